@@ -39,6 +39,8 @@
 #include "http/exception.hh"
 #include "stream_manager.hh"
 #include "system.hh"
+#include "table_scan.hh"
+#include "io_diagnostics.hh"
 
 namespace api {
 
@@ -139,6 +141,12 @@ future<> set_server_done(http_context& ctx) {
         set_compaction_manager(ctx, r);
         rb->register_function(r, "lsa", "Log-structured allocator API");
         set_lsa(ctx, r);
+        rb->register_function(r, "table_scan",
+                "The full-table scan API");
+        set_table_scan(ctx, r);
+        rb->register_function(r, "io_diagnostics",
+                "The I/O diagnostics API");
+        set_io_diagnostics(ctx, r);
 
         rb->register_function(r, "commitlog",
                 "The commit log API");
@@ -64,6 +64,14 @@ future<> foreach_column_family(http_context& ctx, const sstring& name, function<
 
 future<json::json_return_type>  get_cf_stats(http_context& ctx, const sstring& name,
         int64_t column_family::stats::*f) {
+    // Plain counters are served from the per-shard stats snapshots, which
+    // avoids a cross-shard map_reduce on every poll. Fall back when the
+    // snapshots are not usable yet (e.g. a freshly created table).
+    if (auto m = column_family::snapshot_member(f)) {
+        if (auto v = column_family::sum_stats_snapshots(get_uuid(name, ctx.db.local()), m)) {
+            return make_ready_future<json::json_return_type>(*v);
+        }
+    }
     return map_reduce_cf(ctx, name, int64_t(0), [f](const column_family& cf) {
         return cf.get_stats().*f;
     }, std::plus<int64_t>());
@@ -71,6 +79,11 @@ future<json::json_return_type>  get_cf_stats(http_context& ctx, const sstring& n
 
 future<json::json_return_type>  get_cf_stats(http_context& ctx,
         int64_t column_family::stats::*f) {
+    if (auto m = column_family::snapshot_member(f)) {
+        if (auto v = column_family::sum_stats_snapshots(stdx::nullopt, m)) {
+            return make_ready_future<json::json_return_type>(*v);
+        }
+    }
     return map_reduce_cf(ctx, int64_t(0), [f](const column_family& cf) {
         return cf.get_stats().*f;
     }, std::plus<int64_t>());
@@ -78,6 +91,11 @@ future<json::json_return_type>  get_cf_stats(http_context& ctx,
 
 static future<json::json_return_type>  get_cf_stats_count(http_context& ctx, const sstring& name,
         utils::timed_rate_moving_average_and_histogram column_family::stats::*f) {
+    if (auto m = column_family::snapshot_member(f)) {
+        if (auto v = column_family::sum_stats_snapshots(get_uuid(name, ctx.db.local()), m)) {
+            return make_ready_future<json::json_return_type>(*v);
+        }
+    }
     return map_reduce_cf(ctx, name, int64_t(0), [f](const column_family& cf) {
         return (cf.get_stats().*f).hist.count;
     }, std::plus<int64_t>());
@@ -101,6 +119,11 @@ static future<json::json_return_type>  get_cf_stats_sum(http_context& ctx, const
 
 static future<json::json_return_type>  get_cf_stats_count(http_context& ctx,
         utils::timed_rate_moving_average_and_histogram column_family::stats::*f) {
+    if (auto m = column_family::snapshot_member(f)) {
+        if (auto v = column_family::sum_stats_snapshots(stdx::nullopt, m)) {
+            return make_ready_future<json::json_return_type>(*v);
+        }
+    }
     return map_reduce_cf(ctx, int64_t(0), [f](const column_family& cf) {
         return (cf.get_stats().*f).hist.count;
     }, std::plus<int64_t>());
@@ -482,6 +505,10 @@ void set_column_family(http_context& ctx, routes& r) {
         return get_cf_stats_sum(ctx, req->param["name"] ,&column_family::stats::writes);
     });
 
+    cf::get_range_latency.set(r, [&ctx] (std::unique_ptr<request> req) {
+        return get_cf_stats_sum(ctx, req->param["name"] ,&column_family::stats::range_reads);
+    });
+
     cf::get_all_read_latency_histogram_depricated.set(r, [&ctx] (std::unique_ptr<request> req) {
         return get_cf_histogram(ctx, &column_family::stats::writes);
     });
@@ -873,6 +900,13 @@ void set_column_family(http_context& ctx, routes& r) {
         utils::estimated_histogram_merge, utils_json::estimated_histogram());
     });
 
+    cf::get_range_latency_estimated_histogram.set(r, [&ctx](std::unique_ptr<request> req) {
+        return map_reduce_cf(ctx, req->param["name"], utils::estimated_histogram(0), [](column_family& cf) {
+            return cf.get_stats().estimated_range_read;
+        },
+        utils::estimated_histogram_merge, utils_json::estimated_histogram());
+    });
+
     cf::set_compaction_strategy_class.set(r, [&ctx](std::unique_ptr<request> req) {
         sstring strategy = req->get_query_param("class_name");
         return foreach_column_family(ctx, req->param["name"], [strategy](column_family& cf) {
@@ -905,5 +939,45 @@ void set_column_family(http_context& ctx, routes& r) {
             return make_ready_future<json::json_return_type>(res);
         });
     });
+
+    cf::get_pending_backup_files.set(r, [&ctx](std::unique_ptr<request> req) {
+        // The backups directory is shared by all shards, so the local
+        // replica of the column family sees everything.
+        auto cf = ctx.db.local().get_column_families().at(get_uuid(req->param["name"], ctx.db.local()));
+        return cf->pending_backup_files().then([cf](std::vector<sstring> files) {
+            return make_ready_future<json::json_return_type>(std::move(files));
+        });
+    });
+
+    cf::get_backup_file.set(r, [&ctx](std::unique_ptr<request> req) {
+        auto cf = ctx.db.local().get_column_families().at(get_uuid(req->param["name"], ctx.db.local()));
+        sstring file_name = req->get_query_param("file");
+        if (file_name.empty()) {
+            throw bad_param_exception("The 'file' query parameter is mandatory");
+        }
+        // Stream the file straight into the response body instead of
+        // buffering it; backup files are sstable components and can be
+        // arbitrarily large. The shared pointer keeps the column family
+        // alive for as long as the transfer runs.
+        std::function<future<>(output_stream<char>&&)> body_writer = [cf, file_name = std::move(file_name)](output_stream<char>&& s) {
+            return do_with(std::move(s), [cf, file_name](output_stream<char>& s) {
+                return cf->copy_backup_file(file_name, s).finally([&s] {
+                    return s.close();
+                });
+            });
+        };
+        return make_ready_future<json::json_return_type>(std::move(body_writer));
+    });
+
+    cf::delete_backup_file.set(r, [&ctx](std::unique_ptr<request> req) {
+        auto cf = ctx.db.local().get_column_families().at(get_uuid(req->param["name"], ctx.db.local()));
+        sstring file_name = req->get_query_param("file");
+        if (file_name.empty()) {
+            throw bad_param_exception("The 'file' query parameter is mandatory");
+        }
+        return cf->remove_backup_file(std::move(file_name)).then([cf] {
+            return make_ready_future<json::json_return_type>(json_void());
+        });
+    });
 }
 }
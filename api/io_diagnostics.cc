@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "api/api-doc/io_diagnostics.json.hh"
+#include "api/io_diagnostics.hh"
+
+#include "io_class_tracker.hh"
+#include "core/future-util.hh"
+#include <boost/range/irange.hpp>
+#include <algorithm>
+#include <map>
+
+namespace api {
+using namespace httpd;
+
+namespace iod = httpd::io_diagnostics_json;
+
+void set_io_diagnostics(http_context& ctx, routes& r) {
+    iod::get_io_diagnostics.set(r, [] (std::unique_ptr<request> req) {
+        using stats_map = std::map<sstring, io_class_tracker::class_stats>;
+        return do_with(stats_map(), [] (stats_map& acc) {
+            return parallel_for_each(boost::irange(0u, smp::count), [&acc] (unsigned shard) {
+                return smp::submit_to(shard, [] {
+                    return io_class_tracker::local().snapshot();
+                }).then([&acc] (std::vector<io_class_tracker::class_stats> shard_stats) {
+                    for (auto& cs : shard_stats) {
+                        auto& m = acc[cs.name];
+                        m.reads += cs.reads;
+                        m.writes += cs.writes;
+                        m.read_bytes += cs.read_bytes;
+                        m.write_bytes += cs.write_bytes;
+                        m.queue_depth += cs.queue_depth;
+                        m.bytes_in_flight += cs.bytes_in_flight;
+                        m.disk_time_us += cs.disk_time_us;
+                        m.read_latency.merge(cs.read_latency);
+                        m.write_latency.merge(cs.write_latency);
+                    }
+                });
+            }).then([&acc] {
+                // Rank by accumulated disk time: the top entry is the class
+                // responsible for most of the device's busy time.
+                std::vector<stats_map::value_type> ranked(acc.begin(), acc.end());
+                std::sort(ranked.begin(), ranked.end(), [] (const stats_map::value_type& a, const stats_map::value_type& b) {
+                    return a.second.disk_time_us > b.second.disk_time_us;
+                });
+                std::vector<iod::io_class_stats> res;
+                res.reserve(ranked.size());
+                for (auto& e : ranked) {
+                    iod::io_class_stats entry;
+                    entry.name = e.first;
+                    entry.reads = e.second.reads;
+                    entry.writes = e.second.writes;
+                    entry.read_bytes = e.second.read_bytes;
+                    entry.write_bytes = e.second.write_bytes;
+                    entry.queue_depth = e.second.queue_depth;
+                    entry.bytes_in_flight = e.second.bytes_in_flight;
+                    entry.disk_time_ms = e.second.disk_time_us / 1000;
+                    entry.read_latency_p99_us = e.second.read_latency.percentile(0.99);
+                    entry.write_latency_p99_us = e.second.write_latency.percentile(0.99);
+                    res.push_back(std::move(entry));
+                }
+                return json::json_return_type(std::move(res));
+            });
+        });
+    });
+}
+
+}
@@ -40,6 +40,24 @@ void set_lsa(http_context& ctx, routes& r) {
             return json::json_return_type(json::json_void());
         });
     });
+
+    httpd::lsa_json::lsa_set_allocation_profiling.set(r, [&ctx](std::unique_ptr<request> req) {
+        bool enabled = req->get_query_param("enabled") == "true";
+        alogger.info("{} allocation profiling", enabled ? "Enabling" : "Disabling");
+        return ctx.db.invoke_on_all([enabled] (database&) {
+            logalloc::shard_tracker().set_allocation_profiling(enabled);
+        }).then([] {
+            return json::json_return_type(json::json_void());
+        });
+    });
+
+    httpd::lsa_json::lsa_dump_allocation_profile.set(r, [&ctx](std::unique_ptr<request> req) {
+        return ctx.db.map_reduce0([] (database&) {
+            return sprint("shard %d:\n%s", engine().cpu_id(), logalloc::shard_tracker().dump_allocation_profile());
+        }, sstring(), std::plus<sstring>()).then([] (sstring report) {
+            return json::json_return_type(std::move(report));
+        });
+    });
 }
 
 }
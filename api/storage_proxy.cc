@@ -220,6 +220,17 @@ void set_storage_proxy(http_context& ctx, routes& r) {
         return make_ready_future<json::json_return_type>(json_void());
     });
 
+    sp::get_range_scan_concurrency.set(r, [&ctx](std::unique_ptr<request> req)  {
+        return ctx.sp.map_reduce0([](proxy& p) {
+            return std::make_pair(p.get_stats().range_scan_subranges, p.get_stats().range_scan_rounds);
+        }, std::pair<uint64_t, uint64_t>(0, 0), [](std::pair<uint64_t, uint64_t> a, std::pair<uint64_t, uint64_t> b) {
+            return std::make_pair(a.first + b.first, a.second + b.second);
+        }).then([](std::pair<uint64_t, uint64_t> v) {
+            auto avg = v.second ? double(v.first) / v.second : 0.0;
+            return make_ready_future<json::json_return_type>(avg);
+        });
+    });
+
     sp::get_read_repair_attempted.set(r, [&ctx](std::unique_ptr<request> req)  {
         return sum_stats(ctx.sp, &proxy::stats::read_repair_attempts);
     });
@@ -741,6 +741,32 @@ void set_storage_service(http_context& ctx, routes& r) {
         }
     });
 
+    ss::get_recent_slow_queries.set(r, [](std::unique_ptr<request> req) {
+        return tracing::tracing::tracing_instance().map_reduce0([](tracing::tracing& local_tracing) {
+            auto shard = engine().cpu_id();
+            std::vector<ss::slow_query_record> recs;
+            for (auto& r : local_tracing.recent_slow_queries()) {
+                ss::slow_query_record rec;
+                rec.shard = shard;
+                rec.started_at = std::chrono::duration_cast<std::chrono::milliseconds>(r.started_at.time_since_epoch()).count();
+                rec.duration = r.duration.count();
+                rec.client = boost::lexical_cast<std::string>(r.client);
+                rec.username = r.username;
+                rec.request = r.request;
+                for (auto& p : r.parameters) {
+                    ss::mapper m;
+                    m.key = p.first;
+                    m.value = p.second;
+                    rec.parameters.push(std::move(m));
+                }
+                recs.push_back(std::move(rec));
+            }
+            return recs;
+        }, std::vector<ss::slow_query_record>(), concat<ss::slow_query_record>).then([](const std::vector<ss::slow_query_record>& res) {
+            return make_ready_future<json::json_return_type>(res);
+        });
+    });
+
     ss::enable_auto_compaction.set(r, [&ctx](std::unique_ptr<request> req) {
         //TBD
         unimplemented();
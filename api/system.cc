@@ -23,7 +23,12 @@
 #include "api/api.hh"
 
 #include "http/exception.hh"
+#include "database.hh"
+#include "db/config.hh"
 #include "log.hh"
+#include "utils/cpu_profiler.hh"
+
+#include <boost/range/irange.hpp>
 
 namespace api {
 
@@ -65,6 +70,61 @@ void set_system(http_context& ctx, routes& r) {
         }
         return json::json_void();
     });
+
+    hs::get_cpu_profiler_samples.set(r, [](std::unique_ptr<request> req) {
+        return do_with(std::vector<hs::cpu_sample>(), [](std::vector<hs::cpu_sample>& samples) {
+            return parallel_for_each(boost::irange(0u, smp::count), [&samples](unsigned shard) {
+                return smp::submit_to(shard, [] {
+                    return utils::cpu_profiler::shard_samples();
+                }).then([&samples, shard](std::array<uint64_t, utils::cpu_profiler::num_components> counts) {
+                    for (unsigned c = 0; c < counts.size(); c++) {
+                        hs::cpu_sample s;
+                        s.shard = shard;
+                        s.component = utils::cpu_profiler::component_name(utils::cpu_profiler::component(c));
+                        s.count = counts[c];
+                        samples.push_back(std::move(s));
+                    }
+                });
+            }).then([&samples] {
+                return make_ready_future<json::json_return_type>(samples);
+            });
+        });
+    });
+
+    hs::set_cpu_profiler.set(r, [](std::unique_ptr<request> req) {
+        auto enabled = req->get_query_param("enabled") == "true";
+        auto period = std::chrono::microseconds(10000);
+        auto period_param = req->get_query_param("period_us");
+        if (!period_param.empty()) {
+            try {
+                period = std::chrono::microseconds(boost::lexical_cast<uint64_t>(std::string(period_param)));
+            } catch (boost::bad_lexical_cast& e) {
+                throw bad_param_exception("Invalid period " + period_param);
+            }
+        }
+        return smp::invoke_on_all([enabled, period] {
+            if (enabled) {
+                utils::cpu_profiler::start(period);
+            } else {
+                utils::cpu_profiler::stop();
+            }
+        }).then([] {
+            return make_ready_future<json::json_return_type>(json::json_void());
+        });
+    });
+
+    hs::reload_config.set(r, [&ctx](std::unique_ptr<request> req) {
+        // Each shard's database holds its own copy of the config; every
+        // shard re-reads the file and applies the live-updatable changes
+        // to its copy locally. The shard 0 result is reported back.
+        return ctx.db.local().get_config().reload().then([&ctx](std::vector<sstring> applied) {
+            return ctx.db.invoke_on_all([](database& db) {
+                return db.get_config().reload().discard_result();
+            }).then([applied = std::move(applied)] {
+                return make_ready_future<json::json_return_type>(std::move(applied));
+            });
+        });
+    });
 }
 
 }
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "api/api-doc/table_scan.json.hh"
+#include "api/table_scan.hh"
+#include "api/column_family.hh"
+
+#include "http/exception.hh"
+#include "database.hh"
+#include "flat_mutation_reader.hh"
+#include "counters.hh"
+#include "json.hh"
+#include "utils/UUID_gen.hh"
+#include <boost/lexical_cast.hpp>
+
+namespace api {
+using namespace httpd;
+
+namespace ts = httpd::table_scan_json;
+
+static logging::logger slogger("table_scan-api");
+
+// One shard's half of a scan session. Each shard runs its own reader over
+// the data it owns locally, so a client fetching pages from all shards over
+// separate connections keeps all cores busy. The session is pull-driven:
+// the reader advances only when the next page is asked for, so a consumer
+// which falls behind on one shard throttles just that shard's reader and
+// nothing is buffered beyond a single page.
+class scan_session {
+    schema_ptr _schema;
+    flat_mutation_reader _reader;
+    // Serializes page fetches; a retried request must not interleave with
+    // one still consuming the reader.
+    semaphore _page_in_progress{1};
+    Json::Value _pk{Json::objectValue}; // key of the partition being read
+    uint64_t _partitions = 0;
+    uint64_t _rows = 0;
+    bool _done = false;
+public:
+    static constexpr size_t page_size_bytes = 512 * 1024;
+
+    explicit scan_session(column_family& cf)
+        : _schema(cf.schema())
+        , _reader(cf.make_reader(_schema))
+    { }
+
+    uint64_t partitions() const { return _partitions; }
+    uint64_t rows() const { return _rows; }
+    bool done() const { return _done; }
+
+    future<sstring> next_page() {
+        return with_semaphore(_page_in_progress, 1, [this] {
+            if (_done) {
+                return make_ready_future<sstring>(sstring());
+            }
+            auto out = make_lw_shared<sstring>();
+            return _reader.consume_pausable([this, out] (mutation_fragment mf) {
+                consume_fragment(std::move(mf), *out);
+                return out->size() >= page_size_bytes ? stop_iteration::yes : stop_iteration::no;
+            }, db::no_timeout).then([this, out] {
+                if (out->size() < page_size_bytes) {
+                    _done = true;
+                }
+                return std::move(*out);
+            });
+        });
+    }
+private:
+    template<typename ColumnRange>
+    static Json::Value format_key(const ColumnRange& columns, const std::vector<bytes>& components) {
+        Json::Value res(Json::objectValue);
+        auto it = components.begin();
+        for (const column_definition& def : columns) {
+            if (it == components.end()) {
+                break; // clustering key prefixes are legal
+            }
+            res[def.name_as_text().c_str()] = Json::Value(def.type->to_string(*it++).c_str());
+        }
+        return res;
+    }
+
+    void format_cells(column_kind kind, const row& cells, Json::Value& line) {
+        cells.for_each_cell([&] (column_id id, const atomic_cell_or_collection& c) {
+            const column_definition& def = _schema->column_at(kind, id);
+            if (def.is_atomic()) {
+                auto cell = c.as_atomic_cell();
+                if (!cell.is_live()) {
+                    return;
+                }
+                if (def.is_counter()) {
+                    counter_cell_view ccv(cell);
+                    line[def.name_as_text().c_str()] = Json::Value(Json::Int64(ccv.total_value()));
+                } else {
+                    auto v = cell.value();
+                    line[def.name_as_text().c_str()] = Json::Value(def.type->to_string(bytes(v.begin(), v.end())).c_str());
+                }
+            } else {
+                auto ctype = static_pointer_cast<const collection_type_impl>(def.type);
+                auto v = ctype->to_value(c.as_collection_mutation(), cql_serialization_format::internal());
+                line[def.name_as_text().c_str()] = Json::Value(ctype->to_string(v).c_str());
+            }
+        });
+    }
+
+    void consume_fragment(mutation_fragment&& mf, sstring& out) {
+        if (mf.is_partition_start()) {
+            _pk = format_key(_schema->partition_key_columns(), mf.as_partition_start().key().key().explode(*_schema));
+            ++_partitions;
+        } else if (mf.is_static_row()) {
+            Json::Value line(Json::objectValue);
+            line["key"] = _pk;
+            line["static"] = Json::Value(true);
+            format_cells(column_kind::static_column, mf.as_static_row().cells(), line);
+            out += json::to_sstring(line);
+            out += "\n";
+        } else if (mf.is_clustering_row()) {
+            auto& cr = mf.as_clustering_row();
+            Json::Value line(Json::objectValue);
+            line["key"] = _pk;
+            if (_schema->clustering_key_size()) {
+                line["clustering"] = format_key(_schema->clustering_key_columns(), cr.key().explode(*_schema));
+            }
+            format_cells(column_kind::regular_column, cr.cells(), line);
+            out += json::to_sstring(line);
+            out += "\n";
+            ++_rows;
+        }
+        // Range tombstones and partition ends carry no data for an export.
+    }
+};
+
+static thread_local std::unordered_map<utils::UUID, lw_shared_ptr<scan_session>> scan_sessions;
+
+static lw_shared_ptr<scan_session> find_session(const utils::UUID& id) {
+    auto it = scan_sessions.find(id);
+    if (it == scan_sessions.end()) {
+        throw bad_param_exception(sprint("Scan session %s not found on this shard", id));
+    }
+    return it->second;
+}
+
+void set_table_scan(http_context& ctx, routes& r) {
+    ts::table_scan_create_session.set(r, [&ctx] (std::unique_ptr<request> req) {
+        auto uuid = get_uuid(req->param["name"], ctx.db.local());
+        auto id = utils::UUID_gen::get_time_UUID();
+        slogger.info("Starting scan session {} over {}", id, req->param["name"]);
+        return ctx.db.invoke_on_all([id, uuid] (database& db) {
+            scan_sessions.emplace(id, make_lw_shared<scan_session>(db.find_column_family(uuid)));
+        }).then([id] {
+            return json::json_return_type(id.to_sstring());
+        });
+    });
+
+    ts::table_scan_get_page.set(r, [&ctx] (std::unique_ptr<request> req) {
+        auto id = utils::UUID(req->param["id"]);
+        auto shard_param = req->get_query_param("shard");
+        unsigned shard;
+        try {
+            shard = boost::lexical_cast<unsigned>(shard_param);
+        } catch (boost::bad_lexical_cast&) {
+            throw bad_param_exception(sprint("Invalid shard: %s", shard_param));
+        }
+        if (shard >= smp::count) {
+            throw bad_param_exception(sprint("Shard %d out of range, this node has %d shards", shard, smp::count));
+        }
+        return ctx.db.invoke_on(shard, [id] (database&) {
+            auto session = find_session(id);
+            return session->next_page().then([session] (sstring data) {
+                ts::scan_page page;
+                page.data = std::move(data);
+                page.done = session->done();
+                return page;
+            });
+        }).then([] (ts::scan_page page) {
+            return make_ready_future<json::json_return_type>(std::move(page));
+        });
+    });
+
+    ts::table_scan_get_progress.set(r, [&ctx] (std::unique_ptr<request> req) {
+        auto id = utils::UUID(req->param["id"]);
+        return ctx.db.map_reduce0([id] (database&) {
+            std::vector<ts::shard_progress> res;
+            auto it = scan_sessions.find(id);
+            if (it != scan_sessions.end()) {
+                ts::shard_progress p;
+                p.shard = engine().cpu_id();
+                p.partitions = it->second->partitions();
+                p.rows = it->second->rows();
+                p.done = it->second->done();
+                res.push_back(std::move(p));
+            }
+            return res;
+        }, std::vector<ts::shard_progress>(), concat<ts::shard_progress>).then([] (std::vector<ts::shard_progress> res) {
+            return make_ready_future<json::json_return_type>(std::move(res));
+        });
+    });
+
+    ts::table_scan_close_session.set(r, [&ctx] (std::unique_ptr<request> req) {
+        auto id = utils::UUID(req->param["id"]);
+        slogger.info("Closing scan session {}", id);
+        return ctx.db.invoke_on_all([id] (database&) {
+            // An in-flight page fetch holds its own reference and finishes
+            // before the session is actually destroyed.
+            scan_sessions.erase(id);
+        }).then([] {
+            return json::json_return_type(json::json_void());
+        });
+    });
+}
+
+}
@@ -48,10 +48,19 @@ class atomic_cell_or_collection;
 /*
  * Represents atomic cell layout. Works on serialized form.
  *
+ * This layout is in-memory only; cells cross process boundaries through the
+ * IDL and sstables field by field, so it can change freely between releases.
+ *
  * Layout:
  *
- *  <live>  := <int8_t:flags><int64_t:timestamp>(<int32_t:expiry><int32_t:ttl>)?<value>
- *  <dead>  := <int8_t:    0><int64_t:timestamp><int32_t:deletion_time>
+ *  <live>  := <int8_t:flags><timestamp>(<int32_t:expiry><int32_t:ttl>)?<value>
+ *  <dead>  := <int8_t:flags><timestamp><int32_t:deletion_time>
+ *
+ * The timestamp is stored big-endian at its minimal two's complement width,
+ * with the width recorded in the upper bits of the flags byte. Current-era
+ * microsecond timestamps need only 7 bytes, and tombstones and cells written
+ * with small explicit timestamps less; this adds up in collection mutations,
+ * which embed one such cell per element.
  */
 class atomic_cell_type final {
 private:
@@ -59,15 +68,37 @@ private:
     static constexpr int8_t EXPIRY_FLAG = 0x02; // When present, expiry field is present. Set only for live cells
     static constexpr int8_t COUNTER_UPDATE_FLAG = 0x08; // Cell is a counter update.
     static constexpr int8_t COUNTER_IN_PLACE_REVERT = 0x10;
+    // Bits 5-7 of the flags byte hold (full_timestamp_size - width) of the
+    // timestamp field, so a zero there means a full 8-byte timestamp.
+    static constexpr unsigned timestamp_width_shift = 5;
     static constexpr unsigned flags_size = 1;
     static constexpr unsigned timestamp_offset = flags_size;
-    static constexpr unsigned timestamp_size = 8;
-    static constexpr unsigned expiry_offset = timestamp_offset + timestamp_size;
+    static constexpr unsigned full_timestamp_size = 8;
     static constexpr unsigned expiry_size = 4;
-    static constexpr unsigned deletion_time_offset = timestamp_offset + timestamp_size;
     static constexpr unsigned deletion_time_size = 4;
-    static constexpr unsigned ttl_offset = expiry_offset + expiry_size;
     static constexpr unsigned ttl_size = 4;
+
+    static unsigned timestamp_size(int8_t flags) {
+        return full_timestamp_size - ((uint8_t(flags) >> timestamp_width_shift) & 0x7);
+    }
+    // Number of bytes needed to represent ts in two's complement.
+    static unsigned minimal_timestamp_size(api::timestamp_type ts) {
+        unsigned w = 1;
+        while (w < full_timestamp_size
+                && (int64_t(uint64_t(ts) << (64 - 8 * w)) >> (64 - 8 * w)) != ts) {
+            ++w;
+        }
+        return w;
+    }
+    // Records the timestamp's width in the flags byte and stores the
+    // timestamp itself. The cell must have w bytes reserved for it.
+    template<typename BytesContainer>
+    static void write_timestamp(BytesContainer& cell, api::timestamp_type ts, unsigned w) {
+        cell[0] = int8_t(uint8_t(cell[0]) | ((full_timestamp_size - w) << timestamp_width_shift));
+        for (unsigned i = 0; i < w; ++i) {
+            cell[timestamp_offset + i] = int8_t(uint64_t(ts) >> (8 * (w - 1 - i)));
+        }
+    }
     friend class counter_cell_builder;
 private:
     static bool is_counter_update(bytes_view cell) {
@@ -91,18 +122,34 @@ private:
     }
     // Can be called on live and dead cells
     static api::timestamp_type timestamp(const bytes_view& cell) {
-        return get_field<api::timestamp_type>(cell, timestamp_offset);
+        auto w = timestamp_size(cell[0]);
+        if (w == full_timestamp_size) {
+            return get_field<api::timestamp_type>(cell, timestamp_offset);
+        }
+        uint64_t v = 0;
+        for (unsigned i = 0; i < w; ++i) {
+            v = (v << 8) | uint8_t(cell[timestamp_offset + i]);
+        }
+        auto shift = 64 - 8 * w;
+        return int64_t(v << shift) >> shift;
     }
+    // Rewrites the timestamp in place; the new value must fit in the width
+    // the cell was created with. In practice only counter cells are updated
+    // this way, and those are always created with a full-width timestamp.
     template<typename BytesContainer>
     static void set_timestamp(BytesContainer& cell, api::timestamp_type ts) {
-        set_field(cell, timestamp_offset, ts);
+        auto w = timestamp_size(cell[0]);
+        assert(minimal_timestamp_size(ts) <= w);
+        for (unsigned i = 0; i < w; ++i) {
+            cell[timestamp_offset + i] = int8_t(uint64_t(ts) >> (8 * (w - 1 - i)));
+        }
     }
     // Can be called on live cells only
 private:
     template<typename BytesView>
     static BytesView do_get_value(BytesView cell) {
         auto expiry_field_size = bool(cell[0] & EXPIRY_FLAG) * (expiry_size + ttl_size);
-        auto value_offset = flags_size + timestamp_size + expiry_field_size;
+        auto value_offset = flags_size + timestamp_size(cell[0]) + expiry_field_size;
         cell.remove_prefix(value_offset);
         return cell;
     }
@@ -115,55 +162,60 @@ public:
     }
     // Can be called on live counter update cells only
     static int64_t counter_update_value(bytes_view cell) {
-        return get_field<int64_t>(cell, flags_size + timestamp_size);
+        return get_field<int64_t>(cell, flags_size + timestamp_size(cell[0]));
     }
     // Can be called only when is_dead() is true.
     static gc_clock::time_point deletion_time(const bytes_view& cell) {
         assert(is_dead(cell));
         return gc_clock::time_point(gc_clock::duration(
-            get_field<int32_t>(cell, deletion_time_offset)));
+            get_field<int32_t>(cell, flags_size + timestamp_size(cell[0]))));
     }
     // Can be called only when is_live_and_has_ttl() is true.
     static gc_clock::time_point expiry(const bytes_view& cell) {
         assert(is_live_and_has_ttl(cell));
-        auto expiry = get_field<int32_t>(cell, expiry_offset);
+        auto expiry = get_field<int32_t>(cell, flags_size + timestamp_size(cell[0]));
         return gc_clock::time_point(gc_clock::duration(expiry));
     }
     // Can be called only when is_live_and_has_ttl() is true.
     static gc_clock::duration ttl(const bytes_view& cell) {
         assert(is_live_and_has_ttl(cell));
-        return gc_clock::duration(get_field<int32_t>(cell, ttl_offset));
+        return gc_clock::duration(get_field<int32_t>(cell, flags_size + timestamp_size(cell[0]) + expiry_size));
     }
     static managed_bytes make_dead(api::timestamp_type timestamp, gc_clock::time_point deletion_time) {
-        managed_bytes b(managed_bytes::initialized_later(), flags_size + timestamp_size + deletion_time_size);
+        auto w = minimal_timestamp_size(timestamp);
+        managed_bytes b(managed_bytes::initialized_later(), flags_size + w + deletion_time_size);
         b[0] = 0;
-        set_field(b, timestamp_offset, timestamp);
-        set_field(b, deletion_time_offset, deletion_time.time_since_epoch().count());
+        write_timestamp(b, timestamp, w);
+        set_field(b, flags_size + w, deletion_time.time_since_epoch().count());
         return b;
     }
     static managed_bytes make_live(api::timestamp_type timestamp, bytes_view value) {
-        auto value_offset = flags_size + timestamp_size;
+        auto w = minimal_timestamp_size(timestamp);
+        auto value_offset = flags_size + w;
         managed_bytes b(managed_bytes::initialized_later(), value_offset + value.size());
         b[0] = LIVE_FLAG;
-        set_field(b, timestamp_offset, timestamp);
+        write_timestamp(b, timestamp, w);
         std::copy_n(value.begin(), value.size(), b.begin() + value_offset);
         return b;
     }
     static managed_bytes make_live_counter_update(api::timestamp_type timestamp, int64_t value) {
-        auto value_offset = flags_size + timestamp_size;
+        // Full-width timestamp: counter cell timestamps are rewritten in
+        // place when local updates are applied (see counters.cc).
+        auto value_offset = flags_size + full_timestamp_size;
         managed_bytes b(managed_bytes::initialized_later(), value_offset + sizeof(value));
         b[0] = LIVE_FLAG | COUNTER_UPDATE_FLAG;
-        set_field(b, timestamp_offset, timestamp);
+        write_timestamp(b, timestamp, full_timestamp_size);
         set_field(b, value_offset, value);
         return b;
     }
     static managed_bytes make_live(api::timestamp_type timestamp, bytes_view value, gc_clock::time_point expiry, gc_clock::duration ttl) {
-        auto value_offset = flags_size + timestamp_size + expiry_size + ttl_size;
+        auto w = minimal_timestamp_size(timestamp);
+        auto value_offset = flags_size + w + expiry_size + ttl_size;
         managed_bytes b(managed_bytes::initialized_later(), value_offset + value.size());
         b[0] = EXPIRY_FLAG | LIVE_FLAG;
-        set_field(b, timestamp_offset, timestamp);
-        set_field(b, expiry_offset, expiry.time_since_epoch().count());
-        set_field(b, ttl_offset, ttl.count());
+        write_timestamp(b, timestamp, w);
+        set_field(b, flags_size + w, expiry.time_since_epoch().count());
+        set_field(b, flags_size + w + expiry_size, ttl.count());
         std::copy_n(value.begin(), value.size(), b.begin() + value_offset);
         return b;
     }
@@ -185,10 +237,12 @@ public:
         serializer(it);
     })
     static managed_bytes make_live_from_serializer(api::timestamp_type timestamp, size_t size, Serializer&& serializer) {
-        auto value_offset = flags_size + timestamp_size;
+        // Full-width timestamp: the only users are counter cells, whose
+        // timestamps are rewritten in place (see counters.cc).
+        auto value_offset = flags_size + full_timestamp_size;
         managed_bytes b(managed_bytes::initialized_later(), value_offset + size);
         b[0] = LIVE_FLAG;
-        set_field(b, timestamp_offset, timestamp);
+        write_timestamp(b, timestamp, full_timestamp_size);
         serializer(b.begin() + value_offset);
         return b;
     }
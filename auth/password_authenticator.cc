@@ -58,6 +58,7 @@ extern "C" {
 #include "auth/roles-metadata.hh"
 #include "cql3/untyped_result_set.hh"
 #include "log.hh"
+#include "md5_hasher.hh"
 #include "service/migration_manager.hh"
 #include "utils/class_registrator.hh"
 
@@ -161,6 +162,38 @@ static sstring hashpw(const sstring& pass) {
     return hashpw(pass, gensalt());
 }
 
+// Verified-credentials cache parameters. A positive entry lets identical
+// credentials skip crypt_r() for its lifetime; password changes made on
+// other shards are therefore honored with up to this much delay (changes
+// made locally invalidate the entry right away). A negative entry makes
+// repeated presentation of the same wrong credentials fail fast, which
+// both spares the CPU during misconfigured-client storms and rate-limits
+// repeated verification attempts of a guessed password; it is kept short
+// so a just-corrected password isn't refused for long.
+static constexpr std::chrono::seconds credentials_cache_ttl{60};
+static constexpr std::chrono::seconds credentials_negative_ttl{5};
+static constexpr size_t credentials_cache_max_entries = 4096;
+
+static bytes credentials_digest(const sstring& username, const sstring& password) {
+    // Per-shard random salt, so the cached digests are useless outside this
+    // process lifetime and cannot be precomputed offline.
+    static thread_local const sstring salt = [] {
+        std::random_device rd;
+        std::default_random_engine e(rd());
+        std::uniform_int_distribution<char> dist;
+        sstring s(rand_bytes, 0);
+        for (char& c : s) {
+            c = dist(e);
+        }
+        return s;
+    }();
+    md5_hasher h;
+    h.update(salt.c_str(), salt.size());
+    h.update(username.c_str(), username.size() + 1); // include the NUL as separator
+    h.update(password.c_str(), password.size());
+    return h.finalize();
+}
+
 static bool has_salted_hash(const cql3::untyped_result_set_row& row) {
     return utf8_type->deserialize(row.get_blob(SALTED_HASH)) != data_value::make_null(utf8_type);
 }
@@ -283,6 +316,17 @@ future<authenticated_user> password_authenticator::authenticate(
     auto& username = credentials.at(USERNAME_KEY);
     auto& password = credentials.at(PASSWORD_KEY);
 
+    auto digest = credentials_digest(username, password);
+    auto now = seastar::lowres_clock::now();
+    auto ci = _verified_credentials.find(username);
+    if (ci != _verified_credentials.end() && ci->second.expiry > now && ci->second.digest == digest) {
+        if (ci->second.ok) {
+            return make_ready_future<authenticated_user>(username);
+        }
+        return make_exception_future<authenticated_user>(
+                exceptions::authentication_exception("Username and/or password are incorrect"));
+    }
+
     // Here was a thread local, explicit cache of prepared statement. In normal execution this is
     // fine, but since we in testing set up and tear down system over and over, we'd start using
     // obsolete prepared statements pretty quickly.
@@ -304,8 +348,10 @@ future<authenticated_user> password_authenticator::authenticate(
         try {
             auto res = f.get0();
             if (res->empty() || !checkpw(password, res->one().get_as<sstring>(SALTED_HASH))) {
+                cache_verification(username, std::move(digest), false);
                 throw exceptions::authentication_exception("Username and/or password are incorrect");
             }
+            cache_verification(username, std::move(digest), true);
             return make_ready_future<authenticated_user>(username);
         } catch (std::system_error &) {
             std::throw_with_nested(exceptions::authentication_exception("Could not verify password"));
@@ -317,11 +363,28 @@ future<authenticated_user> password_authenticator::authenticate(
     });
 }
 
+void password_authenticator::cache_verification(const sstring& username, bytes digest, bool ok) const {
+    auto now = seastar::lowres_clock::now();
+    if (_verified_credentials.size() >= credentials_cache_max_entries) {
+        for (auto i = _verified_credentials.begin(); i != _verified_credentials.end();) {
+            i = i->second.expiry <= now ? _verified_credentials.erase(i) : std::next(i);
+        }
+        if (_verified_credentials.size() >= credentials_cache_max_entries) {
+            // Degenerate many-roles case; shed everything rather than grow.
+            _verified_credentials.clear();
+        }
+    }
+    _verified_credentials[username] = cached_verification{std::move(digest), ok,
+            now + (ok ? credentials_cache_ttl : credentials_negative_ttl)};
+}
+
 future<> password_authenticator::create(stdx::string_view role_name, const authentication_options& options) {
     if (!options.password) {
         return make_ready_future<>();
     }
 
+    _verified_credentials.erase(sstring(role_name));
+
     return _qp.process(
             update_row_query,
             consistency_for_user(role_name),
@@ -333,6 +396,10 @@ future<> password_authenticator::alter(stdx::string_view role_name, const authen
         return make_ready_future<>();
     }
 
+    // Other shards (and nodes) keep a stale entry for at most
+    // credentials_cache_ttl.
+    _verified_credentials.erase(sstring(role_name));
+
     static const sstring query = sprint(
             "UPDATE %s SET %s = ? WHERE %s = ?",
             meta::roles_table::qualified_name(),
@@ -346,6 +413,8 @@ future<> password_authenticator::alter(stdx::string_view role_name, const authen
 }
 
 future<> password_authenticator::drop(stdx::string_view name) {
+    _verified_credentials.erase(sstring(name));
+
     static const sstring query = sprint(
             "DELETE %s FROM %s WHERE %s = ?",
             SALTED_HASH,
@@ -41,7 +41,10 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include <seastar/core/abort_source.hh>
+#include <seastar/core/lowres_clock.hh>
 
 #include "auth/authenticator.hh"
 #include "cql3/query_processor.hh"
@@ -60,6 +63,18 @@ class password_authenticator : public authenticator {
     future<> _stopped;
     seastar::abort_source _as;
 
+    // Verified-credentials cache (per shard, since the authenticator is).
+    // Maps a role name to a salted digest of the last credentials verified
+    // with the expensive crypt_r() round, plus the outcome, so reconnect
+    // storms presenting the same credentials skip the hashing entirely.
+    // See authenticate() for the coherency rules.
+    struct cached_verification {
+        bytes digest;
+        bool ok;
+        seastar::lowres_clock::time_point expiry;
+    };
+    mutable std::unordered_map<sstring, cached_verification> _verified_credentials;
+
 public:
     static db::consistency_level consistency_for_user(stdx::string_view role_name);
 
@@ -92,6 +107,8 @@ public:
     virtual ::shared_ptr<sasl_challenge> new_sasl_challenge() const override;
 
 private:
+    void cache_verification(const sstring& username, bytes digest, bool ok) const;
+
     bool legacy_metadata_exists() const;
 
     future<> migrate_legacy_metadata();
@@ -44,6 +44,12 @@
 // region, and aggressively in the third region.
 //
 // The constants q1 and q2 are used to determine the proportional factor at each stage.
+//
+// On top of the proportional term, the controller evaluates the curve at the backlog predicted
+// for the next interval rather than the current one, so shares ramp up while the backlog is
+// still growing and back off while it drains, instead of oscillating around each threshold.
+// The output can be clamped to a [min, max] range, and a controller may supply a foreground
+// pressure signal which temporarily halves the output while foreground work queues behind it.
 class backlog_controller {
 public:
     future<> shutdown() {
@@ -63,6 +69,17 @@ protected:
     std::vector<control_point> _control_points;
 
     std::function<float()> _current_backlog;
+    // Backlog seen by the previous adjust() round, for the derivative term.
+    float _last_backlog = 0;
+    // How many intervals ahead we extrapolate the backlog when evaluating
+    // the control curve.
+    static constexpr float derivative_lead = 1.0f;
+    // Clamps applied to the controller output, not to static shares.
+    float _min_shares = 0;
+    float _max_shares = 1000;
+    // Returns non-zero when foreground work is queueing behind this class.
+    // May be left unset for controllers with no foreground to yield to.
+    std::function<float()> _foreground_pressure;
     // updating shares for an I/O class may contact another shard and returns a future.
     future<> _inflight_update;
 
@@ -128,10 +145,15 @@ class compaction_controller : public backlog_controller {
 public:
     static constexpr unsigned normalization_factor = 10;
     compaction_controller(seastar::scheduling_group sg, const ::io_priority_class& iop, float static_shares) : backlog_controller(sg, iop, static_shares) {}
-    compaction_controller(seastar::scheduling_group sg, const ::io_priority_class& iop, std::chrono::milliseconds interval, std::function<float()> current_backlog)
+    compaction_controller(seastar::scheduling_group sg, const ::io_priority_class& iop, std::chrono::milliseconds interval, std::function<float()> current_backlog,
+            float min_shares, float max_shares, std::function<float()> foreground_pressure)
         : backlog_controller(sg, iop, std::move(interval),
           std::vector<backlog_controller::control_point>({{0.5, 10}, {1.5, 100} , {normalization_factor, 1000}}),
           std::move(current_backlog)
         )
-    {}
+    {
+        _min_shares = min_shares;
+        _max_shares = max_shares;
+        _foreground_pressure = std::move(foreground_pressure);
+    }
 };
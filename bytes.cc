@@ -22,6 +22,10 @@
 #include "bytes.hh"
 #include "core/print.hh"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#endif
+
 static inline int8_t hex_to_int(unsigned char c) {
     switch (c) {
         case '0': return 0;
@@ -45,13 +49,53 @@ static inline int8_t hex_to_int(unsigned char c) {
     }
 }
 
+#if defined(__x86_64__) || defined(__i386__)
+// Decodes 16 hex digits to their nibble values. Returns false if any of the
+// characters is not a hex digit, leaving the output unspecified.
+static inline bool decode_hex_block(__m128i chars, __m128i& nibbles) {
+    auto lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    auto is_digit = _mm_and_si128(
+            _mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+            _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), chars));
+    auto is_alpha = _mm_and_si128(
+            _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+            _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower));
+    // Bytes with the high bit set compare as negative and so fail both
+    // range checks above.
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xffff) {
+        return false;
+    }
+    nibbles = _mm_or_si128(
+            _mm_and_si128(is_digit, _mm_sub_epi8(chars, _mm_set1_epi8('0'))),
+            _mm_and_si128(is_alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+    return true;
+}
+#endif
+
 bytes from_hex(sstring_view s) {
     if (s.length() % 2 == 1) {
         throw std::invalid_argument("An hex string representing bytes must have an even length");
     }
     bytes out{bytes::initialized_later(), s.length() / 2};
     unsigned end = out.size();
-    for (unsigned i = 0; i != end; i++) {
+    unsigned i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    // Decode 32 hex digits to 16 bytes per iteration. On a non-hex character
+    // we drop to the scalar loop, which reports it with the usual exception.
+    while (i + 16 <= end) {
+        auto p = reinterpret_cast<const __m128i*>(s.data() + i * 2);
+        __m128i nib1, nib2;
+        if (!decode_hex_block(_mm_loadu_si128(p), nib1) || !decode_hex_block(_mm_loadu_si128(p + 1), nib2)) {
+            break;
+        }
+        // Combine adjacent nibbles: the first of each pair is the high one.
+        auto mul = _mm_set1_epi16(0x0110);
+        auto packed = _mm_packus_epi16(_mm_maddubs_epi16(nib1, mul), _mm_maddubs_epi16(nib2, mul));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out.begin() + i), packed);
+        i += 16;
+    }
+#endif
+    for (; i != end; i++) {
         auto half_byte1 = hex_to_int(s[i * 2]);
         auto half_byte2 = hex_to_int(s[i * 2 + 1]);
         if (half_byte1 == -1 || half_byte2 == -1) {
@@ -66,7 +110,23 @@ sstring to_hex(bytes_view b) {
     static char digits[] = "0123456789abcdef";
     sstring out(sstring::initialized_later(), b.size() * 2);
     unsigned end = b.size();
-    for (unsigned i = 0; i != end; ++i) {
+    unsigned i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    // Encode 16 bytes to 32 hex digits per iteration, translating the
+    // nibbles through the digit table with a byte shuffle.
+    auto lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits));
+    auto low_mask = _mm_set1_epi8(0x0f);
+    while (i + 16 <= end) {
+        auto in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b.data() + i));
+        auto lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, low_mask));
+        auto hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), low_mask));
+        auto p = reinterpret_cast<__m128i*>(out.begin() + i * 2);
+        _mm_storeu_si128(p, _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(p + 1, _mm_unpackhi_epi8(hi, lo));
+        i += 16;
+    }
+#endif
+    for (; i != end; ++i) {
         uint8_t x = b[i];
         out[2*i] = digits[x >> 4];
         out[2*i+1] = digits[x & 0xf];
@@ -26,6 +26,7 @@
 #include "bytes.hh"
 #include "core/unaligned.hh"
 #include "hashing.hh"
+#include "vint-serialization.hh"
 #include "seastar/core/simple-stream.hh"
 /**
  * Utility for writing data into a buffer when its final size is not known up front.
@@ -227,6 +228,46 @@ public:
         write(bytes_view(reinterpret_cast<const signed char*>(ptr), size));
     }
 
+private:
+    // Widest possible vint encoding of a 64-bit value.
+    static constexpr size_type max_vint_length = 9;
+
+    // Gives back the tail of the most recent alloc() which turned out not
+    // to be needed. Valid only right after the alloc(), before any other
+    // write.
+    void trim_last_alloc(size_type unused) {
+        _current->offset -= unused;
+        _size -= unused;
+    }
+public:
+    // Encodes a vint directly into the stream: space for the widest
+    // possible encoding is carved out of the current chunk, the value is
+    // encoded in place and the unused tail is given back. Saves the
+    // encode-into-a-temporary-and-copy round trip of writing through
+    // unsigned_vint::serialize() plus write().
+    void write_unsigned_vint(uint64_t v) {
+        auto out = alloc(max_vint_length);
+        trim_last_alloc(max_vint_length - unsigned_vint::serialize(v, out));
+    }
+
+    void write_signed_vint(int64_t v) {
+        auto out = alloc(max_vint_length);
+        trim_last_alloc(max_vint_length - signed_vint::serialize(v, out));
+    }
+
+    // Encodes several unsigned vints back to back, reserving worst-case
+    // space once. Meant for multi-field headers, where it replaces one
+    // reserve-encode-trim cycle per field with one per header.
+    void write_unsigned_vints(std::initializer_list<uint64_t> values) {
+        auto reserved = max_vint_length * size_type(values.size());
+        auto out = alloc(reserved);
+        size_type used = 0;
+        for (auto v : values) {
+            used += unsigned_vint::serialize(v, out + used);
+        }
+        trim_last_alloc(reserved - used);
+    }
+
     bool is_linearized() const {
         return !_begin || !_begin->next;
     }
@@ -279,8 +320,26 @@ public:
         return _size == 0;
     }
 
+    // Makes the first chunk of the stream large enough to fit size bytes
+    // (clamped to max_chunk_size()), so that writers which know the
+    // approximate final size up front do not have to grow the stream
+    // through the doubling sequence of small chunks. May only be called
+    // on an empty stream; hints not exceeding the default chunk size are
+    // ignored.
     void reserve(size_t size) {
-        // FIXME: implement
+        if (_begin || size <= chunk_size) {
+            return;
+        }
+        auto alloc_size = std::min<size_t>(size + sizeof(chunk), max_chunk_size());
+        auto space = malloc(alloc_size);
+        if (!space) {
+            throw std::bad_alloc();
+        }
+        auto new_chunk = std::unique_ptr<chunk>(new (space) chunk());
+        new_chunk->offset = 0;
+        new_chunk->size = alloc_size - sizeof(chunk);
+        _begin = std::move(new_chunk);
+        _current = _begin.get();
     }
 
     void append(const bytes_ostream& o) {
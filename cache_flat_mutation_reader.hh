@@ -86,6 +86,15 @@ class cache_flat_mutation_reader final : public flat_mutation_reader::impl {
     partition_snapshot_row_cursor _next_row;
     bool _next_row_in_range = false;
 
+    // How many more clustering rows this read may leave populated in cache,
+    // per the table's rows_per_partition caching option. Both cache hits and
+    // fresh insertions are counted, so the cap is positional - it retains the
+    // head of the partition (in reader order) rather than whichever rows a
+    // particular read happened to miss on. Once exhausted, can_populate()
+    // turns false and all population and continuity marking takes the
+    // regular mispopulate paths, which keep the cache consistent.
+    uint64_t _row_population_budget;
+
     future<> do_fill_buffer(db::timeout_clock::time_point);
     void copy_from_cache_to_buffer();
     future<> process_static_row(db::timeout_clock::time_point);
@@ -130,6 +139,7 @@ public:
         , _upper_bound(position_in_partition_view::before_all_clustered_rows())
         , _read_context(std::move(ctx))
         , _next_row(*_schema, *_snp)
+        , _row_population_budget(_schema->caching_options().rows_per_partition())
     {
         clogger.trace("csm {}: table={}.{}", this, _schema->ks_name(), _schema->cf_name());
         push_mutation_fragment(partition_start(std::move(dk), _snp->partition_tombstone()));
@@ -259,9 +269,35 @@ future<> cache_flat_mutation_reader::read_from_underlying(db::timeout_clock::tim
         [this] {
             _state = state::reading_from_cache;
             _lsa_manager.run_in_update_section([this] {
+                position_in_partition old_pos(_next_row.position());
                 auto same_pos = _next_row.maybe_refresh();
                 if (!same_pos) {
-                    _read_context->cache().on_mispopulate(); // FIXME: Insert dummy entry at _upper_bound.
+                    // The entry the cursor stood on went away (e.g. was evicted),
+                    // but the underlying read still covered everything up to
+                    // min(old_pos, _upper_bound). Record that with a dummy entry
+                    // so a repeated scan of this interval stays in cache, instead
+                    // of dropping the population on the floor.
+                    if (can_populate() && (!_ck_ranges_curr->start() || _last_row.refresh(*_snp))) {
+                        position_in_partition::less_compare pos_less(*_schema);
+                        position_in_partition_view end = pos_less(old_pos, _upper_bound) ? old_pos : _upper_bound;
+                        rows_entry::compare less(*_schema);
+                        auto& rows = _snp->version()->partition().clustered_rows();
+                        with_allocator(_snp->region().allocator(), [&] {
+                            auto e = alloc_strategy_unique_ptr<rows_entry>(
+                                current_allocator().construct<rows_entry>(*_schema, end, is_dummy::yes, is_continuous::yes));
+                            // Use _next_row iterator only as a hint, because there could be insertions before end.
+                            auto insert_result = rows.insert_check(_next_row.get_iterator_in_latest_version(), *e, less);
+                            if (insert_result.second) {
+                                clogger.trace("csm {}: inserted dummy at {} after eviction", this, end);
+                                e.release();
+                            } else {
+                                clogger.trace("csm {}: mark {} as continuous after eviction", this, insert_result.first->position());
+                                insert_result.first->set_continuous(true);
+                            }
+                        });
+                    } else {
+                        _read_context->cache().on_mispopulate();
+                    }
                     _next_row_in_range = !after_current_range(_next_row.position());
                     if (!_next_row.continuous()) {
                         start_reading_from_underlying();
@@ -383,6 +419,9 @@ void cache_flat_mutation_reader::maybe_add_to_cache(const clustering_row& cr) {
         if (_read_context->digest_requested()) {
             cr.cells().prepare_hash(*_schema, column_kind::regular_column);
         }
+        if (_schema->is_counter()) {
+            cr.cells().prepare_counter_totals(*_schema, column_kind::regular_column);
+        }
         auto new_entry = alloc_strategy_unique_ptr<rows_entry>(
             current_allocator().construct<rows_entry>(cr.key(), cr.tomb(), cr.marker(), cr.cells()));
         new_entry->set_continuous(false);
@@ -406,6 +445,7 @@ void cache_flat_mutation_reader::maybe_add_to_cache(const clustering_row& cr) {
             _last_row = partition_snapshot_row_weakref(*_snp, it);
         });
     });
+    --_row_population_budget;
 }
 
 inline
@@ -531,6 +571,9 @@ inline
 void cache_flat_mutation_reader::add_to_buffer(const partition_snapshot_row_cursor& row) {
     if (!row.dummy()) {
         _read_context->cache().on_row_hit();
+        if (_row_population_budget) {
+            --_row_population_budget;
+        }
         add_clustering_row_to_buffer(row.row(_read_context->digest_requested()));
     }
 }
@@ -580,6 +623,9 @@ void cache_flat_mutation_reader::maybe_add_to_cache(const static_row& sr) {
             if (_read_context->digest_requested()) {
                 sr.cells().prepare_hash(*_schema, column_kind::static_column);
             }
+            if (_schema->is_counter()) {
+                sr.cells().prepare_counter_totals(*_schema, column_kind::static_column);
+            }
             _snp->version()->partition().static_row().apply(*_schema, column_kind::static_column, sr.cells());
         });
     } else {
@@ -599,7 +645,9 @@ void cache_flat_mutation_reader::maybe_set_static_row_continuous() {
 
 inline
 bool cache_flat_mutation_reader::can_populate() const {
-    return _snp->at_latest_version() && _read_context->cache().phase_of(_read_context->key()) == _read_context->phase();
+    return _row_population_budget > 0
+        && _snp->at_latest_version()
+        && _read_context->cache().phase_of(_read_context->key()) == _read_context->phase();
 }
 
 } // namespace cache
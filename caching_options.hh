@@ -20,6 +20,7 @@
  */
 
 #pragma once
+#include <limits>
 #include <core/sstring.hh>
 #include <boost/lexical_cast.hpp>
 #include "exceptions/exceptions.hh"
@@ -32,8 +33,10 @@ class caching_options {
     // For Origin, the default value for the row is "NONE". However, since our
     // row_cache will cache both keys and rows, we will default to ALL.
     //
-    // FIXME: We don't yet make any changes to our caching policies based on
-    // this (and maybe we shouldn't)
+    // The "keys" option is still accepted only for compatibility and has no
+    // effect; "rows_per_partition" is honored by the cache read path as a cap
+    // on how many rows of a partition get populated (see
+    // cache_flat_mutation_reader).
     static constexpr auto default_key = "ALL";
     static constexpr auto default_row = "ALL";
 
@@ -59,6 +62,19 @@ class caching_options {
     caching_options() : _key_cache(default_key), _row_cache(default_row) {}
 public:
 
+    // How many rows from the head of each partition reads may populate into
+    // the cache. "ALL" places no bound, "NONE" disables row population
+    // altogether (keys are still cached).
+    uint64_t rows_per_partition() const {
+        if (_row_cache == "ALL") {
+            return std::numeric_limits<uint64_t>::max();
+        }
+        if (_row_cache == "NONE") {
+            return 0;
+        }
+        return boost::lexical_cast<unsigned long>(_row_cache);
+    }
+
     std::map<sstring, sstring> to_map() const {
         return {{ "keys", _key_cache }, { "rows_per_partition", _row_cache }};
     }
@@ -23,38 +23,60 @@
 
 #include "seastar/core/file.hh"
 #include "disk-error-handler.hh"
+#include "io_class_tracker.hh"
+#include "disk_device_tracker.hh"
 
 class checked_file_impl : public file_impl {
 public:
 
-    checked_file_impl(const io_error_handler& error_handler, file f)
-            : _error_handler(error_handler), _file(f) {
+    // `device` attributes this file's reads, writes and errors to the device
+    // it lives on (see disk_device_tracker); pass no_device for files where
+    // per-device accounting is not interesting.
+    checked_file_impl(const io_error_handler& error_handler, file f,
+                      disk_device_tracker::device_id device = disk_device_tracker::no_device)
+            : _error_handler(error_handler), _file(f), _device(device) {
         _memory_dma_alignment = f.memory_dma_alignment();
         _disk_read_dma_alignment = f.disk_read_dma_alignment();
         _disk_write_dma_alignment = f.disk_write_dma_alignment();
     }
 
     virtual future<size_t> write_dma(uint64_t pos, const void* buffer, size_t len, const io_priority_class& pc) override {
-        return do_io_check(_error_handler, [&] {
-            return get_file_impl(_file)->write_dma(pos, buffer, len, pc);
+        return io_class_tracker::local().account(pc, io_class_tracker::op_type::write, len, [&] {
+            return disk_device_tracker::local().account_write(_device, [&] {
+                return do_io_check(_error_handler, [&] {
+                    return get_file_impl(_file)->write_dma(pos, buffer, len, pc);
+                });
+            });
         });
     }
 
     virtual future<size_t> write_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc) override {
-        return do_io_check(_error_handler, [&] {
-            return get_file_impl(_file)->write_dma(pos, iov, pc);
+        return io_class_tracker::local().account(pc, io_class_tracker::op_type::write, iovec_length(iov), [&] {
+            return disk_device_tracker::local().account_write(_device, [&] {
+                return do_io_check(_error_handler, [&] {
+                    return get_file_impl(_file)->write_dma(pos, iov, pc);
+                });
+            });
         });
     }
 
     virtual future<size_t> read_dma(uint64_t pos, void* buffer, size_t len, const io_priority_class& pc) override {
-        return do_io_check(_error_handler, [&] {
-            return get_file_impl(_file)->read_dma(pos, buffer, len, pc);
+        return io_class_tracker::local().account(pc, io_class_tracker::op_type::read, len, [&] {
+            return disk_device_tracker::local().account_read(_device, [&] {
+                return do_io_check(_error_handler, [&] {
+                    return get_file_impl(_file)->read_dma(pos, buffer, len, pc);
+                });
+            });
         });
     }
 
     virtual future<size_t> read_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc) override {
-        return do_io_check(_error_handler, [&] {
-            return get_file_impl(_file)->read_dma(pos, iov, pc);
+        return io_class_tracker::local().account(pc, io_class_tracker::op_type::read, iovec_length(iov), [&] {
+            return disk_device_tracker::local().account_read(_device, [&] {
+                return do_io_check(_error_handler, [&] {
+                    return get_file_impl(_file)->read_dma(pos, iov, pc);
+                });
+            });
         });
     }
 
@@ -113,28 +135,43 @@ public:
     }
 
     virtual future<temporary_buffer<uint8_t>> dma_read_bulk(uint64_t offset, size_t range_size, const io_priority_class& pc) override {
-        return do_io_check(_error_handler, [&] {
-            return get_file_impl(_file)->dma_read_bulk(offset, range_size, pc);
+        return io_class_tracker::local().account(pc, io_class_tracker::op_type::read, range_size, [&] {
+            return disk_device_tracker::local().account_read(_device, [&] {
+                return do_io_check(_error_handler, [&] {
+                    return get_file_impl(_file)->dma_read_bulk(offset, range_size, pc);
+                });
+            });
         });
     }
+private:
+    static size_t iovec_length(const std::vector<iovec>& iov) {
+        size_t len = 0;
+        for (auto& v : iov) {
+            len += v.iov_len;
+        }
+        return len;
+    }
 private:
     const io_error_handler& _error_handler;
     file _file;
+    disk_device_tracker::device_id _device;
 };
 
-inline file make_checked_file(const io_error_handler& error_handler, file f)
+inline file make_checked_file(const io_error_handler& error_handler, file f,
+                              disk_device_tracker::device_id device = disk_device_tracker::no_device)
 {
-    return file(::make_shared<checked_file_impl>(error_handler, f));
+    return file(::make_shared<checked_file_impl>(error_handler, f, device));
 }
 
 future<file>
 inline open_checked_file_dma(const io_error_handler& error_handler,
                              sstring name, open_flags flags,
-                             file_open_options options = {})
+                             file_open_options options = {},
+                             disk_device_tracker::device_id device = disk_device_tracker::no_device)
 {
     return do_io_check(error_handler, [&] {
-        return open_file_dma(name, flags, options).then([&] (file f) {
-            return make_ready_future<file>(make_checked_file(error_handler, f));
+        return open_file_dma(name, flags, options).then([&error_handler, device] (file f) {
+            return make_ready_future<file>(make_checked_file(error_handler, f, device));
         });
     });
 }
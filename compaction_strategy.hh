@@ -38,6 +38,7 @@ enum class compaction_strategy_type {
     leveled,
     date_tiered,
     time_window,
+    latency_aware,
 };
 
 class compaction_strategy_impl;
@@ -60,6 +61,10 @@ public:
     // Return a list of sstables to be compacted after applying the strategy.
     compaction_descriptor get_sstables_for_compaction(column_family& cfs, std::vector<shared_sstable> candidates);
 
+    // Return a single sstable worth rewriting alone just to purge its droppable
+    // tombstones, or an empty descriptor if there is none.
+    compaction_descriptor get_garbage_collect_job(column_family& cf, std::vector<shared_sstable> candidates);
+
     std::vector<resharding_descriptor> get_resharding_jobs(column_family& cf, std::vector<shared_sstable> candidates);
 
     // Some strategies may look at the compacted and resulting sstables to
@@ -89,6 +94,8 @@ public:
             return "DateTieredCompactionStrategy";
         case compaction_strategy_type::time_window:
             return "TimeWindowCompactionStrategy";
+        case compaction_strategy_type::latency_aware:
+            return "LatencyAwareCompactionStrategy";
         default:
             throw std::runtime_error("Invalid Compaction Strategy");
         }
@@ -109,6 +116,8 @@ public:
             return compaction_strategy_type::date_tiered;
         } else if (short_name == "TimeWindowCompactionStrategy") {
             return compaction_strategy_type::time_window;
+        } else if (short_name == "LatencyAwareCompactionStrategy") {
+            return compaction_strategy_type::latency_aware;
         } else {
             throw exceptions::configuration_exception(sprint("Unable to find compaction strategy class '%s'", name));
         }
@@ -51,7 +51,11 @@ public:
         , _byte_order_equal(std::all_of(_types.begin(), _types.end(), [] (auto t) {
                 return t->is_byte_order_equal();
             }))
-        , _byte_order_comparable(false)
+        , _byte_order_comparable(std::all_of(_types.begin(), _types.end(), [] (auto t) {
+                return t->is_byte_order_comparable();
+            }) && (_types.size() == 1 || std::none_of(_types.begin(), _types.end(), [] (auto t) {
+                return t->is_reversed();
+            })))
         , _is_reversed(_types.size() == 1 && _types[0]->is_reversed())
     { }
 
@@ -205,11 +209,19 @@ public:
     }
     int compare(bytes_view b1, bytes_view b2) {
         if (_byte_order_comparable) {
+            // Every component compares bytewise, so we can walk the
+            // serialized components directly and let memcmp do the work,
+            // skipping the per-component virtual comparator dispatch. The
+            // length prefixes themselves must not take part in the
+            // comparison: they would make a short component sort before a
+            // longer one regardless of contents.
             if (_is_reversed) {
-                return compare_unsigned(b2, b1);
-            } else {
-                return compare_unsigned(b1, b2);
+                std::swap(b1, b2);
             }
+            return lexicographical_tri_compare(begin(b1), end(b1), begin(b2), end(b2),
+                [] (const bytes_view& v1, const bytes_view& v2) {
+                    return compare_unsigned(v1, v2);
+                });
         }
         return lexicographical_tri_compare(_types.begin(), _types.end(),
             begin(b1), end(b1), begin(b2), end(b2), [] (auto&& type, auto&& v1, auto&& v2) {
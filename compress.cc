@@ -22,6 +22,7 @@
 #include <lz4.h>
 #include <zlib.h>
 #include <snappy-c.h>
+#include <zstd.h>
 
 #include "compress.hh"
 #include "utils/class_registrator.hh"
@@ -61,6 +62,23 @@ public:
     size_t compress_max_size(size_t input_len) const override;
 };
 
+class zstd_processor: public compressor {
+    int _compression_level = 3;
+public:
+    zstd_processor(const opt_getter&);
+
+    size_t uncompress(const char* input, size_t input_len, char* output,
+                    size_t output_len) const override;
+    size_t compress(const char* input, size_t input_len, char* output,
+                    size_t output_len) const override;
+    size_t compress_max_size(size_t input_len) const override;
+
+    std::set<sstring> option_names() const override;
+    std::map<sstring, sstring> options() const override;
+
+    static const sstring COMPRESSION_LEVEL;
+};
+
 compressor::compressor(sstring name)
     : _name(std::move(name))
 {}
@@ -320,6 +338,75 @@ size_t deflate_processor::compress_max_size(size_t input_len) const {
     return res;
 }
 
+const sstring zstd_processor::COMPRESSION_LEVEL = "compression_level";
+
+zstd_processor::zstd_processor(const opt_getter& opts)
+    : compressor(namespace_prefix + "ZstdCompressor") {
+    auto level = opts(COMPRESSION_LEVEL);
+    if (level) {
+        try {
+            _compression_level = std::stoi(*level);
+        } catch (const std::exception& e) {
+            throw exceptions::syntax_exception(sstring("Invalid integer value ") + *level + " for " + COMPRESSION_LEVEL);
+        }
+        if (_compression_level < 1 || _compression_level > ZSTD_maxCLevel()) {
+            throw exceptions::configuration_exception(sprint("%s must be between 1 and %d.", COMPRESSION_LEVEL, ZSTD_maxCLevel()));
+        }
+    }
+}
+
+// The (de)compression contexts are fairly large and not cheap to create, so
+// they are created once per shard and reused for all chunks instead of being
+// allocated on every call.
+static ZSTD_CCtx* zstd_cctx() {
+    static thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> ctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+    if (!ctx) {
+        throw std::runtime_error("zstd compression context allocation failure");
+    }
+    return ctx.get();
+}
+
+static ZSTD_DCtx* zstd_dctx() {
+    static thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> ctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    if (!ctx) {
+        throw std::runtime_error("zstd decompression context allocation failure");
+    }
+    return ctx.get();
+}
+
+size_t zstd_processor::uncompress(const char* input, size_t input_len,
+                char* output, size_t output_len) const {
+    auto ret = ZSTD_decompressDCtx(zstd_dctx(), output, output_len, input, input_len);
+    if (ZSTD_isError(ret)) {
+        throw std::runtime_error(sprint("zstd uncompression failure: %s", ZSTD_getErrorName(ret)));
+    }
+    return ret;
+}
+
+size_t zstd_processor::compress(const char* input, size_t input_len,
+                char* output, size_t output_len) const {
+    auto ret = ZSTD_compressCCtx(zstd_cctx(), output, output_len, input, input_len, _compression_level);
+    if (ZSTD_isError(ret)) {
+        throw std::runtime_error(sprint("zstd compression failure: %s", ZSTD_getErrorName(ret)));
+    }
+    return ret;
+}
+
+size_t zstd_processor::compress_max_size(size_t input_len) const {
+    return ZSTD_compressBound(input_len);
+}
+
+std::set<sstring> zstd_processor::option_names() const {
+    return { COMPRESSION_LEVEL };
+}
+
+std::map<sstring, sstring> zstd_processor::options() const {
+    return { { COMPRESSION_LEVEL, std::to_string(_compression_level) } };
+}
+
+using zstd_registrator = class_registrator<compressor_ptr, zstd_processor, const compressor::opt_getter&>;
+static zstd_registrator zstd_registrator_instance(compressor::namespace_prefix + "ZstdCompressor");
+
 size_t snappy_processor::uncompress(const char* input, size_t input_len,
                 char* output, size_t output_len) const {
     if (snappy_uncompress(input, input_len, output, &output_len)
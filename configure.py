@@ -279,6 +279,8 @@ scylla_tests = [
     'tests/streaming_histogram_test',
     'tests/duration_test',
     'tests/vint_serialization_test',
+    'tests/mc_format_test',
+    'tests/bloom_filter_test',
     'tests/compress_test',
     'tests/chunked_vector_test',
     'tests/loading_cache_test',
@@ -294,7 +296,10 @@ scylla_tests = [
 ]
 
 perf_tests = [
-    'tests/perf/perf_mutation_readers'
+    'tests/perf/perf_mutation_readers',
+    'tests/perf/perf_memtable_insert',
+    'tests/perf/perf_row_cache_reads',
+    'tests/perf/perf_serialization',
 ]
 
 apps = [
@@ -391,6 +396,7 @@ scylla_core = (['database.cc',
                  'counters.cc',                 
                  'compress.cc',
                  'sstables/sstables.cc',
+                 'sstables/mc_format.cc',
                  'sstables/compress.cc',
                  'sstables/row.cc',
                  'sstables/partition.cc',
@@ -461,9 +467,11 @@ scylla_core = (['database.cc',
                  'utils/murmur_hash.cc',
                  'utils/uuid.cc',
                  'utils/big_decimal.cc',
+                 'utils/utf8.cc',
                  'types.cc',
                  'validation.cc',
                  'service/priority_manager.cc',
+                 'service/workload_group.cc',
                  'service/migration_manager.cc',
                  'service/storage_proxy.cc',
                  'cql3/operator.cc',
@@ -503,6 +511,7 @@ scylla_core = (['database.cc',
                  'db/marshal/type_parser.cc',
                  'db/batchlog_manager.cc',
                  'db/view/view.cc',
+                 'db/view/view_builder.cc',
                  'db/view/row_locking.cc',
                  'index/secondary_index_manager.cc',
                  'io/io.cc',
@@ -512,6 +521,7 @@ scylla_core = (['database.cc',
                  'utils/bloom_filter.cc',
                  'utils/bloom_calculations.cc',
                  'utils/rate_limiter.cc',
+                 'utils/cpu_profiler.cc',
                  'utils/file_lock.cc',
                  'utils/dynamic_bitset.cc',
                  'utils/managed_bytes.cc',
@@ -600,8 +610,11 @@ scylla_core = (['database.cc',
                  'range_tombstone.cc',
                  'range_tombstone_list.cc',
                  'disk-error-handler.cc',
+                 'io_class_tracker.cc',
+                 'disk_device_tracker.cc',
                  'duration.cc',
                  'vint-serialization.cc',
+                 'utils/crc.cc',
                  'utils/arch/powerpc/crc32-vpmsum/crc32_wrapper.cc',
                  ]
                 + [Antlr3Grammar('cql3/Cql.g')]
@@ -639,7 +652,11 @@ api = ['api/api.cc',
        'api/api-doc/stream_manager.json',
        'api/stream_manager.cc',
        'api/api-doc/system.json',
-       'api/system.cc'
+       'api/system.cc',
+       'api/api-doc/table_scan.json',
+       'api/table_scan.cc',
+       'api/api-doc/io_diagnostics.json',
+       'api/io_diagnostics.cc'
        ]
 
 idls = ['idl/gossip_digest.idl.hh',
@@ -701,6 +718,8 @@ pure_boost_tests = set([
     'tests/streaming_histogram_test',
     'tests/duration_test',
     'tests/vint_serialization_test',
+    'tests/mc_format_test',
+    'tests/bloom_filter_test',
     'tests/compress_test',
     'tests/chunked_vector_test',
     'tests/big_decimal_test',
@@ -921,7 +940,7 @@ for mode in build_modes:
 seastar_deps = 'practically_anything_can_change_so_lets_run_it_every_time_and_restat.'
 
 args.user_cflags += " " + pkg_config("--cflags", "jsoncpp")
-libs = ' '.join([maybe_static(args.staticyamlcpp, '-lyaml-cpp'), '-llz4', '-lz', '-lsnappy', pkg_config("--libs", "jsoncpp"),
+libs = ' '.join([maybe_static(args.staticyamlcpp, '-lyaml-cpp'), '-llz4', '-lz', '-lsnappy', '-lzstd', pkg_config("--libs", "jsoncpp"),
                  maybe_static(args.staticboost, '-lboost_filesystem'), ' -lcrypt', ' -lcryptopp',
                  maybe_static(args.staticboost, '-lboost_date_time'),
                 ])
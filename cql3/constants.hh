@@ -75,6 +75,23 @@ public:
         virtual sstring to_string() const override { return to_hex(*_bytes); }
     };
 
+    /**
+     * A value bound from the request frame. Unlike \c value it does not own
+     * the bytes but keeps a view into the frame buffer. The frame stays alive
+     * for at least as long as the query_options which produced the view, i.e.
+     * for the duration of the statement execution, which is also the lifetime
+     * of any terminal produced by bind(). get() materializes an owned copy
+     * for the rare callers that retain the value past execution.
+     */
+    class bound_value final : public terminal {
+        cql3::raw_value_view _view;
+    public:
+        explicit bound_value(cql3::raw_value_view view) : _view(view) {}
+        virtual cql3::raw_value get(const query_options& options) override { return cql3::raw_value::make_value(_view); }
+        virtual cql3::raw_value_view bind_and_get(const query_options& options) override { return _view; }
+        virtual sstring to_string() const override { return _view ? to_hex(*_view) : sstring("null"); }
+    };
+
     static thread_local const ::shared_ptr<value> UNSET_VALUE;
 
     class null_literal final : public term::raw {
@@ -189,11 +206,13 @@ public:
         }
 
         virtual ::shared_ptr<terminal> bind(const query_options& options) override {
-            auto bytes = bind_and_get(options);
-            if (!bytes) {
+            auto value = bind_and_get(options);
+            if (!value) {
                 return ::shared_ptr<terminal>{};
             }
-            return ::make_shared<constants::value>(std::move(cql3::raw_value::make_value(to_bytes(*bytes))));
+            // The view points into the request frame, which outlives the
+            // bound terminal, so there is no need to copy the value out.
+            return ::make_shared<constants::bound_value>(value);
         }
     };
 
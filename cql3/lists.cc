@@ -475,11 +475,11 @@ lists::discarder_by_index::execute(mutation& m, const clustering_key_prefix& pre
     }
 
     auto ltype = static_pointer_cast<const list_type_impl>(column.type);
-    auto cvalue = dynamic_pointer_cast<constants::value>(index);
-    assert(cvalue);
+    auto index_value = index->bind_and_get(params._options);
+    assert(index_value);
 
     auto&& existing_list_opt = params.get_prefetched_list(m.key().view(), prefix.view(), column);
-    int32_t idx = read_simple_exactly<int32_t>(*cvalue->_bytes);
+    int32_t idx = read_simple_exactly<int32_t>(*index_value);
     if (!existing_list_opt) {
         throw exceptions::invalid_request_exception("Attempted to delete an element from a list which is null");
     }
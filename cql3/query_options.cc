@@ -145,6 +145,11 @@ size_t query_options::get_values_count() const
 cql3::raw_value_view query_options::make_temporary(cql3::raw_value value) const
 {
     if (value) {
+        if (_scratch_arena) {
+            auto p = static_cast<int8_t*>(_scratch_arena->alloc(value->size(), 1));
+            std::copy(value->begin(), value->end(), p);
+            return cql3::raw_value_view::make_value(bytes_view{p, value->size()});
+        }
         _temporaries.emplace_back(value->begin(), value->end());
         auto& temporary = _temporaries.back();
         return cql3::raw_value_view::make_value(bytes_view{temporary.data(), temporary.size()});
@@ -152,6 +157,16 @@ cql3::raw_value_view query_options::make_temporary(cql3::raw_value value) const
     return cql3::raw_value_view::make_null();
 }
 
+void query_options::set_scratch_arena(utils::bump_arena& arena)
+{
+    _scratch_arena = &arena;
+    if (_batch_options) {
+        for (auto& bo : *_batch_options) {
+            bo.set_scratch_arena(arena);
+        }
+    }
+}
+
 bool query_options::skip_metadata() const
 {
     return _skip_metadata;
@@ -51,6 +51,7 @@
 #include "cql3/column_identifier.hh"
 #include "cql3/values.hh"
 #include "cql_serialization_format.hh"
+#include "utils/bump_arena.hh"
 
 namespace cql3 {
 
@@ -74,6 +75,7 @@ private:
     std::vector<cql3::raw_value> _values;
     std::vector<cql3::raw_value_view> _value_views;
     mutable std::vector<std::vector<int8_t>> _temporaries;
+    utils::bump_arena* _scratch_arena = nullptr;
     const bool _skip_metadata;
     const specific_options _options;
     cql_serialization_format _cql_serialization_format;
@@ -171,6 +173,11 @@ public:
     // Mainly for the sake of BatchQueryOptions
     const specific_options& get_specific_options() const;
     const query_options& for_statement(size_t i) const;
+    // Makes make_temporary() allocate from the given arena instead of from
+    // _temporaries. The arena must outlive this object; the transport layer
+    // passes the per-request arena of the owning query_state, so temporaries
+    // are freed wholesale when the response is sent.
+    void set_scratch_arena(utils::bump_arena& arena);
     void prepare(const std::vector<::shared_ptr<column_specification>>& specs);
 private:
     void fill_value_views();
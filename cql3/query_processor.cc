@@ -105,7 +105,13 @@ query_processor::query_processor(distributed<service::storage_proxy>& proxy, dis
                     sm::make_derive(
                             "statements_prepared",
                             _stats.prepare_invocations,
-                            sm::description("Counts a total number of parsed CQL requests."))});
+                            sm::description("Counts a total number of parsed CQL requests.")),
+
+                    sm::make_derive(
+                            "statements_parser_skips",
+                            _stats.parser_skips,
+                            sm::description(
+                                    "Counts statements, prepared or not, which reused a retained parse tree instead of re-parsing the query."))});
 
     _metrics.add_group(
             "cql",
@@ -307,7 +313,33 @@ prepared_cache_key_type query_processor::compute_thrift_id(
 
 std::unique_ptr<prepared_statement>
 query_processor::get_statement(const sstring_view& query, const service::client_state& client_state) {
-    ::shared_ptr<raw::parsed_statement> statement = parse_statement(query);
+    // Unprepared statements go through the same retained parse trees the
+    // re-prepare path uses: a legacy client which keeps sending the same
+    // literal statement then pays an MD5 of the query string per request
+    // instead of a full ANTLR parse. Keying on (query, keyspace), like the
+    // prepared ids do, keeps a tree from being shared across keyspaces
+    // with different meanings of the same unqualified table name.
+    auto key = compute_id(query, client_state.get_raw_keyspace());
+    return get_statement_for_prepare(key, sstring(query), client_state);
+}
+
+std::unique_ptr<prepared_statement>
+query_processor::get_statement_for_prepare(
+        const prepared_cache_key_type& key,
+        const sstring& query_string,
+        const service::client_state& client_state) {
+    ::shared_ptr<raw::parsed_statement> statement;
+    auto it = _parse_trees.find(key.key());
+    bool retained = it != _parse_trees.end();
+    if (retained) {
+        // Typically a re-preparation after a schema change invalidated the
+        // prepared statement: the parse tree is still good, only the
+        // binding/validation phase below needs to run again.
+        statement = it->second;
+        ++_stats.parser_skips;
+    } else {
+        statement = parse_statement(query_string);
+    }
 
     // Set keyspace for statement that require login
     auto cf_stmt = dynamic_pointer_cast<raw::cf_statement>(statement);
@@ -315,7 +347,14 @@ query_processor::get_statement(const sstring_view& query, const service::client_
         cf_stmt->prepare_keyspace(client_state);
     }
     ++_stats.prepare_invocations;
-    return statement->prepare(_db.local(), _cql_stats);
+    auto prepared = statement->prepare(_db.local(), _cql_stats);
+    if (!retained && statement->is_reusable()) {
+        if (_parse_trees.size() >= max_retained_parse_trees) {
+            _parse_trees.clear();
+        }
+        _parse_trees.emplace(key.key(), std::move(statement));
+    }
+    return prepared;
 }
 
 ::shared_ptr<raw::parsed_statement>
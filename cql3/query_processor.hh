@@ -107,6 +107,7 @@ private:
 
     struct stats {
         uint64_t prepare_invocations = 0;
+        uint64_t parser_skips = 0;
     } _stats;
 
     cql_stats _cql_stats;
@@ -122,6 +123,17 @@ private:
     // don't bother with expiration on those.
     std::unordered_map<sstring, std::unique_ptr<statements::prepared_statement>> _internal_statements;
 
+    // Parse trees of reusable statements, keyed like _prepared_cache. A
+    // schema change invalidates prepared statements, but the parse tree is
+    // schema-independent, so re-preparation only needs to re-run the cheap
+    // binding/validation phase instead of going through the parser again
+    // (see statements::raw::parsed_statement::is_reusable()). Unprepared
+    // statements consult the same map: clients which keep sending the same
+    // literal statement then pay an MD5 per request instead of a full
+    // ANTLR parse. Cleared wholesale when over capacity.
+    static constexpr size_t max_retained_parse_trees = 8192;
+    std::unordered_map<prepared_cache_key_type::cache_key_type, ::shared_ptr<statements::raw::parsed_statement>, utils::tuple_hash> _parse_trees;
+
 public:
     static const sstring CQL_VERSION;
 
@@ -248,6 +260,14 @@ public:
             const std::experimental::string_view& query,
             const service::client_state& client_state);
 
+    // Like get_statement(), but takes the precomputed cache key under which
+    // a parse tree of the same query may have been retained, avoiding a
+    // second hash of the query string on the prepare path.
+    std::unique_ptr<statements::prepared_statement> get_statement_for_prepare(
+            const prepared_cache_key_type& key,
+            const sstring& query_string,
+            const service::client_state& client_state);
+
     friend class migration_subscriber;
 
 private:
@@ -308,8 +328,8 @@ private:
                 id_gen(query_string, client_state.get_raw_keyspace()),
                 std::move(query_string),
                 [this, &client_state, &id_getter](const prepared_cache_key_type& key, const sstring& query_string) {
-            return _prepared_cache.get(key, [this, &query_string, &client_state] {
-                auto prepared = get_statement(query_string, client_state);
+            return _prepared_cache.get(key, [this, &key, &query_string, &client_state] {
+                auto prepared = get_statement_for_prepare(key, query_string, client_state);
                 auto bound_terms = prepared->statement->get_bound_terms();
                 if (bound_terms > std::numeric_limits<uint16_t>::max()) {
                     throw exceptions::invalid_request_exception(
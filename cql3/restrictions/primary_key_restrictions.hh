@@ -54,6 +54,9 @@
 #include "core/shared_ptr.hh"
 
 namespace cql3 {
+
+class term;
+
 namespace restrictions {
 
 /**
@@ -78,11 +81,29 @@ class primary_key_restrictions: public abstract_restriction,
 public:
     typedef typename range_type_for<ValueType>::type bounds_range_type;
 
+    /**
+     * One step of a compiled bound-extraction plan: the EQ value term
+     * restricting a single key component, paired with that component's
+     * definition (kept for error reporting).
+     */
+    using eq_bind_op = std::pair<const column_definition*, ::shared_ptr<term>>;
+
     virtual ::shared_ptr<primary_key_restrictions<ValueType>> merge_to(schema_ptr, ::shared_ptr<restriction> restriction) {
         merge_with(restriction);
         return this->shared_from_this();
     }
 
+    /**
+     * Lowers this restriction set into a flat list of EQ bind ops, one per
+     * restricted component in ring order, so that prepared statement
+     * execution can bind values in a tight loop instead of re-walking the
+     * restriction graph. Returns an empty list for shapes which cannot be
+     * lowered (slices, IN, token restrictions, non-contiguous components).
+     */
+    virtual std::vector<eq_bind_op> eq_bind_ops() const {
+        return {};
+    }
+
     virtual std::vector<ValueType> values_as_keys(const query_options& options) const = 0;
     virtual std::vector<bounds_range_type> bounds_ranges(const query_options& options) const = 0;
 
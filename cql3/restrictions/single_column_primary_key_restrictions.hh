@@ -154,6 +154,21 @@ public:
         do_merge_with(::static_pointer_cast<single_column_restriction>(restriction));
     }
 
+    virtual std::vector<typename primary_key_restrictions<ValueType>::eq_bind_op> eq_bind_ops() const override {
+        std::vector<typename primary_key_restrictions<ValueType>::eq_bind_op> ops;
+        if (!_restrictions->is_all_eq()) {
+            return ops;
+        }
+        ops.reserve(_restrictions->size());
+        for (auto&& e : _restrictions->restrictions()) {
+            if (!e.second->is_EQ() || ops.size() != _schema->position(*e.first)) {
+                return {};
+            }
+            ops.emplace_back(e.first, ::static_pointer_cast<single_column_restriction::EQ>(e.second)->get_value());
+        }
+        return ops;
+    }
+
     virtual std::vector<ValueType> values_as_keys(const query_options& options) const override {
         std::vector<std::vector<bytes_opt>> value_vector;
         value_vector.reserve(_restrictions->size());
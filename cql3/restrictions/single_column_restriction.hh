@@ -129,6 +129,10 @@ public:
         , _value(std::move(value))
     { }
 
+    ::shared_ptr<term> get_value() const {
+        return _value;
+    }
+
     virtual bool uses_function(const sstring& ks_name, const sstring& function_name) const override {
         return abstract_restriction::term_uses_function(_value, ks_name, function_name);
     }
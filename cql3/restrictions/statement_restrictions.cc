@@ -274,6 +274,17 @@ statement_restrictions::statement_restrictions(database& db,
     if (_uses_secondary_indexing && !for_view) {
         validate_secondary_index_selections(selects_only_static_columns);
     }
+
+    // Lower the key restrictions into flat bind plans when they have the
+    // point lookup shape, so that execution doesn't have to traverse the
+    // restriction graph again. The partition key plan is only valid when it
+    // covers the whole key; a clustering prefix plan is valid as is.
+    if (!_uses_secondary_indexing) {
+        if (!has_partition_key_unrestricted_components()) {
+            _pk_bind_plan = _partition_key_restrictions->eq_bind_ops();
+        }
+        _ck_bind_plan = _clustering_columns_restrictions->eq_bind_ops();
+    }
 }
 
 void statement_restrictions::add_restriction(::shared_ptr<restriction> restriction) {
@@ -378,6 +389,24 @@ dht::partition_range_vector statement_restrictions::get_partition_key_ranges(con
     if (_partition_key_restrictions->empty()) {
         return {dht::partition_range::make_open_ended_both_sides()};
     }
+    if (!_pk_bind_plan.empty()) {
+        std::vector<bytes> components;
+        components.reserve(_pk_bind_plan.size());
+        for (auto&& op : _pk_bind_plan) {
+            auto val = to_bytes_opt(op.second->bind_and_get(options));
+            if (!val) {
+                throw exceptions::invalid_request_exception(sprint("Invalid null value for partition key part %s",
+                    op.first->name_as_text()));
+            }
+            components.emplace_back(std::move(*val));
+        }
+        auto key = partition_key::from_exploded(*_schema, std::move(components));
+        auto token = dht::global_partitioner().get_token(*_schema, key);
+        dht::partition_range_vector ranges;
+        ranges.emplace_back(dht::partition_range::make_singular(
+            dht::ring_position(std::move(token), std::move(key))));
+        return ranges;
+    }
     return _partition_key_restrictions->bounds_ranges(options);
 }
 
@@ -385,6 +414,20 @@ std::vector<query::clustering_range> statement_restrictions::get_clustering_boun
     if (_clustering_columns_restrictions->empty()) {
         return {query::clustering_range::make_open_ended_both_sides()};
     }
+    if (!_ck_bind_plan.empty()) {
+        std::vector<bytes> components;
+        components.reserve(_ck_bind_plan.size());
+        for (auto&& op : _ck_bind_plan) {
+            auto val = to_bytes_opt(op.second->bind_and_get(options));
+            if (!val) {
+                throw exceptions::invalid_request_exception(sprint("Invalid null value for clustering key part %s",
+                    op.first->name_as_text()));
+            }
+            components.emplace_back(std::move(*val));
+        }
+        return {query::clustering_range::make_singular(
+            clustering_key_prefix::from_exploded(*_schema, std::move(components)))};
+    }
     return _clustering_columns_restrictions->bounds_ranges(options);
 }
 
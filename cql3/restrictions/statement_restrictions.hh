@@ -101,6 +101,19 @@ private:
      */
     bool _is_key_range = false;
 
+    /**
+     * Compiled plan for the partition key of point lookups: one EQ bind op
+     * per component, in ring order. Compiled once at prepare time; empty
+     * when the partition key restrictions cannot be lowered, in which case
+     * execution falls back to the generic restriction traversal.
+     */
+    std::vector<primary_key_restrictions<partition_key>::eq_bind_op> _pk_bind_plan;
+
+    /**
+     * Same as _pk_bind_plan, for an all-EQ prefix of the clustering key.
+     */
+    std::vector<primary_key_restrictions<clustering_key_prefix>::eq_bind_op> _ck_bind_plan;
+
 public:
     /**
      * Creates a new empty <code>StatementRestrictions</code>.
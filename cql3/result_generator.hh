@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/distributed.hh"
+
+#include "schema.hh"
+#include "query-request.hh"
+#include "query-result.hh"
+#include "query-result-reader.hh"
+#include "cql3/result_set.hh"
+#include "cql3/selection/selection.hh"
+
+namespace cql3 {
+
+/// Serialized form of a page of query results.
+///
+/// Wraps the query::result a page was read from and can emit the page's rows
+/// in the CQL wire format straight from it, without building the intermediate
+/// cql3::result_set. Valid only for trivial selections
+/// (selection::is_trivial()), where the rows the result_set_builder would
+/// produce are exactly the cells its visitor is fed, in feed order.
+///
+/// The wire visitor passed to visit() needs a single member:
+///
+///   void write_value(std::experimental::optional<bytes_view>);
+///
+/// called once per cell, in row-major order; a disengaged optional denotes
+/// a null cell. The number of rows that will be emitted is row_count().
+class result_generator {
+    schema_ptr _schema;
+    foreign_ptr<lw_shared_ptr<query::result>> _result;
+    lw_shared_ptr<const query::read_command> _command;
+    ::shared_ptr<const selection::selection> _selection;
+    uint32_t _row_count;
+    cql_serialization_format _serialization_format;
+    gc_clock::time_point _now;
+private:
+    // Implements the ResultVisitor concept from query.hh, forwarding each
+    // cell to the wire visitor. Mirrors selection::result_set_builder::visitor,
+    // which defines the row layout the client expects.
+    template<typename WireVisitor>
+    class cell_emitter {
+        const schema& _schema;
+        const selection::selection& _selection;
+        WireVisitor& _visitor;
+        uint32_t _row_count;
+        std::vector<bytes> _partition_key;
+        std::vector<bytes> _clustering_key;
+    private:
+        void write_null() {
+            _visitor.write_value(std::experimental::optional<bytes_view>());
+        }
+        void write_cell(const column_definition& def, query::result_row_view::iterator_type& i) {
+            if (def.type->is_multi_cell()) {
+                _visitor.write_value(i.next_collection_cell());
+            } else {
+                auto cell = i.next_atomic_cell();
+                if (cell) {
+                    _visitor.write_value(cell->value());
+                } else {
+                    write_null();
+                }
+            }
+        }
+    public:
+        cell_emitter(const schema& s, const selection::selection& selection, WireVisitor& visitor)
+            : _schema(s), _selection(selection), _visitor(visitor), _row_count(0) {
+        }
+        void accept_new_partition(const partition_key& key, uint32_t row_count) {
+            _partition_key = key.explode(_schema);
+            _row_count = row_count;
+        }
+        void accept_new_partition(uint32_t row_count) {
+            _row_count = row_count;
+        }
+        void accept_new_row(const clustering_key& key,
+                const query::result_row_view& static_row,
+                const query::result_row_view& row) {
+            _clustering_key = key.explode(_schema);
+            accept_new_row(static_row, row);
+        }
+        void accept_new_row(const query::result_row_view& static_row,
+                const query::result_row_view& row) {
+            auto static_row_iterator = static_row.iterator();
+            auto row_iterator = row.iterator();
+            for (auto&& def : _selection.get_columns()) {
+                switch (def->kind) {
+                case column_kind::partition_key:
+                    _visitor.write_value(bytes_view(_partition_key[def->component_index()]));
+                    break;
+                case column_kind::clustering_key:
+                    if (_clustering_key.size() > def->component_index()) {
+                        _visitor.write_value(bytes_view(_clustering_key[def->component_index()]));
+                    } else {
+                        write_null();
+                    }
+                    break;
+                case column_kind::regular_column:
+                    write_cell(*def, row_iterator);
+                    break;
+                case column_kind::static_column:
+                    write_cell(*def, static_row_iterator);
+                    break;
+                default:
+                    assert(0);
+                }
+            }
+        }
+        void accept_partition_end(const query::result_row_view& static_row) {
+            if (_row_count == 0) {
+                auto static_row_iterator = static_row.iterator();
+                for (auto&& def : _selection.get_columns()) {
+                    if (def->is_partition_key()) {
+                        _visitor.write_value(bytes_view(_partition_key[def->component_index()]));
+                    } else if (def->is_static()) {
+                        write_cell(*def, static_row_iterator);
+                    } else {
+                        write_null();
+                    }
+                }
+            }
+        }
+    };
+public:
+    result_generator(schema_ptr s, foreign_ptr<lw_shared_ptr<query::result>> result,
+            lw_shared_ptr<const query::read_command> cmd, ::shared_ptr<const selection::selection> selection,
+            uint32_t row_count, cql_serialization_format sf, gc_clock::time_point now)
+        : _schema(std::move(s))
+        , _result(std::move(result))
+        , _command(std::move(cmd))
+        , _selection(std::move(selection))
+        , _row_count(row_count)
+        , _serialization_format(sf)
+        , _now(now)
+    { }
+
+    uint32_t row_count() const {
+        return _row_count;
+    }
+
+    template<typename WireVisitor>
+    void visit(WireVisitor&& visitor) const {
+        cell_emitter<std::remove_reference_t<WireVisitor>> emitter(*_schema, *_selection, visitor);
+        query::result_view::consume(*_result, _command->slice, emitter);
+    }
+
+    // Fallback for consumers which want the materialized rows, e.g. internal
+    // queries. Costs what the non-generator path would have.
+    std::unique_ptr<result_set> materialize() const {
+        selection::result_set_builder builder(*_selection, _now, _serialization_format);
+        selection::result_set_builder::visitor v(builder, *_schema, *_selection);
+        query::result_view::consume(*_result, _command->slice, v);
+        return builder.build();
+    }
+};
+
+}
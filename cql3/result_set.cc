@@ -129,9 +129,10 @@ const std::vector<uint16_t>& prepared_metadata::partition_key_bind_indices() con
 
 result_set::result_set(std::vector<::shared_ptr<column_specification>> metadata_)
     : _metadata(::make_shared<metadata>(std::move(metadata_)))
+    , _metadata_unshared(true)
 { }
 
-result_set::result_set(::shared_ptr<metadata> metadata)
+result_set::result_set(::shared_ptr<const metadata> metadata)
     : _metadata(std::move(metadata))
 { }
 
@@ -169,7 +170,13 @@ void result_set::trim(size_t limit) {
 }
 
 metadata& result_set::get_metadata() {
-    return *_metadata;
+    if (!_metadata_unshared) {
+        _metadata = ::make_shared<metadata>(*_metadata);
+        _metadata_unshared = true;
+    }
+    // Safe: we hold the only reference to a copy we just made, or were
+    // constructed with a freshly built metadata object.
+    return const_cast<metadata&>(*_metadata);
 }
 
 const metadata& result_set::get_metadata() const {
@@ -133,12 +133,16 @@ public:
 
 class result_set {
 public:
-    ::shared_ptr<metadata> _metadata;
+    // Shared with the prepared statement's selection until a mutation (e.g.
+    // attaching paging state) forces an unshare; see get_metadata().
+    ::shared_ptr<const metadata> _metadata;
     std::deque<std::vector<bytes_opt>> _rows;
+private:
+    bool _metadata_unshared = false;
 public:
     result_set(std::vector<::shared_ptr<column_specification>> metadata_);
 
-    result_set(::shared_ptr<metadata> metadata);
+    result_set(::shared_ptr<const metadata> metadata);
 
     size_t size() const;
 
@@ -157,6 +161,10 @@ public:
         std::sort(_rows.begin(), _rows.end(), std::ref(cmp));
     }
 
+    // Unshares the metadata on first call, so that result sets built for
+    // prepared statement executions can reference the statement's cached
+    // metadata object without copying it until someone actually needs to
+    // modify it.
     metadata& get_metadata();
 
     const metadata& get_metadata() const;
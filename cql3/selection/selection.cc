@@ -106,6 +106,9 @@ public:
 
     virtual bool is_wildcard() const override { return _is_wildcard; }
     virtual bool is_aggregate() const override { return false; }
+    // simple_selectors move the input row to the output unchanged, so the
+    // output rows are exactly the cells the builder's visitor is fed.
+    virtual bool is_trivial() const override { return true; }
 protected:
     class simple_selectors : public selectors {
     private:
@@ -252,7 +255,9 @@ selection::collect_metadata(schema_ptr schema, const std::vector<::shared_ptr<ra
 }
 
 result_set_builder::result_set_builder(const selection& s, gc_clock::time_point now, cql_serialization_format sf)
-    : _result_set(std::make_unique<result_set>(::make_shared<metadata>(*(s.get_result_metadata()))))
+    // The metadata object is shared with the selection, not copied; the
+    // result set unshares it if a mutation is ever needed.
+    : _result_set(std::make_unique<result_set>(s.get_result_metadata()))
     , _selectors(s.new_selectors())
     , _now(now)
     , _cql_serialization_format(sf)
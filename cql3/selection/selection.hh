@@ -98,6 +98,14 @@ public:
         return false;
     }
 
+    // True when the rows result_set_builder would produce are exactly the
+    // cells its visitor is fed, in feed order. Such a selection allows a
+    // result page to be serialized to the wire straight from query::result,
+    // without materializing a cql3::result_set (see cql3::result_generator).
+    virtual bool is_trivial() const {
+        return false;
+    }
+
     /**
      * Checks if this selection contains static columns.
      * @return <code>true</code> if this selection contains static columns, <code>false</code> otherwise;
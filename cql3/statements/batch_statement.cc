@@ -109,8 +109,26 @@ uint32_t batch_statement::get_bound_terms()
 
 future<> batch_statement::check_access(const service::client_state& state)
 {
-    return parallel_for_each(_statements.begin(), _statements.end(), [&state](auto&& s) {
-        return s->check_access(state);
+    // Large batches from bulk loaders commonly repeat a single table
+    // hundreds of times. modification_statement::check_access() depends
+    // only on the statement's table and whether it has conditions, so
+    // checking once per distinct (table, conditions) combination amortizes
+    // the permission lookups over the whole batch.
+    std::vector<modification_statement*> distinct;
+    for (auto&& s : _statements) {
+        auto dup = boost::algorithm::any_of(distinct, [&s] (auto&& d) {
+            return d->keyspace() == s->keyspace()
+                    && d->column_family() == s->column_family()
+                    && d->has_conditions() == s->has_conditions();
+        });
+        if (!dup) {
+            distinct.push_back(s.get());
+        }
+    }
+    return do_with(std::move(distinct), [&state] (auto& distinct) {
+        return parallel_for_each(distinct, [&state] (auto&& s) {
+            return s->check_access(state);
+        });
     });
 }
 
@@ -169,9 +187,13 @@ void batch_statement::validate()
 
 void batch_statement::validate(distributed<service::storage_proxy>& proxy, const service::client_state& state)
 {
+    if (_statements_validated) {
+        return;
+    }
     for (auto&& s : _statements) {
         s->validate(proxy, state);
     }
+    _statements_validated = true;
 }
 
 const std::vector<shared_ptr<modification_statement>>& batch_statement::get_statements()
@@ -72,6 +72,10 @@ private:
     std::vector<shared_ptr<modification_statement>> _statements;
     std::unique_ptr<attributes> _attrs;
     bool _has_conditions;
+    // The per-statement checks in validate(proxy, state) depend only on the
+    // prepared statements, so they are run once and the result is remembered
+    // for subsequent executions of the same prepared batch.
+    bool _statements_validated = false;
     cql_stats& _stats;
 public:
     /**
@@ -53,12 +53,16 @@ parsed_statement::~parsed_statement()
 { }
 
 shared_ptr<variable_specifications> parsed_statement::get_bound_variables() {
-    return _variables;
+    // A fresh instance per call: preparation collects marker specifications
+    // into it and then moves them out into the prepared statement, so a
+    // shared instance would not survive a second prepare() of the same
+    // parse tree (see is_reusable()).
+    return ::make_shared<variable_specifications>(_bound_names);
 }
 
 // Used by the parser and preparable statement
 void parsed_statement::set_bound_variables(const std::vector<::shared_ptr<column_identifier>>& bound_names) {
-    _variables = ::make_shared<variable_specifications>(bound_names);
+    _bound_names = bound_names;
 }
 
 bool parsed_statement::uses_function(const sstring& ks_name, const sstring& function_name) const {
@@ -85,6 +85,8 @@ public:
     }
 
     virtual std::unique_ptr<prepared> prepare(database& db, cql_stats& stats) override;
+
+    virtual bool is_reusable() const override { return true; }
 };
 
 }
@@ -61,7 +61,7 @@ namespace raw {
 
 class parsed_statement {
 private:
-    ::shared_ptr<variable_specifications> _variables;
+    std::vector<::shared_ptr<column_identifier>> _bound_names;
 
 public:
     using prepared = statements::prepared_statement;
@@ -73,6 +73,13 @@ public:
 
     virtual std::unique_ptr<prepared_statement> prepare(database& db, cql_stats& stats) = 0;
 
+    // Whether prepare() may be called on this parse tree more than once.
+    // The query processor retains reusable parse trees so that
+    // re-preparation after a schema change skips the parser and only
+    // re-runs the binding/validation phase. Statement types whose
+    // prepare() consumes parse-tree state must return false.
+    virtual bool is_reusable() const { return false; }
+
     virtual bool uses_function(const sstring& ks_name, const sstring& function_name) const;
 };
 
@@ -75,13 +75,16 @@ public:
         const orderings_type _orderings;
         const bool _is_distinct;
         const bool _allow_filtering;
+        const bool _bypass_cache;
     public:
         parameters();
         parameters(orderings_type orderings,
             bool is_distinct,
-            bool allow_filtering);
+            bool allow_filtering,
+            bool bypass_cache = false);
         bool is_distinct();
         bool allow_filtering();
+        bool bypass_cache() const;
         orderings_type const& orderings();
     };
     template<typename T>
@@ -105,6 +108,8 @@ public:
         return prepare(db, stats, false);
     }
     std::unique_ptr<prepared> prepare(database& db, cql_stats& stats, bool for_view);
+
+    virtual bool is_reusable() const override { return true; }
 private:
     ::shared_ptr<restrictions::statement_restrictions> prepare_restrictions(
         database& db,
@@ -64,14 +64,17 @@ thread_local const shared_ptr<select_statement::parameters> select_statement::_d
 select_statement::parameters::parameters()
     : _is_distinct{false}
     , _allow_filtering{false}
+    , _bypass_cache{false}
 { }
 
 select_statement::parameters::parameters(orderings_type orderings,
                                          bool is_distinct,
-                                         bool allow_filtering)
+                                         bool allow_filtering,
+                                         bool bypass_cache)
     : _orderings{std::move(orderings)}
     , _is_distinct{is_distinct}
     , _allow_filtering{allow_filtering}
+    , _bypass_cache{bypass_cache}
 { }
 
 bool select_statement::parameters::is_distinct() {
@@ -82,6 +85,10 @@ bool select_statement::parameters::allow_filtering() {
     return _allow_filtering;
 }
 
+bool select_statement::parameters::bypass_cache() const {
+    return _bypass_cache;
+}
+
 select_statement::parameters::orderings_type const& select_statement::parameters::orderings() {
     return _orderings;
 }
@@ -106,6 +113,9 @@ select_statement::select_statement(schema_ptr schema,
     , _stats(stats)
 {
     _opts = _selection->get_query_options();
+    if (_parameters->bypass_cache()) {
+        _opts.set(query::partition_slice::option::bypass_cache);
+    }
 }
 
 bool select_statement::uses_function(const sstring& ks_name, const sstring& function_name) const {
@@ -258,6 +268,13 @@ select_statement::do_execute(distributed<service::storage_proxy>& proxy,
     auto aggregate = _selection->is_aggregate();
     if (aggregate && page_size <= 0) {
         page_size = DEFAULT_COUNT_PAGE_SIZE;
+        // count(*)-style aggregates select no cell values, so each row on the
+        // wire is just its key data. Larger internal pages are cheap then and
+        // save round trips; replicas remain protected by the result memory
+        // limit, which turns an oversized page into a short read.
+        if (_selection->get_columns().empty()) {
+            page_size *= 10;
+        }
     }
 
     auto key_ranges = _restrictions->get_partition_key_ranges(options);
@@ -295,6 +312,27 @@ select_statement::do_execute(distributed<service::storage_proxy>& proxy,
                         " you must either remove the ORDER BY or the IN and sort client side, or disable paging for this query");
     }
 
+    if (_selection->is_trivial()) {
+        // Serve the page in serialized form: the transport layer writes the
+        // rows to the response frame straight from the query::result instead
+        // of round-tripping them through a materialized cql3::result_set.
+        return p->fetch_page_generator(page_size, now).then(
+                [this, p](cql3::result_generator generator) {
+            ::shared_ptr<const metadata> meta = _selection->get_result_metadata();
+            if (!p->is_exhausted()) {
+                // Only a page that needs paging state attached pays for a
+                // copy of the metadata; the final (or only) page shares the
+                // statement's cached object.
+                auto m = ::make_shared<metadata>(*meta);
+                m->set_has_more_pages(p->state());
+                meta = std::move(m);
+            }
+
+            auto msg = ::make_shared<cql_transport::messages::result_message::rows>(std::move(generator), std::move(meta));
+            return make_ready_future<shared_ptr<cql_transport::messages::result_message>>(std::move(msg));
+        });
+    }
+
     return p->fetch_page(page_size, now).then(
             [this, p, &options, limit, now](std::unique_ptr<cql3::result_set> rs) {
 
@@ -446,21 +484,43 @@ indexed_table_select_statement::prepare(database& db,
 }
 
 
+// Estimated number of distinct indexed values, i.e. the partition count of
+// the underlying index table. The ratio of the base table's partition count
+// to it approximates the posting list size of one lookup.
+static uint64_t index_cardinality(database& db, const schema_ptr& schema, const secondary_index::index& index) {
+    try {
+        auto& index_cf = db.find_column_family(schema->ks_name(), sprint("%s_index", index.metadata().name()));
+        return index_cf.estimate_partition_count();
+    } catch (no_such_column_family&) {
+        // The backing view may not have been created yet.
+        return 0;
+    }
+}
+
 stdx::optional<secondary_index::index> indexed_table_select_statement::find_idx(database& db,
                                                                                 schema_ptr schema,
                                                                                 ::shared_ptr<restrictions::statement_restrictions> restrictions)
 {
     auto& sim = db.find_column_family(schema).get_index_manager();
+    stdx::optional<secondary_index::index> chosen;
+    uint64_t chosen_cardinality = 0;
     for (::shared_ptr<cql3::restrictions::restrictions> restriction : restrictions->index_restrictions()) {
         for (const auto& cdef : restriction->get_column_defs()) {
             for (auto index : sim.list_indexes()) {
                 if (index.depends_on(*cdef)) {
-                    return stdx::make_optional<secondary_index::index>(std::move(index));
+                    // When several indexes can serve the query, pick the one
+                    // with the most distinct values: each of its lookups
+                    // matches the fewest base rows.
+                    auto cardinality = index_cardinality(db, schema, index);
+                    if (!chosen || cardinality > chosen_cardinality) {
+                        chosen = stdx::make_optional<secondary_index::index>(std::move(index));
+                        chosen_cardinality = cardinality;
+                    }
                 }
             }
         }
     }
-    return stdx::nullopt;
+    return chosen;
 }
 
 indexed_table_select_statement::indexed_table_select_statement(schema_ptr schema, uint32_t bound_terms,
@@ -492,43 +552,32 @@ indexed_table_select_statement::do_execute(distributed<service::storage_proxy>&
     ++_stats.reads;
 
     assert(_restrictions->uses_secondary_indexing());
-    return find_index_partition_ranges(proxy, state, options).then([limit, now, &state, &options, &proxy, this] (dht::partition_range_vector partition_ranges) {
-        auto command = ::make_lw_shared<query::read_command>(
-                _schema->id(),
-                _schema->version(),
-                make_partition_slice(options),
-                limit,
-                now,
-                tracing::make_trace_info(state.get_trace_state()),
-                query::max_partitions,
-                options.get_timestamp(state));
-        return this->execute(proxy, command, std::move(partition_ranges), state, options, now);
-    });
-}
 
-future<dht::partition_range_vector>
-indexed_table_select_statement::find_index_partition_ranges(distributed<service::storage_proxy>& proxy,
-                                             service::query_state& state,
-                                             const query_options& options)
-{
     const auto& im = _index.metadata();
     sstring index_table_name = sprint("%s_index", im.name());
     tracing::add_table_name(state.get_trace_state(), keyspace(), index_table_name);
     auto& db = proxy.local().get_db().local();
     const auto& view = db.find_column_family(_schema->ks_name(), index_table_name);
-    dht::partition_range_vector partition_ranges;
+
+    // Make the planner's view of the index visible in tracing: with the
+    // current statistics one lookup is expected to match
+    // base partitions / index keys rows.
+    if (state.get_trace_state()) {
+        auto base_count = db.find_column_family(_schema).estimate_partition_count();
+        auto index_count = view.estimate_partition_count();
+        tracing::trace(state.get_trace_state(), "Reading through index {}: ~{} base partitions over ~{} index keys (~{} per lookup)",
+                im.name(), base_count, index_count, index_count ? base_count / index_count : base_count);
+    }
+
+    dht::partition_range_vector index_ranges;
     for (const auto& restriction : _restrictions->index_restrictions()) {
         auto pk = partition_key::from_optional_exploded(*view.schema(), restriction->values(options));
         auto dk = dht::global_partitioner().decorate_key(*view.schema(), pk);
-        auto range = dht::partition_range::make_singular(dk);
-        partition_ranges.emplace_back(range);
+        index_ranges.emplace_back(dht::partition_range::make_singular(dk));
     }
 
-    auto now = gc_clock::now();
-    int32_t limit = get_limit(options);
-
     partition_slice_builder partition_slice_builder{*view.schema()};
-    auto cmd = ::make_lw_shared<query::read_command>(
+    auto vcmd = ::make_lw_shared<query::read_command>(
             view.schema()->id(),
             view.schema()->version(),
             partition_slice_builder.build(),
@@ -537,34 +586,93 @@ indexed_table_select_statement::find_index_partition_ranges(distributed<service:
             tracing::make_trace_info(state.get_trace_state()),
             query::max_partitions,
             options.get_timestamp(state));
-    return proxy.local().query(view.schema(),
-                               cmd,
-                               std::move(partition_ranges),
-                               options.get_consistency(),
-                               state.get_trace_state()).then([cmd, this, &options, now, &view] (foreign_ptr<lw_shared_ptr<query::result>> result) {
-        std::vector<const column_definition*> columns;
-        for (const column_definition& cdef : _schema->partition_key_columns()) {
-            columns.emplace_back(view.schema()->get_column_definition(cdef.name()));
-        }
-        auto selection = selection::selection::for_columns(view.schema(), columns);
-        cql3::selection::result_set_builder builder(*selection, now, options.get_cql_serialization_format());
-        query::result_view::consume(*result,
-                                    cmd->slice,
-                                    cql3::selection::result_set_builder::visitor(builder, *view.schema(), *selection));
-        auto rs = cql3::untyped_result_set(::make_shared<cql_transport::messages::result_message::rows>(std::move(builder.build())));
-        dht::partition_range_vector partition_ranges;
-        for (size_t i = 0; i < rs.size(); i++) {
-            const auto& row = rs.at(i);
-            for (const auto& column : row.get_columns()) {
-                auto blob = row.get_blob(column->name->to_cql_string());
-                auto pk = partition_key::from_exploded(*_schema, { blob });
-                auto dk = dht::global_partitioner().decorate_key(*_schema, pk);
-                auto range = dht::partition_range::make_singular(dk);
-                partition_ranges.emplace_back(range);
+    vcmd->slice.options.set<query::partition_slice::option::allow_short_read>();
+
+    std::vector<const column_definition*> columns;
+    for (const column_definition& cdef : _schema->partition_key_columns()) {
+        columns.emplace_back(view.schema()->get_column_definition(cdef.name()));
+    }
+    auto selection = selection::selection::for_columns(view.schema(), columns);
+
+    auto command = ::make_lw_shared<query::read_command>(
+            _schema->id(),
+            _schema->version(),
+            make_partition_slice(options),
+            limit,
+            now,
+            tracing::make_trace_info(state.get_trace_state()),
+            query::max_partitions,
+            options.get_timestamp(state));
+
+    // Instead of materializing the whole posting list and only then querying
+    // the base table, page through the index and pipeline: while the base
+    // rows for page N are being fetched, the posting list read for page N+1
+    // is already in flight. The base fetch for a page goes out as one
+    // combined read command; storage_proxy groups the singular ranges per
+    // replica and runs them in parallel.
+    struct pipeline {
+        ::shared_ptr<service::pager::query_pager> pager;
+        query::result_merger merger;
+        stdx::optional<dht::partition_range_vector> batch;
+        uint32_t base_rows = 0;
+    };
+
+    auto pager = service::pager::query_pagers::pager(view.schema(), std::move(selection), state, options, vcmd, std::move(index_ranges));
+
+    return do_with(pipeline{std::move(pager), query::result_merger(limit, query::max_partitions), stdx::nullopt},
+            [this, &proxy, &state, &options, command, limit, now] (pipeline& p) {
+        return repeat([this, &proxy, &state, &options, command, limit, now, &p] {
+            if (!p.batch && p.pager->is_exhausted()) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
             }
+            auto index_f = p.pager->is_exhausted()
+                    ? make_ready_future<stdx::optional<dht::partition_range_vector>>(stdx::nullopt)
+                    : p.pager->fetch_page(DEFAULT_INDEX_PAGE_SIZE, now).then([this] (std::unique_ptr<cql3::result_set> rs) {
+                        return stdx::make_optional(base_ranges_from_index_page(std::move(rs)));
+                    });
+            auto base_f = !p.batch || p.batch->empty()
+                    ? make_ready_future<>()
+                    : [&, this] {
+                        auto cmd = ::make_lw_shared<query::read_command>(*command);
+                        return proxy.local().query(_schema, cmd, std::move(*p.batch), options.get_consistency(), state.get_trace_state())
+                                .then([&p, cmd] (foreign_ptr<lw_shared_ptr<query::result>> result) {
+                            if (result->row_count()) {
+                                p.base_rows += *result->row_count();
+                            }
+                            p.merger(std::move(result));
+                        });
+                    }();
+            return when_all_succeed(std::move(index_f), std::move(base_f)).then([&p, limit] (stdx::optional<dht::partition_range_vector> next) {
+                p.batch = std::move(next);
+                if (p.base_rows >= uint32_t(limit)) {
+                    // The merger trims to the limit; the remaining posting
+                    // list cannot contribute anything.
+                    p.batch = stdx::nullopt;
+                    return stop_iteration::yes;
+                }
+                return stop_iteration::no;
+            });
+        }).then([this, &options, command, now, &p] {
+            return this->process_results(p.merger.get(), command, options, now);
+        });
+    });
+}
+
+dht::partition_range_vector
+indexed_table_select_statement::base_ranges_from_index_page(std::unique_ptr<cql3::result_set> rs) const {
+    auto urs = cql3::untyped_result_set(::make_shared<cql_transport::messages::result_message::rows>(std::move(rs)));
+    dht::partition_range_vector partition_ranges;
+    partition_ranges.reserve(urs.size());
+    for (size_t i = 0; i < urs.size(); i++) {
+        const auto& row = urs.at(i);
+        for (const auto& column : row.get_columns()) {
+            auto blob = row.get_blob(column->name->to_cql_string());
+            auto pk = partition_key::from_exploded(*_schema, { blob });
+            auto dk = dht::global_partitioner().decorate_key(*_schema, pk);
+            partition_ranges.emplace_back(dht::partition_range::make_singular(dk));
         }
-        return make_ready_future<dht::partition_range_vector>(partition_ranges);
-    }).finally([cmd] {});
+    }
+    return partition_ranges;
 }
 
 namespace raw {
@@ -646,7 +754,9 @@ select_statement::prepare_restrictions(database& db,
                                        bool for_view)
 {
     try {
-        return ::make_shared<restrictions::statement_restrictions>(db, schema, statement_type::SELECT, std::move(_where_clause), bound_names,
+        // No move: the restrictions only read the where clause, and this
+        // parse tree must stay reusable (see parsed_statement::is_reusable()).
+        return ::make_shared<restrictions::statement_restrictions>(db, schema, statement_type::SELECT, _where_clause, bound_names,
             selection->contains_only_static_columns(), selection->contains_a_collection(), for_view);
     } catch (const exceptions::unrecognized_entity_exception& e) {
         if (contains_alias(e.entity)) {
@@ -186,9 +186,12 @@ private:
     virtual future<::shared_ptr<cql_transport::messages::result_message>> do_execute(distributed<service::storage_proxy>& proxy,
                                                                                      service::query_state& state, const query_options& options) override;
 
-    future<dht::partition_range_vector> find_index_partition_ranges(distributed<service::storage_proxy>& proxy,
-                                                                    service::query_state& state,
-                                                                    const query_options& options);
+    // Size of the internal pages used to read the index posting list. Each
+    // index row becomes one singular base-table range, so this is also the
+    // batch size of the combined base-table reads.
+    static constexpr int DEFAULT_INDEX_PAGE_SIZE = 1024;
+
+    dht::partition_range_vector base_ranges_from_index_page(std::unique_ptr<cql3::result_set>) const;
 };
 
 }
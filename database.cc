@@ -40,6 +40,7 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include "sstables/sstables.hh"
+#include "sstables/downsampling.hh"
 #include "sstables/compaction.hh"
 #include "sstables/remove.hh"
 #include <boost/range/adaptor/transformed.hpp>
@@ -64,6 +65,7 @@
 #include <core/fstream.hh>
 #include <seastar/core/enum.hh>
 #include "utils/latency.hh"
+#include "utils/seqlock.hh"
 #include "schema_registry.hh"
 #include "service/priority_manager.hh"
 #include "cell_locking.hh"
@@ -355,12 +357,22 @@ contains_rows(const sstables::sstable& sst, const schema_ptr& schema, const ck_f
 // of a range for each clustering component.
 static std::vector<sstables::shared_sstable>
 filter_sstable_for_reader(std::vector<sstables::shared_sstable>&& sstables, column_family& cf, const schema_ptr& schema,
-        const sstables::key& key, const query::partition_slice& slice) {
+        const sstables::key& key, const query::partition_slice& slice, uint64_t absent_generation) {
     auto sstable_has_not_key = [&] (const sstables::shared_sstable& sst) {
         return !sst->filter_has_key(key);
     };
     sstables.erase(boost::remove_if(sstables, sstable_has_not_key), sstables.end());
 
+    // Every bloom filter denies the key, and bloom filters have no false
+    // negatives: the partition is absent from all sstables regardless of the
+    // queried slice, so it is safe to remember. The clustering filter below
+    // gives no such guarantee, so an empty result past this point must not
+    // be cached.
+    if (sstables.empty()) {
+        cf.note_partition_absent(bytes_view(key), absent_generation);
+        return sstables;
+    }
+
     // no clustering filtering is applied if schema defines no clustering key or
     // compaction strategy thinks it will not benefit from such an optimization.
     if (!schema->clustering_key_size() || !cf.get_compaction_strategy().use_clustering_key_filter()) {
@@ -508,6 +520,137 @@ public:
     }
 };
 
+// Reads a single partition from a set of sstables, opening them from the
+// newest to the oldest (by the max timestamp in their stats metadata), so
+// that a partition tombstone found in a newer sstable can prove older
+// sstables irrelevant before they are touched at all: nothing in an sstable
+// whose max timestamp is older than an already-seen partition tombstone can
+// survive the deletion, so such sstables do not even have their index
+// opened. This makes reads of fully deleted partitions nearly free instead
+// of an N-way merge of the same deletion marker.
+class single_key_tombstone_skipping_reader : public flat_mutation_reader::impl {
+    std::vector<sstables::shared_sstable> _sstables;
+    utils::estimated_histogram& _sstable_histogram;
+    std::reference_wrapper<const dht::partition_range> _pr;
+    std::reference_wrapper<const query::partition_slice> _slice;
+    std::reference_wrapper<const io_priority_class> _pc;
+    reader_resource_tracker _resource_tracker;
+    tracing::trace_state_ptr _trace_state;
+    streamed_mutation::forwarding _fwd;
+    mutation_reader::forwarding _fwd_mr;
+    ::cf_stats* _cf_stats;
+    size_t _next = 0;
+    tombstone _tomb;
+    std::vector<flat_mutation_reader> _opened;
+    stdx::optional<flat_mutation_reader> _underlying;
+private:
+    future<> prepare() {
+        return repeat([this] {
+            if (_next == _sstables.size()) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            auto& sst = _sstables[_next++];
+            if (_tomb && sst->get_stats_metadata().max_timestamp < _tomb.timestamp) {
+                ++_cf_stats->sstables_skipped_by_partition_tombstone;
+                tracing::trace(_trace_state, "Skipping sstable {}: all its data is older than partition tombstone {}",
+                        seastar::value_of([&sst] { return sst->get_filename(); }), _tomb);
+                return make_ready_future<stop_iteration>(stop_iteration::no);
+            }
+            tracing::trace(_trace_state, "Reading key {} from sstable {}", _pr.get(),
+                    seastar::value_of([&sst] { return sst->get_filename(); }));
+            _opened.push_back(sst->read_row_flat(_schema, _pr.get().start()->value(), _slice.get(), _pc.get(), _resource_tracker, _fwd));
+            // Peeking pulls in the partition_start fragment, which carries the
+            // partition tombstone; the fragment stays in the reader's buffer
+            // for the merge below.
+            return _opened.back().peek().then([this] (mutation_fragment* mf) {
+                if (!mf) {
+                    // Bloom filter false positive; the sstable does not
+                    // contain the partition after all.
+                    _opened.pop_back();
+                } else if (mf->is_partition_start()) {
+                    _tomb.apply(mf->as_partition_start().partition_tombstone());
+                }
+                return stop_iteration::no;
+            });
+        }).then([this] {
+            _sstable_histogram.add(_opened.size());
+            if (_opened.empty()) {
+                _underlying = make_empty_flat_reader(_schema);
+            } else {
+                _underlying = make_combined_reader(_schema, std::move(_opened), _fwd, _fwd_mr);
+            }
+        });
+    }
+    future<> ensure_underlying() {
+        if (_underlying) {
+            return make_ready_future<>();
+        }
+        return prepare();
+    }
+public:
+    single_key_tombstone_skipping_reader(schema_ptr schema,
+                                         std::vector<sstables::shared_sstable> sstables,
+                                         utils::estimated_histogram& sstable_histogram,
+                                         const dht::partition_range& pr,
+                                         const query::partition_slice& slice,
+                                         const io_priority_class& pc,
+                                         reader_resource_tracker resource_tracker,
+                                         tracing::trace_state_ptr trace_state,
+                                         streamed_mutation::forwarding fwd,
+                                         mutation_reader::forwarding fwd_mr,
+                                         ::cf_stats* cf_stats)
+        : impl(std::move(schema))
+        , _sstables(std::move(sstables))
+        , _sstable_histogram(sstable_histogram)
+        , _pr(pr)
+        , _slice(slice)
+        , _pc(pc)
+        , _resource_tracker(std::move(resource_tracker))
+        , _trace_state(std::move(trace_state))
+        , _fwd(fwd)
+        , _fwd_mr(fwd_mr)
+        , _cf_stats(cf_stats)
+    {
+        std::sort(_sstables.begin(), _sstables.end(), [] (const sstables::shared_sstable& a, const sstables::shared_sstable& b) {
+            return a->get_stats_metadata().max_timestamp > b->get_stats_metadata().max_timestamp;
+        });
+    }
+    virtual future<> fill_buffer(db::timeout_clock::time_point timeout) override {
+        return ensure_underlying().then([this, timeout] {
+            return _underlying->fill_buffer(timeout).then([this] {
+                _end_of_stream = _underlying->is_end_of_stream();
+                while (!_underlying->is_buffer_empty()) {
+                    push_mutation_fragment(_underlying->pop_mutation_fragment());
+                }
+            });
+        });
+    }
+    virtual void next_partition() override {
+        clear_buffer_to_next_partition();
+        if (!is_buffer_empty()) {
+            return;
+        }
+        _end_of_stream = false;
+        if (_underlying) {
+            _underlying->next_partition();
+        }
+    }
+    virtual future<> fast_forward_to(const dht::partition_range& pr, db::timeout_clock::time_point timeout) override {
+        clear_buffer();
+        _end_of_stream = false;
+        return ensure_underlying().then([this, &pr, timeout] {
+            return _underlying->fast_forward_to(pr, timeout);
+        });
+    }
+    virtual future<> fast_forward_to(position_range pr, db::timeout_clock::time_point timeout) override {
+        forward_buffer_to(pr.start());
+        _end_of_stream = false;
+        return ensure_underlying().then([this, pr = std::move(pr), timeout] () mutable {
+            return _underlying->fast_forward_to(std::move(pr), timeout);
+        });
+    }
+};
+
 static flat_mutation_reader
 create_single_key_sstable_reader(column_family* cf,
                                  schema_ptr schema,
@@ -519,21 +662,22 @@ create_single_key_sstable_reader(column_family* cf,
                                  reader_resource_tracker resource_tracker,
                                  tracing::trace_state_ptr trace_state,
                                  streamed_mutation::forwarding fwd,
-                                 mutation_reader::forwarding fwd_mr)
+                                 mutation_reader::forwarding fwd_mr,
+                                 uint64_t absent_generation)
 {
     auto key = sstables::key::from_partition_key(*schema, *pr.start()->value().key());
-    auto readers = boost::copy_range<std::vector<flat_mutation_reader>>(
-        filter_sstable_for_reader(sstables->select(pr), *cf, schema, key, slice)
-        | boost::adaptors::transformed([&] (const sstables::shared_sstable& sstable) {
-            tracing::trace(trace_state, "Reading key {} from sstable {}", pr, seastar::value_of([&sstable] { return sstable->get_filename(); }));
-            return sstable->read_row_flat(schema, pr.start()->value(), slice, pc, resource_tracker, fwd);
-        })
-    );
-    if (readers.empty()) {
+    if (cf->partition_known_absent(bytes_view(key))) {
+        tracing::trace(trace_state, "Key {} is known to be absent from all sstables", pr);
+        return make_empty_flat_reader(schema);
+    }
+    auto candidates = filter_sstable_for_reader(sstables->select(pr), *cf, schema, key, slice, absent_generation);
+    if (candidates.empty()) {
         return make_empty_flat_reader(schema);
     }
-    sstable_histogram.add(readers.size());
-    return make_combined_reader(schema, std::move(readers), fwd, fwd_mr);
+    // The candidates are opened newest-first by the reader below, so that a
+    // partition tombstone found early can rule out opening the older ones.
+    return make_flat_mutation_reader<single_key_tombstone_skipping_reader>(std::move(schema), std::move(candidates),
+            sstable_histogram, pr, slice, pc, std::move(resource_tracker), std::move(trace_state), fwd, fwd_mr, cf->cf_stats());
 }
 
 flat_mutation_reader
@@ -559,8 +703,13 @@ column_family::make_sstable_reader(schema_ptr s,
             return make_empty_flat_reader(s); // range doesn't belong to this shard
         }
 
+        // Taken together with the sstable set, so that a reader which runs
+        // delayed (behind the read concurrency semaphore) cannot repopulate
+        // the absent-partitions cache from a stale set.
+        auto absent_generation = _absent_partitions_generation;
+
         if (config.resources_sem) {
-            auto ms = mutation_source([&config, sstables=std::move(sstables), this] (
+            auto ms = mutation_source([&config, sstables=std::move(sstables), absent_generation, this] (
                         schema_ptr s,
                         const dht::partition_range& pr,
                         const query::partition_slice& slice,
@@ -569,12 +718,12 @@ column_family::make_sstable_reader(schema_ptr s,
                         streamed_mutation::forwarding fwd,
                         mutation_reader::forwarding fwd_mr) {
                     return create_single_key_sstable_reader(const_cast<column_family*>(this), std::move(s), std::move(sstables),
-                                _stats.estimated_sstable_per_read, pr, slice, pc, reader_resource_tracker(config.resources_sem), std::move(trace_state), fwd, fwd_mr);
+                                _stats.estimated_sstable_per_read, pr, slice, pc, reader_resource_tracker(config.resources_sem), std::move(trace_state), fwd, fwd_mr, absent_generation);
                 });
             return make_restricted_flat_reader(config, std::move(ms), std::move(s), pr, slice, pc, std::move(trace_state), fwd, fwd_mr);
         } else {
             return create_single_key_sstable_reader(const_cast<column_family*>(this), std::move(s), std::move(sstables),
-                        _stats.estimated_sstable_per_read, pr, slice, pc, no_resource_tracking(), std::move(trace_state), fwd, fwd_mr);
+                        _stats.estimated_sstable_per_read, pr, slice, pc, no_resource_tracking(), std::move(trace_state), fwd, fwd_mr, absent_generation);
         }
     } else {
         if (config.resources_sem) {
@@ -672,7 +821,15 @@ column_family::make_reader(schema_ptr s,
         readers.emplace_back(mt->make_flat_reader(s, range, slice, pc, trace_state, fwd, fwd_mr));
     }
 
-    if (_config.enable_cache) {
+    if (slice.options.contains<query::partition_slice::option::bypass_cache>()) {
+        // Reads which bypass the cache (scans, typically) go straight to the
+        // sstables, so they neither populate the cache nor touch the LRU
+        // order of the resident working set. They also run under the
+        // streaming priority class, so that latency-sensitive reads win the
+        // competition for the disk.
+        readers.emplace_back(make_sstable_reader(s, _sstables, range, slice,
+                service::get_local_streaming_read_priority(), std::move(trace_state), fwd, fwd_mr));
+    } else if (_config.enable_cache) {
         readers.emplace_back(_cache.make_reader(s, range, slice, pc, std::move(trace_state), fwd, fwd_mr));
     } else {
         readers.emplace_back(make_sstable_reader(s, _sstables, range, slice, pc, std::move(trace_state), fwd, fwd_mr));
@@ -808,6 +965,9 @@ void column_family::add_sstable(sstables::shared_sstable sstable, const std::vec
     auto new_sstables = make_lw_shared(*_sstables);
     new_sstables->insert(sstable);
     _sstables = std::move(new_sstables);
+    ++_sstable_set_version;
+    // The new sstable may contain partitions we cached as absent.
+    invalidate_absent_partitions();
     update_stats_for_new_sstable(sstable->bytes_on_disk(), shards_for_the_sstable);
     _compaction_strategy.get_backlog_tracker().add_sstable(sstable);
 }
@@ -902,7 +1062,13 @@ column_family::seal_active_streaming_memtable_immediate(flush_permit&& permit) {
                     return with_scheduling_group(_config.memtable_to_cache_scheduling_group, [this, newtab, old] {
                       auto adder = [this, newtab] {
                           add_sstable(newtab, {engine().cpu_id()});
-                          try_trigger_compaction();
+                          // Compacting per-flush sstables while the stream is still
+                          // feeding us just rewrites them again when the next flush
+                          // lands; the completed plan triggers one compaction which
+                          // integrates them all (see flush_streaming_mutations()).
+                          if (_streaming_plans_in_progress.empty()) {
+                              try_trigger_compaction();
+                          }
                           dblog.debug("Flushing to {} done", newtab->get_filename());
                       };
                       if (_config.enable_cache) {
@@ -1049,25 +1215,51 @@ column_family::try_flush_memtable_to_sstable(lw_shared_ptr<memtable> old, sstabl
     // The code as is guarantees that we'll never partially backup a
     // single sstable, so that is enough of a guarantee.
     database_sstable_write_monitor monitor(std::move(permit), newtab, _compaction_manager, _compaction_strategy);
-    return do_with(std::move(monitor), [this, old, newtab] (auto& monitor) {
+    // Flush-merge: absorb small sstables that compaction would immediately
+    // re-merge with this flush's output, writing their data through this
+    // single pass instead. They are replaced by the output once it is sealed.
+    std::vector<sstables::shared_sstable> merge_with;
+    if (_config.enable_flush_merge) {
+        merge_with = _compaction_manager.prepare_flush_merge(*this, old->occupancy().total_space());
+    }
+    return do_with(std::move(monitor), std::move(merge_with), [this, old, newtab] (auto& monitor, auto& merge_with) {
         auto&& priority = service::get_local_memtable_flush_priority();
-        return write_memtable_to_sstable(*old, newtab, monitor, incremental_backups_enabled(), priority, false).then([this, newtab, old, &monitor] {
+        return write_memtable_to_sstable(*old, merge_with, newtab, monitor, incremental_backups_enabled(), priority, false).then([this, newtab, old, &monitor, &merge_with] {
          // Switch back to default scheduling group for post-flush actions, to avoid them being staved by the memtable flush
          // controller. Cache update does not affect the input of the memtable cpu controller, so it can be subject to
          // priority inversion.
-         return with_scheduling_group(default_scheduling_group(), [this, &monitor, old = std::move(old), newtab = std::move(newtab)] () mutable {
+         return with_scheduling_group(default_scheduling_group(), [this, &monitor, &merge_with, old = std::move(old), newtab = std::move(newtab)] () mutable {
           return newtab->open_data().then([this, old, newtab] () {
             dblog.debug("Flushing to {} done", newtab->get_filename());
             return with_scheduling_group(_config.memtable_to_cache_scheduling_group, [this, old, newtab] {
                 return update_cache(old, newtab);
             });
-          }).then([this, old, newtab] () noexcept {
+          }).then([this, old, newtab, &merge_with] () noexcept {
+            if (!merge_with.empty()) {
+                try {
+                    // newtab entered the sstable list in update_cache() and
+                    // contains everything the absorbed sstables did, so they
+                    // can be dropped now.
+                    on_compaction_completion({}, merge_with);
+                } catch (...) {
+                    // The absorbed sstables only hold data that newtab
+                    // duplicates, so leaving them to regular compaction is
+                    // safe.
+                    dblog.warn("failed to remove sstables absorbed by flush of {}: {}", newtab->get_filename(), std::current_exception());
+                }
+                _compaction_manager.deregister_compacting_sstables(merge_with);
+                merge_with.clear();
+            }
             _memtables->erase(old);
             dblog.debug("Memtable for {} replaced", newtab->get_filename());
             return stop_iteration::yes;
-          }).handle_exception([this, old, newtab, &monitor] (auto e) {
+          }).handle_exception([this, old, newtab, &monitor, &merge_with] (auto e) {
             monitor.write_failed();
             newtab->mark_for_deletion();
+            // The absorbed sstables stay in place; release them so that
+            // compaction (or the flush retry) can pick them up again.
+            _compaction_manager.deregister_compacting_sstables(merge_with);
+            merge_with.clear();
             dblog.error("failed to write sstable {}: {}", newtab->get_filename(), e);
             // If we failed this write we will try the write again and that will create a new flush reader
             // that will decrease dirty memory again. So we need to reset the accounting.
@@ -1248,6 +1440,7 @@ void column_family::set_metrics() {
             _metrics.add_group("column_family", {
                     ms::make_histogram("read_latency", ms::description("Read latency histogram"), [this] {return _stats.estimated_read.get_histogram(std::chrono::microseconds(100));})(cf)(ks),
                     ms::make_histogram("write_latency", ms::description("Write latency histogram"), [this] {return _stats.estimated_write.get_histogram(std::chrono::microseconds(100));})(cf)(ks),
+                    ms::make_histogram("range_latency", ms::description("Range scan latency histogram"), [this] {return _stats.estimated_range_read.get_histogram(std::chrono::microseconds(100));})(cf)(ks),
                     ms::make_gauge("cache_hit_rate", ms::description("Cache hit rate"), [this] {return float(_global_cache_hit_rate);})(cf)(ks)
             });
         }
@@ -1286,6 +1479,7 @@ column_family::rebuild_sstable_list(const std::vector<sstables::shared_sstable>&
         }
     }
     _sstables = make_lw_shared(std::move(new_sstable_list));
+    ++_sstable_set_version;
 }
 
 void
@@ -1398,13 +1592,18 @@ void column_family::remove_ancestors_needed_rewrite(std::unordered_set<uint64_t>
 }
 
 future<>
-column_family::compact_sstables(sstables::compaction_descriptor descriptor, bool cleanup) {
+column_family::compact_sstables(sstables::compaction_descriptor descriptor) {
+    return compact_sstables(std::move(descriptor), sstables::compaction_type::Compaction);
+}
+
+future<>
+column_family::compact_sstables(sstables::compaction_descriptor descriptor, sstables::compaction_type type) {
     if (!descriptor.sstables.size()) {
         // if there is nothing to compact, just return.
         return make_ready_future<>();
     }
 
-    return with_lock(_sstables_lock.for_read(), [this, descriptor = std::move(descriptor), cleanup] () mutable {
+    return with_lock(_sstables_lock.for_read(), [this, descriptor = std::move(descriptor), type] () mutable {
         auto create_sstable = [this] {
                 auto gen = this->calculate_generation_for_new_table();
                 auto sst = sstables::make_sstable(_schema, _config.datadir, gen,
@@ -1414,10 +1613,21 @@ column_family::compact_sstables(sstables::compaction_descriptor descriptor, bool
                 return sst;
         };
         auto sstables_to_compact = descriptor.sstables;
+        // Incrementally replace the inputs the compaction exhausted with the
+        // outputs that cover their data, so reads stop merging an input as
+        // soon as it's fully rewritten instead of only when the whole
+        // compaction finishes. The inputs are only deleted on completion.
+        auto replacer = [this] (std::vector<sstables::shared_sstable> new_sstables, std::vector<sstables::shared_sstable> old_sstables) {
+            rebuild_sstable_list(new_sstables, old_sstables);
+            rebuild_statistics();
+        };
         return sstables::compact_sstables(std::move(descriptor), *this, create_sstable,
-                cleanup).then([this, sstables_to_compact = std::move(sstables_to_compact)] (auto info) {
+                type, std::move(replacer)).then([this, sstables_to_compact = std::move(sstables_to_compact)] (auto info) {
             _compaction_strategy.notify_completion(sstables_to_compact, info.new_sstables);
-            this->on_compaction_completion(info.new_sstables, sstables_to_compact);
+            // All new sstables were already made visible to reads through the
+            // replacer as they were sealed, so only the inputs are left to be
+            // dropped and deleted.
+            this->on_compaction_completion({}, sstables_to_compact);
             return info;
         });
     }).then([this] (auto info) {
@@ -1471,7 +1681,7 @@ future<> column_family::cleanup_sstables(sstables::compaction_descriptor descrip
             static thread_local semaphore sem(1);
 
             return with_semaphore(sem, 1, [this, &sst] {
-                return this->compact_sstables(sstables::compaction_descriptor({ sst }, sst->get_sstable_level()), true);
+                return this->compact_sstables(sstables::compaction_descriptor({ sst }, sst->get_sstable_level()), sstables::compaction_type::Cleanup);
             });
         });
     });
@@ -1507,8 +1717,8 @@ void column_family::do_trigger_compaction() {
     }
 }
 
-future<> column_family::run_compaction(sstables::compaction_descriptor descriptor) {
-    return compact_sstables(std::move(descriptor));
+future<> column_family::run_compaction(sstables::compaction_descriptor descriptor, sstables::compaction_type type) {
+    return compact_sstables(std::move(descriptor), type);
 }
 
 void column_family::set_compaction_strategy(sstables::compaction_strategy_type strategy) {
@@ -1532,12 +1742,24 @@ void column_family::set_compaction_strategy(sstables::compaction_strategy_type s
     // now exception safe:
     _compaction_strategy = std::move(new_cs);
     _sstables = std::move(new_sstables);
+    ++_sstable_set_version;
 }
 
 size_t column_family::sstables_count() const {
     return _sstables->all()->size();
 }
 
+uint64_t column_family::estimate_partition_count() const {
+    uint64_t count = 0;
+    for (auto& mt : *_memtables) {
+        count += mt->partition_count();
+    }
+    for (auto& sst : *_sstables->all()) {
+        count += sst->get_estimated_key_count();
+    }
+    return count;
+}
+
 std::vector<uint64_t> column_family::sstable_count_per_level() const {
     std::vector<uint64_t> count_per_level;
     for (auto&& sst : *_sstables->all()) {
@@ -1632,18 +1854,29 @@ future<> distributed_loader::open_sstable(distributed<database>& db, sstables::e
     return db.invoke_on(column_family::calculate_shard_from_sstable_generation(comps.generation),
             [&db, comps = std::move(comps), func = std::move(func), pc] (database& local) {
 
-        return with_semaphore(local.sstable_load_concurrency_sem(), 1, [&db, &local, comps = std::move(comps), func = std::move(func), pc] {
+        // The semaphore bounds how many sstables have their components parsed
+        // at any one time; sharing already-parsed components with the other
+        // owner shards happens outside of it, so a slow peer doesn't hold up
+        // the parsing pipeline.
+        auto f = with_semaphore(local.sstable_load_concurrency_sem(), 1, [&local, comps, pc] {
             auto& cf = local.find_column_family(comps.ks, comps.cf);
-
-            auto f = sstables::sstable::load_shared_components(cf.schema(), cf._config.datadir, comps.generation, comps.version, comps.format, pc);
-            return f.then([&db, comps = std::move(comps), func = std::move(func)] (sstables::sstable_open_info info) {
-                // shared components loaded, now opening sstable in all shards that own it with shared components
-                return do_with(std::move(info), [&db, comps = std::move(comps), func = std::move(func)] (auto& info) {
-                    return invoke_shards_with_ptr(info.owners, db, std::move(info.components),
-                            [owners = info.owners, data = info.data.dup(), index = info.index.dup(), comps, func] (database& db, auto components) {
-                        auto& cf = db.find_column_family(comps.ks, comps.cf);
-                        return func(cf, sstables::foreign_sstable_open_info{std::move(components), owners, data, index});
-                    });
+            return sstables::sstable::load_shared_components(cf.schema(), cf._config.datadir, comps.generation, comps.version, comps.format, pc);
+        });
+        return f.then([&db, comps = std::move(comps), func = std::move(func)] (sstables::sstable_open_info info) {
+            if (info.owners.size() == 1 && info.owners[0] == engine().cpu_id()) {
+                // The common unresharded case: this shard is the sole owner,
+                // so there is nobody to share the components with. Open the
+                // sstable right here, skipping the cross-shard hops.
+                auto& cf = db.local().find_column_family(comps.ks, comps.cf);
+                return func(cf, sstables::foreign_sstable_open_info{make_foreign(std::move(info.components)),
+                        std::move(info.owners), info.data.dup(), info.index.dup()});
+            }
+            // shared components loaded, now opening sstable in all shards that own it with shared components
+            return do_with(std::move(info), [&db, comps = std::move(comps), func = std::move(func)] (auto& info) {
+                return invoke_shards_with_ptr(info.owners, db, std::move(info.components),
+                        [owners = info.owners, data = info.data.dup(), index = info.index.dup(), comps, func] (database& db, auto components) {
+                    auto& cf = db.find_column_family(comps.ks, comps.cf);
+                    return func(cf, sstables::foreign_sstable_open_info{std::move(components), owners, data, index});
                 });
             });
         });
@@ -2085,11 +2318,12 @@ make_flush_controller(db::config& cfg, seastar::scheduling_group sg, const ::io_
 
 inline
 compaction_controller
-make_compaction_controller(db::config& cfg, seastar::scheduling_group sg, const ::io_priority_class& iop, std::function<double()> fn) {
+make_compaction_controller(db::config& cfg, seastar::scheduling_group sg, const ::io_priority_class& iop, std::function<double()> fn, std::function<float()> pressure) {
     if (cfg.compaction_static_shares() > 0) {
         return compaction_controller(sg, iop, cfg.compaction_static_shares());
     }
-    return compaction_controller(sg, iop, 250ms, std::move(fn));
+    return compaction_controller(sg, iop, 250ms, std::move(fn),
+            cfg.compaction_shares_min(), cfg.compaction_shares_max(), std::move(pressure));
 }
 
 utils::UUID database::empty_version = utils::UUID_gen::get_name_UUID(bytes{});
@@ -2104,7 +2338,7 @@ database::database(const db::config& cfg, database_config dbcfg)
     // Allow system tables a pool of 10 MB memory to write, but never block on other regions.
     , _system_dirty_memory_manager(*this, 10 << 20, cfg.virtual_dirty_soft_limit())
     , _dirty_memory_manager(*this, memory::stats().total_memory() * 0.45, cfg.virtual_dirty_soft_limit())
-    , _streaming_dirty_memory_manager(*this, memory::stats().total_memory() * 0.10, cfg.virtual_dirty_soft_limit())
+    , _streaming_dirty_memory_manager(*this, memory::stats().total_memory() * 0.10, cfg.virtual_dirty_soft_limit(), dbcfg.streaming_scheduling_group)
     , _dbcfg(dbcfg)
     , _memtable_controller(make_flush_controller(*_cfg, dbcfg.memtable_scheduling_group, service::get_local_memtable_flush_priority(), [this, limit = float(_dirty_memory_manager.throttle_threshold())] {
         return (_dirty_memory_manager.virtual_dirty_memory()) / limit;
@@ -2123,17 +2357,192 @@ database::database(const db::config& cfg, database_config dbcfg)
             return compaction_controller::normalization_factor;
         }
         return _compaction_manager->backlog() / memory::stats().total_memory();
+    }, [this] () -> float {
+        // We measure no per-I/O-class latency on the replica; reads queued
+        // on the concurrency semaphore are the foreground congestion signal.
+        return queued_reads();
     }))
 {
     local_schema_registry().init(*this); // TODO: we're never unbound.
     _compaction_manager->start();
     setup_metrics();
+    _summary_resampling_timer.arm_periodic(std::chrono::minutes(1));
+    _stats_snapshot_timer.arm_periodic(std::chrono::milliseconds(100));
 
     dblog.info("Row: max_vector_size: {}, internal_count: {}", size_t(row::max_vector_size), size_t(row::internal_count));
 }
 
+void database::resample_sstable_summaries() {
+    // Downsampling only pays off when summary memory could be put to better
+    // use by the cache, so use recent evictions as the pressure signal.
+    auto evictions = global_cache_tracker().get_stats().partition_evictions;
+    bool under_pressure = evictions > _resampler_last_cache_evictions;
+    _resampler_last_cache_evictions = evictions;
+
+    // Never downsample below this level; past that the extra index reads on
+    // every lookup outweigh the remaining memory savings.
+    static constexpr int min_sampling_level = sstables::downsampling::BASE_SAMPLING_LEVEL / 8;
+    // Summaries smaller than this are not worth touching.
+    static constexpr size_t min_summary_footprint = 128 * 1024;
+
+    auto candidates = make_lw_shared<std::vector<sstables::shared_sstable>>();
+    for (auto& p : _column_families) {
+        for (auto& sst : *p.second->get_sstables()) {
+            if (sst->has_active_index_readers()) {
+                continue;
+            }
+            auto reads = sst->reads_since_last_resample_check();
+            if (under_pressure) {
+                if (!reads && sst->sampling_level() > min_sampling_level
+                        && sst->summary_memory_footprint() >= min_summary_footprint) {
+                    candidates->push_back(sst);
+                }
+            } else if (reads && sst->sampling_level() < sstables::downsampling::BASE_SAMPLING_LEVEL) {
+                candidates->push_back(sst);
+            }
+        }
+    }
+    if (candidates->empty()) {
+        return;
+    }
+    // Resample in the background; stop() closes the gate after cancelling
+    // the timer. Sstables removed from their table meanwhile are kept alive
+    // by the shared pointer, so at worst we resample a defunct summary.
+    with_gate(_summary_resampling_gate, [under_pressure, candidates] {
+        return do_for_each(*candidates, [under_pressure] (sstables::shared_sstable& sst) {
+            if (under_pressure) {
+                return sst->downsample_summary(std::max(sst->sampling_level() / 2, int(min_sampling_level)));
+            }
+            return sst->upsample_summary(service::get_local_compaction_priority());
+        }).finally([candidates] {});
+    });
+}
+
+// Preallocated blocks of per-table stats snapshots, one per shard. Each
+// shard publishes into its own block from _stats_snapshot_timer; any shard
+// may read all blocks directly, which makes a REST API stats scrape
+// O(tables) memory reads instead of O(tables * shards) cross-shard futures.
+// The blocks are allocated on first publish and deliberately never freed:
+// the API may still be scraping while a shard's database shuts down, and a
+// few hundred KB per shard is cheap insurance against that race.
+struct stats_snapshot_block {
+    // Enough for every deployment we have seen; tables beyond this are
+    // simply not published and their scrapes fall back to map_reduce.
+    static constexpr size_t max_tables = 4096;
+    std::array<utils::seqlock<column_family::stats_snapshot>, max_tables> slots;
+    // True when every table of the owning shard fit in the block.
+    std::atomic<bool> complete{false};
+};
+
+static constexpr unsigned max_snapshot_shards = 1024;
+static std::array<std::atomic<stats_snapshot_block*>, max_snapshot_shards> stats_snapshot_blocks;
+
+void database::publish_stats_snapshots() {
+    auto shard = engine().cpu_id();
+    if (shard >= max_snapshot_shards) {
+        return;
+    }
+    auto* block = stats_snapshot_blocks[shard].load(std::memory_order_relaxed);
+    if (!block) {
+        block = new stats_snapshot_block();
+        stats_snapshot_blocks[shard].store(block, std::memory_order_release);
+    }
+    size_t i = 0;
+    bool complete = true;
+    for (auto& p : _column_families) {
+        if (i == block->slots.size()) {
+            complete = false;
+            break;
+        }
+        auto& stats = p.second->get_stats();
+        column_family::stats_snapshot s;
+        s.id = p.first;
+        s.memtable_switch_count = stats.memtable_switch_count;
+        s.pending_flushes = stats.pending_flushes;
+        s.live_disk_space_used = stats.live_disk_space_used;
+        s.total_disk_space_used = stats.total_disk_space_used;
+        s.live_sstable_count = stats.live_sstable_count;
+        s.pending_compactions = stats.pending_compactions;
+        s.reads_count = stats.reads.hist.count;
+        s.writes_count = stats.writes.hist.count;
+        s.used = true;
+        block->slots[i++].write(s);
+    }
+    // Slots are filled densely, so clearing up to the first unused one is
+    // enough to retire snapshots of dropped tables.
+    while (i < block->slots.size() && block->slots[i].read().used) {
+        block->slots[i++].write(column_family::stats_snapshot());
+    }
+    block->complete.store(complete, std::memory_order_release);
+}
+
+int64_t column_family::stats_snapshot::* column_family::snapshot_member(int64_t stats::*f) {
+    if (f == &stats::memtable_switch_count) {
+        return &stats_snapshot::memtable_switch_count;
+    } else if (f == &stats::pending_flushes) {
+        return &stats_snapshot::pending_flushes;
+    } else if (f == &stats::live_disk_space_used) {
+        return &stats_snapshot::live_disk_space_used;
+    } else if (f == &stats::total_disk_space_used) {
+        return &stats_snapshot::total_disk_space_used;
+    } else if (f == &stats::live_sstable_count) {
+        return &stats_snapshot::live_sstable_count;
+    } else if (f == &stats::pending_compactions) {
+        return &stats_snapshot::pending_compactions;
+    }
+    return nullptr;
+}
+
+int64_t column_family::stats_snapshot::* column_family::snapshot_member(utils::timed_rate_moving_average_and_histogram stats::*f) {
+    if (f == &stats::reads) {
+        return &stats_snapshot::reads_count;
+    } else if (f == &stats::writes) {
+        return &stats_snapshot::writes_count;
+    }
+    return nullptr;
+}
+
+stdx::optional<int64_t> column_family::sum_stats_snapshots(stdx::optional<utils::UUID> id, int64_t stats_snapshot::* member) {
+    int64_t total = 0;
+    for (unsigned shard = 0; shard < smp::count; ++shard) {
+        if (shard >= max_snapshot_shards) {
+            return stdx::nullopt;
+        }
+        auto* block = stats_snapshot_blocks[shard].load(std::memory_order_acquire);
+        if (!block || !block->complete.load(std::memory_order_acquire)) {
+            return stdx::nullopt;
+        }
+        bool found = false;
+        for (auto& slot : block->slots) {
+            auto s = slot.read();
+            if (!s.used) {
+                break;
+            }
+            if (!id) {
+                total += s.*member;
+            } else if (s.id == *id) {
+                total += s.*member;
+                found = true;
+                break;
+            }
+        }
+        if (id && !found) {
+            // The table may have been created since the shard last
+            // published; let the caller take the slow path.
+            return stdx::nullopt;
+        }
+    }
+    return total;
+}
+
 void backlog_controller::adjust() {
-    auto backlog = _current_backlog();
+    auto current = _current_backlog();
+    // React to where the backlog is heading, not just to where it is: a
+    // growing backlog gets its shares one interval early, a draining one
+    // releases them before it is fully consumed. This damps the oscillation
+    // between starving compaction and compaction storms around each
+    // control point.
+    auto backlog = std::max(0.0f, current + derivative_lead * (current - std::exchange(_last_backlog, current)));
 
     // interpolate to find out which region we are. This run infrequently and there are a fixed
     // number of points so a simple loop will do.
@@ -2145,6 +2554,13 @@ void backlog_controller::adjust() {
     control_point& cp = _control_points[idx];
     control_point& last = _control_points[idx - 1];
     float result = last.output + (backlog - last.input) * (cp.output - last.output)/(cp.input - last.input);
+    if (_foreground_pressure && _foreground_pressure() > 0) {
+        // Foreground work is queueing behind us; be nice until it drains.
+        // The backlog keeps growing meanwhile and will claim the shares
+        // back as soon as the foreground queue empties.
+        result /= 2;
+    }
+    result = std::max(_min_shares, std::min(result, _max_shares));
     update_controller(result);
 }
 
@@ -2229,6 +2645,9 @@ database::setup_metrics() {
                        sm::description("Counts sstables that survived the clustering key filtering. "
                                        "High value indicates that bloom filter is not very efficient and still have to access a lot of sstables to get data.")),
 
+        sm::make_derive("sstables_skipped_by_partition_tombstone", _cf_stats.sstables_skipped_by_partition_tombstone,
+                       sm::description("Counts sstables single-partition reads did not open because a newer partition tombstone covered everything they could contain.")),
+
         sm::make_derive("total_writes", _stats->total_writes,
                        sm::description("Counts the total number of successful write operations performed by this shard.")),
 
@@ -2239,6 +2658,11 @@ database::setup_metrics() {
         sm::make_derive("total_writes_timedout", _stats->total_writes_timedout,
                        sm::description("Counts write operations failed due to a timeout. A positive value is a sign of storage being overloaded.")),
 
+        sm::make_derive("large_writes", _stats->large_writes,
+                       sm::description("Counts writes whose size crossed half of the commitlog record size limit. "
+                                       "Such writes stall commitlog segment allocation and spike memtable memory; "
+                                       "the application should chunk large blobs into multiple cells.")),
+
         sm::make_derive("total_reads", _stats->total_reads,
                        sm::description("Counts the total number of successful reads on this shard.")),
 
@@ -2264,6 +2688,10 @@ database::setup_metrics() {
                        sm::description("Holds the number of currently queued read operations."),
                        {user_label_instance}),
 
+        sm::make_derive("total_queued_reads", _stats->total_queued_reads,
+                       sm::description("Counts reads that were not admitted immediately and had to wait for memory held by other reads to be released."),
+                       {user_label_instance}),
+
         sm::make_gauge("active_reads", [this] { return _stats->active_reads_streaming; },
                        sm::description("Holds the number of currently active read operations issued on behalf of streaming "),
                        {streaming_label_instance}),
@@ -2279,6 +2707,10 @@ database::setup_metrics() {
                        sm::description("Holds the number of currently queued read operations on behalf of streaming."),
                        {streaming_label_instance}),
 
+        sm::make_derive("total_queued_reads", _stats->total_queued_reads_streaming,
+                       sm::description("Counts reads issued on behalf of streaming that were not admitted immediately and had to wait for memory held by other reads to be released."),
+                       {streaming_label_instance}),
+
         sm::make_gauge("active_reads", [this] { return _stats->active_reads_system_keyspace; },
                        sm::description("Holds the number of currently active read operations from \"system\" keyspace tables. "),
                        {system_label_instance}),
@@ -2293,6 +2725,10 @@ database::setup_metrics() {
                        sm::description("Holds the number of currently queued read operations from \"system\" keyspace tables."),
                        {system_label_instance}),
 
+        sm::make_derive("total_queued_reads", _stats->total_queued_reads_system_keyspace,
+                       sm::description("Counts reads from \"system\" keyspace tables that were not admitted immediately and had to wait for memory held by other reads to be released."),
+                       {system_label_instance}),
+
         sm::make_gauge("total_result_bytes", [this] { return get_result_memory_limiter().total_used_memory(); },
                        sm::description("Holds the current amount of memory used for results.")),
 
@@ -2355,12 +2791,20 @@ future<> distributed_loader::populate_keyspace(distributed<database>& db, sstrin
 }
 
 static future<> populate(distributed<database>& db, sstring datadir) {
-    return lister::scan_dir(datadir, { directory_entry_type::directory }, [&db] (lister::path datadir, directory_entry de) {
-        auto& ks_name = de.name;
-        if (is_system_keyspace(ks_name)) {
+    // Scan first, populate later, so that keyspaces are loaded in parallel
+    // rather than in directory order. The per-shard sstable load semaphore
+    // still bounds how many sstables are being opened at any one time.
+    return do_with(std::vector<sstring>(), [&db, datadir] (std::vector<sstring>& ks_names) {
+        return lister::scan_dir(datadir, { directory_entry_type::directory }, [&ks_names] (lister::path datadir, directory_entry de) {
+            if (!is_system_keyspace(de.name)) {
+                ks_names.push_back(de.name);
+            }
             return make_ready_future<>();
-        }
-        return distributed_loader::populate_keyspace(db, datadir.native(), ks_name);
+        }).then([&db, &ks_names, datadir] {
+            return parallel_for_each(ks_names, [&db, datadir] (const sstring& ks_name) {
+                return distributed_loader::populate_keyspace(db, datadir, ks_name);
+            });
+        });
     });
 }
 
@@ -2507,7 +2951,7 @@ database::init_commitlog() {
                 _commitlog->discard_completed_segments(id);
                 return;
             }
-            _column_families[id]->flush();
+            _column_families[id]->flush(pos);
         }).release(); // we have longer life time than CL. Ignore reg anchor
     });
 }
@@ -2528,7 +2972,9 @@ database::shard_of(const frozen_mutation& m) {
     // sent the partition key in legacy form or together
     // with token.
     schema_ptr schema = find_schema(m.column_family_id());
-    return shard_of(dht::global_partitioner().get_token(*schema, m.key(*schema)));
+    // The token is cached in m, so the later apply on the owning shard
+    // won't hash the key again.
+    return shard_of(m.token(*schema));
 }
 
 void database::add_keyspace(sstring name, keyspace k) {
@@ -2766,6 +3212,7 @@ keyspace::make_column_family_config(const schema& s, const db::config& db_config
     cfg.streaming_read_concurrency_config = _config.streaming_read_concurrency_config;
     cfg.cf_stats = _config.cf_stats;
     cfg.enable_incremental_backups = _config.enable_incremental_backups;
+    cfg.enable_flush_merge = _config.enable_flush_merge;
     cfg.compaction_scheduling_group = _config.compaction_scheduling_group;
     cfg.memtable_scheduling_group = _config.memtable_scheduling_group;
     cfg.memtable_to_cache_scheduling_group = _config.memtable_to_cache_scheduling_group;
@@ -2951,6 +3398,22 @@ compare_atomic_cell_for_merge(atomic_cell_view left, atomic_cell_view right) {
     return 0;
 }
 
+// Range scans typically fill a whole page, so start their result buffer
+// with a full-sized chunk instead of growing it through the doubling
+// sequence of small chunks. Point reads keep the default small initial
+// chunk since their results are usually tiny.
+static size_t query_reserve_size(const dht::partition_range_vector& ranges, query::result_options opts) {
+    // Digest-only reads discard the serialized output, so there is nothing
+    // worth reserving buffer space for.
+    if (opts.request == query::result_request::only_digest) {
+        return 0;
+    }
+    auto is_scan = ranges.size() > 1 || std::any_of(ranges.begin(), ranges.end(), [] (const dht::partition_range& range) {
+        return !range.is_singular();
+    });
+    return is_scan ? bytes_ostream::max_chunk_size() : 0;
+}
+
 struct query_state {
     explicit query_state(schema_ptr s,
                          const query::read_command& cmd,
@@ -2959,7 +3422,7 @@ struct query_state {
                          query::result_memory_accounter memory_accounter = { })
             : schema(std::move(s))
             , cmd(cmd)
-            , builder(cmd.slice, opts, std::move(memory_accounter))
+            , builder(cmd.slice, opts, std::move(memory_accounter), query_reserve_size(ranges, opts))
             , limit(cmd.row_limit)
             , partition_limit(cmd.partition_limit)
             , current_partition_range(ranges.begin())
@@ -2991,12 +3454,21 @@ column_family::query(schema_ptr s, const query::read_command& cmd, query::result
                      uint64_t max_size, db::timeout_clock::time_point timeout) {
     utils::latency_counter lc;
     _stats.reads.set_latency(lc);
+    auto is_range_scan = partition_ranges.size() != 1 || !partition_ranges.front().is_singular();
+    if (!is_range_scan) {
+        sample_hot_partition(partition_ranges.front());
+    }
     auto f = opts.request == query::result_request::only_digest
              ? memory_limiter.new_digest_read(max_size) : memory_limiter.new_data_read(max_size);
-    return f.then([this, lc, s = std::move(s), &cmd, opts, &partition_ranges, trace_state = std::move(trace_state), timeout] (query::result_memory_accounter accounter) mutable {
+    return f.then([this, lc, is_range_scan, s = std::move(s), &cmd, opts, &partition_ranges, trace_state = std::move(trace_state), timeout] (query::result_memory_accounter accounter) mutable {
         auto qs_ptr = std::make_unique<query_state>(std::move(s), cmd, opts, partition_ranges, std::move(accounter));
         auto& qs = *qs_ptr;
         return do_until(std::bind(&query_state::done, &qs), [this, &qs, trace_state = std::move(trace_state), timeout] {
+            if (timeout <= db::timeout_clock::now()) {
+                // Multi-range scans can outlive the deadline mid-way; stop
+                // between ranges rather than finish a page nobody waits for.
+                return make_exception_future<>(timed_out_error());
+            }
             auto&& range = *qs.current_partition_range++;
             return data_query(qs.schema, as_mutation_source(), range, qs.cmd.slice, qs.remaining_rows(),
                               qs.remaining_partitions(), qs.cmd.timestamp, qs.builder, trace_state,
@@ -3004,15 +3476,50 @@ column_family::query(schema_ptr s, const query::read_command& cmd, query::result
         }).then([qs_ptr = std::move(qs_ptr), &qs] {
             return make_ready_future<lw_shared_ptr<query::result>>(
                     make_lw_shared<query::result>(qs.builder.build()));
-        }).finally([lc, this]() mutable {
+        }).finally([lc, is_range_scan, this]() mutable {
             _stats.reads.mark(lc);
+            if (is_range_scan) {
+                _stats.range_reads.mark(lc);
+            }
             if (lc.is_start()) {
                 _stats.estimated_read.add(lc.latency(), _stats.reads.hist.count);
+                if (is_range_scan) {
+                    _stats.estimated_range_read.add(lc.latency(), _stats.range_reads.hist.count);
+                }
             }
         });
     });
 }
 
+void
+column_family::sample_hot_partition(const dht::partition_range& pr) {
+    if (++_read_sample_ticker % hot_key_sample_rate) {
+        return;
+    }
+    auto& pos = pr.start()->value();
+    if (!pos.has_key()) {
+        return;
+    }
+    with_linearized_managed_bytes([&] {
+        _hot_keys.add(to_bytes(bytes_view(pos.key()->representation())));
+    });
+    if (_hot_keys.total() < hot_key_window) {
+        return;
+    }
+    if (auto* top = _hot_keys.top()) {
+        // count - error is a lower bound on the key's share of the sample.
+        auto guaranteed = top->count - top->error;
+        if (guaranteed * 4 >= _hot_keys.total()) {
+            dblog.warn("Hot partition in {}.{}: key {} accounts for at least {}% of recent single-partition reads on shard {}",
+                    _schema->ks_name(), _schema->cf_name(), to_hex(top->key),
+                    guaranteed * 100 / _hot_keys.total(), engine().cpu_id());
+        }
+    }
+    // Keep the estimator reflecting the recent stream; this also paces
+    // the warning above to at most once per half-window.
+    _hot_keys.age();
+}
+
 mutation_source
 column_family::as_mutation_source() const {
     return mutation_source([this] (schema_ptr s,
@@ -3043,6 +3550,12 @@ std::chrono::milliseconds column_family::get_coordinator_read_latency_percentile
 future<lw_shared_ptr<query::result>, cache_temperature>
 database::query(schema_ptr s, const query::read_command& cmd, query::result_options opts, const dht::partition_range_vector& ranges,
                 tracing::trace_state_ptr trace_state, uint64_t max_result_size, db::timeout_clock::time_point timeout) {
+    if (timeout <= db::timeout_clock::now()) {
+        // The coordinator's deadline has already passed; shed the read
+        // instead of queueing it on the query stage.
+        ++_stats->total_reads_failed;
+        return make_exception_future<lw_shared_ptr<query::result>, cache_temperature>(timed_out_error());
+    }
     column_family& cf = find_column_family(cmd.cf_id);
     return _data_query_stage(&cf, std::move(s), seastar::cref(cmd), opts, seastar::cref(ranges),
                             std::move(trace_state), seastar::ref(get_result_memory_limiter()),
@@ -3063,6 +3576,10 @@ database::query(schema_ptr s, const query::read_command& cmd, query::result_opti
 future<reconcilable_result, cache_temperature>
 database::query_mutations(schema_ptr s, const query::read_command& cmd, const dht::partition_range& range,
                           query::result_memory_accounter&& accounter, tracing::trace_state_ptr trace_state, db::timeout_clock::time_point timeout) {
+    if (timeout <= db::timeout_clock::now()) {
+        ++_stats->total_reads_failed;
+        return make_exception_future<reconcilable_result, cache_temperature>(timed_out_error());
+    }
     column_family& cf = find_column_family(cmd.cf_id);
     return mutation_query(std::move(s), cf.as_mutation_source(), range, cmd.slice, cmd.row_limit, cmd.partition_limit,
             cmd.timestamp, std::move(accounter), std::move(trace_state),
@@ -3229,6 +3746,7 @@ void column_family::apply_streaming_mutation(schema_ptr m_schema, utils::UUID pl
     if (dblog.is_enabled(logging::log_level::trace)) {
         dblog.trace("streaming apply {}", m.pretty_printer(m_schema));
     }
+    _streaming_plans_in_progress.insert(plan_id);
     if (fragmented) {
         apply_streaming_big_mutation(std::move(m_schema), plan_id, m);
         return;
@@ -3307,6 +3825,41 @@ future<> dirty_memory_manager::flush_one(memtable_list& mtlist, flush_permit&& p
     });
 }
 
+// Flushing a memtable costs I/O roughly proportional to its live data
+// (used_space), while it releases the memtable's whole allocated footprint
+// (total_space); the ratio between the two is how much dirty memory each
+// byte of flush I/O buys back, making a fragmented memtable a better deal
+// than a compact one of the same size. On top of that, a memtable which
+// grew since the previous selection is the one actually feeding the
+// pressure - flushing anything else just lets it keep growing - so recent
+// growth weighs several times stronger than resident size. A huge but idle
+// memtable therefore no longer automatically wins over a small,
+// fast-growing one.
+memtable* dirty_memory_manager::pick_flush_candidate() {
+    memtable* best = nullptr;
+    double best_score = 0;
+    std::unordered_map<const memtable*, uint64_t> sizes;
+    _virtual_region_group.for_each_region([&] (logalloc::region* r) {
+        auto& mt = memtable::from_region(*r);
+        auto occ = mt.occupancy();
+        if (!occ.total_space()) {
+            return;
+        }
+        auto i = _previous_flush_candidate_sizes.find(&mt);
+        uint64_t previous = i != _previous_flush_candidate_sizes.end() ? i->second : 0;
+        uint64_t growth = occ.total_space() > previous ? occ.total_space() - previous : 0;
+        auto efficiency = double(occ.total_space()) / double(std::max(occ.used_space(), size_t(1)));
+        auto score = double(occ.total_space()) * efficiency + double(growth) * _growth_weight;
+        sizes.emplace(&mt, occ.total_space());
+        if (!best || score > best_score) {
+            best = &mt;
+            best_score = score;
+        }
+    });
+    _previous_flush_candidate_sizes = std::move(sizes);
+    return best;
+}
+
 future<> dirty_memory_manager::flush_when_needed() {
     if (!_db) {
         return make_ready_future<>();
@@ -3315,6 +3868,19 @@ future<> dirty_memory_manager::flush_when_needed() {
     return do_until([this] { return _db_shutdown_requested; }, [this] {
         auto has_work = [this] { return has_pressure() || _db_shutdown_requested; };
         return _should_flush.wait(std::move(has_work)).then([this] {
+            // When the dirty limit itself is approaching, a single flush at
+            // a time no longer keeps up with ingest and writes start
+            // stalling on the throttle. Grant a second flush slot so two
+            // (typically small) memtables can drain in parallel, and take
+            // it back once the pressure recedes - non-blockingly, so if
+            // both slots are busy we simply retry on a later iteration.
+            bool limit_approaching = this->virtual_dirty_memory() > this->throttle_threshold() * 9 / 10;
+            if (limit_approaching && !_extra_flush_slot) {
+                _extra_flush_slot = true;
+                _flush_serializer.signal();
+            } else if (!limit_approaching && _extra_flush_slot && _flush_serializer.try_wait()) {
+                _extra_flush_slot = false;
+            }
             return get_flush_permit().then([this] (auto permit) {
                 // We give priority to explicit flushes. They are mainly user-initiated flushes,
                 // flushes coming from a DROP statement, or commitlog flushes.
@@ -3329,15 +3895,17 @@ future<> dirty_memory_manager::flush_when_needed() {
                 // flush. Most of the time we want some coordination with the commitlog to allow us to
                 // release commitlog segments as early as we can.
                 //
-                // But during pressure condition, we'll just pick the CF that holds the largest
-                // memtable. The advantage of doing this is that this is objectively the one that will
-                // release the biggest amount of memory and is less likely to be generating tiny
-                // SSTables.
-                memtable& candidate_memtable = memtable::from_region(*(this->_virtual_region_group.get_largest_region()));
+                // But during pressure condition, we pick the memtable whose flush releases the most
+                // memory per unit of flush work, weighing recent growth extra - see
+                // pick_flush_candidate() for the full rationale.
+                memtable* candidate_memtable = this->pick_flush_candidate();
+                if (!candidate_memtable) {
+                    return make_ready_future<>();
+                }
                 // Do not wait. The semaphore will protect us against a concurrent flush. But we
                 // want to start a new one as soon as the permits are destroyed and the semaphore is
                 // made ready again, not when we are done with the current one.
-                this->flush_one(*(candidate_memtable.get_memtable_list()), std::move(permit));
+                this->flush_one(*(candidate_memtable->get_memtable_list()), std::move(permit));
                 return make_ready_future<>();
             });
         });
@@ -3416,14 +3984,20 @@ future<> database::apply_with_commitlog(schema_ptr s, column_family& cf, utils::
     auto cl = cf.commitlog();
     if (cl != nullptr) {
         commitlog_entry_writer cew(s, m);
-        return cf.commitlog()->add_entry(uuid, cew, timeout).then([&m, this, s, timeout, cl](db::rp_handle h) {
-            return this->apply_in_memory(m, s, std::move(h), timeout).handle_exception(maybe_handle_reorder);
+        return cf.commitlog()->add_entry(uuid, cew, timeout).then([&m, this, s = std::move(s), timeout](db::rp_handle h) mutable {
+            return this->apply_in_memory(m, std::move(s), std::move(h), timeout).handle_exception(maybe_handle_reorder);
         });
     }
     return apply_in_memory(m, std::move(s), {}, timeout);
 }
 
 future<> database::do_apply(schema_ptr s, const frozen_mutation& m, db::timeout_clock::time_point timeout) {
+    if (timeout <= db::timeout_clock::now()) {
+        // The deadline passed while the mutation sat in the apply stage
+        // queue; the coordinator has already given up on it, so don't
+        // spend commitlog and memtable work on a response nobody wants.
+        return make_exception_future<>(timed_out_error());
+    }
     // I'm doing a nullcheck here since the init code path for db etc
     // is a little in flux and commitlog is created only when db is
     // initied from datadir.
@@ -3433,6 +4007,32 @@ future<> database::do_apply(schema_ptr s, const frozen_mutation& m, db::timeout_
         throw std::runtime_error(sprint("attempted to mutate using not synced schema of %s.%s, version=%s",
                                  s->ks_name(), s->cf_name(), s->version()));
     }
+    if (auto* cl = cf.commitlog()) {
+        auto size = m.representation().size();
+        auto limit = cl->max_record_size();
+        if (size > limit) {
+            // The commitlog would reject this anyway, but deep inside
+            // add_entry() with a bare size in the message and after the view
+            // update work was already done. Fail upfront and name the table.
+            return make_exception_future<>(std::invalid_argument(sprint(
+                    "Mutation of %d bytes for %s.%s exceeds the maximum commitlog record size of %d bytes; "
+                    "large blobs must be chunked into multiple cells by the application",
+                    size, s->ks_name(), s->cf_name(), limit)));
+        }
+        if (size > limit / 2) {
+            ++_stats->large_writes;
+            // One warning per interval is enough to point at the offender
+            // without the log amplifying the overload.
+            static thread_local db::timeout_clock::time_point last_warn;
+            auto now = db::timeout_clock::now();
+            if (now - last_warn > std::chrono::seconds(10)) {
+                last_warn = now;
+                dblog.warn("Large write of {} bytes to {}.{} (commitlog record limit is {} bytes); "
+                           "writes this size stall commitlog segments and spike memtable memory, "
+                           "consider chunking blobs at the application", size, s->ks_name(), s->cf_name(), limit);
+            }
+        }
+    }
     if (cf.views().empty()) {
         return apply_with_commitlog(std::move(s), cf, std::move(uuid), m, timeout);
     }
@@ -3470,12 +4070,108 @@ Future database::update_write_metrics(Future&& f) {
 }
 
 future<> database::apply(schema_ptr s, const frozen_mutation& m, db::timeout_clock::time_point timeout) {
+    if (timeout <= db::timeout_clock::now()) {
+        // Shed the mutation before it even queues on the apply stage.
+        return update_write_metrics(make_exception_future<>(timed_out_error()));
+    }
     if (dblog.is_enabled(logging::log_level::trace)) {
         dblog.trace("apply {}", m.pretty_printer(s));
     }
     return update_write_metrics(apply_stage(this, std::move(s), seastar::cref(m), timeout));
 }
 
+future<> database::apply_in_memory_batch(std::vector<std::pair<schema_ptr, frozen_mutation>>& muts, std::vector<size_t> idx,
+        utils::UUID uuid, std::vector<db::rp_handle> handles, db::timeout_clock::time_point timeout) {
+    auto& cf = find_column_family(uuid);
+    return cf.dirty_memory_region_group().run_when_memory_available(
+            [this, &muts, idx = std::move(idx), uuid, handles = std::move(handles)] () mutable {
+        for (size_t j = 0; j < idx.size(); ++j) {
+            auto h = handles.empty() ? db::rp_handle() : std::move(handles[j]);
+            auto& p = muts[idx[j]];
+            try {
+                auto& cf = find_column_family(uuid);
+                cf.apply(p.second, p.first, std::move(h));
+            } catch (no_such_column_family&) {
+                dblog.error("Attempting to mutate non-existent table {}", uuid);
+                return; // the rest of the group targets the same table
+            } catch (mutation_reordered_with_truncate_exception&) {
+                // Same as maybe_handle_reorder(): the mutation raced with a
+                // truncate, so we can just drop it.
+                dblog.debug("replay_position reordering detected");
+            }
+        }
+    }, timeout);
+}
+
+future<> database::apply_table_batch(std::vector<std::pair<schema_ptr, frozen_mutation>>& muts, std::vector<size_t> idx, db::timeout_clock::time_point timeout) {
+    auto uuid = muts[idx.front()].second.column_family_id();
+    auto& cf = find_column_family(uuid);
+    for (auto i : idx) {
+        auto& s = muts[i].first;
+        if (!s->is_synced()) {
+            throw std::runtime_error(sprint("attempted to mutate using not synced schema of %s.%s, version=%s",
+                                     s->ks_name(), s->cf_name(), s->version()));
+        }
+    }
+    if (!cf.views().empty()) {
+        // View updates read before they write, under a partition lock, so
+        // there is nothing to amortize; use the one-by-one path.
+        return do_for_each(idx, [this, &muts, timeout] (size_t i) {
+            return do_apply(muts[i].first, muts[i].second, timeout);
+        });
+    }
+    auto cl = cf.commitlog();
+    if (cl != nullptr) {
+        std::vector<std::pair<utils::UUID, commitlog_entry_writer>> entries;
+        entries.reserve(idx.size());
+        for (auto i : idx) {
+            entries.emplace_back(uuid, commitlog_entry_writer(muts[i].first, muts[i].second));
+        }
+        return cl->add_entries(std::move(entries), timeout).then(
+                [this, &muts, idx = std::move(idx), uuid, timeout] (std::vector<db::rp_handle> handles) mutable {
+            return apply_in_memory_batch(muts, std::move(idx), uuid, std::move(handles), timeout);
+        });
+    }
+    return apply_in_memory_batch(muts, std::move(idx), uuid, {}, timeout);
+}
+
+future<> database::apply_batch(std::vector<std::pair<schema_ptr, frozen_mutation>> muts, db::timeout_clock::time_point timeout) {
+    if (muts.empty()) {
+        return make_ready_future<>();
+    }
+    auto n = muts.size();
+    if (timeout <= db::timeout_clock::now()) {
+        _stats->total_writes_failed += n;
+        _stats->total_writes_timedout += n;
+        return make_exception_future<>(timed_out_error());
+    }
+    return do_with(std::move(muts), std::unordered_map<utils::UUID, std::vector<size_t>>(),
+            [this, timeout] (std::vector<std::pair<schema_ptr, frozen_mutation>>& muts, auto& groups) {
+        for (size_t i = 0; i < muts.size(); ++i) {
+            groups[muts[i].second.column_family_id()].push_back(i);
+        }
+        return parallel_for_each(groups, [this, &muts, timeout] (std::pair<const utils::UUID, std::vector<size_t>>& g) {
+            return futurize_apply([&] {
+                return apply_table_batch(muts, std::move(g.second), timeout);
+            });
+        });
+    }).then_wrapped([s = _stats, n] (future<> f) {
+        // Same accounting as update_write_metrics(), batch-sized.
+        if (f.failed()) {
+            s->total_writes_failed += n;
+            try {
+                f.get();
+            } catch (const timed_out_error&) {
+                s->total_writes_timedout += n;
+                throw;
+            }
+            assert(0 && "should not reach");
+        }
+        s->total_writes += n;
+        return f;
+    });
+}
+
 future<> database::apply_streaming_mutation(schema_ptr s, utils::UUID plan_id, const frozen_mutation& m, bool fragmented) {
     if (!s->is_synced()) {
         throw std::runtime_error(sprint("attempted to mutate using not synced schema of %s.%s, version=%s",
@@ -3498,6 +4194,7 @@ database::make_keyspace_config(const keyspace_metadata& ksm) {
         cfg.enable_disk_reads = true; // we allways read from disk
         cfg.enable_commitlog = ksm.durable_writes() && _cfg->enable_commitlog() && !_cfg->enable_in_memory_data_store();
         cfg.enable_cache = _cfg->enable_cache();
+        cfg.enable_flush_merge = _cfg->flush_merge_enabled();
 
     } else {
         cfg.datadir = "";
@@ -3510,6 +4207,7 @@ database::make_keyspace_config(const keyspace_metadata& ksm) {
     cfg.streaming_dirty_memory_manager = &_streaming_dirty_memory_manager;
     cfg.read_concurrency_config.resources_sem = &_read_concurrency_sem;
     cfg.read_concurrency_config.active_reads = &_stats->active_reads;
+    cfg.read_concurrency_config.total_queued_reads = &_stats->total_queued_reads;
     cfg.read_concurrency_config.max_queue_length = 100;
     cfg.read_concurrency_config.raise_queue_overloaded_exception = [this] {
         ++_stats->sstable_read_queue_overloaded;
@@ -3519,6 +4217,7 @@ database::make_keyspace_config(const keyspace_metadata& ksm) {
     // Trust the caller to limit concurrency.
     cfg.streaming_read_concurrency_config.resources_sem = &_streaming_concurrency_sem;
     cfg.streaming_read_concurrency_config.active_reads = &_stats->active_reads_streaming;
+    cfg.streaming_read_concurrency_config.total_queued_reads = &_stats->total_queued_reads_streaming;
     cfg.cf_stats = &_cf_stats;
     cfg.enable_incremental_backups = _enable_incremental_backups;
 
@@ -3616,7 +4315,11 @@ schema_ptr database::find_indexed_table(const sstring& ks_name, const sstring& i
 
 future<>
 database::stop() {
-    return _compaction_manager->stop().then([this] {
+    _summary_resampling_timer.cancel();
+    _stats_snapshot_timer.cancel();
+    return _summary_resampling_gate.close().then([this] {
+        return _compaction_manager->stop();
+    }).then([this] {
         // try to ensure that CL has done disk flushing
         if (_commitlog != nullptr) {
             return _commitlog->shutdown();
@@ -3669,26 +4372,33 @@ column_family::run_with_compaction_disabled(std::function<future<> ()> func) {
 }
 
 future<> database::truncate(const keyspace& ks, column_family& cf, timestamp_func tsf, bool with_snapshot) {
-    return cf.run_async([this, &ks, &cf, tsf = std::move(tsf), with_snapshot] {
-        const auto durable = ks.metadata()->durable_writes();
+    return cf.run_async([this, &cf, tsf = std::move(tsf), with_snapshot] {
         const auto auto_snapshot = with_snapshot && get_config().auto_snapshot();
 
         // Force mutations coming in to re-acquire higher rp:s
         // This creates a "soft" ordering, in that we will guarantee that
-        // any sstable written _after_ we issue the flush below will
-        // only have higher rp:s than we will get from the discard_sstable
-        // call.
+        // any data written _after_ this point will only have higher rp:s
+        // than anything we drop below.
         auto low_mark = cf.set_low_replay_position_mark();
 
 
-        return cf.run_with_compaction_disabled([&cf, durable, auto_snapshot, tsf = std::move(tsf), low_mark]() mutable {
+        return cf.run_with_compaction_disabled([&cf, auto_snapshot, tsf = std::move(tsf), low_mark]() mutable {
             future<> f = make_ready_future<>();
-            if (durable || auto_snapshot) {
+            if (auto_snapshot) {
+                // A snapshot promises that the pre-truncation data is on
+                // disk, so this path cannot avoid the flush barrier.
+                //
                 // TODO:
                 // this is not really a guarantee at all that we've actually
                 // gotten all things to disk. Again, need queue-ish or something.
                 f = cf.flush();
             } else {
+                // The data is about to be deleted anyway, so there is no
+                // point in paying for a flush just to discard its output:
+                // drop the memtables outright and rely on the truncation
+                // record saved below to fence the commitlog entries that
+                // backed them out of replay. This makes TRUNCATE return
+                // without waiting for a flush of the busiest memtable.
                 f = cf.clear();
             }
             return f.then([&cf, auto_snapshot, tsf = std::move(tsf), low_mark] {
@@ -3703,12 +4413,13 @@ future<> database::truncate(const keyspace& ks, column_family& cf, timestamp_fun
                     }
                     return f.then([&cf, truncated_at, low_mark] {
                         return cf.discard_sstables(truncated_at).then([&cf, truncated_at, low_mark](db::replay_position rp) {
-                            // TODO: verify that rp == db::replay_position is because we have no sstables (and no data flushed)
-                            if (rp == db::replay_position()) {
-                                return make_ready_future();
-                            }
+                            // Everything we dropped - discarded sstables and
+                            // cleared memtables alike - was applied before the
+                            // low mark was set, so recording the higher of the
+                            // two makes commitlog replay skip the truncated
+                            // writes even when they were never flushed.
+                            rp = std::max(rp, low_mark);
                             // TODO: indexes.
-                            assert(low_mark <= rp);
                             return db::system_keyspace::save_truncation_record(cf, truncated_at, rp);
                         });
                     });
@@ -3998,10 +4709,86 @@ future<std::unordered_map<sstring, column_family::snapshot_details>> column_fami
     });
 }
 
+// Guards against path components smuggled in through the REST API; the
+// uploader only ever deals in plain component file names.
+static void validate_backup_file_name(const sstring& name) {
+    if (name.empty() || name.find('/') != sstring::npos || name == "." || name == "..") {
+        throw std::invalid_argument(sprint("invalid backup file name: %s", name));
+    }
+}
+
+future<std::vector<sstring>> column_family::pending_backup_files() {
+    auto backupdir = lister::path(_config.datadir) / "backups";
+    return do_with(std::vector<sstring>(), std::move(backupdir), [] (auto& files, const lister::path& backupdir) {
+        return io_check([&] { return engine().file_exists(backupdir.native()); }).then([&files, &backupdir] (bool exists) {
+            if (!exists) {
+                // Nothing was flushed since incremental backups were enabled.
+                return make_ready_future<>();
+            }
+            return lister::scan_dir(backupdir, { directory_entry_type::regular }, [&files] (lister::path parent_dir, directory_entry de) {
+                files.push_back(std::move(de.name));
+                return make_ready_future<>();
+            }, &column_family::manifest_json_filter);
+        }).then([&files] {
+            return std::move(files);
+        });
+    });
+}
+
+future<> column_family::copy_backup_file(sstring name, output_stream<char>& out) {
+    validate_backup_file_name(name);
+    auto filename = (lister::path(_config.datadir) / "backups" / name.c_str()).native();
+    return open_checked_file_dma(general_disk_error_handler, std::move(filename), open_flags::ro).then([&out] (file f) {
+        // The backup links are read with direct I/O, so shipping a backup
+        // does not evict hot sstable data from the page cache, and at the
+        // backup priority class, so it only consumes otherwise idle disk
+        // bandwidth.
+        file_input_stream_options options;
+        options.buffer_size = 128 * 1024;
+        options.read_ahead = 4;
+        options.io_priority_class = service::get_local_backup_priority();
+        return do_with(make_file_input_stream(std::move(f), options), [&out] (input_stream<char>& in) {
+            return repeat([&in, &out] {
+                return in.read().then([&out] (temporary_buffer<char> buf) {
+                    if (buf.empty()) {
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    }
+                    return out.write(buf.get(), buf.size()).then([] {
+                        return stop_iteration::no;
+                    });
+                });
+            }).finally([&in] {
+                return in.close();
+            });
+        });
+    });
+}
+
+future<> column_family::remove_backup_file(sstring name) {
+    validate_backup_file_name(name);
+    auto backupdir = _config.datadir + "/backups";
+    return io_check(remove_file, backupdir + "/" + name).then([backupdir = std::move(backupdir)] {
+        return io_check(sync_directory, std::move(backupdir));
+    });
+}
+
 future<> column_family::flush() {
     return _memtables->request_flush();
 }
 
+future<> column_family::flush(const db::replay_position& pos) {
+    // The commitlog wants the segments below pos released. Memtables already
+    // sealed have their flushes in flight and will release their segments on
+    // completion; sealing the active memtable helps only if it actually holds
+    // data in one of those older segments. Skipping the seal otherwise keeps
+    // one slow flush of a big table from making every other dirty table churn
+    // out a tiny sstable each time the commitlog hits its size threshold.
+    if (!_memtables->active_memtable().rp_set().has_segment_before(pos.id)) {
+        return make_ready_future<>();
+    }
+    return _memtables->request_flush();
+}
+
 // FIXME: We can do much better than this in terms of cache management. Right
 // now, we only have to flush the touched ranges because of the possibility of
 // streaming containing token ownership changes.
@@ -4020,13 +4807,14 @@ future<> column_family::flush_streaming_mutations(utils::UUID plan_id, dht::part
         return flush_streaming_big_mutations(plan_id).then([this, ranges = std::move(ranges)] (auto sstables) mutable {
             return _streaming_memtables->seal_active_memtable_delayed().then([this] {
                 return _streaming_flush_phaser.advance_and_await();
-            }).then([this, sstables = std::move(sstables), ranges = std::move(ranges)] () mutable {
-                return _cache.invalidate([this, sstables = std::move(sstables)] () mutable noexcept {
+            }).then([this, plan_id, sstables = std::move(sstables), ranges = std::move(ranges)] () mutable {
+                return _cache.invalidate([this, plan_id, sstables = std::move(sstables)] () mutable noexcept {
                     // FIXME: this is not really noexcept, but we need to provide strong exception guarantees.
                     for (auto&& sst : sstables) {
                         // seal_active_streaming_memtable_big() ensures sst is unshared.
                         this->add_sstable(sst.sstable, {engine().cpu_id()});
                     }
+                    _streaming_plans_in_progress.erase(plan_id);
                     this->try_trigger_compaction();
                 }, std::move(ranges));
             });
@@ -4055,8 +4843,14 @@ future<std::vector<column_family::monitored_sstable>> column_family::flush_strea
 }
 
 future<> column_family::fail_streaming_mutations(utils::UUID plan_id) {
+    _streaming_plans_in_progress.erase(plan_id);
     auto it = _streaming_memtables_big.find(plan_id);
     if (it == _streaming_memtables_big.end()) {
+        // The small sstables which were flushed (but not compacted) while
+        // this plan was in progress still need integrating.
+        if (_streaming_plans_in_progress.empty()) {
+            try_trigger_compaction();
+        }
         return make_ready_future<>();
     }
     auto entry = it->second;
@@ -4065,6 +4859,9 @@ future<> column_family::fail_streaming_mutations(utils::UUID plan_id) {
         for (auto&& sst : entry->sstables) {
             sst.sstable->mark_for_deletion();
         }
+        if (_streaming_plans_in_progress.empty()) {
+            try_trigger_compaction();
+        }
     });
 }
 
@@ -4077,6 +4874,7 @@ future<> column_family::clear() {
     _streaming_memtables->clear();
     _streaming_memtables->add_memtable();
     _streaming_memtables_big.clear();
+    _streaming_plans_in_progress.clear();
     return _cache.invalidate([] { /* There is no underlying mutation source */ });
 }
 
@@ -4109,6 +4907,7 @@ future<db::replay_position> column_family::discard_sstables(db_clock::time_point
                 }
 
                 cf._sstables = std::move(pruned);
+                ++cf._sstable_set_version;
             }
         };
         auto p = make_lw_shared<pruner>(*this);
@@ -4116,12 +4915,45 @@ future<db::replay_position> column_family::discard_sstables(db_clock::time_point
             p->prune(truncated_at);
             dblog.debug("cleaning out row cache");
         }).then([this, p]() mutable {
-            return parallel_for_each(p->remove, [this](sstables::shared_sstable s) {
+            // The pruned sstables are no longer visible to new reads, so
+            // truncation does not have to wait for their files to go away.
+            // Delete them in the background, the same way compaction disposes
+            // of its inputs; until then they are tracked in
+            // _sstables_compacted_but_not_deleted so their disk space is
+            // still accounted for.
+            _sstables_compacted_but_not_deleted.insert(_sstables_compacted_but_not_deleted.end(),
+                    p->remove.begin(), p->remove.end());
+            for (auto& s : p->remove) {
                 _compaction_strategy.get_backlog_tracker().remove_sstable(s);
-                return sstables::delete_atomically({s});
-            }).then([p] {
-                return make_ready_future<db::replay_position>(p->rp);
+            }
+            rebuild_statistics();
+
+            seastar::with_gate(_sstable_deletion_gate, [this, p] {
+                return parallel_for_each(p->remove, [](sstables::shared_sstable s) {
+                    return sstables::delete_atomically({s});
+                }).then_wrapped([this, p] (future<> f) {
+                    // unconditionally stop tracking the discarded sstables, or
+                    // they could stay forever in the set, resulting in deleted
+                    // files remaining opened and disk space not being released
+                    // until shutdown.
+                    std::unordered_set<sstables::shared_sstable> s(p->remove.begin(), p->remove.end());
+                    auto e = boost::range::remove_if(_sstables_compacted_but_not_deleted, [&] (sstables::shared_sstable sst) -> bool {
+                        return s.count(sst);
+                    });
+                    _sstables_compacted_but_not_deleted.erase(e, _sstables_compacted_but_not_deleted.end());
+                    rebuild_statistics();
+                    try {
+                        f.get();
+                    } catch (...) {
+                        dblog.warn("Failed to delete truncated sstables of {}.{}: {}",
+                                _schema->ks_name(), _schema->cf_name(), std::current_exception());
+                    }
+                    // refresh underlying data source in row cache to prevent it from holding
+                    // reference to sstables files which were previously deleted.
+                    _cache.refresh_snapshot();
+                });
             });
+            return make_ready_future<db::replay_position>(p->rp);
         });
     });
 }
@@ -4178,6 +5010,15 @@ void column_family::set_schema(schema_ptr s) {
     dblog.debug("Changing schema version of {}.{} ({}) from {} to {}",
                 _schema->ks_name(), _schema->cf_name(), _schema->id(), _schema->version(), s->version());
 
+    // Memtable and cache entries are upgraded lazily on read (see
+    // schema_upgrader.hh), so most schema changes are a pointer swap.
+    // Rebuilding the compaction strategy (and its sstable set and backlog
+    // tracker) and kicking off compaction is only warranted when the
+    // compaction configuration itself changed; doing it for a metadata-only
+    // ALTER turns every schema change into an I/O event.
+    auto compaction_reconfigured = _schema->compaction_strategy() != s->compaction_strategy()
+            || _schema->compaction_strategy_options() != s->compaction_strategy_options();
+
     for (auto& m : *_memtables) {
         m->set_schema(s);
     }
@@ -4196,8 +5037,10 @@ void column_family::set_schema(schema_ptr s) {
     _counter_cell_locks->set_schema(s);
     _schema = std::move(s);
 
-    set_compaction_strategy(_schema->compaction_strategy());
-    trigger_compaction();
+    if (compaction_reconfigured) {
+        set_compaction_strategy(_schema->compaction_strategy());
+        trigger_compaction();
+    }
 }
 
 static std::vector<view_ptr>::iterator find_view(std::vector<view_ptr>& views, const view_ptr& v) {
@@ -4254,10 +5097,19 @@ future<> column_family::generate_and_propagate_view_updates(const schema_ptr& ba
                         std::move(views),
                         flat_mutation_reader_from_mutations({std::move(m)}),
                         std::move(existings)).then([base_token = std::move(base_token)] (auto&& updates) {
-        db::view::mutate_MV(std::move(base_token), std::move(updates));
+        return db::view::mutate_MV(std::move(base_token), std::move(updates));
     });
 }
 
+future<> column_family::populate_view(view_ptr view, mutation&& m) const {
+    if (!db::view::partition_key_matches(*_schema, *view->view_info(), m.decorated_key())) {
+        return make_ready_future<>();
+    }
+    std::vector<view_ptr> views;
+    views.push_back(std::move(view));
+    return generate_and_propagate_view_updates(_schema, std::move(views), std::move(m), { });
+}
+
 /**
  * Given an update for the base table, calculates the set of potentially affected views,
  * generates the relevant updates, and sends them to the paired view replicas.
@@ -4507,6 +5359,36 @@ write_memtable_to_sstable(memtable& mt, sstables::shared_sstable sst,
                                  mt.partition_count(), mt.schema(), cfg, pc);
 }
 
+future<>
+write_memtable_to_sstable(memtable& mt, std::vector<sstables::shared_sstable> merge_with,
+                          sstables::shared_sstable sst, sstables::write_monitor& monitor,
+                          bool backup, const io_priority_class& pc, bool leave_unsealed) {
+    if (merge_with.empty()) {
+        return write_memtable_to_sstable(mt, std::move(sst), monitor, backup, pc, leave_unsealed);
+    }
+    sstables::sstable_writer_config cfg;
+    // The sstables being absorbed were flushed earlier, so their replay
+    // positions cannot be newer than the memtable's.
+    cfg.replay_position = mt.replay_position();
+    cfg.backup = backup;
+    cfg.leave_unsealed = leave_unsealed;
+    cfg.monitor = &monitor;
+    auto schema = mt.schema();
+    std::vector<flat_mutation_reader> readers;
+    readers.reserve(merge_with.size() + 1);
+    readers.emplace_back(mt.make_flush_reader(schema, pc));
+    uint64_t estimated_partitions = mt.partition_count();
+    for (auto& t : merge_with) {
+        readers.emplace_back(t->as_mutation_source().make_reader(schema, query::full_partition_range, schema->full_slice(), pc));
+        estimated_partitions += t->get_estimated_key_count();
+    }
+    // Note that unlike compaction this is a pure merge: nothing is purged,
+    // so the output is exactly the union of its inputs and can safely
+    // replace them the moment it is sealed.
+    return sst->write_components(make_combined_reader(schema, std::move(readers)),
+                                 estimated_partitions, schema, cfg, pc);
+}
+
 future<>
 write_memtable_to_sstable(memtable& mt, sstables::shared_sstable sst) {
     return do_with(permit_monitor(sstable_write_permit::unconditional()), [&mt, sst] (auto& monitor) {
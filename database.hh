@@ -32,6 +32,7 @@
 #include "utils/UUID_gen.hh"
 #include "utils/UUID.hh"
 #include "utils/hash.hh"
+#include "utils/space_saving.hh"
 #include "db_clock.hh"
 #include "gc_clock.hh"
 #include <chrono>
@@ -39,6 +40,7 @@
 #include <functional>
 #include <cstdint>
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
 #include <set>
 #include <iosfwd>
@@ -105,6 +107,7 @@ namespace sstables {
 class sstable;
 class entry_descriptor;
 class compaction_descriptor;
+enum class compaction_type;
 class foreign_sstable_open_info;
 
 }
@@ -271,6 +274,9 @@ struct cf_stats {
     int64_t clustering_filter_fast_path_count = 0;
     // how many sstables survived the clustering key checks
     int64_t surviving_sstables_after_clustering_filter = 0;
+    // how many sstables a single-partition read did not even open because a
+    // newer partition tombstone covered everything they could contain
+    int64_t sstables_skipped_by_partition_tombstone = 0;
 };
 
 class cache_temperature {
@@ -296,6 +302,7 @@ public:
         bool enable_cache = true;
         bool enable_commitlog = true;
         bool enable_incremental_backups = false;
+        bool enable_flush_merge = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         ::dirty_memory_manager* streaming_dirty_memory_manager = &default_dirty_memory_manager;
         restricted_mutation_reader_config read_concurrency_config;
@@ -322,14 +329,44 @@ public:
         int64_t pending_compactions = 0;
         utils::timed_rate_moving_average_and_histogram reads{256};
         utils::timed_rate_moving_average_and_histogram writes{256};
+        /** Multi-partition (range scan) reads; a subset of `reads`. */
+        utils::timed_rate_moving_average_and_histogram range_reads{256};
         utils::estimated_histogram estimated_read;
         utils::estimated_histogram estimated_write;
+        utils::estimated_histogram estimated_range_read;
         utils::estimated_histogram estimated_sstable_per_read{35};
         utils::timed_rate_moving_average_and_histogram tombstone_scanned;
         utils::timed_rate_moving_average_and_histogram live_scanned;
         utils::estimated_histogram estimated_coordinator_read;
     };
 
+    // A snapshot of the plain counters in stats, published periodically by
+    // each shard into a preallocated, seqlock-protected block which any
+    // shard may read directly. This lets the REST API aggregate per-table
+    // counters with plain memory reads instead of a map_reduce over all
+    // shards for every poll. See database::publish_stats_snapshots().
+    struct stats_snapshot {
+        utils::UUID id;
+        int64_t memtable_switch_count = 0;
+        int64_t pending_flushes = 0;
+        int64_t live_disk_space_used = 0;
+        int64_t total_disk_space_used = 0;
+        int64_t live_sstable_count = 0;
+        int64_t pending_compactions = 0;
+        int64_t reads_count = 0;
+        int64_t writes_count = 0;
+        bool used = false;
+    };
+    // Map a stats member the REST API asks for to its snapshot field, or
+    // nullptr if that member is not covered by the snapshots.
+    static int64_t stats_snapshot::* snapshot_member(int64_t stats::*f);
+    static int64_t stats_snapshot::* snapshot_member(utils::timed_rate_moving_average_and_histogram stats::*f);
+    // Sum `member` across all shards' published snapshots of table `id`,
+    // or across all tables if `id` is disengaged. Returns a disengaged
+    // optional if some shard has not published a usable snapshot yet, in
+    // which case the caller should fall back to a cross-shard map_reduce.
+    static stdx::optional<int64_t> sum_stats_snapshots(stdx::optional<utils::UUID> id, int64_t stats_snapshot::* member);
+
     struct snapshot_details {
         int64_t total;
         int64_t live;
@@ -389,6 +426,13 @@ private:
     };
     std::unordered_map<utils::UUID, lw_shared_ptr<streaming_memtable_big>> _streaming_memtables_big;
 
+    // Streaming plans currently writing into this table. While any is in
+    // progress, the small sstables produced by streaming memtable flushes
+    // are not submitted for compaction - the completed plan integrates
+    // them with a single compaction trigger instead of having the strategy
+    // recompact them several times mid-rebuild.
+    std::unordered_set<utils::UUID> _streaming_plans_in_progress;
+
     future<std::vector<monitored_sstable>> flush_streaming_big_mutations(utils::UUID plan_id);
     void apply_streaming_big_mutation(schema_ptr m_schema, utils::UUID plan_id, const frozen_mutation& m);
     future<> seal_active_streaming_memtable_big(streaming_memtable_big& smb, flush_permit&&);
@@ -401,6 +445,29 @@ private:
     sstables::compaction_strategy _compaction_strategy;
     // generation -> sstable. Ordered by key so we can easily get the most recent.
     lw_shared_ptr<sstables::sstable_set> _sstables;
+    // Bumped whenever the set of live sstables changes (flush, compaction,
+    // truncation), so caches derived from the sstable set - the
+    // size_estimates virtual table in particular - can tell whether their
+    // entries are still current with a single comparison.
+    uint64_t _sstable_set_version = 0;
+    // Partition keys recently confirmed by the single-key read path to be
+    // absent from every sstable, so repeated reads of missing keys (e.g.
+    // dedup-style checks) cost one hash lookup instead of a bloom filter
+    // probe per sstable. Exact keys, not a probabilistic filter: a false
+    // "absent" answer would hide live data. Cleared whenever an sstable is
+    // added; compaction only rewrites existing partitions, so rebuilding
+    // the sstable list doesn't need to invalidate it.
+    std::unordered_set<bytes> _absent_partitions;
+    uint64_t _absent_partitions_generation = 0;
+    static constexpr size_t max_absent_partition_entries = 8192;
+    // Tracks the hottest partitions among this shard's recent
+    // single-partition reads over a 1-in-16 sample, so that skewed
+    // workloads which pin one shard can be identified and reported.
+    utils::space_saving<bytes> _hot_keys{8};
+    uint64_t _read_sample_ticker = 0;
+    static constexpr unsigned hot_key_sample_rate = 16;
+    static constexpr uint64_t hot_key_window = 4096;
+    void sample_hot_partition(const dht::partition_range& pr);
     // sstables that have been compacted (so don't look up in query) but
     // have not been deleted yet, so must not GC any tombstones in other sstables
     // that may delete data in these sstables:
@@ -619,6 +686,16 @@ public:
     using const_mutation_partition_ptr = std::unique_ptr<const mutation_partition>;
     using const_row_ptr = std::unique_ptr<const row>;
     memtable& active_memtable() { return _memtables->active_memtable(); }
+    // Whether all memtables, active and sealing, are empty, i.e. all of
+    // the column family's data on this shard resides in sstables.
+    bool memtables_empty() const {
+        for (auto&& mt : *_memtables) {
+            if (!mt->empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
     const row_cache& get_row_cache() const {
         return _cache;
     }
@@ -664,6 +741,10 @@ public:
     void start();
     future<> stop();
     future<> flush();
+    // Flush only if the active memtable holds data in a commitlog segment
+    // older than pos, i.e. if flushing would help releasing segments below
+    // that point. Used by the commitlog pressure handler.
+    future<> flush(const db::replay_position& pos);
     future<> flush_streaming_mutations(utils::UUID plan_id, dht::partition_range_vector ranges = dht::partition_range_vector{});
     future<> fail_streaming_mutations(utils::UUID plan_id);
     future<> clear(); // discards memtable(s) without flushing them to disk.
@@ -706,9 +787,10 @@ public:
     // not a real compaction policy.
     future<> compact_all_sstables();
     // Compact all sstables provided in the vector.
-    // If cleanup is set to true, compaction_sstables will run on behalf of a cleanup job,
+    // If type is Cleanup, compact_sstables will run on behalf of a cleanup job,
     // meaning that irrelevant keys will be discarded.
-    future<> compact_sstables(sstables::compaction_descriptor descriptor, bool cleanup = false);
+    future<> compact_sstables(sstables::compaction_descriptor descriptor, sstables::compaction_type type);
+    future<> compact_sstables(sstables::compaction_descriptor descriptor);
     // Performs a cleanup on each sstable of this column family, excluding
     // those ones that are irrelevant to this node or being compacted.
     // Cleanup is about discarding keys that are no longer relevant for a
@@ -723,6 +805,19 @@ public:
     future<> snapshot(sstring name);
     future<std::unordered_map<sstring, snapshot_details>> get_snapshot_details();
 
+    // Incremental backup shipping. When incremental backups are enabled,
+    // every sealed sstable is hardlinked into <datadir>/backups/ and sits
+    // there until an uploader ships it off-node. The methods below let the
+    // uploader drive that directly through the REST API instead of re-reading
+    // the data files through the page cache with external tools: list the
+    // components that still await shipping, stream one of them with direct
+    // I/O at the dedicated backup priority, and drop its link once shipped.
+    // The backups directory is per-node, so these run on whatever shard
+    // handles the request.
+    future<std::vector<sstring>> pending_backup_files();
+    future<> copy_backup_file(sstring name, output_stream<char>& out);
+    future<> remove_backup_file(sstring name);
+
     const bool incremental_backups_enabled() const {
         return _config.enable_incremental_backups;
     }
@@ -740,12 +835,21 @@ public:
     std::vector<sstables::shared_sstable> sstables_need_rewrite() const;
     size_t sstables_count() const;
     std::vector<uint64_t> sstable_count_per_level() const;
+    // See _sstable_set_version.
+    uint64_t sstable_set_version() const {
+        return _sstable_set_version;
+    }
+    // Lightweight partition count estimate built from the sstable summaries
+    // and memtables; maintained as a side effect of writes, so cheap enough
+    // for cost-based decisions at query time. May count a partition once per
+    // sstable it appears in.
+    uint64_t estimate_partition_count() const;
     int64_t get_unleveled_sstables() const;
 
     void start_compaction();
     void trigger_compaction();
     void try_trigger_compaction() noexcept;
-    future<> run_compaction(sstables::compaction_descriptor descriptor);
+    future<> run_compaction(sstables::compaction_descriptor descriptor, sstables::compaction_type type);
     void set_compaction_strategy(sstables::compaction_strategy_type strategy);
     const sstables::compaction_strategy& get_compaction_strategy() const {
         return _compaction_strategy;
@@ -763,6 +867,32 @@ public:
         return _config.cf_stats;
     }
 
+    // Negative partition-existence cache, maintained by the single-key
+    // sstable read path. The generation guards against a reader created
+    // against an older sstable list repopulating the cache after an
+    // invalidation.
+    uint64_t absent_partitions_generation() const {
+        return _absent_partitions_generation;
+    }
+    bool partition_known_absent(bytes_view key) const {
+        return !_absent_partitions.empty() && _absent_partitions.count(to_bytes(key));
+    }
+    void note_partition_absent(bytes_view key, uint64_t generation) {
+        if (generation != _absent_partitions_generation) {
+            return;
+        }
+        if (_absent_partitions.size() >= max_absent_partition_entries) {
+            // Wholesale eviction is cheap and the hot misses will be
+            // re-added on their next read.
+            _absent_partitions.clear();
+        }
+        _absent_partitions.emplace(to_bytes(key));
+    }
+    void invalidate_absent_partitions() {
+        _absent_partitions.clear();
+        ++_absent_partitions_generation;
+    }
+
     compaction_manager& get_compaction_manager() const {
         return _compaction_manager;
     }
@@ -785,6 +915,13 @@ public:
     void remove_view(view_ptr v);
     const std::vector<view_ptr>& views() const;
     future<row_locker::lock_holder> push_view_replica_updates(const schema_ptr& s, const frozen_mutation& fm) const;
+
+    // Build-path counterpart of push_view_replica_updates(): streams base
+    // data which already exists on this replica through view update
+    // generation for the given view only. No read-before-write or locking
+    // is needed since there are no concurrent view entries to reconcile
+    // with - regenerating the same updates is idempotent.
+    future<> populate_view(view_ptr view, mutation&& m) const;
     void add_coordinator_read_latency(utils::estimated_histogram::duration latency);
     std::chrono::milliseconds get_coordinator_read_latency_percentile(double percentile);
 
@@ -970,6 +1107,7 @@ public:
         bool enable_disk_writes = true;
         bool enable_cache = true;
         bool enable_incremental_backups = false;
+        bool enable_flush_merge = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         ::dirty_memory_manager* streaming_dirty_memory_manager = &default_dirty_memory_manager;
         restricted_mutation_reader_config read_concurrency_config;
@@ -1087,8 +1225,18 @@ private:
         uint64_t active_reads_streaming = 0;
         uint64_t active_reads_system_keyspace = 0;
 
+        uint64_t total_queued_reads = 0;
+        uint64_t total_queued_reads_streaming = 0;
+        uint64_t total_queued_reads_system_keyspace = 0;
+
         uint64_t short_data_queries = 0;
         uint64_t short_mutation_queries = 0;
+
+        // Writes whose frozen representation crossed half of the commitlog
+        // record size limit. These are the ones stalling segment allocation
+        // and spiking memtables; a steadily growing counter means some
+        // application stores blobs that should be chunked client-side.
+        uint64_t large_writes = 0;
     };
 
     lw_shared_ptr<db_stats> _stats;
@@ -1123,6 +1271,20 @@ private:
     bool _enable_incremental_backups = false;
 
     compaction_controller _compaction_controller;
+
+    // Periodically trades index summary memory of cold sstables for cache
+    // space when the row cache is under eviction pressure, and restores the
+    // summaries of sstables which became hot again.
+    timer<> _summary_resampling_timer{[this] { resample_sstable_summaries(); }};
+    seastar::gate _summary_resampling_gate;
+    uint64_t _resampler_last_cache_evictions = 0;
+    void resample_sstable_summaries();
+
+    // Publishes column_family::stats_snapshot blocks for this shard's
+    // tables, so other shards can aggregate the counters without messaging.
+    timer<> _stats_snapshot_timer{[this] { publish_stats_snapshots(); }};
+    void publish_stats_snapshots();
+
     future<> init_commitlog();
     future<> apply_in_memory(const frozen_mutation& m, schema_ptr m_schema, db::rp_handle&&, db::timeout_clock::time_point timeout);
     future<> apply_in_memory(const mutation& m, column_family& cf, db::rp_handle&&, db::timeout_clock::time_point timeout);
@@ -1136,6 +1298,8 @@ private:
 
     friend class db_apply_executor;
     future<> do_apply(schema_ptr, const frozen_mutation&, db::timeout_clock::time_point timeout);
+    future<> apply_table_batch(std::vector<std::pair<schema_ptr, frozen_mutation>>& muts, std::vector<size_t> idx, db::timeout_clock::time_point timeout);
+    future<> apply_in_memory_batch(std::vector<std::pair<schema_ptr, frozen_mutation>>& muts, std::vector<size_t> idx, utils::UUID uuid, std::vector<db::rp_handle> handles, db::timeout_clock::time_point timeout);
     future<> apply_with_commitlog(schema_ptr, column_family&, utils::UUID, const frozen_mutation&, db::timeout_clock::time_point timeout);
     future<> apply_with_commitlog(column_family& cf, const mutation& m, db::timeout_clock::time_point timeout);
 
@@ -1226,6 +1390,13 @@ public:
     // Apply the mutation atomically.
     // Throws timed_out_error when timeout is reached.
     future<> apply(schema_ptr, const frozen_mutation&, db::timeout_clock::time_point timeout = db::no_timeout);
+    // Apply a batch of mutations destined for this shard. Each mutation is
+    // applied with the same semantics as apply(), but the column family
+    // lookup, the commitlog allocation and the dirty memory wait are paid
+    // once per table instead of once per mutation. Mutations for tables
+    // with materialized views go through the regular apply() path, since
+    // they need a read-before-write under a per-partition lock.
+    future<> apply_batch(std::vector<std::pair<schema_ptr, frozen_mutation>> muts, db::timeout_clock::time_point timeout = db::no_timeout);
     future<> apply_streaming_mutation(schema_ptr, utils::UUID plan_id, const frozen_mutation&, bool fragmented);
     future<mutation> apply_counter_update(schema_ptr, const frozen_mutation& m, db::timeout_clock::time_point timeout, tracing::trace_state_ptr trace_state);
     keyspace::config make_keyspace_config(const keyspace_metadata& ksm);
@@ -1259,6 +1430,9 @@ public:
     const db::config& get_config() const {
         return *_cfg;
     }
+    db::config& get_config() {
+        return *_cfg;
+    }
 
     future<> flush_all_memtables();
 
@@ -1284,6 +1458,12 @@ public:
     db::timeout_semaphore& system_keyspace_read_concurrency_sem() {
         return _system_read_concurrency_sem;
     }
+    // Reads queued on the concurrency semaphore - used as the foreground
+    // congestion signal by background work (compaction controller, view
+    // builder) that should back off under load.
+    size_t queued_reads() const {
+        return _read_concurrency_sem.waiters();
+    }
     semaphore& sstable_load_concurrency_sem() {
         return _sstable_load_concurrency_sem;
     }
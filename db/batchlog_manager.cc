@@ -74,10 +74,10 @@ static logging::logger blogger("batchlog_manager");
 
 const uint32_t db::batchlog_manager::replay_interval;
 const uint32_t db::batchlog_manager::page_size;
+const uint32_t db::batchlog_manager::max_replay_parallelism;
 
 db::batchlog_manager::batchlog_manager(cql3::query_processor& qp)
-        : _qp(qp)
-        , _e1(_rd()) {
+        : _qp(qp) {
     namespace sm = seastar::metrics;
 
     _metrics.add_group("batchlog_manager", {
@@ -91,15 +91,16 @@ future<> db::batchlog_manager::do_batch_log_replay() {
     // Use with_semaphore is much simpler, but nested invoke_on can
     // cause deadlock.
     return get_batchlog_manager().invoke_on(0, [] (auto& bm) {
-        return bm._sem.wait().then([&bm] {
-            return bm._cpu++ % smp::count;
-        });
-    }).then([] (auto dest) {
-        blogger.debug("Batchlog replay on shard {}: starts", dest);
-        return get_batchlog_manager().invoke_on(dest, [] (auto& bm) {
+        return bm._sem.wait();
+    }).then([] {
+        blogger.debug("Batchlog replay: starts");
+        // Every shard scans the batchlog concurrently, replaying only the
+        // batches whose partitions it owns, so a large post-crash backlog
+        // drains on all cores instead of one.
+        return get_batchlog_manager().invoke_on_all([] (auto& bm) {
             return bm.replay_all_failed_batches();
-        }).then([dest] {
-            blogger.debug("Batchlog replay on shard {}: done", dest);
+        }).then([] {
+            blogger.debug("Batchlog replay: done");
         });
     }).finally([] {
         return get_batchlog_manager().invoke_on(0, [] (auto& bm) {
@@ -109,12 +110,10 @@ future<> db::batchlog_manager::do_batch_log_replay() {
 }
 
 future<> db::batchlog_manager::start() {
-    // Since replay is a "node global" operation, we should not attempt to do
-    // it in parallel on each shard. It will just overlap/interfere.  To
-    // simplify syncing between the timer and user initiated replay operations,
-    // we use the _timer and _sem on shard zero only. Replaying batchlog can
-    // generate a lot of work, so we distrute the real work on all cpus with
-    // round-robin scheduling.
+    // Replay passes are "node global", so to keep the timer and user
+    // initiated replay operations from overlapping, passes are serialized
+    // with the _timer and _sem on shard zero only. Within a pass, each shard
+    // replays the slice of the batchlog it owns, all shards in parallel.
     if (engine().cpu_id() == 0) {
         _timer.set_callback([this] {
             return do_batch_log_replay().handle_exception([] (auto ep) {
@@ -292,6 +291,26 @@ future<> db::batchlog_manager::replay_all_failed_batches() {
         });
     };
 
+    // All shards scan the batchlog concurrently, so replay only the batches
+    // this shard owns; the others are someone else's responsibility. The
+    // writes themselves are bounded by a semaphore, so a post-crash backlog
+    // doesn't turn into an unbounded burst of CL=ALL mutations.
+    auto owned_by_this_shard = [this] (const cql3::untyped_result_set::row& row) {
+        auto schema = _qp.db().local().find_schema(system_keyspace::NAME, system_keyspace::BATCHLOG);
+        auto key = partition_key::from_singular(*schema, row.get_as<utils::UUID>("id"));
+        return dht::shard_of(dht::global_partitioner().get_token(*schema, key)) == engine().cpu_id();
+    };
+    auto replay_sem = make_lw_shared<semaphore>(max_replay_parallelism);
+    auto batch = [batch = std::move(batch), owned_by_this_shard = std::move(owned_by_this_shard), replay_sem]
+            (const cql3::untyped_result_set::row& row) {
+        if (!owned_by_this_shard(row)) {
+            return make_ready_future<>();
+        }
+        return with_semaphore(*replay_sem, 1, [&batch, &row] {
+            return batch(row);
+        });
+    };
+
     return seastar::with_gate(_gate, [this, batch = std::move(batch)] {
         blogger.debug("Started replayAllFailedBatches (cpu {})", engine().cpu_id());
 
@@ -372,38 +391,45 @@ std::unordered_set<gms::inet_address> db::batchlog_manager::endpoint_filter(cons
         validated.erase(local_rack);
     }
 
+    // Prefer the endpoints we hear from most promptly. We track no direct
+    // network latencies, so the mean gossip heartbeat arrival interval is
+    // used as the proximity signal; in a multi-DC cluster it reliably ranks
+    // nearby endpoints above far ones. Unlike the random choice this used to
+    // make, the ordering is also deterministic, so consecutive batches land
+    // on the same replicas and their batchlog writes and removals coalesce
+    // into combined messages downstream.
+    auto by_proximity = [] (const gms::inet_address& a, const gms::inet_address& b) {
+        auto am = gms::get_local_failure_detector().arrival_mean(a);
+        auto bm = gms::get_local_failure_detector().arrival_mean(b);
+        return am != bm ? am < bm : a < b;
+    };
+
     if (validated.bucket_count() == 1) {
-        // we have only 1 `other` rack
-        auto res = validated | boost::adaptors::map_values;
-        if (validated.size() > 2) {
-            return boost::copy_range<return_type>(
-                    boost::copy_range<std::vector<gms::inet_address>>(res)
-                            | boost::adaptors::sliced(0, 2));
+        // we have only 1 `other` rack: grab its two closest members
+        auto members = boost::copy_range<std::vector<gms::inet_address>>(validated | boost::adaptors::map_values);
+        std::sort(members.begin(), members.end(), by_proximity);
+        if (members.size() > 2) {
+            members.resize(2);
         }
-        return boost::copy_range<return_type>(res);
+        return boost::copy_range<return_type>(members);
     }
 
-    // randomize which racks we pick from if more than 2 remaining
-
-    std::vector<sstring> racks = boost::copy_range<std::vector<sstring>>(validated | boost::adaptors::map_keys);
-
-    if (validated.bucket_count() > 2) {
-        std::shuffle(racks.begin(), racks.end(), _e1);
-        racks.resize(2);
+    // grab the closest member of each rack, then keep the two closest of
+    // those, preserving the rack diversity of the old random placement
+    std::vector<gms::inet_address> picks;
+    for (auto i = validated.begin(); i != validated.end();) {
+        auto range = validated.equal_range(i->first);
+        auto best = std::min_element(range.first, range.second, [&] (auto& a, auto& b) {
+            return by_proximity(a.second, b.second);
+        });
+        picks.emplace_back(best->second);
+        i = range.second;
     }
-
-    std::unordered_set<gms::inet_address> result;
-
-    // grab a random member of up to two racks
-    for (auto& rack : racks) {
-        auto rack_members = validated.bucket(rack);
-        auto n = validated.bucket_size(rack_members);
-        auto cpy = boost::copy_range<std::vector<gms::inet_address>>(validated.equal_range(rack) | boost::adaptors::map_values);
-        std::uniform_int_distribution<size_t> rdist(0, n - 1);
-        result.emplace(cpy[rdist(_e1)]);
+    std::sort(picks.begin(), picks.end(), by_proximity);
+    if (picks.size() > 2) {
+        picks.resize(2);
     }
-
-    return result;
+    return boost::copy_range<return_type>(picks);
 }
 
 
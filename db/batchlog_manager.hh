@@ -58,6 +58,9 @@ class batchlog_manager {
 private:
     static constexpr uint32_t replay_interval = 60 * 1000; // milliseconds
     static constexpr uint32_t page_size = 128; // same as HHOM, for now, w/out using any heuristics. TODO: set based on avg batch size.
+    // How many batches a shard replays concurrently within a page. Bounds the
+    // burst of CL=ALL writes a post-crash backlog can generate per shard.
+    static constexpr uint32_t max_replay_parallelism = 16;
 
     using clock_type = lowres_clock;
 
@@ -72,12 +75,8 @@ private:
     timer<clock_type> _timer;
     semaphore _sem{1};
     seastar::gate _gate;
-    unsigned _cpu = 0;
     bool _stop = false;
 
-    std::random_device _rd;
-    std::default_random_engine _e1;
-
     future<> replay_all_failed_batches();
 public:
     // Takes a QP, not a distributes. Because this object is supposed
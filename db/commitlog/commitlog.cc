@@ -39,7 +39,9 @@
  */
 
 #include <stdexcept>
+#include <cstring>
 #include <string>
+#include <deque>
 #include <sys/stat.h>
 #include <malloc.h>
 #include <regex>
@@ -77,9 +79,11 @@
 
 #include <boost/range/numeric.hpp>
 #include <boost/range/adaptor/transformed.hpp>
+#include <boost/range/irange.hpp>
 
 #include "checked-file-impl.hh"
 #include "disk-error-handler.hh"
+#include "lister.hh"
 
 static logging::logger clogger("commitlog");
 
@@ -118,7 +122,10 @@ db::commitlog::config::config(const db::config& cfg)
     , commitlog_total_space_in_mb(cfg.commitlog_total_space_in_mb() >= 0 ? cfg.commitlog_total_space_in_mb() : (memory::stats().total_memory() * smp::count) >> 20)
     , commitlog_segment_size_in_mb(cfg.commitlog_segment_size_in_mb())
     , commitlog_sync_period_in_ms(cfg.commitlog_sync_period_in_ms())
-    , mode(cfg.commitlog_sync() == "batch" ? sync_mode::BATCH : sync_mode::PERIODIC)
+    , commitlog_sync_batch_window_in_ms(cfg.commitlog_sync_batch_window_in_ms())
+    , mode(cfg.commitlog_sync() == "batch" ? sync_mode::BATCH
+            : cfg.commitlog_sync() == "group" ? sync_mode::GROUP
+            : sync_mode::PERIODIC)
 {}
 
 db::commitlog::descriptor::descriptor(segment_id_type i, const std::string& fname_prefix, uint32_t v)
@@ -210,6 +217,9 @@ public:
     future<rp_handle>
     allocate_when_possible(const cf_id_type& id, shared_ptr<entry_writer> writer, db::timeout_clock::time_point timeout);
 
+    future<std::vector<rp_handle>>
+    allocate_batch_when_possible(std::vector<std::pair<cf_id_type, shared_ptr<entry_writer>>> writers, db::timeout_clock::time_point timeout);
+
     struct stats {
         uint64_t cycle_count = 0;
         uint64_t flush_count = 0;
@@ -307,18 +317,61 @@ public:
         _flush_handlers.erase(id);
     }
 
+    // A subscribed entry noted at allocation time; resolved into a
+    // zero-copy view of the segment buffer when the buffer is cycled.
+    struct change_feed_item {
+        cf_id_type id;
+        replay_position rp;
+        size_t off;
+        size_t size;
+    };
+
+    change_feed_id subscribe_change_feed(std::vector<cf_id_type> ids, change_feed_consumer c) {
+        auto id = ++_change_feed_ids;
+        _change_feed.emplace(id, change_feed_subscription{
+                std::unordered_set<cf_id_type>(ids.begin(), ids.end()), std::move(c)});
+        return id;
+    }
+    void unsubscribe_change_feed(change_feed_id id) {
+        _change_feed.erase(id);
+    }
+    bool change_feed_wants(const cf_id_type& id) const {
+        for (auto& p : _change_feed) {
+            if (p.second.ids.count(id)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    future<> deliver_change_feed(std::vector<change_feed_item>, buffer_type&);
+
     void flush_segments(bool = false);
 
 private:
     future<> clear_reserve_segments();
 
+    bool recycle_segment_file(const sstring& fname);
+    future<> recover_recycled_segments();
+
     size_t max_request_controller_units() const;
     segment_id_type _ids = 0;
     std::vector<sseg_ptr> _segments;
     queue<sseg_ptr> _reserve_segments;
+    // Clean, retired segment files kept (renamed aside) for reuse by
+    // allocate_segment(), so steady-state segment rollover skips file
+    // creation and the fallocate/extent metadata churn that comes with it
+    // on XFS. Bounded by cfg.max_reserve_segments; overflow is unlinked
+    // as before.
+    std::deque<sstring> _recycled_segments;
     std::vector<buffer_type> _temp_buffers;
     std::unordered_map<flush_handler_id, flush_handler> _flush_handlers;
     flush_handler_id _flush_ids = 0;
+    struct change_feed_subscription {
+        std::unordered_set<cf_id_type> ids;
+        change_feed_consumer consumer;
+    };
+    std::unordered_map<change_feed_id, change_feed_subscription> _change_feed;
+    change_feed_id _change_feed_ids = 0;
     replay_position _flush_position;
     timer<clock_type> _timer;
     future<> replenish_reserve();
@@ -390,6 +443,9 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
     using time_point = segment_manager::time_point;
 
     buffer_type _buffer;
+    // Entries in _buffer wanted by change feed subscribers; handed off
+    // in cycle() together with the buffer.
+    std::vector<segment_manager::change_feed_item> _feed_items;
     std::unordered_map<cf_id_type, uint64_t> _cf_dirty;
     time_point _sync_time;
     seastar::gate _gate;
@@ -398,6 +454,16 @@ class db::commitlog::segment : public enable_shared_from_this<segment>, public c
 
     uint64_t _num_allocs = 0;
 
+    // Group commit (sync_mode::GROUP) state. The promise, when engaged,
+    // represents the sync which will cover everything currently in the
+    // buffer; it is created by the first allocation needing one and shared
+    // by all later ones until the sync is dispatched.
+    stdx::optional<shared_promise<>> _group_sync;
+    bool _group_sync_dispatched = false;
+    // Decayed average of observed sync latency. Sizes the batching window
+    // used when the log is idle.
+    std::chrono::microseconds _group_sync_latency{0};
+
     std::unordered_set<table_schema_version> _known_schema_versions;
 
     friend std::ostream& operator<<(std::ostream&, const segment&);
@@ -448,8 +514,10 @@ public:
             _segment_manager->totals.total_size_on_disk -= size_on_disk();
             _segment_manager->totals.total_size -= (size_on_disk() + _buffer.size());
             try {
-                commit_io_check([] (const char* fname) { ::unlink(fname); },
-                        _file_name.c_str());
+                if (!_segment_manager->recycle_segment_file(_file_name)) {
+                    commit_io_check([] (const char* fname) { ::unlink(fname); },
+                            _file_name.c_str());
+                }
             } catch (...) {
                 clogger.error("Could not delete segment {}: {}", *this, std::current_exception());
             }
@@ -476,7 +544,7 @@ public:
     }
 
     bool must_sync() {
-        if (_segment_manager->cfg.mode == sync_mode::BATCH) {
+        if (_segment_manager->cfg.mode != sync_mode::PERIODIC) {
             return false;
         }
         auto now = clock_type::now();
@@ -675,7 +743,10 @@ public:
 
         // The write will be allowed to start now, but flush (below) must wait for not only this,
         // but all previous write/flush pairs.
-        return _pending_ops.run_with_ordered_post_op(rp, [this, size, off, buf = std::move(buf)]() mutable {
+        return _pending_ops.run_with_ordered_post_op(rp, [this, size, off, buf = std::move(buf), feed = std::exchange(_feed_items, {})]() mutable {
+            // do_with keeps the buffer alive until both the write and any
+            // change feed delivery (which holds views into it) are done.
+            return do_with(std::move(buf), std::move(feed), [this, size, off](buffer_type& buf, std::vector<segment_manager::change_feed_item>& feed) {
                 auto written = make_lw_shared<size_t>(0);
                 auto p = buf.get();
                 return repeat([this, size, off, written, p]() mutable {
@@ -702,10 +773,16 @@ public:
                             throw;
                         }
                     });
-                }).finally([this, buf = std::move(buf), size]() mutable {
+                }).then([this, &buf, &feed] {
+                    if (feed.empty()) {
+                        return make_ready_future<>();
+                    }
+                    return _segment_manager->deliver_change_feed(std::move(feed), buf);
+                }).finally([this, &buf, size] {
                     _segment_manager->release_buffer(std::move(buf));
                     _segment_manager->notify_memory_written(size);
                 });
+            });
         }, [me, flush_after, top, rp] { // lambda instead of bind, so we keep "me" alive.
             assert(me->_pending_ops.has_operation(rp));
             return flush_after ? me->do_flush(top) : make_ready_future<sseg_ptr>(me);
@@ -749,6 +826,64 @@ public:
         });
     }
 
+    future<sseg_ptr> group_cycle(timeout_clock::time_point timeout) {
+        /**
+         * For group mode, allocations share syncs. Anything we just
+         * appended is covered by the currently scheduled sync, if there is
+         * one, since the buffer is not written out until that sync is
+         * dispatched. Otherwise the log is idle and we schedule a sync,
+         * holding it back for roughly one observed sync latency so that
+         * concurrent small writes coalesce into a single device flush - a
+         * lone write pays at most the equivalent of one extra flush in
+         * added latency. Allocations arriving while a sync is actually in
+         * flight create the next one, dispatched back to back; the flush
+         * they waited out acted as their batching window.
+         */
+        auto me = shared_from_this();
+        if (!_group_sync) {
+            _group_sync.emplace();
+            if (!_group_sync_dispatched) {
+                _group_sync_dispatched = true;
+                auto window = std::min<std::chrono::microseconds>(_group_sync_latency,
+                        std::chrono::milliseconds(_segment_manager->cfg.commitlog_sync_batch_window_in_ms));
+                sleep(window).then([me] {
+                    me->dispatch_group_sync();
+                });
+            }
+        }
+        return with_timeout(timeout, _group_sync->get_shared_future()).then([me] {
+            // As in batch mode, it is ok to leave the sync behind on
+            // timeout; later allocations share it or queue behind it.
+            return make_ready_future<sseg_ptr>(me);
+        });
+    }
+
+    void dispatch_group_sync() {
+        auto me = shared_from_this();
+        auto p = std::exchange(_group_sync, stdx::nullopt);
+        auto start = std::chrono::steady_clock::now();
+        sync().then_wrapped([this, me, p = std::move(*p), start](future<sseg_ptr> f) mutable {
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            _group_sync_latency = _group_sync_latency.count() == 0 ? latency : (_group_sync_latency * 7 + latency) / 8;
+            if (f.failed()) {
+                // If we get an IO exception (which we assume this is)
+                // we should close the segment, like batch mode does.
+                _closed = true;
+                p.set_exception(f.get_exception());
+            } else {
+                f.ignore_ready_future();
+                p.set_value();
+            }
+            if (_group_sync) {
+                // More allocations arrived while we were flushing; serve
+                // them all with one follow-up sync.
+                dispatch_group_sync();
+            } else {
+                _group_sync_dispatched = false;
+            }
+        });
+    }
+
     /**
      * Add a "mutation" to the segment.
      */
@@ -822,6 +957,12 @@ public:
         out = data_output(e, sizeof(uint32_t));
         out.write(crc.checksum());
 
+        if (_segment_manager->change_feed_wants(id)) {
+            // Note the payload region (what commitlog_entry_reader expects,
+            // sans entry header and trailing crc) for delivery on cycle().
+            _feed_items.push_back(segment_manager::change_feed_item{id, rp, pos + 2 * sizeof(uint32_t), size});
+        }
+
         ++_segment_manager->totals.allocation_count;
         ++_num_allocs;
 
@@ -831,6 +972,10 @@ public:
             return batch_cycle(timeout).then([h = std::move(h)](auto s) mutable {
                 return make_ready_future<rp_handle>(std::move(h));
             });
+        } else if (_segment_manager->cfg.mode == sync_mode::GROUP) {
+            return group_cycle(timeout).then([h = std::move(h)](auto s) mutable {
+                return make_ready_future<rp_handle>(std::move(h));
+            });
         } else {
             // If this buffer alone is too big, potentially bigger than the maximum allowed size,
             // then no other request will be allowed in to force the cycle()ing of this buffer. We
@@ -923,6 +1068,42 @@ db::commitlog::segment_manager::allocate_when_possible(const cf_id_type& id, sha
     });
 }
 
+future<std::vector<db::rp_handle>>
+db::commitlog::segment_manager::allocate_batch_when_possible(std::vector<std::pair<cf_id_type, shared_ptr<entry_writer>>> writers, db::timeout_clock::time_point timeout) {
+    // Like in allocate_when_possible(), an over-sized entry must throw here,
+    // before anything of the batch has been written.
+    for (auto& w : writers) {
+        auto ep = sanity_check_size(w.second->size());
+        if (ep) {
+            return make_exception_future<std::vector<rp_handle>>(std::move(ep));
+        }
+    }
+    return active_segment(timeout).then([this, writers = std::move(writers), timeout] (sseg_ptr s) mutable {
+        return do_with(std::move(s), std::move(writers), std::vector<rp_handle>(), [this, timeout] (sseg_ptr& s, std::vector<std::pair<cf_id_type, shared_ptr<entry_writer>>>& writers, std::vector<rp_handle>& handles) {
+            handles.resize(writers.size());
+            // The writes are issued in parallel, like independent add_entry()
+            // calls would be, so they land back to back in the buffer and, in
+            // batch/group mode, share a single sync. The segment was resolved
+            // once above; should it fill up mid-batch, allocate() forwards to
+            // the new active segment by itself.
+            return parallel_for_each(boost::irange(size_t(0), writers.size()), [this, &s, &writers, &handles, timeout] (size_t i) {
+                auto size = writers[i].second->size();
+                auto fut = get_units(_request_controller, size, timeout);
+                if (_request_controller.waiters()) {
+                    totals.requests_blocked_memory++;
+                }
+                return fut.then([this, &s, &writers, &handles, i, timeout] (auto permit) mutable {
+                    return s->allocate(writers[i].first, std::move(writers[i].second), std::move(permit), timeout).then([&handles, i] (rp_handle h) {
+                        handles[i] = std::move(h);
+                    });
+                });
+            }).then([&handles] {
+                return make_ready_future<std::vector<rp_handle>>(std::move(handles));
+            });
+        });
+    });
+}
+
 const size_t db::commitlog::segment::default_size;
 
 db::commitlog::segment_manager::segment_manager(config c)
@@ -995,6 +1176,16 @@ future<> db::commitlog::segment_manager::replenish_reserve() {
     });
 }
 
+// Suffix given to clean, retired segment files that are kept around for
+// reuse instead of being deleted. It makes them invisible to the replay
+// descriptor scan below.
+static const sstring recycled_suffix(".recycled");
+
+static bool is_recycled_segment_file(const sstring& name) {
+    return name.size() >= recycled_suffix.size()
+            && std::equal(recycled_suffix.begin(), recycled_suffix.end(), name.end() - recycled_suffix.size());
+}
+
 future<std::vector<db::commitlog::descriptor>>
 db::commitlog::segment_manager::list_descriptors(sstring dirname) {
     struct helper {
@@ -1020,7 +1211,8 @@ db::commitlog::segment_manager::list_descriptors(sstring dirname) {
                 return make_ready_future<std::experimental::optional<directory_entry_type>>(de.type);
             };
             return entry_type(de).then([this, de](std::experimental::optional<directory_entry_type> type) {
-                if (type == directory_entry_type::regular && de.name[0] != '.' && !is_cassandra_segment(de.name)) {
+                if (type == directory_entry_type::regular && de.name[0] != '.' && !is_cassandra_segment(de.name)
+                        && !is_recycled_segment_file(de.name)) {
                     try {
                         _result.emplace_back(de.name, _fname_prefix);
                     } catch (std::domain_error& e) {
@@ -1054,7 +1246,9 @@ db::commitlog::segment_manager::list_descriptors(sstring dirname) {
 }
 
 future<> db::commitlog::segment_manager::init() {
-    return list_descriptors(cfg.commit_log_location).then([this](std::vector<descriptor> descs) {
+    return recover_recycled_segments().then([this] {
+        return list_descriptors(cfg.commit_log_location);
+    }).then([this](std::vector<descriptor> descs) {
         assert(_reserve_segments.empty()); // _segments_to_replay must not pick them up
         segment_id_type id = std::chrono::duration_cast<std::chrono::milliseconds>(runtime::get_boot_time().time_since_epoch()).count() + 1;
         for (auto& d : descs) {
@@ -1172,15 +1366,131 @@ void db::commitlog::segment_manager::flush_segments(bool force) {
     }
 }
 
+future<> db::commitlog::segment_manager::deliver_change_feed(std::vector<change_feed_item> items, buffer_type& buf) {
+    // Defensive copy, like flush_segments(): consumers may (un)subscribe
+    // while we are delivering.
+    std::vector<std::pair<change_feed_consumer, std::vector<change_feed_entry>>> batches;
+    for (auto& p : _change_feed) {
+        std::vector<change_feed_entry> entries;
+        for (auto& i : items) {
+            if (p.second.ids.count(i.id)) {
+                entries.emplace_back(change_feed_entry{i.id, i.rp, buf.share(i.off, i.size)});
+            }
+        }
+        if (!entries.empty()) {
+            batches.emplace_back(p.second.consumer, std::move(entries));
+        }
+    }
+    return do_with(std::move(batches), [](std::vector<std::pair<change_feed_consumer, std::vector<change_feed_entry>>>& batches) {
+        return do_for_each(batches, [](std::pair<change_feed_consumer, std::vector<change_feed_entry>>& b) {
+            return futurize_apply(b.first, std::move(b.second)).handle_exception([](auto ep) {
+                // The feed is best effort for the consumer; it must not be
+                // able to wedge the commitlog.
+                clogger.warn("Exception from change feed consumer: {}", ep);
+            });
+        });
+    });
+}
+
+// Moves a clean, retired segment file aside for later reuse instead of
+// deleting it. Returns false if the recycle list is full or we are
+// shutting down, in which case the caller deletes the file as before.
+// Called from the segment destructor, hence the synchronous rename; it is
+// a pure metadata operation within the same directory, just like the
+// unlink it replaces.
+bool db::commitlog::segment_manager::recycle_segment_file(const sstring& fname) {
+    if (_shutdown || _recycled_segments.size() >= cfg.max_reserve_segments) {
+        return false;
+    }
+    auto recycled = fname + recycled_suffix;
+    try {
+        commit_io_check([] (const char* from, const char* to) {
+            if (::rename(from, to) < 0) {
+                throw std::system_error(errno, std::system_category());
+            }
+        }, fname.c_str(), recycled.c_str());
+    } catch (...) {
+        clogger.error("Could not recycle segment file {}: {}", fname, std::current_exception());
+        return false;
+    }
+    clogger.debug("Recycled segment file {}", fname);
+    _recycled_segments.emplace_back(std::move(recycled));
+    return true;
+}
+
+// Picks up segment files recycled by a previous incarnation so they get
+// reused rather than leaked; anything beyond the reserve bound is deleted.
+future<> db::commitlog::segment_manager::recover_recycled_segments() {
+    return lister::scan_dir(lister::path(cfg.commit_log_location), { directory_entry_type::regular }, [this] (lister::path dir, directory_entry de) {
+        if (!is_recycled_segment_file(de.name)) {
+            return make_ready_future<>();
+        }
+        auto path = sstring((dir / de.name.c_str()).native());
+        if (_recycled_segments.size() < cfg.max_reserve_segments) {
+            clogger.debug("Found recycled segment file {}", de.name);
+            _recycled_segments.emplace_back(std::move(path));
+            return make_ready_future<>();
+        }
+        return commit_io_check([path = std::move(path)] {
+            return engine().remove_file(path);
+        });
+    });
+}
+
 future<db::commitlog::segment_manager::sseg_ptr> db::commitlog::segment_manager::allocate_segment(bool active) {
     descriptor d(next_id(), cfg.fname_prefix);
+    auto dst = cfg.commit_log_location + "/" + d.filename();
     file_open_options opt;
     opt.extent_allocation_size_hint = max_size;
-    return open_checked_file_dma(commit_error_handler, cfg.commit_log_location + "/" + d.filename(), open_flags::wo | open_flags::create, opt).then([this, d, active](file f) {
-        // xfs doesn't like files extended betond eof, so enlarge the file
-        return f.truncate(max_size).then([this, d, active, f] () mutable {
-            auto s = make_shared<segment>(this->shared_from_this(), d, std::move(f), active);
-            return make_ready_future<sseg_ptr>(s);
+    auto flags = open_flags::wo;
+    auto pre = make_ready_future<>();
+    if (!_recycled_segments.empty()) {
+        auto src = std::move(_recycled_segments.front());
+        _recycled_segments.pop_front();
+        // Reuse a recycled segment file. Renaming it into place is pure
+        // metadata and skips the file creation and fallocate a fresh
+        // segment pays. The stale contents are *not* harmless as-is: every
+        // checksum in the old segment was computed with its then-valid id,
+        // and replay takes the id from the file header, never from the
+        // name, so if we crash before the first buffer of the new segment
+        // hits disk - the steady state for reserve segments - the entire
+        // retired segment would replay as valid and resurrect flushed
+        // data. Hence zero the first page, and sync, before the file
+        // becomes visible under a segment name; replay then treats it
+        // like an empty pre-allocated segment.
+        clogger.debug("Reusing recycled segment file {} as {}", src, d.filename());
+        pre = commit_io_check([src = std::move(src), dst] {
+            return open_checked_file_dma(commit_error_handler, src, open_flags::wo).then([] (file f) {
+                auto a = ::memalign(segment::alignment, segment::alignment);
+                if (a == nullptr) {
+                    throw std::bad_alloc();
+                }
+                buffer_type buf(reinterpret_cast<char*>(a), segment::alignment, make_free_deleter(a));
+                std::memset(buf.get_write(), 0, buf.size());
+                auto p = buf.get();
+                return f.dma_write(0, p, segment::alignment).then([buf = std::move(buf)] (size_t written) {
+                    if (written != segment::alignment) {
+                        throw std::runtime_error("Short write while clearing recycled segment header");
+                    }
+                }).then([f] () mutable {
+                    return f.flush();
+                }).finally([f] () mutable {
+                    return f.close();
+                });
+            }).then([src, dst] {
+                return engine().rename_file(src, dst);
+            });
+        });
+    } else {
+        flags = flags | open_flags::create;
+    }
+    return pre.then([this, d, dst = std::move(dst), active, opt, flags] {
+        return open_checked_file_dma(commit_error_handler, dst, flags, opt).then([this, d, active](file f) {
+            // xfs doesn't like files extended betond eof, so enlarge the file
+            return f.truncate(max_size).then([this, d, active, f] () mutable {
+                auto s = make_shared<segment>(this->shared_from_this(), d, std::move(f), active);
+                return make_ready_future<sseg_ptr>(s);
+            });
         });
     });
 }
@@ -1379,7 +1689,8 @@ void db::commitlog::segment_manager::on_timer() {
     // without waiting for them, so segement_manager could be shut down
     // while they are running.
     seastar::with_gate(_gate, [this] {
-        if (cfg.mode != sync_mode::BATCH) {
+        // batch and group modes sync from the write path.
+        if (cfg.mode == sync_mode::PERIODIC) {
             sync();
         }
         // IFF a new segment was put in use since last we checked, and we're
@@ -1482,30 +1793,41 @@ future<db::rp_handle> db::commitlog::add(const cf_id_type& id,
     return _segment_manager->allocate_when_possible(id, writer, timeout);
 }
 
+class db::commitlog::cl_entry_writer final : public entry_writer {
+    commitlog_entry_writer _writer;
+public:
+    cl_entry_writer(const commitlog_entry_writer& wr) : _writer(wr) { }
+    virtual size_t size(segment& seg) override {
+        _writer.set_with_schema(!seg.is_schema_version_known(_writer.schema()));
+        return _writer.size();
+    }
+    virtual size_t size() override {
+        return _writer.mutation_size();
+    }
+    virtual void write(segment& seg, output& out) override {
+        if (_writer.with_schema()) {
+            seg.add_schema_version(_writer.schema());
+        }
+        _writer.write(out);
+    }
+};
+
 future<db::rp_handle> db::commitlog::add_entry(const cf_id_type& id, const commitlog_entry_writer& cew, timeout_clock::time_point timeout)
 {
-    class cl_entry_writer final : public entry_writer {
-        commitlog_entry_writer _writer;
-    public:
-        cl_entry_writer(const commitlog_entry_writer& wr) : _writer(wr) { }
-        virtual size_t size(segment& seg) override {
-            _writer.set_with_schema(!seg.is_schema_version_known(_writer.schema()));
-            return _writer.size();
-        }
-        virtual size_t size() override {
-            return _writer.mutation_size();
-        }
-        virtual void write(segment& seg, output& out) override {
-            if (_writer.with_schema()) {
-                seg.add_schema_version(_writer.schema());
-            }
-            _writer.write(out);
-        }
-    };
     auto writer = ::make_shared<cl_entry_writer>(cew);
     return _segment_manager->allocate_when_possible(id, writer, timeout);
 }
 
+future<std::vector<db::rp_handle>> db::commitlog::add_entries(std::vector<std::pair<cf_id_type, commitlog_entry_writer>> entries, timeout_clock::time_point timeout)
+{
+    std::vector<std::pair<cf_id_type, shared_ptr<entry_writer>>> writers;
+    writers.reserve(entries.size());
+    for (auto& e : entries) {
+        writers.emplace_back(e.first, ::make_shared<cl_entry_writer>(e.second));
+    }
+    return _segment_manager->allocate_batch_when_possible(std::move(writers), timeout);
+}
+
 db::commitlog::commitlog(config cfg)
         : _segment_manager(::make_shared<segment_manager>(std::move(cfg))) {
 }
@@ -1563,6 +1885,14 @@ void db::commitlog::remove_flush_handler(flush_handler_id id) {
     _segment_manager->remove_flush_handler(id);
 }
 
+db::commitlog::change_feed_id db::commitlog::subscribe_change_feed(std::vector<cf_id_type> ids, change_feed_consumer c) {
+    return _segment_manager->subscribe_change_feed(std::move(ids), std::move(c));
+}
+
+void db::commitlog::unsubscribe_change_feed(change_feed_id id) {
+    _segment_manager->unsubscribe_change_feed(id);
+}
+
 void db::commitlog::discard_completed_segments(const cf_id_type& id, const rp_set& used) {
     _segment_manager->discard_completed_segments(id, used);
 }
@@ -104,7 +104,7 @@ private:
     ::shared_ptr<segment_manager> _segment_manager;
 public:
     enum class sync_mode {
-        PERIODIC, BATCH
+        PERIODIC, BATCH, GROUP
     };
     struct config {
         config() = default;
@@ -116,6 +116,8 @@ public:
         uint64_t commitlog_total_space_in_mb = 0;
         uint64_t commitlog_segment_size_in_mb = 32;
         uint64_t commitlog_sync_period_in_ms = 10 * 1000; //TODO: verify default!
+        // Upper bound on the group commit batching window (sync_mode::GROUP).
+        uint64_t commitlog_sync_batch_window_in_ms = 10 * 1000;
         // Max number of segments to keep in pre-alloc reserve.
         // Not (yet) configurable from scylla.conf.
         uint64_t max_reserve_segments = 12;
@@ -212,6 +214,17 @@ public:
      */
     future<rp_handle> add_entry(const cf_id_type& id, const commitlog_entry_writer& entry_writer, db::timeout_clock::time_point timeout);
 
+    /**
+     * Add a batch of entries to the commit log as a single operation. The
+     * size sanity checks and the active segment resolution are done once
+     * for the whole batch, the entries are laid out back to back in the
+     * segment buffer, and in batch/group sync modes they share a single
+     * disk sync.
+     * Resolves with timed_out_error when timeout is reached.
+     * The returned handles are in the same order as the given entries.
+     */
+    future<std::vector<rp_handle>> add_entries(std::vector<std::pair<cf_id_type, commitlog_entry_writer>> entries, db::timeout_clock::time_point timeout);
+
     /**
      * Modifies the per-CF dirty cursors of any commit log segments for the column family according to the position
      * given. Discards any commit log segments that are no longer used.
@@ -257,6 +270,36 @@ public:
     flush_handler_anchor add_flush_handler(flush_handler);
     void remove_flush_handler(flush_handler_id);
 
+    /**
+     * Change feed. A consumer subscribed to a set of column families is
+     * handed batched views of the entries written for those column
+     * families, once per write cycle which contained at least one of
+     * them, after the cycle has been written to disk.
+     *
+     * The views are zero-copy slices of the internal segment buffer in
+     * the same format the replayer sees (see commitlog_entry_reader),
+     * and are only valid until the future returned by the consumer
+     * resolves; after that, the buffer is recycled. A consumer which
+     * needs the data for longer must copy it.
+     *
+     * Entries carry their replay_position, so a consumer can track and
+     * resume its progress in the same terms as the replayer.
+     *
+     * Delivery happens off the write path: a slow consumer delays
+     * recycling of the buffer, but never an "add" or a disk sync, and
+     * no entries are dropped.
+     */
+    struct change_feed_entry {
+        cf_id_type id;
+        replay_position position;
+        temporary_buffer<char> data;
+    };
+    typedef std::function<future<>(std::vector<change_feed_entry>)> change_feed_consumer;
+    typedef uint64_t change_feed_id;
+
+    change_feed_id subscribe_change_feed(std::vector<cf_id_type>, change_feed_consumer);
+    void unsubscribe_change_feed(change_feed_id);
+
     /**
      * Returns a vector of the segment names
      */
@@ -358,6 +401,8 @@ private:
         virtual void write(segment&, output&) = 0;
         virtual ~entry_writer() {};
     };
+
+    class cl_entry_writer;
 };
 
 }
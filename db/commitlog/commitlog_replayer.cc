@@ -61,6 +61,11 @@
 
 static logging::logger rlogger("commitlog_replayer");
 
+// How many segments of a shard are replayed concurrently. Enough to overlap
+// segment I/O and parsing with mutation application without flooding the
+// memtables during startup.
+static constexpr size_t replay_segment_concurrency = 4;
+
 class db::commitlog_replayer::impl {
     struct column_mappings {
         std::unordered_map<table_schema_version, column_mapping> map;
@@ -358,26 +363,32 @@ future<> db::commitlog_replayer::recover(std::vector<sstring> files, sstring fna
             return map_reduce(smp::all_cpus(), [this, map, &fname_prefix] (unsigned id) {
                 return smp::submit_to(id, [this, id, map, &fname_prefix] () {
                     auto total = ::make_lw_shared<impl::stats>();
-                    // TODO: or something. For now, we do this serialized per shard,
-                    // to reduce mutation congestion. We could probably (says avi)
-                    // do 2 segments in parallel or something, but lets use this first.
+                    // Segments are replayed a few at a time so that reading and
+                    // parsing one overlaps with applying another. Mutation
+                    // application commutes (reconciliation is timestamp-based)
+                    // and the per-cf replay positions filter flushed entries
+                    // regardless of the order segments are visited in, so
+                    // replaying segments of a shard concurrently is safe.
+                    auto sem = ::make_lw_shared<semaphore>(replay_segment_concurrency);
                     auto range = map->equal_range(id);
-                    return do_for_each(range.first, range.second, [this, total, &fname_prefix] (const std::pair<unsigned, sstring>& p) {
+                    return parallel_for_each(range.first, range.second, [this, total, sem, &fname_prefix] (const std::pair<unsigned, sstring>& p) {
                         auto&f = p.second;
-                        rlogger.debug("Replaying {}", f);
-                        return _impl->recover(f, fname_prefix).then([f, total](impl::stats stats) {
-                            if (stats.corrupt_bytes != 0) {
-                                rlogger.warn("Corrupted file: {}. {} bytes skipped.", f, stats.corrupt_bytes);
-                            }
-                            rlogger.debug("Log replay of {} complete, {} replayed mutations ({} invalid, {} skipped)"
-                                            , f
-                                            , stats.applied_mutations
-                                            , stats.invalid_mutations
-                                            , stats.skipped_mutations
-                            );
-                            *total += stats;
+                        return with_semaphore(*sem, 1, [this, total, f, &fname_prefix] {
+                            rlogger.debug("Replaying {}", f);
+                            return _impl->recover(f, fname_prefix).then([f, total](impl::stats stats) {
+                                if (stats.corrupt_bytes != 0) {
+                                    rlogger.warn("Corrupted file: {}. {} bytes skipped.", f, stats.corrupt_bytes);
+                                }
+                                rlogger.debug("Log replay of {} complete, {} replayed mutations ({} invalid, {} skipped)"
+                                                , f
+                                                , stats.applied_mutations
+                                                , stats.invalid_mutations
+                                                , stats.skipped_mutations
+                                );
+                                *total += stats;
+                            });
                         });
-                    }).then([total] {
+                    }).then([total, sem] {
                         return make_ready_future<impl::stats>(*total);
                     });
                 });
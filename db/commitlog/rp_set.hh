@@ -81,6 +81,18 @@ public:
     const usage_map& usage() const {
         return _usage;
     }
+
+    // True iff any tracked position lies in a segment older than "id".
+    // Used to tell whether flushing the data covered by this set would
+    // actually help releasing commitlog segments below that point.
+    bool has_segment_before(segment_id_type id) const {
+        for (auto& e : _usage) {
+            if (e.first < id) {
+                return true;
+            }
+        }
+        return false;
+    }
 private:
     usage_map _usage;
 };
@@ -21,6 +21,7 @@
  */
 
 #include <unordered_map>
+#include <unordered_set>
 #include <regex>
 
 #include <boost/any.hpp>
@@ -99,6 +100,21 @@ db::config::config()
     : config(std::make_shared<db::extensions>())
 {}
 
+db::config::config(const config& other)
+    : config(other._extensions)
+{
+    // The delegated constructor rebuilt the value list with references to
+    // this object's own members; now fill those members in from the source,
+    // one value at a time. Both lists come from the same constructor, so
+    // they line up.
+    auto mine = values().begin();
+    for (auto& theirs : other.values()) {
+        mine->get().copy_value_from(theirs.get());
+        ++mine;
+    }
+    _read_from = other._read_from;
+}
+
 db::config::~config()
 {}
 
@@ -156,6 +172,35 @@ void db::config::check_experimental(const sstring& what) const {
     }
 }
 
+static logging::logger cfglog("config");
+
+// Options known to take effect without a restart: their consumers re-read
+// them on every use rather than copying them at start-up. Extend this list
+// as more consumers become restart-free.
+static const std::unordered_set<stdx::string_view> live_update_options = {
+    "read_request_timeout_in_ms",
+    "write_request_timeout_in_ms",
+    "counter_write_request_timeout_in_ms",
+    "cas_contention_timeout_in_ms",
+    "truncate_request_timeout_in_ms",
+    "range_request_timeout_in_ms",
+};
+
+future<std::vector<sstring>> db::config::reload() {
+    if (!read_from()) {
+        return make_ready_future<std::vector<sstring>>(std::vector<sstring>());
+    }
+    auto fresh = std::make_unique<config>(_extensions);
+    auto f = fresh->read_from_file(*read_from(), [](auto& opt, auto& msg, auto) {
+        cfglog.warn("Parsing option {} failed during reload: {}", opt, msg);
+    });
+    return f.then([this, fresh = std::move(fresh)] {
+        return apply_live_values(*fresh, [](const config_src& src) {
+            return live_update_options.count(src.name()) != 0;
+        });
+    });
+}
+
 namespace bpo = boost::program_options;
 
 logging::settings db::config::logging_settings(const bpo::variables_map& map) const {
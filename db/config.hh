@@ -61,11 +61,25 @@ class config : public utils::config_file {
 public:
     config();
     config(std::shared_ptr<db::extensions>);
+    // The base class keeps a list of references to the object's own value
+    // members, so the default copy constructor must not be used.
+    config(const config&);
     ~config();
 
     // Throws exception if experimental feature is disabled.
     void check_experimental(const sstring& what) const;
 
+    /**
+     * Re-reads the configuration file this config was loaded from and
+     * applies whichever changed options are safe to change at runtime -
+     * currently the request timeouts, whose consumers re-read them on
+     * every request. Every shard's database holds its own copy of the
+     * config, so the update must be invoked on each copy on its owning
+     * shard (see the SIGHUP handler in main). Returns the names of the
+     * options which were applied.
+     */
+    future<std::vector<sstring>> reload();
+
     /**
      * Scans the environment variables for configuration files directory
      * definition. It's either $SCYLLA_CONF, $SCYLLA_HOME/conf or "conf" if none
@@ -125,6 +139,12 @@ public:
     val(compaction_static_shares, float, 0, Used, \
             "If set to higher than 0, ignore the controller's output and set the compaction shares statically. Do not set this unless you know what you are doing and suspect a problem in the controller. This option will be retired when the controller reaches more maturity" \
     )   \
+    val(compaction_shares_min, float, 10, Used, \
+            "Lower clamp for the compaction controller output. Keeps compaction making some progress even when the backlog signal is low, bounding read amplification growth" \
+    )   \
+    val(compaction_shares_max, float, 1000, Used, \
+            "Upper clamp for the compaction controller output. Bounds how hard compaction may push when the backlog grows, protecting foreground tail latency" \
+    )   \
     /* Initialization properties */             \
     /* The minimal properties needed for configuring a cluster. */  \
     val(cluster_name, sstring, "", Used,   \
@@ -152,7 +172,7 @@ public:
     val(hints_directory, sstring, "/var/lib/scylla/hints", Used,   \
             "The directory where hints files are stored if hinted handoff is enabled."   \
     )                                           \
-    val(saved_caches_directory, sstring, "/var/lib/scylla/saved_caches", Unused, \
+    val(saved_caches_directory, sstring, "/var/lib/scylla/saved_caches", Used, \
             "The directory location where table key and row caches are stored."  \
     )                                                   \
     /* Commonly used properties */  \
@@ -222,6 +242,9 @@ public:
     val(compaction_large_partition_warning_threshold_mb, uint32_t, 100, Unused, \
             "Log a warning when compacting partitions larger than this value"   \
     )                                               \
+    val(flush_merge_enabled, bool, false, Used, \
+            "When a memtable flush is about to produce a small sstable that compaction would immediately re-merge with other small sstables, absorb those sstables into the flush itself: the flush writes one combined output and removes the absorbed inputs, so their data goes through a single write pass instead of two. Reduces write amplification for tables with a high flush rate."   \
+    )                                               \
     /* Common memtable settings */  \
     val(memtable_total_space_in_mb, uint32_t, 0, Invalid,     \
             "Specifies the total memory used for all memtables on a node. This replaces the per-table storage settings memtable_operations_in_millions and memtable_throughput_in_mb."  \
@@ -258,6 +281,7 @@ public:
             "\n"    \
             "\tperiodic : Used with commitlog_sync_period_in_ms (Default: 10000 - 10 seconds ) to control how often the commit log is synchronized to disk. Periodic syncs are acknowledged immediately.\n"   \
             "\tbatch : Used with commitlog_sync_batch_window_in_ms (Default: disabled **) to control how long Scylla waits for other writes before performing a sync. When using this method, writes are not acknowledged until fsynced to disk.\n"  \
+            "\tgroup : Like batch, but writes arriving while a sync is in flight are grouped into a single follow-up sync, and an otherwise idle log delays the first write by the observed sync latency (bounded by commitlog_sync_batch_window_in_ms) so concurrent writes share one sync. Writes are not acknowledged until fsynced to disk.\n"  \
             "Related information: Durability"   \
     )                                                   \
     val(commitlog_segment_size_in_mb, uint32_t, 64, Used,     \
@@ -412,13 +436,13 @@ public:
             "A global cache setting for tables. It is the maximum size of the key cache in memory. To disable set to 0.\n"  \
             "Related information: nodetool setcachecapacity."   \
     )   \
-    val(row_cache_keys_to_save, uint32_t, 0, Unused,                \
-            "Number of keys from the row cache to save."  \
+    val(row_cache_keys_to_save, uint32_t, 0, Used,                \
+            "Number of keys from the row cache to save. (0: a builtin default)"  \
     )   \
     val(row_cache_size_in_mb, uint32_t, 0, Unused,                \
             "Maximum size of the row cache in memory. Row cache can save more time than key_cache_size_in_mb, but is space-intensive because it contains the entire row. Use the row cache only for hot rows or static rows. If you reduce the size, you may not get you hottest keys loaded on start up."  \
     )   \
-    val(row_cache_save_period, uint32_t, 0, Unused,     \
+    val(row_cache_save_period, uint32_t, 0, Used,     \
             "Duration in seconds that rows are saved in cache. Caches are saved to saved_caches_directory."  \
     )   \
     val(memory_allocator, sstring, "NativeAllocator", Invalid,     \
@@ -564,6 +588,12 @@ public:
     val(cache_hit_rate_read_balancing, bool, true, Used, \
             "This boolean controls whether the replicas for read query will be choosen based on cache hit ratio"\
     ) \
+    val(digest_read_bypass_enabled, bool, false, Used, \
+            "Allows the coordinator to serve quorum reads of a table from a single replica while the table's observed digest mismatch rate stays negligible (below 0.01%). A sample of reads keeps going through the regular data-plus-digest path, so the mismatch rate stays current and divergent replicas are still read-repaired; any observed mismatch disables the bypass for the table until agreement is re-established. Reads served from a single replica provide consistency level ONE guarantees."\
+    ) \
+    val(hot_key_result_cache_enabled, bool, false, Used, \
+            "Extends the per-shard coordinator-side cache of query results for very hot partitions to all consistency levels. Reads at consistency level ONE or LOCAL_ONE use the cache regardless of this option, since a coordinator-local copy is within their consistency contract. Cached entries are invalidated by writes coordinated or applied by this node, and otherwise expire after one second, so reads may observe results which are up to one second stale."\
+    ) \
     /* Advanced fault detection settings */ \
     /* Settings to handle poorly performing or failing nodes. */    \
     val(dynamic_snitch_badness_threshold, double, 0, Unused,     \
@@ -592,6 +622,9 @@ public:
     val(batchlog_replay_throttle_in_kb, uint32_t, 1024, Unused,     \
             "Total maximum throttle. Throttling is reduced proportionally to the number of nodes in the cluster."  \
     )   \
+    val(read_repair_throttle_in_kb, uint32_t, 65536, Used,     \
+            "Per-table, per-shard cap on read repair mutation traffic, in KB per second. Prevents repair of a frequently-read diverging partition from overwhelming its replicas. Set to 0 to disable the cap."  \
+    )   \
     /* Request scheduler properties */  \
     /* Settings to handle incoming client requests according to a defined policy. If you need to use these properties, your nodes are overloaded and dropping requests. It is recommended that you add more nodes and not try to prioritize requests. */    \
     val(request_scheduler, sstring, "org.apache.cassandra.scheduler.NoScheduler", Unused,     \
@@ -734,6 +767,13 @@ public:
     val(enable_keyspace_column_family_metrics, bool, false, Used, "Enable per keyspace and per column family metrics reporting") \
     val(enable_sstable_data_integrity_check, bool, false, Used, "Enable interposer which checks for integrity of every sstable write." \
         " Performance is affected to some extent as a result. Useful to help debugging problems that may arise at another layers.") \
+    val(sstable_filter_idle_timeout_in_s, uint32_t, 0, Used, "Load sstable bloom filters on first use instead of at startup, and unload" \
+        " them again after this many seconds of not being consulted. Reads of an sstable whose filter is not loaded fall back to the index." \
+        " Cuts startup time and baseline memory on nodes with many rarely read sstables. Set to zero (the default) to keep filters loaded eagerly.") \
+    val(sstable_blocked_bloom_filter, bool, false, Used, "Write the bloom filters of new sstables in the cache-line-blocked layout," \
+        " where all probes of a key fall into a single 512-bit block: negative lookups cost one cache miss instead of one per hash, for a" \
+        " slightly higher false positive rate at the same size. Filters written this way cannot be read by versions without this feature," \
+        " so enable it only once the whole cluster supports it.") \
     val(cpu_scheduler, bool, true, Used, "Enable cpu scheduling") \
     /* done! */
 
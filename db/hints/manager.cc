@@ -32,6 +32,10 @@
 #include "disk-error-handler.hh"
 #include "lister.hh"
 #include "db/timeout_clock.hh"
+#include <seastar/core/sleep.hh>
+#include <array>
+#include <atomic>
+#include <random>
 
 namespace db {
 namespace hints {
@@ -120,10 +124,11 @@ bool manager::end_point_hints_manager::store_hint(schema_ptr s, lw_shared_ptr<co
             shard_stats().size_of_hints_in_progress += mut_size;
 
             return with_shared(file_update_mutex(), [this, fm, s, tr_state] () mutable -> future<> {
-                return get_or_load().then([this, fm = std::move(fm), s = std::move(s), tr_state] (hints_store_ptr log_ptr) mutable {
+                return get_or_load().then([this, fm = std::move(fm), s, tr_state] (hints_store_ptr log_ptr) mutable {
                     commitlog_entry_writer cew(s, *fm);
                     return log_ptr->add_entry(s->id(), cew, db::timeout_clock::now() + _shard_manager.hint_file_write_timeout);
-                }).then([this, tr_state] (db::rp_handle rh) {
+                }).then([this, s = std::move(s), tr_state] (db::rp_handle rh) {
+                    note_stored_hint(rh.rp().id, s->gc_grace_seconds());
                     rh.release();
                     ++shard_stats().written;
 
@@ -150,6 +155,26 @@ bool manager::end_point_hints_manager::store_hint(schema_ptr s, lw_shared_ptr<co
     return true;
 }
 
+void manager::end_point_hints_manager::note_stored_hint(uint64_t segment_id, gc_clock::duration gc_grace) noexcept {
+    try {
+        segment_stats& st = _segments_stats[segment_id];
+        st.max_gc_grace = std::max(st.max_gc_grace, gc_grace);
+        ++st.hints;
+    } catch (...) {
+        // The entry is an optimization only - without it the segment is
+        // simply replayed the usual way.
+    }
+}
+
+const manager::end_point_hints_manager::segment_stats* manager::end_point_hints_manager::get_segment_stats(uint64_t segment_id) const noexcept {
+    auto it = _segments_stats.find(segment_id);
+    return it == _segments_stats.end() ? nullptr : &it->second;
+}
+
+void manager::end_point_hints_manager::forget_segment_stats(uint64_t segment_id) noexcept {
+    _segments_stats.erase(segment_id);
+}
+
 future<> manager::end_point_hints_manager::populate_segments_to_replay() {
     return with_lock(file_update_mutex(), [this] {
         return get_or_load().discard_result();
@@ -605,6 +630,14 @@ manager::end_point_hints_manager::sender::clock::duration manager::end_point_hin
 void manager::end_point_hints_manager::sender::start() {
     _stopped = seastar::async([this] {
         manager_logger.trace("ep_manager({})::sender: started", end_point_key());
+        try {
+            // Jitter the first iteration: when a node comes back, all the
+            // shards here and the other nodes holding hints for it would
+            // otherwise begin replaying at the same instant.
+            sleep_abortable(std::chrono::milliseconds(std::random_device{}() % 2000)).get();
+        } catch (seastar::sleep_aborted&) {
+            // the loop below will notice state::stopping
+        }
         while (!_state.contains(state::stopping)) {
             try {
                 flush_maybe().get();
@@ -624,6 +657,114 @@ void manager::end_point_hints_manager::sender::start() {
     });
 }
 
+// Pacing state for hint replay, keyed by target address and shared by all
+// shards through plain atomics.
+//
+// When a node comes back after being down, every shard here (and usually
+// several other nodes) starts replaying hints to it at once, and an
+// uncoordinated drain can drive the target right back into overload,
+// generating more hints. Every sender therefore draws send credit from a
+// per-target token bucket whose rate follows the observed reply latency
+// (see sender::adjust_send_rate()). Slots are claimed on first use and
+// never freed; a hash collision merely makes two targets share a bucket,
+// which errs on the slower, safer side.
+static constexpr uint64_t hint_send_rate_initial = 1024; // hints/s, per target
+static constexpr uint64_t hint_send_rate_min = 16;
+static constexpr uint64_t hint_send_rate_max = 64 * 1024;
+static constexpr int64_t hint_send_burst = 128; // tokens
+
+struct hint_send_rate_slot {
+    std::atomic<uint32_t> ep{0}; // raw IPv4 address of the target, 0 when free
+    std::atomic<uint64_t> rate{hint_send_rate_initial}; // hints/s
+    std::atomic<int64_t> last_refill_us{0};
+    std::atomic<int64_t> milli_tokens{hint_send_burst * 1000};
+};
+
+static constexpr size_t max_hint_send_rate_slots = 128;
+static std::array<hint_send_rate_slot, max_hint_send_rate_slots> hint_send_rate_slots;
+
+static hint_send_rate_slot& hint_send_rate_slot_for(gms::inet_address ep) {
+    uint32_t raw = ep.raw_addr();
+    size_t i = std::hash<uint32_t>()(raw) % max_hint_send_rate_slots;
+    for (size_t probes = 0; probes < max_hint_send_rate_slots; ++probes) {
+        hint_send_rate_slot& slot = hint_send_rate_slots[i];
+        uint32_t cur = slot.ep.load(std::memory_order_acquire);
+        if (cur == raw) {
+            return slot;
+        }
+        if (cur == 0) {
+            if (slot.ep.compare_exchange_strong(cur, raw, std::memory_order_acq_rel)) {
+                return slot;
+            }
+            if (cur == raw) { // another shard claimed it for the same target
+                return slot;
+            }
+        }
+        i = (i + 1) % max_hint_send_rate_slots;
+    }
+    // All slots taken - an unrealistic number of distinct targets. Share the home slot.
+    return hint_send_rate_slots[std::hash<uint32_t>()(raw) % max_hint_send_rate_slots];
+}
+
+static bool try_take_send_credit(hint_send_rate_slot& slot) {
+    using namespace std::chrono;
+    int64_t now_us = duration_cast<microseconds>(seastar::lowres_clock::now().time_since_epoch()).count();
+    int64_t last_us = slot.last_refill_us.exchange(now_us, std::memory_order_relaxed);
+    uint64_t rate = slot.rate.load(std::memory_order_relaxed);
+    if (last_us != 0 && now_us > last_us) {
+        int64_t added = (now_us - last_us) * int64_t(rate) / 1000; // milli-tokens
+        if (added > 0 && slot.milli_tokens.fetch_add(added, std::memory_order_relaxed) + added > hint_send_burst * 1000) {
+            // Clamping may race with other shards, but only by a few tokens.
+            slot.milli_tokens.store(hint_send_burst * 1000, std::memory_order_relaxed);
+        }
+    }
+    int64_t cur = slot.milli_tokens.load(std::memory_order_relaxed);
+    while (cur >= 1000) {
+        if (slot.milli_tokens.compare_exchange_weak(cur, cur - 1000, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+future<> manager::end_point_hints_manager::sender::wait_for_send_credit() {
+    hint_send_rate_slot& slot = hint_send_rate_slot_for(end_point_key());
+    return repeat([&slot] {
+        if (try_take_send_credit(slot)) {
+            return make_ready_future<stop_iteration>(stop_iteration::yes);
+        }
+        auto token_period = std::chrono::microseconds(1000000 / std::max<uint64_t>(slot.rate.load(std::memory_order_relaxed), 1));
+        return seastar::sleep(token_period).then([] { return stop_iteration::no; });
+    });
+}
+
+void manager::end_point_hints_manager::sender::adjust_send_rate(std::chrono::microseconds sample_latency, bool failed) noexcept {
+    // The reply latency of a target that is keeping up; above twice this the
+    // target is considered to be falling behind. Hint replay is background
+    // work, so it's fine to be conservative here.
+    constexpr int64_t healthy_latency_us = 100 * 1000;
+    hint_send_rate_slot& slot = hint_send_rate_slot_for(end_point_key());
+    if (!failed) {
+        int64_t sample_us = sample_latency.count();
+        _send_latency_ewma_us = _send_latency_ewma_us ? (7 * _send_latency_ewma_us + sample_us) / 8 : sample_us;
+    }
+    uint64_t rate = slot.rate.load(std::memory_order_relaxed);
+    if (failed || _send_latency_ewma_us > 2 * healthy_latency_us) {
+        // Multiplicative decrease, at most once a second so that a batch of
+        // in-flight failures doesn't instantly floor the rate.
+        if (clock::now() >= _next_rate_decrease_tp) {
+            slot.rate.store(std::max(rate / 2, hint_send_rate_min), std::memory_order_relaxed);
+            _next_rate_decrease_tp = clock::now() + std::chrono::seconds(1);
+            _next_rate_increase_tp = _next_rate_decrease_tp;
+        }
+    } else if (_send_latency_ewma_us < healthy_latency_us && clock::now() >= _next_rate_increase_tp) {
+        // Additive increase, paced so that a burst of quick replies doesn't
+        // open the valve all at once.
+        slot.rate.store(std::min(rate + 64, hint_send_rate_max), std::memory_order_relaxed);
+        _next_rate_increase_tp = clock::now() + std::chrono::milliseconds(100);
+    }
+}
+
 future<> manager::end_point_hints_manager::sender::send_one_mutation(mutation m) {
     keyspace& ks = _db.find_keyspace(m.schema()->ks_name());
     auto& rs = ks.get_replication_strategy();
@@ -640,7 +781,9 @@ future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<s
 
     manager_logger.trace("memory budget: need {} have {}", hint_memory_budget, _shard_manager._send_limiter.available_units());
 
-    return get_units(_shard_manager._send_limiter, hint_memory_budget).then([this, secs_since_file_mod, &fname, buf = std::move(buf), rp, ctx_ptr] (auto units) mutable {
+    return wait_for_send_credit().then([this, hint_memory_budget] {
+        return get_units(_shard_manager._send_limiter, hint_memory_budget);
+    }).then([this, secs_since_file_mod, &fname, buf = std::move(buf), rp, ctx_ptr] (auto units) mutable {
         with_gate(ctx_ptr->file_send_gate, [this, secs_since_file_mod, &fname, buf = std::move(buf), rp, ctx_ptr] () mutable {
             try {
                 try {
@@ -663,11 +806,14 @@ future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<s
                     return make_ready_future<>();
                 }
 
-                return this->send_one_mutation(std::move(m)).then([this, rp, ctx_ptr] {
+                auto send_start_tp = std::chrono::steady_clock::now();
+                return this->send_one_mutation(std::move(m)).then([this, rp, ctx_ptr, send_start_tp] {
                     ctx_ptr->rps_set.erase(rp);
                     ++this->shard_stats().sent;
+                    this->adjust_send_rate(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - send_start_tp), false);
                 }).handle_exception([this, ctx_ptr] (auto eptr) {
                     ctx_ptr->state.set(send_state::segment_replay_failed);
+                    this->adjust_send_rate(std::chrono::microseconds(0), true);
                 });
 
             // ignore these errors and move on - probably this hint is too old and the KS/CF has been deleted...
@@ -689,6 +835,23 @@ future<> manager::end_point_hints_manager::sender::send_one_hint(lw_shared_ptr<s
 bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fname) {
     timespec last_mod = get_last_file_modification(fname).get0();
     gc_clock::duration secs_since_file_mod = std::chrono::seconds(last_mod.tv_sec);
+
+    // If we know the longest gc_grace_seconds of any hint written into this
+    // segment and even that hint has expired by now, drop the whole segment
+    // without reading it. The check mirrors the per-hint one in
+    // send_one_hint().
+    uint64_t segment_id = commitlog::descriptor(fname, manager::FILENAME_PREFIX).id;
+    const segment_stats* seg_stats = _ep_manager.get_segment_stats(segment_id);
+    if (seg_stats && gc_clock::now().time_since_epoch() - secs_since_file_mod > seg_stats->max_gc_grace - manager::hints_flush_period) {
+        manager_logger.trace("send_one_file(): all {} hints in segment {} have expired, deleting it without replay", seg_stats->hints, fname);
+        with_shared(_file_update_mutex, [&fname] {
+            return io_check(remove_file, fname);
+        }).get();
+        _ep_manager.forget_segment_stats(segment_id);
+        _last_not_complete_rp.erase(fname);
+        return true;
+    }
+
     lw_shared_ptr<send_one_file_ctx> ctx_ptr = make_lw_shared<send_one_file_ctx>();
 
     try {
@@ -708,7 +871,7 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
             return flush_maybe().finally([this, ctx_ptr, buf = std::move(buf), rp, secs_since_file_mod, &fname] () mutable {
                 return send_one_hint(std::move(ctx_ptr), std::move(buf), rp, secs_since_file_mod, fname);
             });
-        }, _last_not_complete_rp.pos).get0();
+        }, last_not_complete_rp(fname).pos).get0();
 
         s->done().get();
     } catch (...) {
@@ -723,12 +886,12 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
     if (ctx_ptr->state.contains(send_state::segment_replay_failed)) {
         if (ctx_ptr->state.contains(send_state::restart_segment)) {
             // if _rps_set contents is inconsistent simply re-start the current file from the beginning
-            _last_not_complete_rp = replay_position();
+            _last_not_complete_rp.erase(fname);
         } else if (!ctx_ptr->rps_set.empty()) {
-            _last_not_complete_rp = *std::min_element(ctx_ptr->rps_set.begin(), ctx_ptr->rps_set.end());
+            _last_not_complete_rp[fname] = *std::min_element(ctx_ptr->rps_set.begin(), ctx_ptr->rps_set.end());
         }
 
-        manager_logger.trace("send_one_file(): error while sending hints from {}, last RP is {}", fname, _last_not_complete_rp);
+        manager_logger.trace("send_one_file(): error while sending hints from {}, last RP is {}", fname, last_not_complete_rp(fname));
         return false;
     }
 
@@ -738,7 +901,8 @@ bool manager::end_point_hints_manager::sender::send_one_file(const sstring& fnam
     }).get();
 
     // clear the replay position - we are going to send the next segment...
-    _last_not_complete_rp = replay_position();
+    _last_not_complete_rp.erase(fname);
+    _ep_manager.forget_segment_stats(segment_id);
     manager_logger.trace("send_one_file(): segment {} was sent in full and deleted", fname);
     return true;
 }
@@ -751,12 +915,47 @@ void manager::end_point_hints_manager::sender::send_hints_maybe() noexcept {
     int replayed_segments_count = 0;
 
     try {
-        while (have_segments()) {
-            if (!send_one_file(*_segments_to_replay.begin())) {
-                break;
+        bool replay_failed = false;
+        while (have_segments() && !replay_failed) {
+            // Replay a few segments in parallel. Every hint still has to
+            // acquire the shared send limiter before going out, so the
+            // pacing towards the target is the same as with one segment -
+            // we only stop serializing on each file's framing and I/O.
+            std::vector<sstring> batch;
+            for (const sstring& seg : _segments_to_replay) {
+                batch.push_back(seg);
+                if (int(batch.size()) == max_concurrent_segment_replays) {
+                    break;
+                }
+            }
+
+            std::vector<future<bool>> replays;
+            replays.reserve(batch.size());
+            for (const sstring& fname : batch) {
+                replays.push_back(seastar::async([this, fname] {
+                    return send_one_file(fname);
+                }));
+            }
+
+            auto results = when_all(replays.begin(), replays.end()).get0();
+            auto batch_it = batch.begin();
+            for (auto& r : results) {
+                bool segment_sent = false;
+                try {
+                    segment_sent = r.get0();
+                } catch (...) {
+                    // Handled below like any other failed segment.
+                }
+                if (segment_sent) {
+                    // Successfully replayed segments were deleted from disk,
+                    // so they come off the list no matter where they were on it.
+                    _segments_to_replay.remove(*batch_it);
+                    ++replayed_segments_count;
+                } else {
+                    replay_failed = true;
+                }
+                ++batch_it;
             }
-            _segments_to_replay.pop_front();
-            ++replayed_segments_count;
         }
 
     // Ignore exceptions, we will retry sending this file from where we left off the next time.
@@ -33,6 +33,7 @@
 #include <seastar/core/shared_mutex.hh>
 #include "gms/gossiper.hh"
 #include "db/commitlog/commitlog.hh"
+#include "gc_clock.hh"
 #include "utils/loading_shared_values.hh"
 
 namespace db {
@@ -88,12 +89,27 @@ private:
             };
 
         private:
+            // Number of segments a single send_hints_maybe() round replays in
+            // parallel. Hints from all of them still go through the shared
+            // send limiter, so the pacing towards the target is unchanged.
+            static constexpr int max_concurrent_segment_replays = 4;
+
             std::list<sstring> _segments_to_replay;
-            replay_position _last_not_complete_rp;
+            // Per-segment positions to resume an interrupted replay from.
+            // A segment without an entry is replayed from the beginning.
+            std::unordered_map<sstring, replay_position> _last_not_complete_rp;
+
+            replay_position last_not_complete_rp(const sstring& fname) const noexcept {
+                auto it = _last_not_complete_rp.find(fname);
+                return it == _last_not_complete_rp.end() ? replay_position() : it->second;
+            }
             state_set _state;
             future<> _stopped;
             clock::time_point _next_flush_tp;
             clock::time_point _next_send_retry_tp;
+            int64_t _send_latency_ewma_us = 0;
+            clock::time_point _next_rate_increase_tp;
+            clock::time_point _next_rate_decrease_tp;
             key_type _ep_key;
             end_point_hints_manager& _ep_manager;
             manager& _shard_manager;
@@ -220,6 +236,21 @@ private:
             /// \brief Return the amount of time we want to sleep after the current iteration.
             /// \return The time till the soonest event: flushing or re-sending.
             clock::duration next_sleep_duration() const;
+
+            /// \brief Wait until the per-target token bucket (shared by all shards) allows sending the next hint.
+            /// \return future that resolves when a send credit has been taken
+            future<> wait_for_send_credit();
+
+            /// \brief Feed one send outcome into the pacing logic.
+            ///
+            /// Maintains an EWMA of the target's reply latency and drives the shared per-target send rate with an
+            /// AIMD rule: additive increase while the target keeps up, halving when sends fail or the latency EWMA
+            /// indicates that the target is falling behind. Every node replaying hints to the same target observes
+            /// the same slowdown, so they all back off together and the drain converges instead of oscillating.
+            ///
+            /// \param sample_latency latency of the completed send (ignored if \param failed is TRUE)
+            /// \param failed TRUE if the send completed with an error
+            void adjust_send_rate(std::chrono::microseconds sample_latency, bool failed) noexcept;
         };
 
     private:
@@ -241,6 +272,21 @@ private:
         state_set _state;
         const boost::filesystem::path _hints_dir;
         uint64_t _hints_in_progress = 0;
+
+    public:
+        /// Metadata about the hints written into one commitlog segment during
+        /// this process lifetime, keyed by segment id in \ref _segments_stats.
+        /// Replay uses it to discard segments whose longest-living hint has
+        /// already outlived its table's gc_grace_seconds without reading them.
+        /// Segments found on disk at startup have no entry and are replayed
+        /// the usual way.
+        struct segment_stats {
+            gc_clock::duration max_gc_grace = gc_clock::duration(0);
+            uint64_t hints = 0;
+        };
+
+    private:
+        std::unordered_map<uint64_t, segment_stats> _segments_stats;
         sender _sender;
 
     public:
@@ -263,6 +309,15 @@ private:
         /// \return FALSE if hint is definitely not going to be stored
         bool store_hint(schema_ptr s, lw_shared_ptr<const frozen_mutation> fm, tracing::trace_state_ptr tr_state) noexcept;
 
+        /// \brief Account a hint written into the given segment.
+        void note_stored_hint(uint64_t segment_id, gc_clock::duration gc_grace) noexcept;
+
+        /// \return The metadata of the given segment, or nullptr when nothing was recorded for it.
+        const segment_stats* get_segment_stats(uint64_t segment_id) const noexcept;
+
+        /// \brief Drop the metadata of a segment which was replayed or discarded.
+        void forget_segment_stats(uint64_t segment_id) noexcept;
+
         /// \brief Populates the _segments_to_replay list.
         ///  Populates the _segments_to_replay list with the names of the files in the <manager hints files directory> directory
         ///  in the order they should be sent out.
@@ -66,6 +66,7 @@
 #include "md5_hasher.hh"
 
 #include <seastar/util/noncopyable_function.hh>
+#include <seastar/core/shared_future.hh>
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/range/algorithm/copy.hpp>
@@ -728,11 +729,37 @@ future<> merge_unlock() {
  * @throws ConfigurationException If one of metadata attributes has invalid value
  * @throws IOException If data was corrupted during transportation or failed to apply fs operations
  */
+// Mutations of merge_schema() calls which arrived while the merge lock was
+// being acquired by an earlier call. They are all merged in a single
+// do_merge_schema() pass, with one version recalculation and announcement,
+// so a burst of DDL (CI creating hundreds of tables) costs a few passes
+// instead of one full read-apply-diff cycle per statement. Merging the
+// combined batch is equivalent to merging its parts one by one since the
+// before/after diff is computed over all keyspaces the batch touches.
+static thread_local std::vector<mutation> pending_mutations;
+static thread_local std::experimental::optional<shared_promise<>> pending_merge;
+
 future<> merge_schema(distributed<service::storage_proxy>& proxy, std::vector<mutation> mutations)
 {
-    return merge_lock().then([&proxy, mutations = std::move(mutations)] () mutable {
-        return do_merge_schema(proxy, std::move(mutations), true).then([&proxy] {
+    if (pending_merge) {
+        std::move(mutations.begin(), mutations.end(), std::back_inserter(pending_mutations));
+        return pending_merge->get_shared_future();
+    }
+    pending_merge = shared_promise<>();
+    pending_mutations = std::move(mutations);
+    return merge_lock().then([&proxy] () mutable {
+        auto current_merge = std::move(*pending_merge);
+        pending_merge = {};
+        return do_merge_schema(proxy, std::exchange(pending_mutations, {}), true).then([&proxy] {
             return update_schema_version_and_announce(proxy);
+        }).then_wrapped([current_merge = std::move(current_merge)] (future<> f) mutable {
+            if (f.failed()) {
+                auto ep = f.get_exception();
+                current_merge.set_exception(ep);
+                return make_exception_future<>(std::move(ep));
+            }
+            current_merge.set_value();
+            return make_ready_future<>();
         });
     }).finally([] {
         return merge_unlock();
@@ -766,12 +793,20 @@ std::map<qualified_name, schema_mutations>
 read_tables_for_keyspaces(distributed<service::storage_proxy>& proxy, const std::set<sstring>& keyspace_names, schema_ptr s)
 {
     std::map<qualified_name, schema_mutations> result;
-    for (auto&& keyspace_name : keyspace_names) {
-        for (auto&& table_name : read_table_names_of_keyspace(proxy, keyspace_name, s).get0()) {
-            auto qn = qualified_name(keyspace_name, table_name);
-            result.emplace(qn, read_table_mutations(proxy, qn, s).get0());
-        }
-    }
+    // The reads are all local and independent, so issue them in parallel
+    // across keyspaces and tables rather than one at a time.
+    parallel_for_each(keyspace_names, [&proxy, &result, s] (const sstring& keyspace_name) {
+        return read_table_names_of_keyspace(proxy, keyspace_name, s).then([&proxy, &result, s, keyspace_name] (std::vector<sstring> table_names) {
+            return do_with(std::move(table_names), [&proxy, &result, s, keyspace_name] (std::vector<sstring>& table_names) {
+                return parallel_for_each(table_names, [&proxy, &result, s, keyspace_name] (const sstring& table_name) {
+                    auto qn = qualified_name(keyspace_name, table_name);
+                    return read_table_mutations(proxy, qn, s).then([&result, qn] (schema_mutations sm) mutable {
+                        result.emplace(std::move(qn), std::move(sm));
+                    });
+                });
+            });
+        });
+    }).get();
     return result;
 }
 
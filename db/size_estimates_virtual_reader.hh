@@ -35,6 +35,7 @@
 #include "range.hh"
 #include "service/storage_service.hh"
 #include "stdx.hh"
+#include "utils/hash.hh"
 #include "mutation_fragment.hh"
 #include "sstables/sstables.hh"
 #include "db/timeout_clock.hh"
@@ -289,10 +290,51 @@ private:
         return dht::partition_range(std::move(start_bound), std::move(end_bound), r.is_singular());
     }
 
+    // Memoizes the expensive part of estimate(). Entries are keyed by table
+    // and token range and tagged with the table's sstable_set_version at
+    // computation time, so they stay valid until the next flush, compaction
+    // or truncation touches the table, without any explicit invalidation
+    // hooks. Spark jobs query size_estimates from every node at once and
+    // tend to repeat the same ranges, so on all but the first query per
+    // sstable-set generation this turns the per-range summary scans into a
+    // single hash lookup.
+    class estimate_cache {
+    public:
+        using key_type = std::tuple<utils::UUID, bytes, bytes>;
+        struct entry {
+            uint64_t version;
+            int64_t partitions_count;
+            int64_t mean_partition_size;
+        };
+    private:
+        static constexpr size_t max_entries = 128 * 1024;
+        std::unordered_map<key_type, entry, utils::tuple_hash> _cache;
+    public:
+        const entry* find(const key_type& k, uint64_t version) const {
+            auto it = _cache.find(k);
+            if (it == _cache.end() || it->second.version != version) {
+                return nullptr;
+            }
+            return &it->second;
+        }
+        void store(key_type k, entry e) {
+            if (_cache.size() >= max_entries) {
+                _cache.clear();
+            }
+            _cache[std::move(k)] = std::move(e);
+        }
+    };
+
     /**
      * Add a new range_estimates for the specified range, considering the sstables associated with `cf`.
      */
     static system_keyspace::range_estimates estimate(const column_family& cf, const token_range& r) {
+        static thread_local estimate_cache cache;
+        auto version = cf.sstable_set_version();
+        auto key = estimate_cache::key_type(cf.schema()->id(), r.start, r.end);
+        if (auto e = cache.find(key, version)) {
+            return {cf.schema(), r.start, r.end, e->partitions_count, e->mean_partition_size};
+        }
         int64_t count{0};
         utils::estimated_histogram hist{0};
         auto from_bytes = [] (auto& b) {
@@ -310,7 +352,9 @@ private:
                 hist.merge(sstable->get_stats_metadata().estimated_row_size);
             }
         }
-        return {cf.schema(), r.start, r.end, count, count > 0 ? hist.mean() : 0};
+        auto mean = count > 0 ? hist.mean() : 0;
+        cache.store(std::move(key), {version, count, mean});
+        return {cf.schema(), r.start, r.end, count, mean};
     }
 };
 
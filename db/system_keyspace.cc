@@ -68,6 +68,9 @@
 #include "log.hh"
 #include "serializer.hh"
 #include <core/enum.hh>
+#include <core/timer.hh>
+#include <core/shared_future.hh>
+#include <core/future-util.hh>
 #include "service/storage_proxy.hh"
 #include "message/messaging_service.hh"
 #include "mutation_query.hh"
@@ -86,6 +89,72 @@ namespace system_keyspace {
 static logging::logger slogger("system_keyspace");
 static const api::timestamp_type creation_timestamp = api::new_timestamp();
 
+// Coalesces small bookkeeping writes (peer columns, hint drop counters,
+// compaction history) issued within one tick into a single background flush,
+// so each of them does not individually pay a commitlog+memtable round
+// interleaved with user traffic. Writes which need durability or ordering
+// guarantees (truncation records, token updates, peer removal) keep the
+// direct path and flush() any batched writes first.
+class bookkeeping_write_batcher {
+public:
+    using write_fn = std::function<future<> ()>;
+private:
+    struct batch {
+        std::vector<write_fn> writes;
+        shared_promise<> done;
+    };
+    std::unique_ptr<batch> _current;
+    timer<> _timer;
+private:
+    void do_flush() {
+        if (!_current) {
+            return;
+        }
+        auto b = std::move(_current);
+        auto& writes = b->writes;
+        // Applied in the background; callers waiting on the batch observe
+        // completion (or failure) through the shared promise.
+        do_for_each(writes, [] (write_fn& write) {
+            return write();
+        }).then_wrapped([b = std::move(b)] (future<> f) {
+            if (f.failed()) {
+                auto ex = f.get_exception();
+                slogger.error("bookkeeping write failed: {}", ex);
+                b->done.set_exception(std::move(ex));
+            } else {
+                b->done.set_value();
+            }
+        });
+    }
+public:
+    bookkeeping_write_batcher() : _timer([this] { do_flush(); }) {}
+
+    future<> add(write_fn write) {
+        if (!_current) {
+            _current = std::make_unique<batch>();
+            _timer.arm(std::chrono::milliseconds(100));
+        }
+        _current->writes.emplace_back(std::move(write));
+        return _current->done.get_shared_future();
+    }
+
+    // Completes when every write admitted so far has been applied.
+    future<> flush() {
+        if (!_current) {
+            return make_ready_future<>();
+        }
+        _timer.cancel();
+        auto f = _current->done.get_shared_future();
+        do_flush();
+        return f;
+    }
+};
+
+static bookkeeping_write_batcher& bookkeeping_batcher() {
+    static thread_local bookkeeping_write_batcher batcher;
+    return batcher;
+}
+
 api::timestamp_type schema_creation_timestamp() {
     return creation_timestamp;
 }
@@ -441,6 +510,28 @@ schema_ptr size_estimates() {
     return size_estimates;
 }
 
+schema_ptr workload_groups() {
+    static thread_local auto workload_groups = [] {
+        schema_builder builder(make_lw_shared(schema(generate_legacy_id(NAME, WORKLOAD_GROUPS), NAME, WORKLOAD_GROUPS,
+            // partition key
+            {{"role", utf8_type}},
+            // clustering key
+            {},
+            // regular columns
+            {{"shares", int32_type}},
+            // static columns
+            {},
+            // regular column name type
+            utf8_type,
+            // comment
+            "per-role scheduling shares for workload isolation"
+            )));
+        builder.with_version(generate_schema_version(builder.uuid()));
+        return builder.build(schema_builder::compact_storage::no);
+    }();
+    return workload_groups;
+}
+
 namespace v3 {
 
 schema_ptr batches() {
@@ -603,7 +694,7 @@ schema_ptr views_builds_in_progress() {
         // partition key
         {{"keyspace_name", utf8_type}},
         // clustering key
-        {{"view_name", utf8_type}},
+        {{"view_name", utf8_type}, {"cpu_id", int32_type}},
         // regular columns
         {{"last_token", utf8_type}, {"generation_number", int32_type}},
         // static columns
@@ -1105,7 +1196,11 @@ future<> save_truncation_records(const column_family& cf, db_clock::time_point t
     auto map_type = map_type_impl::get_instance(uuid_type, bytes_type, true);
 
     sstring req = sprint("UPDATE system.%s SET truncated_at = truncated_at + ? WHERE key = '%s'", LOCAL, LOCAL);
-    return qctx->qp().execute_internal(req, {make_map_value(map_type, tmp)}).then([](auto rs) {
+    // Truncation records must be durable in order with respect to any pending
+    // bookkeeping writes, so drain the batcher before the forced flush below.
+    return bookkeeping_batcher().flush().then([req = std::move(req), tmp = std::move(tmp), map_type] {
+        return qctx->qp().execute_internal(req, {make_map_value(map_type, tmp)});
+    }).then([](auto rs) {
         truncation_records = {};
         return force_blocking_flush(LOCAL);
     });
@@ -1322,6 +1417,19 @@ future<std::unordered_map<gms::inet_address, sstring>> load_peer_features() {
     });
 }
 
+future<std::unordered_map<sstring, int32_t>> load_workload_groups() {
+    sstring req = sprint("SELECT role, shares FROM system.%s", WORKLOAD_GROUPS);
+    return execute_cql(req).then([] (::shared_ptr<cql3::untyped_result_set> cql_result) {
+        std::unordered_map<sstring, int32_t> ret;
+        for (auto& row : *cql_result) {
+            if (row.has("shares")) {
+                ret.emplace(row.get_as<sstring>("role"), row.get_as<int32_t>("shares"));
+            }
+        }
+        return ret;
+    });
+}
+
 future<> update_preferred_ip(gms::inet_address ep, gms::inet_address preferred_ip) {
     sstring req = sprint("INSERT INTO system.%s (peer, preferred_ip) VALUES (?, ?)", PEERS);
     return execute_cql(req, ep.addr(), preferred_ip.addr()).discard_result().then([] {
@@ -1371,9 +1479,11 @@ future<> update_peer_info(gms::inet_address ep, sstring column_name, Value value
     }
 
     return update_cached_values(ep, column_name, value).then([ep, column_name, value] {
-        sstring clause = sprint("(peer, %s) VALUES (?, ?)", column_name);
-        sstring req = sprint("INSERT INTO system.%s " + clause, PEERS);
-        return execute_cql(req, ep.addr(), value).discard_result();
+        return bookkeeping_batcher().add([ep, column_name, value] {
+            sstring clause = sprint("(peer, %s) VALUES (?, ?)", column_name);
+            sstring req = sprint("INSERT INTO system.%s " + clause, PEERS);
+            return execute_cql(req, ep.addr(), value).discard_result();
+        });
     });
 }
 // sets are not needed, since tokens are updated by another method
@@ -1382,9 +1492,11 @@ template future<> update_peer_info<utils::UUID>(gms::inet_address ep, sstring co
 template future<> update_peer_info<net::ipv4_address>(gms::inet_address ep, sstring column_name, net::ipv4_address);
 
 future<> update_hints_dropped(gms::inet_address ep, utils::UUID time_period, int value) {
-    // with 30 day TTL
-    sstring req = sprint("UPDATE system.%s USING TTL 2592000 SET hints_dropped[ ? ] = ? WHERE peer = ?", PEER_EVENTS);
-    return execute_cql(req, time_period, value, ep.addr()).discard_result();
+    return bookkeeping_batcher().add([ep, time_period, value] {
+        // with 30 day TTL
+        sstring req = sprint("UPDATE system.%s USING TTL 2592000 SET hints_dropped[ ? ] = ? WHERE peer = ?", PEER_EVENTS);
+        return execute_cql(req, time_period, value, ep.addr()).discard_result();
+    });
 }
 
 future<> update_schema_version(utils::UUID version) {
@@ -1396,8 +1508,12 @@ future<> update_schema_version(utils::UUID version) {
  * Remove stored tokens being used by another node
  */
 future<> remove_endpoint(gms::inet_address ep) {
-    return _local_cache.invoke_on_all([ep] (local_cache& lc) {
-        lc._cached_dc_rack_info.erase(ep);
+    // Flush any batched writes to this peer's row first, so they cannot be
+    // applied after the delete below and resurrect it.
+    return bookkeeping_batcher().flush().then([ep] {
+        return _local_cache.invoke_on_all([ep] (local_cache& lc) {
+            lc._cached_dc_rack_info.erase(ep);
+        });
     }).then([ep] {
         sstring req = sprint("DELETE FROM system.%s WHERE peer = ?", PEERS);
         return execute_cql(req, ep.addr()).discard_result();
@@ -1540,7 +1656,8 @@ std::vector<schema_ptr> all_tables() {
     r.insert(r.end(), { built_indexes(), hints(), batchlog(), paxos(), local(),
                     peers(), peer_events(), range_xfers(),
                     compactions_in_progress(), compaction_history(),
-                    sstable_activity(), size_estimates(),
+                    sstable_activity(), size_estimates(), workload_groups(),
+                    v3::views_builds_in_progress(), v3::built_views(),
     });
     // legacy schema
     r.insert(r.end(), {
@@ -1580,6 +1697,7 @@ void make(database& db, bool durable, bool volatile_testing_only) {
             // don't make system keyspace reads wait for user reads
             kscfg.read_concurrency_config.resources_sem = &db.system_keyspace_read_concurrency_sem();
             kscfg.read_concurrency_config.active_reads = &db.get_stats().active_reads_system_keyspace;
+            kscfg.read_concurrency_config.total_queued_reads = &db.get_stats().total_queued_reads_system_keyspace;
             kscfg.read_concurrency_config.max_queue_length = std::numeric_limits<size_t>::max();
             // don't make system keyspace writes wait for user writes (if under pressure)
             kscfg.dirty_memory_manager = &db._system_dirty_memory_manager;
@@ -1703,13 +1821,15 @@ future<> update_compaction_history(sstring ksname, sstring cfname, int64_t compa
         return make_ready_future<>();
     }
 
-    auto map_type = map_type_impl::get_instance(int32_type, long_type, true);
+    return bookkeeping_batcher().add([ksname = std::move(ksname), cfname = std::move(cfname), compacted_at, bytes_in, bytes_out, rows_merged = std::move(rows_merged)] {
+        auto map_type = map_type_impl::get_instance(int32_type, long_type, true);
 
-    sstring req = sprint("INSERT INTO system.%s (id, keyspace_name, columnfamily_name, compacted_at, bytes_in, bytes_out, rows_merged) VALUES (?, ?, ?, ?, ?, ?, ?)"
-                    , COMPACTION_HISTORY);
+        sstring req = sprint("INSERT INTO system.%s (id, keyspace_name, columnfamily_name, compacted_at, bytes_in, bytes_out, rows_merged) VALUES (?, ?, ?, ?, ?, ?, ?)"
+                        , COMPACTION_HISTORY);
 
-    return execute_cql(req, utils::UUID_gen::get_time_UUID(), ksname, cfname, compacted_at, bytes_in, bytes_out,
-                       make_map_value(map_type, prepare_rows_merged(rows_merged))).discard_result();
+        return execute_cql(req, utils::UUID_gen::get_time_UUID(), ksname, cfname, compacted_at, bytes_in, bytes_out,
+                           make_map_value(map_type, prepare_rows_merged(rows_merged))).discard_result();
+    });
 }
 
 future<std::vector<compaction_history_entry>> get_compaction_history() {
@@ -1736,6 +1856,62 @@ future<std::vector<compaction_history_entry>> get_compaction_history() {
 }
 
 
+future<> mark_view_as_built(sstring ks_name, sstring view_name) {
+    sstring req = sprint("INSERT INTO system.%s (keyspace_name, view_name) VALUES (?, ?)", v3::BUILT_VIEWS);
+    return execute_cql(req, std::move(ks_name), std::move(view_name)).discard_result();
+}
+
+future<> remove_built_view(sstring ks_name, sstring view_name) {
+    sstring req = sprint("DELETE FROM system.%s WHERE keyspace_name = ? AND view_name = ?", v3::BUILT_VIEWS);
+    return execute_cql(req, std::move(ks_name), std::move(view_name)).discard_result();
+}
+
+future<std::vector<view_name>> load_built_views() {
+    sstring req = sprint("SELECT * FROM system.%s", v3::BUILT_VIEWS);
+    return execute_cql(req).then([] (::shared_ptr<cql3::untyped_result_set> cql_result) {
+        return boost::copy_range<std::vector<view_name>>(*cql_result
+                | boost::adaptors::transformed([] (const cql3::untyped_result_set::row& row) {
+            auto ks_name = row.get_as<sstring>("keyspace_name");
+            auto cf_name = row.get_as<sstring>("view_name");
+            return std::make_pair(std::move(ks_name), std::move(cf_name));
+        }));
+    });
+}
+
+future<> update_view_build_progress(sstring ks_name, sstring view_name, const dht::token& token) {
+    sstring req = sprint("INSERT INTO system.%s (keyspace_name, view_name, cpu_id, last_token) VALUES (?, ?, ?, ?)",
+            v3::VIEWS_BUILDS_IN_PROGRESS);
+    return execute_cql(req, std::move(ks_name), std::move(view_name), int32_t(engine().cpu_id()),
+            dht::global_partitioner().to_sstring(token)).discard_result();
+}
+
+future<> remove_view_build_progress(sstring ks_name, sstring view_name) {
+    sstring req = sprint("DELETE FROM system.%s WHERE keyspace_name = ? AND view_name = ? AND cpu_id = ?",
+            v3::VIEWS_BUILDS_IN_PROGRESS);
+    return execute_cql(req, std::move(ks_name), std::move(view_name), int32_t(engine().cpu_id())).discard_result();
+}
+
+future<std::vector<view_build_progress>> load_view_build_progress() {
+    sstring req = sprint("SELECT keyspace_name, view_name, cpu_id, last_token FROM system.%s", v3::VIEWS_BUILDS_IN_PROGRESS);
+    return execute_cql(req).then([] (::shared_ptr<cql3::untyped_result_set> cql_result) {
+        std::vector<view_build_progress> progress;
+        for (auto& row : *cql_result) {
+            // The table is shared by all shards, but each one checkpoints
+            // and resumes only its own scan.
+            if (row.get_as<int32_t>("cpu_id") != int32_t(engine().cpu_id())) {
+                continue;
+            }
+            view_build_progress p;
+            p.view = std::make_pair(row.get_as<sstring>("keyspace_name"), row.get_as<sstring>("view_name"));
+            if (row.has("last_token")) {
+                p.last_token = dht::global_partitioner().from_sstring(row.get_as<sstring>("last_token"));
+            }
+            progress.push_back(std::move(p));
+        }
+        return progress;
+    });
+}
+
 future<int> increment_and_get_generation() {
     auto req = sprint("SELECT gossip_generation FROM system.%s WHERE key='%s'", LOCAL, LOCAL);
     return qctx->qp().execute_internal(req).then([] (auto rs) {
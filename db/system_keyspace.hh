@@ -42,6 +42,7 @@
 
 #include <unordered_map>
 #include <utility>
+#include <experimental/optional>
 #include "schema.hh"
 #include "db/schema_tables.hh"
 #include "utils/UUID.hh"
@@ -80,6 +81,7 @@ static constexpr auto COMPACTIONS_IN_PROGRESS = "compactions_in_progress";
 static constexpr auto COMPACTION_HISTORY = "compaction_history";
 static constexpr auto SSTABLE_ACTIVITY = "sstable_activity";
 static constexpr auto SIZE_ESTIMATES = "size_estimates";
+static constexpr auto WORKLOAD_GROUPS = "workload_groups";
 
 namespace v3 {
 static constexpr auto BATCHES = "batches";
@@ -121,6 +123,7 @@ struct range_estimates {
 extern schema_ptr hints();
 extern schema_ptr batchlog();
 extern schema_ptr built_indexes(); // TODO (from Cassandra): make private
+extern schema_ptr workload_groups();
 
 namespace legacy {
 
@@ -364,6 +367,23 @@ enum class bootstrap_state {
                                        std::unordered_map<int32_t, int64_t> rows_merged);
     future<std::vector<compaction_history_entry>> get_compaction_history();
 
+    // (keyspace name, view name)
+    using view_name = std::pair<sstring, sstring>;
+
+    struct view_build_progress {
+        view_name view;
+        stdx::optional<dht::token> last_token;
+    };
+
+    future<> mark_view_as_built(sstring ks_name, sstring view_name);
+    future<> remove_built_view(sstring ks_name, sstring view_name);
+    future<std::vector<view_name>> load_built_views();
+
+    // Each shard tracks its own scan position, keyed by its cpu id.
+    future<> update_view_build_progress(sstring ks_name, sstring view_name, const dht::token& token);
+    future<> remove_view_build_progress(sstring ks_name, sstring view_name);
+    future<std::vector<view_build_progress>> load_view_build_progress();
+
     typedef std::vector<db::replay_position> replay_positions;
 
     future<> save_truncation_record(const column_family&, db_clock::time_point truncated_at, db::replay_position);
@@ -485,6 +505,9 @@ enum class bootstrap_state {
 
     future<std::unordered_map<gms::inet_address, sstring>> load_peer_features();
 
+    // Contents of the workload_groups table: role name -> scheduling shares.
+    future<std::unordered_map<sstring, int32_t>> load_workload_groups();
+
 future<int> increment_and_get_generation();
 bool bootstrap_complete();
 bool bootstrap_in_progress();
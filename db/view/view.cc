@@ -45,6 +45,10 @@
 #include <boost/range/algorithm/transform.hpp>
 #include <boost/range/adaptors.hpp>
 
+#include "core/future-util.hh"
+#include <seastar/core/memory.hh>
+#include <seastar/core/semaphore.hh>
+
 #include "clustering_bounds_comparator.hh"
 #include "cql3/statements/select_statement.hh"
 #include "cql3/util.hh"
@@ -785,13 +789,128 @@ get_view_natural_endpoint(const sstring& keyspace_name,
     return view_endpoints[base_it - base_endpoints.begin()];
 }
 
+// A per-shard batcher for outgoing view updates. Updates are staged here by
+// mutate_MV() and applied or sent in the background, merged per destination
+// replica and per view partition, so the base write only pays for generating
+// them. The memory consumed by staged and in-flight updates is bounded: when
+// the budget is exhausted, staging waits for older updates to drain, pushing
+// back on the base write path.
+class view_update_batcher {
+    struct batch {
+        std::vector<mutation> mutations;
+        size_t size = 0;
+    };
+
+    // Memory budget for staged and in-flight view updates on this shard.
+    const size_t _memory_budget = memory::stats().total_memory() / 64;
+    // Dispatch a batch once it accumulates this much, ...
+    static constexpr size_t max_batch_size = 128 * 1024;
+    // ... or at the latest this long after its oldest staged update.
+    static constexpr std::chrono::milliseconds max_batch_delay{10};
+
+    semaphore _memory{_memory_budget};
+    batch _local; // applied with mutate_locally()
+    std::unordered_map<gms::inet_address, batch> _remote; // sent with send_to_endpoint()
+    timer<> _flush_timer{[this] { flush_all(); }};
+
+public:
+    future<> stage_local(mutation mut) {
+        return do_stage(true, { }, std::move(mut));
+    }
+
+    future<> stage(gms::inet_address endpoint, mutation mut) {
+        return do_stage(false, std::move(endpoint), std::move(mut));
+    }
+
+private:
+    static size_t update_size(const mutation& m) {
+        return sizeof(mutation) + m.key().external_memory_usage() + m.partition().external_memory_usage();
+    }
+
+    future<> do_stage(bool local, gms::inet_address endpoint, mutation mut) {
+        auto size = std::min(update_size(mut), _memory_budget);
+        // This is the backpressure point: if the shard-wide budget for view
+        // updates is spent, the base write stalls here until enough
+        // previously staged updates complete.
+        return _memory.wait(size).then([this, local, endpoint, mut = std::move(mut), size] () mutable {
+            auto& b = local ? _local : _remote[endpoint];
+            // Merge with an already-staged update to the same view partition,
+            // if any; batches are small, so a linear scan will do.
+            auto i = std::find_if(b.mutations.begin(), b.mutations.end(), [&mut] (const mutation& m) {
+                return m.schema() == mut.schema() && m.decorated_key().equal(*mut.schema(), mut.decorated_key());
+            });
+            if (i != b.mutations.end()) {
+                i->apply(std::move(mut));
+            } else {
+                b.mutations.emplace_back(std::move(mut));
+            }
+            b.size += size;
+            if (b.size >= max_batch_size) {
+                flush(local, endpoint);
+            } else if (!_flush_timer.armed()) {
+                _flush_timer.arm(max_batch_delay);
+            }
+        });
+    }
+
+    void flush(bool local, gms::inet_address endpoint) {
+        batch b;
+        if (local) {
+            b = std::exchange(_local, batch());
+        } else {
+            auto i = _remote.find(endpoint);
+            if (i == _remote.end()) {
+                return;
+            }
+            b = std::move(i->second);
+            _remote.erase(i);
+        }
+        if (b.mutations.empty()) {
+            return;
+        }
+        auto size = b.size;
+        // Note that mutate_locally(mutations) copies the mutations (in
+        // frozen form), and send_to_endpoint() takes its mutation by value,
+        // so neither needs the batch kept alive. We do not wait for either
+        // to complete.
+        auto f = local ? service::get_local_storage_proxy().mutate_locally(std::move(b.mutations))
+                : parallel_for_each(b.mutations, [endpoint] (mutation& m) {
+                    return service::get_local_storage_proxy().send_to_endpoint(std::move(m), endpoint, db::write_type::VIEW);
+                });
+        f.then_wrapped([this, local, endpoint, size] (future<> f) {
+            if (f.failed()) {
+                if (local) {
+                    vlogger.error("Error applying local view update: {}", f.get_exception());
+                } else {
+                    vlogger.error("Error applying view update to {}: {}", endpoint, f.get_exception());
+                }
+            }
+            _memory.signal(size);
+        });
+    }
+
+    void flush_all() {
+        flush(true, { });
+        while (!_remote.empty()) {
+            flush(false, _remote.begin()->first);
+        }
+    }
+};
+
+static view_update_batcher& local_view_update_batcher() {
+    static thread_local view_update_batcher batcher;
+    return batcher;
+}
+
 // Take the view mutations generated by generate_view_updates(), which pertain
-// to a modification of a single base partition, and apply them to the
-// appropriate paired replicas. This is done asynchronously - we do not wait
-// for the writes to complete.
+// to a modification of a single base partition, and stage them for delivery
+// to the appropriate paired replicas. Delivery is done asynchronously - we do
+// not wait for the writes to complete - but the returned future may wait when
+// the shard's view update memory budget is exhausted, so the base write slows
+// down instead of queueing updates without bound.
 // FIXME: I dropped a lot of parameters the Cassandra version had,
 // we may need them back: writeCommitLog, baseComplete, queryStartNanoTime.
-void mutate_MV(const dht::token& base_token,
+future<> mutate_MV(const dht::token& base_token,
         std::vector<mutation> mutations)
 {
 #if 0
@@ -823,7 +942,8 @@ void mutate_MV(const dht::token& base_token,
                                                                                                           () -> asyncRemoveFromBatchlog(batchlogEndpoints, batchUUID));
             // add a handler for each mutation - includes checking availability, but doesn't initiate any writes, yet
 #endif
-    for (auto& mut : mutations) {
+    return do_with(std::move(mutations), [base_token] (std::vector<mutation>& mutations) {
+      return do_for_each(mutations, [base_token] (mutation& mut) {
         auto view_token = mut.token();
         auto keyspace_name = mut.schema()->ks_name();
         auto paired_endpoint = get_view_natural_endpoint(keyspace_name, base_token, view_token);
@@ -834,13 +954,10 @@ void mutate_MV(const dht::token& base_token,
             auto my_address = utils::fb_utilities::get_broadcast_address();
             if (*paired_endpoint == my_address && pending_endpoints.empty() &&
                 service::get_local_storage_service().is_joined()) {
-                    // Note that we start here an asynchronous apply operation, and
-                    // do not wait for it to complete.
-                    // Note also that mutate_locally(mut) copies mut (in
-                    // frozen from) so don't need to increase its lifetime.
-                    service::get_local_storage_proxy().mutate_locally(mut).handle_exception([] (auto ep) {
-                        vlogger.error("Error applying local view update: {}", ep);
-                    });
+                    // The batcher applies the mutation in the background,
+                    // possibly merged with other updates for the same view
+                    // partition.
+                    return local_view_update_batcher().stage_local(std::move(mut));
             } else {
 #if 0
                         wrappers.add(wrapViewBatchResponseHandler(mutation,
@@ -855,10 +972,7 @@ void mutate_MV(const dht::token& base_token,
                 // FIXME: Temporary hack: send the write directly to paired_endpoint,
                 // without a batchlog, and without checking for success
                 // Note we don't wait for the asynchronous operation to complete
-                // FIXME: need to extend mut's lifetime???
-                service::get_local_storage_proxy().send_to_endpoint(mut, *paired_endpoint, db::write_type::VIEW).handle_exception([paired_endpoint] (auto ep) {
-                    vlogger.error("Error applying view update to {}: {}", *paired_endpoint, ep);
-                });;
+                return local_view_update_batcher().stage(*paired_endpoint, std::move(mut));
             }
         } else {
 #if 0
@@ -874,7 +988,9 @@ void mutate_MV(const dht::token& base_token,
                 }
 #endif
         }
-    }
+        return make_ready_future<>();
+      });
+    });
 #if 0
             if (!wrappers.isEmpty())
             {
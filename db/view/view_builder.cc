@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/core/sleep.hh>
+
+#include "db/view/view_builder.hh"
+#include "database.hh"
+#include "db/system_keyspace.hh"
+#include "dht/i_partitioner.hh"
+#include "flat_mutation_reader.hh"
+#include "service/priority_manager.hh"
+#include "log.hh"
+
+namespace db {
+
+namespace view {
+
+static logging::logger vblogger("view_builder");
+
+view_builder::view_builder(seastar::distributed<database>& db)
+        : _db(db) {
+}
+
+future<> view_builder::start() {
+    // Only shard 0 coordinates; build_view() fans the actual work out to
+    // every shard.
+    if (engine().cpu_id() != 0) {
+        return make_ready_future<>();
+    }
+    with_gate(_build_gate, [this] {
+        return build_all();
+    }).handle_exception([] (auto ep) {
+        vblogger.error("View building failed: {}", ep);
+    });
+    return make_ready_future<>();
+}
+
+future<> view_builder::stop() {
+    _stopped = true;
+    return _build_gate.close();
+}
+
+future<> view_builder::build_all() {
+    return seastar::async([this] {
+        auto built = db::system_keyspace::load_built_views().get0();
+        std::vector<view_ptr> views_to_build;
+        for (auto& cf_entry : _db.local().get_column_families()) {
+            for (auto& view : cf_entry.second->views()) {
+                auto name = std::make_pair(view->ks_name(), view->cf_name());
+                if (std::find(built.begin(), built.end(), name) == built.end()) {
+                    views_to_build.push_back(view);
+                }
+            }
+        }
+        // One view at a time: each build already keeps every shard busy.
+        for (auto& view : views_to_build) {
+            if (_stopped) {
+                return;
+            }
+            build_view(view).get();
+        }
+    });
+}
+
+future<> view_builder::build_view(view_ptr view) {
+    auto ks_name = view->ks_name();
+    auto cf_name = view->cf_name();
+    vblogger.info("Building view {}.{}", ks_name, cf_name);
+    auto base_id = view->view_info()->base_id();
+    auto view_id = view->id();
+    return container().invoke_on_all([base_id, view_id] (view_builder& vb) {
+        return vb.build_view_locally(base_id, view_id);
+    }).then([this, ks_name, cf_name] {
+        if (_stopped) {
+            // Keep the per-shard checkpoints so the next start resumes.
+            return make_ready_future<>();
+        }
+        return db::system_keyspace::mark_view_as_built(ks_name, cf_name).then([ks_name, cf_name] {
+            return db::system_keyspace::remove_view_build_progress(ks_name, cf_name);
+        }).then([ks_name, cf_name] {
+            vblogger.info("Finished building view {}.{}", ks_name, cf_name);
+        });
+    });
+}
+
+future<> view_builder::build_view_locally(utils::UUID base_id, utils::UUID view_id) {
+    return with_gate(_build_gate, [this, base_id, view_id] {
+        return seastar::async([this, base_id, view_id] {
+            auto& db = _db.local();
+            auto cf = db.find_column_family(base_id).shared_from_this();
+            auto base = cf->schema();
+            auto view = view_ptr(db.find_schema(view_id));
+
+            // Resume from this shard's checkpoint, if there is one. Tokens
+            // are fully contained by a shard, so each shard's scan position
+            // is independent of the others.
+            stdx::optional<dht::token> last_token;
+            for (auto& p : db::system_keyspace::load_view_build_progress().get0()) {
+                if (p.view.first == view->ks_name() && p.view.second == view->cf_name()) {
+                    last_token = p.last_token;
+                }
+            }
+            auto range = query::full_partition_range;
+            if (last_token) {
+                vblogger.info("Resuming build of view {}.{} on shard {} after token {}",
+                        view->ks_name(), view->cf_name(), engine().cpu_id(), *last_token);
+                range = dht::partition_range::make_starting_with({dht::ring_position::ending_at(*last_token), false});
+            }
+
+            auto reader = cf->make_reader(base, range, base->full_slice(), service::get_local_streaming_read_priority());
+            size_t in_batch = 0;
+            auto batch_start = std::chrono::steady_clock::now();
+            while (!_stopped) {
+                auto mo = read_mutation_from_flat_mutation_reader(reader).get0();
+                if (!mo) {
+                    break;
+                }
+                auto token = mo->token();
+                cf->populate_view(view, std::move(*mo)).get();
+                if (++in_batch >= batch_size) {
+                    in_batch = 0;
+                    db::system_keyspace::update_view_build_progress(view->ks_name(), view->cf_name(), token).get();
+                    // Throttle against foreground load: when reads are
+                    // queued, pause for as long as the batch took, halving
+                    // the build's share of the shard.
+                    auto now = std::chrono::steady_clock::now();
+                    if (db.queued_reads()) {
+                        seastar::sleep(now - batch_start).get();
+                    }
+                    batch_start = std::chrono::steady_clock::now();
+                }
+            }
+        });
+    });
+}
+
+}
+
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <seastar/core/distributed.hh>
+#include <seastar/core/gate.hh>
+#include "schema.hh"
+#include "utils/UUID.hh"
+
+class database;
+
+namespace db {
+
+namespace view {
+
+/**
+ * Builds materialized views from base table data which predates the view.
+ *
+ * One instance runs on every shard. Shard 0 coordinates: it picks the views
+ * which are not yet marked as built in system.built_views and asks every
+ * shard to stream the base table data it owns through view update
+ * generation, so a build runs with full smp parallelism. Each shard
+ * checkpoints the token it reached in system.views_builds_in_progress after
+ * every batch of partitions, so an interrupted build resumes from where it
+ * stopped instead of starting over. The scan runs at streaming I/O priority
+ * and backs off between batches while foreground reads are queued, so a
+ * build does not compete with serving traffic.
+ */
+class view_builder : public seastar::peering_sharded_service<view_builder> {
+public:
+    // Number of partitions streamed between two progress checkpoints.
+    static constexpr size_t batch_size = 128;
+private:
+    seastar::distributed<database>& _db;
+    seastar::gate _build_gate;
+    bool _stopped = false;
+public:
+    explicit view_builder(seastar::distributed<database>& db);
+
+    // Kicks off building of all views not yet marked as built. The builds
+    // run in the background; startup does not wait for them.
+    future<> start();
+    future<> stop();
+
+    // Builds the given view on all shards and marks it as built.
+    // Must be called on shard 0.
+    future<> build_view(view_ptr view);
+private:
+    future<> build_all();
+    future<> build_view_locally(utils::UUID base_id, utils::UUID view_id);
+};
+
+}
+
+}
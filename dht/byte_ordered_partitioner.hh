@@ -50,6 +50,17 @@ public:
     virtual int tri_compare(const token& t1, const token& t2) const override {
         return compare_unsigned(t1._data, t2._data);
     }
+    virtual uint64_t token_comparison_prefix(const token& t) const override {
+        // Tokens compare lexicographically, so the first 8 bytes,
+        // zero-padded, interpreted big-endian, order consistently;
+        // longer tokens sharing those bytes tie and fall back.
+        uint64_t v = 0;
+        auto n = std::min(t._data.size(), sizeof(uint64_t));
+        for (size_t i = 0; i < n; ++i) {
+            v |= uint64_t(uint8_t(t._data[i])) << ((sizeof(uint64_t) - 1 - i) * 8);
+        }
+        return v;
+    }
     virtual token midpoint(const token& t1, const token& t2) const;
     virtual sstring to_sstring(const dht::token& t) const override {
         if (t._kind == dht::token::kind::before_all_keys) {
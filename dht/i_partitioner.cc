@@ -157,6 +157,16 @@ std::ostream& operator<<(std::ostream& out, const decorated_key& dk) {
     return out << "{key: " << dk._key << ", token:" << dk._token << "}";
 }
 
+std::vector<token>
+i_partitioner::get_tokens(const std::vector<sstables::key_view>& keys) {
+    std::vector<token> ret;
+    ret.reserve(keys.size());
+    for (auto&& key : keys) {
+        ret.push_back(get_token(key));
+    }
+    return ret;
+}
+
 // FIXME: make it per-keyspace
 std::unique_ptr<i_partitioner> default_partitioner;
 
@@ -46,6 +46,7 @@
 #include "keys.hh"
 #include "utils/managed_bytes.hh"
 #include "stdx.hh"
+#include <limits>
 #include <memory>
 #include <random>
 #include <utility>
@@ -248,6 +249,13 @@ public:
     virtual token get_token(const schema& s, partition_key_view key) = 0;
     virtual token get_token(const sstables::key_view& key) = 0;
 
+    /**
+     * @return the tokens of a batch of keys, in order. Equivalent to calling
+     * get_token() on each key, but lets implementations overlap the hash
+     * computations of adjacent keys.
+     */
+    virtual std::vector<token> get_tokens(const std::vector<sstables::key_view>& keys);
+
 
     /**
      * @return a partitioner-specific string representation of this token
@@ -330,6 +338,19 @@ public:
      * @return < 0 if if t1's _data array is less, t2's. 0 if they are equal, and > 0 otherwise. _kind comparison should be done separately.
      */
     virtual int tri_compare(const token& t1, const token& t2) const = 0;
+    /**
+     * @return a value which orders the same way the token does when
+     * compared as an unsigned integer, as long as two tokens' values
+     * differ; equal values say nothing and must be resolved with a full
+     * tri_compare(). Only called for tokens of kind::key. This lets hot
+     * comparison paths (e.g. the memtable partition index) decide most
+     * comparisons on an inline integer without touching the token's
+     * managed storage. Partitioners with no cheap mapping may keep the
+     * default, which makes every comparison fall back.
+     */
+    virtual uint64_t token_comparison_prefix(const token& t) const {
+        return 0;
+    }
     /**
      * @return true if t1's _data array is equal t2's. _kind comparison should be done separately.
      */
@@ -346,6 +367,16 @@ public:
     /**
      * @return number of shards configured for this partitioner
      */
+    /**
+     * @return the number of most significant token bits that shard_of()
+     * ignores when mapping a token to a shard. Advertised to shard-aware
+     * drivers together with shard_count() so they can reproduce the
+     * mapping client-side.
+     */
+    virtual unsigned sharding_ignore_msb() const {
+        return 0;
+    }
+
     unsigned shard_count() const {
         return _shard_count;
     }
@@ -573,6 +604,7 @@ public:
         , _weight(weight)
     { }
 
+    const dht::token& token() const { return *_token; }
     const partition_key* key() const { return _key; }
 
     friend std::ostream& operator<<(std::ostream&, ring_position_view);
@@ -613,6 +645,24 @@ i_partitioner& global_partitioner();
 
 unsigned shard_of(const token&);
 
+/**
+ * A 64-bit prefix of a token's comparison order: if two tokens' prefixes
+ * differ, comparing the prefixes as unsigned integers gives the same
+ * result as dht::tri_compare() on the tokens; equal prefixes say nothing
+ * and the caller must fall back to a full comparison. See
+ * i_partitioner::token_comparison_prefix().
+ */
+inline uint64_t token_comparison_prefix(const token& t) {
+    switch (t._kind) {
+    case token::kind::before_all_keys:
+        return 0;
+    case token::kind::after_all_keys:
+        return std::numeric_limits<uint64_t>::max();
+    default:
+        return global_partitioner().token_comparison_prefix(t);
+    }
+}
+
 struct ring_position_range_and_shard {
     dht::partition_range ring_range;
     unsigned shard;
@@ -92,6 +92,31 @@ murmur3_partitioner::get_token(const sstables::key_view& key) {
     return get_token(bytes_view(key));
 }
 
+std::vector<token>
+murmur3_partitioner::get_tokens(const std::vector<sstables::key_view>& keys) {
+    std::vector<token> ret;
+    ret.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto k1 = bytes_view(keys[i]);
+        // Hash adjacent keys in pairs; the interleaved lanes hide the
+        // latency of the hash's multiply chains.
+        if (i + 1 < keys.size() && !k1.empty()) {
+            auto k2 = bytes_view(keys[i + 1]);
+            if (!k2.empty()) {
+                std::array<uint64_t, 2> h1;
+                std::array<uint64_t, 2> h2;
+                utils::murmur_hash::hash3_x64_128_x2(k1.begin(), k1.size(), k2.begin(), k2.size(), 0, h1, h2);
+                ret.push_back(get_token(h1[0]));
+                ret.push_back(get_token(h2[0]));
+                ++i;
+                continue;
+            }
+        }
+        ret.push_back(get_token(k1));
+    }
+    return ret;
+}
+
 token
 murmur3_partitioner::get_token(const schema& s, partition_key_view key) {
     std::array<uint64_t, 2> hash;
@@ -157,6 +182,16 @@ dht::token murmur3_partitioner::from_bytes(bytes_view bytes) const {
     }
 }
 
+uint64_t murmur3_partitioner::token_comparison_prefix(const token& t) const {
+    if (t._data.size() != sizeof(int64_t)) {
+        return 0;
+    }
+    // Tokens order as signed 64-bit integers; unbias() maps that order
+    // onto the unsigned range, so the whole token fits in the prefix and
+    // only equal tokens fall back.
+    return unbias(t);
+}
+
 int murmur3_partitioner::tri_compare(const token& t1, const token& t2) const {
     auto l1 = long_token(t1);
     auto l2 = long_token(t2);
@@ -67,10 +67,19 @@ range_streamer::get_range_fetch_map(const std::unordered_multimap<dht::token_ran
                                     const std::unordered_set<std::unique_ptr<i_source_filter>>& source_filters,
                                     const sstring& keyspace) {
     std::unordered_multimap<inet_address, dht::token_range> range_fetch_map_map;
+    // Ranges assigned to each source so far. Each range is still fetched
+    // from exactly one node, but by assigning every range to the least
+    // loaded of its eligible replicas the whole set of ranges is spread
+    // across all of them, and do_stream_async(), which runs one streaming
+    // fiber per source, pulls disjoint ranges from all replicas in parallel
+    // instead of serializing most of the work on a single source.
+    std::unordered_map<inet_address, size_t> load;
     for (auto x : unordered_multimap_to_unordered_map(ranges_with_sources)) {
         const dht::token_range& range_ = x.first;
         const std::unordered_set<inet_address>& addresses = x.second;
         bool found_source = false;
+        bool have_best = false;
+        inet_address best;
         for (auto address : addresses) {
             if (address == utils::fb_utilities::get_broadcast_address()) {
                 // If localhost is a source, we have found one, but we don't add it to the map to avoid streaming locally
@@ -90,9 +99,16 @@ range_streamer::get_range_fetch_map(const std::unordered_multimap<dht::token_ran
                 continue;
             }
 
-            range_fetch_map_map.emplace(address, range_);
+            if (!have_best || load[address] < load[best]) {
+                best = address;
+                have_best = true;
+            }
             found_source = true;
-            break; // ensure we only stream from one other node for each range
+        }
+
+        if (have_best) {
+            ++load[best];
+            range_fetch_map_map.emplace(best, range_);
         }
 
         if (!found_source) {
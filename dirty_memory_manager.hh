@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <boost/intrusive/parent_from_member.hpp>
 #include <seastar/core/condition-variable.hh>
 #include <seastar/core/future.hh>
@@ -90,7 +91,13 @@ class dirty_memory_manager: public logalloc::region_group_reclaimer {
     // memtable is totally gone. That means that if we have throttled requests, they will stay
     // throttled for a long time. Even when we have virtual dirty, that only provides a rough
     // estimate, and we can't release requests that early.
+    //
+    // The exception is when the dirty limit itself is approaching: then a single flush at a
+    // time no longer keeps up with ingest, so flush_when_needed() temporarily grants a second
+    // unit, letting two (typically small) memtables drain in parallel, and takes it back as
+    // soon as the pressure recedes. _extra_flush_slot tracks whether that unit is out.
     semaphore _flush_serializer;
+    bool _extra_flush_slot = false;
     // We will accept a new flush before another one ends, once it is done with the data write.
     // That is so we can keep the disk always busy. But there is still some background work that is
     // left to be done. Mostly, update the caches and seal the auxiliary components of the SSTable.
@@ -102,6 +109,17 @@ class dirty_memory_manager: public logalloc::region_group_reclaimer {
     condition_variable _should_flush;
     int64_t _dirty_bytes_released_pre_accounted = 0;
 
+    // Occupancy of each memtable as of the previous flush-candidate
+    // selection, so pick_flush_candidate() can tell which memtables are
+    // actively growing. Rebuilt on every selection; sealed memtables
+    // simply drop out.
+    std::unordered_map<const memtable*, uint64_t> _previous_flush_candidate_sizes;
+    // How much stronger recent growth weighs than resident size when
+    // scoring flush candidates.
+    static constexpr unsigned _growth_weight = 4;
+
+    memtable* pick_flush_candidate();
+
     future<> flush_when_needed();
 
     future<> _waiting_flush;
@@ -149,12 +167,18 @@ public:
     //
     // We then set the soft limit to 80 % of the virtual dirty hard limit, which is equal to 40 % of
     // the user-supplied threshold.
-    dirty_memory_manager(database& db, size_t threshold, double soft_limit)
+    //
+    // deferred_work_sg names the scheduling group under which writes that were
+    // blocked on this manager's dirty limits are resumed, so that e.g. a
+    // streaming-driven surge is charged to streaming rather than to whatever
+    // foreground task relieved the pressure.
+    dirty_memory_manager(database& db, size_t threshold, double soft_limit,
+            seastar::scheduling_group deferred_work_sg = seastar::default_scheduling_group())
         : logalloc::region_group_reclaimer(threshold / 2, threshold * soft_limit / 2)
         , _real_dirty_reclaimer(threshold)
         , _db(&db)
-        , _real_region_group(_real_dirty_reclaimer)
-        , _virtual_region_group(&_real_region_group, *this)
+        , _real_region_group(_real_dirty_reclaimer, deferred_work_sg)
+        , _virtual_region_group(&_real_region_group, *this, deferred_work_sg)
         , _flush_serializer(1)
         , _waiting_flush(flush_when_needed()) {}
 
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <sys/stat.h>
+
+#include "disk_device_tracker.hh"
+#include "log.hh"
+#include <seastar/core/metrics.hh>
+
+static logging::logger devlog("disk_device_tracker");
+
+disk_device_tracker& disk_device_tracker::local() {
+    static thread_local disk_device_tracker tracker;
+    return tracker;
+}
+
+static const seastar::metrics::label device_label("device");
+
+disk_device_tracker::device_id disk_device_tracker::register_directory(const sstring& path) {
+    auto it = _by_path.find(path);
+    if (it != _by_path.end()) {
+        return it->second;
+    }
+    // One blocking syscall per distinct directory per shard; table creation
+    // already stats and opens files on this path.
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        devlog.warn("Could not stat {}: {}; I/O on it will not be attributed to a device", path, strerror(errno));
+        _by_path.emplace(path, no_device);
+        return no_device;
+    }
+    auto dit = _by_dev.find(st.st_dev);
+    if (dit != _by_dev.end()) {
+        _by_path.emplace(path, dit->second);
+        return dit->second;
+    }
+    auto id = device_id(_devices.size());
+    _devices.push_back(std::make_unique<device_stats>());
+    auto& ds = *_devices.back();
+    ds.path = path;
+    _by_dev.emplace(st.st_dev, id);
+    _by_path.emplace(path, id);
+
+    namespace sm = seastar::metrics;
+    auto label = device_label(path);
+    _metrics.add_group("disk_device", {
+        sm::make_derive("reads", ds.reads,
+                sm::description("Number of sstable read requests completed on this device"), {label}),
+        sm::make_derive("writes", ds.writes,
+                sm::description("Number of sstable write requests completed on this device"), {label}),
+        sm::make_derive("read_errors", ds.read_errors,
+                sm::description("Number of sstable read requests that failed on this device"), {label}),
+        sm::make_derive("write_errors", ds.write_errors,
+                sm::description("Number of sstable write requests that failed on this device"), {label}),
+        sm::make_gauge("read_latency_ewma_us", [&ds] { return ds.read_latency_ewma_us; },
+                sm::description("Moving average of sstable read latency on this device, in microseconds"), {label}),
+        sm::make_gauge("slow", [this, id] { return is_slow(id) ? 1 : 0; },
+                sm::description("Whether this device's recent read latency is an outlier among the node's devices"), {label}),
+    });
+    return id;
+}
+
+void disk_device_tracker::account_read_finish(device_stats& ds, std::chrono::steady_clock::time_point start) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    ds.reads++;
+    ds.read_latency.add(us);
+    ds.read_latency_ewma_us += ewma_alpha * (us - ds.read_latency_ewma_us);
+}
+
+bool disk_device_tracker::is_slow(device_id id) const {
+    if (id == no_device || _devices.size() < 2) {
+        return false;
+    }
+    auto& ds = *_devices[id];
+    if (ds.reads < slow_min_reads || ds.read_latency_ewma_us < slow_floor_us) {
+        return false;
+    }
+    // Compare against the fastest device with comparable traffic. Using the
+    // minimum rather than the median keeps this meaningful on two-disk nodes.
+    auto best = ds.read_latency_ewma_us;
+    for (auto& d : _devices) {
+        if (d.get() != &ds && d->reads >= slow_min_reads) {
+            best = std::min(best, d->read_latency_ewma_us);
+        }
+    }
+    return ds.read_latency_ewma_us > best * slow_ratio;
+}
+
+std::vector<disk_device_tracker::device_stats> disk_device_tracker::snapshot() const {
+    std::vector<device_stats> res;
+    res.reserve(_devices.size());
+    for (auto& d : _devices) {
+        res.push_back(*d);
+    }
+    return res;
+}
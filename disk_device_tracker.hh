@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "core/future.hh"
+#include <seastar/core/metrics_registration.hh>
+#include "utils/estimated_histogram.hh"
+#include "seastarx.hh"
+
+// Per-shard accounting of sstable I/O broken down by the device the file
+// lives on, fed by the checked file wrappers (checked-file-impl.hh). On
+// JBOD-style nodes with one data directory per disk this separates a single
+// failing or slow device from the rest: errors and latency are attributed
+// to the device they came from instead of one node-wide pool, so operators
+// (and the metrics) can tell a one-disk brownout from a node-wide problem.
+//
+// Devices are keyed by st_dev of the directory the sstable lives in, so
+// directories on the same filesystem share one entry regardless of how many
+// tables they hold.
+class disk_device_tracker {
+public:
+    using device_id = unsigned;
+    static constexpr device_id no_device = device_id(-1);
+
+    struct device_stats {
+        // First directory seen on this device; stands in for a device name.
+        sstring path;
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t read_errors = 0;
+        uint64_t write_errors = 0;
+        // Exponentially-weighted moving average of read latency, in
+        // microseconds. Recency-weighted so a device going bad shows up
+        // within a few thousand requests regardless of uptime.
+        double read_latency_ewma_us = 0;
+        utils::estimated_histogram read_latency; // microseconds
+    };
+private:
+    // Decay factor for read_latency_ewma_us.
+    static constexpr double ewma_alpha = 1.0 / 64;
+    // Devices with fewer reads than this are never flagged slow.
+    static constexpr uint64_t slow_min_reads = 1024;
+    // ...nor are devices whose EWMA is below this, so an idle NVMe drive
+    // doesn't make a healthy HDD look like an outlier.
+    static constexpr double slow_floor_us = 2000;
+    // A device is slow when its EWMA exceeds the best qualifying device's
+    // by this factor.
+    static constexpr double slow_ratio = 2.0;
+
+    // unique_ptr so metrics lambdas can hold stable references.
+    std::vector<std::unique_ptr<device_stats>> _devices;
+    std::unordered_map<sstring, device_id> _by_path;
+    std::unordered_map<unsigned long, device_id> _by_dev;
+    seastar::metrics::metric_groups _metrics;
+private:
+    void account_read_finish(device_stats& ds, std::chrono::steady_clock::time_point start);
+public:
+    // Maps a directory to the device its filesystem lives on, registering
+    // the device (and its metrics) on first sight. Stats the directory the
+    // first time a given path is seen; subsequent calls are map lookups.
+    device_id register_directory(const sstring& path);
+
+    // Accounts one read from `id`, spanning the future returned by `func`.
+    // Pass-through when id == no_device.
+    template <typename Func>
+    auto account_read(device_id id, Func&& func) {
+        if (id == no_device) {
+            return futurize<std::result_of_t<Func()>>::apply(std::forward<Func>(func));
+        }
+        auto& ds = *_devices[id];
+        auto start = std::chrono::steady_clock::now();
+        return func().then_wrapped([this, &ds, start] (auto f) {
+            if (f.failed()) {
+                ds.read_errors++;
+            } else {
+                this->account_read_finish(ds, start);
+            }
+            return std::move(f);
+        });
+    }
+
+    // Accounts one write to `id`, spanning the future returned by `func`.
+    // Pass-through when id == no_device.
+    template <typename Func>
+    auto account_write(device_id id, Func&& func) {
+        if (id == no_device) {
+            return futurize<std::result_of_t<Func()>>::apply(std::forward<Func>(func));
+        }
+        auto& ds = *_devices[id];
+        return func().then_wrapped([&ds] (auto f) {
+            if (f.failed()) {
+                ds.write_errors++;
+            } else {
+                ds.writes++;
+            }
+            return std::move(f);
+        });
+    }
+
+    // Whether this device's recent read latency is an outlier compared to
+    // the other devices on this shard. Requires at least two devices with
+    // traffic; a node with one data disk has nothing to compare against.
+    bool is_slow(device_id id) const;
+
+    // Copies of the stats of every device seen by this shard so far.
+    std::vector<device_stats> snapshot() const;
+
+    static disk_device_tracker& local();
+};
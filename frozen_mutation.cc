@@ -67,9 +67,17 @@ frozen_mutation::key(const schema& s) const {
     return _pk;
 }
 
+dht::token
+frozen_mutation::token(const schema& s) const {
+    if (!_token) {
+        _token = dht::global_partitioner().get_token(s, key(s));
+    }
+    return *_token;
+}
+
 dht::decorated_key
 frozen_mutation::decorated_key(const schema& s) const {
-    return dht::global_partitioner().decorate_key(s, key(s));
+    return dht::decorated_key{token(s), _pk};
 }
 
 partition_key frozen_mutation::deserialize_key() const {
@@ -92,6 +100,7 @@ frozen_mutation::frozen_mutation(bytes_ostream&& b, partition_key pk)
 
 frozen_mutation::frozen_mutation(const mutation& m)
     : _pk(m.key())
+    , _token(m.token())
 {
     mutation_partition_serializer part_ser(*m.schema(), m.partition());
 
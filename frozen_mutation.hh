@@ -48,6 +48,11 @@ class frozen_mutation final {
 private:
     bytes_ostream _bytes;
     partition_key _pk;
+    // Token of _pk, computed lazily. Mutations arriving from the network or
+    // read back from the commit log get decorated several times on the way
+    // to the memtable (shard routing, counter locking, view updates), and
+    // hashing the key is the expensive part of that.
+    mutable stdx::optional<dht::token> _token;
 private:
     partition_key deserialize_key() const;
     ser::mutation_view mutation_view() const;
@@ -63,6 +68,7 @@ public:
     utils::UUID column_family_id() const;
     utils::UUID schema_version() const; // FIXME: Should replace column_family_id()
     partition_key_view key(const schema& s) const;
+    dht::token token(const schema& s) const;
     dht::decorated_key decorated_key(const schema& s) const;
     mutation_partition_view partition() const;
     mutation unfreeze(schema_ptr s) const;
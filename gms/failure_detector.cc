@@ -54,6 +54,9 @@ namespace gms {
 static logging::logger logger("failure_detector");
 
 constexpr std::chrono::milliseconds failure_detector::DEFAULT_MAX_PAUSE;
+constexpr double arrival_window::JITTER_SCALE;
+constexpr double arrival_window::MIN_JITTER_FRACTION;
+constexpr int failure_detector::CONVICTION_HYSTERESIS;
 
 using clk = arrival_window::clk;
 
@@ -86,19 +89,37 @@ void arrival_window::add(clk::time_point value, const gms::inet_address& ep) {
         _arrival_intervals.add(get_initial_value().count());
     }
     _tlast = value;
+    _suspicions = 0;
 }
 
 double arrival_window::mean() {
     return _arrival_intervals.mean();
 }
 
+double arrival_window::variance() {
+    return _arrival_intervals.variance();
+}
+
+double arrival_window::stdev() {
+    return std::sqrt(variance());
+}
+
 double arrival_window::phi(clk::time_point tnow) {
     assert(_arrival_intervals.size() > 0 && _tlast > clk::time_point::min()); // should not be called before any samples arrive
     auto t = (tnow - _tlast).count();
     auto m = mean();
-    double phi = t / m;
-    logger.debug("failure_detector: now={}, tlast={}, t={}, mean={}, phi={}",
-        tnow.time_since_epoch().count(), _tlast.time_since_epoch().count(), t, m, phi);
+    // Widen the interval we measure against in proportion to the jitter
+    // observed on this link. On a steady intra-DC link the stdev is small and
+    // this behaves close to the classic t / mean; on a jittery cross-DC link
+    // a heartbeat has to be late by the usual variation on top of the mean
+    // before phi approaches the conviction threshold, so routine latency
+    // spikes no longer flap the endpoint. The floor keeps a window of
+    // perfectly regular arrivals from collapsing the widening to zero.
+    auto floor = MIN_JITTER_FRACTION * m;
+    auto jitter = std::max(stdev(), floor);
+    double phi = t / (m + JITTER_SCALE * jitter);
+    logger.debug("failure_detector: now={}, tlast={}, t={}, mean={}, jitter={}, phi={}",
+        tnow.time_since_epoch().count(), _tlast.time_since_epoch().count(), t, m, jitter, phi);
     return phi;
 }
 
@@ -228,6 +249,13 @@ void failure_detector::interpret(inet_address ep) {
     logger.trace("failure_detector: phi_convict_threshold={}", _phi);
 
     if (PHI_FACTOR * phi > get_phi_convict_threshold()) {
+        // Hysteresis: only convict once phi has stayed above the threshold
+        // for consecutive rounds with no heartbeat in between, so a single
+        // transient spike does not trigger cluster-wide topology reactions.
+        if (hb_wnd.suspect() < CONVICTION_HYSTERESIS) {
+            logger.debug("failure_detector: suspecting ep={} phi={}, waiting for next round before conviction", ep, phi);
+            return;
+        }
         logger.trace("failure_detector: notifying listeners that {} is down", ep);
         logger.trace("failure_detector: intervals: {} mean: {}", hb_wnd, hb_wnd.mean());
         for (auto& listener : _fd_evnt_listeners) {
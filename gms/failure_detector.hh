@@ -69,6 +69,19 @@ private:
     // change.
     static constexpr double PHI_FACTOR{M_LOG10El};
 
+    // Scales how much the observed inter-arrival jitter widens the interval
+    // phi is computed against; see phi().
+    static constexpr double JITTER_SCALE = 2.0;
+
+    // Lower bound on the jitter estimate, as a fraction of the mean interval,
+    // so that a window of perfectly regular arrivals does not collapse the
+    // widening to zero and leave us as spike-sensitive as before.
+    static constexpr double MIN_JITTER_FRACTION = 0.1;
+
+    // Number of consecutive interpret rounds in which phi exceeded the
+    // conviction threshold without a heartbeat arriving in between.
+    int _suspicions = 0;
+
 public:
     arrival_window(int size)
         : _arrival_intervals(size) {
@@ -84,9 +97,19 @@ public:
 
     double mean();
 
+    double variance();
+
+    // Standard deviation of the inter-arrival intervals, i.e. the jitter of
+    // the link to this endpoint.
+    double stdev();
+
     // see CASSANDRA-2597 for an explanation of the math at work here.
     double phi(clk::time_point tnow);
 
+    // Called when phi exceeds the conviction threshold; returns how many
+    // consecutive rounds it has done so. Reset by the next heartbeat.
+    int suspect() { return ++_suspicions; }
+
     size_t size() { return _arrival_intervals.size(); }
 
     friend std::ostream& operator<<(std::ostream& os, const arrival_window& w);
@@ -108,6 +131,12 @@ private:
     // change.
     static constexpr double PHI_FACTOR{M_LOG10El};
 
+    // How many consecutive interpret rounds phi has to stay above the
+    // conviction threshold before listeners are notified. Convicting a node
+    // triggers expensive topology reactions, so a single late heartbeat
+    // should not be enough.
+    static constexpr int CONVICTION_HYSTERESIS = 2;
+
     std::map<inet_address, arrival_window> _arrival_samples;
     std::list<i_failure_detection_event_listener*> _fd_evnt_listeners;
     double _phi = 8;
@@ -155,6 +184,18 @@ public:
         return _arrival_samples;
     }
 
+    // Mean inter-arrival interval of gossip heartbeats from the endpoint, or
+    // infinity when we have no samples yet. We track no direct network
+    // latencies, so this is the best proximity/health signal available: the
+    // lower the mean, the more promptly the peer is heard from.
+    double arrival_mean(inet_address ep) {
+        auto it = _arrival_samples.find(ep);
+        if (it == _arrival_samples.end() || it->second.size() == 0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return it->second.mean();
+    }
+
 private:
     void append_endpoint_state(std::stringstream& ss, const endpoint_state& state);
 
@@ -69,6 +69,9 @@ using clk = gossiper::clk;
 static logging::logger logger("gossip");
 
 constexpr std::chrono::milliseconds gossiper::INTERVAL;
+constexpr std::chrono::milliseconds gossiper::QUIET_INTERVAL;
+constexpr std::chrono::minutes gossiper::QUIET_CLUSTER_THRESHOLD;
+constexpr uint64_t gossiper::FULL_DIGEST_ROUND_PERIOD;
 constexpr std::chrono::hours gossiper::A_VERY_LONG_TIME;
 constexpr int64_t gossiper::MAX_GENERATION_DIFFERENCE;
 
@@ -286,6 +289,10 @@ future<> gossiper::handle_ack_msg(msg_addr id, gossip_digest_ack ack_msg) {
             }
         }
         gms::gossip_digest_ack2 ack2_msg(std::move(delta_ep_state_map));
+        // Once the peer gets the ack2 it knows our state as of this exchange, so
+        // remember what it has seen and trim it from future syn messages. If the
+        // ack2 is lost, the periodic full digest round repairs the divergence.
+        this->record_acked_digests(id.addr);
         logger.trace("Sending a GossipDigestACK2 to {}", id);
         return this->ms().send_gossip_digest_ack2(id, std::move(ack2_msg)).handle_exception([id] (auto ep) {
             logger.warn("Fail to send GossipDigestACK2 to {}: {}", id, ep);
@@ -464,6 +471,31 @@ future<> gossiper::apply_state_locally(std::map<inet_address, endpoint_state> ma
                 logger.trace("Ignoring gossip for {} because it is quarantined", ep);
                 return make_ready_future<>();
             }
+            // Fast path: during heavy gossip traffic most of the incoming
+            // states carry nothing newer than what we already have. Discard
+            // those synchronously, before allocating a thread and taking the
+            // endpoint lock, so that flapping endpoints do not convoy behind
+            // each other. The decision is re-checked under the lock below,
+            // since the local state may change until we acquire it.
+            if (!this->is_in_shadow_round()) {
+                auto es = this->get_endpoint_state_for_endpoint_ptr(ep);
+                if (es) {
+                    const endpoint_state& remote_state = map[ep];
+                    int local_generation = es->get_heart_beat_state().get_generation();
+                    int remote_generation = remote_state.get_heart_beat_state().get_generation();
+                    if (remote_generation < local_generation) {
+                        logger.trace("Ignoring remote generation {} < {}", remote_generation, local_generation);
+                        return make_ready_future<>();
+                    }
+                    if (remote_generation == local_generation
+                            && this->get_max_endpoint_state_version(remote_state) <= this->get_max_endpoint_state_version(*es)
+                            && (es->is_alive() || this->is_dead_state(*es))) {
+                        logger.trace("Ignoring remote version {} <= {} for {}",
+                            this->get_max_endpoint_state_version(remote_state), this->get_max_endpoint_state_version(*es), ep);
+                        return make_ready_future<>();
+                    }
+                }
+            }
           return seastar::with_semaphore(_apply_state_locally_semaphore, 1, [this, &ep, &map] () mutable {
             return seastar::async([this, &ep, &map] () mutable {
                 /*
@@ -649,8 +681,18 @@ void gossiper::run() {
                     }
                 }
                 logger.debug("Talk to {} live nodes: {}", nr_live_nodes, live_nodes);
+                // Every FULL_DIGEST_ROUND_PERIOD rounds the complete digest list is
+                // sent for anti-entropy. In between, digests a peer already acked
+                // are trimmed, so endpoints whose state did not advance since we
+                // last exchanged gossip with that peer are not re-sent.
+                bool full_digests = (_nr_run % FULL_DIGEST_ROUND_PERIOD) == 0;
                 for (auto& ep: live_nodes) {
-                    do_gossip_to_live_member(message, ep).handle_exception([] (auto ep) {
+                    auto digests = full_digests ? g_digests : trim_digests_for_peer(ep, g_digests);
+                    if (digests.empty()) {
+                        continue;
+                    }
+                    gossip_digest_syn syn(get_cluster_name(), get_partitioner_name(), std::move(digests));
+                    do_gossip_to_live_member(std::move(syn), ep).handle_exception([] (auto ep) {
                         logger.trace("Failed to do_gossip_to_live_member: {}", ep);
                     });
                 }
@@ -706,7 +748,16 @@ void gossiper::run() {
                     _shadow_unreachable_endpoints = _unreachable_endpoints;
                 }
 
-                _the_gossiper.invoke_on_all([this, live_endpoint_changed, unreachable_endpoint_changed, es = endpoint_state_map] (gossiper& local_gossiper) {
+                // Other shards only consume the liveness bit of each state,
+                // so ship a snapshot of just that instead of copying the full
+                // endpoint_state map (with all its versioned application
+                // states) once per shard inside the timer callback.
+                std::unordered_map<inet_address, bool> alive_map;
+                alive_map.reserve(endpoint_state_map.size());
+                for (auto& e : endpoint_state_map) {
+                    alive_map.emplace(e.first, e.second.is_alive());
+                }
+                _the_gossiper.invoke_on_all([this, live_endpoint_changed, unreachable_endpoint_changed, alive_map = std::move(alive_map)] (gossiper& local_gossiper) {
                     // Don't copy gossiper(CPU0) maps into themselves!
                     if (engine().cpu_id() != 0) {
                         if (live_endpoint_changed) {
@@ -717,8 +768,8 @@ void gossiper::run() {
                             local_gossiper._unreachable_endpoints = _shadow_unreachable_endpoints;
                         }
 
-                        for (auto&& e : es) {
-                            local_gossiper.endpoint_state_map[e.first].set_alive(e.second.is_alive());
+                        for (auto&& e : alive_map) {
+                            local_gossiper.endpoint_state_map[e.first].set_alive(e.second);
                         }
                     }
                 }).get();
@@ -739,7 +790,13 @@ void gossiper::run() {
             }
         }
         if (_enabled) {
-            _scheduled_gossip_task.arm(INTERVAL);
+            // Gossip less often when nothing but heartbeats has been flowing
+            // for a while. Any real state change resets the interval at once.
+            auto interval = INTERVAL;
+            if (now() - _last_cluster_activity > QUIET_CLUSTER_THRESHOLD) {
+                interval = QUIET_INTERVAL;
+            }
+            _scheduled_gossip_task.arm(interval);
         }
         this->timer_callback_unlock();
     });
@@ -842,7 +899,7 @@ std::set<inet_address> gossiper::get_unreachable_members() {
     return ret;
 }
 
-int gossiper::get_max_endpoint_state_version(endpoint_state state) {
+int gossiper::get_max_endpoint_state_version(const endpoint_state& state) const {
     int max_version = state.get_heart_beat_state().get_heart_beat_version();
     for (auto& entry : state.get_application_state_map()) {
         auto& value = entry.second;
@@ -853,7 +910,9 @@ int gossiper::get_max_endpoint_state_version(endpoint_state state) {
 
 // Runs inside seastar::async context
 void gossiper::evict_from_membership(inet_address endpoint) {
+    note_cluster_activity();
     _unreachable_endpoints.erase(endpoint);
+    _digests_acked_by_peer.erase(endpoint);
     container().invoke_on_all([endpoint] (auto& g) {
         g.endpoint_state_map.erase(endpoint);
     }).get();
@@ -916,6 +975,37 @@ void gossiper::make_random_gossip_digest(std::vector<gossip_digest>& g_digests)
 #endif
 }
 
+void gossiper::note_cluster_activity() {
+    _last_cluster_activity = now();
+}
+
+void gossiper::record_acked_digests(inet_address peer) {
+    auto& acked = _digests_acked_by_peer[peer];
+    acked.clear();
+    for (auto& x : endpoint_state_map) {
+        acked[x.first] = std::make_pair(x.second.get_heart_beat_state().get_generation(),
+                                        get_max_endpoint_state_version(x.second));
+    }
+}
+
+std::vector<gossip_digest> gossiper::trim_digests_for_peer(inet_address peer, const std::vector<gossip_digest>& digests) const {
+    auto it = _digests_acked_by_peer.find(peer);
+    if (it == _digests_acked_by_peer.end()) {
+        return digests;
+    }
+    auto& acked = it->second;
+    std::vector<gossip_digest> ret;
+    ret.reserve(digests.size());
+    for (auto& d : digests) {
+        auto a = acked.find(d.get_endpoint());
+        if (a == acked.end() || d.get_generation() > a->second.first ||
+                (d.get_generation() == a->second.first && d.get_max_version() > a->second.second)) {
+            ret.push_back(d);
+        }
+    }
+    return ret;
+}
+
 future<> gossiper::replicate(inet_address ep, const endpoint_state& es) {
     return container().invoke_on_all([ep, es, orig = engine().cpu_id(), self = shared_from_this()] (gossiper& g) {
         if (engine().cpu_id() != orig) {
@@ -1287,6 +1377,7 @@ void gossiper::mark_alive(inet_address addr, endpoint_state& local_state) {
 // Runs inside seastar::async context
 void gossiper::real_mark_alive(inet_address addr, endpoint_state& local_state) {
     logger.trace("marking as alive {}", addr);
+    note_cluster_activity();
     local_state.mark_alive();
     local_state.update_timestamp(); // prevents do_status_check from racing us and evicting if it was down > A_VERY_LONG_TIME
     auto it_ = std::find(_live_endpoints.begin(), _live_endpoints.end(), addr);
@@ -1313,6 +1404,7 @@ void gossiper::real_mark_alive(inet_address addr, endpoint_state& local_state) {
 // Runs inside seastar::async context
 void gossiper::mark_dead(inet_address addr, endpoint_state& local_state) {
     logger.trace("marking as down {}", addr);
+    note_cluster_activity();
     local_state.mark_dead();
     _live_endpoints.erase(std::remove(_live_endpoints.begin(), _live_endpoints.end(), addr), _live_endpoints.end());
     _live_endpoints_just_added.remove(addr);
@@ -1326,6 +1418,7 @@ void gossiper::mark_dead(inet_address addr, endpoint_state& local_state) {
 
 // Runs inside seastar::async context
 void gossiper::handle_major_state_change(inet_address ep, const endpoint_state& eps) {
+    note_cluster_activity();
     auto eps_old = get_endpoint_state_for_endpoint(ep);
     if (!is_dead_state(eps) && !_in_shadow_round) {
         if (endpoint_state_map.count(ep))  {
@@ -1454,6 +1547,11 @@ void gossiper::apply_new_states(inet_address addr, endpoint_state& local_state,
             local_state.add_application_state(remote_key, remote_value);
         }
     }
+
+    if (!changed.empty()) {
+        // Heartbeat-only updates don't count as cluster activity.
+        note_cluster_activity();
+    }
 }
 
 // Runs inside seastar::async context
@@ -1698,6 +1796,7 @@ future<> gossiper::add_local_application_state(std::vector<std::pair<application
     return container().invoke_on(0, [states = std::move(states)] (gossiper& gossiper) mutable {
         return seastar::async([g = gossiper.shared_from_this(), states = std::move(states)]() mutable {
             auto& gossiper = *g;
+            gossiper.note_cluster_activity();
             inet_address ep_addr = gossiper.get_broadcast_address();
             // for symmetry with other apply, use endpoint lock for our own address.
             auto permit = gossiper.lock_endpoint(ep_addr).get0();
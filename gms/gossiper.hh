@@ -148,6 +148,14 @@ public:
         versioned_value::STATUS_BOOTSTRAPPING,
     };
     static constexpr std::chrono::milliseconds INTERVAL{1000};
+    /* round interval used instead of INTERVAL once the cluster has been quiet
+     * (nothing but heartbeat updates) for QUIET_CLUSTER_THRESHOLD. The failure
+     * detector is adaptive and learns the longer heartbeat inter-arrival times. */
+    static constexpr std::chrono::milliseconds QUIET_INTERVAL{2000};
+    static constexpr std::chrono::minutes QUIET_CLUSTER_THRESHOLD{5};
+    /* every that many rounds the complete digest list is gossiped regardless of
+     * what peers have already acked, bounding divergence of the acked-digest cache */
+    static constexpr uint64_t FULL_DIGEST_ROUND_PERIOD = 16;
     static constexpr std::chrono::hours A_VERY_LONG_TIME{24 * 3};
 
     /** Maximimum difference in generation and version values we are willing to accept about a peer */
@@ -223,6 +231,18 @@ private:
     std::unordered_map<inet_address, clk::time_point> _shadow_unreachable_endpoints;
     std::vector<inet_address> _shadow_live_endpoints;
 
+    /* last time something other than a heartbeat changed, used to stretch the
+     * gossip round interval when the cluster is quiescent */
+    clk::time_point _last_cluster_activity = now();
+
+    /* (generation, max version) of each endpoint as last acked by a given peer.
+     * Digests a peer has already acked are trimmed from syn messages sent to it. */
+    std::unordered_map<inet_address, std::unordered_map<inet_address, std::pair<int32_t, int32_t>>> _digests_acked_by_peer;
+
+    void note_cluster_activity();
+    void record_acked_digests(inet_address peer);
+    std::vector<gossip_digest> trim_digests_for_peer(inet_address peer, const std::vector<gossip_digest>& digests) const;
+
     void run();
     // Replicates given endpoint_state to all other shards.
     // The state state doesn't have to be kept alive around until completes.
@@ -285,7 +305,7 @@ public:
      * @param ep_state
      * @return
      */
-    int get_max_endpoint_state_version(endpoint_state state);
+    int get_max_endpoint_state_version(const endpoint_state& state) const;
 
 
 private:
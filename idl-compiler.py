@@ -37,7 +37,6 @@ READ_BUFF = 'input_buffer'
 WRITE_BUFF = 'output_buffer'
 SERIALIZER = 'serialize'
 DESERIALIZER = 'deserialize'
-SETSIZE = 'set_size'
 SIZETYPE = 'size_type'
 
 parser = argparse.ArgumentParser(description="""Generate serializer helper function""")
@@ -885,12 +884,17 @@ $template
 template <typename Output>
 void serializer<$name>::write(Output& buf, const $name& obj) {""").substitute({'func' : SERIALIZER, 'name' : full_name, 'template': template}))
     if not is_final:
-        fprintln(cout, Template("""  $set_size(buf, obj);""").substitute({'func' : SERIALIZER, 'set_size' : SETSIZE, 'name' : name, 'sizetype' : SIZETYPE}))
+        # The frame either writes the size up front (generic outputs, via a
+        # measuring pass) or reserves a placeholder which frame.end()
+        # backpatches, depending on the output type.
+        fprintln(cout, """  auto frame = start_frame(buf, obj);""")
     for param in cls["members"]:
         if is_class(param) or is_enum(param):
             continue
         fprintln(cout, Template("""  static_assert(is_equivalent<decltype(obj.$var), $type>::value, "member value has a wrong type");
     $func(buf, obj.$var);""").substitute({'func' : SERIALIZER, 'var' : param["name"], 'type' : param_type(param["type"])}))
+    if not is_final:
+        fprintln(cout, """  frame.end(buf);""")
     fprintln(cout, "}")
 
     fprintln(cout, Template("""
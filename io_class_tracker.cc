@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "io_class_tracker.hh"
+#include "core/print.hh"
+#include <seastar/core/metrics.hh>
+
+io_class_tracker& io_class_tracker::local() {
+    static thread_local io_class_tracker tracker;
+    return tracker;
+}
+
+static const seastar::metrics::label class_label("class");
+
+io_class_tracker::class_stats& io_class_tracker::stats_for(const io_priority_class& pc) {
+    auto it = _classes.find(pc.id());
+    if (it == _classes.end()) {
+        it = _classes.emplace(pc.id(), class_stats{}).first;
+        it->second.name = sprint("class-%d", pc.id());
+    }
+    return it->second;
+}
+
+void io_class_tracker::account_finish(class_stats& cs, op_type type, uint64_t bytes, std::chrono::steady_clock::time_point start) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    cs.queue_depth--;
+    cs.bytes_in_flight -= bytes;
+    cs.disk_time_us += us;
+    if (type == op_type::read) {
+        cs.reads++;
+        cs.read_bytes += bytes;
+        cs.read_latency.add(us);
+    } else {
+        cs.writes++;
+        cs.write_bytes += bytes;
+        cs.write_latency.add(us);
+    }
+}
+
+void io_class_tracker::register_class(const io_priority_class& pc, sstring name) {
+    auto& cs = stats_for(pc);
+    if (cs.name == name) {
+        return; // already registered
+    }
+    cs.name = name;
+    namespace sm = seastar::metrics;
+    auto label = class_label(name);
+    _metrics.add_group("io_class", {
+        sm::make_derive("reads", cs.reads,
+                sm::description("Number of read requests completed by this I/O class"), {label}),
+        sm::make_derive("writes", cs.writes,
+                sm::description("Number of write requests completed by this I/O class"), {label}),
+        sm::make_derive("read_bytes", cs.read_bytes,
+                sm::description("Number of bytes read by this I/O class"), {label}),
+        sm::make_derive("write_bytes", cs.write_bytes,
+                sm::description("Number of bytes written by this I/O class"), {label}),
+        sm::make_gauge("queue_depth", [&cs] { return cs.queue_depth; },
+                sm::description("Requests issued by this I/O class and not yet completed"), {label}),
+        sm::make_gauge("bytes_in_flight", [&cs] { return cs.bytes_in_flight; },
+                sm::description("Bytes issued by this I/O class and not yet completed"), {label}),
+        sm::make_derive("disk_time_us", cs.disk_time_us,
+                sm::description("Total time requests of this I/O class spent queued and on the device, in microseconds"), {label}),
+    });
+}
+
+std::vector<io_class_tracker::class_stats> io_class_tracker::snapshot() const {
+    std::vector<class_stats> res;
+    res.reserve(_classes.size());
+    for (auto& e : _classes) {
+        res.push_back(e.second);
+    }
+    return res;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+#include "core/future.hh"
+#include "core/reactor.hh"
+#include <seastar/core/metrics_registration.hh>
+#include "utils/estimated_histogram.hh"
+#include "seastarx.hh"
+
+// Per-shard accounting of disk I/O broken down by io_priority_class, fed by
+// the checked file wrappers (checked-file-impl.hh). Attributes device time to
+// the class that issued each request - compaction vs. query vs. commitlog -
+// and feeds both the metrics API (io_class group) and the /io_diagnostics
+// REST endpoint.
+class io_class_tracker {
+public:
+    enum class op_type { read, write };
+
+    struct class_stats {
+        sstring name;
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t read_bytes = 0;
+        uint64_t write_bytes = 0;
+        // Requests issued and not yet completed.
+        uint64_t queue_depth = 0;
+        uint64_t bytes_in_flight = 0;
+        // Sum of request completion latencies, in microseconds. Queueing
+        // delay counts towards the class which caused it, so ranking classes
+        // by this number attributes device saturation.
+        uint64_t disk_time_us = 0;
+        utils::estimated_histogram read_latency;   // microseconds
+        utils::estimated_histogram write_latency;  // microseconds
+    };
+private:
+    std::unordered_map<unsigned, class_stats> _classes;
+    seastar::metrics::metric_groups _metrics;
+private:
+    class_stats& stats_for(const io_priority_class& pc);
+    void account_finish(class_stats& cs, op_type type, uint64_t bytes, std::chrono::steady_clock::time_point start);
+public:
+    // Gives a priority class a stable name and exports its counters through
+    // the metrics API. Classes never registered are still tracked and show
+    // up in /io_diagnostics as "class-<id>".
+    void register_class(const io_priority_class& pc, sstring name);
+
+    // Accounts one read or write of `bytes` issued under `pc`, spanning the
+    // future returned by `func`.
+    template <typename Func>
+    auto account(const io_priority_class& pc, op_type type, uint64_t bytes, Func&& func) {
+        auto& cs = stats_for(pc);
+        cs.queue_depth++;
+        cs.bytes_in_flight += bytes;
+        auto start = std::chrono::steady_clock::now();
+        return func().then_wrapped([this, &cs, type, bytes, start] (auto f) {
+            account_finish(cs, type, bytes, start);
+            return std::move(f);
+        });
+    }
+
+    // Copies of the stats of every class seen by this shard so far.
+    std::vector<class_stats> snapshot() const;
+
+    static io_class_tracker& local();
+};
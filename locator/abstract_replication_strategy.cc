@@ -74,19 +74,16 @@ void abstract_replication_strategy::validate_replication_strategy(const sstring&
 }
 
 std::vector<inet_address> abstract_replication_strategy::get_natural_endpoints(const token& search_token) {
-    const token& key_token = _token_metadata.first_token(search_token);
     auto& cached_endpoints = get_cached_endpoints();
-    auto res = cached_endpoints.find(key_token);
+    auto& entry = cached_endpoints[_token_metadata.first_token_index(search_token)];
 
-    if (res == cached_endpoints.end()) {
-        auto endpoints = calculate_natural_endpoints(search_token, _token_metadata);
-        cached_endpoints.emplace(key_token, endpoints);
-
-        return std::move(endpoints);
+    if (!entry) {
+        entry = calculate_natural_endpoints(search_token, _token_metadata);
+        return *entry;
     }
 
     ++_cache_hits_count;
-    return res->second;
+    return *entry;
 }
 
 void abstract_replication_strategy::validate_replication_factor(sstring rf) const
@@ -102,12 +99,15 @@ void abstract_replication_strategy::validate_replication_factor(sstring rf) cons
     }
 }
 
-inline std::unordered_map<token, std::vector<inet_address>>&
+inline std::vector<std::experimental::optional<std::vector<inet_address>>>&
 abstract_replication_strategy::get_cached_endpoints() {
     if (_last_invalidated_ring_version != _token_metadata.get_ring_version()) {
         _cached_endpoints.clear();
         _last_invalidated_ring_version = _token_metadata.get_ring_version();
     }
+    // Cheap no-op when already sized; keeps us parallel to sorted_tokens()
+    // so first_token_index() is always a valid index into the cache.
+    _cached_endpoints.resize(_token_metadata.sorted_tokens().size());
 
     return _cached_endpoints;
 }
@@ -47,12 +47,17 @@ enum class replication_strategy_type {
 class abstract_replication_strategy {
 private:
     long _last_invalidated_ring_version = 0;
-    std::unordered_map<token, std::vector<inet_address>> _cached_endpoints;
+    // Flat endpoint cache, parallel to token_metadata::sorted_tokens().
+    // Entries are computed lazily and the whole array is dropped when the
+    // ring version changes. Endpoint resolution is thus a single binary
+    // search over the sorted ring plus an array index, instead of a hash
+    // map lookup keyed by token bytes.
+    std::vector<std::experimental::optional<std::vector<inet_address>>> _cached_endpoints;
     uint64_t _cache_hits_count = 0;
 
     static logging::logger logger;
 
-    std::unordered_map<token, std::vector<inet_address>>&
+    std::vector<std::experimental::optional<std::vector<inet_address>>>&
     get_cached_endpoints();
 protected:
     sstring _ks_name;
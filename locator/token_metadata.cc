@@ -49,7 +49,7 @@ static void remove_by_value(C& container, V value) {
 
 token_metadata::token_metadata(std::unordered_map<token, inet_address> token_to_endpoint_map, std::unordered_map<inet_address, utils::UUID> endpoints_map, topology topology) :
     _token_to_endpoint_map(token_to_endpoint_map), _endpoint_to_host_id_map(endpoints_map), _topology(topology) {
-    _sorted_tokens = sort_tokens();
+    update_sorted_tokens();
 }
 
 std::vector<token> token_metadata::sort_tokens() {
@@ -65,6 +65,36 @@ std::vector<token> token_metadata::sort_tokens() {
     return sorted;
 }
 
+void token_metadata::update_sorted_tokens() {
+    _sorted_tokens = sort_tokens();
+    auto n = _sorted_tokens.size();
+    _token_prefixes.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        _token_prefixes[i] = dht::token_comparison_prefix(_sorted_tokens[i]);
+    }
+    // About one bucket per token keeps the scanned runs down to a couple
+    // of cache lines; cap the table size so it stays negligible next to
+    // the tokens themselves even on very large rings.
+    unsigned bits = 1;
+    while ((size_t(1) << bits) < n && bits < 20) {
+        ++bits;
+    }
+    auto buckets = size_t(1) << bits;
+    _bucket_shift = 64 - bits;
+    // _bucket_start[b] is the first index whose prefix falls into bucket b
+    // or a later one, so [_bucket_start[b], _bucket_start[b + 1]) covers
+    // exactly the tokens of bucket b.
+    _bucket_start.assign(buckets + 1, n);
+    _bucket_start[0] = 0;
+    size_t prev = 0;
+    for (size_t i = 0; i < n; ++i) {
+        auto b = _token_prefixes[i] >> _bucket_shift;
+        while (prev < b) {
+            _bucket_start[++prev] = i;
+        }
+    }
+}
+
 const std::vector<token>& token_metadata::sorted_tokens() const {
     return _sorted_tokens;
 }
@@ -143,7 +173,7 @@ void token_metadata::update_normal_tokens(std::unordered_map<inet_address, std::
     }
 
     if (should_sort_tokens) {
-        _sorted_tokens = sort_tokens();
+        update_sorted_tokens();
     }
 }
 
@@ -153,12 +183,27 @@ size_t token_metadata::first_token_index(const token& start) const {
         tlogger.error("{}", msg);
         throw std::runtime_error(msg);
     }
-    auto it = std::lower_bound(_sorted_tokens.begin(), _sorted_tokens.end(), start);
-    if (it == _sorted_tokens.end()) {
+    auto p = dht::token_comparison_prefix(start);
+    auto b = p >> _bucket_shift;
+    size_t i = _bucket_start[b];
+    size_t e = _bucket_start[b + 1];
+    // Tokens before the bucket have a smaller prefix and so compare below
+    // start; tokens after it compare above. The run itself is a flat array
+    // of integers, so this reads a couple of sequential cache lines where
+    // the old binary search took O(log n) dependent misses.
+    while (i < e && _token_prefixes[i] < p) {
+        ++i;
+    }
+    // Tokens sharing start's full 64-bit prefix have to be resolved with a
+    // real comparison; for murmur3 the prefix is the whole token, so the
+    // run is empty or a single exact match.
+    auto run_end = std::upper_bound(_token_prefixes.begin() + i, _token_prefixes.begin() + e, p) - _token_prefixes.begin();
+    auto it = std::lower_bound(_sorted_tokens.begin() + i, _sorted_tokens.begin() + run_end, start);
+    auto idx = size_t(std::distance(_sorted_tokens.begin(), it));
+    if (idx == _sorted_tokens.size()) {
         return 0;
-    } else {
-        return std::distance(_sorted_tokens.begin(), it);
     }
+    return idx;
 }
 
 const token& token_metadata::first_token(const token& start) const {
@@ -319,7 +364,7 @@ void token_metadata::remove_endpoint(inet_address endpoint) {
     _topology.remove_endpoint(endpoint);
     _leaving_endpoints.erase(endpoint);
     _endpoint_to_host_id_map.erase(endpoint);
-    _sorted_tokens = sort_tokens();
+    update_sorted_tokens();
     invalidate_cached_rings();
 }
 
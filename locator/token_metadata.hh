@@ -156,11 +156,22 @@ private:
 
     std::vector<token> _sorted_tokens;
 
+    // Two-level lookup index over _sorted_tokens, rebuilt whenever the ring
+    // changes: a radix bucket on the high bits of each token's comparison
+    // prefix (see dht::token_comparison_prefix()) selects a short run of
+    // the flat prefix array, which is then scanned sequentially. This keeps
+    // first_token_index() to a couple of cache lines instead of O(log n)
+    // dependent misses through the token objects.
+    std::vector<uint64_t> _token_prefixes;
+    std::vector<uint32_t> _bucket_start;
+    unsigned _bucket_shift = 63;
+
     topology _topology;
 
     long _ring_version = 0;
 
     std::vector<token> sort_tokens();
+    void update_sorted_tokens();
 
     class tokens_iterator :
             public std::iterator<std::input_iterator_tag, token> {
@@ -35,6 +35,7 @@
 #include "service/load_broadcaster.hh"
 #include "streaming/stream_session.hh"
 #include "db/system_keyspace.hh"
+#include "db/view/view_builder.hh"
 #include "db/batchlog_manager.hh"
 #include "db/commitlog/commitlog.hh"
 #include "db/hints/manager.hh"
@@ -47,6 +48,7 @@
 #include "release.hh"
 #include "repair/repair.hh"
 #include <cstdio>
+#include <csignal>
 #include <core/file.hh>
 #include <sys/time.h>
 #include <sys/resource.h>
@@ -58,6 +60,8 @@
 #include <seastar/core/memory.hh>
 #include <seastar/util/log-cli.hh>
 #include "service/cache_hitrate_calculator.hh"
+#include "service/cache_saver.hh"
+#include "service/workload_group.hh"
 #include "sstables/compaction_manager.hh"
 #include "sstables/sstables.hh"
 
@@ -312,6 +316,8 @@ int main(int ac, char** av) {
 
     distributed<database> db;
     seastar::sharded<service::cache_hitrate_calculator> cf_cache_hitrate_calculator;
+    seastar::sharded<service::cache_saver> cache_saver;
+    seastar::sharded<db::view::view_builder> view_builder;
     debug::db = &db;
     auto& qp = cql3::get_query_processor();
     auto& proxy = service::get_storage_proxy();
@@ -340,9 +346,32 @@ int main(int ac, char** av) {
 
         tcp_syncookies_sanity();
 
-        return seastar::async([cfg, ext, &db, &qp, &proxy, &mm, &ctx, &opts, &dirs, &pctx, &prometheus_server, &return_value, &cf_cache_hitrate_calculator] {
+        return seastar::async([cfg, ext, &db, &qp, &proxy, &mm, &ctx, &opts, &dirs, &pctx, &prometheus_server, &return_value, &cf_cache_hitrate_calculator, &cache_saver] {
             read_config(opts, *cfg).get();
             configurable::init_all(opts, *cfg, *ext).get();
+            // SIGHUP re-reads the configuration file and applies the
+            // live-updatable options. Every shard's database holds its own
+            // copy of the config, so each shard re-applies the file to its
+            // copy locally - readers never see another shard's write.
+            engine().handle_signal(SIGHUP, [cfg, &db] {
+                cfg->reload().then([&db](std::vector<sstring> applied) {
+                    for (auto& name : applied) {
+                        startlog.info("Configuration reload: applied new value of {}", name);
+                    }
+                    if (applied.empty()) {
+                        startlog.info("Configuration reload: no live-updatable changes found");
+                        return make_ready_future<>();
+                    }
+                    if (!db.local_is_initialized()) {
+                        return make_ready_future<>();
+                    }
+                    return db.invoke_on_all([](database& db) {
+                        return db.get_config().reload().discard_result();
+                    });
+                }).handle_exception([](std::exception_ptr ep) {
+                    startlog.error("Configuration reload failed: {}", ep);
+                });
+            });
 
             logging::apply_settings(cfg->logging_settings(opts));
 
@@ -441,20 +470,28 @@ int main(int ac, char** av) {
             if (opts.count("developer-mode")) {
                 smp::invoke_on_all([] { engine().set_strict_dma(false); }).get();
             }
+            // Tracing, the snitch and the API server do not depend on each
+            // other, so bring them up concurrently. Everything past the join
+            // below may consult the snitch (gossip, storage service) or
+            // trace, so they must all be up before we go on.
             supervisor::notify("creating tracing");
-            tracing::tracing::create_tracing("trace_keyspace_helper").get();
+            auto tracing_ready = tracing::tracing::create_tracing("trace_keyspace_helper");
             supervisor::notify("creating snitch");
-            i_endpoint_snitch::create_snitch(cfg->endpoint_snitch()).get();
+            auto snitch_ready = i_endpoint_snitch::create_snitch(cfg->endpoint_snitch());
             // #293 - do not stop anything
             // engine().at_exit([] { return i_endpoint_snitch::stop_snitch(); });
-            supervisor::notify("determining DNS name");
-            auto e = seastar::net::dns::get_host_by_name(api_address).get0();
             supervisor::notify("starting API server");
-            auto ip = e.addr_list.front();
-            ctx.http_server.start("API").get();
-            api::set_server_init(ctx).get();
-            ctx.http_server.listen(ipv4_addr{ip, api_port}).get();
-            startlog.info("Scylla API server listening on {}:{} ...", api_address, api_port);
+            auto api_ready = seastar::net::dns::get_host_by_name(api_address).then([&ctx, api_port] (auto e) {
+                auto ip = e.addr_list.front();
+                return ctx.http_server.start("API").then([&ctx] {
+                    return api::set_server_init(ctx);
+                }).then([&ctx, ip, api_port] {
+                    return ctx.http_server.listen(ipv4_addr{ip, api_port});
+                });
+            }).then([api_address, api_port] {
+                startlog.info("Scylla API server listening on {}:{} ...", api_address, api_port);
+            });
+            when_all_succeed(std::move(tracing_ready), std::move(snitch_ready), std::move(api_ready)).get();
             static sharded<auth::service> auth_service;
             supervisor::notify("initializing storage service");
             init_storage_service(db, auth_service);
@@ -488,27 +525,44 @@ int main(int ac, char** av) {
                 });
             });
             verify_seastar_io_scheduler(opts.count("max-io-requests"), db.local().get_config().developer_mode()).get();
+            // The data, commitlog, saved caches and hints trees are disjoint,
+            // so create and lock them concurrently.
             supervisor::notify("creating data directories");
-            dirs.touch_and_lock(db.local().get_config().data_file_directories()).get();
+            std::vector<future<>> dir_inits;
+            dir_inits.push_back(dirs.touch_and_lock(db.local().get_config().data_file_directories()));
             supervisor::notify("creating commitlog directory");
-            dirs.touch_and_lock(db.local().get_config().commitlog_directory()).get();
+            dir_inits.push_back(dirs.touch_and_lock(db.local().get_config().commitlog_directory()));
             std::unordered_set<sstring> directories;
             directories.insert(db.local().get_config().data_file_directories().cbegin(),
                     db.local().get_config().data_file_directories().cend());
             directories.insert(db.local().get_config().commitlog_directory());
+            if (db.local().get_config().row_cache_save_period()) {
+                supervisor::notify("creating saved caches directory");
+                dir_inits.push_back(dirs.touch_and_lock(db.local().get_config().saved_caches_directory()));
+                directories.insert(db.local().get_config().saved_caches_directory());
+            }
 
             if (hinted_handoff_enabled) {
                 supervisor::notify("creating hints directories");
                 using namespace boost::filesystem;
 
                 path hints_base_dir(db.local().get_config().hints_directory());
-                dirs.touch_and_lock(db.local().get_config().hints_directory()).get();
                 directories.insert(db.local().get_config().hints_directory());
+                std::vector<sstring> hints_dirs;
                 for (unsigned i = 0; i < smp::count; ++i) {
                     sstring shard_dir((hints_base_dir / seastar::to_sstring(i).c_str()).native());
-                    dirs.touch_and_lock(shard_dir).get();
+                    hints_dirs.push_back(shard_dir);
                     directories.insert(std::move(shard_dir));
                 }
+                // The shard directories live under the base directory, so
+                // lock the base first and fan out only then.
+                dir_inits.push_back(dirs.touch_and_lock(db.local().get_config().hints_directory()).then(
+                        [&dirs, hints_dirs = std::move(hints_dirs)] {
+                    return dirs.touch_and_lock(hints_dirs);
+                }));
+            }
+            for (auto& f : when_all(dir_inits.begin(), dir_inits.end()).get0()) {
+                f.get();
             }
 
             supervisor::notify("verifying directories");
@@ -523,7 +577,10 @@ int main(int ac, char** av) {
             // Iteration through column family directory for sstable loading is
             // done only by shard 0, so we'll no longer face race conditions as
             // described here: https://github.com/scylladb/scylla/issues/1014
-            distributed_loader::init_system_keyspace(db).get();
+            // System sstable loading is pure disk I/O and consults neither
+            // messaging nor gossip, so let it run while those are brought up
+            // below; it is joined before the system keyspace is used.
+            auto system_keyspace_ready = distributed_loader::init_system_keyspace(db);
 
             supervisor::notify("starting gossip");
             // Moved local parameters here, esp since with the
@@ -562,11 +619,14 @@ int main(int ac, char** av) {
                     , phi
                     , cfg->listen_on_broadcast_address());
             supervisor::notify("starting storage proxy");
-            proxy.start(std::ref(db), hinted_handoff_enabled).get();
+            auto proxy_ready = proxy.start(std::ref(db), hinted_handoff_enabled);
             // #293 - do not stop anything
             // engine().at_exit([&proxy] { return proxy.stop(); });
             supervisor::notify("starting migration manager");
-            mm.start().get();
+            auto mm_ready = mm.start();
+            // The query processor registers with the local migration manager
+            // and holds the proxy, so join both before starting it.
+            when_all_succeed(std::move(proxy_ready), std::move(mm_ready)).get();
             // #293 - do not stop anything
             // engine().at_exit([&mm] { return mm.stop(); });
             supervisor::notify("starting query processor");
@@ -579,6 +639,7 @@ int main(int ac, char** av) {
             // engine().at_exit([] { return db::get_batchlog_manager().stop(); });
             sstables::init_metrics().get();
 
+            system_keyspace_ready.get();
             db::system_keyspace::minimal_setup(db, qp);
 
             // schema migration, if needed, is also done on shard 0
@@ -631,10 +692,9 @@ int main(int ac, char** av) {
                     cf.trigger_compaction();
                 }
             }).get();
-            api::set_server_gossip(ctx).get();
-            api::set_server_snitch(ctx).get();
-            api::set_server_storage_proxy(ctx).get();
-            api::set_server_load_sstable(ctx).get();
+            // These only register REST routes and are independent of each other.
+            when_all_succeed(api::set_server_gossip(ctx), api::set_server_snitch(ctx),
+                    api::set_server_storage_proxy(ctx), api::set_server_load_sstable(ctx)).get();
             static seastar::sharded<memory_threshold_guard> mtg;
             mtg.start(cfg->large_memory_allocation_warning_threshold());
             supervisor::notify("initializing migration manager RPC verbs");
@@ -679,7 +739,15 @@ int main(int ac, char** av) {
             cf_cache_hitrate_calculator.start(std::ref(db), std::ref(cf_cache_hitrate_calculator)).get();
             engine().at_exit([&cf_cache_hitrate_calculator] { return cf_cache_hitrate_calculator.stop(); });
             cf_cache_hitrate_calculator.local().run_on(engine().cpu_id());
+            supervisor::notify("starting cache saver");
+            cache_saver.start(std::ref(db)).get();
+            engine().at_exit([&cache_saver] { return cache_saver.stop(); });
+            cache_saver.invoke_on_all([] (service::cache_saver& cs) { cs.start(); }).get();
             api::set_server_cache(ctx);
+            supervisor::notify("starting view builder");
+            view_builder.start(std::ref(db)).get();
+            engine().at_exit([&view_builder] { return view_builder.stop(); });
+            view_builder.invoke_on_all([] (db::view::view_builder& vb) { return vb.start(); }).get();
             gms::get_local_gossiper().wait_for_gossip_to_settle().get();
             api::set_server_gossip_settle(ctx).get();
 
@@ -689,6 +757,13 @@ int main(int ac, char** av) {
                 proxy.invoke_on_all([] (service::storage_proxy& local_proxy) { local_proxy.start_hints_manager(gms::get_local_gossiper().shared_from_this()); }).get();
             }
 
+            supervisor::notify("starting workload group registry");
+            service::get_workload_group_registry().start().get();
+            engine().at_exit([] { return service::get_workload_group_registry().stop(); });
+            if (cfg->cpu_scheduler()) {
+                service::get_workload_group_registry().invoke_on_all([] (service::workload_group_registry& r) { return r.start(); }).get();
+            }
+
             supervisor::notify("starting native transport");
             service::get_local_storage_service().start_native_transport().get();
             if (start_thrift) {
@@ -44,3 +44,16 @@ write_memtable_to_sstable(memtable& mt,
 future<>
 write_memtable_to_sstable(memtable& mt,
         sstables::shared_sstable sst);
+
+// Flush-merge mode: stream the memtable combined with the given sstables
+// into one output sstable, which then supersedes them. Their data goes
+// through a single write pass instead of being rewritten by a subsequent
+// compaction. See column_family::try_flush_memtable_to_sstable().
+future<>
+write_memtable_to_sstable(memtable& mt,
+        std::vector<sstables::shared_sstable> merge_with,
+        sstables::shared_sstable sst,
+        sstables::write_monitor& mon,
+        bool backup = false,
+        const io_priority_class& pc = default_priority_class(),
+        bool leave_unsealed = false);
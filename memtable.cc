@@ -19,6 +19,7 @@
  * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "core/print.hh"
 #include "memtable.hh"
 #include "database.hh"
 #include "frozen_mutation.hh"
@@ -32,6 +33,7 @@ memtable::memtable(schema_ptr schema, dirty_memory_manager& dmm, memtable_list*
         , _memtable_list(memtable_list)
         , _schema(std::move(schema))
         , partitions(memtable_entry::compare(_schema)) {
+    set_name(sprint("memtable:%s.%s", _schema->ks_name(), _schema->cf_name()));
 }
 
 static thread_local dirty_memory_manager mgr_for_tests;
@@ -108,7 +110,7 @@ memtable::find_or_create_partition(const dht::decorated_key& key) {
     assert(!reclaiming_enabled());
 
     // call lower_bound so we have a hint for the insert, just in case.
-    auto i = partitions.lower_bound(key, memtable_entry::compare(_schema));
+    auto i = partitions.lower_bound(memtable_entry::prefixed(key), memtable_entry::compare(_schema));
     if (i == partitions.end() || !key.equal(*_schema, i->key())) {
         memtable_entry* entry = current_allocator().construct<memtable_entry>(
             _schema, dht::decorated_key(key), mutation_partition(_schema));
@@ -124,7 +126,7 @@ boost::iterator_range<memtable::partitions_type::const_iterator>
 memtable::slice(const dht::partition_range& range) const {
     if (query::is_single_partition(range)) {
         const query::ring_position& pos = range.start()->value();
-        auto i = partitions.find(pos, memtable_entry::compare(_schema));
+        auto i = partitions.find(memtable_entry::prefixed(pos), memtable_entry::compare(_schema));
         if (i != partitions.end()) {
             return boost::make_iterator_range(i, std::next(i));
         } else {
@@ -135,14 +137,14 @@ memtable::slice(const dht::partition_range& range) const {
 
         auto i1 = range.start()
                   ? (range.start()->is_inclusive()
-                        ? partitions.lower_bound(range.start()->value(), cmp)
-                        : partitions.upper_bound(range.start()->value(), cmp))
+                        ? partitions.lower_bound(memtable_entry::prefixed(range.start()->value()), cmp)
+                        : partitions.upper_bound(memtable_entry::prefixed(range.start()->value()), cmp))
                   : partitions.cbegin();
 
         auto i2 = range.end()
                   ? (range.end()->is_inclusive()
-                        ? partitions.upper_bound(range.end()->value(), cmp)
-                        : partitions.lower_bound(range.end()->value(), cmp))
+                        ? partitions.upper_bound(memtable_entry::prefixed(range.end()->value()), cmp)
+                        : partitions.lower_bound(memtable_entry::prefixed(range.end()->value()), cmp))
                   : partitions.cend();
 
         return boost::make_iterator_range(i1, i2);
@@ -163,8 +165,8 @@ class iterator_reader {
         auto cmp = memtable_entry::compare(_memtable->_schema);
         return _range->end()
             ? (_range->end()->is_inclusive()
-                ? _memtable->partitions.upper_bound(_range->end()->value(), cmp)
-                : _memtable->partitions.lower_bound(_range->end()->value(), cmp))
+                ? _memtable->partitions.upper_bound(memtable_entry::prefixed(_range->end()->value()), cmp)
+                : _memtable->partitions.lower_bound(memtable_entry::prefixed(_range->end()->value()), cmp))
             : _memtable->partitions.end();
     }
     void update_iterators() {
@@ -174,7 +176,7 @@ class iterator_reader {
         if (_last) {
             if (current_reclaim_counter != _last_reclaim_counter ||
                   _last_partition_count != _memtable->partition_count()) {
-                _i = _memtable->partitions.upper_bound(*_last, cmp);
+                _i = _memtable->partitions.upper_bound(memtable_entry::prefixed(*_last), cmp);
                 _end = lookup_end();
                 _last_partition_count = _memtable->partition_count();
             }
@@ -182,8 +184,8 @@ class iterator_reader {
             // Initial lookup
             _i = _range->start()
                  ? (_range->start()->is_inclusive()
-                    ? _memtable->partitions.lower_bound(_range->start()->value(), cmp)
-                    : _memtable->partitions.upper_bound(_range->start()->value(), cmp))
+                    ? _memtable->partitions.lower_bound(memtable_entry::prefixed(_range->start()->value()), cmp)
+                    : _memtable->partitions.upper_bound(memtable_entry::prefixed(_range->start()->value()), cmp))
                  : _memtable->partitions.begin();
             _end = lookup_end();
             _last_partition_count = _memtable->partition_count();
@@ -539,7 +541,7 @@ memtable::make_flat_reader(schema_ptr s,
         const query::ring_position& pos = range.start()->value();
         auto snp = _read_section(*this, [&] () -> lw_shared_ptr<partition_snapshot> {
             managed_bytes::linearization_context_guard lcg;
-            auto i = partitions.find(pos, memtable_entry::compare(_schema));
+            auto i = partitions.find(memtable_entry::prefixed(pos), memtable_entry::compare(_schema));
             if (i != partitions.end()) {
                 upgrade_entry(*i);
                 return i->snapshot(*this);
@@ -651,6 +653,7 @@ memtable_entry::memtable_entry(memtable_entry&& o) noexcept
     : _link()
     , _schema(std::move(o._schema))
     , _key(std::move(o._key))
+    , _token_prefix(o._token_prefix)
     , _pe(std::move(o._pe))
 {
     using container_type = memtable::partitions_type;
@@ -43,6 +43,11 @@ class memtable_entry {
     bi::set_member_hook<> _link;
     schema_ptr _schema;
     dht::decorated_key _key;
+    // Cached dht::token_comparison_prefix() of _key's token. Most tree
+    // comparisons during lookups and inserts are decided on this inline
+    // integer alone, without dereferencing the token's managed storage or
+    // comparing key bytes.
+    uint64_t _token_prefix;
     partition_entry _pe;
 public:
     friend class memtable;
@@ -50,6 +55,7 @@ public:
     memtable_entry(schema_ptr s, dht::decorated_key key, mutation_partition p)
         : _schema(std::move(s))
         , _key(std::move(key))
+        , _token_prefix(dht::token_comparison_prefix(_key.token()))
         , _pe(std::move(p))
     { }
 
@@ -79,6 +85,20 @@ public:
         return size;
     }
 
+    // A lookup key bundled with its precomputed token comparison prefix,
+    // so that a whole tree descent computes the prefix only once.
+    template <typename T>
+    struct prefixed_key {
+        const T& key;
+        uint64_t prefix;
+        explicit prefixed_key(const T& k) : key(k), prefix(dht::token_comparison_prefix(k.token())) {}
+    };
+
+    template <typename T>
+    static prefixed_key<T> prefixed(const T& k) {
+        return prefixed_key<T>(k);
+    }
+
     struct compare {
         dht::decorated_key::less_comparator _c;
 
@@ -91,6 +111,9 @@ public:
         }
 
         bool operator()(const memtable_entry& k1, const memtable_entry& k2) const {
+            if (k1._token_prefix != k2._token_prefix) {
+                return k1._token_prefix < k2._token_prefix;
+            }
             return _c(k1._key, k2._key);
         }
 
@@ -105,6 +128,22 @@ public:
         bool operator()(const dht::ring_position& k1, const memtable_entry& k2) const {
             return _c(k1, k2._key);
         }
+
+        template <typename T>
+        bool operator()(const prefixed_key<T>& k1, const memtable_entry& k2) const {
+            if (k1.prefix != k2._token_prefix) {
+                return k1.prefix < k2._token_prefix;
+            }
+            return _c(k1.key, k2._key);
+        }
+
+        template <typename T>
+        bool operator()(const memtable_entry& k1, const prefixed_key<T>& k2) const {
+            if (k1._token_prefix != k2.prefix) {
+                return k1._token_prefix < k2.prefix;
+            }
+            return _c(k1._key, k2.key);
+        }
     };
 
     friend std::ostream& operator<<(std::ostream&, const memtable_entry&);
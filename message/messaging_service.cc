@@ -383,12 +383,23 @@ rpc::no_wait_type messaging_service::no_wait() {
     return rpc::no_wait;
 }
 
+// Verbs are spread over separate connections ("lanes") per endpoint, so that
+// verbs with different latency requirements don't share a TCP stream. RPC
+// responses are multiplexed, but frames on one connection are sent back to
+// back, so a single large frame head-of-line blocks every small frame queued
+// behind it. The lanes:
+//   0 - latency-critical data path: MUTATION, READ and friends, whose frames
+//       are bounded by the query/mutation size limits;
+//   1 - gossip and schema version pulls, which must not be stuck behind
+//       anything (and GET_SCHEMA_VERSION is sent from within read/mutate
+//       handlers, so a shared connection could deadlock);
+//   2 - streaming, whose frames are large by design;
+//   3 - mutation responses, so acks flow while we are busy sending;
+//   4 - schema transfer: DEFINITIONS_UPDATE and MIGRATION_REQUEST carry
+//       full schema mutations, easily megabytes on a large schema, which
+//       would otherwise stall the data path during schema changes.
 static unsigned get_rpc_client_idx(messaging_verb verb) {
     unsigned idx = 0;
-    // GET_SCHEMA_VERSION is sent from read/mutate verbs so should be
-    // sent on a different connection to avoid potential deadlocks
-    // as well as reduce latency as there are potentially many requests
-    // blocked on schema version request.
     if (verb == messaging_verb::GOSSIP_DIGEST_SYN ||
         verb == messaging_verb::GOSSIP_DIGEST_ACK2 ||
         verb == messaging_verb::GOSSIP_SHUTDOWN ||
@@ -399,10 +410,15 @@ static unsigned get_rpc_client_idx(messaging_verb verb) {
                verb == messaging_verb::PREPARE_DONE_MESSAGE ||
                verb == messaging_verb::STREAM_MUTATION ||
                verb == messaging_verb::STREAM_MUTATION_DONE ||
+               verb == messaging_verb::STREAM_SSTABLE ||
                verb == messaging_verb::COMPLETE_MESSAGE) {
         idx = 2;
-    } else if (verb == messaging_verb::MUTATION_DONE || verb == messaging_verb::MUTATION_FAILED) {
+    } else if (verb == messaging_verb::MUTATION_DONE || verb == messaging_verb::MUTATION_FAILED ||
+               verb == messaging_verb::MUTATION_DONE_MULTI) {
         idx = 3;
+    } else if (verb == messaging_verb::DEFINITIONS_UPDATE ||
+               verb == messaging_verb::MIGRATION_REQUEST) {
+        idx = 4;
     }
     return idx;
 }
@@ -695,6 +711,15 @@ future<> messaging_service::send_stream_mutation_done(msg_addr id, UUID plan_id,
         plan_id, std::move(ranges), cf_id, dst_cpu_id);
 }
 
+// STREAM_SSTABLE
+void messaging_service::register_stream_sstable(std::function<future<> (const rpc::client_info& cinfo, UUID plan_id, sstring ks_name, sstring cf_name, sstring component, uint64_t offset, bytes data, bool last_chunk)>&& func) {
+    register_handler(this, messaging_verb::STREAM_SSTABLE, std::move(func));
+}
+future<> messaging_service::send_stream_sstable(msg_addr id, UUID plan_id, sstring ks_name, sstring cf_name, sstring component, uint64_t offset, bytes data, bool last_chunk) {
+    return send_message<void>(this, messaging_verb::STREAM_SSTABLE, id,
+        plan_id, std::move(ks_name), std::move(cf_name), std::move(component), offset, std::move(data), last_chunk);
+}
+
 // COMPLETE_MESSAGE
 void messaging_service::register_complete_message(std::function<future<> (const rpc::client_info& cinfo, UUID plan_id, unsigned dst_cpu_id, rpc::optional<bool> failed)>&& func) {
     register_handler(this, messaging_verb::COMPLETE_MESSAGE, std::move(func));
@@ -790,6 +815,42 @@ future<> messaging_service::send_mutation(msg_addr id, clock_type::time_point ti
         std::move(reply_to), std::move(shard), std::move(response_id), std::move(trace_info));
 }
 
+void messaging_service::register_mutation_batch(std::function<future<rpc::no_wait_type> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms,
+    inet_address reply_to, unsigned shard, std::vector<response_id_type> response_ids)>&& func) {
+    register_handler(this, netw::messaging_verb::MUTATION_BATCH, std::move(func));
+}
+void messaging_service::unregister_mutation_batch() {
+    _rpc->unregister_handler(netw::messaging_verb::MUTATION_BATCH);
+}
+future<> messaging_service::send_mutation_batch(msg_addr id, clock_type::time_point timeout, std::vector<std::reference_wrapper<const frozen_mutation>> fms,
+    inet_address reply_to, unsigned shard, std::vector<response_id_type> response_ids) {
+    return send_message_oneway_timeout(this, timeout, messaging_verb::MUTATION_BATCH, std::move(id), std::move(fms),
+        std::move(reply_to), std::move(shard), std::move(response_ids));
+}
+
+void messaging_service::register_mutation_forward(std::function<future<> (const rpc::client_info&, rpc::opt_time_point, frozen_mutation fm,
+    rpc::optional<std::experimental::optional<tracing::trace_info>> trace_info)>&& func) {
+    register_handler(this, netw::messaging_verb::MUTATION_FORWARD, std::move(func));
+}
+void messaging_service::unregister_mutation_forward() {
+    _rpc->unregister_handler(netw::messaging_verb::MUTATION_FORWARD);
+}
+future<> messaging_service::send_mutation_forward(msg_addr id, clock_type::time_point timeout, const frozen_mutation& fm,
+    std::experimental::optional<tracing::trace_info> trace_info) {
+    return send_message_timeout<void>(this, messaging_verb::MUTATION_FORWARD, std::move(id), timeout, fm, std::move(trace_info));
+}
+
+void messaging_service::register_mutation_done_multi(std::function<future<rpc::no_wait_type> (const rpc::client_info& cinfo, unsigned shard, response_id_type response_id,
+    std::vector<inet_address> acked, size_t num_failed)>&& func) {
+    register_handler(this, netw::messaging_verb::MUTATION_DONE_MULTI, std::move(func));
+}
+void messaging_service::unregister_mutation_done_multi() {
+    _rpc->unregister_handler(netw::messaging_verb::MUTATION_DONE_MULTI);
+}
+future<> messaging_service::send_mutation_done_multi(msg_addr id, unsigned shard, response_id_type response_id, std::vector<inet_address> acked, size_t num_failed) {
+    return send_message_oneway(this, messaging_verb::MUTATION_DONE_MULTI, std::move(id), std::move(shard), std::move(response_id), std::move(acked), num_failed);
+}
+
 void messaging_service::register_counter_mutation(std::function<future<> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms, db::consistency_level cl, stdx::optional<tracing::trace_info> trace_info)>&& func) {
     register_handler(this, netw::messaging_verb::COUNTER_MUTATION, std::move(func));
 }
@@ -860,6 +921,16 @@ future<reconcilable_result, rpc::optional<cache_temperature>> messaging_service:
     return send_message_timeout<future<reconcilable_result, rpc::optional<cache_temperature>>>(this, messaging_verb::READ_MUTATION_DATA, std::move(id), timeout, cmd, pr);
 }
 
+void messaging_service::register_read_data_multi(std::function<future<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, std::vector<compat::wrapping_partition_range> prs)>&& func) {
+    register_handler(this, netw::messaging_verb::READ_DATA_MULTI, std::move(func));
+}
+void messaging_service::unregister_read_data_multi() {
+    _rpc->unregister_handler(netw::messaging_verb::READ_DATA_MULTI);
+}
+future<query::result, rpc::optional<cache_temperature>> messaging_service::send_read_data_multi(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const std::vector<dht::partition_range>& prs) {
+    return send_message_timeout<future<query::result, rpc::optional<cache_temperature>>>(this, messaging_verb::READ_DATA_MULTI, std::move(id), timeout, cmd, prs);
+}
+
 void messaging_service::register_read_digest(std::function<future<query::result_digest, api::timestamp_type, cache_temperature> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda)>&& func) {
     register_handler(this, netw::messaging_verb::READ_DIGEST, std::move(func));
 }
@@ -109,7 +109,12 @@ enum class messaging_verb : int32_t {
     SCHEMA_CHECK = 22,
     COUNTER_MUTATION = 23,
     MUTATION_FAILED = 24,
-    LAST = 25,
+    STREAM_SSTABLE = 25,
+    MUTATION_BATCH = 26,
+    MUTATION_FORWARD = 27,
+    MUTATION_DONE_MULTI = 28,
+    READ_DATA_MULTI = 29,
+    LAST = 30,
 };
 
 } // namespace netw
@@ -204,7 +209,9 @@ private:
     std::array<std::unique_ptr<rpc_protocol_server_wrapper>, 2> _server;
     ::shared_ptr<seastar::tls::server_credentials> _credentials;
     std::array<std::unique_ptr<rpc_protocol_server_wrapper>, 2> _server_tls;
-    std::array<clients_map, 4> _clients;
+    // One map per connection lane; see get_rpc_client_idx() for which verbs
+    // travel over which lane and why.
+    std::array<clients_map, 5> _clients;
     uint64_t _dropped_messages[static_cast<int32_t>(messaging_verb::LAST)] = {};
     bool _stopping = false;
     std::list<std::function<void(gms::inet_address ep)>> _connection_drop_notifiers;
@@ -250,6 +257,12 @@ public:
     void register_stream_mutation_done(std::function<future<> (const rpc::client_info& cinfo, UUID plan_id, dht::token_range_vector ranges, UUID cf_id, unsigned dst_cpu_id)>&& func);
     future<> send_stream_mutation_done(msg_addr id, UUID plan_id, dht::token_range_vector ranges, UUID cf_id, unsigned dst_cpu_id);
 
+    // Wrapper for STREAM_SSTABLE verb. Ships a chunk of an sstable component
+    // file verbatim; the receiver assembles components in the table's upload
+    // directory and loads them when the sstable's TOC completes.
+    void register_stream_sstable(std::function<future<> (const rpc::client_info& cinfo, UUID plan_id, sstring ks_name, sstring cf_name, sstring component, uint64_t offset, bytes data, bool last_chunk)>&& func);
+    future<> send_stream_sstable(msg_addr id, UUID plan_id, sstring ks_name, sstring cf_name, sstring component, uint64_t offset, bytes data, bool last_chunk);
+
     void register_complete_message(std::function<future<> (const rpc::client_info& cinfo, UUID plan_id, unsigned dst_cpu_id, rpc::optional<bool> failed)>&& func);
     future<> send_complete_message(msg_addr id, UUID plan_id, unsigned dst_cpu_id, bool failed = false);
 
@@ -302,6 +315,41 @@ public:
     future<> send_mutation(msg_addr id, clock_type::time_point timeout, const frozen_mutation& fm, std::vector<inet_address> forward,
         inet_address reply_to, unsigned shard, response_id_type response_id, std::experimental::optional<tracing::trace_info> trace_info = std::experimental::nullopt);
 
+    // Wrapper for MUTATION_BATCH
+    // Carries several mutations coalesced for the same destination. Each
+    // mutation is acknowledged individually through MUTATION_DONE/MUTATION_FAILED
+    // using its own response id, so there is no batch-level reply.
+    void register_mutation_batch(std::function<future<rpc::no_wait_type> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms,
+        inet_address reply_to, unsigned shard, std::vector<response_id_type> response_ids)>&& func);
+    void unregister_mutation_batch();
+    // The mutations are serialized on the wire exactly as if they were passed
+    // by value; taking references avoids copying their frozen representation
+    // on the sending side. The caller must keep them alive until the returned
+    // future resolves.
+    future<> send_mutation_batch(msg_addr id, clock_type::time_point timeout, std::vector<std::reference_wrapper<const frozen_mutation>> fms,
+        inet_address reply_to, unsigned shard, std::vector<response_id_type> response_ids);
+
+    // Wrapper for MUTATION_FORWARD
+    // Sent by a remote-DC write coordinator to the other replicas in its
+    // datacenter. Unlike MUTATION, the acknowledgement is the RPC reply
+    // itself; the coordinator aggregates the replies and acknowledges the
+    // originating node once, through MUTATION_DONE_MULTI, so that each
+    // replica does not have to ack across the WAN individually.
+    void register_mutation_forward(std::function<future<> (const rpc::client_info&, rpc::opt_time_point, frozen_mutation fm,
+        rpc::optional<std::experimental::optional<tracing::trace_info>> trace_info)>&& func);
+    void unregister_mutation_forward();
+    future<> send_mutation_forward(msg_addr id, clock_type::time_point timeout, const frozen_mutation& fm,
+        std::experimental::optional<tracing::trace_info> trace_info = std::experimental::nullopt);
+
+    // Wrapper for MUTATION_DONE_MULTI
+    // Acknowledges one write on behalf of several replicas at once: acked
+    // lists the endpoints whose writes completed and num_failed counts the
+    // ones that did not.
+    void register_mutation_done_multi(std::function<future<rpc::no_wait_type> (const rpc::client_info& cinfo, unsigned shard, response_id_type response_id,
+        std::vector<inet_address> acked, size_t num_failed)>&& func);
+    void unregister_mutation_done_multi();
+    future<> send_mutation_done_multi(msg_addr id, unsigned shard, response_id_type response_id, std::vector<inet_address> acked, size_t num_failed);
+
     // Wrapper for COUNTER_MUTATION
     void register_counter_mutation(std::function<future<> (const rpc::client_info&, rpc::opt_time_point, std::vector<frozen_mutation> fms, db::consistency_level cl, stdx::optional<tracing::trace_info> trace_info)>&& func);
     void unregister_counter_mutation();
@@ -338,6 +386,13 @@ public:
     void unregister_read_mutation_data();
     future<reconcilable_result, rpc::optional<cache_temperature>> send_read_mutation_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr);
 
+    // Wrapper for READ_DATA_MULTI. Executes one read command over several
+    // singular partition ranges on the receiving replica, which returns the
+    // per-range results merged in request order.
+    void register_read_data_multi(std::function<future<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, std::vector<compat::wrapping_partition_range> prs)>&& func);
+    void unregister_read_data_multi();
+    future<query::result, rpc::optional<cache_temperature>> send_read_data_multi(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const std::vector<dht::partition_range>& prs);
+
     // Wrapper for READ_DIGEST
     void register_read_digest(std::function<future<query::result_digest, api::timestamp_type, cache_temperature> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> digest)>&& func);
     void unregister_read_digest();
@@ -294,7 +294,17 @@ void mutation_partition::apply_monotonically(const schema& s, mutation_partition
     auto p_i = p._rows.begin();
     while (p_i != p._rows.end()) {
         rows_entry& src_e = *p_i;
-        auto i = _rows.lower_bound(src_e, less);
+        // Time-series workloads insert rows in increasing clustering order,
+        // so the common case is an append past the current last row. Probe
+        // the tail with a single comparison before paying for a full tree
+        // descent; source rows are sorted, so once one of them lands at the
+        // end every following one does too.
+        rows_type::iterator i;
+        if (_rows.empty() || less(*_rows.rbegin(), src_e)) {
+            i = _rows.end();
+        } else {
+            i = _rows.lower_bound(src_e, less);
+        }
         if (i == _rows.end() || less(src_e, *i)) {
             p_i = p._rows.erase(p_i);
             _rows.insert_before(i, src_e);
@@ -319,7 +329,14 @@ void mutation_partition::apply_monotonically(const schema& s, mutation_partition
 
 void
 mutation_partition::apply_weak(const schema& s, mutation_partition_view p, const schema& p_schema) {
-    // FIXME: Optimize
+    if (s.version() == p_schema.version()) {
+        // We promise only weak exception guarantees, so we can merge the
+        // serialized representation in place without materializing an
+        // intermediate mutation_partition.
+        mutation_partition_applier applier(s, *this);
+        p.accept(s, applier);
+        return;
+    }
     mutation_partition p2(*this, copy_comparators_only{});
     partition_builder b(p_schema, p2);
     p.accept(p_schema, b);
@@ -597,8 +614,12 @@ void write_cell(RowWriter& w, const query::partition_slice& slice, const data_ty
 }
 
 template<typename RowWriter>
-void write_counter_cell(RowWriter& w, const query::partition_slice& slice, ::atomic_cell_view c) {
+void write_counter_cell(RowWriter& w, const query::partition_slice& slice, const cell_and_hash& c_a_h) {
+    auto c = c_a_h.cell.as_atomic_cell();
     assert(c.is_live());
+    if (!c_a_h.counter_total) {
+        c_a_h.counter_total = counter_cell_view(c).total_value();
+    }
     auto wr = w.add().write();
     [&, wr = std::move(wr)] () mutable {
         if (slice.options.contains<query::partition_slice::option::send_timestamp>()) {
@@ -607,7 +628,7 @@ void write_counter_cell(RowWriter& w, const query::partition_slice& slice, ::ato
             return std::move(wr).skip_timestamp();
         }
     }().skip_expiry()
-            .write_value(counter_cell_view::total_value_type()->decompose(counter_cell_view(c).total_value()))
+            .write_value(counter_cell_view::total_value_type()->decompose(*c_a_h.counter_total))
             .skip_ttl()
             .end_qr_cell();
 }
@@ -686,6 +707,20 @@ void row::prepare_hash(const schema& s, column_kind kind) const {
     });
 }
 
+void row::prepare_counter_totals(const schema& s, column_kind kind) const {
+    // const to avoid removing const qualifiers on the read path
+    for_each_cell([&s, kind] (column_id id, const cell_and_hash& c_a_h) {
+        auto& def = s.column_at(kind, id);
+        if (!def.is_counter() || c_a_h.counter_total) {
+            return;
+        }
+        auto c = c_a_h.cell.as_atomic_cell();
+        if (c.is_live() && !c.is_counter_update()) {
+            c_a_h.counter_total = counter_cell_view(c).total_value();
+        }
+    });
+}
+
 template<typename RowWriter>
 static void get_compacted_row_slice(const schema& s,
     const query::partition_slice& slice,
@@ -695,17 +730,18 @@ static void get_compacted_row_slice(const schema& s,
     RowWriter& writer)
 {
     for (auto id : columns) {
-        const atomic_cell_or_collection* cell = cells.find_cell(id);
-        if (!cell) {
+        const cell_and_hash* c_a_h = cells.find_cell_and_hash(id);
+        if (!c_a_h) {
             writer.add().skip();
         } else {
+            auto&& cell = &c_a_h->cell;
             auto&& def = s.column_at(kind, id);
             if (def.is_atomic()) {
                 auto c = cell->as_atomic_cell();
                 if (!c.is_live()) {
                     writer.add().skip();
                 } else if (def.is_counter()) {
-                    write_counter_cell(writer, slice, cell->as_atomic_cell());
+                    write_counter_cell(writer, slice, *c_a_h);
                 } else {
                     write_cell(writer, slice, cell->as_atomic_cell());
                 }
@@ -1014,9 +1050,11 @@ apply_monotonically(const column_definition& def, cell_and_hash& dst,
         if (def.is_counter()) {
             counter_cell_view::apply_reversibly(dst.cell, src); // FIXME: Optimize
             dst.hash = { };
+            dst.counter_total = { };
         } else if (compare_atomic_cell_for_merge(dst.cell.as_atomic_cell(), src.as_atomic_cell()) < 0) {
             std::swap(dst.cell, src);
             dst.hash = std::move(src_hash);
+            dst.counter_total = { };
         }
     } else {
         auto ct = static_pointer_cast<const collection_type_impl>(def.type);
@@ -1524,6 +1562,37 @@ void row::apply_monotonically(const schema& s, column_kind kind, row&& other) {
 bool row::compact_and_expire(const schema& s, column_kind kind, row_tombstone tomb, gc_clock::time_point query_time,
     can_gc_fn& can_gc, gc_clock::time_point gc_before)
 {
+    // Pre-pass over the contiguous storage which classifies all cells of the
+    // row at once, before any of them is touched. Cells are kept in
+    // serialized form, so instead of wide timestamp compares the batch is a
+    // tight loop reading just the flag byte and the timestamp of each cell.
+    // The shadowable tombstone is always >= the regular one, so a single
+    // comparison against tomb.tomb() establishes that a cell is covered by
+    // neither. When every cell turns out to be trivially live - no TTL, not
+    // dead, not shadowed - the erase machinery below is skipped entirely,
+    // which is the common case for rows in non-expiring tables.
+    if (_type == storage_type::vector) {
+        const api::timestamp_type tomb_ts = tomb.tomb().timestamp;
+        bool all_trivially_live = true;
+        for (unsigned i = 0; i < _storage.vector.v.size(); i++) {
+            if (!_storage.vector.present.test(i)) {
+                continue;
+            }
+            const column_definition& def = s.column_at(kind, i);
+            if (!def.is_atomic() || (def.is_counter() && tomb_ts != api::missing_timestamp)) {
+                all_trivially_live = false;
+                break;
+            }
+            atomic_cell_view cell = _storage.vector.v[i].cell.as_atomic_cell();
+            if (!cell.is_live() || cell.is_live_and_has_ttl() || cell.timestamp() <= tomb_ts) {
+                all_trivially_live = false;
+                break;
+            }
+        }
+        if (all_trivially_live) {
+            return _size > 0;
+        }
+    }
     bool any_live = false;
     remove_if([&] (column_id id, atomic_cell_or_collection& c) {
         bool erase = false;
@@ -1818,6 +1887,16 @@ uint32_t mutation_querier::consume_end_of_stream() {
     }
 }
 
+// When short reads are allowed, a read which keeps finding live rows can go
+// on for as long as the memory budget lasts, which for a wide partition can
+// be far longer than a reactor task quota. Ending the page when preemption
+// is requested keeps such reads streaming in bounded chunks; the short read
+// machinery resumes them from the last returned row as usual. Only called
+// after a live row has been emitted, which guarantees forward progress.
+static stop_iteration stop_on_preemption(bool short_read_allowed) {
+    return stop_iteration(short_read_allowed && need_preempt());
+}
+
 class query_result_builder {
     const schema& _schema;
     query::result::builder& _rb;
@@ -1845,6 +1924,11 @@ public:
     }
     stop_iteration consume(clustering_row&& cr, row_tombstone t,  bool) {
         _stop = _mutation_consumer->consume(std::move(cr), t) && _short_read_allowed;
+        if (!_stop && !_pw->requested_digest()) {
+            // Not for digest-producing reads: those need to stop at the same
+            // point on all replicas or they would mismatch spuriously.
+            _stop = stop_on_preemption(bool(_short_read_allowed));
+        }
         return _stop;
     }
     stop_iteration consume(range_tombstone&& rt) {
@@ -1944,6 +2028,9 @@ public:
             // mean that the next page fetch will read all tombstones after the
             // last live row again.
             _stop = stop && stop_iteration(_short_read_allowed);
+            if (!_stop) {
+                _stop = stop_on_preemption(_short_read_allowed);
+            }
         }
         return _mutation_consumer->consume(std::move(cr)) || _stop;
     }
@@ -73,6 +73,12 @@ using cell_hash_opt = seastar::optimized_optional<cell_hash>;
 struct cell_and_hash {
     atomic_cell_or_collection cell;
     mutable cell_hash_opt hash;
+    // Memoized sum of all counter shards, so that repeated reads of a hot
+    // counter cell don't pay the shard merge walk each time. Populated
+    // lazily on the read path, copied together with the cell into query
+    // temporaries and reset whenever the cell changes. Only meaningful for
+    // live counter cells.
+    mutable stdx::optional<int64_t> counter_total;
 };
 
 //
@@ -326,6 +332,10 @@ public:
 
     void prepare_hash(const schema& s, column_kind kind) const;
 
+    // Memoizes the merged total of every live counter cell in this row, so
+    // copies made for a query carry the value and reads become a cached load.
+    void prepare_counter_totals(const schema& s, column_kind kind) const;
+
     friend std::ostream& operator<<(std::ostream& os, const row& r);
 };
 
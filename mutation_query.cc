@@ -58,7 +58,16 @@ bool reconcilable_result::operator!=(const reconcilable_result& other) const {
 
 query::result
 to_data_query_result(const reconcilable_result& r, schema_ptr s, const query::partition_slice& slice, uint32_t max_rows, uint32_t max_partitions, query::result_options opts) {
-    query::result::builder builder(slice, opts, { });
+    // The data result is no bigger than the reconcilable one, so the size
+    // of the frozen mutations makes a good reservation for the result buffer.
+    // A digest-only result discards its output, so reserve nothing for it.
+    size_t reserve_size = 0;
+    if (opts.request != query::result_request::only_digest) {
+        for (const partition& p : r.partitions()) {
+            reserve_size += p.mut().representation().size();
+        }
+    }
+    query::result::builder builder(slice, opts, { }, reserve_size);
     for (const partition& p : r.partitions()) {
         if (builder.row_count() >= max_rows || builder.partition_count() >= max_partitions) {
             break;
@@ -23,6 +23,7 @@
 #include <boost/range/algorithm/reverse.hpp>
 #include <boost/move/iterator.hpp>
 #include <variant>
+#include <algorithm>
 
 #include "mutation_reader.hh"
 #include "core/future-util.hh"
@@ -188,6 +189,8 @@ private:
     const dht::token* current_position() const;
     void maybe_add_readers(const dht::token* const t);
     void add_readers(std::vector<flat_mutation_reader> new_readers);
+    void push_fragment(reader_and_last_fragment_kind rk, mutation_fragment mf);
+    void reader_out_of_fragments(reader_and_last_fragment_kind rk);
     future<> prepare_next();
     // Collect all forwardable readers into _next, and remove them from
     // their previous containers (_halted_readers and _fragment_heap).
@@ -300,28 +303,54 @@ struct mutation_reader_merger::fragment_heap_compare {
     }
 };
 
+void mutation_reader_merger::push_fragment(reader_and_last_fragment_kind rk, mutation_fragment mf) {
+    if (mf.is_partition_start()) {
+        _reader_heap.emplace_back(rk.reader, std::move(mf));
+        boost::push_heap(_reader_heap, reader_heap_compare(*_schema));
+    } else {
+        _fragment_heap.emplace_back(rk.reader, std::move(mf));
+        boost::range::push_heap(_fragment_heap, fragment_heap_compare(*_schema));
+    }
+}
+
+void mutation_reader_merger::reader_out_of_fragments(reader_and_last_fragment_kind rk) {
+    if (_fwd_sm == streamed_mutation::forwarding::yes && rk.last_kind != mutation_fragment::kind::partition_end) {
+        // When in streamed_mutation::forwarding mode we need
+        // to keep track of readers that returned
+        // end-of-stream to know what readers to ff. We can't
+        // just ff all readers as we might drop fragments from
+        // partitions we haven't even read yet.
+        // Readers whoose last emitted fragment was a partition
+        // end are out of data for good for the current range.
+        _halted_readers.push_back(rk);
+    } else if (_fwd_mr == mutation_reader::forwarding::no) {
+        _all_readers.remove_if([mr = rk.reader] (auto& r) { return &r == mr; });
+    }
+}
+
 future<> mutation_reader_merger::prepare_next() {
-    return parallel_for_each(_next, [this] (reader_and_last_fragment_kind rk) {
+    // The sub-readers buffer fragments ahead of us, so most of the time
+    // every reader in _next can produce its next fragment right away.
+    // Take those synchronously instead of allocating a future (and a
+    // continuation) per fragment, which dominates the merge cost on wide
+    // range scans; only readers whose buffer ran dry go through the
+    // future-based path below.
+    auto unready = std::partition(_next.begin(), _next.end(), [] (reader_and_last_fragment_kind rk) {
+        return !rk.reader->is_buffer_empty() || rk.reader->is_end_of_stream();
+    });
+    for (auto it = _next.begin(); it != unready; ++it) {
+        if (it->reader->is_buffer_empty()) {
+            reader_out_of_fragments(*it);
+        } else {
+            push_fragment(*it, it->reader->pop_mutation_fragment());
+        }
+    }
+    return parallel_for_each(unready, _next.end(), [this] (reader_and_last_fragment_kind rk) {
         return (*rk.reader)().then([this, rk] (mutation_fragment_opt mfo) {
             if (mfo) {
-                if (mfo->is_partition_start()) {
-                    _reader_heap.emplace_back(rk.reader, std::move(*mfo));
-                    boost::push_heap(_reader_heap, reader_heap_compare(*_schema));
-                } else {
-                    _fragment_heap.emplace_back(rk.reader, std::move(*mfo));
-                    boost::range::push_heap(_fragment_heap, fragment_heap_compare(*_schema));
-                }
-            } else if (_fwd_sm == streamed_mutation::forwarding::yes && rk.last_kind != mutation_fragment::kind::partition_end) {
-                // When in streamed_mutation::forwarding mode we need
-                // to keep track of readers that returned
-                // end-of-stream to know what readers to ff. We can't
-                // just ff all readers as we might drop fragments from
-                // partitions we haven't even read yet.
-                // Readers whoose last emitted fragment was a partition
-                // end are out of data for good for the current range.
-                _halted_readers.push_back(rk);
-            } else if (_fwd_mr == mutation_reader::forwarding::no) {
-                _all_readers.remove_if([mr = rk.reader] (auto& r) { return &r == mr; });
+                push_fragment(rk, std::move(*mfo));
+            } else {
+                reader_out_of_fragments(rk);
             }
         });
     }).then([this] {
@@ -668,6 +697,13 @@ class restricting_mutation_reader : public flat_mutation_reader::impl {
     static const std::size_t new_reader_base_cost{16 * 1024};
 
     future<> create_reader(db::timeout_clock::time_point timeout) {
+        // A read that cannot be admitted right away joins the semaphore's
+        // FIFO queue; the FIFO order is what keeps a steady stream of new
+        // reads from starving the ones already waiting.
+        if (_config.total_queued_reads
+                && (_config.resources_sem->waiters() || _config.resources_sem->available_units() < ssize_t(new_reader_base_cost))) {
+            ++(*_config.total_queued_reads);
+        }
         auto f = timeout != db::no_timeout
                 ? _config.resources_sem->wait(timeout, new_reader_base_cost)
                 : _config.resources_sem->wait(new_reader_base_cost);
@@ -273,6 +273,9 @@ snapshot_source make_empty_snapshot_source();
 struct restricted_mutation_reader_config {
     db::timeout_semaphore* resources_sem = nullptr;
     uint64_t* active_reads = nullptr;
+    // Counts reads that could not be admitted immediately and had to queue
+    // on resources_sem, waiting for other reads to release memory.
+    uint64_t* total_queued_reads = nullptr;
     size_t max_queue_length = std::numeric_limits<size_t>::max();
     std::function<void ()> raise_queue_overloaded_exception = default_raise_queue_overloaded_exception;
 
@@ -212,6 +212,9 @@ class partition_snapshot_flat_reader : public flat_mutation_reader::impl, public
                     if (_digest_requested) {
                         e.row().cells().prepare_hash(_schema, column_kind::regular_column);
                     }
+                    if (_schema.is_counter()) {
+                        e.row().cells().prepare_counter_totals(_schema, column_kind::regular_column);
+                    }
                     auto result = mutation_fragment(mutation_fragment::clustering_row_tag_t(), e);
                     while (has_more_rows() && _eq(peek_row().position(), result.as_clustering_row().position())) {
                         const rows_entry& e = pop_clustering_row();
@@ -228,6 +228,28 @@ public:
     // Must be called under reclaim lock.
     // When throws, the cursor is invalidated and its position is not changed.
     bool advance_to(position_in_partition_view lower_bound) {
+        // When the iterators are still valid and lower_bound is close ahead,
+        // step to it from the current row. In very wide partitions a full
+        // seek descends the row tree of every version from its root, which
+        // is a deep pointer chase; stepping keeps nearby seeks, e.g. between
+        // adjacent clustering ranges of one read, at a few iterator moves.
+        if (iterators_valid() && !_current_row.empty()) {
+            position_in_partition::tri_compare cmp(_schema);
+            auto res = cmp(_position, lower_bound);
+            if (res == 0) {
+                return true;
+            }
+            if (res < 0) {
+                // Bounded, so that a seek to a distant position still uses
+                // the logarithmic descent rather than a linear walk.
+                static constexpr int max_steps = 8;
+                for (int i = 0; i < max_steps && next(); ++i) {
+                    if (cmp(_position, lower_bound) >= 0) {
+                        return no_clustering_row_between(_schema, lower_bound, _position);
+                    }
+                }
+            }
+        }
         prepare_heap(lower_bound);
         _change_mark = _snp.get_change_mark();
         bool found = no_clustering_row_between(_schema, lower_bound, _heap[0].it->position());
@@ -275,6 +297,9 @@ public:
         if (digest_requested) {
             row->row().cells().prepare_hash(_schema, column_kind::regular_column);
         }
+        if (_schema.is_counter()) {
+            row->row().cells().prepare_counter_totals(_schema, column_kind::regular_column);
+        }
         auto mf = mutation_fragment(clustering_row(*row));
         auto& cr = mf.as_mutable_clustering_row();
         for (++it; it != _current_row.end(); ++it) {
@@ -24,6 +24,7 @@
 
 #include "partition_version.hh"
 #include "partition_builder.hh"
+#include "mutation_partition_applier.hh"
 #include "partition_snapshot_row_cursor.hh"
 
 static void remove_or_mark_as_unique_owner(partition_version* current)
@@ -119,6 +120,9 @@ inline Result squashed(const partition_version_ref& v, Map&& map, Reduce&& reduc
                             if (digest_requested) {
                                 mp.static_row().prepare_hash(*_schema, column_kind::static_column);
                             }
+                            if (_schema->is_counter()) {
+                                mp.static_row().prepare_counter_totals(*_schema, column_kind::static_column);
+                            }
                             return mp.static_row();
                          },
                          [this] (row& a, const row& b) { a.apply(*_schema, column_kind::static_column, b); }));
@@ -277,6 +281,20 @@ void partition_entry::apply(const schema& s, mutation_partition&& mp, const sche
 
 void partition_entry::apply(const schema& s, mutation_partition_view mpv, const schema& mp_schema)
 {
+    if (!_snapshot && s.version() == mp_schema.version()) {
+        // Fast path for replicated writes: merge the serialized
+        // representation straight into the current version instead of
+        // materializing an intermediate mutation_partition first. Cells
+        // land directly in rows allocated from the current (LSA) region.
+        // Weak exception guarantees, which is fine here: all the merges
+        // the applier performs are idempotent, so when the enclosing
+        // allocating section retries after a mid-apply failure the result
+        // converges. With snapshots around we still need the intermediate
+        // partition to keep the versioned sum intact on exception.
+        mutation_partition_applier applier(s, _version->partition());
+        mpv.accept(s, applier);
+        return;
+    }
     mutation_partition mp(mp_schema.shared_from_this());
     partition_builder pb(mp_schema, mp);
     mpv.accept(mp_schema, pb);
@@ -100,7 +100,7 @@ constexpr auto max_rows = std::numeric_limits<uint32_t>::max();
 class partition_slice {
 public:
     enum class option { send_clustering_key, send_partition_key, send_timestamp, send_expiry, reversed, distinct, collections_as_maps, send_ttl,
-                        allow_short_read, with_digest };
+                        allow_short_read, with_digest, bypass_cache };
     using option_set = enum_set<super_enum<option,
         option::send_clustering_key,
         option::send_partition_key,
@@ -111,7 +111,8 @@ public:
         option::collections_as_maps,
         option::send_ttl,
         option::allow_short_read,
-        option::with_digest>>;
+        option::with_digest,
+        option::bypass_cache>>;
     clustering_row_ranges _row_ranges;
 public:
     std::vector<column_id> static_columns; // TODO: consider using bitmap
@@ -83,6 +83,7 @@ void result_set_builder::accept_new_partition(const partition_key& key, uint32_t
 void result_set_builder::accept_new_partition(uint32_t row_count)
 {
     _row_count = row_count;
+    _rows.reserve(_rows.size() + row_count);
 }
 
 void result_set_builder::accept_new_row(const clustering_key& key, const result_row_view& static_row, const result_row_view& row)
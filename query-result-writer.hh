@@ -130,9 +130,20 @@ class result::builder {
     short_read _short_read;
     digester _digest;
     result_memory_accounter _memory_accounter;
+private:
+    static bytes_ostream make_reserved(size_t size) {
+        bytes_ostream out;
+        out.reserve(size);
+        return out;
+    }
 public:
-    builder(const partition_slice& slice, result_options options, result_memory_accounter memory_accounter)
-        : _slice(slice)
+    // reserve_size is a hint about the expected size of the result; when
+    // non-zero the output buffer starts with a chunk big enough for that
+    // many bytes instead of being grown chunk by chunk as the result is
+    // serialized.
+    builder(const partition_slice& slice, result_options options, result_memory_accounter memory_accounter, size_t reserve_size = 0)
+        : _out(make_reserved(reserve_size))
+        , _slice(slice)
         , _w(ser::writer_of_query_result<bytes_ostream>(_out).start_partitions())
         , _request(options.request)
         , _digest(digester(options.digest_algo))
@@ -162,7 +173,10 @@ public:
         // fetch the row range for this partition already.
         auto& ranges = _slice.row_ranges(s, key);
         auto after_key = [this, pw = _w.add(), &key] () mutable {
-            if (_slice.options.contains<partition_slice::option::send_partition_key>()) {
+            // Digest-only results are discarded in build(), so don't bother
+            // serializing keys into them; the digest hashes the key directly.
+            if (_request != result_request::only_digest
+                    && _slice.options.contains<partition_slice::option::send_partition_key>()) {
                 return std::move(pw).write_key(key);
             } else {
                 return std::move(pw).skip_key();
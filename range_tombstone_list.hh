@@ -75,6 +75,16 @@ class range_tombstone_list final {
         void cancel() noexcept {
             _ops.clear();
         }
+    private:
+        // Makes sure the next emplace_back() cannot throw, so that an op can
+        // be recorded after its mutation was made. Grows geometrically, since
+        // reserving for exactly one more element at a time makes recording n
+        // ops quadratic when a tombstone overlaps many existing ones.
+        void reserve_one_op() {
+            if (_ops.size() == _ops.capacity()) {
+                _ops.reserve(std::max<size_t>(8, _ops.capacity() * 2));
+            }
+        }
     };
     class nop_reverter : public reverter {
     public:
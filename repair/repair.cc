@@ -71,6 +71,9 @@ public:
     size_t current_sub_ranges_nr_in = 0;
     size_t current_sub_ranges_nr_out = 0;
     int ranges_index = 0;
+    // How many of this shard's token ranges may be repaired in parallel
+    // (the user's jobThreads setting).
+    size_t ranges_parallelism;
     // Only allow one stream_plan in flight
     semaphore sp_parallelism_semaphore{1};
     lw_shared_ptr<streaming::stream_plan> _sp_in;
@@ -82,7 +85,8 @@ public:
             const std::vector<sstring>& cfs_,
             int id_,
             const std::vector<sstring>& data_centers_,
-            const std::vector<sstring>& hosts_)
+            const std::vector<sstring>& hosts_,
+            size_t ranges_parallelism_)
         : db(db_)
         , keyspace(keyspace_)
         , ranges(ranges_)
@@ -90,7 +94,8 @@ public:
         , id(id_)
         , shard(engine().cpu_id())
         , data_centers(data_centers_)
-        , hosts(hosts_) {
+        , hosts(hosts_)
+        , ranges_parallelism(ranges_parallelism_) {
     }
     future<> do_streaming() {
         size_t ranges_in = 0;
@@ -663,6 +668,171 @@ std::ostream& operator<<(std::ostream& out, const partition_checksum& c) {
     return out;
 }
 
+// Cache of the last computed checksum of each sub-range, together with a
+// fingerprint of the column family state it was computed from. Periodic
+// repairs mostly visit data which did not change since the previous run,
+// and both the repair master and the repair slave compute their checksums
+// with checksum_range_shard() below, so when the fingerprint still matches
+// on both sides we can answer from the cache without re-reading anything,
+// making repair cost proportional to churn rather than to data size.
+//
+// The fingerprint is correct because all of its inputs only move forward:
+// the write counter and sstable generations are monotonic, so once the
+// content of a column family changes, its old fingerprint can never be
+// observed again and a stale cache entry can never match.
+class range_checksum_cache {
+public:
+    struct cf_fingerprint {
+        uint64_t writes = 0;
+        bool memtable_empty = true;
+        table_schema_version schema_version;
+        std::vector<int64_t> generations;
+        bool operator==(const cf_fingerprint& other) const {
+            return writes == other.writes
+                && memtable_empty == other.memtable_empty
+                && schema_version == other.schema_version
+                && generations == other.generations;
+        }
+    };
+private:
+    struct entry {
+        cf_fingerprint fingerprint;
+        repair_checksum version;
+        partition_checksum checksum;
+    };
+    std::unordered_map<sstring, entry> _entries;
+    // A repair of a big table creates one entry per sub-range. Rather than
+    // maintaining an LRU for what is a small per-entry footprint, just drop
+    // everything in the unlikely event the map grows out of proportion.
+    static constexpr size_t max_entries = 1024 * 1024;
+public:
+    static cf_fingerprint fingerprint(column_family& cf) {
+        cf_fingerprint fp;
+        fp.writes = cf.get_stats().writes.hist.count;
+        fp.memtable_empty = cf.active_memtable().empty();
+        fp.schema_version = cf.schema()->version();
+        for (auto& sst : *cf.get_sstables()) {
+            fp.generations.push_back(sst->generation());
+        }
+        boost::sort(fp.generations);
+        return fp;
+    }
+    static sstring make_key(const sstring& keyspace, const sstring& cf, const dht::partition_range_vector& prs) {
+        auto key = keyspace + "." + cf;
+        for (auto& pr : prs) {
+            key += sprint(":%s", pr);
+        }
+        return key;
+    }
+    stdx::optional<partition_checksum> find(const sstring& key, const cf_fingerprint& fp, repair_checksum version) {
+        auto it = _entries.find(key);
+        if (it == _entries.end() || it->second.version != version || !(it->second.fingerprint == fp)) {
+            return stdx::nullopt;
+        }
+        return it->second.checksum;
+    }
+    void store(sstring key, cf_fingerprint fp, repair_checksum version, const partition_checksum& checksum) {
+        if (_entries.size() >= max_entries) {
+            _entries.clear();
+        }
+        _entries[std::move(key)] = entry{std::move(fp), version, checksum};
+    }
+};
+
+static thread_local range_checksum_cache checksum_cache;
+
+// Digests of individual sstables are cached separately, keyed by sstable
+// generation. Unlike the whole-range entries above, which die whenever the
+// column family's fingerprint moves, an sstable is immutable so these entries
+// never go stale - they survive the flushes and compactions which change the
+// sstable set. When a sub-range can be decomposed into per-sstable reads (see
+// disjoint_sstables_for_range() below), only sstables we have not digested
+// before need to be read from disk, so the next repair after a flush or a
+// compaction re-reads just the new sstables instead of the whole range.
+class sstable_checksum_cache {
+    struct entry {
+        repair_checksum version;
+        partition_checksum checksum;
+    };
+    std::unordered_map<sstring, entry> _entries;
+    // See the eviction note on range_checksum_cache above.
+    static constexpr size_t max_entries = 1024 * 1024;
+public:
+    static sstring make_key(int64_t generation, const sstring& range_key) {
+        return sprint("%d:%s", generation, range_key);
+    }
+    stdx::optional<partition_checksum> find(const sstring& key, repair_checksum version) const {
+        auto it = _entries.find(key);
+        if (it == _entries.end() || it->second.version != version) {
+            return stdx::nullopt;
+        }
+        return it->second.checksum;
+    }
+    void store(sstring key, repair_checksum version, const partition_checksum& checksum) {
+        if (_entries.size() >= max_entries) {
+            _entries.clear();
+        }
+        _entries[std::move(key)] = entry{version, checksum};
+    }
+};
+
+static thread_local sstable_checksum_cache sstable_checksum_cache_instance;
+
+// Per-partition digests are XOR'ed together (see partition_checksum::add), so
+// the checksum of a range equals the XOR of the checksums of any partitioning
+// of its data - as long as every partition is hashed exactly once, whole.
+// That holds when the memtables are empty and the sstables intersecting the
+// range do not overlap in partition key order: every partition then lives
+// entirely in exactly one sstable, and hashing each sstable separately yields
+// the same per-partition digests as hashing the merged stream. Overlapping
+// sstables (or data still in a memtable) would split a partition between
+// sources, and a partition hashed in two pieces digests differently from the
+// merged whole, so in that case we return nothing and the caller falls back
+// to a single merged read.
+static stdx::optional<std::vector<sstables::shared_sstable>>
+disjoint_sstables_for_range(column_family& cf, const dht::partition_range_vector& prs) {
+    if (!cf.memtables_empty()) {
+        return stdx::nullopt;
+    }
+    std::vector<sstables::shared_sstable> ssts;
+    for (auto& pr : prs) {
+        for (auto& sst : cf.select_sstables(pr)) {
+            if (boost::find(ssts, sst) == ssts.end()) {
+                ssts.push_back(std::move(sst));
+            }
+        }
+    }
+    auto& s = *cf.schema();
+    boost::sort(ssts, [&s] (const sstables::shared_sstable& a, const sstables::shared_sstable& b) {
+        return a->get_first_decorated_key().less_compare(s, b->get_first_decorated_key());
+    });
+    for (size_t i = 1; i < ssts.size(); i++) {
+        if (!ssts[i - 1]->get_last_decorated_key().less_compare(s, ssts[i]->get_first_decorated_key())) {
+            return stdx::nullopt;
+        }
+    }
+    return ssts;
+}
+
+// Calculate the checksum of the part of a single sstable which falls into
+// the given ranges. The caller must keep prs alive until the returned future
+// resolves.
+static future<partition_checksum> checksum_sstable_range(column_family& cf,
+        sstables::shared_sstable sst, const dht::partition_range_vector& prs,
+        repair_checksum hash_version) {
+    return do_with(partition_checksum(), std::move(sst), [&cf, &prs, hash_version] (partition_checksum& sum, sstables::shared_sstable& sst) {
+        return do_for_each(prs, [&cf, &sum, &sst, hash_version] (const dht::partition_range& pr) {
+            auto reader = sst->read_range_rows_flat(cf.schema(), pr, cf.schema()->full_slice(),
+                    service::get_local_streaming_read_priority());
+            return partition_checksum::compute(std::move(reader), hash_version).then([&sum] (partition_checksum checksum) {
+                sum.add(checksum);
+            });
+        }).then([&sum] {
+            return sum;
+        });
+    });
+}
+
 // Calculate the checksum of the data held *on this shard* of a column family,
 // in the given token range.
 // All parameters to this function are constant references, and the caller
@@ -676,8 +846,43 @@ static future<partition_checksum> checksum_range_shard(database &db,
         const sstring& keyspace_name, const sstring& cf_name,
         const dht::partition_range_vector& prs, repair_checksum hash_version) {
     auto& cf = db.find_column_family(keyspace_name, cf_name);
+    auto key = range_checksum_cache::make_key(keyspace_name, cf_name, prs);
+    auto fp = range_checksum_cache::fingerprint(cf);
+    if (auto cached = checksum_cache.find(key, fp, hash_version)) {
+        rlogger.debug("Checksum of {} served from cache", key);
+        return make_ready_future<partition_checksum>(*cached);
+    }
+    if (auto ssts = disjoint_sstables_for_range(cf, prs)) {
+        return do_with(std::move(*ssts), partition_checksum(), std::move(key), std::move(fp),
+                [&cf, &prs, hash_version] (auto& ssts, auto& result, auto& key, auto& fp) {
+            return do_for_each(ssts, [&cf, &prs, &result, &key, hash_version] (sstables::shared_sstable& sst) {
+                auto sst_key = sstable_checksum_cache::make_key(sst->generation(), key);
+                if (auto cached = sstable_checksum_cache_instance.find(sst_key, hash_version)) {
+                    result.add(*cached);
+                    return make_ready_future<>();
+                }
+                return checksum_sstable_range(cf, sst, prs, hash_version).then(
+                        [&result, sst_key = std::move(sst_key), hash_version] (partition_checksum checksum) mutable {
+                    sstable_checksum_cache_instance.store(std::move(sst_key), hash_version, checksum);
+                    result.add(checksum);
+                });
+            }).then([&result, &key, &fp, hash_version] {
+                // Also usable next time the whole fingerprint is unchanged,
+                // without touching the per-sstable entries at all.
+                checksum_cache.store(std::move(key), std::move(fp), hash_version, result);
+                return result;
+            });
+        });
+    }
     auto reader = cf.make_streaming_reader(cf.schema(), prs);
-    return partition_checksum::compute(std::move(reader), hash_version);
+    return partition_checksum::compute(std::move(reader), hash_version).then(
+            [key = std::move(key), fp = std::move(fp), hash_version] (partition_checksum checksum) mutable {
+        // The fingerprint was taken before the read; if the data changed
+        // underneath us the entry is inconsistent, but its fingerprint is
+        // also dead (see above) so it can never be served.
+        checksum_cache.store(std::move(key), std::move(fp), hash_version, checksum);
+        return checksum;
+    });
 }
 
 // It is counter-productive to allow a large number of range checksum
@@ -1030,6 +1235,12 @@ struct repair_options {
     // The node starting the repair must be in the data center; Issuing a
     // repair to a data center other than the named one returns an error.
     std::vector<sstring> data_centers;
+    // The number of token ranges each shard repairs concurrently ("nodetool
+    // repair -j"). Repairing a range is mostly waiting for checksums from
+    // the replicas, so allowing a few ranges in flight keeps the shard and
+    // the network busy; disk reads and streaming remain capped by their own
+    // semaphores regardless of this setting.
+    int job_threads = 1;
 
     repair_options(std::unordered_map<sstring, sstring> options) {
         bool_opt(primary_range, options, PRIMARY_RANGE_KEY);
@@ -1062,9 +1273,12 @@ struct repair_options {
         if (trace) {
             throw std::runtime_error("unsupported trace");
         }
-        // Consume, ignore.
-        int job_threads;
         int_opt(job_threads, options, JOB_THREADS_KEY);
+        if (job_threads < 1 || job_threads > MAX_JOB_THREADS) {
+            throw std::runtime_error(sprint(
+                    "unsupported repair jobThreads: %d (must be between 1 and %d)",
+                    job_threads, MAX_JOB_THREADS));
+        }
 
         // The parsing code above removed from the map options we have parsed.
         // If anything is left there in the end, it's an unsupported option.
@@ -1092,6 +1306,8 @@ struct repair_options {
         SEQUENTIAL=0, PARALLEL=1, DATACENTER_AWARE=2
     };
 
+    static constexpr int MAX_JOB_THREADS = 16;
+
 private:
     static void bool_opt(bool& var,
             std::unordered_map<sstring, sstring>& options,
@@ -1182,24 +1398,32 @@ private:
 // same nodes as replicas.
 static future<> repair_ranges(lw_shared_ptr<repair_info> ri) {
     repair_tracker.add_repair_info(ri->id, ri);
-    // repair all the ranges in sequence
-    return do_for_each(ri->ranges, [ri] (auto&& range) {
-        ri->check_in_abort();
-        ri->ranges_index++;
-        rlogger.info("Repair {} out of {} ranges, id={}, shard={}, keyspace={}, table={}, range={}",
-            ri->ranges_index, ri->ranges.size(), ri->id, ri->shard, ri->keyspace, ri->cfs, range);
-        return do_with(dht::selective_token_range_sharder(range, ri->shard), [ri] (auto& sharder) {
-            return repeat([ri, &sharder] () {
-                check_in_shutdown();
+    // Repair the ranges with up to ranges_parallelism of them in flight at
+    // once. Each shard walks its own list independently, so a shard holding
+    // little data for the current range moves on instead of idling, and with
+    // jobThreads > 1 the wait for replica checksums of one range overlaps
+    // with work on the next ones.
+    return do_with(semaphore(ri->ranges_parallelism), [ri] (semaphore& sem) {
+        return parallel_for_each(ri->ranges, [ri, &sem] (auto&& range) {
+            return with_semaphore(sem, 1, [ri, &range] {
                 ri->check_in_abort();
-                auto range_shard = sharder.next();
-                if (range_shard) {
-                    return repair_range(*ri, *range_shard).then([] {
-                        return make_ready_future<stop_iteration>(stop_iteration::no);
+                ri->ranges_index++;
+                rlogger.info("Repair {} out of {} ranges, id={}, shard={}, keyspace={}, table={}, range={}",
+                    ri->ranges_index, ri->ranges.size(), ri->id, ri->shard, ri->keyspace, ri->cfs, range);
+                return do_with(dht::selective_token_range_sharder(range, ri->shard), [ri] (auto& sharder) {
+                    return repeat([ri, &sharder] () {
+                        check_in_shutdown();
+                        ri->check_in_abort();
+                        auto range_shard = sharder.next();
+                        if (range_shard) {
+                            return repair_range(*ri, *range_shard).then([] {
+                                return make_ready_future<stop_iteration>(stop_iteration::no);
+                            });
+                        } else {
+                            return make_ready_future<stop_iteration>(stop_iteration::yes);
+                        }
                     });
-                } else {
-                    return make_ready_future<stop_iteration>(stop_iteration::yes);
-                }
+                });
             });
         });
     }).then([ri] {
@@ -1320,10 +1544,11 @@ static int do_repair_start(seastar::sharded<database>& db, sstring keyspace,
 
     for (auto shard : boost::irange(unsigned(0), smp::count)) {
         auto f = db.invoke_on(shard, [keyspace, cfs, id, ranges,
-                data_centers = options.data_centers, hosts = options.hosts] (database& localdb) mutable {
+                data_centers = options.data_centers, hosts = options.hosts,
+                job_threads = options.job_threads] (database& localdb) mutable {
             auto ri = make_lw_shared<repair_info>(service::get_local_storage_service().db(),
                     std::move(keyspace), std::move(ranges), std::move(cfs),
-                    id, std::move(data_centers), std::move(hosts));
+                    id, std::move(data_centers), std::move(hosts), job_threads);
             return repair_ranges(ri);
         });
         repair_results.push_back(std::move(f));
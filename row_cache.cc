@@ -26,7 +26,9 @@
 #include <seastar/core/metrics.hh>
 #include <seastar/util/defer.hh>
 #include "memtable.hh"
+#include "frozen_mutation.hh"
 #include "partition_snapshot_reader.hh"
+#include <lz4.h>
 #include <chrono>
 #include <boost/version.hpp>
 #include <sys/sdt.h>
@@ -56,9 +58,164 @@ cache_tracker& global_cache_tracker() {
     return instance;
 }
 
+thread_local frozen_partition_cache::lru_type frozen_partition_cache::_lru;
+thread_local size_t frozen_partition_cache::_used_bytes = 0;
+thread_local uint64_t frozen_partition_cache::_partitions = 0;
+
+// Fraction of shard memory the frozen tier may use. Small on purpose - the
+// tier holds evicted data, so it must not crowd out the cache proper.
+static constexpr float frozen_cache_fraction = 0.05;
+
+// Freezing happens synchronously in the eviction path, so don't spend time
+// on partitions whose serialized form is large; they are also the ones for
+// which re-reading from sstables is relatively cheapest per byte.
+static constexpr size_t max_frozen_partition_size = 128 * 1024;
+
+size_t frozen_partition_cache::budget() {
+    static thread_local size_t b = memory::stats().total_memory() * frozen_cache_fraction;
+    return b;
+}
+
+frozen_partition_cache::frozen_partition_cache(schema_ptr s)
+    : _entries(dht::decorated_key::less_comparator(std::move(s)))
+{ }
+
+frozen_partition_cache::~frozen_partition_cache() {
+    clear();
+}
+
+frozen_partition_cache::map_type::iterator frozen_partition_cache::erase(map_type::iterator it) {
+    _used_bytes -= it->second.memory_usage();
+    --_partitions;
+    return _entries.erase(it); // the LRU hook auto-unlinks
+}
+
+void frozen_partition_cache::insert(schema_ptr s, const dht::decorated_key& key, bytes data, size_t uncompressed_size) {
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        erase(it);
+    }
+    auto r = _entries.emplace(std::piecewise_construct,
+            std::forward_as_tuple(key),
+            std::forward_as_tuple(this, std::move(s), std::move(data), uncompressed_size));
+    it = r.first;
+    it->second._key = &it->first;
+    _used_bytes += it->second.memory_usage();
+    ++_partitions;
+    _lru.push_front(it->second);
+    while (_used_bytes > budget() && !_lru.empty()) {
+        entry& victim = _lru.back();
+        victim._owner->erase(victim._owner->_entries.find(*victim._key));
+    }
+}
+
+bool frozen_partition_cache::demote(cache_entry& ce) noexcept {
+    try {
+        // Escape the LSA allocator; everything in this tier lives in
+        // standard allocator memory, outside the region under pressure.
+        return with_allocator(standard_allocator(), [&] {
+          // Reading the evicted partition linearizes any fragmented
+          // managed_bytes it contains, which needs a linearization context
+          // (the evictor provides one, but demotion must not depend on its
+          // caller for correctness). The standard-allocator allocations
+          // below (freeze, LZ4 buffers, insert) can also re-enter reclaim
+          // and compact the cache region, relocating the entry under our
+          // feet, so keep the region locked until the copy is done.
+          return with_linearized_managed_bytes([&] {
+            logalloc::reclaim_lock guard(global_cache_tracker().region());
+            schema_ptr s = ce.schema();
+            mutation m(s, ce.key(), ce.partition().squashed(*s));
+            if (!m.partition().is_fully_continuous()) {
+                // Information about which ranges are missing cannot be
+                // preserved across freezing.
+                return false;
+            }
+            auto fm = freeze(m);
+            const bytes_ostream& repr = fm.representation();
+            if (repr.size() > max_frozen_partition_size) {
+                return false;
+            }
+            bytes raw(bytes::initialized_later(), repr.size());
+            auto pos = raw.begin();
+            for (bytes_view frag : repr) {
+                pos = std::copy(frag.begin(), frag.end(), pos);
+            }
+            auto bound = LZ4_compressBound(raw.size());
+            auto buf = std::make_unique<char[]>(bound);
+            auto len = LZ4_compress_default(reinterpret_cast<const char*>(raw.data()), buf.get(), raw.size(), bound);
+            if (len <= 0) {
+                return false;
+            }
+            insert(std::move(s), ce.key(), bytes(reinterpret_cast<const int8_t*>(buf.get()), len), raw.size());
+            return true;
+          });
+        });
+    } catch (...) {
+        // We're likely running under memory pressure; failing to freeze
+        // simply turns the demotion into a plain eviction.
+        return false;
+    }
+}
+
+mutation frozen_partition_cache::entry::unfreeze() const {
+    bytes raw(bytes::initialized_later(), _uncompressed_size);
+    auto len = LZ4_decompress_safe(reinterpret_cast<const char*>(_data.data()),
+            reinterpret_cast<char*>(raw.data()), _data.size(), _uncompressed_size);
+    if (len < 0 || size_t(len) != _uncompressed_size) {
+        throw std::runtime_error("failed to decompress frozen partition");
+    }
+    bytes_ostream bo;
+    bo.write(bytes_view(raw));
+    return frozen_mutation(std::move(bo)).unfreeze(_schema);
+}
+
+stdx::optional<mutation> frozen_partition_cache::find_and_remove(const dht::decorated_key& key) {
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return stdx::nullopt;
+    }
+    stdx::optional<mutation> m;
+    try {
+        m = it->second.unfreeze();
+    } catch (...) {
+        // Drop the entry; the read falls through to the sstables.
+    }
+    erase(it);
+    return m;
+}
+
+void frozen_partition_cache::erase(const dht::decorated_key& key) {
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        erase(it);
+    }
+}
+
+void frozen_partition_cache::erase(const dht::partition_range& range) {
+    if (_entries.empty()) {
+        return;
+    }
+    auto cmp = dht::ring_position_comparator(*_entries.key_comp().s);
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (range.contains(dht::ring_position(it->first), cmp)) {
+            it = erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void frozen_partition_cache::clear() noexcept {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        it = erase(it);
+    }
+}
+
 cache_tracker::cache_tracker() {
     setup_metrics();
 
+    _region.set_name("cache");
+
     _region.make_evictable([this] {
         return with_allocator(_region.allocator(), [this] {
           // Removing a partition may require reading large keys when we rebalance
@@ -67,9 +224,16 @@ cache_tracker::cache_tracker() {
            try {
             auto evict_last = [this](lru_type& lru) {
                 cache_entry& ce = lru.back();
+                // Unlink from the LRU before demoting: demotion allocates
+                // from the standard allocator, which can re-enter reclaim
+                // and must not pick the same victim again.
+                ce._lru_link.unlink();
+                if (ce._frozen_owner && ce._frozen_owner->demote(ce)) {
+                    ++_stats.partition_demotions;
+                }
                 auto it = row_cache::partitions_type::s_iterator_to(ce);
                 clear_continuity(*std::next(it));
-                lru.pop_back_and_dispose(current_deleter<cache_entry>());
+                current_deleter<cache_entry>()(&ce);
             };
             if (_lru.empty()) {
                 return memory::reclaiming_result::reclaimed_nothing;
@@ -107,6 +271,11 @@ cache_tracker::setup_metrics() {
         sm::make_derive("row_insertions", sm::description("total number of rows added to cache"), _stats.row_insertions),
         sm::make_derive("concurrent_misses_same_key", sm::description("total number of operation with misses same key"), _stats.concurrent_misses_same_key),
         sm::make_derive("partition_merges", sm::description("total number of partitions merged"), _stats.partition_merges),
+        sm::make_derive("cold_merge_invalidations", sm::description("total number of cold partitions invalidated instead of merged on memtable update"), _stats.cold_merge_invalidations),
+        sm::make_derive("partition_demotions", sm::description("total number of evicted partitions frozen into the second cache tier"), _stats.partition_demotions),
+        sm::make_derive("partition_promotions", sm::description("total number of frozen partitions re-expanded into the cache"), _stats.partition_promotions),
+        sm::make_gauge("frozen_partitions", sm::description("current number of partitions in the frozen tier"), [] { return frozen_partition_cache::partitions(); }),
+        sm::make_gauge("frozen_bytes_used", sm::description("current bytes used by the frozen tier"), [] { return frozen_partition_cache::used_bytes(); }),
         sm::make_derive("partition_evictions", sm::description("total number of evicted partitions"), _stats.partition_evictions),
         sm::make_derive("partition_removals", sm::description("total number of invalidated partitions"), _stats.partition_removals),
         sm::make_derive("mispopulations", sm::description("number of entries not inserted by reads"), _stats.mispopulations),
@@ -149,6 +318,11 @@ void cache_tracker::touch(cache_entry& e) {
         lru.push_front(e);
     };
     move_to_front(_lru, e);
+    e._last_touch = ++_touch_counter;
+}
+
+bool cache_tracker::is_hot(const cache_entry& e) const {
+    return _touch_counter - e._last_touch <= _stats.partitions / 2;
 }
 
 void cache_tracker::insert(cache_entry& entry) {
@@ -157,6 +331,7 @@ void cache_tracker::insert(cache_entry& entry) {
     // partition_range_cursor depends on this to detect invalidation of _end
     _region.allocator().invalidate_references();
     _lru.push_front(entry);
+    entry._last_touch = ++_touch_counter;
 }
 
 void cache_tracker::on_erase() {
@@ -169,6 +344,14 @@ void cache_tracker::on_merge() {
     ++_stats.partition_merges;
 }
 
+void cache_tracker::on_cold_merge_invalidation() {
+    ++_stats.cold_merge_invalidations;
+}
+
+void cache_tracker::on_promotion() {
+    ++_stats.partition_promotions;
+}
+
 void cache_tracker::on_partition_hit() {
     ++_stats.partition_hits;
 }
@@ -738,6 +921,9 @@ row_cache::make_reader(schema_ptr s,
     auto ctx = make_lw_shared<read_context>(*this, s, range, slice, pc, trace_state, fwd, fwd_mr);
 
     if (!ctx->is_range_query()) {
+        // A frozen copy of the partition may be waiting in the second tier;
+        // re-expanding it is much cheaper than going to the sstables.
+        promote_from_frozen(ctx->range().start()->value());
         return _read_section(_tracker.region(), [&] {
             return with_linearized_managed_bytes([&] {
                 cache_entry::compare cmp(_schema);
@@ -775,6 +961,7 @@ row_cache::~row_cache() {
 }
 
 void row_cache::clear_now() noexcept {
+    _frozen->clear();
     with_allocator(_tracker.allocator(), [this] {
         auto it = _partitions.erase_and_dispose(_partitions.begin(), partitions_end(), [this, deleter = current_deleter<cache_entry>()] (auto&& p) mutable {
             _tracker.on_erase();
@@ -797,6 +984,7 @@ cache_entry& row_cache::do_find_or_create_entry(const dht::decorated_key& key,
                 auto i = _partitions.lower_bound(key, cache_entry::compare(_schema));
                 if (i == _partitions.end() || !i->key().equal(*_schema, key)) {
                     i = create_entry(i);
+                    i->_frozen_owner = _frozen.get();
                 } else {
                     visit_entry(i);
                 }
@@ -959,6 +1147,28 @@ future<> row_cache::do_update(external_updater eu, memtable& m, Updater updater)
                 {
                     _update_section(_tracker.region(), [&] {
                         STAP_PROBE(scylla, row_cache_update_one_batch_start);
+                        // Memtable entries are visited in ring order, so each
+                        // lookup lands at or after the previous one. Resume the
+                        // search from the previous position and only fall back
+                        // to a full descent when the gap is large. Nothing else
+                        // modifies the tree within a batch, so the hint stays
+                        // valid until we yield.
+                        stdx::optional<partitions_type::iterator> hint;
+                        auto lower_bound_hinted = [&] (const dht::decorated_key& key) {
+                            constexpr int max_hint_steps = 8;
+                            if (!hint) {
+                                return _partitions.lower_bound(key, cmp);
+                            }
+                            auto i = *hint;
+                            int steps = 0;
+                            while (i != _partitions.end() && cmp(*i, key)) {
+                                if (++steps > max_hint_steps) {
+                                    return _partitions.lower_bound(key, cmp);
+                                }
+                                ++i;
+                            }
+                            return i;
+                        };
                         // FIXME: we should really be checking should_yield() here instead of
                         // need_preempt(). However, should_yield() is currently quite
                         // expensive and we need to amortize it somehow.
@@ -968,11 +1178,17 @@ future<> row_cache::do_update(external_updater eu, memtable& m, Updater updater)
                           with_linearized_managed_bytes([&] {
                            {
                             memtable_entry& mem_e = *i;
+                            // Whatever is frozen for this key predates the
+                            // memtable and must not resurface.
+                            _frozen->erase(mem_e.key());
                             auto size_entry = mem_e.size_in_allocator(_tracker.allocator());
 
-                            // FIXME: Optimize knowing we lookup in-order.
-                            auto cache_i = _partitions.lower_bound(mem_e.key(), cmp);
+                            auto cache_i = lower_bound_hinted(mem_e.key());
                             updater(cache_i, mem_e, is_present);
+                            // Entries the updater inserted sit right before
+                            // cache_i and carry the current key, so everything
+                            // before cache_i still sorts below the next key.
+                            hint = cache_i;
                             real_dirty_acc.unpin_memory(size_entry);
                             i = m.partitions.erase(i);
                             current_allocator().destroy(&mem_e);
@@ -1006,14 +1222,27 @@ future<> row_cache::update(external_updater eu, memtable& m) {
         if (cache_i != partitions_end() && cache_i->key().equal(*_schema, mem_e.key())) {
             cache_entry& entry = *cache_i;
             upgrade_entry(entry);
-            entry.partition().apply_to_incomplete(*_schema, std::move(mem_e.partition()), *mem_e.schema(), _tracker.region());
-            _tracker.touch(entry);
-            _tracker.on_merge();
+            if (_tracker.is_hot(entry)) {
+                entry.partition().apply_to_incomplete(*_schema, std::move(mem_e.partition()), *mem_e.schema(), _tracker.region());
+                _tracker.touch(entry);
+                _tracker.on_merge();
+            } else {
+                // A full merge into a cold entry pays for moving rows which
+                // will likely be evicted before they are read again. Evict
+                // the cached rows instead, as update_invalidating() does,
+                // and apply into the now-empty entry; a later read
+                // repopulates from the just-flushed sstable. The entry is
+                // deliberately not promoted in the LRU.
+                entry.partition().evict();
+                entry.partition().apply_to_incomplete(*_schema, std::move(mem_e.partition()), *mem_e.schema(), _tracker.region());
+                _tracker.on_cold_merge_invalidation();
+            }
         } else if (cache_i->continuous() || is_present(mem_e.key()) == partition_presence_checker_result::definitely_doesnt_exist) {
             // Partition is absent in underlying. First, insert a neutral partition entry.
             cache_entry* entry = current_allocator().construct<cache_entry>(cache_entry::evictable_tag(),
                 _schema, dht::decorated_key(mem_e.key()),
                 partition_entry::make_evictable(*_schema, mutation_partition(_schema)));
+            entry->_frozen_owner = _frozen.get();
             entry->set_continuous(cache_i->continuous());
             _tracker.insert(*entry);
             _partitions.insert(cache_i, *entry);
@@ -1043,6 +1272,42 @@ void row_cache::refresh_snapshot() {
     _underlying = _snapshot_source();
 }
 
+void row_cache::promote_from_frozen(const dht::ring_position& pos) {
+    if (_frozen->empty() || !pos.has_key()) {
+        return;
+    }
+    if (_prev_snapshot) {
+        // Update in progress. populate() is not aware of population phases,
+        // so promoting now could insert an entry which the update process
+        // no longer reaches. The miss will go to the sstables instead; the
+        // frozen entry stays coherent because do_update() erases the keys
+        // it processes.
+        return;
+    }
+    auto dk = pos.as_decorated_key();
+    bool present = _read_section(_tracker.region(), [&] {
+        return with_linearized_managed_bytes([&] {
+            return _partitions.find(dk, cache_entry::compare(_schema)) != _partitions.end();
+        });
+    });
+    if (present) {
+        // A scanning read repopulated the entry since it was frozen; the
+        // live entry is always at least as recent.
+        _frozen->erase(dk);
+        return;
+    }
+    auto m = _frozen->find_and_remove(dk);
+    if (!m) {
+        return;
+    }
+    try {
+        populate(*m);
+        _tracker.on_promotion();
+    } catch (...) {
+        // Failing to promote is just a cache miss.
+    }
+}
+
 void row_cache::touch(const dht::decorated_key& dk) {
  _read_section(_tracker.region(), [&] {
   with_linearized_managed_bytes([&] {
@@ -1055,6 +1320,7 @@ void row_cache::touch(const dht::decorated_key& dk) {
 }
 
 void row_cache::invalidate_locked(const dht::decorated_key& dk) {
+    _frozen->erase(dk);
     auto pos = _partitions.lower_bound(dk, cache_entry::compare(_schema));
     if (pos == partitions_end() || !pos->key().equal(*_schema, dk)) {
         _tracker.clear_continuity(*pos);
@@ -1096,6 +1362,8 @@ void row_cache::evict(const dht::partition_range& range) {
 void row_cache::invalidate_unwrapped(const dht::partition_range& range) {
     logalloc::reclaim_lock _(_tracker.region());
 
+    _frozen->erase(range);
+
     auto cmp = cache_entry::compare(_schema);
     auto begin = _partitions.lower_bound(dht::ring_position_view::for_range_start(range), cmp);
     auto end = _partitions.lower_bound(dht::ring_position_view::for_range_end(range), cmp);
@@ -1115,6 +1383,7 @@ row_cache::row_cache(schema_ptr s, snapshot_source src, cache_tracker& tracker,
     , _partitions(cache_entry::compare(_schema))
     , _underlying(src())
     , _snapshot_source(std::move(src))
+    , _frozen(std::make_unique<frozen_partition_cache>(_schema))
 {
     with_allocator(_tracker.allocator(), [this, cont] {
         cache_entry* entry = current_allocator().construct<cache_entry>(cache_entry::dummy_entry_tag());
@@ -1128,6 +1397,8 @@ cache_entry::cache_entry(cache_entry&& o) noexcept
     , _key(std::move(o._key))
     , _pe(std::move(o._pe))
     , _flags(o._flags)
+    , _last_touch(o._last_touch)
+    , _frozen_owner(o._frozen_owner)
     , _lru_link()
     , _cache_link()
 {
@@ -23,6 +23,7 @@
 
 #include <boost/intrusive/list.hpp>
 #include <boost/intrusive/set.hpp>
+#include <map>
 
 #include "core/memory.hh"
 #include <seastar/core/thread.hh>
@@ -43,6 +44,7 @@ namespace bi = boost::intrusive;
 
 class row_cache;
 class memtable_entry;
+class frozen_partition_cache;
 
 namespace cache {
 
@@ -75,6 +77,12 @@ class cache_entry {
         bool _continuous : 1;
         bool _dummy_entry : 1;
     } _flags{};
+    // Value of the tracker's touch counter when this entry was last touched.
+    // Used by cache_tracker::is_hot() to approximate the entry's LRU position.
+    uint64_t _last_touch = 0;
+    // The frozen tier of the owning cache, so that the entry can be demoted
+    // into it on eviction. Not set for dummy entries.
+    frozen_partition_cache* _frozen_owner = nullptr;
     lru_link_type _lru_link;
     cache_link_type _cache_link;
     friend class size_calculator;
@@ -83,6 +91,7 @@ class cache_entry {
 public:
     friend class row_cache;
     friend class cache_tracker;
+    friend class frozen_partition_cache;
 
     struct dummy_entry_tag{};
     struct incomplete_tag{};
@@ -175,6 +184,75 @@ public:
     friend std::ostream& operator<<(std::ostream&, cache_entry&);
 };
 
+// Second tier of the cache, holding partitions evicted from the cache proper
+// in a compact, compressed form.
+//
+// When memory pressure forces the cache to evict its least recently used
+// entry, the partition is often still warmer than anything in the sstables.
+// Instead of dropping it, the owning cache squashes the entry into a
+// frozen_mutation, compresses it with LZ4 and parks the bytes here, in
+// standard allocator memory outside the LSA region which is being reclaimed.
+// A later single-partition read which misses in the cache proper checks this
+// tier first and, on a hit, re-expands the partition back into the cache
+// instead of going to the sstables.
+//
+// The tier is bounded by a per-shard byte budget shared between all tables;
+// once full, the least recently frozen entries are dropped for good. Entries
+// are removed on the same events which remove live cache entries, so a frozen
+// partition always reflects the underlying mutation source.
+class frozen_partition_cache final {
+    using lru_link_type = bi::list_member_hook<bi::link_mode<bi::auto_unlink>>;
+    class entry {
+        friend class frozen_partition_cache;
+        frozen_partition_cache* _owner;
+        const dht::decorated_key* _key = nullptr; // points at the map node's key
+        schema_ptr _schema; // the schema the partition was frozen with
+        bytes _data; // LZ4-compressed frozen_mutation representation
+        size_t _uncompressed_size;
+        lru_link_type _lru_link;
+    public:
+        entry(frozen_partition_cache* owner, schema_ptr s, bytes data, size_t uncompressed_size)
+            : _owner(owner)
+            , _schema(std::move(s))
+            , _data(std::move(data))
+            , _uncompressed_size(uncompressed_size)
+        { }
+        size_t memory_usage() const { return sizeof(entry) + _data.size(); }
+        mutation unfreeze() const;
+    };
+    using lru_type = bi::list<entry,
+        bi::member_hook<entry, lru_link_type, &entry::_lru_link>,
+        bi::constant_time_size<false>>; // we need this to have bi::auto_unlink on hooks.
+    using map_type = std::map<dht::decorated_key, entry, dht::decorated_key::less_comparator>;
+private:
+    map_type _entries;
+    // The LRU and the budget are shared by all tables on the shard.
+    static thread_local lru_type _lru;
+    static thread_local size_t _used_bytes;
+    static thread_local uint64_t _partitions;
+private:
+    map_type::iterator erase(map_type::iterator);
+    void insert(schema_ptr, const dht::decorated_key&, bytes data, size_t uncompressed_size);
+public:
+    explicit frozen_partition_cache(schema_ptr);
+    ~frozen_partition_cache();
+    static size_t budget();
+    static size_t used_bytes() { return _used_bytes; }
+    static uint64_t partitions() { return _partitions; }
+    bool empty() const { return _entries.empty(); }
+    // Freezes and stores the entry's partition. Returns false when the
+    // partition cannot be represented (incomplete, too large) or when
+    // freezing fails; the caller then falls back to plain eviction.
+    // May evict the least recently frozen partitions to stay in budget.
+    bool demote(cache_entry&) noexcept;
+    // Removes the frozen partition for given key and returns it re-expanded,
+    // or nullopt when there isn't one.
+    stdx::optional<mutation> find_and_remove(const dht::decorated_key&);
+    void erase(const dht::decorated_key&);
+    void erase(const dht::partition_range&);
+    void clear() noexcept;
+};
+
 // Tracks accesses and performs eviction of cache entries.
 class cache_tracker final {
 public:
@@ -207,6 +285,9 @@ public:
         uint64_t reads_with_misses;
         uint64_t reads_done;
         uint64_t pinned_dirty_memory_overload;
+        uint64_t cold_merge_invalidations;
+        uint64_t partition_demotions;
+        uint64_t partition_promotions;
 
         uint64_t active_reads() const {
             return reads - reads_done;
@@ -217,6 +298,9 @@ private:
     seastar::metrics::metric_groups _metrics;
     logalloc::region _region;
     lru_type _lru;
+    // Incremented on every touch()/insert(); recorded in each entry so that
+    // is_hot() can approximate an entry's LRU position without a list walk.
+    uint64_t _touch_counter = 0;
 private:
     void setup_metrics();
 public:
@@ -226,8 +310,13 @@ public:
     void touch(cache_entry&);
     void insert(cache_entry&);
     void clear_continuity(cache_entry& ce);
+    // True when the entry was touched within the last partitions()/2
+    // touches, approximating being in the front half of the LRU.
+    bool is_hot(const cache_entry&) const;
     void on_erase();
     void on_merge();
+    void on_cold_merge_invalidation();
+    void on_promotion();
     void on_partition_hit();
     void on_partition_miss();
     void on_row_hit();
@@ -240,6 +329,17 @@ public:
     const logalloc::region& region() const;
     uint64_t partitions() const { return _stats.partitions; }
     const stats& get_stats() const { return _stats; }
+    // Invokes func for evictable entries, the most recently used first,
+    // until func returns stop_iteration::yes or entries run out. func must
+    // not yield and must not modify the cache.
+    template<typename Func>
+    void foreach_entry_in_lru_order(Func&& func) {
+        for (cache_entry& e : _lru) {
+            if (func(e) == stop_iteration::yes) {
+                break;
+            }
+        }
+    }
 };
 
 // Returns a reference to shard-wide cache_tracker.
@@ -333,6 +433,9 @@ private:
     logalloc::allocating_section _update_section;
     logalloc::allocating_section _populate_section;
     logalloc::allocating_section _read_section;
+    // The frozen tier, fed by LRU eviction. Held by pointer so that entries
+    // can keep a back-pointer to it across moves of the row_cache object.
+    std::unique_ptr<frozen_partition_cache> _frozen;
     flat_mutation_reader create_underlying_reader(cache::read_context&, mutation_source&, const dht::partition_range&);
     flat_mutation_reader make_scanning_reader(const dht::partition_range&, lw_shared_ptr<cache::read_context>);
     void on_partition_hit();
@@ -342,6 +445,9 @@ private:
     void on_row_insert();
     void on_mispopulate();
     void upgrade_entry(cache_entry&);
+    // Re-expands the frozen partition for given position into the cache,
+    // if there is one. No-op for positions without a key.
+    void promote_from_frozen(const dht::ring_position& pos);
     void invalidate_locked(const dht::decorated_key&);
     void invalidate_unwrapped(const dht::partition_range&);
     void clear_now() noexcept;
@@ -23,6 +23,7 @@
 
 #include "serializer.hh"
 #include <seastar/util/bool_class.hh>
+#include <functional>
 
 namespace ser {
 
@@ -37,6 +38,42 @@ void set_size(Stream& os, const T& obj) {
 }
 
 
+// A non-final object is prefixed with its serialized size so that older
+// versions can skip fields they don't know about. The generic way to learn
+// the size is to serialize the object into a measuring stream first, which
+// walks every object twice (and nested non-final objects many more times).
+// Outputs which support placeholders get a single-pass path instead: the
+// size slot is reserved up front and backpatched once the members have been
+// written. Generated serializers bracket the members with
+// start_frame()/frame.end().
+struct generic_sized_frame {
+    template<typename Output>
+    void end(Output&) { }
+};
+
+template<typename T, typename Output>
+inline generic_sized_frame start_frame(Output& out, const T& obj) {
+    set_size(out, obj);
+    return {};
+}
+
+struct bytes_ostream_sized_frame {
+    bytes_ostream::position start;
+    bytes_ostream::place_holder<size_type> ph;
+    void end(bytes_ostream& out) {
+        // The size prefix counts itself, and start was taken before the
+        // placeholder was allocated, so written_since() is exactly it.
+        auto stream = ph.get_stream();
+        serialize(stream, out.written_since(start));
+    }
+};
+
+template<typename T>
+inline bytes_ostream_sized_frame start_frame(bytes_ostream& out, const T&) {
+    auto pos = out.pos();
+    return { pos, out.write_place_holder<size_type>() };
+}
+
 template<typename Output>
 void safe_serialize_as_uint32(Output& out, uint64_t data) {
     if (data > std::numeric_limits<uint32_t>::max()) {
@@ -423,6 +460,18 @@ struct serializer<std::unique_ptr<T>> {
     }
 };
 
+// Serializes the referenced object as if it was passed by value, so that a
+// sender can serialize straight from an object it doesn't own without copying
+// it first. Write-only: there is nothing for a reference to bind to on the
+// read side, so receivers deserialize the referenced type itself.
+template<typename T>
+struct serializer<std::reference_wrapper<T>> {
+    template<typename Output>
+    static void write(Output& out, const std::reference_wrapper<T>& v) {
+        serialize(out, v.get());
+    }
+};
+
 template<typename Enum>
 struct serializer<enum_set<Enum>> {
     template<typename Input>
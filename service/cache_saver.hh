@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "database.hh"
+#include "core/timer.hh"
+#include "core/sharded.hh"
+
+namespace service {
+
+// Periodically dumps the hottest partition keys of this shard's row cache
+// to saved_caches_directory and, on startup, replays reads for the keys
+// saved by the previous run, so that after a restart the cache reaches a
+// useful hit rate in minutes instead of refilling one miss at a time.
+// Enabled by setting row_cache_save_period to a non-zero number of seconds.
+class cache_saver : public seastar::async_sharded_service<cache_saver> {
+    seastar::sharded<database>& _db;
+    timer<lowres_clock> _timer;
+    future<> _done = make_ready_future<>();
+    bool _stopped = false;
+
+    sstring saved_keys_file() const;
+    future<> save_keys();
+    future<> replay_saved_keys();
+    future<> warm_partition(utils::UUID cf_id, bytes key);
+public:
+    explicit cache_saver(seastar::sharded<database>& db);
+    // Kicks off cache warming from the previous dump, if one exists, and
+    // arms the periodic key dump. Must be called on each shard, after
+    // sstables have been loaded.
+    void start();
+    future<> stop();
+};
+
+}
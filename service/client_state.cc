@@ -261,6 +261,7 @@ service::client_state::client_state(service::client_state::request_copy_tag, con
         , _remote_address(orig._remote_address)
         , _auth_service(local_auth_service_copy(orig))
         , _request_ts(ts)
+        , _workload_group(orig._workload_group)
 {
     assert(!orig._trace_state_ptr);
 }
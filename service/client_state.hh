@@ -121,6 +121,12 @@ private:
     // Only set for "request copy"
     stdx::optional<api::timestamp_type> _request_ts;
 
+    // Scheduling group of the workload group configured for the
+    // authenticated role, if any. Statements executed on behalf of this
+    // client run inside it, so that tenants compete for reactor time at
+    // the configured ratios.
+    stdx::optional<seastar::scheduling_group> _workload_group;
+
 public:
     struct internal_tag {};
     struct external_tag {};
@@ -146,6 +152,14 @@ public:
         _auth_state = new_state;
     }
 
+    void set_workload_group(seastar::scheduling_group sg) noexcept {
+        _workload_group = sg;
+    }
+
+    const stdx::optional<seastar::scheduling_group>& get_workload_group() const noexcept {
+        return _workload_group;
+    }
+
     /// \brief A cross-shard copy-constructor.
     /// Copies everything that may be copied on the remote shard (e.g. _user is out since it's a shared_ptr).
     /// The created copy of the original client state that may be safely used in the specific request handling flow.
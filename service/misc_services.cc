@@ -40,9 +40,15 @@
 
 #include "load_broadcaster.hh"
 #include "cache_hitrate_calculator.hh"
+#include "cache_saver.hh"
 #include "db/system_keyspace.hh"
 #include "gms/application_state.hh"
 #include "service/storage_service.hh"
+#include "service/priority_manager.hh"
+#include "core/fstream.hh"
+#include <seastar/core/byteorder.hh>
+#include "utils/logalloc.hh"
+#include "utils/managed_bytes.hh"
 
 namespace service {
 
@@ -179,4 +185,161 @@ future<> cache_hitrate_calculator::stop() {
     return make_ready_future<>();
 }
 
+// cache_saver implementation
+static logging::logger cslogger("cache_saver");
+
+// Bounds the dump when row_cache_keys_to_save is left at 0, both to keep
+// the file small and to keep the non-yielding LRU walk short.
+static constexpr size_t default_row_cache_keys_to_save = 16384;
+
+cache_saver::cache_saver(seastar::sharded<database>& db)
+        : _db(db)
+        , _timer([this] {
+            _done = _done.then([this] {
+                return save_keys();
+            }).handle_exception([this] (auto ep) {
+                cslogger.warn("Failed to save row cache keys to {}: {}", saved_keys_file(), ep);
+            });
+        })
+{}
+
+void cache_saver::start() {
+    auto period = _db.local().get_config().row_cache_save_period();
+    if (!period) {
+        return;
+    }
+    _done = replay_saved_keys();
+    _timer.arm_periodic(std::chrono::seconds(period));
+}
+
+future<> cache_saver::stop() {
+    _timer.cancel();
+    _stopped = true;
+    return std::move(_done);
+}
+
+sstring cache_saver::saved_keys_file() const {
+    return sprint("%s/row_cache-keys-%u.db", _db.local().get_config().saved_caches_directory(), engine().cpu_id());
+}
+
+future<> cache_saver::save_keys() {
+    struct saved_key {
+        utils::UUID cf_id;
+        bytes key;
+    };
+    auto keys = make_lw_shared<std::vector<saved_key>>();
+    size_t limit = _db.local().get_config().row_cache_keys_to_save();
+    if (!limit) {
+        limit = default_row_cache_keys_to_save;
+    }
+    keys->reserve(limit);
+    // Copying keys out linearizes LSA-managed bytes, which requires a
+    // linearization context, and allocates from the standard allocator,
+    // which may trigger reclaim and evict entries from the very LRU being
+    // walked. Lock the cache region against reclaim for the duration.
+    with_linearized_managed_bytes([&] {
+        logalloc::reclaim_lock guard(global_cache_tracker().region());
+        global_cache_tracker().foreach_entry_in_lru_order([&] (cache_entry& e) {
+            if (e.is_dummy_entry()) {
+                return stop_iteration::no;
+            }
+            keys->emplace_back(saved_key{e.schema()->id(), to_bytes(e.key().key().representation())});
+            return stop_iteration(keys->size() >= limit);
+        });
+    });
+    auto tmp = saved_keys_file() + ".tmp";
+    return open_file_dma(tmp, open_flags::wo | open_flags::create | open_flags::truncate).then([keys] (file f) {
+        auto out = make_lw_shared<output_stream<char>>(make_file_output_stream(std::move(f)));
+        return do_for_each(*keys, [out] (saved_key& sk) {
+            // Each record is the table id (two big-endian 64-bit halves),
+            // the key length (big-endian 32-bit) and the key bytes.
+            char header[20];
+            write_be<int64_t>(header, sk.cf_id.get_most_significant_bits());
+            write_be<int64_t>(header + 8, sk.cf_id.get_least_significant_bits());
+            write_be<uint32_t>(header + 16, sk.key.size());
+            return out->write(header, sizeof(header)).then([out, &sk] {
+                return out->write(reinterpret_cast<const char*>(sk.key.data()), sk.key.size());
+            });
+        }).then([out] {
+            return out->flush();
+        }).finally([out, keys] {
+            return out->close();
+        });
+    }).then([this, tmp] {
+        return rename_file(tmp, saved_keys_file());
+    }).then([this] {
+        return sync_directory(_db.local().get_config().saved_caches_directory());
+    }).then([this, keys] {
+        cslogger.debug("Saved {} row cache keys to {}", keys->size(), saved_keys_file());
+    });
+}
+
+future<> cache_saver::replay_saved_keys() {
+    return file_exists(saved_keys_file()).then([this] (bool exists) {
+        if (!exists) {
+            return make_ready_future<>();
+        }
+        return open_file_dma(saved_keys_file(), open_flags::ro).then([this] (file f) {
+            auto in = make_lw_shared<input_stream<char>>(make_file_input_stream(std::move(f)));
+            auto count = make_lw_shared<size_t>(0);
+            return repeat([this, in, count] {
+                if (_stopped) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
+                return in->read_exactly(20).then([this, in, count] (temporary_buffer<char> header) {
+                    if (header.size() < 20) {
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    }
+                    auto msb = read_be<int64_t>(header.get());
+                    auto lsb = read_be<int64_t>(header.get() + 8);
+                    auto len = read_be<uint32_t>(header.get() + 16);
+                    return in->read_exactly(len).then([this, count, cf_id = utils::UUID(msb, lsb), len] (temporary_buffer<char> key) {
+                        if (key.size() < len) {
+                            return make_ready_future<stop_iteration>(stop_iteration::yes);
+                        }
+                        ++(*count);
+                        return warm_partition(cf_id, bytes(reinterpret_cast<const int8_t*>(key.get()), len)).then([] {
+                            return stop_iteration::no;
+                        });
+                    });
+                });
+            }).then([this, count] {
+                cslogger.info("Warmed up row cache with {} partitions from {}", *count, saved_keys_file());
+            }).finally([in] {
+                return in->close();
+            });
+        });
+    }).handle_exception([this] (auto ep) {
+        cslogger.warn("Failed to warm up row cache from {}: {}", saved_keys_file(), ep);
+    });
+}
+
+future<> cache_saver::warm_partition(utils::UUID cf_id, bytes key) {
+    lw_shared_ptr<column_family> cf;
+    try {
+        cf = _db.local().find_column_family(cf_id).shared_from_this();
+    } catch (no_such_column_family&) {
+        // The table was dropped since the keys were saved.
+        return make_ready_future<>();
+    }
+    auto s = cf->schema();
+    auto dk = dht::global_partitioner().decorate_key(*s, partition_key::from_bytes(key));
+    if (dht::shard_of(dk.token()) != engine().cpu_id()) {
+        // The keys were saved with a different shard count.
+        return make_ready_future<>();
+    }
+    // Read through the cache so the partition is populated on the way; one
+    // partition at a time and at streaming priority so ongoing reads and
+    // writes take precedence.
+    return do_with(dht::partition_range::make_singular(std::move(dk)), [this, cf, s] (dht::partition_range& pr) {
+        return do_with(cf->make_reader(s, pr, s->full_slice(), get_local_streaming_read_priority()), [] (flat_mutation_reader& reader) {
+            return repeat([&reader] {
+                return reader().then([] (mutation_fragment_opt mfo) {
+                    return stop_iteration(!mfo);
+                });
+            });
+        });
+    });
+}
+
 }
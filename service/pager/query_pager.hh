@@ -43,6 +43,7 @@
 
 #include "paging_state.hh"
 #include "cql3/result_set.hh"
+#include "cql3/result_generator.hh"
 #include "cql3/selection/selection.hh"
 
 namespace service {
@@ -85,6 +86,13 @@ public:
      */
     virtual future<> fetch_page(cql3::selection::result_set_builder&, uint32_t page_size, gc_clock::time_point) = 0;
 
+    /**
+     * Fetches the next page in serialized form, leaving the rows in the
+     * query::result they were read from. Only valid for trivial selections
+     * (cql3::selection::selection::is_trivial()).
+     */
+    virtual future<cql3::result_generator> fetch_page_generator(uint32_t page_size, gc_clock::time_point) = 0;
+
     /**
      * Whether or not this pager is exhausted, i.e. whether or not a call to
      * fetchPage may return more result.
@@ -71,6 +71,15 @@ private:
     }
 
     future<> fetch_page(cql3::selection::result_set_builder& builder, uint32_t page_size, gc_clock::time_point now) override {
+        return do_fetch_page(page_size, now).then(
+                [this, &builder, page_size, now](foreign_ptr<lw_shared_ptr<query::result>> results) {
+                    handle_result(builder, std::move(results), page_size, now);
+                });
+    }
+
+    // Applies the paging state to the query ranges and slice and runs the
+    // read for the next page, leaving the result handling to the caller.
+    future<foreign_ptr<lw_shared_ptr<query::result>>> do_fetch_page(uint32_t page_size, gc_clock::time_point now) {
         auto state = _options.get_paging_state();
 
         if (!_last_pkey && state) {
@@ -204,10 +213,7 @@ private:
         auto ranges = _ranges;
         auto command = ::make_lw_shared<query::read_command>(*_cmd);
         return get_local_storage_proxy().query(_schema, std::move(command), std::move(ranges),
-                _options.get_consistency(), _state.get_trace_state()).then(
-                [this, &builder, page_size, now](foreign_ptr<lw_shared_ptr<query::result>> results) {
-                    handle_result(builder, std::move(results), page_size, now);
-                });
+                _options.get_consistency(), _state.get_trace_state());
     }
 
     future<std::unique_ptr<cql3::result_set>> fetch_page(uint32_t page_size,
@@ -222,6 +228,51 @@ private:
                 });
     }
 
+    future<cql3::result_generator> fetch_page_generator(uint32_t page_size, gc_clock::time_point now) override {
+        return do_fetch_page(page_size, now).then(
+                [this, page_size, now](foreign_ptr<lw_shared_ptr<query::result>> results) {
+            // We still have to walk the page to size it and to find where the
+            // next one starts, but unlike the result_set_builder path no cell
+            // values are copied along the way.
+            struct last_key_visitor {
+                uint32_t total_rows = 0;
+                std::experimental::optional<partition_key> last_pkey;
+                std::experimental::optional<clustering_key> last_ckey;
+
+                void accept_new_partition(uint32_t) {
+                    throw std::logic_error("Should not reach!");
+                }
+                void accept_new_partition(const partition_key& key, uint32_t row_count) {
+                    total_rows += std::max(row_count, 1u);
+                    last_pkey = key;
+                    last_ckey = { };
+                }
+                void accept_new_row(const clustering_key& key,
+                        const query::result_row_view&, const query::result_row_view&) {
+                    last_ckey = key;
+                }
+                void accept_new_row(const query::result_row_view&, const query::result_row_view&) {
+                }
+                void accept_partition_end(const query::result_row_view&) {
+                }
+            };
+
+            // The generator must see the slice the page was read with, while
+            // update_state() below clears this page's clustering ranges from
+            // _cmd in preparation for the next one.
+            auto cmd = ::make_lw_shared<const query::read_command>(*_cmd);
+
+            last_key_visitor v;
+            query::result_view::consume(*results, cmd->slice, v);
+
+            bool is_short_read = results->is_short_read();
+            update_state(v.total_rows, std::move(v.last_pkey), std::move(v.last_ckey), page_size, is_short_read);
+
+            return cql3::result_generator(_schema, std::move(results), std::move(cmd), _selection,
+                    v.total_rows, _options.get_cql_serialization_format(), now);
+        });
+    }
+
     void handle_result(
             cql3::selection::result_set_builder& builder,
             foreign_ptr<lw_shared_ptr<query::result>> results,
@@ -267,6 +318,13 @@ private:
         myvisitor v(builder, *_schema, *_selection);
         query::result_view::consume(*results, _cmd->slice, v);
 
+        update_state(v.total_rows, std::move(v.last_pkey), std::move(v.last_ckey), page_size, results->is_short_read());
+    }
+
+    void update_state(uint32_t total_rows,
+            std::experimental::optional<partition_key> last_pkey,
+            std::experimental::optional<clustering_key> last_ckey,
+            uint32_t page_size, bool is_short_read) {
         if (_last_pkey) {
             // refs #752, when doing aggregate queries we will re-use same
             // slice repeatedly. Since "specific ck ranges" only deal with
@@ -276,12 +334,12 @@ private:
             _cmd->slice.clear_range(*_schema, *_last_pkey);
         }
 
-        _max = _max - v.total_rows;
-        _exhausted = (v.total_rows < page_size && !results->is_short_read()) || _max == 0;
-        _last_pkey = v.last_pkey;
-        _last_ckey = v.last_ckey;
+        _max = _max - total_rows;
+        _exhausted = (total_rows < page_size && !is_short_read) || _max == 0;
+        _last_pkey = std::move(last_pkey);
+        _last_ckey = std::move(last_ckey);
 
-        qlogger.debug("Fetched {} rows, max_remain={} {}", v.total_rows, _max, _exhausted ? "(exh)" : "");
+        qlogger.debug("Fetched {} rows, max_remain={} {}", total_rows, _max, _exhausted ? "(exh)" : "");
 
         if (_last_pkey) {
             qlogger.debug("Last partition key: {}", *_last_pkey);
@@ -23,6 +23,7 @@
 #include <seastar/core/reactor.hh>
 
 #include "seastarx.hh"
+#include "io_class_tracker.hh"
 
 namespace service {
 class priority_manager {
@@ -32,6 +33,8 @@ class priority_manager {
     ::io_priority_class _stream_write_priority;
     ::io_priority_class _sstable_query_read;
     ::io_priority_class _compaction_priority;
+    ::io_priority_class _backup_priority;
+    ::io_priority_class _scrub_priority;
 
 public:
     const ::io_priority_class&
@@ -64,6 +67,16 @@ public:
         return _compaction_priority;
     }
 
+    const ::io_priority_class&
+    backup_priority() {
+        return _backup_priority;
+    }
+
+    const ::io_priority_class&
+    scrub_priority() {
+        return _scrub_priority;
+    }
+
     priority_manager()
         : _commitlog_priority(engine().register_one_priority_class("commitlog", 1000))
         , _mt_flush_priority(engine().register_one_priority_class("memtable_flush", 1000))
@@ -71,8 +84,27 @@ public:
         , _stream_write_priority(engine().register_one_priority_class("streaming_write", 200))
         , _sstable_query_read(engine().register_one_priority_class("query", 1000))
         , _compaction_priority(engine().register_one_priority_class("compaction", 1000))
-
-    {}
+        // Backup uploads are pure background work; give them the smallest
+        // share so they only soak up otherwise idle bandwidth.
+        , _backup_priority(engine().register_one_priority_class("backup", 50))
+        // Background checksum validation must never compete with foreground
+        // work; it gets the smallest share of all and only fills idle time.
+        , _scrub_priority(engine().register_one_priority_class("scrub", 10))
+
+    {
+        // Name the classes so per-class I/O metrics and /io_diagnostics can
+        // attribute device time to them.
+        auto& tracker = io_class_tracker::local();
+        tracker.register_class(default_priority_class(), "default");
+        tracker.register_class(_commitlog_priority, "commitlog");
+        tracker.register_class(_mt_flush_priority, "memtable_flush");
+        tracker.register_class(_stream_read_priority, "streaming_read");
+        tracker.register_class(_stream_write_priority, "streaming_write");
+        tracker.register_class(_sstable_query_read, "query");
+        tracker.register_class(_compaction_priority, "compaction");
+        tracker.register_class(_backup_priority, "backup");
+        tracker.register_class(_scrub_priority, "scrub");
+    }
 };
 
 priority_manager& get_local_priority_manager();
@@ -105,4 +137,14 @@ const inline ::io_priority_class&
 get_local_compaction_priority() {
     return get_local_priority_manager().compaction_priority();
 }
+
+const inline ::io_priority_class&
+get_local_backup_priority() {
+    return get_local_priority_manager().backup_priority();
+}
+
+const inline ::io_priority_class&
+get_local_scrub_priority() {
+    return get_local_priority_manager().scrub_priority();
+}
 }
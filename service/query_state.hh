@@ -25,6 +25,7 @@
 
 #include "service/client_state.hh"
 #include "tracing/tracing.hh"
+#include "utils/bump_arena.hh"
 
 namespace service {
 
@@ -32,6 +33,7 @@ class query_state final {
 private:
     client_state _client_state;
     tracing::trace_state_ptr _trace_state_ptr;
+    utils::bump_arena _arena;
 
 public:
     query_state(client_state client_state)
@@ -57,6 +59,13 @@ public:
     api::timestamp_type get_timestamp() {
         return _client_state.get_timestamp();
     }
+
+    // Scratch arena for temporaries whose lifetime is bounded by this
+    // query. It is freed wholesale when the query_state is destroyed,
+    // i.e. once the response has been sent.
+    utils::bump_arena& arena() {
+        return _arena;
+    }
 };
 
 }
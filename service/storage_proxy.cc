@@ -59,6 +59,7 @@
 #include "db/hints/manager.hh"
 #include "exceptions/exceptions.hh"
 #include <boost/range/algorithm_ext/push_back.hpp>
+#include <boost/range/irange.hpp>
 #include <boost/iterator/counting_iterator.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/algorithm/cxx11/any_of.hpp>
@@ -73,7 +74,10 @@
 #include <boost/range/empty.hpp>
 #include <boost/range/algorithm/min_element.hpp>
 #include <boost/range/adaptor/transformed.hpp>
+#include "utils/cpu_profiler.hh"
 #include "utils/latency.hh"
+#include "utils/hash.hh"
+#include "xx_hasher.hh"
 #include "schema.hh"
 #include "schema_registry.hh"
 #include "utils/joinpoint.hh"
@@ -180,7 +184,48 @@ public:
     }
 };
 
-class abstract_write_response_handler {
+// A write response handler lives exactly as long as its write, so handlers
+// are allocated and freed at the full write rate of the shard. Their storage
+// is drawn from this per-shard freelist instead of the general allocator: a
+// chunk goes back on the list when a handler is destroyed and is handed out
+// again, placement-constructed, for the next write. All concrete handler
+// types fit one chunk size (static_asserts after their definitions), so the
+// list never has to match sizes; anything larger, such as a subclass grown
+// beyond the chunk in the future, falls through to the general allocator.
+class write_response_handler_pool {
+public:
+    static constexpr size_t chunk_size = 512;
+private:
+    static constexpr size_t max_free_chunks = 1024;
+    std::vector<void*> _free;
+public:
+    void* allocate(size_t size) {
+        if (size > chunk_size || _free.empty()) {
+            return ::operator new(std::max(size, chunk_size));
+        }
+        auto ptr = _free.back();
+        _free.pop_back();
+        return ptr;
+    }
+    void deallocate(void* ptr, size_t size) {
+        if (size > chunk_size || _free.size() >= max_free_chunks) {
+            ::operator delete(ptr);
+            return;
+        }
+        _free.push_back(ptr);
+    }
+    ~write_response_handler_pool() {
+        for (auto ptr : _free) {
+            ::operator delete(ptr);
+        }
+    }
+    static write_response_handler_pool& local() {
+        static thread_local write_response_handler_pool pool;
+        return pool;
+    }
+};
+
+class abstract_write_response_handler : public enable_shared_from_this<abstract_write_response_handler> {
 protected:
     storage_proxy::response_id_type _id;
     promise<> _ready; // available when cl is achieved
@@ -313,6 +358,15 @@ public:
     const tracing::trace_state_ptr& get_trace_state() const {
         return _trace_state;
     }
+    // Deriving from enable_shared_from_this puts the reference count inside
+    // the object, which makes ::make_shared() allocate the handler itself
+    // rather than a wrapper, so these hooks see every handler allocation.
+    static void* operator new(size_t size) {
+        return write_response_handler_pool::local().allocate(size);
+    }
+    static void operator delete(void* ptr, size_t size) {
+        write_response_handler_pool::local().deallocate(ptr, size);
+    }
     friend storage_proxy;
 };
 
@@ -401,6 +455,13 @@ public:
     }
 };
 
+static_assert(sizeof(write_response_handler) <= write_response_handler_pool::chunk_size,
+        "write response handlers are expected to fit the pool chunk size");
+static_assert(sizeof(datacenter_write_response_handler) <= write_response_handler_pool::chunk_size,
+        "write response handlers are expected to fit the pool chunk size");
+static_assert(sizeof(datacenter_sync_write_response_handler) <= write_response_handler_pool::chunk_size,
+        "write response handlers are expected to fit the pool chunk size");
+
 bool storage_proxy::need_throttle_writes() const {
     return _stats.background_write_bytes > memory::stats().total_memory() / 10 || _stats.queued_write_bytes > 6*1024*1024;
 }
@@ -465,7 +526,7 @@ void storage_proxy::got_failure_response(storage_proxy::response_id_type id, gms
 future<> storage_proxy::response_wait(storage_proxy::response_id_type id, clock_type::time_point timeout) {
     auto& e = _response_handlers.find(id)->second;
 
-    e.expire_timer.arm(timeout);
+    _expiry_wheel.arm(e.expire_timer, timeout);
 
     return e.handler->wait();
 }
@@ -544,6 +605,11 @@ inline uint64_t& storage_proxy::split_stats::get_ep_stat(gms::inet_address ep) {
 storage_proxy::~storage_proxy() {}
 storage_proxy::storage_proxy(distributed<database>& db, stdx::optional<std::vector<sstring>> hinted_handoff_enabled) : _db(db) {
     namespace sm = seastar::metrics;
+    // Start the handler map at a realistic in-flight window instead of
+    // growing there through a chain of rehashes on the first load spike; it
+    // only ever grows (erase never shrinks it), so once at the peak window
+    // it stays rehash-free.
+    _response_handlers.reserve(1024);
     _metrics.add_group(COORDINATOR_STATS_CATEGORY, {
         sm::make_histogram("read_latency", sm::description("The general read latency histogram"), [this]{ return _stats.estimated_read.get_histogram(16, 20);}),
         sm::make_histogram("write_latency", sm::description("The general write latency histogram"), [this]{return _stats.estimated_write.get_histogram(16, 20);}),
@@ -577,6 +643,9 @@ storage_proxy::storage_proxy(distributed<database>& db, stdx::optional<std::vect
         sm::make_total_operations("canceled_read_repairs", [this] { return _stats.global_read_repairs_canceled_due_to_concurrent_write; },
                        sm::description("number of global read repairs canceled due to a concurrent write")),
 
+        sm::make_total_operations("coalesced_read_repairs", [this] { return _stats.read_repair_coalesced_writes; },
+                       sm::description("number of read repair rounds merged into a concurrent in-flight repair of the same partition")),
+
         sm::make_total_operations("foreground_read_repair", [this] { return _stats.read_repair_repaired_blocking; },
                       sm::description("number of foreground read repairs")),
 
@@ -606,6 +675,21 @@ storage_proxy::storage_proxy(distributed<database>& db, stdx::optional<std::vect
 
         sm::make_total_operations("speculative_data_reads", [this] { return _stats.speculative_data_reads; },
                        sm::description("number of speculative data read requests that were sent")),
+
+        sm::make_total_operations("reads_coalesced", [this] { return _stats.reads_coalesced; },
+                       sm::description("number of reads attached to an identical read already in flight")),
+
+        sm::make_total_operations("multi_range_reads", [this] { return _stats.multi_range_reads; },
+                       sm::description("number of multi-key reads collapsed into a single READ_DATA_MULTI request")),
+
+        sm::make_total_operations("hot_key_cache_hits", [this] { return _stats.hot_key_cache_hits; },
+                       sm::description("number of singular reads served from the hot key result cache")),
+
+        sm::make_total_operations("hot_key_cache_misses", [this] { return _stats.hot_key_cache_misses; },
+                       sm::description("number of hot key reads that were executed and populated the result cache")),
+
+        sm::make_total_operations("digest_read_bypass_reads", [this] { return _stats.digest_read_bypass_reads; },
+                       sm::description("number of quorum reads served from a single replica due to proven digest agreement")),
     });
 
     _metrics.add_group(REPLICA_STATS_CATEGORY, {
@@ -1043,6 +1127,9 @@ storage_proxy::response_id_type storage_proxy::unique_response_handler::release(
 
 future<>
 storage_proxy::mutate_locally(const mutation& m, clock_type::time_point timeout) {
+    if (!_hot_key_cache.empty()) {
+        _hot_key_cache.invalidate(m.column_family_id(), bytes_view(m.key().representation()));
+    }
     auto shard = _db.local().shard_of(m);
     return _db.invoke_on(shard, [s = global_schema_ptr(m.schema()), m = freeze(m), timeout] (database& db) -> future<> {
         return db.apply(s, m, timeout);
@@ -1051,6 +1138,9 @@ storage_proxy::mutate_locally(const mutation& m, clock_type::time_point timeout)
 
 future<>
 storage_proxy::mutate_locally(const schema_ptr& s, const frozen_mutation& m, clock_type::time_point timeout) {
+    if (!_hot_key_cache.empty()) {
+        _hot_key_cache.invalidate(m.column_family_id(), m.key(*s).representation());
+    }
     auto shard = _db.local().shard_of(m);
     return _db.invoke_on(shard, [&m, gs = global_schema_ptr(s), timeout] (database& db) -> future<> {
         return db.apply(gs, m, timeout);
@@ -1059,17 +1149,87 @@ storage_proxy::mutate_locally(const schema_ptr& s, const frozen_mutation& m, clo
 
 future<>
 storage_proxy::mutate_locally(std::vector<mutation> mutations, clock_type::time_point timeout) {
-    return do_with(std::move(mutations), [this, timeout] (std::vector<mutation>& pmut){
-        return parallel_for_each(pmut.begin(), pmut.end(), [this, timeout] (const mutation& m) {
-            return mutate_locally(m, timeout);
+    // Freeze and group the mutations by owning shard, so each shard gets a
+    // single apply_batch() call instead of one apply() per mutation.
+    std::unordered_map<unsigned, std::vector<std::pair<global_schema_ptr, frozen_mutation>>> by_shard;
+    for (auto& m : mutations) {
+        if (!_hot_key_cache.empty()) {
+            _hot_key_cache.invalidate(m.column_family_id(), bytes_view(m.key().representation()));
+        }
+        by_shard[_db.local().shard_of(m)].emplace_back(global_schema_ptr(m.schema()), freeze(m));
+    }
+    mutations.clear();
+    return do_with(std::move(by_shard), [this, timeout] (auto& by_shard) {
+        return parallel_for_each(by_shard, [this, timeout] (auto& x) {
+            return _db.invoke_on(x.first, [&ms = x.second, timeout] (database& db) {
+                std::vector<std::pair<schema_ptr, frozen_mutation>> muts;
+                muts.reserve(ms.size());
+                for (auto& p : ms) {
+                    muts.emplace_back(p.first.get(), std::move(p.second));
+                }
+                return db.apply_batch(std::move(muts), timeout);
+            });
         });
     });
 }
 
+// Merges counter updates from one batch that target the same partition of the
+// same table. Two counter update cells sum their deltas when merged, so the
+// combined mutation is equivalent to applying the originals one by one, but
+// a batch hammering a few hot cells costs a single lock-read-apply cycle on
+// the leader shard instead of one per update.
+std::vector<storage_proxy::frozen_mutation_and_schema>
+storage_proxy::merge_counter_updates(std::vector<frozen_mutation_and_schema> updates) {
+    // Maps (table, partition key) to the index of the first update seen for it.
+    std::unordered_map<std::pair<utils::UUID, bytes>, size_t, utils::tuple_hash> first_update;
+    std::vector<stdx::optional<mutation>> accumulators(updates.size());
+    std::vector<bool> consumed(updates.size(), false);
+    bool merged_any = false;
+
+    for (size_t i = 0; i < updates.size(); ++i) {
+        auto& u = updates[i];
+        auto key = std::make_pair(u.fm.column_family_id(), to_bytes(u.fm.key(*u.s).representation()));
+        auto it = first_update.find(key);
+        if (it == first_update.end()) {
+            first_update.emplace(std::move(key), i);
+            continue;
+        }
+        auto& dst = updates[it->second];
+        auto& acc = accumulators[it->second];
+        if (!acc) {
+            acc = dst.fm.unfreeze(dst.s);
+        }
+        acc->apply(u.fm.unfreeze(u.s));
+        consumed[i] = true;
+        merged_any = true;
+    }
+
+    if (!merged_any) {
+        return updates;
+    }
+
+    std::vector<frozen_mutation_and_schema> result;
+    result.reserve(first_update.size());
+    for (size_t i = 0; i < updates.size(); ++i) {
+        if (consumed[i]) {
+            continue;
+        }
+        if (accumulators[i]) {
+            result.emplace_back(frozen_mutation_and_schema{freeze(*accumulators[i]), updates[i].s});
+        } else {
+            result.emplace_back(std::move(updates[i]));
+        }
+    }
+    return result;
+}
+
 future<>
 storage_proxy::mutate_counters_on_leader(std::vector<frozen_mutation_and_schema> mutations, db::consistency_level cl, clock_type::time_point timeout,
                                          tracing::trace_state_ptr trace_state) {
     _stats.received_counter_updates += mutations.size();
+    if (mutations.size() > 1) {
+        mutations = merge_counter_updates(std::move(mutations));
+    }
     return do_with(std::move(mutations), [this, cl, timeout, trace_state = std::move(trace_state)] (std::vector<frozen_mutation_and_schema>& update_ms) mutable {
         return parallel_for_each(update_ms, [this, cl, timeout, trace_state] (frozen_mutation_and_schema& fm_a_s) {
             return mutate_counter_on_leader_and_replicate(fm_a_s.s, std::move(fm_a_s.fm), cl, timeout, trace_state);
@@ -1107,6 +1267,11 @@ storage_proxy::mutate_streaming_mutation(const schema_ptr& s, utils::UUID plan_i
  */
 storage_proxy::response_id_type
 storage_proxy::create_write_response_handler(const mutation& m, db::consistency_level cl, db::write_type type, tracing::trace_state_ptr tr_state) {
+    // A write is about to go out through this coordinator; drop any cached
+    // result pages for the partition before replicas start acknowledging it.
+    if (!_hot_key_cache.empty()) {
+        _hot_key_cache.invalidate(m.column_family_id(), bytes_view(m.key().representation()));
+    }
     auto keyspace_name = m.schema()->ks_name();
     keyspace& ks = _db.local().find_keyspace(keyspace_name);
     auto& rs = ks.get_replication_strategy();
@@ -1199,7 +1364,18 @@ future<std::vector<storage_proxy::unique_response_handler>> storage_proxy::mutat
 
 future<> storage_proxy::mutate_begin(std::vector<unique_response_handler> ids, db::consistency_level cl,
                                      stdx::optional<clock_type::time_point> timeout_opt) {
-    return parallel_for_each(ids, [this, cl, timeout_opt] (unique_response_handler& protected_response) {
+    auto timeout = timeout_opt.value_or(clock_type::now() + std::chrono::milliseconds(_db.local().get_config().write_request_timeout_in_ms()));
+    // For requests carrying more than one mutation (e.g. an unlogged batch
+    // spanning many partitions) remote writes are coalesced per destination,
+    // so a replica owning many of the mutations gets one MUTATION_BATCH verb
+    // instead of a MUTATION per mutation.
+    stdx::optional<coalesced_write_map> batches;
+    if (ids.size() > 1 && get_local_storage_service().cluster_supports_mutation_batch()) {
+        batches.emplace();
+    }
+    // send_to_live_endpoints() only collects into batches synchronously, so
+    // they can live on our stack: they are flushed before we return.
+    auto f = parallel_for_each(ids, [this, cl, timeout, batches = batches ? &*batches : nullptr] (unique_response_handler& protected_response) {
         auto response_id = protected_response.id;
         // it is better to send first and hint afterwards to reduce latency
         // but request may complete before hint_to_dead_endpoints() is called and
@@ -1207,12 +1383,15 @@ future<> storage_proxy::mutate_begin(std::vector<unique_response_handler> ids, d
         // frozen_mutation copy, or manage handler live time differently.
         hint_to_dead_endpoints(response_id, cl);
 
-        auto timeout = timeout_opt.value_or(clock_type::now() + std::chrono::milliseconds(_db.local().get_config().write_request_timeout_in_ms()));
         // call before send_to_live_endpoints() for the same reason as above
         auto f = response_wait(response_id, timeout);
-        send_to_live_endpoints(protected_response.release(), timeout); // response is now running and it will either complete or timeout
+        send_to_live_endpoints(protected_response.release(), timeout, batches); // response is now running and it will either complete or timeout
         return std::move(f);
     });
+    if (batches) {
+        flush_coalesced_writes(std::move(*batches), timeout);
+    }
+    return f;
 }
 
 // this function should be called with a future that holds result of mutation attempt (usually
@@ -1355,6 +1534,7 @@ future<> storage_proxy::mutate(std::vector<mutation> mutations, db::consistency_
 }
 
 future<> storage_proxy::do_mutate(std::vector<mutation> mutations, db::consistency_level cl, tracing::trace_state_ptr tr_state, bool raw_counters) {
+    utils::cpu_profiler::scope profiler_scope(utils::cpu_profiler::component::coordinator_write);
     auto mid = raw_counters ? mutations.begin() : boost::range::partition(mutations, [] (auto&& m) {
         return m.schema()->is_counter();
     });
@@ -1487,17 +1667,8 @@ storage_proxy::mutate_atomically(std::vector<mutation> mutations, db::consistenc
             return send_batchlog_mutation(std::move(m));
         };
         future<> async_remove_from_batchlog() {
-            // delete batch
-            auto schema = _p._db.local().find_schema(db::system_keyspace::NAME, db::system_keyspace::BATCHLOG);
-            auto key = partition_key::from_exploded(*schema, {uuid_type->decompose(_batch_uuid)});
-            auto now = service::client_state(service::client_state::internal_tag()).get_timestamp();
-            mutation m(schema, key);
-            m.partition().apply_delete(*schema, clustering_key_prefix::make_empty(), tombstone(now, gc_clock::now()));
-
-            tracing::trace(_trace_state, "Sending a batchlog remove mutation");
-            return send_batchlog_mutation(std::move(m), db::consistency_level::ANY).handle_exception([] (std::exception_ptr eptr) {
-                slogger.error("Failed to remove mutations from batchlog: {}", eptr);
-            });
+            tracing::trace(_trace_state, "Enqueuing a batchlog remove mutation");
+            return _p.remove_from_batchlog(_batch_uuid, _batchlog_endpoints, _trace_state);
         };
 
         future<> run() {
@@ -1525,6 +1696,45 @@ storage_proxy::mutate_atomically(std::vector<mutation> mutations, db::consistenc
     });
 }
 
+future<> storage_proxy::remove_from_batchlog(utils::UUID id, std::unordered_set<gms::inet_address> endpoints, tracing::trace_state_ptr tr_state) {
+    _pending_batchlog_removals.emplace_back(batchlog_removal{std::move(id), std::move(endpoints), std::move(tr_state)});
+    if (!_pending_batchlog_removal_flush) {
+        // A removal is a tiny fire-and-forget delete issued once per logged
+        // batch. Defer the send by one reactor iteration so removals from
+        // batches completing around the same time go out in a single pass,
+        // where the per-destination write coalescing above folds same-replica
+        // ones into combined messages.
+        _pending_batchlog_removal_flush = shared_promise<>();
+        later().then([this, p = shared_from_this()] {
+            auto flush = std::move(*_pending_batchlog_removal_flush);
+            _pending_batchlog_removal_flush = {};
+            return flush_batchlog_removals().finally([flush = std::move(flush)] () mutable {
+                flush.set_value();
+            });
+        });
+    }
+    return _pending_batchlog_removal_flush->get_shared_future();
+}
+
+future<> storage_proxy::flush_batchlog_removals() {
+    auto schema = _db.local().find_schema(db::system_keyspace::NAME, db::system_keyspace::BATCHLOG);
+    auto now = service::client_state(service::client_state::internal_tag()).get_timestamp();
+    return do_with(std::exchange(_pending_batchlog_removals, {}), [this, schema, now] (std::vector<batchlog_removal>& pending) {
+        return mutate_prepare<>(pending, db::consistency_level::ANY, db::write_type::BATCH_LOG,
+                [this, schema, now] (const batchlog_removal& r, db::consistency_level cl, db::write_type type) {
+            auto key = partition_key::from_exploded(*schema, {uuid_type->decompose(r.id)});
+            mutation m(schema, key);
+            m.partition().apply_delete(*schema, clustering_key_prefix::make_empty(), tombstone(now, gc_clock::now()));
+            auto& ks = _db.local().find_keyspace(schema->ks_name());
+            return create_write_response_handler(ks, cl, type, std::make_unique<shared_mutation>(m), r.endpoints, {}, {}, r.trace_state);
+        }).then([this] (std::vector<unique_response_handler> ids) {
+            return mutate_begin(std::move(ids), db::consistency_level::ANY);
+        }).handle_exception([] (std::exception_ptr eptr) {
+            slogger.error("Failed to remove mutations from batchlog: {}", eptr);
+        });
+    });
+}
+
 bool storage_proxy::cannot_hint(gms::inet_address target) {
     // if hints are disabled we "can always hint" since there's going to be no hint generated in this case
     return hints_enabled() && _hints_manager->too_many_in_flight_hints_for(target);
@@ -1560,7 +1770,7 @@ future<> storage_proxy::send_to_endpoint(mutation m, gms::inet_address target, d
  * @throws OverloadedException if the hints cannot be written/enqueued
  */
  // returned future is ready when sent is complete, not when mutation is executed on all (or any) targets!
-void storage_proxy::send_to_live_endpoints(storage_proxy::response_id_type response_id, clock_type::time_point timeout)
+void storage_proxy::send_to_live_endpoints(storage_proxy::response_id_type response_id, clock_type::time_point timeout, coalesced_write_map* batches)
 {
     // extra-datacenter replicas, grouped by dc
     std::unordered_map<sstring, std::vector<gms::inet_address>> dc_groups;
@@ -1634,6 +1844,12 @@ void storage_proxy::send_to_live_endpoints(storage_proxy::response_id_type respo
 
             if (coordinator == my_address) {
                 f = futurize<void>::apply(lmutate, std::move(m));
+            } else if (batches && forward.empty() && !handler.is_counter() && !handler.read_repair_write() && !handler.get_trace_state()) {
+                // Defer the send; flush_coalesced_writes() will group it with
+                // other writes headed to the same destination. Only plain,
+                // untraced writes with no forwarding are eligible, so that the
+                // batched verb stays simple.
+                (*batches)[coordinator].push_back(coalesced_write{response_id, handler_ptr, std::move(m)});
             } else {
                 f = futurize<void>::apply(rmutate, coordinator, std::move(forward), *m);
             }
@@ -1658,6 +1874,69 @@ void storage_proxy::send_to_live_endpoints(storage_proxy::response_id_type respo
     }
 }
 
+void storage_proxy::flush_coalesced_writes(coalesced_write_map batches, clock_type::time_point timeout)
+{
+    auto my_address = utils::fb_utilities::get_broadcast_address();
+    auto& ms = netw::get_local_messaging_service();
+
+    for (auto&& dest : batches) {
+        auto coordinator = dest.first;
+        auto writes = make_lw_shared<std::vector<coalesced_write>>(std::move(dest.second));
+
+        size_t msize = 0;
+        for (auto&& w : *writes) {
+            msize += w.mutation->representation().size();
+        }
+        _stats.queued_write_bytes += msize;
+
+        future<> f = make_ready_future<>();
+        if (writes->size() == 1) {
+            // A destination that ended up with a single write gains nothing
+            // from the batched verb; use the plain one.
+            auto& w = (*writes)[0];
+            f = ms.send_mutation(netw::messaging_service::msg_addr{coordinator, 0}, timeout, *w.mutation,
+                    {}, my_address, engine().cpu_id(), w.id);
+        } else {
+            // The rpc layer serializes the arguments before the send future
+            // resolves and writes never outlives it, so references are enough
+            // and the frozen representations are not copied again.
+            std::vector<std::reference_wrapper<const frozen_mutation>> fms;
+            std::vector<response_id_type> response_ids;
+            fms.reserve(writes->size());
+            response_ids.reserve(writes->size());
+            for (auto&& w : *writes) {
+                fms.emplace_back(std::cref(*w.mutation));
+                response_ids.push_back(w.id);
+            }
+            f = ms.send_mutation_batch(netw::messaging_service::msg_addr{coordinator, 0}, timeout, std::move(fms),
+                    my_address, engine().cpu_id(), std::move(response_ids));
+        }
+        // writes is captured to keep the handlers, and thereby the mutations
+        // being serialized, alive until the send completes.
+        f.then_wrapped([this, p = shared_from_this(), coordinator, writes, msize] (future<> f) {
+            _stats.queued_write_bytes -= msize;
+            unthrottle();
+            if (!f.failed()) {
+                return;
+            }
+            auto eptr = f.get_exception();
+            for (auto&& w : *writes) {
+                ++_stats.writes_errors.get_ep_stat(coordinator);
+                got_failure_response(w.id, coordinator, 1);
+            }
+            try {
+                std::rethrow_exception(eptr);
+            } catch(rpc::closed_error&) {
+                // ignore, disconnect will be logged by gossiper
+            } catch(seastar::gate_closed_exception&) {
+                // may happen during shutdown, ignore it
+            } catch(...) {
+                slogger.error("exception during mutation write to {}: {}", coordinator, std::current_exception());
+            }
+        });
+    }
+}
+
 // returns number of hints stored
 template<typename Range>
 size_t storage_proxy::hint_to_dead_endpoints(std::unique_ptr<mutation_holder>& mh, const Range& targets, tracing::trace_state_ptr tr_state) noexcept
@@ -1804,11 +2083,86 @@ size_t storage_proxy::hint_to_dead_endpoints(std::unique_ptr<mutation_holder>& m
     }
 #endif
 
+utils::rate_limiter& storage_proxy::read_repair_limiter(const utils::UUID& cf_id) {
+    auto it = _read_repair_limiters.find(cf_id);
+    if (it == _read_repair_limiters.end()) {
+        auto rate = _db.local().get_config().read_repair_throttle_in_kb() * size_t(1024);
+        it = _read_repair_limiters.emplace(cf_id, make_lw_shared<utils::rate_limiter>(rate)).first;
+    }
+    return *it->second;
+}
+
+future<> storage_proxy::send_repair(dht::token token, std::unordered_map<gms::inet_address, std::experimental::optional<mutation>> diffs, db::consistency_level cl, tracing::trace_state_ptr trace_state) {
+    auto it = _pending_read_repairs.find(token);
+    if (it != _pending_read_repairs.end() && it->second->cl == cl) {
+        // A repair write for this partition is already in flight; fold our
+        // diffs into the round that will be sent when it completes. Reads
+        // merged here still wait for their data to be repaired before they
+        // are allowed to respond.
+        auto& pending = *it->second;
+        for (auto&& d : diffs) {
+            auto& dst = pending.diffs[d.first];
+            if (!dst) {
+                dst = std::move(d.second);
+            } else if (d.second) {
+                dst->apply(std::move(*d.second));
+            }
+        }
+        _stats.read_repair_coalesced_writes++;
+        return it->second->done.get_shared_future();
+    }
+    // Estimate the size and cap per-table repair bandwidth so that repairing
+    // a hot diverging partition cannot saturate the replicas it targets.
+    size_t size = 0;
+    stdx::optional<utils::UUID> cf_id;
+    for (auto&& d : diffs) {
+        if (d.second) {
+            size += d.second->partition().external_memory_usage();
+            cf_id = d.second->schema()->id();
+        }
+    }
+    if (!cf_id) {
+        return make_ready_future<>();
+    }
+    auto entry = make_lw_shared<pending_read_repair>();
+    entry->cl = cl;
+    if (it == _pending_read_repairs.end()) {
+        // Don't coalesce across consistency levels; just don't register.
+        _pending_read_repairs.emplace(token, entry);
+    }
+    return read_repair_limiter(*cf_id).reserve(size).then([this, diffs = std::move(diffs), cl, trace_state] () mutable {
+        return mutate_internal(std::array<std::unordered_map<gms::inet_address, std::experimental::optional<mutation>>, 1>{{std::move(diffs)}}, cl, false, trace_state);
+    }).then_wrapped([this, token, entry, trace_state] (future<> f) {
+        if (_pending_read_repairs.count(token) && _pending_read_repairs[token] == entry) {
+            _pending_read_repairs.erase(token);
+        }
+        if (entry->diffs.empty()) {
+            entry->done.set_value();
+        } else {
+            // Send the diffs which accumulated while we were in flight as
+            // one merged follow-up round, and unblock its waiters when it
+            // completes.
+            send_repair(token, std::move(entry->diffs), entry->cl, trace_state).then_wrapped([entry] (future<> f) {
+                if (f.failed()) {
+                    entry->done.set_exception(f.get_exception());
+                } else {
+                    entry->done.set_value();
+                }
+            });
+        }
+        return f;
+    });
+}
+
 future<> storage_proxy::schedule_repair(std::unordered_map<dht::token, std::unordered_map<gms::inet_address, std::experimental::optional<mutation>>> diffs, db::consistency_level cl, tracing::trace_state_ptr trace_state) {
     if (diffs.empty()) {
         return make_ready_future<>();
     }
-    return mutate_internal(diffs | boost::adaptors::map_values, cl, false, std::move(trace_state));
+    return do_with(std::move(diffs), [this, cl, trace_state = std::move(trace_state)] (auto& diffs) {
+        return parallel_for_each(diffs, [this, cl, trace_state] (auto& d) {
+            return this->send_repair(d.first, std::move(d.second), cl, trace_state);
+        });
+    });
 }
 
 class abstract_read_resolver {
@@ -2556,9 +2910,12 @@ protected:
     }
     future<> make_data_requests(digest_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout, bool want_digest) {
         return parallel_for_each(begin, end, [this, resolver = std::move(resolver), timeout, want_digest] (gms::inet_address ep) {
-            return make_data_request(ep, timeout, want_digest).then_wrapped([this, resolver, ep] (future<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature> f) {
+            utils::latency_counter lc;
+            lc.start();
+            return make_data_request(ep, timeout, want_digest).then_wrapped([this, resolver, ep, lc] (future<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature> f) mutable {
                 try {
                     auto v = f.get();
+                    _proxy->record_endpoint_read_latency(ep, lc.stop().latency());
                     _cf->set_hit_rate(ep, std::get<1>(v));
                     resolver->add_data(ep, std::get<0>(std::move(v)));
                     ++_proxy->_stats.data_read_completed.get_ep_stat(ep);
@@ -2571,9 +2928,12 @@ protected:
     }
     future<> make_digest_requests(digest_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout) {
         return parallel_for_each(begin, end, [this, resolver = std::move(resolver), timeout] (gms::inet_address ep) {
-            return make_digest_request(ep, timeout).then_wrapped([this, resolver, ep] (future<query::result_digest, api::timestamp_type, cache_temperature> f) {
+            utils::latency_counter lc;
+            lc.start();
+            return make_digest_request(ep, timeout).then_wrapped([this, resolver, ep, lc] (future<query::result_digest, api::timestamp_type, cache_temperature> f) mutable {
                 try {
                     auto v = f.get();
+                    _proxy->record_endpoint_read_latency(ep, lc.stop().latency());
                     _cf->set_hit_rate(ep, std::get<2>(v));
                     resolver->add_digest(ep, std::get<0>(v), std::get<1>(v));
                     ++_proxy->_stats.digest_read_completed.get_ep_stat(ep);
@@ -2699,6 +3059,9 @@ public:
                 bool digests_match;
                 std::tie(result, digests_match) = f.get(); // can throw
 
+                if (exec->_targets.size() > 1) {
+                    exec->_proxy->record_digest_match(exec->_schema->id(), digests_match);
+                }
                 if (digests_match) {
                     exec->_result_promise.set_value(std::move(result));
                     if (exec->_block_for < exec->_targets.size()) { // if there are more targets then needed for cl, check digest in background
@@ -2725,6 +3088,7 @@ public:
             exec->_proxy->_stats.background_reads++;
             digest_resolver->done().then([exec, digest_resolver, timeout, background_repair_check] () mutable {
                 if (background_repair_check && !digest_resolver->digests_match()) {
+                    exec->_proxy->record_digest_match(exec->_schema->id(), false);
                     exec->_proxy->_stats.read_repair_repaired_background++;
                     exec->_result_promise = promise<foreign_ptr<lw_shared_ptr<query::result>>>();
                     exec->reconcile(exec->_cl, timeout);
@@ -2791,9 +3155,18 @@ public:
             }
         });
         auto& sr = _schema->speculative_retry();
-        auto t = (sr.get_type() == speculative_retry::type::PERCENTILE) ?
-            std::min(_cf->get_coordinator_read_latency_percentile(sr.get_value()), std::chrono::milliseconds(_proxy->get_db().local().get_config().read_request_timeout_in_ms()/2)) :
-            std::chrono::milliseconds(unsigned(sr.get_value()));
+        std::chrono::milliseconds t;
+        if (sr.get_type() == speculative_retry::type::PERCENTILE) {
+            // Prefer the latency profile of the replica we are actually
+            // waiting for; a healthy replica on a table with a slow replica
+            // shouldn't inherit the latter's speculation threshold. Fall
+            // back to the table-wide percentile until enough samples exist.
+            auto ep_latency = _proxy->endpoint_read_latency_percentile(*_targets.begin(), sr.get_value());
+            t = ep_latency ? *ep_latency : _cf->get_coordinator_read_latency_percentile(sr.get_value());
+            t = std::min(t, std::chrono::milliseconds(_proxy->get_db().local().get_config().read_request_timeout_in_ms()/2));
+        } else {
+            t = std::chrono::milliseconds(unsigned(sr.get_value()));
+        }
         _speculate_timer.arm(t);
 
         // if CL + RR result in covering all replicas, getReadExecutor forces AlwaysSpeculating.  So we know
@@ -2831,6 +3204,58 @@ public:
     }
 };
 
+void storage_proxy::record_endpoint_read_latency(gms::inet_address ep, utils::estimated_histogram::duration latency) {
+    _endpoint_read_latencies[ep].hist.add(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+}
+
+stdx::optional<std::chrono::milliseconds> storage_proxy::endpoint_read_latency_percentile(gms::inet_address ep, double percentile) {
+    static constexpr int64_t min_samples = 16;
+    auto it = _endpoint_read_latencies.find(ep);
+    if (it == _endpoint_read_latencies.end() || it->second.hist.count() < min_samples) {
+        return stdx::nullopt;
+    }
+    auto& tracker = it->second;
+    if (tracker.cached_percentile != percentile || lowres_clock::now() - tracker.percentile_cache_timestamp > std::chrono::seconds(1)) {
+        tracker.percentile_cache_timestamp = lowres_clock::now();
+        tracker.cached_percentile = percentile;
+        tracker.percentile_cache_value = std::chrono::milliseconds(std::max(tracker.hist.percentile(percentile) / 1000, int64_t(1)));
+        tracker.hist *= 0.9; // decay values a little to give new data points more weight
+    }
+    return tracker.percentile_cache_value;
+}
+
+void storage_proxy::record_digest_match(const utils::UUID& cf_id, bool match) {
+    auto& t = _digest_agreement[cf_id];
+    ++t.checks;
+    if (!match) {
+        ++t.mismatches;
+    }
+    // Age the counters so that a mismatch eventually stops disqualifying
+    // the table, and old agreement does not hide a recent divergence.
+    if (t.checks >= (1 << 16)) {
+        t.checks /= 2;
+        t.mismatches -= t.mismatches / 2;
+    }
+}
+
+bool storage_proxy::should_bypass_digest_reads(const utils::UUID& cf_id) {
+    static constexpr uint64_t min_checks = 1024;
+    static constexpr uint64_t mismatch_denominator = 10000; // require a mismatch rate below 0.01%
+    static constexpr uint64_t verify_sample_rate = 16;
+    auto i = _digest_agreement.find(cf_id);
+    if (i == _digest_agreement.end()) {
+        return false;
+    }
+    auto& t = i->second;
+    if (t.checks < min_checks || t.mismatches * mismatch_denominator >= t.checks) {
+        return false;
+    }
+    // Keep sending every verify_sample_rate-th read down the regular
+    // data-plus-digest path, so the mismatch rate stays current and
+    // divergent replicas still get read-repaired.
+    return ++t.bypassed_reads % verify_sample_rate != 0;
+}
+
 db::read_repair_decision storage_proxy::new_read_repair_decision(const schema& s) {
     double chance = _read_repair_chance(_urandom);
     if (s.read_repair_chance() > chance) {
@@ -2880,6 +3305,21 @@ db::read_repair_decision storage_proxy::new_read_repair_decision(const schema& s
 
     size_t block_for = db::block_for(ks, cl);
     auto p = shared_from_this();
+
+    if (_db.local().get_config().digest_read_bypass_enabled()
+            && repair_decision == db::read_repair_decision::NONE
+            && (cl == db::consistency_level::QUORUM || cl == db::consistency_level::LOCAL_QUORUM)
+            && target_replicas.size() > 1
+            && should_bypass_digest_reads(schema->id())) {
+        // This table's replicas agreed on virtually every digest check, so
+        // serve the read from the closest replica alone.
+        // should_bypass_digest_reads() keeps a sample of reads on the
+        // regular quorum path to notice when that stops being true.
+        ++_stats.digest_read_bypass_reads;
+        target_replicas.resize(1);
+        return ::make_shared<never_speculating_read_executor>(schema, cf, p, cmd, std::move(pr), cl, std::move(target_replicas), std::move(trace_state));
+    }
+
     // Speculative retry is disabled *OR* there are simply no extra replicas to speculate.
     if (retry_type == speculative_retry::type::NONE || block_for == all_replicas.size()
             || (repair_decision == db::read_repair_decision::DC_LOCAL && is_datacenter_local(cl) && block_for == target_replicas.size())) {
@@ -2954,10 +3394,222 @@ void storage_proxy::handle_read_error(std::exception_ptr eptr, bool range) {
     }
 }
 
+size_t storage_proxy::hot_key_result_cache::cache_key_hash::operator()(const cache_key& k) const {
+    return utils::hash_combine(std::hash<utils::UUID>()(k.cf_id),
+            utils::hash_combine(std::hash<bytes_view>()(bytes_view(k.pkey.begin(), k.pkey.size())), k.slice_digest));
+}
+
+stdx::optional<lw_shared_ptr<query::result>>
+storage_proxy::hot_key_result_cache::lookup(const cache_key& k) {
+    auto it = _entries.find(k);
+    if (it != _entries.end()) {
+        if (clock_type::now() < it->second.expires) {
+            return it->second.result;
+        }
+        _entries.erase(it);
+    }
+    // Sample the reads rather than counting them all, so that hotness
+    // detection costs no more than an increment for keys which never get hot.
+    if (++_reads % sample_rate == 0) {
+        _sketch.add(k);
+        if (_sketch.total() >= sketch_window) {
+            _sketch.age();
+        }
+    }
+    return stdx::nullopt;
+}
+
+bool storage_proxy::hot_key_result_cache::is_hot(const cache_key& k) const {
+    for (auto& e : _sketch.entries()) {
+        if (e.key == k) {
+            return e.count - e.error >= promote_threshold;
+        }
+    }
+    return false;
+}
+
+void storage_proxy::hot_key_result_cache::insert(cache_key k, lw_shared_ptr<query::result> result) {
+    if (_entries.size() >= max_entries) {
+        // The cache is tiny, a scan for the entry closest to expiry is fine.
+        auto it = std::min_element(_entries.begin(), _entries.end(), [] (auto& a, auto& b) {
+            return a.second.expires < b.second.expires;
+        });
+        _entries.erase(it);
+    }
+    _entries[std::move(k)] = entry{std::move(result), clock_type::now() + entry_ttl};
+}
+
+void storage_proxy::hot_key_result_cache::invalidate(const utils::UUID& cf_id, bytes_view pkey) {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->first.cf_id == cf_id && bytes_view(it->first.pkey.begin(), it->first.pkey.size()) == pkey) {
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Digest of the parts of a read which determine the content of the returned
+// page, so that only reads which would produce an identical page share a hot
+// key cache entry.
+static uint64_t hot_key_slice_digest(const query::read_command& cmd, db::consistency_level cl) {
+    xx_hasher h;
+    auto feed_int = [&h] (uint64_t v) {
+        h.update(reinterpret_cast<const char*>(&v), sizeof(v));
+    };
+    auto feed_bytes = [&] (bytes_view v) {
+        feed_int(v.size());
+        h.update(reinterpret_cast<const char*>(v.data()), v.size());
+    };
+    for (auto&& r : cmd.slice.default_row_ranges()) {
+        auto feed_bound = [&] (const stdx::optional<query::clustering_range::bound>& b) {
+            feed_int(b ? (b->is_inclusive() ? 2 : 1) : 0);
+            if (b) {
+                feed_bytes(bytes_view(b->value().representation()));
+            }
+        };
+        feed_bound(r.start());
+        feed_bound(r.end());
+    }
+    feed_int(cmd.slice.static_columns.size());
+    for (auto id : cmd.slice.static_columns) {
+        feed_int(id);
+    }
+    for (auto id : cmd.slice.regular_columns) {
+        feed_int(id);
+    }
+    feed_int(cmd.slice.options.mask());
+    feed_int(cmd.slice.cql_format().protocol_version());
+    feed_int(cmd.slice.partition_row_limit());
+    feed_int(cmd.row_limit);
+    feed_int(cmd.partition_limit);
+    feed_int(static_cast<uint64_t>(cl));
+    return h.finalize_uint64();
+}
+
+stdx::optional<storage_proxy::hot_key_result_cache::cache_key>
+storage_proxy::make_hot_key_cache_key(const query::read_command& cmd, const dht::partition_range& pr, db::consistency_level cl) {
+    if (cmd.slice.get_specific_ranges()) {
+        // Paging inside a partition; consecutive pages differ, not worth caching.
+        return stdx::nullopt;
+    }
+    if (!pr.start() || !pr.start()->value().has_key()) {
+        return stdx::nullopt;
+    }
+    auto key = bytes_view(pr.start()->value().key()->representation());
+    return hot_key_result_cache::cache_key{cmd.cf_id, bytes(key.begin(), key.end()), hot_key_slice_digest(cmd, cl)};
+}
+
 future<foreign_ptr<lw_shared_ptr<query::result>>>
 storage_proxy::query_singular(lw_shared_ptr<query::read_command> cmd, dht::partition_range_vector&& partition_ranges, db::consistency_level cl,
                               tracing::trace_state_ptr trace_state,
                               clock_type::time_point timeout) {
+    // Reads at CL.ONE make no promise beyond what a single replica knows -
+    // the same reasoning behind db::read_repair_decision for them - so a
+    // short-TTL coordinator-local copy of the page is within their contract
+    // and the cache is used for them unconditionally.
+    // Once a key storms, every coordinator holds a copy, which spreads the
+    // load that used to converge on the owning replicas across the whole
+    // cluster. Stronger consistency levels use the cache only when the
+    // operator opted in.
+    stdx::optional<hot_key_result_cache::cache_key> cache_key;
+    bool use_hot_key_cache = cl == db::consistency_level::ONE || cl == db::consistency_level::LOCAL_ONE
+            || _db.local().get_config().hot_key_result_cache_enabled();
+    if (use_hot_key_cache && partition_ranges.size() == 1) {
+        cache_key = make_hot_key_cache_key(*cmd, partition_ranges[0], cl);
+        if (cache_key) {
+            if (auto cached = _hot_key_cache.lookup(*cache_key)) {
+                ++_stats.hot_key_cache_hits;
+                return make_ready_future<foreign_ptr<lw_shared_ptr<query::result>>>(make_foreign(std::move(*cached)));
+            }
+            // An identical read may already be executing (dashboard fan-out
+            // tends to issue the same page many times at once). Attach to it
+            // instead of asking the replicas for the same data again. The
+            // attached read completes with the leader's timeout, which under
+            // the same config differs from ours by the queueing delay only.
+            auto it = _inflight_reads.find(*cache_key);
+            if (it != _inflight_reads.end()) {
+                ++_stats.reads_coalesced;
+                tracing::trace(trace_state, "Attaching to an identical in-flight read");
+                auto inflight = it->second;
+                ++inflight->waiters;
+                return inflight->done.get_shared_future().then([inflight] {
+                    return make_ready_future<foreign_ptr<lw_shared_ptr<query::result>>>(make_foreign(inflight->result));
+                });
+            }
+        }
+    }
+
+    if (partition_ranges.size() > 1
+            && (cl == db::consistency_level::ONE || cl == db::consistency_level::LOCAL_ONE)
+            && service::get_local_storage_service().cluster_supports_read_data_multi()) {
+        if (auto f = try_read_data_multi(cmd, partition_ranges, cl, trace_state, timeout)) {
+            return std::move(*f).then_wrapped([p = shared_from_this(), cmd, partition_ranges = std::move(partition_ranges), cl, trace_state, timeout] (
+                    future<foreign_ptr<lw_shared_ptr<query::result>>> f) mutable {
+                if (!f.failed()) {
+                    return make_ready_future<foreign_ptr<lw_shared_ptr<query::result>>>(f.get0());
+                }
+                // The batched read failed as a whole; retry on the per-range
+                // executor path, which reports errors per range and can pick
+                // other replicas.
+                slogger.debug("read_data_multi failed, falling back to per-range reads: {}", f.get_exception());
+                return p->do_query_singular(cmd, std::move(partition_ranges), cl, std::move(trace_state), timeout, stdx::nullopt);
+            });
+        }
+    }
+
+    return do_query_singular(cmd, std::move(partition_ranges), cl, std::move(trace_state), timeout, std::move(cache_key));
+}
+
+stdx::optional<future<foreign_ptr<lw_shared_ptr<query::result>>>>
+storage_proxy::try_read_data_multi(lw_shared_ptr<query::read_command> cmd, const dht::partition_range_vector& partition_ranges,
+                                   db::consistency_level cl, tracing::trace_state_ptr trace_state, clock_type::time_point timeout) {
+    schema_ptr schema = local_schema_registry().get(cmd->schema_version);
+    keyspace& ks = _db.local().find_keyspace(schema->ks_name());
+    if (new_read_repair_decision(*schema) != db::read_repair_decision::NONE) {
+        // Read repair wants to involve additional replicas per key; leave
+        // that to the per-range executors.
+        return stdx::nullopt;
+    }
+    auto cf = _db.local().find_column_family(schema).shared_from_this();
+    auto* hr_cf = _db.local().get_config().cache_hit_rate_read_balancing() ? &*cf : nullptr;
+    stdx::optional<gms::inet_address> target;
+    for (auto& pr : partition_ranges) {
+        const dht::token& token = pr.start()->value().token();
+        auto targets = db::filter_for_query(cl, ks, get_live_sorted_endpoints(ks, token), db::read_repair_decision::NONE, nullptr, hr_cf);
+        if (targets.empty() || fbu::is_me(targets[0]) || (target && targets[0] != *target)) {
+            return stdx::nullopt;
+        }
+        target = targets[0];
+    }
+    // An IN-clause read fans out into one executor - and thus one READ_DATA
+    // message - per key. All keys here are owned by the same remote replica,
+    // so ask for them in a single READ_DATA_MULTI round trip instead. The
+    // replica merges the per-range results in request order, which is the
+    // order the per-range executor results would have been merged in.
+    auto ep = *target;
+    ++_stats.multi_range_reads;
+    ++_stats.data_read_attempts.get_ep_stat(ep);
+    tracing::trace(trace_state, "read_data_multi: fetching {} partition ranges from /{}", partition_ranges.size(), ep);
+    auto& ms = netw::get_local_messaging_service();
+    utils::latency_counter lc;
+    lc.start();
+    auto p = shared_from_this();
+    return std::move(ms.send_read_data_multi(netw::messaging_service::msg_addr{ep, 0}, timeout, *cmd, partition_ranges).then(
+            [p, ep, cf, lc, trace_state] (query::result&& result, rpc::optional<cache_temperature> hit_rate) mutable {
+        tracing::trace(trace_state, "read_data_multi: got response from /{}", ep);
+        p->record_endpoint_read_latency(ep, lc.stop().latency());
+        cf->set_hit_rate(ep, hit_rate.value_or(cache_temperature::invalid()));
+        ++p->_stats.data_read_completed.get_ep_stat(ep);
+        return make_ready_future<foreign_ptr<lw_shared_ptr<query::result>>>(make_foreign(::make_lw_shared<query::result>(std::move(result))));
+    }));
+}
+
+future<foreign_ptr<lw_shared_ptr<query::result>>>
+storage_proxy::do_query_singular(lw_shared_ptr<query::read_command> cmd, dht::partition_range_vector&& partition_ranges, db::consistency_level cl,
+                              tracing::trace_state_ptr trace_state,
+                              clock_type::time_point timeout,
+                              stdx::optional<hot_key_result_cache::cache_key> cache_key) {
     std::vector<::shared_ptr<abstract_read_executor>> exec;
     exec.reserve(partition_ranges.size());
 
@@ -2981,6 +3633,41 @@ storage_proxy::query_singular(lw_shared_ptr<query::read_command> cmd, dht::parti
         });
     }, std::move(merger));
 
+    if (cache_key) {
+        // Registered only now so that a synchronous failure above cannot
+        // leave an entry whose promise nobody will resolve.
+        auto inflight = make_lw_shared<inflight_read>();
+        _inflight_reads.emplace(*cache_key, inflight);
+        f = f.then_wrapped([this, inflight, k = *cache_key] (future<foreign_ptr<lw_shared_ptr<query::result>>> f) {
+            _inflight_reads.erase(k);
+            if (f.failed()) {
+                auto eptr = f.get_exception();
+                inflight->done.set_exception(eptr);
+                return make_exception_future<foreign_ptr<lw_shared_ptr<query::result>>>(std::move(eptr));
+            }
+            auto result = f.get0();
+            if (inflight->waiters) {
+                // The result may live on another shard; the waiters share a
+                // local copy of the serialized page.
+                inflight->result = make_lw_shared<query::result>(bytes_ostream(result->buf()),
+                        result->is_short_read(), result->row_count(), result->partition_count());
+            }
+            inflight->done.set_value();
+            return make_ready_future<foreign_ptr<lw_shared_ptr<query::result>>>(std::move(result));
+        });
+    }
+
+    if (cache_key && _hot_key_cache.is_hot(*cache_key)) {
+        f = f.then([this, k = std::move(*cache_key)] (foreign_ptr<lw_shared_ptr<query::result>> result) mutable {
+            ++_stats.hot_key_cache_misses;
+            // The result may live on another shard; cache a local copy of the
+            // serialized page (the digest, if any, is not needed for data reads).
+            _hot_key_cache.insert(std::move(k), make_lw_shared<query::result>(bytes_ostream(result->buf()),
+                    result->is_short_read(), result->row_count(), result->partition_count()));
+            return std::move(result);
+        });
+    }
+
     return f.handle_exception([exec = std::move(exec), p = shared_from_this()] (std::exception_ptr eptr) {
         // hold onto exec until read is complete
         p->handle_read_error(eptr, false);
@@ -2988,6 +3675,13 @@ storage_proxy::query_singular(lw_shared_ptr<query::read_command> cmd, dht::parti
     });
 }
 
+// Upper bound on the projected result volume of a single round of
+// concurrent subrange requests. The fan-out is sized so that, at the
+// per-range result size observed in the previous round, a round's merged
+// query::result stays below this, keeping the merge through
+// query::result_merger memory-bounded no matter how wide the scan goes.
+static constexpr size_t max_concurrent_range_scan_result_bytes = 4 << 20;
+
 future<std::vector<foreign_ptr<lw_shared_ptr<query::result>>>>
 storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::time_point timeout, std::vector<foreign_ptr<lw_shared_ptr<query::result>>>&& results,
         lw_shared_ptr<query::read_command> cmd, db::consistency_level cl, dht::partition_range_vector::iterator&& i,
@@ -3082,6 +3776,9 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
     query::result_merger merger(cmd->row_limit, cmd->partition_limit);
     merger.reserve(exec.size());
 
+    _stats.range_scan_subranges += exec.size();
+    ++_stats.range_scan_rounds;
+
     auto f = ::map_reduce(exec.begin(), exec.end(), [timeout] (::shared_ptr<abstract_read_executor>& rex) {
         return rex->execute(timeout);
     }, std::move(merger));
@@ -3090,16 +3787,39 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
                    cl, cmd, concurrency_factor, timeout, remaining_row_count, remaining_partition_count, trace_state = std::move(trace_state)]
                    (foreign_ptr<lw_shared_ptr<query::result>>&& result) mutable {
         result->ensure_counts();
-        remaining_row_count -= result->row_count().value();
+        auto fetched_rows = result->row_count().value();
+        auto fetched_bytes = result->buf().size();
+        remaining_row_count -= fetched_rows;
         remaining_partition_count -= result->partition_count().value();
         results.emplace_back(std::move(result));
         if (i == ranges.end() || !remaining_row_count || !remaining_partition_count) {
             return make_ready_future<std::vector<foreign_ptr<lw_shared_ptr<query::result>>>>(std::move(results));
         } else {
+            // Size the next round's fan-out from what this one yielded
+            // instead of blindly doubling: issue as many subranges as it
+            // would take, at the observed rows per range, to satisfy the
+            // remaining limit in one round. Sparse ranges thus fan out
+            // very wide while a scan about to hit its limit stays narrow.
+            // The projected result volume of a round is kept bounded, so
+            // the merged query::result cannot blow up no matter how empty
+            // the ranges turn out to be.
+            auto ranges_queried = std::max(exec.size(), size_t(1));
+            int next_concurrency_factor;
+            if (!fetched_rows) {
+                next_concurrency_factor = concurrency_factor * 4;
+            } else {
+                next_concurrency_factor = (uint64_t(remaining_row_count) * ranges_queried + fetched_rows - 1) / fetched_rows;
+            }
+            next_concurrency_factor = std::min<int>(next_concurrency_factor, concurrency_factor * 16);
+            auto bytes_per_range = fetched_bytes / ranges_queried + 1;
+            next_concurrency_factor = std::min<int>(next_concurrency_factor, max_concurrent_range_scan_result_bytes / bytes_per_range + 1);
+            next_concurrency_factor = std::max(next_concurrency_factor, 1);
+            slogger.trace("range scan fetched {} rows / {} bytes from {} subranges, next fan-out {}",
+                    fetched_rows, fetched_bytes, ranges_queried, next_concurrency_factor);
             cmd->row_limit = remaining_row_count;
             cmd->partition_limit = remaining_partition_count;
             return p->query_partition_key_range_concurrent(timeout, std::move(results), cmd, cl, std::move(i),
-                    std::move(ranges), concurrency_factor * 2, std::move(trace_state), remaining_row_count, remaining_partition_count);
+                    std::move(ranges), next_concurrency_factor, std::move(trace_state), remaining_row_count, remaining_partition_count);
         }
     }).handle_exception([p] (std::exception_ptr eptr) {
         p->handle_read_error(eptr, true);
@@ -3166,6 +3886,7 @@ storage_proxy::query(schema_ptr s,
     db::consistency_level cl, tracing::trace_state_ptr trace_state,
     clock_type::time_point timeout)
 {
+    utils::cpu_profiler::scope profiler_scope(utils::cpu_profiler::component::coordinator_read);
     if (slogger.is_enabled(logging::log_level::trace) || qlogger.is_enabled(logging::log_level::trace)) {
         static thread_local int next_id = 0;
         auto query_id = next_id++;
@@ -3724,6 +4445,70 @@ void storage_proxy::init_messaging_service() {
                 [src_addr = std::move(src_addr), &cinfo, forward = std::move(forward), reply_to, shard, response_id, trace_state_ptr, timeout] (const frozen_mutation& m, shared_ptr<storage_proxy>& p, size_t& errors) mutable {
             ++p->_stats.received_mutations;
             p->_stats.forwarded_mutations += forward.size();
+            if (!forward.empty() && get_dc(reply_to) != get_local_dc() &&
+                    get_local_storage_service().cluster_supports_mutation_forward()) {
+                // The origin is in another datacenter and the whole cluster
+                // understands the aggregated protocol: collect the acks of
+                // the replicas in this DC and reply across the WAN once,
+                // instead of having each replica ack the origin individually.
+                return do_with(std::vector<gms::inet_address>(),
+                        [&m, &p, &errors, src_addr, reply_to, shard, response_id, trace_state_ptr, timeout, forward = std::move(forward)] (std::vector<gms::inet_address>& acked) mutable {
+                    acked.reserve(forward.size() + 1);
+                    return when_all(
+                        futurize<void>::apply([timeout, &p, &m, src_addr] () mutable {
+                            // FIXME: get_schema_for_write() doesn't timeout
+                            return get_schema_for_write(m.schema_version(), std::move(src_addr)).then([&m, &p, timeout] (schema_ptr s) {
+                                return p->mutate_locally(std::move(s), m, timeout);
+                            });
+                        }).then_wrapped([&acked, &errors, reply_to, shard] (future<> f) {
+                            if (f.failed()) {
+                                seastar::log_level l = seastar::log_level::warn;
+                                auto eptr = f.get_exception();
+                                try {
+                                    std::rethrow_exception(eptr);
+                                } catch (timed_out_error&) {
+                                    // ignore timeouts so that logs are not flooded.
+                                    // database total_writes_timedout counter was incremented.
+                                    l = seastar::log_level::debug;
+                                } catch (...) {
+                                    // ignore
+                                }
+                                slogger.log(l, "Failed to apply mutation from {}#{}: {}", reply_to, shard, eptr);
+                                errors++;
+                            } else {
+                                acked.push_back(utils::fb_utilities::get_broadcast_address());
+                            }
+                        }),
+                        parallel_for_each(forward.begin(), forward.end(), [&m, &p, &acked, &errors, trace_state_ptr, timeout] (gms::inet_address target) {
+                            auto& ms = netw::get_local_messaging_service();
+                            tracing::trace(trace_state_ptr, "Forwarding a mutation to /{}", target);
+                            return ms.send_mutation_forward(netw::messaging_service::msg_addr{target, 0}, timeout, m,
+                                    tracing::make_trace_info(trace_state_ptr)).then_wrapped([&p, &acked, &errors, target] (future<> f) {
+                                if (f.failed()) {
+                                    ++p->_stats.forwarding_errors;
+                                    errors++;
+                                } else {
+                                    acked.push_back(target);
+                                }
+                                f.ignore_ready_future();
+                            });
+                        })
+                    ).then_wrapped([&acked, &errors, reply_to, shard, response_id, trace_state_ptr] (future<std::tuple<future<>, future<>>>&& f) {
+                        f.ignore_ready_future();
+                        auto& ms = netw::get_local_messaging_service();
+                        // As with MUTATION_DONE, wait for the send so that a busy
+                        // reply_to cannot make unsent responses pile up and OOM
+                        // our shard.
+                        tracing::trace(trace_state_ptr, "Sending aggregated mutation_done ({} acks, {} failures) to /{}", acked.size(), errors, reply_to);
+                        return ms.send_mutation_done_multi(netw::messaging_service::msg_addr{reply_to, shard}, shard, response_id, std::move(acked), errors).then_wrapped([] (future<> f) {
+                            f.ignore_ready_future();
+                            return netw::messaging_service::no_wait();
+                        });
+                    }).finally([trace_state_ptr] {
+                        tracing::trace(trace_state_ptr, "Mutation handling is done");
+                    });
+                });
+            }
             return when_all(
                 // mutate_locally() may throw, putting it into apply() converts exception to a future.
                 futurize<void>::apply([timeout, &p, &m, reply_to, src_addr = std::move(src_addr)] () mutable {
@@ -3786,6 +4571,99 @@ void storage_proxy::init_messaging_service() {
             });
         });
     });
+    ms.register_mutation_forward([] (const rpc::client_info& cinfo, rpc::opt_time_point t, frozen_mutation in, rpc::optional<std::experimental::optional<tracing::trace_info>> trace_info) {
+        tracing::trace_state_ptr trace_state_ptr;
+        auto src_addr = netw::messaging_service::get_source(cinfo);
+
+        if (trace_info && *trace_info) {
+            tracing::trace_info& tr_info = **trace_info;
+            trace_state_ptr = tracing::tracing::get_local_tracing_instance().create_session(tr_info);
+            tracing::begin(trace_state_ptr);
+            tracing::trace(trace_state_ptr, "Message received from /{}", src_addr.addr);
+        }
+
+        storage_proxy::clock_type::time_point timeout;
+        if (!t) {
+            auto timeout_in_ms = get_local_shared_storage_proxy()->_db.local().get_config().write_request_timeout_in_ms();
+            timeout = clock_type::now() + std::chrono::milliseconds(timeout_in_ms);
+        } else {
+            timeout = *t;
+        }
+
+        return do_with(std::move(in), get_local_shared_storage_proxy(),
+                [src_addr = std::move(src_addr), timeout, trace_state_ptr] (const frozen_mutation& m, shared_ptr<storage_proxy>& p) mutable {
+            ++p->_stats.received_mutations;
+            // The ack is the RPC reply itself; a failure propagates to the
+            // forwarding coordinator as an exceptional reply and is folded
+            // into its aggregated response.
+            return futurize<void>::apply([timeout, &p, &m, src_addr = std::move(src_addr)] () mutable {
+                // FIXME: get_schema_for_write() doesn't timeout
+                return get_schema_for_write(m.schema_version(), std::move(src_addr)).then([&m, &p, timeout] (schema_ptr s) {
+                    return p->mutate_locally(std::move(s), m, timeout);
+                });
+            }).finally([trace_state_ptr] {
+                tracing::trace(trace_state_ptr, "Mutation handling is done");
+            });
+        });
+    });
+    ms.register_mutation_batch([] (const rpc::client_info& cinfo, rpc::opt_time_point t, std::vector<frozen_mutation> in,
+            gms::inet_address reply_to, unsigned shard, std::vector<storage_proxy::response_id_type> response_ids) {
+        auto src_addr = netw::messaging_service::get_source(cinfo);
+
+        storage_proxy::clock_type::time_point timeout;
+        if (!t) {
+            auto timeout_in_ms = get_local_shared_storage_proxy()->_db.local().get_config().write_request_timeout_in_ms();
+            timeout = clock_type::now() + std::chrono::milliseconds(timeout_in_ms);
+        } else {
+            timeout = *t;
+        }
+
+        return do_with(std::move(in), std::move(response_ids), get_local_shared_storage_proxy(),
+                [src_addr = std::move(src_addr), reply_to, shard, timeout] (std::vector<frozen_mutation>& mutations, std::vector<storage_proxy::response_id_type>& ids, shared_ptr<storage_proxy>& p) {
+            p->_stats.received_mutations += mutations.size();
+            // Each mutation is applied and acknowledged independently; the
+            // batching only amortizes the request side of the verb.
+            return parallel_for_each(boost::irange<size_t>(0, mutations.size()), [&mutations, &ids, &p, src_addr, reply_to, shard, timeout] (size_t i) {
+                auto& m = mutations[i];
+                auto response_id = ids[i];
+                return futurize<void>::apply([timeout, &p, &m, src_addr] () mutable {
+                    // FIXME: get_schema_for_write() doesn't timeout
+                    return get_schema_for_write(m.schema_version(), std::move(src_addr)).then([&m, &p, timeout] (schema_ptr s) {
+                        return p->mutate_locally(std::move(s), m, timeout);
+                    });
+                }).then([reply_to, shard, response_id] {
+                    auto& ms = netw::get_local_messaging_service();
+                    // As with MUTATION, wait for the ack send so that a busy
+                    // reply_to cannot make unsent responses pile up and OOM
+                    // our shard.
+                    return ms.send_mutation_done(netw::messaging_service::msg_addr{reply_to, shard}, shard, response_id).then_wrapped([] (future<> f) {
+                        f.ignore_ready_future();
+                    });
+                }).handle_exception([reply_to, shard, response_id] (std::exception_ptr eptr) {
+                    seastar::log_level l = seastar::log_level::warn;
+                    try {
+                        std::rethrow_exception(eptr);
+                    } catch (timed_out_error&) {
+                        // ignore timeouts so that logs are not flooded.
+                        // database total_writes_timedout counter was incremented.
+                        l = seastar::log_level::debug;
+                    } catch (...) {
+                        // ignore
+                    }
+                    slogger.log(l, "Failed to apply mutation from {}#{}: {}", reply_to, shard, eptr);
+                    if (get_local_storage_service().cluster_supports_write_failure_reply()) {
+                        auto& ms = netw::get_local_messaging_service();
+                        return ms.send_mutation_failed(netw::messaging_service::msg_addr{reply_to, shard}, shard, response_id, 1).then_wrapped([] (future<> f) {
+                            f.ignore_ready_future();
+                        });
+                    }
+                    return make_ready_future<>();
+                });
+            }).then([] {
+                return netw::messaging_service::no_wait();
+            });
+        });
+    });
     ms.register_mutation_done([] (const rpc::client_info& cinfo, unsigned shard, storage_proxy::response_id_type response_id) {
         auto& from = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
         return get_storage_proxy().invoke_on(shard, [from, response_id] (storage_proxy& sp) {
@@ -3800,6 +4678,21 @@ void storage_proxy::init_messaging_service() {
             return netw::messaging_service::no_wait();
         });
     });
+    ms.register_mutation_done_multi([] (const rpc::client_info& cinfo, unsigned shard, storage_proxy::response_id_type response_id,
+            std::vector<gms::inet_address> acked, size_t num_failed) {
+        auto& from = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
+        return get_storage_proxy().invoke_on(shard, [from, response_id, acked = std::move(acked), num_failed] (storage_proxy& sp) {
+            for (auto&& ep : acked) {
+                sp.got_response(response_id, ep);
+            }
+            if (num_failed) {
+                // Attribute the failures to the forwarding coordinator, the
+                // same way the plain path does when a forwarded send fails.
+                sp.got_failure_response(response_id, from, num_failed);
+            }
+            return netw::messaging_service::no_wait();
+        });
+    });
     ms.register_read_data([] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda) {
         tracing::trace_state_ptr trace_state_ptr;
         auto src_addr = netw::messaging_service::get_source(cinfo);
@@ -3829,6 +4722,53 @@ void storage_proxy::init_messaging_service() {
             });
         });
     });
+    ms.register_read_data_multi([] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, std::vector<compat::wrapping_partition_range> prs) {
+        tracing::trace_state_ptr trace_state_ptr;
+        auto src_addr = netw::messaging_service::get_source(cinfo);
+        if (cmd.trace_info) {
+            trace_state_ptr = tracing::tracing::get_local_tracing_instance().create_session(*cmd.trace_info);
+            tracing::begin(trace_state_ptr);
+            tracing::trace(trace_state_ptr, "read_data_multi: message received from /{} for {} ranges", src_addr.addr, prs.size());
+        }
+        auto max_size = cinfo.retrieve_auxiliary<uint64_t>("max_result_size");
+        return do_with(std::move(prs), get_local_shared_storage_proxy(), std::move(trace_state_ptr), cache_temperature(cache_temperature::invalid()),
+                [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), max_size, t] (
+                        std::vector<compat::wrapping_partition_range>& prs,
+                        shared_ptr<storage_proxy>& p,
+                        tracing::trace_state_ptr& trace_state_ptr,
+                        cache_temperature& hit_rate) mutable {
+            p->_stats.replica_data_reads += prs.size();
+            auto src_ip = src_addr.addr;
+            return get_schema_for_read(cmd->schema_version, std::move(src_addr)).then([cmd, &prs, &p, &trace_state_ptr, &hit_rate, max_size, t] (schema_ptr s) {
+                auto timeout = t ? *t : db::no_timeout;
+                query::result_options opts;
+                opts.digest_algo = query::digest_algorithm::none;
+                opts.request = query::result_request::only_result;
+                query::result_merger merger(cmd->row_limit, cmd->partition_limit);
+                merger.reserve(prs.size());
+                // One schema lookup and one reply for the whole batch; the
+                // per-range reads still run concurrently on their home shards,
+                // and are merged in request order so the combined result is
+                // the one the sender would have produced itself.
+                return ::map_reduce(prs.begin(), prs.end(), [cmd, s, &p, &trace_state_ptr, &hit_rate, opts, max_size, timeout] (compat::wrapping_partition_range& pr) {
+                    auto pr2 = compat::unwrap(std::move(pr), *s);
+                    if (pr2.second) {
+                        // this function assumes singular queries but doesn't validate
+                        throw std::runtime_error("READ_DATA_MULTI called with wrapping range");
+                    }
+                    return p->query_result_local(s, cmd, std::move(pr2.first), opts, trace_state_ptr, timeout, max_size).then(
+                            [&hit_rate] (foreign_ptr<lw_shared_ptr<query::result>> result, cache_temperature ht) {
+                        hit_rate = ht;
+                        return std::move(result);
+                    });
+                }, std::move(merger));
+            }).then([&hit_rate] (foreign_ptr<lw_shared_ptr<query::result>> result) {
+                return make_ready_future<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>(std::move(result), hit_rate);
+            }).finally([&trace_state_ptr, src_ip] () mutable {
+                tracing::trace(trace_state_ptr, "read_data_multi handling is done, sending a response to /{}", src_ip);
+            });
+        });
+    });
     ms.register_read_mutation_data([] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, compat::wrapping_partition_range pr) {
         tracing::trace_state_ptr trace_state_ptr;
         auto src_addr = netw::messaging_service::get_source(cinfo);
@@ -3904,9 +4844,13 @@ void storage_proxy::init_messaging_service() {
 void storage_proxy::uninit_messaging_service() {
     auto& ms = netw::get_local_messaging_service();
     ms.unregister_mutation();
+    ms.unregister_mutation_forward();
+    ms.unregister_mutation_batch();
     ms.unregister_mutation_done();
     ms.unregister_mutation_failed();
+    ms.unregister_mutation_done_multi();
     ms.unregister_read_data();
+    ms.unregister_read_data_multi();
     ms.unregister_read_mutation_data();
     ms.unregister_read_digest();
     ms.unregister_truncate();
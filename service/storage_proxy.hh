@@ -51,7 +51,11 @@
 #include "db/hints/manager.hh"
 #include "utils/histogram.hh"
 #include "utils/estimated_histogram.hh"
+#include "utils/rate_limiter.hh"
+#include "utils/space_saving.hh"
+#include "utils/timer_wheel.hh"
 #include "tracing/trace_state.hh"
+#include <seastar/core/shared_future.hh>
 #include <seastar/core/metrics.hh>
 #include "frozen_mutation.hh"
 #include "db/config.hh"
@@ -74,7 +78,9 @@ public:
 private:
     struct rh_entry {
         ::shared_ptr<abstract_write_response_handler> handler;
-        timer<clock_type> expire_timer;
+        // Linked into _expiry_wheel; per-request timer<>s are too expensive
+        // to arm and disarm at the write rates a shard handles.
+        utils::timer_wheel<clock_type>::entry expire_timer;
         rh_entry(::shared_ptr<abstract_write_response_handler>&& h, std::function<void()>&& cb);
     };
 
@@ -90,6 +96,17 @@ private:
         response_id_type release();
     };
 
+    // A remote write deferred by send_to_live_endpoints() so that all writes
+    // headed to the same destination within one request can be flushed as a
+    // single MUTATION_BATCH verb, amortizing per-message overhead across e.g.
+    // an unlogged batch spanning many partitions.
+    struct coalesced_write {
+        response_id_type id;
+        ::shared_ptr<abstract_write_response_handler> handler;
+        lw_shared_ptr<const frozen_mutation> mutation;
+    };
+    using coalesced_write_map = std::unordered_map<gms::inet_address, std::vector<coalesced_write>>;
+
     static const sstring COORDINATOR_STATS_CATEGORY;
     static const sstring REPLICA_STATS_CATEGORY;
 
@@ -151,10 +168,16 @@ public:
         // write attempts due to Read Repair logic
         split_stats read_repair_write_attempts;
 
+        // Subranges issued by range scans and the rounds they were issued
+        // in; their ratio is the average range scan fan-out.
+        uint64_t range_scan_subranges = 0;
+        uint64_t range_scan_rounds = 0;
+
         uint64_t read_repair_attempts = 0;
         uint64_t read_repair_repaired_blocking = 0;
         uint64_t read_repair_repaired_background = 0;
         uint64_t global_read_repairs_canceled_due_to_concurrent_write = 0;
+        uint64_t read_repair_coalesced_writes = 0;
 
         // number of mutations received as a coordinator
         uint64_t received_mutations = 0;
@@ -187,6 +210,11 @@ public:
         uint64_t throttled_writes = 0; // total number of writes ever delayed due to throttling
         uint64_t speculative_digest_reads = 0;
         uint64_t speculative_data_reads = 0;
+        uint64_t reads_coalesced = 0; // reads attached to an identical in-flight read
+        uint64_t multi_range_reads = 0; // multi-key reads collapsed into a single READ_DATA_MULTI request
+        uint64_t hot_key_cache_hits = 0; // singular reads served from the hot key result cache
+        uint64_t hot_key_cache_misses = 0; // hot key reads which had to be executed and (re)populated the cache
+        uint64_t digest_read_bypass_reads = 0; // quorum reads served from a single replica due to proven digest agreement
 
         // Data read attempts
         split_stats data_read_attempts;
@@ -210,6 +238,9 @@ private:
     distributed<database>& _db;
     response_id_type _next_response_id = 1; // 0 is reserved for unique_response_handler
     std::unordered_map<response_id_type, rh_entry> _response_handlers;
+    // Expires response handlers at ~10ms granularity; arming a wheel entry
+    // is an O(1) list link, unlike a timer<> arm through the timer set.
+    utils::timer_wheel<clock_type> _expiry_wheel{std::chrono::milliseconds(10)};
     // This buffer hold ids of throttled writes in case resource consumption goes
     // below the threshold and we want to unthrottle some of them. Without this throttled
     // request with dead or slow replica may wait for up to timeout ms before replying
@@ -225,6 +256,99 @@ private:
     std::default_random_engine _urandom;
     std::uniform_real_distribution<> _read_repair_chance = std::uniform_real_distribution<>(0,1);
     seastar::metrics::metric_groups _metrics;
+    // Per-endpoint read latency tracking, used by the speculating read
+    // executor to fire a backup request when a replica exceeds its own
+    // latency percentile rather than the table-wide one.
+    struct endpoint_read_latency_tracker {
+        utils::estimated_histogram hist;
+        lowres_clock::time_point percentile_cache_timestamp;
+        std::chrono::milliseconds percentile_cache_value;
+        double cached_percentile = 0;
+    };
+    std::unordered_map<gms::inet_address, endpoint_read_latency_tracker> _endpoint_read_latencies;
+    // Per-table digest agreement tracking for the digest read bypass
+    // (digest_read_bypass_enabled): every digest-checked read records
+    // whether the replica digests matched, and tables whose observed
+    // mismatch rate is negligible have most of their quorum reads served by
+    // a single replica, with a sample kept on the full path to notice when
+    // replicas start disagreeing.
+    struct digest_agreement_tracker {
+        uint64_t checks = 0;
+        uint64_t mismatches = 0;
+        uint64_t bypassed_reads = 0;
+    };
+    std::unordered_map<utils::UUID, digest_agreement_tracker> _digest_agreement;
+    void record_digest_match(const utils::UUID& cf_id, bool match);
+    bool should_bypass_digest_reads(const utils::UUID& cf_id);
+    // Per-shard cache of serialized query results for very hot partitions,
+    // so that repeated reads of the same page do not have to be executed on
+    // the replicas over and over. Used automatically for CL.ONE/LOCAL_ONE
+    // reads; hot_key_result_cache_enabled extends it to the remaining
+    // consistency levels.
+    // Entries are keyed by the table, the partition key and a digest of the
+    // slice, and are invalidated by writes coordinated or applied by this
+    // node. Writes which never touch this node cannot invalidate, so entries
+    // also expire after a short TTL which bounds the staleness.
+    class hot_key_result_cache {
+    public:
+        struct cache_key {
+            utils::UUID cf_id;
+            bytes pkey;
+            uint64_t slice_digest;
+            bool operator==(const cache_key& o) const {
+                return cf_id == o.cf_id && slice_digest == o.slice_digest && pkey == o.pkey;
+            }
+        };
+        struct cache_key_hash {
+            size_t operator()(const cache_key& k) const;
+        };
+    private:
+        struct entry {
+            lw_shared_ptr<query::result> result;
+            clock_type::time_point expires;
+        };
+        static constexpr unsigned sample_rate = 128; // one in this many reads feeds the sketch
+        static constexpr uint64_t promote_threshold = 4; // guaranteed sampled reads before a key is considered hot
+        static constexpr size_t max_entries = 64;
+        static constexpr size_t sketch_size = 8;
+        static constexpr uint64_t sketch_window = 4096; // sampled reads between sketch agings
+        static constexpr std::chrono::milliseconds entry_ttl{1000};
+        std::unordered_map<cache_key, entry, cache_key_hash> _entries;
+        // Heavy-hitter sketch over the sampled read keys; a key whose
+        // guaranteed frequency (count minus estimation error) reaches the
+        // promotion threshold is considered hot. Aged periodically so old
+        // celebrities fade out.
+        utils::space_saving<cache_key> _sketch{sketch_size};
+        uint64_t _reads = 0;
+    public:
+        // Engaged on a hit. Also counts the read towards hotness detection.
+        stdx::optional<lw_shared_ptr<query::result>> lookup(const cache_key& k);
+        // Whether the key has been read often enough to be worth caching.
+        bool is_hot(const cache_key& k) const;
+        void insert(cache_key k, lw_shared_ptr<query::result> result);
+        void invalidate(const utils::UUID& cf_id, bytes_view pkey);
+        bool empty() const {
+            return _entries.empty();
+        }
+    };
+    hot_key_result_cache _hot_key_cache;
+    // Disengaged when the read is not cacheable (e.g. paging inside a partition).
+    static stdx::optional<hot_key_result_cache::cache_key> make_hot_key_cache_key(const query::read_command& cmd,
+            const dht::partition_range& pr, db::consistency_level cl);
+    // An identical read (same table, partition key, slice and consistency
+    // level) which is already in flight on this shard. Concurrent duplicates
+    // attach to the leader's future instead of issuing their own replica
+    // reads, and each waiter receives a coordinator-local copy of the page.
+    struct inflight_read {
+        shared_promise<> done;
+        lw_shared_ptr<query::result> result; // set before done resolves
+        unsigned waiters = 0;
+    };
+    std::unordered_map<hot_key_result_cache::cache_key, lw_shared_ptr<inflight_read>, hot_key_result_cache::cache_key_hash> _inflight_reads;
+public:
+    void record_endpoint_read_latency(gms::inet_address ep, utils::estimated_histogram::duration latency);
+    // Engaged only once the endpoint has accumulated enough samples.
+    stdx::optional<std::chrono::milliseconds> endpoint_read_latency_percentile(gms::inet_address ep, double percentile);
 private:
     void uninit_messaging_service();
     future<foreign_ptr<lw_shared_ptr<query::result>>> query_singular(lw_shared_ptr<query::read_command> cmd,
@@ -232,6 +356,20 @@ private:
                                                                      db::consistency_level cl,
                                                                      tracing::trace_state_ptr trace_state,
                                                                      clock_type::time_point timeout);
+    // The per-range read executor path of query_singular().
+    future<foreign_ptr<lw_shared_ptr<query::result>>> do_query_singular(lw_shared_ptr<query::read_command> cmd,
+                                                                     dht::partition_range_vector&& partition_ranges,
+                                                                     db::consistency_level cl,
+                                                                     tracing::trace_state_ptr trace_state,
+                                                                     clock_type::time_point timeout,
+                                                                     stdx::optional<hot_key_result_cache::cache_key> cache_key);
+    // Engaged only when all ranges are owned by the same remote replica, in
+    // which case they are fetched in a single READ_DATA_MULTI round trip.
+    stdx::optional<future<foreign_ptr<lw_shared_ptr<query::result>>>> try_read_data_multi(lw_shared_ptr<query::read_command> cmd,
+                                                                     const dht::partition_range_vector& partition_ranges,
+                                                                     db::consistency_level cl,
+                                                                     tracing::trace_state_ptr trace_state,
+                                                                     clock_type::time_point timeout);
     response_id_type register_response_handler(shared_ptr<abstract_write_response_handler>&& h);
     void remove_response_handler(response_id_type id);
     void got_response(response_id_type id, gms::inet_address from);
@@ -242,7 +380,8 @@ private:
             const std::vector<gms::inet_address>& pending_endpoints, std::vector<gms::inet_address>, tracing::trace_state_ptr tr_state);
     response_id_type create_write_response_handler(const mutation&, db::consistency_level cl, db::write_type type, tracing::trace_state_ptr tr_state);
     response_id_type create_write_response_handler(const std::unordered_map<gms::inet_address, std::experimental::optional<mutation>>&, db::consistency_level cl, db::write_type type, tracing::trace_state_ptr tr_state);
-    void send_to_live_endpoints(response_id_type response_id, clock_type::time_point timeout);
+    void send_to_live_endpoints(response_id_type response_id, clock_type::time_point timeout, coalesced_write_map* batches = nullptr);
+    void flush_coalesced_writes(coalesced_write_map batches, clock_type::time_point timeout);
     template<typename Range>
     size_t hint_to_dead_endpoints(std::unique_ptr<mutation_holder>& mh, const Range& targets, tracing::trace_state_ptr tr_state) noexcept;
     void hint_to_dead_endpoints(response_id_type, db::consistency_level);
@@ -287,7 +426,30 @@ private:
     future<std::vector<unique_response_handler>> mutate_prepare(const Range& mutations, db::consistency_level cl, db::write_type type, tracing::trace_state_ptr tr_state);
     future<> mutate_begin(std::vector<unique_response_handler> ids, db::consistency_level cl, stdx::optional<clock_type::time_point> timeout_opt = { });
     future<> mutate_end(future<> mutate_result, utils::latency_counter, tracing::trace_state_ptr trace_state);
+    // Batchlog removals buffered for the next flush; see remove_from_batchlog().
+    struct batchlog_removal {
+        utils::UUID id;
+        std::unordered_set<gms::inet_address> endpoints;
+        tracing::trace_state_ptr trace_state;
+    };
+    std::vector<batchlog_removal> _pending_batchlog_removals;
+    stdx::optional<shared_promise<>> _pending_batchlog_removal_flush;
+    future<> remove_from_batchlog(utils::UUID id, std::unordered_set<gms::inet_address> endpoints, tracing::trace_state_ptr tr_state);
+    future<> flush_batchlog_removals();
     future<> schedule_repair(std::unordered_map<dht::token, std::unordered_map<gms::inet_address, std::experimental::optional<mutation>>> diffs, db::consistency_level cl, tracing::trace_state_ptr trace_state);
+    // Read-repair diffs produced by concurrent reads of the same partition are
+    // coalesced: while a repair write for a token is in flight, later diffs are
+    // merged into a pending round sent when it completes, so a hot diverging
+    // partition produces one repair write per round instead of one per read.
+    struct pending_read_repair {
+        std::unordered_map<gms::inet_address, std::experimental::optional<mutation>> diffs;
+        db::consistency_level cl;
+        shared_promise<> done;
+    };
+    std::unordered_map<dht::token, lw_shared_ptr<pending_read_repair>> _pending_read_repairs;
+    std::unordered_map<utils::UUID, lw_shared_ptr<utils::rate_limiter>> _read_repair_limiters;
+    future<> send_repair(dht::token token, std::unordered_map<gms::inet_address, std::experimental::optional<mutation>> diffs, db::consistency_level cl, tracing::trace_state_ptr trace_state);
+    utils::rate_limiter& read_repair_limiter(const utils::UUID& cf_id);
     bool need_throttle_writes() const;
     void unthrottle();
     void handle_read_error(std::exception_ptr eptr, bool range);
@@ -301,6 +463,7 @@ private:
         frozen_mutation fm;
         schema_ptr s;
     };
+    static std::vector<frozen_mutation_and_schema> merge_counter_updates(std::vector<frozen_mutation_and_schema> updates);
     future<> mutate_counters_on_leader(std::vector<frozen_mutation_and_schema> mutations, db::consistency_level cl, clock_type::time_point timeout,
                                        tracing::trace_state_ptr trace_state);
     future<> mutate_counter_on_leader_and_replicate(const schema_ptr& s, frozen_mutation m, db::consistency_level cl, clock_type::time_point timeout,
@@ -94,6 +94,9 @@ static const sstring CORRECT_NON_COMPOUND_RANGE_TOMBSTONES = "CORRECT_NON_COMPOU
 static const sstring WRITE_FAILURE_REPLY_FEATURE = "WRITE_FAILURE_REPLY";
 static const sstring XXHASH_FEATURE = "XXHASH";
 static const sstring ROLES_FEATURE = "ROLES";
+static const sstring MUTATION_BATCH_FEATURE = "MUTATION_BATCH";
+static const sstring MUTATION_FORWARD_FEATURE = "MUTATION_FORWARD";
+static const sstring READ_DATA_MULTI_FEATURE = "READ_DATA_MULTI";
 
 distributed<storage_service> _the_storage_service;
 
@@ -144,6 +147,9 @@ sstring storage_service::get_config_supported_features() {
         WRITE_FAILURE_REPLY_FEATURE,
         XXHASH_FEATURE,
         ROLES_FEATURE,
+        MUTATION_BATCH_FEATURE,
+        MUTATION_FORWARD_FEATURE,
+        READ_DATA_MULTI_FEATURE,
     };
     if (service::get_local_storage_service()._db.local().get_config().experimental()) {
         features.push_back(MATERIALIZED_VIEWS_FEATURE);
@@ -358,6 +364,9 @@ void storage_service::register_features() {
     _write_failure_reply_feature = gms::feature(WRITE_FAILURE_REPLY_FEATURE);
     _xxhash_feature = gms::feature(XXHASH_FEATURE);
     _roles_feature = gms::feature(ROLES_FEATURE);
+    _mutation_batch_feature = gms::feature(MUTATION_BATCH_FEATURE);
+    _mutation_forward_feature = gms::feature(MUTATION_FORWARD_FEATURE);
+    _read_data_multi_feature = gms::feature(READ_DATA_MULTI_FEATURE);
 
     if (_db.local().get_config().experimental()) {
         _materialized_views_feature = gms::feature(MATERIALIZED_VIEWS_FEATURE);
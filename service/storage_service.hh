@@ -278,6 +278,9 @@ private:
     gms::feature _write_failure_reply_feature;
     gms::feature _xxhash_feature;
     gms::feature _roles_feature;
+    gms::feature _mutation_batch_feature;
+    gms::feature _mutation_forward_feature;
+    gms::feature _read_data_multi_feature;
 public:
     void enable_all_features() {
         _range_tombstones_feature.enable();
@@ -292,6 +295,9 @@ public:
         _write_failure_reply_feature.enable();
         _xxhash_feature.enable();
         _roles_feature.enable();
+        _mutation_batch_feature.enable();
+        _mutation_forward_feature.enable();
+        _read_data_multi_feature.enable();
     }
 
     void finish_bootstrapping() {
@@ -2273,6 +2279,18 @@ public:
     bool cluster_supports_roles() const {
         return bool(_roles_feature);
     }
+
+    bool cluster_supports_mutation_batch() const {
+        return bool(_mutation_batch_feature);
+    }
+
+    bool cluster_supports_mutation_forward() const {
+        return bool(_mutation_forward_feature);
+    }
+
+    bool cluster_supports_read_data_multi() const {
+        return bool(_read_data_multi_feature);
+    }
 };
 
 inline future<> init_storage_service(distributed<database>& db, sharded<auth::service>& auth_service) {
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "service/workload_group.hh"
+
+#include <seastar/core/print.hh>
+#include <seastar/core/future-util.hh>
+
+#include "db/system_keyspace.hh"
+#include "log.hh"
+
+namespace service {
+
+static logging::logger wlogger("workload_group");
+
+distributed<workload_group_registry> _the_workload_group_registry;
+
+constexpr std::chrono::seconds workload_group_registry::refresh_interval;
+constexpr unsigned workload_group_registry::default_shares;
+
+future<> workload_group_registry::start() {
+    if (engine().cpu_id() != 0) {
+        return make_ready_future<>();
+    }
+    _refresh_timer.set_callback([this] {
+        // Chain the refreshes so a slow query cannot overlap with the next
+        // tick, and so stop() can wait for the one in flight.
+        _pending_refresh = _pending_refresh.then([this] {
+            return refresh().handle_exception([] (std::exception_ptr ep) {
+                wlogger.warn("Failed to refresh workload groups: {}", ep);
+            });
+        });
+    });
+    _refresh_timer.arm_periodic(refresh_interval);
+    return make_ready_future<>();
+}
+
+future<> workload_group_registry::stop() {
+    _refresh_timer.cancel();
+    return std::exchange(_pending_refresh, make_ready_future<>());
+}
+
+future<> workload_group_registry::create_group(sstring role, unsigned shares) {
+    return seastar::create_scheduling_group(sprint("wl:%s", role), shares).then([this, role = std::move(role), shares] (scheduling_group sg) {
+        return container().invoke_on_all([sg, role, shares] (workload_group_registry& r) {
+            // I/O priority classes are per reactor; each shard registers its
+            // own under the same name.
+            auto pc = engine().register_one_priority_class(sprint("wl:%s", role), shares);
+            r._groups.emplace(role, group{sg, pc, shares});
+        });
+    });
+}
+
+future<> workload_group_registry::update_shares(sstring role, unsigned shares) {
+    return container().invoke_on_all([role, shares] (workload_group_registry& r) {
+        auto i = r._groups.find(role);
+        if (i == r._groups.end() || i->second.shares == shares) {
+            return make_ready_future<>();
+        }
+        i->second.shares = shares;
+        i->second.sg.set_shares(shares);
+        return engine().update_shares_for_class(i->second.pc, shares);
+    });
+}
+
+future<> workload_group_registry::refresh() {
+    return db::system_keyspace::load_workload_groups().then([this] (std::unordered_map<sstring, int32_t> loaded) {
+        return do_with(std::move(loaded), [this] (std::unordered_map<sstring, int32_t>& loaded) {
+            return parallel_for_each(loaded, [this] (const std::pair<const sstring, int32_t>& e) {
+                auto shares = unsigned(std::max(e.second, int32_t(1)));
+                auto i = _groups.find(e.first);
+                if (i == _groups.end()) {
+                    wlogger.info("Creating workload group for role {} with {} shares", e.first, shares);
+                    return create_group(e.first, shares);
+                } else if (i->second.shares != shares) {
+                    wlogger.info("Updating workload group for role {} to {} shares", e.first, shares);
+                    return update_shares(e.first, shares);
+                }
+                return make_ready_future<>();
+            }).then([this, &loaded] {
+                // A role deleted from the table keeps its group but reverts
+                // to the default shares.
+                return parallel_for_each(_groups, [this, &loaded] (const std::pair<const sstring, group>& e) {
+                    if (!loaded.count(e.first) && e.second.shares != default_shares) {
+                        wlogger.info("Resetting workload group for role {} to {} shares", e.first, default_shares);
+                        return update_shares(e.first, default_shares);
+                    }
+                    return make_ready_future<>();
+                });
+            });
+        });
+    });
+}
+
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unordered_map>
+
+#include <seastar/core/distributed.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/scheduling.hh>
+#include <seastar/core/timer.hh>
+#include <seastar/core/lowres_clock.hh>
+
+#include "seastarx.hh"
+#include "stdx.hh"
+
+namespace service {
+
+// Maps authenticated roles to seastar scheduling groups and I/O priority
+// classes, so that workloads sharing a cluster compete for reactor time at
+// configured ratios instead of a tenant's heavy scans starving everyone.
+//
+// The groups are driven by the system.workload_groups table (role text
+// PRIMARY KEY, shares int). Shard 0 polls the table, creates a scheduling
+// group and an I/O priority class for every listed role and applies share
+// changes at runtime; roles without an entry keep running in the group they
+// arrived in. Deleting a row reverts the role's shares to the default, since
+// the reactor offers no way to destroy a scheduling group.
+class workload_group_registry : public peering_sharded_service<workload_group_registry> {
+public:
+    struct group {
+        scheduling_group sg;
+        ::io_priority_class pc;
+        unsigned shares;
+    };
+private:
+    static constexpr std::chrono::seconds refresh_interval{10};
+    static constexpr unsigned default_shares = 1000;
+
+    std::unordered_map<sstring, group> _groups;
+    timer<lowres_clock> _refresh_timer; // armed on shard 0 only
+    future<> _pending_refresh = make_ready_future<>();
+public:
+    future<> start();
+    future<> stop();
+
+    // The scheduling group configured for the given role, if any. Cheap;
+    // called once per CQL request.
+    stdx::optional<scheduling_group> find(const sstring& role) const {
+        auto i = _groups.find(role);
+        if (i == _groups.end()) {
+            return stdx::nullopt;
+        }
+        return i->second.sg;
+    }
+private:
+    future<> refresh();
+    future<> create_group(sstring role, unsigned shares);
+    future<> update_shares(sstring role, unsigned shares);
+};
+
+extern distributed<workload_group_registry> _the_workload_group_registry;
+
+inline distributed<workload_group_registry>& get_workload_group_registry() {
+    return _the_workload_group_registry;
+}
+
+// Safe to call before the registry is started (e.g. in tools and tests
+// which bring up the CQL server without one); no role maps to a group then.
+inline stdx::optional<scheduling_group> find_workload_group(const sstring& role) {
+    if (!_the_workload_group_registry.local_is_initialized()) {
+        return stdx::nullopt;
+    }
+    return _the_workload_group_registry.local().find(role);
+}
+
+}
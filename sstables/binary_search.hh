@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "sstables/key.hh"
 #include "dht/i_partitioner.hh"
 
@@ -86,4 +88,65 @@ int binary_search(const T& entries, const key& sk) {
     return binary_search(entries, sk, dht::global_partitioner().get_token(key_view(sk)));
 }
 
+// Narrows the range [low, end) of summary entry indexes down to the
+// single sampling run which can contain the first entry not less than
+// the given token, using the first-level summary::token_samples array.
+// That array is contiguous and small enough to stay cache-resident
+// under load, so the narrowing touches none of the scattered entries.
+// It compares tokens only, hence the result is valid for any position
+// (before-key, exact or after-key) carrying that token.
+template <typename Summary>
+std::pair<size_t, size_t> summary_token_run(const Summary& s, const dht::token& token, size_t low, size_t end) {
+    if (!s.token_samples.empty()) {
+        auto begin = s.token_samples.begin();
+        auto first_ge = std::lower_bound(begin, s.token_samples.end(), token);
+        auto first_gt = std::upper_bound(first_ge, s.token_samples.end(), token);
+        if (first_ge != begin) {
+            // Entries with an equal token but a smaller key can precede
+            // the first sample whose token compares >= ours, hence the
+            // run starts at the last sample with a strictly smaller token.
+            low = std::max(low, size_t(first_ge - begin - 1) * Summary::token_sample_interval);
+        }
+        if (first_gt != s.token_samples.end()) {
+            end = std::min(end, size_t(first_gt - begin) * Summary::token_sample_interval);
+        }
+        end = std::max(end, low);
+    }
+    return {low, end};
+}
+
+// Two-level variant for the summary, with the same return value contract
+// as binary_search(). The first level narrows the search to a single
+// sampling run via summary_token_run(); the second level binary-searches
+// that run using the token stored in each entry, so no probe has to
+// re-hash its key.
+template <typename Summary>
+int summary_binary_search(const Summary& s, const key& sk, const dht::token& token) {
+    auto& entries = s.entries;
+    auto run = summary_token_run(s, token, 0, entries.size());
+    int low = run.first, high = int(run.second) - 1;
+    // When the narrowed run is empty the insertion point is low.
+    int mid = low, result = -1;
+    while (low <= high) {
+        mid = low + ((high - low) >> 1);
+        const auto& mid_entry = entries[mid];
+
+        if (token == mid_entry.token) {
+            result = sk.tri_compare(mid_entry.get_key());
+        } else {
+            result = token < mid_entry.token ? -1 : 1;
+        }
+
+        if (result > 0) {
+            low = mid + 1;
+        } else if (result < 0) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+
+    return -mid - (result < 0 ? 1 : 2);
+}
+
 }
@@ -52,6 +52,7 @@
 #include "core/future-util.hh"
 #include "core/pipe.hh"
 #include <seastar/core/scheduling.hh>
+#include <seastar/core/condition-variable.hh>
 
 #include "sstables.hh"
 #include "sstables/progress_monitor.hh"
@@ -435,6 +436,9 @@ private:
     virtual void stop_sstable_writer() = 0;
     // finish all writers.
     virtual void finish_sstable_writer() = 0;
+    // undo any partial result made visible to reads, as the new sstables are
+    // about to be deleted.
+    virtual void on_interrupt() {}
 
     compacting_sstable_writer get_compacting_sstable_writer() {
         return compacting_sstable_writer(*this);
@@ -475,6 +479,9 @@ void compacting_sstable_writer::consume_end_of_stream() {
 
 class regular_compaction : public compaction {
     std::function<shared_sstable()> _creator;
+    // if set, called every time an output sstable is sealed to make it visible
+    // to reads and withdraw the inputs it made redundant.
+    replacer_fn _replacer;
     // store a clone of sstable set for column family, which needs to be alive for incremental selector.
     const sstable_set _set;
     // used to incrementally calculate max purgeable timestamp, as we iterate through decorated keys.
@@ -485,14 +492,22 @@ class regular_compaction : public compaction {
     stdx::optional<compaction_weight_registration> _weight_registration;
     mutable compaction_read_monitor_generator _monitor_generator;
     std::deque<compaction_write_monitor> _active_write_monitors = {};
+    // input sstables not yet withdrawn through _replacer.
+    std::vector<shared_sstable> _unreplaced_sstables;
+    // sstables already added to and removed from the live set through _replacer,
+    // kept so the replacement can be undone if the compaction is interrupted.
+    std::vector<shared_sstable> _published_sstables;
+    std::vector<shared_sstable> _withdrawn_sstables;
 public:
-    regular_compaction(column_family& cf, compaction_descriptor descriptor, std::function<shared_sstable()> creator)
+    regular_compaction(column_family& cf, compaction_descriptor descriptor, std::function<shared_sstable()> creator, replacer_fn replacer)
         : compaction(cf, std::move(descriptor.sstables), descriptor.max_sstable_bytes, descriptor.level)
         , _creator(std::move(creator))
+        , _replacer(std::move(replacer))
         , _set(cf.get_sstable_set())
         , _selector(_set.make_incremental_selector())
         , _weight_registration(std::move(descriptor.weight_registration))
         , _monitor_generator(_cf.get_compaction_manager(), _cf)
+        , _unreplaced_sstables(_sstables)
     {
     }
 
@@ -554,6 +569,7 @@ public:
 
     virtual void stop_sstable_writer() override {
         finish_new_sstable(_writer, _sst);
+        maybe_replace_exhausted_sstables();
     }
 
     virtual void finish_sstable_writer() override {
@@ -562,7 +578,42 @@ public:
             stop_sstable_writer();
         }
     }
+
+    virtual void on_interrupt() override {
+        if (_published_sstables.empty()) {
+            return;
+        }
+        // Bring the withdrawn inputs back and withdraw the outputs we
+        // published, which are about to be deleted.
+        _replacer(std::move(_withdrawn_sstables), std::move(_published_sstables));
+    }
 private:
+    // The compaction reads its input in token order, so once an output sstable
+    // is sealed, every input whose last key doesn't exceed the output's last
+    // key had all of its data either rewritten into sealed outputs or purged.
+    // Publish the output and withdraw the exhausted inputs right away, so a
+    // long-running compaction reduces read amplification as it proceeds,
+    // instead of only when the whole job finishes, possibly hours later.
+    void maybe_replace_exhausted_sstables() {
+        if (!_replacer) {
+            return;
+        }
+        auto& s = *_cf.schema();
+        auto& last = _sst->get_last_decorated_key();
+        auto it = std::stable_partition(_unreplaced_sstables.begin(), _unreplaced_sstables.end(), [&] (const shared_sstable& sst) {
+            return sst->get_last_decorated_key().tri_compare(s, last) > 0;
+        });
+        std::vector<shared_sstable> exhausted(it, _unreplaced_sstables.end());
+        _unreplaced_sstables.erase(it, _unreplaced_sstables.end());
+        if (!exhausted.empty()) {
+            clogger.debug("Replacing earlier {} exhausted sstable(s) of {}.{} by output {}",
+                exhausted.size(), _info->ks, _info->cf, _sst->get_filename());
+        }
+        _published_sstables.push_back(_sst);
+        _withdrawn_sstables.insert(_withdrawn_sstables.end(), exhausted.begin(), exhausted.end());
+        _replacer({ _sst }, std::move(exhausted));
+    }
+
     void on_end_of_stream() {
         if (_weight_registration) {
             _cf.get_compaction_manager().on_compaction_complete(*_weight_registration);
@@ -572,8 +623,8 @@ private:
 
 class cleanup_compaction final : public regular_compaction {
 public:
-    cleanup_compaction(column_family& cf, compaction_descriptor descriptor, std::function<shared_sstable()> creator)
-        : regular_compaction(cf, std::move(descriptor), std::move(creator))
+    cleanup_compaction(column_family& cf, compaction_descriptor descriptor, std::function<shared_sstable()> creator, replacer_fn replacer)
+        : regular_compaction(cf, std::move(descriptor), std::move(creator), std::move(replacer))
     {
         _info->type = compaction_type::Cleanup;
     }
@@ -602,6 +653,26 @@ public:
     }
 };
 
+// Rewrites a single sstable just to get rid of its droppable tombstones.
+// Inherits max_purgeable_func() from regular_compaction, so a tombstone is
+// only dropped if no uncompacted sstable may contain data it shadows.
+class garbage_collect_compaction final : public regular_compaction {
+public:
+    garbage_collect_compaction(column_family& cf, compaction_descriptor descriptor, std::function<shared_sstable()> creator, replacer_fn replacer)
+        : regular_compaction(cf, std::move(descriptor), std::move(creator), std::move(replacer))
+    {
+        _info->type = compaction_type::GarbageCollect;
+    }
+
+    void report_start(const sstring& formatted_msg) const override {
+        clogger.info("Garbage collecting {}", formatted_msg);
+    }
+
+    void report_finish(const sstring& formatted_msg, std::chrono::time_point<db_clock> ended_at) const override {
+        clogger.info("Garbage collected {}", formatted_msg);
+    }
+};
+
 
 class resharding_compaction final : public compaction {
     std::vector<std::pair<shared_sstable, stdx::optional<sstable_writer>>> _output_sstables;
@@ -685,9 +756,142 @@ public:
     }
 };
 
+// A single giant partition is compacted by one fiber on one shard: the
+// partition's data lives here, and the merge itself is serial by
+// construction, so its clustering segments cannot be farmed out to other
+// cores. What can be overlapped is input and output. This reader runs a
+// background fiber that keeps pulling from the merged input stream into a
+// bounded staging buffer whenever the compacting writer is blocked on the
+// data file, so the next fragments are already read and merged when the
+// writer unblocks - bounding the worst case by max(read, write) time
+// instead of their sum.
+class prefetching_reader final : public flat_mutation_reader::impl {
+    // Shared with the pump fiber, so destroying the reader while a fill is
+    // still in flight keeps the underlying reader alive until the pump
+    // notices the abort and stops.
+    struct state {
+        flat_mutation_reader underlying;
+        circular_buffer<mutation_fragment> staged;
+        size_t staged_size = 0;
+        bool done = false;
+        bool aborted = false;
+        bool fill_in_progress = false;
+        bool pending_next_partition = false;
+        std::exception_ptr ex;
+        condition_variable staged_not_empty;
+        condition_variable staged_not_full;
+
+        explicit state(flat_mutation_reader r) : underlying(std::move(r)) {}
+    };
+    static constexpr size_t prefetch_bytes = 1 << 20;
+    lw_shared_ptr<state> _state;
+    bool _pump_started = false;
+private:
+    // Runs until end of stream, failure or abort; parks on staged_not_full
+    // while the staging buffer is at capacity.
+    void start_pump() {
+        auto s = _state;
+        (void)repeat([s] {
+            if (s->aborted) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            if (s->staged_size >= prefetch_bytes) {
+                return s->staged_not_full.wait().then([] { return stop_iteration::no; });
+            }
+            s->fill_in_progress = true;
+            return s->underlying.fill_buffer(db::no_timeout).then([s] {
+                s->fill_in_progress = false;
+                if (s->pending_next_partition) {
+                    // The consumer asked to skip the current partition while
+                    // this fill was in flight; drop its fragments instead of
+                    // staging them.
+                    s->pending_next_partition = false;
+                    s->underlying.next_partition();
+                    return stop_iteration::no;
+                }
+                while (!s->underlying.is_buffer_empty()) {
+                    auto mf = s->underlying.pop_mutation_fragment();
+                    s->staged_size += mf.memory_usage();
+                    s->staged.emplace_back(std::move(mf));
+                }
+                if (s->underlying.is_end_of_stream() && s->underlying.is_buffer_empty()) {
+                    s->done = true;
+                    return stop_iteration::yes;
+                }
+                return stop_iteration::no;
+            }).then([s] (stop_iteration stop) {
+                s->staged_not_empty.signal();
+                return stop;
+            });
+        }).then_wrapped([s] (future<> f) {
+            if (f.failed()) {
+                s->ex = f.get_exception();
+                s->done = true;
+                s->fill_in_progress = false;
+                s->staged_not_empty.signal();
+            }
+        });
+    }
+public:
+    explicit prefetching_reader(flat_mutation_reader underlying)
+        : impl(underlying.schema())
+        , _state(make_lw_shared<state>(std::move(underlying)))
+    { }
+
+    ~prefetching_reader() {
+        _state->aborted = true;
+        _state->staged_not_full.signal();
+    }
+
+    virtual future<> fill_buffer(db::timeout_clock::time_point timeout) override {
+        if (!_pump_started) {
+            _pump_started = true;
+            start_pump();
+        }
+        auto s = _state;
+        return s->staged_not_empty.wait([s] { return !s->staged.empty() || s->done; }).then([this, s] {
+            if (s->ex) {
+                return make_exception_future<>(s->ex);
+            }
+            while (!s->staged.empty()) {
+                auto mf = std::move(s->staged.front());
+                s->staged.pop_front();
+                s->staged_size -= mf.memory_usage();
+                push_mutation_fragment(std::move(mf));
+            }
+            if (s->done) {
+                _end_of_stream = true;
+            }
+            s->staged_not_full.signal();
+            return make_ready_future<>();
+        });
+    }
+
+    virtual void next_partition() override {
+        clear_buffer_to_next_partition();
+        if (!is_buffer_empty()) {
+            return;
+        }
+        auto& s = *_state;
+        while (!s.staged.empty() && !s.staged.front().is_partition_start()) {
+            s.staged_size -= s.staged.front().memory_usage();
+            s.staged.pop_front();
+        }
+        if (!s.staged.empty()) {
+            s.staged_not_full.signal();
+            return;
+        }
+        if (s.fill_in_progress) {
+            s.pending_next_partition = true;
+        } else if (!s.done) {
+            s.underlying.next_partition();
+        }
+    }
+};
+
 future<compaction_info> compaction::run(std::unique_ptr<compaction> c) {
     return seastar::async([c = std::move(c)] () mutable {
-        auto reader = c->setup();
+        auto reader = make_flat_mutation_reader<prefetching_reader>(c->setup());
 
         auto cr = c->get_compacting_sstable_writer();
         auto cfc = make_stable_flattened_mutations_consumer<compact_for_compaction<compacting_sstable_writer>>(
@@ -701,6 +905,7 @@ future<compaction_info> compaction::run(std::unique_ptr<compaction> c) {
             auto r = std::move(reader);
             r.consume_in_thread(std::move(cfc), c->filter_func());
         } catch (...) {
+            c->on_interrupt();
             delete_sstables_for_interrupted_compaction(c->_info->new_sstables, c->_info->ks, c->_info->cf);
             c = nullptr; // make sure writers are stopped while running in thread context
             throw;
@@ -711,20 +916,23 @@ future<compaction_info> compaction::run(std::unique_ptr<compaction> c) {
 }
 
 template <typename ...Params>
-static std::unique_ptr<compaction> make_compaction(bool cleanup, Params&&... params) {
-    if (cleanup) {
+static std::unique_ptr<compaction> make_compaction(compaction_type type, Params&&... params) {
+    switch (type) {
+    case compaction_type::Cleanup:
         return std::make_unique<cleanup_compaction>(std::forward<Params>(params)...);
-    } else {
+    case compaction_type::GarbageCollect:
+        return std::make_unique<garbage_collect_compaction>(std::forward<Params>(params)...);
+    default:
         return std::make_unique<regular_compaction>(std::forward<Params>(params)...);
     }
 }
 
 future<compaction_info>
-compact_sstables(sstables::compaction_descriptor descriptor, column_family& cf, std::function<shared_sstable()> creator, bool cleanup) {
+compact_sstables(sstables::compaction_descriptor descriptor, column_family& cf, std::function<shared_sstable()> creator, compaction_type type, replacer_fn replacer) {
     if (descriptor.sstables.empty()) {
         throw std::runtime_error(sprint("Called compaction with empty set on behalf of {}.{}", cf.schema()->ks_name(), cf.schema()->cf_name()));
     }
-    auto c = make_compaction(cleanup, cf, std::move(descriptor), std::move(creator));
+    auto c = make_compaction(type, cf, std::move(descriptor), std::move(creator), std::move(replacer));
     return compaction::run(std::move(c));
 }
 
@@ -63,6 +63,7 @@ namespace sstables {
         Scrub = 3,
         Index_build = 4,
         Reshard = 5,
+        GarbageCollect = 6,
     };
 
     static inline sstring compaction_name(compaction_type type) {
@@ -79,11 +80,18 @@ namespace sstables {
             return "INDEX_BUILD";
         case compaction_type::Reshard:
             return "RESHARD";
+        case compaction_type::GarbageCollect:
+            return "GARBAGE_COLLECT";
         default:
             throw std::runtime_error("Invalid Compaction Type");
         }
     }
 
+    // Called by compaction during its lifetime to incrementally replace the input
+    // sstables it has fully rewritten with the outputs that now cover their data.
+    // First argument holds the sstables to add, second the ones to remove.
+    using replacer_fn = std::function<void(std::vector<shared_sstable>, std::vector<shared_sstable>)>;
+
     struct compaction_info {
         compaction_type type = compaction_type::Compaction;
         sstring ks;
@@ -119,11 +127,19 @@ namespace sstables {
     // Example: It's okay for the size of a new sstable to go beyond max_sstable_size
     // when writing its last partition.
     // sstable_level will be level of the sstable(s) to be created by this function.
-    // If cleanup is true, mutation that doesn't belong to current node will be
+    // If type is Cleanup, mutation that doesn't belong to current node will be
     // cleaned up, log messages will inform the user that compact_sstables runs for
     // cleaning operation, and compaction history will not be updated.
+    // If type is GarbageCollect, a single sstable is rewritten just to purge its
+    // droppable tombstones; no merge work with other sstables is done.
+    // If replacer is provided, it's called every time an output sstable is sealed,
+    // with that sstable and the inputs it exhausted, so the caller can make the
+    // partial result visible to reads while the compaction is still running. The
+    // returned compaction_info then lists work already published through replacer.
     future<compaction_info> compact_sstables(sstables::compaction_descriptor descriptor,
-            column_family& cf, std::function<shared_sstable()> creator, bool cleanup = false);
+            column_family& cf, std::function<shared_sstable()> creator,
+            compaction_type type = compaction_type::Compaction,
+            replacer_fn replacer = {});
 
     // Compacts a set of N shared sstables into M sstables. For every shard involved,
     // i.e. which owns any of the sstables, a new unshared sstable is created.
@@ -23,6 +23,8 @@
 #include "compaction_backlog_manager.hh"
 #include "sstables/sstables.hh"
 #include "database.hh"
+#include "service/priority_manager.hh"
+#include "core/thread.hh"
 #include <seastar/core/metrics.hh>
 #include "exceptions.hh"
 #include <cmath>
@@ -202,6 +204,49 @@ std::vector<sstables::shared_sstable> compaction_manager::get_candidates(const c
     return candidates;
 }
 
+std::vector<sstables::shared_sstable> compaction_manager::prepare_flush_merge(column_family& cf, uint64_t memtable_size) {
+    if (_stopped) {
+        return {};
+    }
+    auto schema = cf.schema();
+    std::vector<sstables::shared_sstable> candidates;
+    for (auto& sst : cf.candidates_for_compaction()) {
+        if (_compacting_sstables.count(sst)) {
+            continue;
+        }
+        // Only unshared level 0 sstables owned by this shard qualify: they
+        // are what the flush output would land next to and be re-merged
+        // with, and removing sstables owned by other shards is the job of
+        // the resharding machinery.
+        auto shards = sst->get_shards_for_this_sstable();
+        if (sst->get_sstable_level() != 0 || shards.size() != 1 || shards[0] != engine().cpu_id()) {
+            continue;
+        }
+        // Absorbing a large sstable would slow the flush down for little
+        // write amplification gain; only take sstables comparable in size
+        // to the memtable being flushed.
+        if (sst->ondisk_data_size() > memtable_size * 4) {
+            continue;
+        }
+        candidates.push_back(sst);
+    }
+    // Only bother when a size-tiered style compaction would be pending for
+    // these sstables anyway; the flush output itself counts as one input.
+    if (int(candidates.size()) + 1 < schema->min_compaction_threshold()) {
+        return {};
+    }
+    std::sort(candidates.begin(), candidates.end(), [] (const sstables::shared_sstable& a, const sstables::shared_sstable& b) {
+        return a->ondisk_data_size() < b->ondisk_data_size();
+    });
+    auto max_inputs = size_t(schema->max_compaction_threshold()) - 1;
+    if (candidates.size() > max_inputs) {
+        candidates.resize(max_inputs);
+    }
+    cmlog.debug("Flush of {}.{} will absorb {} sstables", schema->ks_name(), schema->cf_name(), candidates.size());
+    register_compacting_sstables(candidates);
+    return candidates;
+}
+
 void compaction_manager::register_compacting_sstables(const std::vector<sstables::shared_sstable>& sstables) {
     for (auto& sst : sstables) {
         _compacting_sstables.insert(sst);
@@ -215,6 +260,50 @@ void compaction_manager::deregister_compacting_sstables(const std::vector<sstabl
     }
 }
 
+// Split the input set of a major compaction into fragments that are
+// compacted and released one at a time. Each call to compact_sstables()
+// seals its output and deletes its own inputs, so the temporary space
+// requirement is bounded by the largest fragment rather than by the whole
+// input set, and the I/O load is spread across several smaller jobs.
+// Fragments group sstables of similar size (size-tiered fashion), leaving
+// any merging across fragments to regular compaction afterwards.
+static std::vector<std::vector<sstables::shared_sstable>>
+split_major_compaction_fragments(std::vector<sstables::shared_sstable> candidates) {
+    // With 8 fragments, a major compaction needs roughly 1/8 of the input
+    // set as headroom instead of all of it.
+    static constexpr unsigned major_compaction_fragments = 8;
+
+    std::vector<std::vector<sstables::shared_sstable>> fragments;
+    // Splitting pays off only if every fragment still merges a few sstables.
+    if (candidates.size() < 2 * major_compaction_fragments) {
+        fragments.push_back(std::move(candidates));
+        return fragments;
+    }
+    std::sort(candidates.begin(), candidates.end(), [] (const sstables::shared_sstable& a, const sstables::shared_sstable& b) {
+        return a->data_size() < b->data_size();
+    });
+    uint64_t budget = (get_total_size(candidates) + major_compaction_fragments - 1) / major_compaction_fragments;
+    std::vector<sstables::shared_sstable> current;
+    uint64_t current_size = 0;
+    for (auto& sst : candidates) {
+        current_size += sst->data_size();
+        current.push_back(std::move(sst));
+        if (current_size >= budget && current.size() >= 2) {
+            fragments.push_back(std::move(current));
+            current = {};
+            current_size = 0;
+        }
+    }
+    if (current.size() == 1) {
+        // Don't waste a rewrite of a single sstable; merge it into the
+        // last fragment instead.
+        fragments.back().push_back(std::move(current.back()));
+    } else if (!current.empty()) {
+        fragments.push_back(std::move(current));
+    }
+    return fragments;
+}
+
 future<> compaction_manager::submit_major_compaction(column_family* cf) {
     if (_stopped) {
         return make_ready_future<>();
@@ -239,10 +328,20 @@ future<> compaction_manager::submit_major_compaction(column_family* cf) {
             // leveled strategy may want to promote the merged sstables of a level N.
             auto sstables = get_candidates(*cf);
             auto compacting = compacting_sstable_registration(this, sstables);
+            auto fragments = make_lw_shared<std::vector<std::vector<sstables::shared_sstable>>>(
+                    split_major_compaction_fragments(std::move(sstables)));
 
-            return with_scheduling_group(_scheduling_group, [this, cf, sstables = std::move(sstables)] () mutable {
-                return cf->compact_sstables(sstables::compaction_descriptor(std::move(sstables)));
-            }).then([compacting = std::move(compacting)] {});
+            auto fragment_nr = make_lw_shared<unsigned>(0);
+            return do_for_each(*fragments, [this, task, cf, fragments, fragment_nr] (std::vector<sstables::shared_sstable>& fragment) {
+                if (!can_proceed(task)) {
+                    return make_ready_future<>();
+                }
+                cmlog.info("Major compaction of {}.{}: compacting fragment {}/{} ({} sstables)",
+                        cf->schema()->ks_name(), cf->schema()->cf_name(), ++*fragment_nr, fragments->size(), fragment.size());
+                return with_scheduling_group(_scheduling_group, [cf, &fragment] () mutable {
+                    return cf->compact_sstables(sstables::compaction_descriptor(std::move(fragment)));
+                });
+            }).then([fragments, compacting = std::move(compacting)] {});
         });
     }).then_wrapped([this, task] (future<> f) {
         _stats.active_tasks--;
@@ -324,6 +423,10 @@ void compaction_manager::register_metrics() {
     _metrics.add_group("compaction_manager", {
         sm::make_gauge("compactions", [this] { return _stats.active_tasks; },
                        sm::description("Holds the number of currently active compactions.")),
+        sm::make_derive("validated_bytes", [this] { return _stats.validated_bytes; },
+                       sm::description("Counts the bytes of sstable data verified by background validation.")),
+        sm::make_derive("validation_errors", [this] { return _stats.validation_errors; },
+                       sm::description("Counts the checksum mismatches found by background validation.")),
     });
 }
 
@@ -332,6 +435,7 @@ void compaction_manager::start() {
     register_metrics();
     _compaction_submission_timer.arm(periodic_compaction_submission_interval());
     postponed_compactions_reevaluation();
+    background_validation();
 }
 
 std::function<void()> compaction_manager::compaction_submission_callback() {
@@ -362,6 +466,79 @@ void compaction_manager::postponed_compactions_reevaluation() {
     });
 }
 
+bool compaction_manager::validate_one_batch() {
+    // Pick the next unverified region. The snapshot is taken without yielding,
+    // so the chosen sstable is the only one kept alive across the read below.
+    sstables::shared_sstable target;
+    column_family* target_cf = nullptr;
+    uint64_t watermark = 0;
+    for (auto& e : _compaction_locks) {
+        auto cf = e.first;
+        auto sstables = cf->get_sstables();
+        auto& marks = _validation_watermarks[cf];
+        // Drop bookkeeping for generations compacted away, or the map would
+        // grow with every rewrite of the column family.
+        std::unordered_map<int64_t, uint64_t> live;
+        live.reserve(sstables->size());
+        for (auto& sst : *sstables) {
+            auto it = marks.find(sst->generation());
+            auto verified = it != marks.end() ? it->second : 0;
+            live.emplace(sst->generation(), verified);
+            if (!target && verified < sst->data_size()) {
+                target = sst;
+                target_cf = cf;
+                watermark = verified;
+            }
+        }
+        marks = std::move(live);
+        if (target) {
+            break;
+        }
+    }
+    if (!target) {
+        return false;
+    }
+    try {
+        auto verified_up_to = target->validate_data_checksums(watermark, validation_batch_size,
+                service::get_local_scrub_priority()).get0();
+        _stats.validated_bytes += verified_up_to - watermark;
+        watermark = verified_up_to;
+    } catch (sstables::malformed_sstable_exception& e) {
+        _stats.validation_errors++;
+        cmlog.error("Background validation found corruption: {}", e.what());
+        // Mark the sstable done so the corruption is reported once instead of
+        // being re-read every interval; the operator has to rebuild it anyway.
+        watermark = target->data_size();
+    }
+    // The column family may have been removed while we waited for the read.
+    auto it = _validation_watermarks.find(target_cf);
+    if (it != _validation_watermarks.end()) {
+        it->second[target->generation()] = watermark;
+    }
+    return true;
+}
+
+void compaction_manager::background_validation() {
+    _validation_fiber = seastar::async([this] {
+        while (!_stopped) {
+            bool did_work = false;
+            try {
+                did_work = validate_one_batch();
+            } catch (...) {
+                // Not corruption (that is handled per sstable above), but e.g.
+                // an sstable unlinked under us. Retry on the next interval.
+                cmlog.debug("background validation batch failed: {}", std::current_exception());
+            }
+            auto interval = did_work ? validation_batch_interval() : validation_idle_interval();
+            try {
+                _validation_wakeup.wait(interval).get();
+            } catch (condition_variable_timed_out&) {
+                // Expected: time for the next batch.
+            }
+        }
+    });
+}
+
 void compaction_manager::reevalute_postponed_compactions() {
     _postponed_reevaluation.signal();
 }
@@ -392,6 +569,9 @@ future<> compaction_manager::stop() {
     }).then([this] () mutable {
         reevalute_postponed_compactions();
         return std::move(_waiting_reevalution);
+    }).then([this] {
+        _validation_wakeup.signal();
+        return std::move(_validation_fiber);
     }).then([this] {
         _weight_tracker.clear();
         _compaction_submission_timer.cancel();
@@ -447,6 +627,14 @@ void compaction_manager::submit(column_family* cf) {
             column_family& cf = *task->compacting_cf;
             sstables::compaction_strategy cs = cf.get_compaction_strategy();
             sstables::compaction_descriptor descriptor = cs.get_sstables_for_compaction(cf, get_candidates(cf));
+            auto type = sstables::compaction_type::Compaction;
+            if (descriptor.sstables.empty()) {
+                // No merge work to do. Check if some sstable accumulated enough
+                // droppable tombstones to be worth rewriting on its own, which
+                // reclaims space at a fraction of a full compaction's I/O.
+                descriptor = cs.get_garbage_collect_job(cf, get_candidates(cf));
+                type = sstables::compaction_type::GarbageCollect;
+            }
             int weight = trim_to_compact(&cf, descriptor);
 
             if (descriptor.sstables.empty() || !can_proceed(task)) {
@@ -467,7 +655,15 @@ void compaction_manager::submit(column_family* cf) {
 
             _stats.pending_tasks--;
             _stats.active_tasks++;
-            return cf.run_compaction(std::move(descriptor)).then_wrapped([this, task, compacting = std::move(compacting)] (future<> f) mutable {
+            if (cs.parallel_compaction()) {
+                // This job now owns its input sstables, so a non-overlapping
+                // job of a different weight (e.g. another TWCS time window)
+                // may be startable right away. Evaluate one in a sibling
+                // task instead of waiting for this job to finish; the chain
+                // stops as soon as the strategy has nothing more to offer.
+                submit(&cf);
+            }
+            return cf.run_compaction(std::move(descriptor), type).then_wrapped([this, task, compacting = std::move(compacting)] (future<> f) mutable {
                 _stats.active_tasks--;
 
                 if (!can_proceed(task)) {
@@ -575,6 +771,7 @@ future<> compaction_manager::remove(column_family* cf) {
         return this->task_stop(task);
     }).then([this, cf, tasks_to_stop] {
         _compaction_locks.erase(cf);
+        _validation_watermarks.erase(cf);
     });
 }
 
@@ -50,6 +50,9 @@ public:
         int64_t completed_tasks = 0;
         uint64_t active_tasks = 0; // Number of compaction going on.
         int64_t errors = 0;
+        // Background validation scrub progress and findings.
+        uint64_t validated_bytes = 0;
+        int64_t validation_errors = 0;
     };
 private:
     struct task {
@@ -96,6 +99,20 @@ private:
     // Submission is a NO-OP when there's nothing to do, so it's fine to call it regularly.
     timer<lowres_clock> _compaction_submission_timer = timer<lowres_clock>(compaction_submission_callback());
     static constexpr std::chrono::seconds periodic_compaction_submission_interval() { return std::chrono::seconds(3600); }
+
+    // Background validation scrub: a single fiber walks the sstables of
+    // every registered column family verifying data file checksums, so bit
+    // rot is found before compaction or a read trips on it. It reads at
+    // scrub I/O priority in small batches with a sleep in between, keeping
+    // it invisible to foreground work, and remembers the verified watermark
+    // of each sstable (by generation, so no sstable is kept alive by the
+    // bookkeeping) to avoid re-reading what was already checked.
+    future<> _validation_fiber = make_ready_future<>();
+    condition_variable _validation_wakeup;
+    std::unordered_map<column_family*, std::unordered_map<int64_t, uint64_t>> _validation_watermarks;
+    static constexpr uint64_t validation_batch_size = 1 << 20;
+    static constexpr std::chrono::seconds validation_batch_interval() { return std::chrono::seconds(1); }
+    static constexpr std::chrono::seconds validation_idle_interval() { return std::chrono::seconds(60); }
 private:
     future<> task_stop(lw_shared_ptr<task> task);
 
@@ -118,6 +135,14 @@ private:
     void register_compacting_sstables(const std::vector<sstables::shared_sstable>& sstables);
     void deregister_compacting_sstables(const std::vector<sstables::shared_sstable>& sstables);
 
+    // Flush-merge mode: pick small level 0 sstables that regular compaction
+    // would immediately re-merge with the output of an ongoing memtable
+    // flush, so the flush can absorb them through its single write pass
+    // instead. The returned sstables are registered as compacting; the
+    // caller must hand them back through deregister_compacting_sstables()
+    // whether or not the flush succeeded.
+    std::vector<sstables::shared_sstable> prepare_flush_merge(column_family& cf, uint64_t memtable_size);
+
     // Return true if compaction manager and task weren't asked to stop.
     inline bool can_proceed(const lw_shared_ptr<task>& task);
 
@@ -132,6 +157,9 @@ private:
     inline bool maybe_stop_on_error(future<> f);
 
     void postponed_compactions_reevaluation();
+    // Runs one bounded validation batch; returns true if there was work.
+    bool validate_one_batch();
+    void background_validation();
     void reevalute_postponed_compactions();
     // Postpone compaction for a column family that couldn't be executed due to ongoing
     // similar-sized compaction.
@@ -52,6 +52,7 @@
 #include "sstable_set.hh"
 #include "compatible_ring_position.hh"
 #include <boost/range/algorithm/find.hpp>
+#include <boost/range/algorithm/sort.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/icl/interval_map.hpp>
 #include <boost/algorithm/cxx11/any_of.hpp>
@@ -347,6 +348,32 @@ std::unique_ptr<sstable_set_impl> leveled_compaction_strategy::make_sstable_set(
     return std::make_unique<partitioned_sstable_set>(std::move(schema));
 }
 
+compaction_descriptor
+compaction_strategy_impl::get_garbage_collect_job(column_family& cf, std::vector<sstables::shared_sstable> candidates) {
+    auto gc_before = gc_clock::now() - cf.schema()->gc_grace_seconds();
+
+    // Rewrite the sstable which stands to lose the biggest fraction of its
+    // data, as that's where a single-sstable rewrite reclaims the most space
+    // per byte of compaction I/O.
+    sstables::shared_sstable worst;
+    double worst_ratio = 0;
+    for (auto& sst : candidates) {
+        if (!worth_dropping_tombstones(sst, gc_before)) {
+            continue;
+        }
+        auto ratio = sst->estimate_droppable_tombstone_ratio(gc_before);
+        if (ratio > worst_ratio) {
+            worst_ratio = ratio;
+            worst = sst;
+        }
+    }
+    if (!worst) {
+        return compaction_descriptor();
+    }
+    auto level = worst->get_sstable_level();
+    return compaction_descriptor({ std::move(worst) }, level);
+}
+
 std::vector<resharding_descriptor>
 compaction_strategy_impl::get_resharding_jobs(column_family& cf, std::vector<sstables::shared_sstable> candidates) {
     std::vector<resharding_descriptor> jobs;
@@ -511,6 +538,11 @@ public:
         return sstables::compaction_descriptor();
     }
 
+    // Nothing is compacted with this strategy, not even droppable tombstones.
+    virtual compaction_descriptor get_garbage_collect_job(column_family& cf, std::vector<sstables::shared_sstable> candidates) override {
+        return sstables::compaction_descriptor();
+    }
+
     virtual int64_t estimated_pending_compactions(column_family& cf) const override {
         return 0;
     }
@@ -551,6 +583,138 @@ public:
     }
 };
 
+//
+// A cost-based strategy: instead of reasoning about sstable shapes it watches
+// what reads actually experience. While the table meets its read
+// amplification goal (and, when configured, its read latency goal) no
+// compaction is issued at all; once a goal is missed, the candidates are
+// grouped into clusters of partition-range-overlapping sstables and the
+// cluster with the highest predicted read amplification reduction per byte
+// of compaction I/O - (sstables merged - 1) / cluster size - is compacted
+// first.
+//
+class latency_aware_compaction_strategy : public compaction_strategy_impl {
+    const sstring READ_AMPLIFICATION_GOAL_OPTION = "read_amplification_goal";
+    const sstring READ_LATENCY_GOAL_MS_OPTION = "read_latency_goal_ms";
+    static constexpr double DEFAULT_READ_AMPLIFICATION_GOAL = 2.0;
+
+    double _read_amplification_goal;
+    double _read_latency_goal_ms;
+    compaction_backlog_tracker _backlog_tracker;
+private:
+    struct overlap_cluster {
+        std::vector<shared_sstable> sstables;
+        uint64_t bytes = 0;
+    };
+
+    // Groups sstables into maximal clusters whose partition ranges overlap
+    // transitively. Reads of a key covered by a cluster may have to touch
+    // every sstable in it, so merging a cluster of n sstables saves up to
+    // n - 1 sstable reads per affected read.
+    static std::vector<overlap_cluster> overlap_clusters(const schema& s, std::vector<shared_sstable> candidates) {
+        boost::sort(candidates, [&] (const shared_sstable& a, const shared_sstable& b) {
+            return a->get_first_decorated_key().tri_compare(s, b->get_first_decorated_key()) < 0;
+        });
+        std::vector<overlap_cluster> clusters;
+        const dht::decorated_key* last = nullptr;
+        for (auto& sst : candidates) {
+            if (!last || sst->get_first_decorated_key().tri_compare(s, *last) > 0) {
+                clusters.emplace_back();
+                last = nullptr;
+            }
+            auto& c = clusters.back();
+            c.sstables.push_back(sst);
+            c.bytes += sst->ondisk_data_size();
+            if (!last || sst->get_last_decorated_key().tri_compare(s, *last) > 0) {
+                last = &sst->get_last_decorated_key();
+            }
+        }
+        return clusters;
+    }
+
+    bool goals_met(column_family& cfs) const {
+        auto& stats = cfs.get_stats();
+        if (stats.estimated_sstable_per_read.mean() > _read_amplification_goal) {
+            return false;
+        }
+        // The read latency histogram is collected in nanoseconds.
+        if (_read_latency_goal_ms > 0 && stats.reads.hist.mean / 1e6 > _read_latency_goal_ms) {
+            return false;
+        }
+        return true;
+    }
+public:
+    explicit latency_aware_compaction_strategy(const std::map<sstring, sstring>& options)
+        : compaction_strategy_impl(options)
+        , _backlog_tracker(std::make_unique<unimplemented_backlog_tracker>())
+    {
+        using namespace cql3::statements;
+
+        auto tmp_value = get_value(options, READ_AMPLIFICATION_GOAL_OPTION);
+        _read_amplification_goal = property_definitions::to_double(READ_AMPLIFICATION_GOAL_OPTION, tmp_value, DEFAULT_READ_AMPLIFICATION_GOAL);
+        tmp_value = get_value(options, READ_LATENCY_GOAL_MS_OPTION);
+        _read_latency_goal_ms = property_definitions::to_double(READ_LATENCY_GOAL_MS_OPTION, tmp_value, 0);
+    }
+
+    virtual compaction_descriptor get_sstables_for_compaction(column_family& cfs, std::vector<sstables::shared_sstable> candidates) override {
+        if (candidates.size() < 2 || goals_met(cfs)) {
+            return sstables::compaction_descriptor();
+        }
+        auto clusters = overlap_clusters(*cfs.schema(), std::move(candidates));
+        const overlap_cluster* best = nullptr;
+        double best_score = 0;
+        for (auto& c : clusters) {
+            if (c.sstables.size() < 2) {
+                continue;
+            }
+            auto score = double(c.sstables.size() - 1) / std::max<uint64_t>(c.bytes, 1);
+            if (score > best_score) {
+                best = &c;
+                best_score = score;
+            }
+        }
+        if (!best) {
+            return sstables::compaction_descriptor();
+        }
+        auto sstables = best->sstables;
+        auto max_threshold = unsigned(cfs.schema()->max_compaction_threshold());
+        if (sstables.size() > max_threshold) {
+            // Merging the smaller members buys the most reduction per byte.
+            boost::sort(sstables, [] (const shared_sstable& a, const shared_sstable& b) {
+                return a->ondisk_data_size() < b->ondisk_data_size();
+            });
+            sstables.resize(max_threshold);
+        }
+        clogger.debug("Latency-aware compaction of {} sstables ({} bytes) for {}.{}, estimated read amplification {}",
+                sstables.size(), best->bytes, cfs.schema()->ks_name(), cfs.schema()->cf_name(),
+                cfs.get_stats().estimated_sstable_per_read.mean());
+        return sstables::compaction_descriptor(std::move(sstables));
+    }
+
+    virtual int64_t estimated_pending_compactions(column_family& cf) const override {
+        if (goals_met(cf)) {
+            return 0;
+        }
+        std::vector<sstables::shared_sstable> sstables;
+        sstables.reserve(cf.sstables_count());
+        for (auto& entry : *cf.get_sstables()) {
+            sstables.push_back(entry);
+        }
+        auto clusters = overlap_clusters(*cf.schema(), std::move(sstables));
+        return std::count_if(clusters.begin(), clusters.end(), [] (const overlap_cluster& c) {
+            return c.sstables.size() >= 2;
+        });
+    }
+
+    virtual compaction_strategy_type type() const override {
+        return compaction_strategy_type::latency_aware;
+    }
+
+    virtual compaction_backlog_tracker& get_backlog_tracker() override {
+        return _backlog_tracker;
+    }
+};
+
 leveled_compaction_strategy::leveled_compaction_strategy(const std::map<sstring, sstring>& options)
         : compaction_strategy_impl(options)
         , _stcs_options(options)
@@ -582,7 +746,6 @@ time_window_compaction_strategy::time_window_compaction_strategy(const std::map<
     } else {
         clogger.debug("Enabling tombstone compactions for TWCS");
     }
-    _use_clustering_key_filter = true;
 }
 
 date_tiered_compaction_strategy::date_tiered_compaction_strategy(const std::map<sstring, sstring>& options)
@@ -601,8 +764,6 @@ date_tiered_compaction_strategy::date_tiered_compaction_strategy(const std::map<
     } else {
         date_tiered_manifest::logger.debug("Enabling tombstone compactions for DTCS");
     }
-
-    _use_clustering_key_filter = true;
 }
 
 size_tiered_compaction_strategy::size_tiered_compaction_strategy(const std::map<sstring, sstring>& options)
@@ -632,6 +793,10 @@ compaction_descriptor compaction_strategy::get_sstables_for_compaction(column_fa
     return _compaction_strategy_impl->get_sstables_for_compaction(cfs, std::move(candidates));
 }
 
+compaction_descriptor compaction_strategy::get_garbage_collect_job(column_family& cf, std::vector<sstables::shared_sstable> candidates) {
+    return _compaction_strategy_impl->get_garbage_collect_job(cf, std::move(candidates));
+}
+
 std::vector<resharding_descriptor> compaction_strategy::get_resharding_jobs(column_family& cf, std::vector<sstables::shared_sstable> candidates) {
     return _compaction_strategy_impl->get_resharding_jobs(cf, std::move(candidates));
 }
@@ -685,6 +850,9 @@ compaction_strategy make_compaction_strategy(compaction_strategy_type strategy,
     case compaction_strategy_type::time_window:
         impl = make_shared<time_window_compaction_strategy>(time_window_compaction_strategy(options));
         break;
+    case compaction_strategy_type::latency_aware:
+        impl = make_shared<latency_aware_compaction_strategy>(latency_aware_compaction_strategy(options));
+        break;
     default:
         throw std::runtime_error("strategy not supported");
     }
@@ -38,7 +38,11 @@ protected:
     const sstring TOMBSTONE_THRESHOLD_OPTION = "tombstone_threshold";
     const sstring TOMBSTONE_COMPACTION_INTERVAL_OPTION = "tombstone_compaction_interval";
 
-    bool _use_clustering_key_filter = false;
+    // Whether single-key reads may use the per-sstable min/max clustering
+    // bounds to skip sstables whose rows all lie outside the queried slice.
+    // Enabled for all strategies now that range tombstone bounds widen that
+    // metadata at write time as well.
+    bool _use_clustering_key_filter = true;
     bool _disable_tombstone_compaction = false;
     float _tombstone_threshold = DEFAULT_TOMBSTONE_THRESHOLD;
     db_clock::duration _tombstone_compaction_interval = DEFAULT_TOMBSTONE_COMPACTION_INTERVAL();
@@ -67,6 +71,10 @@ protected:
 public:
     virtual ~compaction_strategy_impl() {}
     virtual compaction_descriptor get_sstables_for_compaction(column_family& cfs, std::vector<sstables::shared_sstable> candidates) = 0;
+    // Select a single sstable which is worth rewriting alone just to purge its
+    // droppable tombstones. Returns an empty descriptor if no candidate has a
+    // droppable tombstone ratio above the strategy's threshold.
+    virtual compaction_descriptor get_garbage_collect_job(column_family& cf, std::vector<sstables::shared_sstable> candidates);
     virtual std::vector<resharding_descriptor> get_resharding_jobs(column_family& cf, std::vector<sstables::shared_sstable> candidates);
     virtual void notify_completion(const std::vector<shared_sstable>& removed, const std::vector<shared_sstable>& added) { }
     virtual compaction_strategy_type type() const = 0;
@@ -21,18 +21,25 @@
 
 #include <stdexcept>
 #include <cstdlib>
+#include <array>
+#include <list>
+#include <memory>
+#include <vector>
+#include <unordered_map>
 
 #include <boost/range/algorithm/find_if.hpp>
 #include <seastar/core/align.hh>
 #include <seastar/core/bitops.hh>
 #include <seastar/core/byteorder.hh>
 #include <seastar/core/fstream.hh>
+#include <seastar/core/metrics.hh>
 
 #include "../compress.hh"
 #include "compress.hh"
 #include "unimplemented.hh"
 #include "stdx.hh"
 #include "segmented_compress_params.hh"
+#include "utils/hash.hh"
 
 namespace sstables {
 
@@ -315,6 +322,11 @@ void compression::update(uint64_t compressed_file_length) {
     _compressed_file_length = compressed_file_length;
 }
 
+uint64_t compression::next_cache_id() {
+    static thread_local uint64_t id = 0;
+    return ++id;
+}
+
 
 // locate() takes a byte position in the uncompressed stream, and finds the
 // the location of the compressed chunk on disk which contains it, and the
@@ -336,6 +348,126 @@ compression::locate(uint64_t position, const compression::segmented_offsets::acc
 
 }
 
+// A small per-shard LRU cache of decompressed chunks, keyed by the owning
+// compression metadata and the chunk's position in the compressed file.
+// Clustered point reads landing in the same chunk (adjacent partitions, or
+// an index lookup followed by the data read) pay for the checksum and the
+// decompression only once; subsequent readers share the cached buffer.
+class chunk_cache {
+public:
+    using key_type = std::pair<uint64_t, uint64_t>; // (metadata cache id, chunk start)
+private:
+    struct entry {
+        key_type key;
+        temporary_buffer<char> data;
+    };
+    std::list<entry> _lru; // front is the most recently used
+    std::unordered_map<key_type, std::list<entry>::iterator, utils::tuple_hash> _index;
+    size_t _size = 0;
+    size_t _capacity;
+public:
+    explicit chunk_cache(size_t capacity) : _capacity(capacity) { }
+    stdx::optional<temporary_buffer<char>> get(key_type key) {
+        auto i = _index.find(key);
+        if (i == _index.end()) {
+            return stdx::nullopt;
+        }
+        _lru.splice(_lru.begin(), _lru, i->second);
+        return i->second->data.share();
+    }
+    void put(key_type key, temporary_buffer<char> data) {
+        if (data.size() > _capacity || _index.count(key)) {
+            return;
+        }
+        _size += data.size();
+        _lru.push_front(entry{key, std::move(data)});
+        _index.emplace(key, _lru.begin());
+        while (_size > _capacity) {
+            auto& victim = _lru.back();
+            _size -= victim.data.size();
+            _index.erase(victim.key);
+            _lru.pop_back();
+        }
+    }
+};
+
+// Sized to hold a handful of chunks; sequential scans evict their own
+// entries quickly and never grow the cache beyond this.
+static thread_local chunk_cache the_chunk_cache(1 << 20);
+
+// A per-shard pool of decompression output buffers. Every compressed read
+// decompresses into a chunk-sized buffer (4k to 64k with the usual chunk
+// length settings), and allocating those from the general allocator on each
+// chunk is measurable churn on read-heavy workloads. The pool keeps a few
+// free buffers per size tier; the buffers are handed out as temporary_buffers
+// whose deleter returns the storage, so sharing them with the chunk cache
+// works, and the deleter holds the pool alive so buffers may safely outlive
+// the shard's last reader during shutdown.
+class decompression_buffer_pool {
+    struct tier {
+        size_t buffer_size;
+        std::vector<std::unique_ptr<char[]>> free;
+    };
+    static constexpr unsigned max_buffers_per_tier = 16;
+    std::array<tier, 3> _tiers;
+    uint64_t _hits = 0;     // served from a free list
+    uint64_t _misses = 0;   // tier was empty, had to allocate
+    uint64_t _unpooled = 0; // larger than the largest tier
+    seastar::metrics::metric_groups _metrics;
+
+    tier* tier_for(size_t size) {
+        for (auto& t : _tiers) {
+            if (size <= t.buffer_size) {
+                return &t;
+            }
+        }
+        return nullptr;
+    }
+    void put(tier& t, std::unique_ptr<char[]> data) {
+        if (t.free.size() < max_buffers_per_tier) {
+            t.free.emplace_back(std::move(data));
+        }
+    }
+public:
+    decompression_buffer_pool() : _tiers{{{4096, {}}, {16384, {}}, {65536, {}}}} {
+        namespace sm = seastar::metrics;
+        _metrics.add_group("sstables", {
+            sm::make_derive("decompression_buffer_hits", _hits,
+                sm::description("Decompression output buffers served from the per-shard buffer pool.")),
+            sm::make_derive("decompression_buffer_misses", _misses,
+                sm::description("Decompression output buffers allocated because the pool tier was empty.")),
+            sm::make_derive("decompression_buffer_unpooled", _unpooled,
+                sm::description("Decompression output buffers larger than the largest pool tier, allocated directly.")),
+        });
+    }
+    // Returns a buffer of `size` usable bytes which gives its storage back
+    // to the pool on destruction.
+    static temporary_buffer<char> get(lw_shared_ptr<decompression_buffer_pool> pool, size_t size) {
+        auto& p = *pool;
+        auto* t = p.tier_for(size);
+        if (!t) {
+            ++p._unpooled;
+            return temporary_buffer<char>(size);
+        }
+        std::unique_ptr<char[]> data;
+        if (t->free.empty()) {
+            ++p._misses;
+            data = std::unique_ptr<char[]>(new char[t->buffer_size]);
+        } else {
+            ++p._hits;
+            data = std::move(t->free.back());
+            t->free.pop_back();
+        }
+        auto ptr = data.get();
+        return temporary_buffer<char>(ptr, size, make_deleter([pool = std::move(pool), t, data = std::move(data)] () mutable {
+            pool->put(*t, std::move(data));
+        }));
+    }
+};
+
+static thread_local lw_shared_ptr<decompression_buffer_pool> the_decompression_buffer_pool =
+        make_lw_shared<decompression_buffer_pool>();
+
 class compressed_file_data_source_impl : public data_source_impl {
     stdx::optional<input_stream<char>> _input_stream;
     sstables::compression* _compression_metadata;
@@ -388,8 +520,19 @@ public:
         if (_pos != _beg_pos && addr.offset != 0) {
             throw std::runtime_error("compressed reader out of sync");
         }
+        auto key = chunk_cache::key_type(_compression_metadata->cache_id(), addr.chunk_start);
+        if (auto cached = the_chunk_cache.get(key)) {
+            // The chunk was decompressed (and its checksum verified) by an
+            // earlier read; skip over its compressed bytes.
+            return _input_stream->skip(addr.chunk_len).then([this, addr, out = std::move(*cached)] () mutable {
+                out.trim_front(addr.offset);
+                _pos += out.size();
+                _underlying_pos += addr.chunk_len;
+                return std::move(out);
+            });
+        }
         return _input_stream->read_exactly(addr.chunk_len).
-            then([this, addr](temporary_buffer<char> buf) {
+            then([this, addr, key](temporary_buffer<char> buf) {
                 // The last 4 bytes of the chunk are the adler32 checksum
                 // of the rest of the (compressed) chunk.
                 auto compressed_len = addr.chunk_len - 4;
@@ -402,7 +545,7 @@ public:
 
                 // We know that the uncompressed data will take exactly
                 // chunk_length bytes (or less, if reading the last chunk).
-                temporary_buffer<char> out(
+                auto out = decompression_buffer_pool::get(the_decompression_buffer_pool,
                         _compression_metadata->uncompressed_chunk_length());
                 // The compressed data is the whole chunk, minus the last 4
                 // bytes (which contain the checksum verified above).
@@ -410,6 +553,7 @@ public:
                 auto len = _compression.uncompress(buf.get(), compressed_len, out.get_write(), out.size());
 
                 out.trim(len);
+                the_chunk_cache.put(key, out.share());
                 out.trim_front(addr.offset);
                 _pos += out.size();
                 _underlying_pos += addr.chunk_len;
@@ -468,6 +612,15 @@ class compressed_file_data_sink_impl : public data_sink_impl {
     sstables::compression::segmented_offsets::writer _offsets;
     sstables::local_compression _compression;
     size_t _pos = 0;
+    // Compressed chunks are handed over to a background write fiber, so
+    // compressing and checksumming the next chunk overlaps with writing
+    // the previous ones even when the file stream's write-behind slots are
+    // all in flight. The semaphore bounds how many compressed chunks may
+    // be queued, capping the memory held by the pipeline.
+    static constexpr size_t pipeline_depth = 4;
+    semaphore _queue_space{pipeline_depth};
+    future<> _queued_writes = make_ready_future<>();
+    std::exception_ptr _write_error;
 public:
     compressed_file_data_sink_impl(file f, sstables::compression* cm, sstables::local_compression lc, file_output_stream_options options)
             : _out(make_file_output_stream(std::move(f), options))
@@ -506,11 +659,29 @@ public:
 
         compressed.trim(len + 4);
 
-        auto f = _out.write(compressed.get(), compressed.size());
-        return f.then([compressed = std::move(compressed)] {});
+        return get_units(_queue_space, 1).then([this, compressed = std::move(compressed)] (auto units) mutable {
+            if (_write_error) {
+                return make_exception_future<>(_write_error);
+            }
+            _queued_writes = _queued_writes.then([this, compressed = std::move(compressed), units = std::move(units)] () mutable {
+                return _out.write(compressed.get(), compressed.size()).then([compressed = std::move(compressed)] {
+                }).handle_exception([this] (std::exception_ptr ep) {
+                    // Reported by the next put() or by close().
+                    _write_error = std::move(ep);
+                });
+            });
+            return make_ready_future<>();
+        });
     }
     virtual future<> close() override {
-        return _out.close();
+        return _queued_writes.then([this] {
+            if (_write_error) {
+                return make_exception_future<>(_write_error);
+            }
+            return make_ready_future<>();
+        }).finally([this] {
+            return _out.close();
+        });
     }
 };
 
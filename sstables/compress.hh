@@ -326,6 +326,8 @@ private:
     // Variables *not* found in the "Compression Info" file (added by update()):
     uint64_t _compressed_file_length = 0;
     uint32_t _full_checksum;
+    static uint64_t next_cache_id();
+    uint64_t _cache_id = next_cache_id();
 public:
     // Set the compressor algorithm, please check the definition of enum compressor.
     void set_compressor(compressor_ptr c);
@@ -375,6 +377,13 @@ public:
         _compressed_file_length = compressed_file_length;
     }
 
+    // Identifies this metadata object in the per-shard cache of decompressed
+    // chunks. Ids are never reused, so entries of a closed sstable simply age
+    // out of the cache instead of requiring explicit invalidation.
+    uint64_t cache_id() const {
+        return _cache_id;
+    }
+
     uint32_t full_checksum() const {
         return _full_checksum;
     }
@@ -22,6 +22,10 @@
 #pragma once
 #include "consumer.hh"
 #include "types.hh"
+#include "utils/chunked_vector.hh"
+#include "core/future-util.hh"
+#include "core/file.hh"
+#include "core/fstream.hh"
 #include <boost/variant.hpp>
 #include <seastar/util/variant_utils.hh>
 
@@ -173,7 +177,152 @@ public:
     {}
 };
 
+// Result of an upper bound search through promoted_index_offsets_cursor.
+struct promoted_index_bound {
+    size_t idx; // index of the first block whose start is greater than the position
+    // Offsets within the partition (promoted_index_block::offset()) of
+    // blocks idx - 1 and idx; disengaged when the respective block does not
+    // exist.
+    stdx::optional<uint64_t> prev_offset;
+    stdx::optional<uint64_t> offset;
+};
+
+// Random-access view of an on-disk promoted index written with
+// sstable_feature::PromotedIndexBlockOffsets: the blocks are followed by a
+// fixed-stride table holding the offset of every block, so a clustering
+// position can be located with a binary search which reads the table and one
+// block per probe, instead of parsing the block stream from its beginning.
+class promoted_index_offsets_cursor {
+    file _index_file;
+    file_input_stream_options _options;
+    uint64_t _blocks_start; // position of the first block in the index file
+    uint32_t _blocks_size;  // total size of the blocks, excluding the offsets table
+    uint32_t _num_blocks;
+    utils::chunked_vector<uint32_t> _offsets; // loaded on first use
+private:
+    future<temporary_buffer<char>> read_exactly_at(uint64_t pos, size_t len) {
+        return do_with(make_file_input_stream(_index_file, pos, len, _options), [len] (input_stream<char>& in) {
+            return in.read_exactly(len).then([len] (temporary_buffer<char> buf) {
+                if (buf.size() != len) {
+                    throw malformed_sstable_exception("promoted index ends prematurely");
+                }
+                return buf;
+            }).finally([&in] {
+                return in.close();
+            });
+        });
+    }
+
+    future<> maybe_load_offsets() {
+        if (!_offsets.empty()) {
+            return make_ready_future<>();
+        }
+        return read_exactly_at(_blocks_start + _blocks_size, size_t(_num_blocks) * 4).then([this] (temporary_buffer<char> buf) {
+            _offsets.reserve(_num_blocks);
+            for (uint32_t i = 0; i != _num_blocks; ++i) {
+                auto off = consume_be<uint32_t>(buf);
+                if (off >= _blocks_size || (i && off <= _offsets.back())) {
+                    throw malformed_sstable_exception("promoted index block offsets are not monotonic");
+                }
+                _offsets.push_back(off);
+            }
+        });
+    }
+
+    uint32_t block_end(size_t idx) const {
+        return idx + 1 < _num_blocks ? _offsets[idx + 1] : _blocks_size;
+    }
+
+    future<promoted_index_block> read_block(size_t idx) {
+        auto off = _offsets[idx];
+        return read_exactly_at(_blocks_start + off, block_end(idx) - off).then([] (temporary_buffer<char> buf) {
+            auto read_name = [&buf] () -> temporary_buffer<char> {
+                if (buf.size() < 2) {
+                    throw malformed_sstable_exception("promoted index block ends prematurely");
+                }
+                auto len = consume_be<uint16_t>(buf);
+                if (buf.size() < len) {
+                    throw malformed_sstable_exception("promoted index block ends prematurely");
+                }
+                auto name = buf.share(0, len);
+                buf.trim_front(len);
+                return name;
+            };
+            auto start = read_name();
+            auto end = read_name();
+            if (buf.size() < 16) {
+                throw malformed_sstable_exception("promoted index block ends prematurely");
+            }
+            auto offset = consume_be<uint64_t>(buf);
+            auto width = consume_be<uint64_t>(buf);
+            return promoted_index_block(std::move(start), std::move(end), offset, width);
+        });
+    }
+
+public:
+    promoted_index_offsets_cursor(file index_file, file_input_stream_options options,
+            uint64_t blocks_start, uint32_t blocks_size, uint32_t num_blocks)
+        : _index_file(std::move(index_file))
+        , _options(std::move(options))
+        , _blocks_start(blocks_start)
+        , _blocks_size(blocks_size)
+        , _num_blocks(num_blocks)
+    {}
+
+    // Finds the first block whose start is greater than pos, along with the
+    // partition offsets of that block and of the one preceding it. Stateless
+    // with respect to the position, so calls need not be monotonic.
+    future<promoted_index_bound> upper_bound(position_in_partition_view pos, const schema& s) {
+        return maybe_load_offsets().then([this, pos, &s] {
+            struct search_state {
+                size_t lo;
+                size_t hi;
+            };
+            return do_with(search_state{0, _num_blocks}, [this, pos, &s] (search_state& st) {
+                return repeat([this, pos, &s, &st] {
+                    if (st.lo >= st.hi) {
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    }
+                    auto mid = st.lo + (st.hi - st.lo) / 2;
+                    return read_block(mid).then([&st, mid, pos, &s] (promoted_index_block block) {
+                        auto cmp = position_in_partition::composite_less_compare(s);
+                        if (cmp(pos, block.start(s))) {
+                            st.hi = mid;
+                        } else {
+                            st.lo = mid + 1;
+                        }
+                        return stop_iteration::no;
+                    });
+                }).then([this, &st] {
+                    return do_with(promoted_index_bound{st.lo, stdx::nullopt, stdx::nullopt}, [this] (promoted_index_bound& bound) {
+                        auto f = bound.idx > 0 ? read_block(bound.idx - 1).then([&bound] (promoted_index_block block) {
+                            bound.prev_offset = block.offset();
+                        }) : make_ready_future<>();
+                        return f.then([this, &bound] {
+                            if (bound.idx >= _num_blocks) {
+                                return make_ready_future<>();
+                            }
+                            return read_block(bound.idx).then([&bound] (promoted_index_block block) {
+                                bound.offset = block.offset();
+                            });
+                        }).then([&bound] {
+                            return bound;
+                        });
+                    });
+                });
+            });
+        });
+    }
+};
+
 class index_entry {
+public:
+    // Promoted indexes up to this size are read in full and retained (see
+    // read_all_pi_blocks()) instead of being streamed with discard. Since
+    // index entries are shared between readers through shared_index_lists,
+    // this effectively caches the parsed blocks of hot partitions, making
+    // the cost of a clustering slice independent of the partition size.
+    static constexpr uint32_t promoted_index_cache_threshold = 128 * 1024;
 private:
     temporary_buffer<char> _key;
     mutable stdx::optional<dht::token> _token;
@@ -182,6 +331,7 @@ private:
     bool _reader_closed = false;
     uint32_t _promoted_index_size;
     stdx::optional<deletion_time> _del_time;
+    stdx::optional<promoted_index_offsets_cursor> _offsets_cursor;
 
 public:
 
@@ -207,11 +357,13 @@ public:
 
     index_entry(temporary_buffer<char>&& key, uint64_t position,
              stdx::optional<input_stream<char>>&& promoted_index_stream, uint32_t promoted_index_size,
-             stdx::optional<deletion_time>&& del_time, uint32_t num_pi_blocks, const schema& s)
+             stdx::optional<deletion_time>&& del_time, uint32_t num_pi_blocks, const schema& s,
+             stdx::optional<promoted_index_offsets_cursor>&& offsets_cursor = stdx::nullopt)
         : _key(std::move(key))
         , _position(position)
         , _promoted_index_size(promoted_index_size)
         , _del_time(std::move(del_time))
+        , _offsets_cursor(std::move(offsets_cursor))
     {
         if (promoted_index_stream) {
             _reader.emplace(std::move(*promoted_index_stream), num_pi_blocks, s, 0, _promoted_index_size);
@@ -239,6 +391,23 @@ public:
         });
     }
 
+    // Reads and retains all remaining promoted index blocks. Unlike
+    // get_pi_blocks_until(), nothing is discarded along the way, so once
+    // this resolves the whole promoted index can be binary-searched,
+    // repeatedly and by every reader sharing this entry through the index
+    // page cache, without touching the index file again.
+    future<> read_all_pi_blocks() {
+        if (!_reader || _reader->get_read_num_blocks() == _reader->get_total_num_blocks()) {
+            return make_ready_future<>();
+        }
+        _reader->switch_to_consume_next_mode();
+        return repeat([this] {
+            return _reader->consume_input().then([this] {
+                return stop_iteration(_reader->get_read_num_blocks() == _reader->get_total_num_blocks());
+            });
+        });
+    }
+
     // Unconditionally reads the promoted index blocks from the next data buffer
     future<> get_next_pi_blocks() {
         if (!_reader) {
@@ -251,6 +420,15 @@ public:
         return _reader->consume_input();
     }
 
+    // Engaged when the sstable carries the trailing block offsets table
+    // (sstable_feature::PromotedIndexBlockOffsets), making the on-disk
+    // promoted index binary-searchable without parsing it from the start.
+    bool has_pi_block_offsets() const { return bool(_offsets_cursor); }
+
+    future<promoted_index_bound> pi_upper_bound(position_in_partition_view pos, const schema& s) {
+        return _offsets_cursor->upper_bound(pos, s);
+    }
+
     uint32_t get_total_pi_blocks_count() const { return _reader ? _reader->get_total_num_blocks() : 0; }
     uint32_t get_read_pi_blocks_count() const { return _reader ? _reader->get_read_num_blocks() : 0; }
     promoted_index_blocks* get_pi_blocks() { return _reader ? &_reader->get_pi_blocks() : nullptr; }
@@ -21,6 +21,7 @@
 
 #pragma once
 #include "sstables.hh"
+#include "binary_search.hh"
 #include "consumer.hh"
 #include "downsampling.hh"
 #include "sstables/shared_index_lists.hh"
@@ -51,6 +52,9 @@ public:
 class trust_promoted_index_tag;
 using trust_promoted_index = bool_class<trust_promoted_index_tag>;
 
+class use_pi_block_offsets_tag;
+using use_pi_block_offsets = bool_class<use_pi_block_offsets_tag>;
+
 // IndexConsumer is a concept that implements:
 //
 // bool should_continue();
@@ -85,6 +89,7 @@ private:
     uint32_t _num_pi_blocks = 0;
 
     trust_promoted_index _trust_pi;
+    use_pi_block_offsets _use_pi_offsets;
     const schema& _s;
 
 public:
@@ -171,8 +176,19 @@ public:
             } else {
                 _num_pi_blocks = 0;
             }
+            stdx::optional<promoted_index_offsets_cursor> offsets_cursor;
+            if (_use_pi_offsets == use_pi_block_offsets::yes && promoted_index_stream && _num_pi_blocks > 0) {
+                // The last 4 * num_blocks bytes of the promoted index are
+                // the table with the offset of every block.
+                auto table_size = uint64_t(_num_pi_blocks) * 4;
+                if (table_size >= _promoted_index_size) {
+                    throw malformed_sstable_exception("promoted index too small to hold its block offsets table");
+                }
+                offsets_cursor.emplace(_index_file, _options, _entry_offset + _key.size() + 30,
+                        _promoted_index_size - table_size, _num_pi_blocks);
+            }
             _consumer.consume_entry(index_entry{std::move(_key), _position, std::move(promoted_index_stream),
-                _promoted_index_size, std::move(_deletion_time), _num_pi_blocks, _s}, _entry_offset);
+                _promoted_index_size, std::move(_deletion_time), _num_pi_blocks, _s, std::move(offsets_cursor)}, _entry_offset);
             _entry_offset += len;
             _deletion_time = stdx::nullopt;
             _num_pi_blocks = 0;
@@ -191,11 +207,11 @@ public:
         return proceed::yes;
     }
 
-    index_consume_entry_context(IndexConsumer& consumer, trust_promoted_index trust_pi, const schema& s,
+    index_consume_entry_context(IndexConsumer& consumer, trust_promoted_index trust_pi, use_pi_block_offsets use_pi_offsets, const schema& s,
             file index_file, file_input_stream_options options, uint64_t start, uint64_t maxlen)
         : continuous_data_consumer(make_file_input_stream(index_file, start, maxlen, options), start, maxlen)
         , _consumer(consumer), _index_file(index_file), _options(options)
-        , _entry_offset(start), _trust_pi(trust_pi), _s(s)
+        , _entry_offset(start), _trust_pi(trust_pi), _use_pi_offsets(use_pi_offsets), _s(s)
     {}
 
     void reset(uint64_t offset) {
@@ -271,7 +287,8 @@ class index_reader {
         reader(shared_sstable sst, const io_priority_class& pc, uint64_t begin, uint64_t end, uint64_t quantity)
             : _consumer(quantity)
             , _context(_consumer,
-                       trust_promoted_index(sst->has_correct_promoted_index_entries()), *sst->_schema, sst->_index_file,
+                       trust_promoted_index(sst->has_correct_promoted_index_entries()),
+                       use_pi_block_offsets(sst->has_promoted_index_block_offsets()), *sst->_schema, sst->_index_file,
                        get_file_input_stream_options(sst, pc), begin, end - begin)
         { }
     };
@@ -379,9 +396,14 @@ public:
         , _pc(pc)
         , _index_lists(index_lists)
     {
+        _sstable->mark_index_reader();
         sstlog.trace("index {}: index_reader for {}", this, _sstable->get_filename());
     }
 
+    ~index_reader() {
+        _sstable->unmark_index_reader();
+    }
+
     index_reader(const index_reader& r)
         : _sstable(r._sstable)
         , _current_list(r._current_list)
@@ -395,6 +417,7 @@ public:
         , _data_file_position(r._data_file_position)
         , _element(r._element)
     {
+        _sstable->mark_index_reader();
         sstlog.trace("index {}: index_reader for {}", this, _sstable->get_filename());
     }
 
@@ -471,6 +494,35 @@ public:
         promoted_index_blocks* pi_blocks = e.get_pi_blocks();
         assert(pi_blocks);
 
+        // Wide partitions written with the trailing block offsets table are
+        // binary-searched directly on disk: only the table and O(log(blocks))
+        // blocks are read, instead of parsing the block stream from its
+        // beginning.
+        if (e.has_pi_block_offsets() && e.get_promoted_index_size() > index_entry::promoted_index_cache_threshold) {
+            return e.pi_upper_bound(pos, *_sstable->_schema).then([this, &e] (promoted_index_bound bound) {
+                _current_pi_idx = bound.idx;
+                // Continue from the block preceding the upper bound, or from
+                // the first block when the position precedes all of them.
+                auto offset = bound.prev_offset ? *bound.prev_offset : bound.offset.value_or(0);
+                _data_file_position = e.position() + offset;
+                _element = indexable_element::cell;
+                sstlog.trace("index {}: skipped to cell (binary search), _current_pi_idx={}, _data_file_position={}",
+                                    this, _current_pi_idx, _data_file_position);
+            });
+        }
+
+        // For partitions with a modest promoted index, read and retain all
+        // the blocks on first use: the binary search below then works on the
+        // complete index, and since the entry is shared through the index
+        // page cache, later slice reads of the same partition need no index
+        // file I/O at all.
+        if (e.get_read_pi_blocks_count() < e.get_total_pi_blocks_count()
+                && e.get_promoted_index_size() <= index_entry::promoted_index_cache_threshold) {
+            return e.read_all_pi_blocks().then([this, pos] {
+                return advance_to(pos);
+            });
+        }
+
         // Optimize short skips which typically land in the same block
         if ((e.get_total_pi_blocks_count() == e.get_read_pi_blocks_count()) && _current_pi_idx >= pi_blocks->size() -1) {
             sstlog.trace("index {}: position in current block (all blocks are read)", this);
@@ -542,6 +594,29 @@ public:
             return advance_to_next_partition();
         }
 
+        // Same binary search path as in advance_to(position_in_partition_view).
+        if (e.has_pi_block_offsets() && e.get_promoted_index_size() > index_entry::promoted_index_cache_threshold) {
+            return e.pi_upper_bound(pos, *_sstable->_schema).then([this, &e] (promoted_index_bound bound) {
+                _current_pi_idx = bound.idx;
+                if (!bound.offset) {
+                    return advance_to_next_partition();
+                }
+                _data_file_position = e.position() + *bound.offset;
+                _element = indexable_element::cell;
+                sstlog.trace("index {}: skipped to cell (binary search), _current_pi_idx={}, _data_file_position={}",
+                                    this, _current_pi_idx, _data_file_position);
+                return make_ready_future<>();
+            });
+        }
+
+        // Same retention policy as in advance_to(position_in_partition_view).
+        if (e.get_read_pi_blocks_count() < e.get_total_pi_blocks_count()
+                && e.get_promoted_index_size() <= index_entry::promoted_index_cache_threshold) {
+            return e.read_all_pi_blocks().then([this, pos] {
+                return advance_past(pos);
+            });
+        }
+
         if (e.get_read_pi_blocks_count() == 0) {
             return e.get_next_pi_blocks().then([this, pos] {
                 return advance_past(pos);
@@ -616,8 +691,13 @@ public:
         }
 
         auto& summary = _sstable->get_summary();
+        // Narrow the search to one sampling run via the first-level token
+        // array before probing the scattered entries. The run is clamped
+        // from below by _previous_summary_idx to preserve the monotonicity
+        // of the result, which the contract above guarantees is correct.
+        auto run = summary_token_run(summary, pos.token(), _previous_summary_idx, summary.entries.size());
         _previous_summary_idx = std::distance(std::begin(summary.entries),
-            std::lower_bound(summary.entries.begin() + _previous_summary_idx, summary.entries.end(), pos, index_comparator(*_sstable->_schema)));
+            std::lower_bound(summary.entries.begin() + run.first, summary.entries.begin() + run.second, pos, index_comparator(*_sstable->_schema)));
 
         if (_previous_summary_idx == 0) {
             sstlog.trace("index {}: first entry", this);
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sstables/mc_format.hh"
+#include "sstables/exceptions.hh"
+#include "vint-serialization.hh"
+
+namespace sstables {
+namespace mc {
+
+static uint64_t make_block_header(const std::vector<bytes_opt>& values, unsigned offset) {
+    uint64_t header = 0;
+    auto limit = std::min<unsigned>(offset + clustering_block_size, values.size());
+    for (auto i = offset; i < limit; ++i) {
+        auto index_in_block = i - offset;
+        if (!values[i]) {
+            header |= clustering_block_null_mask(index_in_block);
+        } else if (values[i]->empty()) {
+            header |= clustering_block_empty_mask(index_in_block);
+        }
+    }
+    return header;
+}
+
+size_t clustering_blocks_serialized_size(const std::vector<bytes_opt>& values) {
+    size_t size = 0;
+    for (unsigned offset = 0; offset < values.size(); offset += clustering_block_size) {
+        size += unsigned_vint::serialized_size(make_block_header(values, offset));
+    }
+    for (auto&& v : values) {
+        if (v && !v->empty()) {
+            size += unsigned_vint::serialized_size(v->size()) + v->size();
+        }
+    }
+    return size;
+}
+
+void write_clustering_blocks(bytes_ostream& out, const std::vector<bytes_opt>& values) {
+    for (unsigned offset = 0; offset < values.size(); offset += clustering_block_size) {
+        out.write_unsigned_vint(make_block_header(values, offset));
+        auto limit = std::min<unsigned>(offset + clustering_block_size, values.size());
+        for (auto i = offset; i < limit; ++i) {
+            if (values[i] && !values[i]->empty()) {
+                out.write_unsigned_vint(values[i]->size());
+                out.write(*values[i]);
+            }
+        }
+    }
+}
+
+static uint64_t read_vint(bytes_view& in) {
+    if (in.empty()) {
+        throw malformed_sstable_exception("truncated clustering block");
+    }
+    auto dv = unsigned_vint::deserialize(in);
+    in.remove_prefix(dv.size);
+    return dv.value;
+}
+
+std::vector<bytes_opt> read_clustering_blocks(bytes_view& in, unsigned n_components) {
+    std::vector<bytes_opt> values;
+    values.reserve(n_components);
+    for (unsigned offset = 0; offset < n_components; offset += clustering_block_size) {
+        auto header = read_vint(in);
+        auto limit = std::min(offset + clustering_block_size, n_components);
+        for (auto i = offset; i < limit; ++i) {
+            auto index_in_block = i - offset;
+            if (header & clustering_block_null_mask(index_in_block)) {
+                values.emplace_back();
+            } else if (header & clustering_block_empty_mask(index_in_block)) {
+                values.emplace_back(bytes());
+            } else {
+                auto len = read_vint(in);
+                if (in.size() < len) {
+                    throw malformed_sstable_exception("truncated clustering value");
+                }
+                values.emplace_back(bytes(in.begin(), in.begin() + len));
+                in.remove_prefix(len);
+            }
+        }
+    }
+    return values;
+}
+
+} // namespace mc
+} // namespace sstables
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "bytes.hh"
+#include "bytes_ostream.hh"
+#include "stdx.hh"
+
+#include <vector>
+
+namespace sstables {
+namespace mc {
+
+//
+// Helpers for the delta-encoded row layout used by the "mc" format
+// generation (the storage engine format introduced by Cassandra 3.0).
+//
+// Unlike ka/la, which repeat the full column name and a fixed 16-bit
+// length field for every cell, mc serializes the clustering prefix of a
+// row once, as a sequence of "clustering blocks": groups of up to 32
+// values preceded by a single unsigned vint header carrying two bits per
+// value (is-null and is-empty), followed by the non-null, non-empty
+// values themselves, each length-prefixed with an unsigned vint.
+//
+
+// Number of clustering values covered by a single block header.
+static constexpr unsigned clustering_block_size = 32;
+
+inline uint64_t clustering_block_null_mask(unsigned index_in_block) {
+    return uint64_t(1) << (index_in_block * 2);
+}
+
+inline uint64_t clustering_block_empty_mask(unsigned index_in_block) {
+    return uint64_t(1) << (index_in_block * 2 + 1);
+}
+
+// Returns the exact number of bytes write_clustering_blocks() will emit
+// for the given prefix, so callers can size vint-encoded row headers
+// without a bounce buffer.
+size_t clustering_blocks_serialized_size(const std::vector<bytes_opt>& values);
+
+// Serializes a full clustering prefix as a sequence of clustering blocks.
+// A disengaged optional stands for a null value.
+void write_clustering_blocks(bytes_ostream& out, const std::vector<bytes_opt>& values);
+
+// Deserializes n_components clustering values, advancing `in` past the
+// consumed bytes. Throws malformed_sstable_exception on truncated input.
+std::vector<bytes_opt> read_clustering_blocks(bytes_view& in, unsigned n_components);
+
+} // namespace mc
+} // namespace sstables
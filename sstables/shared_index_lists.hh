@@ -22,6 +22,8 @@
 #pragma once
 
 #include "index_entry.hh"
+#include <list>
+#include <unordered_map>
 #include <vector>
 #include <seastar/core/future.hh>
 #include "utils/loading_shared_values.hh"
@@ -32,6 +34,9 @@ using index_list = std::vector<index_entry>;
 
 // Associative cache of summary index -> index_list
 // Entries stay around as long as there is any live external reference (list_ptr) to them.
+// On top of that, recently used lists are retained in an LRU bounded by
+// a per-instance memory budget, so that hot index pages are not re-read
+// and re-parsed from Index.db after the last concurrent reader finishes.
 // Supports asynchronous insertion, ensures that only one entry will be loaded.
 class shared_index_lists {
 public:
@@ -40,27 +45,48 @@ public:
         uint64_t hits = 0; // Number of times entry was found ready
         uint64_t misses = 0; // Number of times entry was not found
         uint64_t blocks = 0; // Number of times entry was not ready (>= misses)
+        uint64_t evictions = 0; // Number of times a retained entry was evicted
     } _shard_stats;
 
     struct stats_updater {
         static void inc_hits() noexcept { ++_shard_stats.hits; }
         static void inc_misses() noexcept { ++_shard_stats.misses; }
         static void inc_blocks() noexcept { ++_shard_stats.blocks; }
-        static void inc_evictions() noexcept {}
+        static void inc_evictions() noexcept { ++_shard_stats.evictions; }
     };
 
+    // Per-sstable budget for lists kept alive past the last external
+    // reference. Concurrent readers are unaffected by the budget; they
+    // always share the entry through loading_shared_values.
+    static constexpr size_t default_retention_capacity = 1 << 20;
+
     using loading_shared_lists_type = utils::loading_shared_values<key_type, index_list, std::hash<key_type>, std::equal_to<key_type>, stats_updater>;
     // Pointer to index_list
     using list_ptr = loading_shared_lists_type::entry_ptr;
 private:
+    using lru_type = std::list<std::pair<key_type, list_ptr>>;
 
     loading_shared_lists_type _lists;
+    // Holds extra references keeping recently used lists alive. Declared
+    // after _lists so its references are dropped first on destruction.
+    lru_type _lru;
+    std::unordered_map<key_type, lru_type::iterator> _lru_index;
+    size_t _retained_memory = 0;
+    size_t _retention_capacity = default_retention_capacity;
 public:
 
     shared_index_lists() = default;
     shared_index_lists(shared_index_lists&&) = delete;
     shared_index_lists(const shared_index_lists&) = delete;
 
+    static size_t list_memory_size(const index_list& list) {
+        size_t size = sizeof(index_list);
+        for (auto&& e : list) {
+            size += sizeof(index_entry) + e.get_key_bytes().size() + e.get_promoted_index_size();
+        }
+        return size;
+    }
+
     // Returns a future which resolves with a shared pointer to index_list for given key.
     // Always returns a valid pointer if succeeds. The pointer is never invalidated externally.
     //
@@ -70,10 +96,48 @@ public:
     // The loader object does not survive deferring, so the caller must deal with its liveness.
     template<typename Loader>
     future<list_ptr> get_or_load(const key_type& key, Loader&& loader) {
-        return _lists.get_or_load(key, std::forward<Loader>(loader));
+        return _lists.get_or_load(key, std::forward<Loader>(loader)).then([this, key] (list_ptr ptr) {
+            touch(key, ptr);
+            return ptr;
+        });
+    }
+
+    // Adjusts the memory budget for retained lists, evicting as needed.
+    void set_retention_capacity(size_t capacity) {
+        _retention_capacity = capacity;
+        evict_excess();
     }
 
+    size_t retained_memory() const { return _retained_memory; }
+
     static const stats& shard_stats() { return _shard_stats; }
+private:
+    void touch(const key_type& key, const list_ptr& ptr) {
+        auto it = _lru_index.find(key);
+        if (it != _lru_index.end()) {
+            _lru.splice(_lru.begin(), _lru, it->second);
+            return;
+        }
+        auto size = list_memory_size(*ptr);
+        if (size > _retention_capacity) {
+            return; // Never retain a single list larger than the whole budget.
+        }
+        _lru.emplace_front(key, ptr);
+        _lru_index.emplace(key, _lru.begin());
+        _retained_memory += size;
+        evict_excess();
+    }
+
+    void evict_excess() {
+        while (_retained_memory > _retention_capacity && !_lru.empty()) {
+            auto& victim = _lru.back();
+            _retained_memory -= list_memory_size(*victim.second);
+            _lru_index.erase(victim.first);
+            // Dropping the reference counts the eviction through
+            // loading_shared_values when ours was the last one.
+            _lru.pop_back();
+        }
+    }
 };
 
 }
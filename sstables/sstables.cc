@@ -30,8 +30,10 @@
 #include "core/shared_ptr.hh"
 #include "core/do_with.hh"
 #include "core/thread.hh"
+#include "core/timer.hh"
 #include <seastar/core/shared_future.hh>
 #include <seastar/core/byteorder.hh>
+#include <seastar/core/queue.hh>
 #include <iterator>
 
 #include "types.hh"
@@ -91,18 +93,18 @@ read_monitor_generator& default_read_monitor_generator() {
 }
 
 static future<file> open_sstable_component_file(const io_error_handler& error_handler, sstring name, open_flags flags,
-        file_open_options options) {
+        file_open_options options, disk_device_tracker::device_id device) {
     if (flags != open_flags::ro && get_config().enable_sstable_data_integrity_check()) {
-        return open_integrity_checked_file_dma(name, flags, options).then([&error_handler] (auto f) {
-            return make_checked_file(error_handler, std::move(f));
+        return open_integrity_checked_file_dma(name, flags, options).then([&error_handler, device] (auto f) {
+            return make_checked_file(error_handler, std::move(f), device);
         });
     }
-    return open_checked_file_dma(error_handler, name, flags, options);
+    return open_checked_file_dma(error_handler, name, flags, options, device);
 }
 
 future<file> new_sstable_component_file(const io_error_handler& error_handler, sstring name, open_flags flags,
-        file_open_options options = {}) {
-    return open_sstable_component_file(error_handler, name, flags, options).handle_exception([name] (auto ep) {
+        file_open_options options = {}, disk_device_tracker::device_id device = disk_device_tracker::no_device) {
+    return open_sstable_component_file(error_handler, name, flags, options, device).handle_exception([name] (auto ep) {
         sstlog.error("Could not create SSTable component {}. Found exception: {}", name, ep);
         return make_exception_future<file>(ep);
     });
@@ -190,7 +192,8 @@ make_sstable(schema_ptr schema, sstring dir, int64_t generation, sstable_version
 
 std::unordered_map<sstable::version_types, sstring, enum_hash<sstable::version_types>> sstable::_version_string = {
     { sstable::version_types::ka , "ka" },
-    { sstable::version_types::la , "la" }
+    { sstable::version_types::la , "la" },
+    { sstable::version_types::mc , "mc" }
 };
 
 std::unordered_map<sstable::format_types, sstring, enum_hash<sstable::format_types>> sstable::_format_string = {
@@ -463,6 +466,60 @@ future<> parse(random_access_reader& in, disk_array<Size, Members>& arr) {
     }).finally([len] {});
 }
 
+// The bloom filter bits are parsed into this instead of sstables::filter.
+// Going through the generic disk_array path would materialize all the words
+// in an intermediate chunked_vector only to copy them into the bitset right
+// after, transiently doubling the filter's memory footprint. That adds up at
+// startup on nodes carrying many sstables with large filters, so each chunk
+// of words is loaded from the read buffer straight into its final position
+// in the bitset instead.
+struct filter_bits {
+    uint32_t hashes = 0;
+    stdx::optional<large_bitset> bits;
+};
+
+// Filters written in the cache-line-blocked layout (see
+// utils::filter::blocked_bloom_filter) mark it with this bit in the
+// serialized hash count, since the probe scheme must match between the
+// writer and the reader. Hash counts are tiny, so the bit is never set
+// in filters written by versions predating the blocked layout.
+static constexpr uint32_t blocked_filter_mark = 1u << 31;
+
+static utils::filter_ptr filter_from_bits(filter_bits& filter) {
+    if (filter.hashes & blocked_filter_mark) {
+        return utils::filter::create_blocked_filter(filter.hashes & ~blocked_filter_mark, std::move(*filter.bits));
+    }
+    return utils::filter::create_filter(filter.hashes, std::move(*filter.bits));
+}
+
+future<> parse(random_access_reader& in, filter_bits& f) {
+    return parse(in, f.hashes).then([&in, &f] {
+        return in.read_exactly(sizeof(uint32_t)).then([&in, &f] (auto buf) {
+            check_buf_size(buf, sizeof(uint32_t));
+
+            uint32_t nr_words;
+            read_integer(buf, nr_words);
+            f.bits.emplace(size_t(nr_words) * std::numeric_limits<uint64_t>::digits);
+            auto done = make_lw_shared<size_t>(0);
+            return repeat([&in, &f, len = size_t(nr_words), done] {
+                auto now = std::min(len - *done, 100000 / sizeof(uint64_t));
+                return in.read_exactly(now * sizeof(uint64_t)).then([&f, len, now, done] (auto buf) {
+                    check_buf_size(buf, now * sizeof(uint64_t));
+
+                    auto *nr = reinterpret_cast<net::packed<uint64_t> *>(buf.get_write());
+                    for (size_t i = 0; i < now; ++i) {
+                        nr[i].raw = net::ntoh(nr[i]);
+                    }
+                    auto *words = reinterpret_cast<const uint64_t *>(buf.get());
+                    f.bits->load(words, words + now, *done * std::numeric_limits<uint64_t>::digits);
+                    *done += now;
+                    return make_ready_future<stop_iteration>(*done == len ? stop_iteration::yes : stop_iteration::no);
+                });
+            });
+        });
+    });
+}
+
 template <typename Members>
 inline typename std::enable_if_t<!std::is_integral<Members>::value, void>
 write(file_writer& out, const utils::chunked_vector<Members>& arr) {
@@ -650,6 +707,7 @@ future<> parse(random_access_reader& in, summary& s) {
             // Positions are encoded in little-endian.
             auto b = buf.get();
             s.positions = utils::chunked_vector<pos_type>();
+            s.positions.reserve_partial(s.header.size + 1);
             for (size_t i = 0; i < s.header.size; ++i) {
                 s.positions.push_back(seastar::read_le<pos_type>(b));
                 b += sizeof(pos_type);
@@ -687,13 +745,25 @@ future<> parse(random_access_reader& in, summary& s) {
 
                     // position is little-endian encoded
                     entry.position = seastar::read_le<uint64_t>(buf.get());
-                    entry.token = dht::global_partitioner().get_token(entry.get_key());
 
                     return make_ready_future<>();
                 });
             }).then([&s] {
                 // Delete last element which isn't part of the on-disk format.
                 s.positions.pop_back();
+                // Compute the tokens of all entries in one batch, which lets
+                // the partitioner overlap the hashing of adjacent keys.
+                std::vector<sstables::key_view> keys;
+                keys.reserve(s.entries.size());
+                for (auto& entry : s.entries) {
+                    keys.push_back(entry.get_key());
+                }
+                auto tokens = dht::global_partitioner().get_tokens(keys);
+                auto token_it = tokens.begin();
+                for (auto& entry : s.entries) {
+                    entry.token = std::move(*token_it++);
+                }
+                s.rebuild_token_samples();
             });
         });
     });
@@ -840,32 +910,46 @@ struct streaming_histogram_element {
 };
 
 future<> parse(random_access_reader& in, utils::streaming_histogram& sh) {
-    auto a = std::make_unique<disk_array<uint32_t, streaming_histogram_element>>();
+    auto len = std::make_unique<uint32_t>();
 
-    auto f = parse(in, sh.max_bin_size, *a);
-    return f.then([&sh, a = std::move(a)] {
-        auto length = a->elements.size();
+    auto f = parse(in, sh.max_bin_size, *len);
+    return f.then([&in, &sh, len = std::move(len)] {
+        uint32_t length = *len;
         if (length > sh.max_bin_size) {
             throw malformed_sstable_exception("Streaming histogram with more entries than allowed. Can't continue!");
         }
 
-        // Find bad histogram which had incorrect elements merged due to use of
-        // unordered map. The keys will be unordered. Histogram which size is
-        // less than max allowed will be correct because no entries needed to be
-        // merged, so we can avoid discarding those.
-        // look for commit with title 'streaming_histogram: fix update' for more details.
-        auto possibly_broken_histogram = length == sh.max_bin_size;
-        auto less_comp = [] (auto& x, auto& y) { return x.key < y.key; };
-        if (possibly_broken_histogram && !boost::is_sorted(a->elements, less_comp)) {
-            return make_ready_future<>();
-        }
+        // The bins have a fixed 16-byte layout, so pull them in with a single
+        // read and a swap loop, like the estimated histograms above, instead
+        // of two chained parses per bin.
+        auto type_size = sizeof(uint64_t) * 2;
+        return in.read_exactly(length * type_size).then([&sh, length] (auto buf) {
+            auto type_size = sizeof(uint64_t) * 2;
+            check_buf_size(buf, length * type_size);
 
-        auto transform = [] (auto element) -> std::pair<streaming_histogram_element::key_type, streaming_histogram_element::value_type> {
-            return { element.key, element.value };
-        };
-        boost::copy(a->elements | boost::adaptors::transformed(transform), std::inserter(sh.bin, sh.bin.end()));
+            auto *nr = reinterpret_cast<const net::packed<uint64_t> *>(buf.get());
 
-        return make_ready_future<>();
+            // Find bad histogram which had incorrect elements merged due to use of
+            // unordered map. The keys will be unordered. Histogram which size is
+            // less than max allowed will be correct because no entries needed to be
+            // merged, so we can avoid discarding those.
+            // look for commit with title 'streaming_histogram: fix update' for more details.
+            if (length == sh.max_bin_size) {
+                for (size_t i = 1; i < length; ++i) {
+                    if (convert<double>(net::ntoh(nr[2 * i])) < convert<double>(net::ntoh(nr[2 * (i - 1)]))) {
+                        return make_ready_future<>();
+                    }
+                }
+            }
+
+            // The keys are (now known to be) non-decreasing, so inserting
+            // with an end hint keeps each insertion amortized constant.
+            for (size_t i = 0; i < length; ++i) {
+                sh.bin.emplace_hint(sh.bin.end(), convert<double>(net::ntoh(nr[2 * i])), net::ntoh(nr[2 * i + 1]));
+            }
+
+            return make_ready_future<>();
+        });
     });
 }
 
@@ -941,7 +1025,7 @@ future<> sstable::read_toc() {
 
     sstlog.debug("Reading TOC file {} ", file_path);
 
-    return open_checked_file_dma(_read_error_handler, file_path, open_flags::ro).then([this, file_path] (file f) {
+    return open_checked_file_dma(_read_error_handler, file_path, open_flags::ro, {}, _device).then([this, file_path] (file f) {
         auto bufptr = allocate_aligned_buffer<char>(4096, 4096);
         auto buf = bufptr.get();
 
@@ -1017,7 +1101,7 @@ void sstable::write_toc(const io_priority_class& pc) {
     // If creation of temporary TOC failed, it implies that that boot failed to
     // delete a sstable with temporary for this column family, or there is a
     // sstable being created in parallel with the same generation.
-    file f = new_sstable_component_file(_write_error_handler, file_path, open_flags::wo | open_flags::create | open_flags::exclusive).get0();
+    file f = new_sstable_component_file(_write_error_handler, file_path, open_flags::wo | open_flags::create | open_flags::exclusive, {}, _device).get0();
 
     bool toc_exists = file_exists(filename(sstable::component_type::TOC)).get0();
     if (toc_exists) {
@@ -1073,11 +1157,11 @@ future<> sstable::seal_sstable() {
     });
 }
 
-void write_crc(io_error_handler& error_handler, const sstring file_path, const checksum& c) {
+void write_crc(io_error_handler& error_handler, disk_device_tracker::device_id device, const sstring file_path, const checksum& c) {
     sstlog.debug("Writing CRC file {} ", file_path);
 
     auto oflags = open_flags::wo | open_flags::create | open_flags::exclusive;
-    file f = new_sstable_component_file(error_handler, file_path, oflags).get0();
+    file f = new_sstable_component_file(error_handler, file_path, oflags, {}, device).get0();
 
     file_output_stream_options options;
     options.buffer_size = 4096;
@@ -1087,11 +1171,11 @@ void write_crc(io_error_handler& error_handler, const sstring file_path, const c
 }
 
 // Digest file stores the full checksum of data file converted into a string.
-void write_digest(io_error_handler& error_handler, const sstring file_path, uint32_t full_checksum) {
+void write_digest(io_error_handler& error_handler, disk_device_tracker::device_id device, const sstring file_path, uint32_t full_checksum) {
     sstlog.debug("Writing Digest file {} ", file_path);
 
     auto oflags = open_flags::wo | open_flags::create | open_flags::exclusive;
-    auto f = new_sstable_component_file(error_handler, file_path, oflags).get0();
+    auto f = new_sstable_component_file(error_handler, file_path, oflags, {}, device).get0();
 
     file_output_stream_options options;
     options.buffer_size = 4096;
@@ -1114,7 +1198,7 @@ future<> sstable::read_simple(T& component, const io_priority_class& pc) {
     return open_file_dma(file_path, open_flags::ro).then([this, &component] (file fi) {
         auto fut = fi.size();
         return fut.then([this, &component, fi = std::move(fi)] (uint64_t size) {
-            auto f = make_checked_file(_read_error_handler, fi);
+            auto f = make_checked_file(_read_error_handler, fi, _device);
             auto r = make_lw_shared<file_random_access_reader>(std::move(f), size, sstable_buffer_size);
             auto fut = parse(*r, component);
             return fut.finally([r] {
@@ -1137,7 +1221,7 @@ template <sstable::component_type Type, typename T>
 void sstable::write_simple(const T& component, const io_priority_class& pc) {
     auto file_path = filename(Type);
     sstlog.debug(("Writing " + _component_map[Type] + " file {} ").c_str(), file_path);
-    file f = new_sstable_component_file(_write_error_handler, file_path, open_flags::wo | open_flags::create | open_flags::exclusive).get0();
+    file f = new_sstable_component_file(_write_error_handler, file_path, open_flags::wo | open_flags::create | open_flags::exclusive, {}, _device).get0();
 
     file_output_stream_options options;
     options.buffer_size = sstable_buffer_size;
@@ -1275,7 +1359,7 @@ void sstable::write_statistics(const io_priority_class& pc) {
 void sstable::rewrite_statistics(const io_priority_class& pc) {
     auto file_path = filename(component_type::TemporaryStatistics);
     sstlog.debug("Rewriting statistics component of sstable {}", get_filename());
-    file f = new_sstable_component_file(_write_error_handler, file_path, open_flags::wo | open_flags::create | open_flags::truncate).get0();
+    file f = new_sstable_component_file(_write_error_handler, file_path, open_flags::wo | open_flags::create | open_flags::truncate, {}, _device).get0();
 
     file_output_stream_options options;
     options.buffer_size = sstable_buffer_size;
@@ -1308,7 +1392,7 @@ future<> sstable::read_summary(const io_priority_class& pc) {
 }
 
 future<file> sstable::open_file(component_type type, open_flags flags, file_open_options opts) {
-    auto f = new_sstable_component_file(_read_error_handler, filename(type), flags, opts);
+    auto f = new_sstable_component_file(_read_error_handler, filename(type), flags, opts, _device);
     if ((type != component_type::Data && type != component_type::Index)
                     || get_config().extensions().sstable_file_io_extensions().empty()) {
         return f;
@@ -1406,32 +1490,134 @@ future<> sstable::create_data() {
     });
 }
 
+// Tracks, per shard, the sstables whose bloom filter was loaded lazily, so
+// that a timer can unload the filters which stopped being consulted. The
+// filters themselves are per-shard too (see sstable::_lazy_filter), so the
+// registry deliberately holds plain pointers: sstables deregister themselves
+// on destruction, and an in-flight load keeps its sstable alive by holding
+// shared_from_this().
+class lazy_filter_registry {
+    std::unordered_set<sstable*> _sstables;
+    timer<lowres_clock> _reaper;
+public:
+    lazy_filter_registry() : _reaper([this] { reap(); }) { }
+    void add(sstable* sst) {
+        _sstables.insert(sst);
+        if (!_reaper.armed()) {
+            _reaper.arm(period());
+        }
+    }
+    void remove(sstable* sst) {
+        _sstables.erase(sst);
+    }
+private:
+    static lowres_clock::duration period() {
+        // Checking at the timeout's own granularity means a filter lives for
+        // at most twice the configured idle time, which is close enough.
+        return std::chrono::seconds(std::max(get_config().sstable_filter_idle_timeout_in_s(), 1u));
+    }
+    void reap() {
+        auto used_before = lowres_clock::now() - period();
+        for (auto it = _sstables.begin(); it != _sstables.end();) {
+            if ((*it)->maybe_unload_filter(used_before)) {
+                it = _sstables.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (!_sstables.empty()) {
+            _reaper.arm(period());
+        }
+    }
+};
+
+static thread_local lazy_filter_registry the_lazy_filter_registry;
+
 future<> sstable::read_filter(const io_priority_class& pc) {
     if (!has_component(sstable::component_type::Filter)) {
         _components->filter = std::make_unique<utils::filter::always_present_filter>();
         return make_ready_future<>();
     }
 
-    return do_with(sstables::filter(), [this, &pc] (auto& filter) {
+    if (get_config().sstable_filter_idle_timeout_in_s()) {
+        // Lazy mode: leave the shared filter unset and load a per-shard copy
+        // on first use instead (see maybe_filter()). Until then reads treat
+        // every key as possibly present.
+        return make_ready_future<>();
+    }
+
+    return do_with(filter_bits(), [this, &pc] (auto& filter) {
         return this->read_simple<sstable::component_type::Filter>(filter, pc).then([this, &filter] {
-            large_bitset bs(filter.buckets.elements.size() * 64);
-            bs.load(filter.buckets.elements.begin(), filter.buckets.elements.end());
-            _components->filter = utils::filter::create_filter(filter.hashes, std::move(bs));
+            _components->filter = filter_from_bits(filter);
         });
     });
 }
 
+utils::i_filter* sstable::maybe_filter() {
+    if (_components->filter) {
+        return _components->filter.get();
+    }
+    _lazy_filter_used = lowres_clock::now();
+    if (_lazy_filter) {
+        return _lazy_filter.get();
+    }
+    if (!_lazy_filter_loading && has_component(sstable::component_type::Filter)) {
+        load_filter_in_background();
+    }
+    return nullptr;
+}
+
+void sstable::load_filter_in_background() {
+    _lazy_filter_loading = true;
+    // The sstable may be dropped while the read is in flight, so the
+    // continuation keeps it alive by holding shared_from_this().
+    do_with(filter_bits(), [this] (auto& filter) {
+        return this->read_simple<sstable::component_type::Filter>(filter, default_priority_class()).then([this, &filter] {
+            _lazy_filter = filter_from_bits(filter);
+            _lazy_filter_used = lowres_clock::now();
+            the_lazy_filter_registry.add(this);
+        });
+    }).then_wrapped([this, sst = shared_from_this(), op = background_jobs().start()] (future<> f) {
+        _lazy_filter_loading = false;
+        if (f.failed()) {
+            // Not fatal: reads keep falling back to the index, and the next
+            // filter check will retry the load.
+            sstlog.warn("Failed to load bloom filter of {}: {}", get_filename(), f.get_exception());
+        }
+    });
+}
+
+bool sstable::maybe_unload_filter(lowres_clock::time_point used_before) {
+    if (_lazy_filter_loading) {
+        // A load is in flight; look again on the next pass.
+        return false;
+    }
+    if (_lazy_filter && _lazy_filter_used < used_before) {
+        sstlog.debug("Unloading idle bloom filter of {}", get_filename());
+        _lazy_filter = nullptr;
+    }
+    return !_lazy_filter;
+}
+
 void sstable::write_filter(const io_priority_class& pc) {
     if (!has_component(sstable::component_type::Filter)) {
         return;
     }
 
-    auto f = static_cast<utils::filter::murmur3_bloom_filter *>(_components->filter.get());
+    uint32_t hashes;
+    large_bitset* bs;
+    if (auto bf = dynamic_cast<utils::filter::blocked_bloom_filter*>(_components->filter.get())) {
+        hashes = bf->num_hashes() | blocked_filter_mark;
+        bs = &bf->bits();
+    } else {
+        auto f = static_cast<utils::filter::murmur3_bloom_filter*>(_components->filter.get());
+        hashes = f->num_hashes();
+        bs = &f->bits();
+    }
 
-    auto&& bs = f->bits();
-    utils::chunked_vector<uint64_t> v(align_up(bs.size(), size_t(64)) / 64);
-    bs.save(v.begin());
-    auto filter = sstables::filter(f->num_hashes(), std::move(v));
+    utils::chunked_vector<uint64_t> v(align_up(bs->size(), size_t(64)) / 64);
+    bs->save(v.begin());
+    auto filter = sstables::filter(hashes, std::move(v));
     write_simple<sstable::component_type::Filter>(filter, pc);
 }
 
@@ -1456,8 +1642,8 @@ future<> sstable::load(const io_priority_class& pc) {
 future<> sstable::load(sstables::foreign_sstable_open_info info) {
     return read_toc().then([this, info = std::move(info)] () mutable {
         _components = std::move(info.components);
-        _data_file = make_checked_file(_read_error_handler, info.data.to_file());
-        _index_file = make_checked_file(_read_error_handler, info.index.to_file());
+        _data_file = make_checked_file(_read_error_handler, info.data.to_file(), _device);
+        _index_file = make_checked_file(_read_error_handler, info.index.to_file(), _device);
         _shards = std::move(info.owners);
         validate_min_max_metadata();
         validate_max_local_deletion_time();
@@ -1656,6 +1842,7 @@ void sstable::maybe_flush_pi_block(file_writer& out,
     } else if (out.offset() >= _pi_write.block_next_start_offset) {
         // If we wrote enough bytes to the partition since we output a sample
         // to the promoted index, output one now and start a new one.
+        _pi_write.block_offsets.push_back(_pi_write.data.size());
         output_promoted_index_entry(_pi_write.data,
                 _pi_write.block_first_colname,
                 _pi_write.block_last_colname,
@@ -1969,6 +2156,7 @@ static void seal_summary(summary& s,
     s.header.size_at_full_sampling = sstable::get_size_at_full_sampling(state.partition_count, s.header.min_index_interval);
 
     s.header.memory_size = s.header.size * sizeof(uint32_t);
+    s.positions.reserve_partial(s.header.size);
     for (auto& e: s.entries) {
         s.positions.push_back(s.header.memory_size);
         s.header.memory_size += e.key.size() + sizeof(e.position);
@@ -1982,6 +2170,7 @@ static void seal_summary(summary& s,
         // An empty last_mutation indicates we had just one partition
         s.last_key.value = s.first_key.value;
     }
+    s.rebuild_token_samples();
 }
 
 static
@@ -2051,19 +2240,28 @@ static void seal_statistics(statistics& s, metadata_collector& collector,
 void components_writer::maybe_add_summary_entry(summary& s, const dht::token& token, bytes_view key, uint64_t data_offset,
         uint64_t index_offset, index_sampling_state& state) {
     state.partition_count++;
+    state.partitions_since_summary_entry++;
+    auto entry_size = 8 + 2 + key.size();  // offset + key_size.size + key.size
     // generates a summary entry when possible (= keep summary / data size ratio within reasonable limits)
-    if (data_offset >= state.next_data_offset_to_write_summary) {
-        auto entry_size = 8 + 2 + key.size();  // offset + key_size.size + key.size
-        state.next_data_offset_to_write_summary += state.summary_byte_cost * entry_size;
+    bool byte_trigger = data_offset >= state.next_data_offset_to_write_summary;
+    // Small partitions satisfy the byte trigger only every few hundred
+    // partitions, so also sample every min_index_interval partitions, unless
+    // that would push the summary past a hard budget (a multiple of the
+    // configured ratio, which protects sstables with unusually large keys).
+    auto hard_byte_cost = std::max<size_t>(state.summary_byte_cost / index_sampling_state::interval_trigger_budget_multiplier, 1);
+    bool interval_trigger = !byte_trigger
+            && state.partitions_since_summary_entry >= state.min_index_interval
+            && (state.summary_memory + entry_size) * hard_byte_cost <= data_offset;
+    if (byte_trigger || interval_trigger) {
+        if (byte_trigger) {
+            state.next_data_offset_to_write_summary += state.summary_byte_cost * entry_size;
+        }
+        state.summary_memory += entry_size;
+        state.partitions_since_summary_entry = 0;
         s.entries.push_back({ token, bytes(key.data(), key.size()), index_offset });
     }
 }
 
-void components_writer::maybe_add_summary_entry(const dht::token& token, bytes_view key) {
-    return maybe_add_summary_entry(_sst._components->summary, token, key, get_offset(),
-        _index.offset(), _index_sampling_state);
-}
-
 // Returns offset into data component.
 uint64_t components_writer::get_offset() const {
     if (_sst.has_component(sstable::component_type::CompressionInfo)) {
@@ -2101,6 +2299,83 @@ static size_t summary_byte_cost() {
     return summary_ratio ? (1 / summary_ratio) : components_writer::default_summary_byte_cost;
 }
 
+// Builds the summary and bloom filter off the data and index write path.
+// consume_new_partition() pushes one entry per partition into a bounded queue
+// which a background fiber drains, so key hashing and summary sampling overlap
+// with the data and index writes instead of delaying them. A disengaged
+// optional marks the end of the stream. The fiber owns the sampling state, so
+// it must be joined (close()) before the summary is sealed.
+struct components_writer::summary_and_filter_builder {
+    struct entry {
+        bytes key;
+        dht::token token;
+        uint64_t data_offset;
+        uint64_t index_offset;
+    };
+    // Bounds how far the writer may run ahead of the builder fiber.
+    static constexpr size_t queue_depth = 128;
+
+    sstable& sst;
+    index_sampling_state state;
+    seastar::queue<stdx::optional<entry>> entries;
+    bool closed = false;
+    std::exception_ptr ex;
+    future<> done;
+
+    summary_and_filter_builder(sstable& sst)
+        : sst(sst)
+        , entries(queue_depth)
+        , done(build()) {
+        // Safe to set after the fiber is started: it cannot run before the
+        // first preemption point, and there is no entry for it to pop yet.
+        state.summary_byte_cost = summary_byte_cost();
+    }
+
+    future<> build() {
+        return repeat([this] {
+            return entries.pop_eventually().then([this] (stdx::optional<entry> e) {
+                if (!e) {
+                    return stop_iteration::yes;
+                }
+                // Keep draining after a failure, so add() never blocks on a
+                // full queue with no consumer; close() rethrows the error.
+                if (!ex) {
+                    try {
+                        components_writer::maybe_add_summary_entry(sst._components->summary, e->token, bytes_view(e->key),
+                            e->data_offset, e->index_offset, state);
+                        sst._components->filter->add(bytes_view(e->key));
+                    } catch (...) {
+                        ex = std::current_exception();
+                    }
+                }
+                return stop_iteration::no;
+            });
+        }).then([this] () -> future<> {
+            if (ex) {
+                return make_exception_future<>(std::move(ex));
+            }
+            return make_ready_future<>();
+        });
+    }
+
+    void add(bytes_view key, const dht::token& token, uint64_t data_offset, uint64_t index_offset) {
+        // The writer runs in a seastar thread, so we may block here if the
+        // builder fiber falls behind.
+        entries.push_eventually(entry{ bytes(key.data(), key.size()), token, data_offset, index_offset }).get();
+    }
+
+    // Flushes the queue and joins the builder fiber. Idempotent; also called
+    // from ~components_writer() on abort paths.
+    void close() {
+        if (closed) {
+            return;
+        }
+        closed = true;
+        entries.push_eventually(stdx::nullopt).get();
+        done.get();
+    }
+};
+
 components_writer::components_writer(sstable& sst, const schema& s, file_writer& out,
                                      uint64_t estimated_partitions,
                                      const sstable_writer_config& cfg,
@@ -2112,14 +2387,20 @@ components_writer::components_writer(sstable& sst, const schema& s, file_writer&
     , _index_needs_close(true)
     , _max_sstable_size(cfg.max_sstable_size)
     , _tombstone_written(false)
+    , _builder(std::make_unique<summary_and_filter_builder>(sst))
     , _range_tombstones(s)
 {
-    _sst._components->filter = utils::i_filter::get_filter(estimated_partitions, _schema.bloom_filter_fp_chance());
+    auto filter_format = get_config().sstable_blocked_bloom_filter()
+            ? utils::filter_format::blocked
+            : utils::filter_format::partitioned;
+    _sst._components->filter = utils::i_filter::get_filter(estimated_partitions, _schema.bloom_filter_fp_chance(), filter_format);
     _sst._pi_write.desired_block_size = cfg.promoted_index_block_size.value_or(get_config().column_index_size_in_kb() * 1024);
     _sst._correctly_serialize_non_compound_range_tombstones = cfg.correctly_serialize_non_compound_range_tombstones;
-    _index_sampling_state.summary_byte_cost = summary_byte_cost();
 
     prepare_summary(_sst._components->summary, estimated_partitions, _schema.min_index_interval());
+    // Same reasoning as for summary_byte_cost in the builder constructor:
+    // the fiber cannot have consumed an entry yet.
+    _builder->state.min_index_interval = _schema.min_index_interval();
 
     // FIXME: we may need to set repaired_at stats at this point.
 }
@@ -2130,8 +2411,7 @@ void components_writer::consume_new_partition(const dht::decorated_key& dk) {
 
     _partition_key = key::from_partition_key(_schema, dk.key());
 
-    maybe_add_summary_entry(dk.token(), bytes_view(*_partition_key));
-    _sst._components->filter->add(bytes_view(*_partition_key));
+    _builder->add(bytes_view(*_partition_key), dk.token(), get_offset(), _index.offset());
     _sst._collector.add_key(bytes_view(*_partition_key));
 
     auto p_key = disk_string_view<uint16_t>();
@@ -2144,6 +2424,7 @@ void components_writer::consume_new_partition(const dht::decorated_key& dk) {
     write_index_header(_index, p_key, _out.offset());
     _sst._pi_write.data = {};
     _sst._pi_write.numblocks = 0;
+    _sst._pi_write.block_offsets = {};
     _sst._pi_write.deltime.local_deletion_time = std::numeric_limits<int32_t>::max();
     _sst._pi_write.deltime.marked_for_delete_at = std::numeric_limits<int64_t>::min();
     _sst._pi_write.block_start_offset = _out.offset();
@@ -2211,6 +2492,15 @@ stop_iteration components_writer::consume(range_tombstone&& rt) {
 }
 
 void components_writer::write_tombstone(range_tombstone&& rt) {
+    // The clustering bounds of range tombstones must widen the min/max
+    // column names like rows do, or slice reads relying on that metadata
+    // could skip an sstable whose only relevant content is a covering
+    // tombstone.
+    if (_schema.clustering_key_size()) {
+        auto& collector = _sst.get_metadata_collector();
+        column_name_helper::min_max_components(_schema, collector.min_column_names(), collector.max_column_names(), rt.start.components());
+        column_name_helper::min_max_components(_schema, collector.min_column_names(), collector.max_column_names(), rt.end.components());
+    }
     auto start = composite::from_clustering_element(_schema, rt.start);
     auto start_marker = bound_kind_to_start_marker(rt.start_kind);
     auto end = composite::from_clustering_element(_schema, rt.end);
@@ -2227,6 +2517,7 @@ stop_iteration components_writer::consume_end_of_partition() {
     // However, if the _promoted_index is still empty, don't add a single
     // chunk - better not output a promoted index at all in this case.
     if (!_sst._pi_write.data.empty() && !_sst._pi_write.block_first_colname.empty()) {
+        _sst._pi_write.block_offsets.push_back(_sst._pi_write.data.size());
         output_promoted_index_entry(_sst._pi_write.data,
             _sst._pi_write.block_first_colname,
             _sst._pi_write.block_last_colname,
@@ -2234,10 +2525,24 @@ stop_iteration components_writer::consume_end_of_partition() {
             _out.offset() - _sst._pi_write.block_start_offset);
         _sst._pi_write.numblocks++;
     }
+    // Append the offsets of the blocks as a fixed-stride table, so readers
+    // can binary-search the blocks directly on disk
+    // (sstable_feature::PromotedIndexBlockOffsets). Readers which do not
+    // know about the table never parse past the last block, and skipping
+    // readers skip the promoted index by its size, so it is invisible to
+    // them.
+    if (_sst._pi_write.numblocks) {
+        char q[4];
+        for (auto off : _sst._pi_write.block_offsets) {
+            write_be(q, uint32_t(off));
+            _sst._pi_write.data.write(q, 4);
+        }
+    }
     write_index_promoted(_index, _sst._pi_write.data, _sst._pi_write.deltime,
             _sst._pi_write.numblocks);
     _sst._pi_write.data = {};
     _sst._pi_write.block_first_colname = {};
+    _sst._pi_write.block_offsets = {};
 
     int16_t end_of_row = 0;
     write(_out, end_of_row);
@@ -2257,8 +2562,10 @@ stop_iteration components_writer::consume_end_of_partition() {
 }
 
 void components_writer::consume_end_of_stream() {
+    _builder->close();
+
     // what if there is only one partition? what if it is empty?
-    seal_summary(_sst._components->summary, std::move(_first_key), std::move(_last_key), _index_sampling_state);
+    seal_summary(_sst._components->summary, std::move(_first_key), std::move(_last_key), _builder->state);
 
     _index_needs_close = false;
     _index.close().get();
@@ -2273,6 +2580,13 @@ void components_writer::consume_end_of_stream() {
 }
 
 components_writer::~components_writer() {
+    if (_builder) {
+        try {
+            _builder->close();
+        } catch (...) {
+            sstlog.error("components_writer failed to join summary and filter builder: {}", std::current_exception());
+        }
+    }
     if (_index_needs_close) {
         try {
             _index.close().get();
@@ -2339,10 +2653,10 @@ void sstable_writer::finish_file_writer()
 
     if (!_compression_enabled) {
         auto chksum_wr = static_cast<checksummed_file_writer*>(writer.get());
-        write_digest(_sst._write_error_handler, _sst.filename(sstable::component_type::Digest), chksum_wr->full_checksum());
-        write_crc(_sst._write_error_handler, _sst.filename(sstable::component_type::CRC), chksum_wr->finalize_checksum());
+        write_digest(_sst._write_error_handler, _sst._device, _sst.filename(sstable::component_type::Digest), chksum_wr->full_checksum());
+        write_crc(_sst._write_error_handler, _sst._device, _sst.filename(sstable::component_type::CRC), chksum_wr->finalize_checksum());
     } else {
-        write_digest(_sst._write_error_handler, _sst.filename(sstable::component_type::Digest), _sst._components->compression.full_checksum());
+        write_digest(_sst._write_error_handler, _sst._device, _sst.filename(sstable::component_type::Digest), _sst._components->compression.full_checksum());
     }
 }
 
@@ -2367,6 +2681,11 @@ sstable_writer::sstable_writer(sstable& sst, const schema& s, uint64_t estimated
     , _monitor(cfg.monitor)
     , _correctly_serialize_non_compound_range_tombstones(cfg.correctly_serialize_non_compound_range_tombstones)
 {
+    if (_sst._version == sstable::version_types::mc) {
+        // The components_writer still emits the ka/la row layout; refuse to
+        // produce an mc-named sstable with la-format data in it.
+        throw std::runtime_error("cannot write mc-format sstables yet");
+    }
     _sst.generate_toc(_schema.get_compressor_params().get_compressor(), _schema.bloom_filter_fp_chance());
     _sst.write_toc(_pc);
     _sst.create_data().get();
@@ -2446,14 +2765,19 @@ future<> sstable::generate_summary(const io_priority_class& pc) {
     }
 
     sstlog.info("Summary file {} not found. Generating Summary...", filename(sstable::component_type::Summary));
+    return build_summary_from_index(_components->summary, pc);
+}
+
+future<> sstable::build_summary_from_index(summary& s, const io_priority_class& pc) {
     class summary_generator {
         summary& _summary;
         index_sampling_state _state;
     public:
         std::experimental::optional<key> first_key, last_key;
 
-        summary_generator(summary& s) : _summary(s) {
+        summary_generator(summary& s, size_t min_index_interval) : _summary(s) {
             _state.summary_byte_cost = summary_byte_cost();
+            _state.min_index_interval = min_index_interval;
         }
         bool should_continue() {
             return true;
@@ -2472,24 +2796,24 @@ future<> sstable::generate_summary(const io_priority_class& pc) {
         }
     };
 
-    return open_checked_file_dma(_read_error_handler, filename(component_type::Index), open_flags::ro).then([this, &pc] (file index_file) {
-        return do_with(std::move(index_file), [this, &pc] (file index_file) {
-            return index_file.size().then([this, &pc, index_file] (auto index_size) {
+    return open_checked_file_dma(_read_error_handler, filename(component_type::Index), open_flags::ro).then([this, &s, &pc] (file index_file) {
+        return do_with(std::move(index_file), [this, &s, &pc] (file index_file) {
+            return index_file.size().then([this, &s, &pc, index_file] (auto index_size) {
                 // an upper bound. Surely to be less than this.
                 auto estimated_partitions = index_size / sizeof(uint64_t);
-                prepare_summary(_components->summary, estimated_partitions, _schema->min_index_interval());
+                prepare_summary(s, estimated_partitions, _schema->min_index_interval());
 
                 file_input_stream_options options;
                 options.buffer_size = sstable_buffer_size;
                 options.io_priority_class = pc;
-                return do_with(summary_generator(_components->summary),
-                        [this, &pc, options = std::move(options), index_file, index_size] (summary_generator& s) mutable {
+                return do_with(summary_generator(s, _schema->min_index_interval()),
+                        [this, &s, &pc, options = std::move(options), index_file, index_size] (summary_generator& sg) mutable {
                     auto ctx = make_lw_shared<index_consume_entry_context<summary_generator>>(
-                            s, trust_promoted_index::yes, *_schema, index_file, std::move(options), 0, index_size);
+                            sg, trust_promoted_index::yes, use_pi_block_offsets::no, *_schema, index_file, std::move(options), 0, index_size);
                     return ctx->consume_input().finally([ctx] {
                         return ctx->close();
-                    }).then([this, ctx, &s] {
-                        seal_summary(_components->summary, std::move(s.first_key), std::move(s.last_key), s.state());
+                    }).then([this, ctx, &s, &sg] {
+                        seal_summary(s, std::move(sg.first_key), std::move(sg.last_key), sg.state());
                     });
                 });
             }).then([index_file] () mutable {
@@ -2502,6 +2826,78 @@ future<> sstable::generate_summary(const io_priority_class& pc) {
     });
 }
 
+future<> sstable::downsample_summary(int new_sampling_level) {
+    auto& s = _components->summary;
+    int current = s.header.sampling_level;
+    assert(new_sampling_level > 0 && new_sampling_level < current);
+    if (_active_index_readers || s.entries.size() < size_t(current)) {
+        return make_ready_future<>();
+    }
+
+    // Entries at index start_point + k * current (for every round's start
+    // point) are dropped; see downsampling::get_startpoints().
+    std::vector<bool> removed(current, false);
+    for (auto sp : downsampling::get_startpoints(current, new_sampling_level)) {
+        removed[sp] = true;
+    }
+
+    // The memory stream the positions point into starts with the positions
+    // array itself (see seal_summary()), so the number of surviving entries
+    // is needed up front.
+    size_t kept = s.entries.size();
+    for (int sp = 0; sp < current; ++sp) {
+        if (removed[sp] && size_t(sp) < s.entries.size()) {
+            kept -= (s.entries.size() - sp + current - 1) / current;
+        }
+    }
+
+    auto ns = make_lw_shared<summary>();
+    ns->header = s.header;
+    ns->header.sampling_level = new_sampling_level;
+    ns->header.size = kept;
+    ns->header.memory_size = kept * sizeof(uint32_t);
+    ns->first_key = s.first_key;
+    ns->last_key = s.last_key;
+    ns->positions.reserve_partial(kept);
+    ns->entries.reserve_partial(kept);
+
+    auto idx = make_lw_shared<size_t>(0);
+    return repeat([this, &s, ns, idx, removed = std::move(removed), current] {
+        // The summary can have millions of entries, so rebuild it in chunks.
+        auto end = std::min(*idx + 4096, s.entries.size());
+        while (*idx < end) {
+            auto i = (*idx)++;
+            if (!removed[i % current]) {
+                auto& e = s.entries[i];
+                ns->positions.push_back(ns->header.memory_size);
+                ns->header.memory_size += e.key.size() + sizeof(e.position);
+                ns->entries.push_back(e);
+            }
+        }
+        return make_ready_future<stop_iteration>(stop_iteration(*idx == s.entries.size()));
+    }).then([this, ns] {
+        // An index reader opened while we were rebuilding has cached summary
+        // indexes which would be invalidated by the swap; give up in that
+        // (unlikely, since the sstable is cold) case.
+        if (!_active_index_readers) {
+            _components->summary = std::move(*ns);
+            _components->summary.rebuild_token_samples();
+        }
+    });
+}
+
+future<> sstable::upsample_summary(const io_priority_class& pc) {
+    if (_active_index_readers || _components->summary.header.sampling_level == downsampling::BASE_SAMPLING_LEVEL) {
+        return make_ready_future<>();
+    }
+    auto s = make_lw_shared<summary>();
+    return build_summary_from_index(*s, pc).then([this, s] {
+        if (!_active_index_readers) {
+            _components->summary = std::move(*s);
+        }
+    });
+}
+
 uint64_t sstable::data_size() const {
     if (has_component(sstable::component_type::CompressionInfo)) {
         return _components->compression.uncompressed_file_length();
@@ -2549,6 +2945,9 @@ const sstring sstable::filename(sstring dir, sstring ks, sstring cf, version_typ
         },
         { sstable::version_types::la, [] (entry_descriptor d) {
             return _version_string.at(d.version) + "-" + to_sstring(d.generation) + "-" + _format_string.at(d.format) + "-" + _component_map.at(d.component); }
+        },
+        { sstable::version_types::mc, [] (entry_descriptor d) {
+            return _version_string.at(d.version) + "-" + to_sstring(d.generation) + "-" + _format_string.at(d.format) + "-" + _component_map.at(d.component); }
         }
     };
 
@@ -2559,7 +2958,8 @@ const sstring sstable::filename(sstring dir, sstring ks, sstring cf, version_typ
                                 format_types format, sstring component) {
     static std::unordered_map<version_types, const char*, enum_hash<version_types>> fmtmap = {
         { sstable::version_types::ka, "{0}-{1}-{2}-{3}-{5}" },
-        { sstable::version_types::la, "{2}-{3}-{4}-{5}" }
+        { sstable::version_types::la, "{2}-{3}-{4}-{5}" },
+        { sstable::version_types::mc, "{2}-{3}-{4}-{5}" }
     };
 
     return dir + "/" + seastar::format(fmtmap[version], ks, cf, _version_string.at(version), to_sstring(generation), _format_string.at(format), component);
@@ -2625,6 +3025,9 @@ future<> sstable::set_generation(int64_t new_generation) {
 }
 
 entry_descriptor entry_descriptor::make_descriptor(sstring fname) {
+    // mc is deliberately absent here: accepting an mc-named sstable would
+    // send it through the ka/la component parsers. Until a reader for the
+    // mc row layout exists such files must be rejected loudly below.
     static std::regex la("la-(\\d+)-(\\w+)-(.*)");
     static std::regex ka("(\\w+)-(\\w+)-ka-(\\d+)-(.*)");
 
@@ -2679,7 +3082,19 @@ input_stream<char> sstable::data_stream(uint64_t pos, size_t len, const io_prior
     file_input_stream_options options;
     options.buffer_size = sstable_buffer_size;
     options.io_priority_class = pc;
-    options.read_ahead = 4;
+    // Reads spanning many buffers (compaction, full scans, streaming) are
+    // bandwidth-bound, and a shallow read-ahead leaves the disk queue
+    // running dry between successive buffers. Keep a deeper pipeline of
+    // buffer-aligned reads in flight for those; the dynamic adjustments
+    // below trim the depth back where the read-ahead is observed to be
+    // wasted (e.g. a consumer which keeps skipping). Point reads keep the
+    // shallow depth - their latency is dominated by the first buffer
+    // anyway, and the extra requests would only pollute the queue.
+    if (len >= sequential_scan_read_ahead * sstable_buffer_size) {
+        options.read_ahead = sequential_scan_read_ahead;
+    } else {
+        options.read_ahead = 4;
+    }
     options.dynamic_adjustments = std::move(history);
 
     auto f = resource_tracker.track(_data_file);
@@ -2702,6 +3117,100 @@ future<temporary_buffer<char>> sstable::data_read(uint64_t pos, size_t len, cons
     });
 }
 
+future<uint64_t> sstable::validate_data_checksums(uint64_t offset, uint64_t max_bytes, const io_priority_class& pc) {
+    return seastar::async([this, offset, max_bytes, &pc] () mutable {
+        auto file_end = data_size();
+        auto end = std::min(file_end, offset + max_bytes);
+        if (offset >= end) {
+            return file_end;
+        }
+        if (_components->compression) {
+            // The decompressing stream verifies the adler32 trailer of every
+            // compressed chunk it crosses and throws on a mismatch, so just
+            // draining it validates the range.
+            auto stream = data_stream(offset, end - offset, pc, no_resource_tracking(), {});
+            std::exception_ptr ex;
+            try {
+                while (offset < end) {
+                    auto buf = stream.read().get0();
+                    if (buf.empty()) {
+                        break;
+                    }
+                    offset += buf.size();
+                }
+            } catch (...) {
+                ex = std::current_exception();
+            }
+            stream.close().get();
+            if (ex) {
+                std::rethrow_exception(ex);
+            }
+            return offset;
+        }
+        if (!has_component(component_type::CRC)) {
+            // Nothing to verify against; sstable predates checksumming.
+            return file_end;
+        }
+        // The CRC component is a chunk size followed by one big-endian
+        // adler32 value per chunk. It is written by checksummed_file_writer
+        // but never loaded on the read path, so decode the slice covering
+        // this range here.
+        auto crc_file = open_checked_file_dma(_read_error_handler, filename(component_type::CRC), open_flags::ro).get0();
+        file_input_stream_options crc_options;
+        crc_options.buffer_size = 4096;
+        crc_options.io_priority_class = pc;
+        auto header = make_file_input_stream(crc_file, 0, sizeof(uint32_t), crc_options);
+        auto header_buf = header.read_exactly(sizeof(uint32_t)).get0();
+        header.close().get();
+        if (header_buf.size() != sizeof(uint32_t)) {
+            crc_file.close().get();
+            throw malformed_sstable_exception(filename(component_type::CRC) + ": file too short");
+        }
+        uint64_t chunk_size = net::ntoh(*reinterpret_cast<const net::packed<uint32_t>*>(header_buf.get()));
+        if (!chunk_size) {
+            crc_file.close().get();
+            throw malformed_sstable_exception(filename(component_type::CRC) + ": zero chunk size");
+        }
+        auto first_chunk = offset / chunk_size;
+        auto last_chunk = (end + chunk_size - 1) / chunk_size;
+        auto nr_chunks = last_chunk - first_chunk;
+        offset = first_chunk * chunk_size;
+        auto crc_in = make_file_input_stream(crc_file, sizeof(uint32_t) + first_chunk * sizeof(uint32_t), nr_chunks * sizeof(uint32_t), crc_options);
+        auto expected = crc_in.read_exactly(nr_chunks * sizeof(uint32_t)).get0();
+        crc_in.close().get();
+        crc_file.close().get();
+        if (expected.size() != nr_chunks * sizeof(uint32_t)) {
+            throw malformed_sstable_exception(sprint("%s: truncated, expected checksums for %d chunks", filename(component_type::CRC), nr_chunks));
+        }
+        auto data_end = std::min(file_end, last_chunk * chunk_size);
+        auto stream = data_stream(offset, data_end - offset, pc, no_resource_tracking(), {});
+        auto* crcs = reinterpret_cast<const net::packed<uint32_t>*>(expected.get());
+        std::exception_ptr ex;
+        try {
+            for (uint64_t i = 0; i < nr_chunks; ++i) {
+                auto len = std::min(chunk_size, data_end - offset);
+                auto buf = stream.read_exactly(len).get0();
+                if (buf.size() != len) {
+                    throw malformed_sstable_exception(sprint("%s: unexpected end of data at offset %d", get_filename(), offset));
+                }
+                uint32_t actual = checksum_adler32(buf.get(), buf.size());
+                if (actual != net::ntoh(crcs[i])) {
+                    throw malformed_sstable_exception(sprint("%s: checksum mismatch in chunk at offset %d (stored %u, computed %u)",
+                            get_filename(), offset, uint32_t(net::ntoh(crcs[i])), actual));
+                }
+                offset += len;
+            }
+        } catch (...) {
+            ex = std::current_exception();
+        }
+        stream.close().get();
+        if (ex) {
+            std::rethrow_exception(ex);
+        }
+        return offset;
+    });
+}
+
 void sstable::set_first_and_last_keys() {
     if (_first && _last) {
         return;
@@ -2813,6 +3322,7 @@ future<>
 delete_sstables(std::vector<sstring> tocs);
 
 sstable::~sstable() {
+    the_lazy_filter_registry.remove(this);
     if (_index_file) {
         _index_file.close().handle_exception([save = _index_file, op = background_jobs().start()] (auto ep) {
             sstlog.warn("sstable close index_file failed: {}", ep);
@@ -2867,60 +3377,103 @@ fsync_directory(const io_error_handler& error_handler, sstring fname) {
     });
 }
 
-future<>
-remove_by_toc_name(sstring sstable_toc_name, const io_error_handler& error_handler) {
-    return seastar::async([sstable_toc_name, &error_handler] () mutable {
-        sstring prefix = sstable_toc_name.substr(0, sstable_toc_name.size() - TOC_SUFFIX.size());
-        auto new_toc_name = prefix + TEMPORARY_TOC_SUFFIX;
-        sstring dir;
-
-        if (sstable_io_check(error_handler, file_exists, sstable_toc_name).get0()) {
-            dir = dirname(sstable_toc_name);
-            sstable_io_check(error_handler, rename_file, sstable_toc_name, new_toc_name).get();
-            fsync_directory(error_handler, dir).get();
-        } else if (sstable_io_check(error_handler, file_exists, new_toc_name).get0()) {
-            dir = dirname(new_toc_name);
-        } else {
-            sstlog.warn("Unable to delete {} because it doesn't exist.", sstable_toc_name);
-            return;
-        }
+static future<>
+sync_directories(const io_error_handler& error_handler, const std::unordered_set<sstring>& dirs) {
+    return parallel_for_each(dirs, [&error_handler] (const sstring& dir) {
+        return ::sstable_io_check(error_handler, [&error_handler, &dir] {
+            return open_checked_directory(error_handler, dir).then([] (file f) {
+                return do_with(std::move(f), [] (file& f) {
+                    return f.flush().then([&f] {
+                        return f.close();
+                    });
+                });
+            });
+        });
+    });
+}
 
-        auto toc_file = open_checked_file_dma(error_handler, new_toc_name, open_flags::ro).get0();
-        auto in = make_file_input_stream(toc_file);
-        auto size = toc_file.size().get0();
-        auto text = in.read_exactly(size).get0();
-        in.close().get();
-        std::vector<sstring> components;
-        sstring all(text.begin(), text.end());
-        boost::split(components, all, boost::is_any_of("\n"));
-        parallel_for_each(components, [prefix, &error_handler] (sstring component) mutable {
-            if (component.empty()) {
-                // eof
-                return make_ready_future<>();
-            }
-            if (component == TOC_SUFFIX) {
-                // already deleted
-                return make_ready_future<>();
+// Removes a batch of sstables with one directory sync per directory per
+// stage instead of two per sstable, so that deleting thousands of small
+// sstables (e.g. after a large LCS compaction) costs a handful of
+// metadata flushes rather than thousands.
+static future<>
+remove_batch_by_toc_names(std::vector<sstring> sstable_toc_names, const io_error_handler& error_handler) {
+    return seastar::async([sstable_toc_names = std::move(sstable_toc_names), &error_handler] () mutable {
+        struct removal {
+            sstring prefix;
+            sstring new_toc_name;
+        };
+        std::vector<removal> removals;
+        std::unordered_set<sstring> dirs;
+
+        // Stage 1: rename every TOC to a temporary TOC, committing the
+        // deletions with one directory sync per directory.
+        for (auto& sstable_toc_name : sstable_toc_names) {
+            sstring prefix = sstable_toc_name.substr(0, sstable_toc_name.size() - TOC_SUFFIX.size());
+            auto new_toc_name = prefix + TEMPORARY_TOC_SUFFIX;
+
+            if (sstable_io_check(error_handler, file_exists, sstable_toc_name).get0()) {
+                dirs.insert(dirname(sstable_toc_name));
+                sstable_io_check(error_handler, rename_file, sstable_toc_name, new_toc_name).get();
+            } else if (sstable_io_check(error_handler, file_exists, new_toc_name).get0()) {
+                dirs.insert(dirname(new_toc_name));
+            } else {
+                sstlog.warn("Unable to delete {} because it doesn't exist.", sstable_toc_name);
+                continue;
             }
-            auto fname = prefix + component;
-            return sstable_io_check(error_handler, remove_file, prefix + component).then_wrapped([fname = std::move(fname)] (future<> f) {
-                // forgive ENOENT, since the component may not have been written;
-                try {
-                    f.get();
-                } catch (std::system_error& e) {
-                    if (!is_system_error_errno(ENOENT)) {
-                        throw;
+            removals.push_back(removal{std::move(prefix), std::move(new_toc_name)});
+        }
+        sync_directories(error_handler, dirs).get();
+
+        // Stage 2: unlink all components of all sstables, then sync each
+        // directory once before removing the temporary TOCs.
+        parallel_for_each(removals, [&error_handler] (removal& r) {
+            return seastar::async([&r, &error_handler] {
+                auto toc_file = open_checked_file_dma(error_handler, r.new_toc_name, open_flags::ro).get0();
+                auto in = make_file_input_stream(toc_file);
+                auto size = toc_file.size().get0();
+                auto text = in.read_exactly(size).get0();
+                in.close().get();
+                std::vector<sstring> components;
+                sstring all(text.begin(), text.end());
+                boost::split(components, all, boost::is_any_of("\n"));
+                parallel_for_each(components, [&r, &error_handler] (sstring component) mutable {
+                    if (component.empty()) {
+                        // eof
+                        return make_ready_future<>();
                     }
-                    sstlog.debug("Forgiving ENOENT when deleting file {}", fname);
-                }
-                return make_ready_future<>();
+                    if (component == TOC_SUFFIX) {
+                        // already deleted
+                        return make_ready_future<>();
+                    }
+                    auto fname = r.prefix + component;
+                    return sstable_io_check(error_handler, remove_file, r.prefix + component).then_wrapped([fname = std::move(fname)] (future<> f) {
+                        // forgive ENOENT, since the component may not have been written;
+                        try {
+                            f.get();
+                        } catch (std::system_error& e) {
+                            if (!is_system_error_errno(ENOENT)) {
+                                throw;
+                            }
+                            sstlog.debug("Forgiving ENOENT when deleting file {}", fname);
+                        }
+                        return make_ready_future<>();
+                    });
+                }).get();
             });
         }).get();
-        fsync_directory(error_handler, dir).get();
-        sstable_io_check(error_handler, remove_file, new_toc_name).get();
+        sync_directories(error_handler, dirs).get();
+        parallel_for_each(removals, [&error_handler] (removal& r) {
+            return sstable_io_check(error_handler, remove_file, r.new_toc_name);
+        }).get();
     });
 }
 
+future<>
+remove_by_toc_name(sstring sstable_toc_name, const io_error_handler& error_handler) {
+    return remove_batch_by_toc_names({std::move(sstable_toc_name)}, error_handler);
+}
+
 future<>
 sstable::remove_sstable_with_temp_toc(sstring ks, sstring cf, sstring dir, int64_t generation, version_types v, format_types f) {
     return seastar::async([ks, cf, dir, generation, v, f] {
@@ -2982,7 +3535,7 @@ stdx::optional<std::pair<uint64_t, uint64_t>> sstable::get_sample_indexes_for_ra
         auto kind = before ? key::kind::before_all_keys : key::kind::after_all_keys;
         key k(kind);
         // Binary search will never returns positive values.
-        return uint64_t((binary_search(_components->summary.entries, k, token) + 1) * -1);
+        return uint64_t((summary_binary_search(_components->summary, k, token) + 1) * -1);
     };
     uint64_t left = 0;
     if (range.start()) {
@@ -3062,12 +3615,52 @@ utils::hashed_key sstable::make_hashed_key(const schema& s, const partition_key&
     return utils::make_hashed_key(static_cast<bytes_view>(key::from_partition_key(s, key)));
 }
 
+// Per-shard queue of obsolete sstables awaiting deletion. A single
+// background fiber drains it, unlinking everything queued so far as one
+// batch; sstables queued while a batch is in flight share the next
+// batch's directory syncs. This decouples compaction completion from
+// filesystem metadata cost.
+struct deletion_queue {
+    std::vector<sstring> tocs;
+    stdx::optional<shared_promise<>> batch_done;
+    bool draining = false;
+};
+static thread_local deletion_queue the_deletion_queue;
+
+static future<> drain_deletion_queue() {
+    return repeat([] {
+        auto& q = the_deletion_queue;
+        if (q.tocs.empty()) {
+            q.draining = false;
+            return make_ready_future<stop_iteration>(stop_iteration::yes);
+        }
+        auto batch = std::exchange(q.tocs, {});
+        auto done = std::move(*std::exchange(q.batch_done, stdx::nullopt));
+        return remove_batch_by_toc_names(std::move(batch), sstable_write_error_handler).then_wrapped([done = std::move(done)] (future<> f) mutable {
+            if (f.failed()) {
+                done.set_exception(f.get_exception());
+            } else {
+                done.set_value();
+            }
+            return stop_iteration::no;
+        });
+    });
+}
+
 future<>
 delete_sstables(std::vector<sstring> tocs) {
     // FIXME: this needs to be done atomically (using a log file of sstables we intend to delete)
-    return parallel_for_each(tocs, [] (sstring name) {
-        return remove_by_toc_name(name);
-    });
+    auto& q = the_deletion_queue;
+    boost::range::insert(q.tocs, q.tocs.end(), tocs);
+    if (!q.batch_done) {
+        q.batch_done.emplace();
+    }
+    auto ret = q.batch_done->get_shared_future();
+    if (!q.draining) {
+        q.draining = true;
+        drain_deletion_queue().finally([op = background_jobs().start()] {});
+    }
+    return ret;
 }
 
 future<>
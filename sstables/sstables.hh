@@ -47,6 +47,7 @@
 #include "writer.hh"
 #include "metadata_collector.hh"
 #include "filter.hh"
+#include "disk_device_tracker.hh"
 #include "exceptions.hh"
 #include "mutation_reader.hh"
 #include "query-request.hh"
@@ -56,6 +57,7 @@
 #include "db/commitlog/replay_position.hh"
 #include "flat_mutation_reader.hh"
 #include "utils/phased_barrier.hh"
+#include "core/lowres_clock.hh"
 
 #include <seastar/util/optimized_optional.hh>
 
@@ -166,6 +168,7 @@ public:
         , _now(now)
         , _read_error_handler(error_handler_gen(sstable_read_error))
         , _write_error_handler(error_handler_gen(sstable_write_error))
+        , _device(disk_device_tracker::local().register_directory(_dir))
     { }
     sstable& operator=(const sstable&) = delete;
     sstable(const sstable&) = delete;
@@ -394,7 +397,10 @@ public:
     }
 
     uint64_t filter_memory_size() const {
-        return _components->filter->memory_size();
+        if (_components->filter) {
+            return _components->filter->memory_size();
+        }
+        return _lazy_filter ? _lazy_filter->memory_size() : 0;
     }
 
     // Returns the total bytes of all components.
@@ -459,6 +465,9 @@ public:
     };
 private:
     size_t sstable_buffer_size = default_buffer_size;
+    // Read-ahead depth (in buffers) for data streams which span at least
+    // that many buffers, i.e. long sequential scans. See data_stream().
+    static constexpr unsigned sequential_scan_read_ahead = 8;
 
     static std::unordered_map<version_types, sstring, enum_hash<version_types>> _version_string;
     static std::unordered_map<format_types, sstring, enum_hash<format_types>> _format_string;
@@ -507,6 +516,10 @@ private:
         std::experimental::optional<range_tombstone_accumulator> tombstone_accumulator;
         const schema* schemap;
         size_t desired_block_size;
+        // Offset of every block within .data, appended after the blocks as
+        // the table which makes them binary-searchable
+        // (sstable_feature::PromotedIndexBlockOffsets).
+        utils::chunked_vector<uint32_t> block_offsets;
     } _pi_write;
 
     void maybe_flush_pi_block(file_writer& out,
@@ -526,6 +539,30 @@ private:
 
     filter_tracker _filter_tracker;
 
+    // Lazily loaded bloom filter, used when sstable_filter_idle_timeout_in_s
+    // is set. _components->filter is then left unset at load time (it is
+    // shared across shards and must stay immutable), and each shard loads its
+    // own copy on first use and drops it again after the configured idle time.
+    // While the filter is absent every key is assumed to be possibly present.
+    utils::filter_ptr _lazy_filter;
+    bool _lazy_filter_loading = false;
+    lowres_clock::time_point _lazy_filter_used;
+
+    // Returns the filter to consult, or nullptr if none is loaded, in which
+    // case the caller must assume the key may be present. Touches the idle
+    // timestamp and kicks off a background load if lazy loading is enabled.
+    utils::i_filter* maybe_filter();
+    void load_filter_in_background();
+
+    // Number of index_reader instances currently open on this sstable. Index
+    // readers cache summary indexes across continuations, so the in-memory
+    // summary must not be resampled while any of them is alive.
+    unsigned _active_index_readers = 0;
+
+    // Reads observed by the summary resampler on its previous visit; see
+    // reads_since_last_resample_check().
+    uint64_t _resampler_read_mark = 0;
+
     bool _marked_for_deletion = false;
 
     gc_clock::time_point _now;
@@ -533,6 +570,10 @@ private:
     io_error_handler _read_error_handler;
     io_error_handler _write_error_handler;
 
+    // Device _dir lives on; component file I/O and errors are accounted
+    // to it (see disk_device_tracker).
+    disk_device_tracker::device_id _device;
+
     const bool has_component(component_type f) const;
 
     const sstring filename(component_type f) const;
@@ -568,6 +609,9 @@ private:
     // happen if old tools are being used.
     future<> generate_summary(const io_priority_class& pc);
 
+    // Builds a full-sampling summary into s by scanning Index.db.
+    future<> build_summary_from_index(summary& s, const io_priority_class& pc);
+
     future<> read_statistics(const io_priority_class& pc);
     void write_statistics(const io_priority_class& pc);
     // Rewrite statistics component by creating a temporary Statistics and
@@ -612,6 +656,19 @@ private:
     // for iteration through all the rows.
     future<temporary_buffer<char>> data_read(uint64_t pos, size_t len, const io_priority_class& pc);
 
+    // Verify the data file's per-chunk checksums over a bounded byte range
+    // starting at offset (which is rounded down to a chunk boundary), so a
+    // large sstable can be validated incrementally: the returned value is
+    // the offset verification reached, to be passed back in as the next
+    // starting point. Returns data_size() once the whole file has been
+    // verified, which is also the immediate result for sstables with
+    // nothing to verify against (no compression and no CRC component).
+    // Compressed sstables are checked through the decompressing stream,
+    // which verifies the adler32 trailer of every compressed chunk it
+    // crosses; uncompressed ones are checked against the CRC component.
+    // Throws malformed_sstable_exception on a checksum mismatch.
+    future<uint64_t> validate_data_checksums(uint64_t offset, uint64_t max_bytes, const io_priority_class& pc);
+
     future<summary_entry&> read_summary_entry(size_t i);
 
     // FIXME: pending on Bloom filter implementation
@@ -659,6 +716,10 @@ public:
         return _schema->is_compound() || !has_scylla_component() || _components->scylla_metadata->has_feature(sstable_feature::NonCompoundPIEntries);
     }
 
+    bool has_promoted_index_block_offsets() const {
+        return has_scylla_component() && _components->scylla_metadata->has_feature(sstable_feature::PromotedIndexBlockOffsets);
+    }
+
     bool has_correct_non_compound_range_tombstones() const {
         return _schema->is_compound() || !has_scylla_component() || _components->scylla_metadata->has_feature(sstable_feature::NonCompoundRangeTombstones);
     }
@@ -668,13 +729,20 @@ public:
     }
 
     bool filter_has_key(const key& key) {
-        return _components->filter->is_present(bytes_view(key));
+        auto* f = maybe_filter();
+        return !f || f->is_present(bytes_view(key));
     }
 
     bool filter_has_key(utils::hashed_key key) {
-        return _components->filter->is_present(key);
+        auto* f = maybe_filter();
+        return !f || f->is_present(key);
     }
 
+    // Drops the lazily loaded filter if it was last consulted before
+    // used_before. Called by the idle filter reaper; returns true if no
+    // filter remains loaded, so the caller can stop watching this sstable.
+    bool maybe_unload_filter(lowres_clock::time_point used_before);
+
     bool filter_has_key(const schema& s, partition_key_view key) {
         return filter_has_key(key::from_partition_key(s, key));
     }
@@ -683,6 +751,34 @@ public:
 
     filter_tracker& get_filter_tracker() { return _filter_tracker; }
 
+    void mark_index_reader() { ++_active_index_readers; }
+    void unmark_index_reader() { --_active_index_readers; }
+    bool has_active_index_readers() const { return _active_index_readers; }
+
+    int sampling_level() const { return _components->summary.header.sampling_level; }
+
+    size_t summary_memory_footprint() const { return _components->summary.memory_footprint(); }
+
+    // Replaces the in-memory summary with one downsampled to the given
+    // sampling level, trading a bounded amount of extra index reads for
+    // memory. Summary.db is left untouched, so a restart restores full
+    // sampling. The summary is only swapped if no index reader was opened
+    // meanwhile.
+    future<> downsample_summary(int new_sampling_level);
+
+    // Restores the summary to full sampling by rebuilding it from Index.db.
+    future<> upsample_summary(const io_priority_class& pc);
+
+    // Number of reads which consulted this sstable since the previous call.
+    // Counts bloom filter checks, so purely range-scanned sstables are not
+    // accounted; used by the summary resampler as a cheap hotness signal.
+    uint64_t reads_since_last_resample_check() {
+        auto reads = _filter_tracker.true_positive + _filter_tracker.false_positive;
+        auto t = reads - _resampler_read_mark;
+        _resampler_read_mark = reads;
+        return t;
+    }
+
     uint64_t filter_get_false_positive() {
         return _filter_tracker.false_positive;
     }
@@ -817,14 +913,27 @@ future<> delete_atomically(std::vector<shared_sstable> ssts);
 
 struct index_sampling_state {
     static constexpr size_t default_summary_byte_cost = 2000;
+    // Entries added by the partition interval trigger (rather than the byte
+    // cost) may grow the summary to at most this multiple of the configured
+    // summary-to-data ratio.
+    static constexpr size_t interval_trigger_budget_multiplier = 4;
 
     uint64_t next_data_offset_to_write_summary = 0;
     uint64_t partition_count = 0;
     // Enforces ratio of summary to data of 1 to N.
     size_t summary_byte_cost = default_summary_byte_cost;
+    // Tables of many small partitions reach the byte cost only every few
+    // hundred partitions, which makes every index read scan that many index
+    // entries. Sample at least every min_index_interval partitions too, as
+    // long as the summary stays within the budget above.
+    uint64_t partitions_since_summary_entry = 0;
+    size_t min_index_interval = 128;
+    uint64_t summary_memory = 0;
 };
 
 class components_writer {
+    struct summary_and_filter_builder;
+
     sstable& _sst;
     const schema& _schema;
     file_writer& _out;
@@ -835,10 +944,11 @@ class components_writer {
     // Remember first and last keys, which we need for the summary file.
     stdx::optional<key> _first_key, _last_key;
     stdx::optional<key> _partition_key;
-    index_sampling_state _index_sampling_state;
+    // Builds the summary and bloom filter in a background fiber fed through a
+    // bounded queue, off the data and index write path.
+    std::unique_ptr<summary_and_filter_builder> _builder;
     range_tombstone_stream _range_tombstones;
 private:
-    void maybe_add_summary_entry(const dht::token& token, bytes_view key);
     uint64_t get_offset() const;
     file_writer index_file_writer(sstable& sst, const io_priority_class& pc);
     // Emits all tombstones which start before pos.
@@ -856,7 +966,7 @@ public:
     components_writer(components_writer&& o) : _sst(o._sst), _schema(o._schema), _out(o._out), _index(std::move(o._index)),
             _index_needs_close(o._index_needs_close), _max_sstable_size(o._max_sstable_size), _tombstone_written(o._tombstone_written),
             _first_key(std::move(o._first_key)), _last_key(std::move(o._last_key)), _partition_key(std::move(o._partition_key)),
-            _index_sampling_state(std::move(o._index_sampling_state)), _range_tombstones(std::move(o._range_tombstones)) {
+            _builder(std::move(o._builder)), _range_tombstones(std::move(o._range_tombstones)) {
         o._index_needs_close = false;
     }
 
@@ -143,14 +143,18 @@ public:
         }
 
         if (!expired.empty()) {
-            auto is_expired = [&] (const shared_sstable& s) { return expired.find(s) != expired.end(); };
-            candidates.erase(boost::remove_if(candidates, is_expired), candidates.end());
+            // A descriptor of fully-expired sstables only is a pure unlink:
+            // compaction skips fully-expired inputs entirely, and
+            // get_fully_expired_sstables() has already verified that no
+            // overlapping sstable holds live data older than what they
+            // shadow. Returning it on its own, ahead of any window merge,
+            // reclaims the space of a retired window immediately instead of
+            // tying the unlink to the end of a bucket rewrite.
+            clogger.debug("Going to drop {} fully expired sstables", expired.size());
+            return compaction_descriptor(std::vector<shared_sstable>(expired.begin(), expired.end()));
         }
 
         auto compaction_candidates = get_next_non_expired_sstables(cf, std::move(candidates), gc_before);
-        if (!expired.empty()) {
-            compaction_candidates.insert(compaction_candidates.end(), expired.begin(), expired.end());
-        }
         return compaction_descriptor(std::move(compaction_candidates));
     }
 private:
@@ -179,6 +179,23 @@ struct summary_ka {
     disk_string<uint32_t> first_key;
     disk_string<uint32_t> last_key;
 
+    // First level of the summary search: the token of every
+    // token_sample_interval-th entry, kept contiguous so the initial
+    // narrowing of a binary search stays cache-resident instead of
+    // probing scattered entries. Derived from entries, not part of the
+    // on-disk format; rebuild_token_samples() must run whenever the
+    // entries change.
+    static constexpr size_t token_sample_interval = 64;
+    std::vector<dht::token> token_samples;
+
+    void rebuild_token_samples() {
+        token_samples.clear();
+        token_samples.reserve(entries.size() / token_sample_interval + 1);
+        for (size_t i = 0; i < entries.size(); i += token_sample_interval) {
+            token_samples.push_back(entries[i].token);
+        }
+    }
+
     // NOTE4: There is a structure written by Cassandra into the end of the Summary
     // file, after the field last_key, that we haven't understand yet, but we know
     // that its content isn't related to the summary itself.
@@ -196,6 +213,7 @@ struct summary_ka {
     uint64_t memory_footprint() const {
         auto sz = sizeof(summary_entry) * entries.size() + sizeof(uint32_t) * positions.size() + sizeof(*this);
         sz += first_key.value.size() + last_key.value.size();
+        sz += token_samples.size() * sizeof(dht::token);
         for (auto& e : entries) {
             sz += e.key.size();
         }
@@ -318,7 +336,12 @@ struct sharding_metadata {
 enum sstable_feature : uint8_t {
     NonCompoundPIEntries = 0,       // See #2993
     NonCompoundRangeTombstones = 1, // See #2986
-    End = 2
+    // The promoted index blocks of every index entry are followed by a
+    // fixed-stride table of their offsets, making them binary-searchable on
+    // disk. Readers bound their parse by the block count, so the table is
+    // invisible to versions which do not know about it.
+    PromotedIndexBlockOffsets = 2,
+    End = 3
 };
 
 // Scylla-specific features enabled for a particular sstable.
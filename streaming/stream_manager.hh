@@ -46,6 +46,7 @@
 #include "gms/endpoint_state.hh"
 #include "gms/application_state.hh"
 #include <seastar/core/semaphore.hh>
+#include <seastar/core/memory.hh>
 #include <seastar/core/metrics_registration.hh>
 #include <map>
 
@@ -94,12 +95,18 @@ private:
     std::unordered_map<UUID, shared_ptr<stream_result_future>> _initiated_streams;
     std::unordered_map<UUID, shared_ptr<stream_result_future>> _receiving_streams;
     std::unordered_map<UUID, std::unordered_map<gms::inet_address, stream_bytes>> _stream_bytes;
-    semaphore _mutation_send_limiter{256};
+    semaphore _mutation_send_limiter{max_mutation_send_memory()};
     seastar::metrics::metric_groups _metrics;
 
 public:
     stream_manager();
 
+    // Budget for serialized mutations in flight to all peers. The send
+    // window is admitted in bytes rather than message count, so many small
+    // mutations can be pipelined deeply enough to fill high-RTT links while
+    // a few large fragments cannot pin an unbounded amount of memory.
+    static size_t max_mutation_send_memory() { return memory::stats().total_memory() * 0.01; }
+
     semaphore& mutation_send_limiter() { return _mutation_send_limiter; }
 
     void register_sending(shared_ptr<stream_result_future> result);
@@ -95,6 +95,21 @@ void stream_result_future::handle_session_prepared(shared_ptr<stream_session> se
 
 void stream_result_future::handle_session_complete(shared_ptr<stream_session> session) {
     sslog.debug("[Stream #{}] Session with {} is complete, state={}", session->plan_id(), session->peer, session->get_state());
+    auto session_plan_id = session->plan_id();
+    auto peer = session->peer;
+    auto duration = std::chrono::duration_cast<std::chrono::duration<float>>(lowres_clock::now() - _start_time).count();
+    get_local_stream_manager().get_progress_on_all_shards(session_plan_id, peer).then([session_plan_id, peer, duration] (auto sbytes) {
+        auto tx_bw = sstring("0");
+        auto rx_bw = sstring("0");
+        if (std::fabs(duration) > FLT_EPSILON) {
+            tx_bw = sprint("%.2f", sbytes.bytes_sent / duration / 1024);
+            rx_bw = sprint("%.2f", sbytes.bytes_received / duration / 1024);
+        }
+        sslog.info("[Stream #{}] Session with {} is complete: tx={} KiB, {} KiB/s, rx={} KiB, {} KiB/s",
+                session_plan_id, peer, sbytes.bytes_sent / 1024, tx_bw, sbytes.bytes_received / 1024, rx_bw);
+    }).handle_exception([session_plan_id, peer] (auto ep) {
+        sslog.warn("[Stream #{}] Fail to get progress for peer {}: {}", session_plan_id, peer, ep);
+    });
     auto event = session_complete_event(session);
     fire_stream_event(std::move(event));
     auto si = session->make_session_info();
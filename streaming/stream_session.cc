@@ -56,6 +56,9 @@
 #include "streaming/stream_exception.hh"
 #include "service/storage_proxy.hh"
 #include "service/priority_manager.hh"
+#include "sstables/sstables.hh"
+#include "core/fstream.hh"
+#include "core/align.hh"
 #include "query-request.hh"
 #include "schema_registry.hh"
 
@@ -176,6 +179,59 @@ void stream_session::init_messaging_service_handler() {
             });
         });
     });
+    ms().register_stream_sstable([] (const rpc::client_info& cinfo, UUID plan_id, sstring ks_name, sstring cf_name, sstring component, uint64_t offset, bytes data, bool last_chunk) {
+        auto from = netw::messaging_service::get_source(cinfo);
+        sslog.debug("[Stream #{}] GOT STREAM_SSTABLE from {}: {}.{} component={} offset={} size={} last_chunk={}",
+                plan_id, from.addr, ks_name, cf_name, component, offset, data.size(), last_chunk);
+        auto& db = service::get_local_storage_proxy().get_db().local();
+        if (!db.has_schema(ks_name, cf_name)) {
+            sslog.warn("[Stream #{}] STREAM_SSTABLE from {}: {}.{} is missing, assume the table is dropped",
+                    plan_id, from.addr, ks_name, cf_name);
+            return make_ready_future<>();
+        }
+        auto& cf = db.find_column_family(ks_name, cf_name);
+        auto dir = cf.dir() + "/upload";
+        auto path = dir + "/" + component;
+        get_local_stream_manager().update_progress(plan_id, from.addr, progress_info::direction::IN, data.size());
+        return touch_directory(dir).then([path, offset, data = std::move(data), last_chunk] () mutable {
+            return open_file_dma(path, open_flags::wo | open_flags::create).then([offset, data = std::move(data), last_chunk] (file f) mutable {
+                return do_with(std::move(f), std::move(data), [offset, last_chunk] (file& f, bytes& data) {
+                    auto write = make_ready_future<>();
+                    if (!data.empty()) {
+                        // Chunks other than the final one arrive at offsets and
+                        // sizes which are multiples of the chunk size, so only
+                        // the write size needs padding to the dma alignment; the
+                        // file is truncated to its real size on the last chunk.
+                        auto len = align_up<size_t>(data.size(), f.disk_write_dma_alignment());
+                        auto buf = temporary_buffer<char>::aligned(f.memory_dma_alignment(), len);
+                        std::copy_n(reinterpret_cast<const char*>(data.data()), data.size(), buf.get_write());
+                        std::fill(buf.get_write() + data.size(), buf.get_write() + len, 0);
+                        write = f.dma_write(offset, buf.get(), len).then([buf = std::move(buf)] (size_t) {});
+                    }
+                    return write.then([&f, &data, offset, last_chunk] {
+                        if (last_chunk) {
+                            return f.truncate(offset + data.size()).then([&f] {
+                                return f.flush();
+                            });
+                        }
+                        return make_ready_future<>();
+                    }).finally([&f] {
+                        return f.close();
+                    });
+                });
+            });
+        }).then([plan_id, ks_name, cf_name, component, last_chunk] {
+            // The TOC is sent last, so its completion means the whole sstable
+            // has arrived and can be picked up from the upload directory.
+            if (last_chunk && component.find("TOC") != sstring::npos) {
+                return distributed_loader::flush_upload_dir(stream_session::get_db(), ks_name, cf_name).then(
+                        [plan_id] (std::vector<sstables::entry_descriptor>) {
+                    sslog.debug("[Stream #{}] STREAM_SSTABLE: loaded sstable from upload dir", plan_id);
+                });
+            }
+            return make_ready_future<>();
+        });
+    });
     ms().register_complete_message([] (const rpc::client_info& cinfo, UUID plan_id, unsigned dst_cpu_id, rpc::optional<bool> failed) {
         const auto& from = cinfo.retrieve_auxiliary<gms::inet_address>("baddr");
         if (failed && *failed) {
@@ -579,6 +635,59 @@ sstring stream_session::description() {
     return _stream_result  ? _stream_result->description : "";
 }
 
+// Chunk size for STREAM_SSTABLE transfers. Must be a multiple of the write
+// dma alignment on the receiving side; all chunks but the last are exactly
+// this size, so receiver-side writes stay aligned.
+static constexpr size_t sstable_stream_chunk_size = 128 * 1024;
+
+static future<> stream_one_sstable_file(netw::messaging_service::msg_addr id, utils::UUID plan_id,
+        sstring ks_name, sstring cf_name, sstring path) {
+    auto component = path.substr(path.find_last_of('/') + 1);
+    return open_file_dma(path, open_flags::ro).then([id, plan_id, ks_name, cf_name, component] (file f) {
+        file_input_stream_options options;
+        options.buffer_size = sstable_stream_chunk_size;
+        auto in = make_file_input_stream(std::move(f), std::move(options));
+        return do_with(std::move(in), uint64_t(0), [id, plan_id, ks_name, cf_name, component] (input_stream<char>& in, uint64_t& offset) {
+            return repeat([&in, &offset, id, plan_id, ks_name, cf_name, component] {
+                return in.read_exactly(sstable_stream_chunk_size).then([&offset, id, plan_id, ks_name, cf_name, component] (temporary_buffer<char> buf) {
+                    // read_exactly() returns a short buffer only at end of file.
+                    bool last_chunk = buf.size() < sstable_stream_chunk_size;
+                    auto size = buf.size();
+                    bytes data(reinterpret_cast<const int8_t*>(buf.get()), size);
+                    sslog.debug("[Stream #{}] SEND STREAM_SSTABLE to {}, {}.{} component={} offset={} size={} last_chunk={}",
+                            plan_id, id, ks_name, cf_name, component, offset, size, last_chunk);
+                    return netw::get_local_messaging_service().send_stream_sstable(id, plan_id, ks_name, cf_name,
+                            component, offset, std::move(data), last_chunk).then([&offset, id, plan_id, size, last_chunk] {
+                        get_local_stream_manager().update_progress(plan_id, id.addr, progress_info::direction::OUT, size);
+                        offset += size;
+                        return last_chunk ? stop_iteration::yes : stop_iteration::no;
+                    });
+                });
+            }).finally([&in] {
+                return in.close();
+            });
+        });
+    });
+}
+
+future<> stream_session::transfer_sstable_files(sstring ks_name, sstring cf_name, std::vector<sstables::shared_sstable> sstables) {
+    auto id = msg_addr{peer, dst_cpu_id};
+    auto plan = plan_id();
+    return do_for_each(sstables, [id, plan, ks_name, cf_name] (sstables::shared_sstable& sst) {
+        auto files = sst->component_filenames();
+        // The receiver treats the TOC as the end-of-sstable marker, so it
+        // must go out after everything else.
+        std::stable_partition(files.begin(), files.end(), [toc = sst->toc_filename()] (const sstring& f) {
+            return f != toc;
+        });
+        return do_with(std::move(files), [id, plan, ks_name, cf_name] (std::vector<sstring>& files) {
+            return do_for_each(files, [id, plan, ks_name, cf_name] (sstring& path) {
+                return stream_one_sstable_file(id, plan, ks_name, cf_name, path);
+            });
+        });
+    });
+}
+
 future<> stream_session::update_progress() {
     return get_local_stream_manager().get_progress_on_all_shards(plan_id(), peer).then([this] (auto sbytes) {
         auto bytes_sent = sbytes.bytes_sent;
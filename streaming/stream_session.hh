@@ -53,6 +53,7 @@
 #include "streaming/session_info.hh"
 #include "query-request.hh"
 #include "dht/i_partitioner.hh"
+#include "sstables/shared_sstable.hh"
 #include <map>
 #include <vector>
 #include <memory>
@@ -220,6 +221,14 @@ public:
 
     sstring description();
 
+    // Ships the given sstables to the peer as raw component files over the
+    // STREAM_SSTABLE verb, bypassing mutation-level serialization entirely.
+    // The receiver assembles the components in the table's upload directory
+    // and loads them when each sstable's TOC arrives (it is sent last).
+    // Only suitable for sstables fully covered by the transferred ranges;
+    // callers must fall back to mutation streaming otherwise.
+    future<> transfer_sstable_files(sstring ks_name, sstring cf_name, std::vector<sstables::shared_sstable> sstables);
+
 public:
     /**
      * Bind this session to report to specific {@link StreamResultFuture} and
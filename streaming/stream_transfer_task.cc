@@ -93,9 +93,12 @@ struct send_info {
 };
 
 future<stop_iteration> do_send_mutations(lw_shared_ptr<send_info> si, frozen_mutation fm, bool fragmented) {
-    return get_local_stream_manager().mutation_send_limiter().wait().then([si, fragmented, fm = std::move(fm)] () mutable {
+    auto fm_size = fm.representation().size();
+    // A mutation that could not be fragmented may be larger than the whole
+    // send window; cap its charge so it can still be admitted, alone.
+    auto memory_units = std::min(fm_size, stream_manager::max_mutation_send_memory());
+    return get_local_stream_manager().mutation_send_limiter().wait(memory_units).then([si, fragmented, fm_size, memory_units, fm = std::move(fm)] () mutable {
         sslog.debug("[Stream #{}] SEND STREAM_MUTATION to {}, cf_id={}", si->plan_id, si->id, si->cf_id);
-        auto fm_size = fm.representation().size();
         netw::get_local_messaging_service().send_stream_mutation(si->id, si->plan_id, std::move(fm), si->dst_cpu_id, fragmented).then([si, fm_size] {
             sslog.debug("[Stream #{}] GOT STREAM_MUTATION Reply from {}", si->plan_id, si->id.addr);
             get_local_stream_manager().update_progress(si->plan_id, si->id.addr, progress_info::direction::OUT, fm_size);
@@ -108,8 +111,8 @@ future<stop_iteration> do_send_mutations(lw_shared_ptr<send_info> si, frozen_mut
                 sslog.warn("[Stream #{}] stream_transfer_task: Fail to send STREAM_MUTATION to {}: {}", si->plan_id, si->id, ep);
             }
             si->mutations_done.broken();
-        }).finally([] {
-            get_local_stream_manager().mutation_send_limiter().signal();
+        }).finally([memory_units] {
+            get_local_stream_manager().mutation_send_limiter().signal(memory_units);
         });
         return stop_iteration::no;
     });
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE core
+
+#include "utils/bloom_filter.hh"
+#include "utils/i_filter.hh"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace utils;
+
+static bytes make_key(uint64_t n) {
+    bytes b(bytes::initialized_later(), sizeof(n));
+    std::copy_n(reinterpret_cast<const int8_t*>(&n), sizeof(n), b.begin());
+    return b;
+}
+
+static void check_add_and_lookup(filter_format format) {
+    auto f = i_filter::get_filter(1000, 0.01, format);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        auto key = make_key(i);
+        f->add(key);
+    }
+    for (uint64_t i = 0; i < 1000; ++i) {
+        auto key = make_key(i);
+        BOOST_REQUIRE(f->is_present(bytes_view(key)));
+        BOOST_REQUIRE(f->is_present(make_hashed_key(key)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_partitioned_add_and_lookup) {
+    check_add_and_lookup(filter_format::partitioned);
+}
+
+BOOST_AUTO_TEST_CASE(test_blocked_add_and_lookup) {
+    check_add_and_lookup(filter_format::blocked);
+}
+
+BOOST_AUTO_TEST_CASE(test_blocked_probes_stay_in_one_block) {
+    constexpr auto block_bits = filter::blocked_bloom_filter::block_bits;
+    auto ptr = filter::create_blocked_filter(8, 100, 10);
+    auto& f = static_cast<filter::blocked_bloom_filter&>(*ptr);
+    BOOST_REQUIRE_EQUAL(f.bits().size() % block_bits, 0);
+    for (uint64_t i = 0; i < 100; ++i) {
+        f.clear();
+        auto key = make_key(i);
+        f.add(key);
+        // All bits set by one key must fall into a single 512-bit block.
+        int64_t first_block = -1;
+        for (size_t bit = 0; bit < f.bits().size(); ++bit) {
+            if (f.bits().test(bit)) {
+                auto block = int64_t(bit / block_bits);
+                if (first_block == -1) {
+                    first_block = block;
+                }
+                BOOST_REQUIRE_EQUAL(block, first_block);
+            }
+        }
+        BOOST_REQUIRE(first_block != -1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_blocked_false_positive_rate) {
+    constexpr uint64_t n = 10000;
+    constexpr double target = 0.01;
+    auto f = i_filter::get_filter(n, target, filter_format::blocked);
+    for (uint64_t i = 0; i < n; ++i) {
+        auto key = make_key(i);
+        f->add(key);
+    }
+    uint64_t false_positives = 0;
+    constexpr uint64_t probes = 100000;
+    for (uint64_t i = n; i < n + probes; ++i) {
+        auto key = make_key(i);
+        if (f->is_present(bytes_view(key))) {
+            false_positives++;
+        }
+    }
+    auto rate = double(false_positives) / probes;
+    // Confining all probes of a key to one block inflates the false
+    // positive rate somewhat over the classic layout; it must still stay
+    // in the neighbourhood of the configured target.
+    BOOST_CHECK_MESSAGE(rate < 3 * target, "observed false positive rate " << rate);
+}
@@ -21,6 +21,9 @@
 
 #define BOOST_TEST_MODULE core
 
+#include <limits>
+#include <vector>
+
 #include "bytes_ostream.hh"
 #include <boost/test/unit_test.hpp>
 #include "serializer_impl.hh"
@@ -275,3 +278,32 @@ BOOST_AUTO_TEST_CASE(test_append_big_and_small_chunks) {
     buf.append(big);
     buf.append(small);
 }
+
+BOOST_AUTO_TEST_CASE(test_writing_vints_in_place) {
+    auto values = std::vector<uint64_t>{0, 1, 127, 128, 0xdead, 0xdeadbeef,
+                                        std::numeric_limits<uint64_t>::max()};
+
+    bytes_ostream buf;
+    for (auto v : values) {
+        buf.write_unsigned_vint(v);
+        buf.write_signed_vint(-int64_t(v & 0x7fffffffffffffff));
+    }
+    buf.write_unsigned_vints({0, 1, 127, 128, 0xdead, 0xdeadbeef,
+                              std::numeric_limits<uint64_t>::max()});
+
+    auto in = buf.linearize();
+    for (auto v : values) {
+        auto u = unsigned_vint::deserialize(in);
+        BOOST_REQUIRE_EQUAL(u.value, v);
+        in.remove_prefix(u.size);
+        auto s = signed_vint::deserialize(in);
+        BOOST_REQUIRE_EQUAL(s.value, -int64_t(v & 0x7fffffffffffffff));
+        in.remove_prefix(s.size);
+    }
+    for (auto v : values) {
+        auto u = unsigned_vint::deserialize(in);
+        BOOST_REQUIRE_EQUAL(u.value, v);
+        in.remove_prefix(u.size);
+    }
+    BOOST_REQUIRE(in.empty());
+}
@@ -119,6 +119,46 @@ BOOST_AUTO_TEST_CASE(test_random_walk) {
     }
 }
 
+// Counts moves so we can verify that reserve_partial() prevents element
+// migration during growth: with the first chunk fully sized up front, the
+// only moves observed are the ones performed by push_back() itself.
+class move_counting_class {
+    static uint64_t _moves;
+    uint64_t _value;
+public:
+    explicit move_counting_class(uint64_t value = 0) : _value(value) {}
+    move_counting_class(move_counting_class&& x) noexcept : _value(x._value) {
+        ++_moves;
+    }
+    move_counting_class(const move_counting_class&) = default;
+    move_counting_class& operator=(move_counting_class&&) = default;
+    move_counting_class& operator=(const move_counting_class&) = default;
+    uint64_t value() const { return _value; }
+    static uint64_t moves() { return _moves; }
+    static void reset_moves() { _moves = 0; }
+};
+
+uint64_t move_counting_class::_moves = 0;
+
+BOOST_AUTO_TEST_CASE(tests_reserve_partial) {
+    auto rand = std::default_random_engine();
+    auto size_dist = std::uniform_int_distribution<size_t>(1, 1 << 14);
+    for (auto i = 0; i != 100; ++i) {
+        auto size = size_dist(rand);
+        utils::chunked_vector<move_counting_class, 512> v;
+        v.reserve_partial(size);
+        move_counting_class::reset_moves();
+        for (size_t j = 0; j != size; ++j) {
+            v.push_back(move_counting_class(j));
+        }
+        BOOST_REQUIRE_EQUAL(v.size(), size);
+        BOOST_REQUIRE_EQUAL(move_counting_class::moves(), size);
+        for (size_t j = 0; j != size; ++j) {
+            BOOST_REQUIRE_EQUAL(v[j].value(), j);
+        }
+    }
+}
+
 class exception_safety_checker {
     uint64_t _live_objects = 0;
     uint64_t _countdown = std::numeric_limits<uint64_t>::max();
@@ -22,6 +22,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <boost/range/adaptor/map.hpp>
+#include <boost/range/irange.hpp>
 
 #include <stdlib.h>
 #include <iostream>
@@ -101,6 +102,31 @@ SEASTAR_TEST_CASE(test_commitlog_written_to_disk_batch){
         });
 }
 
+SEASTAR_TEST_CASE(test_commitlog_written_to_disk_group){
+    commitlog::config cfg;
+    cfg.mode = commitlog::sync_mode::GROUP;
+    return cl_test(cfg, [](commitlog& log) {
+            constexpr size_t n_writes = 64;
+            auto count = make_lw_shared<size_t>(0);
+            auto uuid = utils::UUID_gen::get_time_UUID();
+            return parallel_for_each(boost::irange<size_t>(0, n_writes), [&log, uuid, count](size_t) {
+                        sstring tmp = "hej bubba cow";
+                        return log.add_mutation(uuid, tmp.size(), [tmp](db::commitlog::output& dst) {
+                                    dst.write(tmp.begin(), tmp.end());
+                                }).then([count](replay_position rp) {
+                                    BOOST_CHECK_NE(rp, db::replay_position());
+                                    ++(*count);
+                                });
+                    }).then([&log, count] {
+                        BOOST_REQUIRE_EQUAL(*count, size_t(n_writes));
+                        auto flushes = log.get_flush_count();
+                        BOOST_REQUIRE(flushes > 0);
+                        // concurrent writes must share syncs.
+                        BOOST_REQUIRE(flushes < n_writes);
+                    });
+        });
+}
+
 SEASTAR_TEST_CASE(test_commitlog_written_to_disk_periodic){
     return cl_test([](commitlog& log) {
             auto state = make_lw_shared(false);
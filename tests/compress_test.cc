@@ -24,6 +24,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "sstables/compress.hh"
+#include "compress.hh"
 
 BOOST_AUTO_TEST_CASE(segmented_offsets_basic_functionality) {
     sstables::compression::segmented_offsets offsets;
@@ -156,3 +157,38 @@ BOOST_AUTO_TEST_CASE(segmented_offsets_corner_cases) {
     BOOST_REQUIRE(accessor.at(4079) == 4079);
     BOOST_REQUIRE(accessor.at(4080) == 4080);
 }
+
+BOOST_AUTO_TEST_CASE(zstd_round_trip) {
+    auto c = compressor::create("ZstdCompressor", [] (const sstring& key) -> compressor::opt_string {
+        if (key == "compression_level") {
+            return sstring("5");
+        }
+        return std::experimental::nullopt;
+    });
+    BOOST_REQUIRE(c);
+    BOOST_REQUIRE_EQUAL(c->options().at("compression_level"), "5");
+
+    std::string input;
+    for (int i = 0; i < 1000; ++i) {
+        input += "the quick brown fox jumps over the lazy dog ";
+    }
+
+    std::vector<char> compressed(c->compress_max_size(input.size()));
+    auto compressed_size = c->compress(input.data(), input.size(), compressed.data(), compressed.size());
+    BOOST_REQUIRE(compressed_size < input.size());
+
+    std::vector<char> uncompressed(input.size());
+    auto uncompressed_size = c->uncompress(compressed.data(), compressed_size, uncompressed.data(), uncompressed.size());
+    BOOST_REQUIRE_EQUAL(uncompressed_size, input.size());
+    BOOST_REQUIRE(std::equal(input.begin(), input.end(), uncompressed.begin()));
+}
+
+BOOST_AUTO_TEST_CASE(zstd_invalid_level) {
+    auto opts = [] (const sstring& key) -> compressor::opt_string {
+        if (key == "compression_level") {
+            return sstring("1000000");
+        }
+        return std::experimental::nullopt;
+    };
+    BOOST_REQUIRE_THROW(compressor::create("ZstdCompressor", opts), exceptions::configuration_exception);
+}
@@ -22,6 +22,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <stdlib.h>
+#include <algorithm>
 #include <iostream>
 
 #include "tests/test-utils.hh"
@@ -891,3 +892,44 @@ SEASTAR_TEST_CASE(test_parse_broken) {
 
     return make_ready_future<>();
 }
+
+SEASTAR_TEST_CASE(test_apply_live_values) {
+    config cfg;
+
+    cfg.read_from_yaml(R"foo(read_request_timeout_in_ms: 5000
+cluster_name: Test Cluster
+)foo");
+
+    config updated;
+
+    updated.read_from_yaml(R"foo(read_request_timeout_in_ms: 7500
+cluster_name: Other Cluster
+num_tokens: 17
+)foo");
+
+    auto applied = cfg.apply_live_values(updated);
+    auto was_applied = [&](const char* name) {
+        return std::find(applied.begin(), applied.end(), sstring(name)) != applied.end();
+    };
+
+    // A changed, trivially copyable value is applied...
+    BOOST_CHECK_EQUAL(cfg.read_request_timeout_in_ms(), 7500);
+    BOOST_REQUIRE(was_applied("read_request_timeout_in_ms"));
+    // ... including one which was unset on our side...
+    BOOST_CHECK_EQUAL(cfg.num_tokens(), 17);
+    BOOST_REQUIRE(was_applied("num_tokens"));
+    // ... but a string value is never live-updated.
+    BOOST_CHECK_EQUAL(cfg.cluster_name(), "Test Cluster");
+    BOOST_REQUIRE(!was_applied("cluster_name"));
+
+    // A filter restricts what may be applied.
+    config filtered;
+    filtered.read_from_yaml("read_request_timeout_in_ms: 9000\nnum_tokens: 42\n");
+    applied = cfg.apply_live_values(filtered, [](const utils::config_file::config_src& src) {
+        return src.name() == "num_tokens";
+    });
+    BOOST_CHECK_EQUAL(cfg.read_request_timeout_in_ms(), 7500);
+    BOOST_CHECK_EQUAL(cfg.num_tokens(), 42);
+
+    return make_ready_future<>();
+}
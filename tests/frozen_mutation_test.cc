@@ -51,6 +51,11 @@ SEASTAR_TEST_CASE(test_writing_and_reading) {
             BOOST_REQUIRE_EQUAL(frozen.schema_version(), m.schema()->version());
             assert_that(frozen.unfreeze(m.schema())).is_equal_to(m);
             BOOST_REQUIRE(frozen.decorated_key(*m.schema()).equal(*m.schema(), m.decorated_key()));
+            // Covers the lazily-decorated path, as on a replica receiving
+            // the mutation off the wire.
+            auto received = frozen_mutation(bytes_ostream(frozen.representation()));
+            BOOST_REQUIRE(received.token(*m.schema()) == m.token());
+            BOOST_REQUIRE(received.decorated_key(*m.schema()).equal(*m.schema(), m.decorated_key()));
         });
     });
 }
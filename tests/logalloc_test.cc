@@ -271,6 +271,25 @@ SEASTAR_TEST_CASE(test_blob) {
     });
 }
 
+SEASTAR_TEST_CASE(test_freeing_last_allocation_rewinds_bump_pointer) {
+    return seastar::async([] {
+        region reg;
+        with_allocator(reg.allocator(), [&] {
+            // Freeing the most recent allocation should give its space right
+            // back, so the next same-sized allocation lands at the same
+            // address instead of leaving a dead object behind.
+            auto a = make_managed<uint64_t>(1);
+            auto* addr = &*a;
+            auto used = reg.occupancy().used_space();
+            a = {};
+            BOOST_REQUIRE(reg.occupancy().used_space() < used);
+            auto b = make_managed<uint64_t>(2);
+            BOOST_REQUIRE_EQUAL(addr, &*b);
+            BOOST_REQUIRE_EQUAL(reg.occupancy().used_space(), used);
+        });
+    });
+}
+
 SEASTAR_TEST_CASE(test_merging) {
     return seastar::async([] {
         region reg1;
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE core
+
+#include "sstables/mc_format.hh"
+#include "sstables/exceptions.hh"
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+using namespace sstables;
+
+static bytes serialize(const std::vector<bytes_opt>& values) {
+    bytes_ostream out;
+    mc::write_clustering_blocks(out, values);
+    auto view = out.linearize();
+    return bytes(view.begin(), view.end());
+}
+
+static void check_roundtrip(const std::vector<bytes_opt>& values) {
+    auto serialized = serialize(values);
+    BOOST_REQUIRE_EQUAL(serialized.size(), mc::clustering_blocks_serialized_size(values));
+    auto in = bytes_view(serialized);
+    auto deserialized = mc::read_clustering_blocks(in, values.size());
+    BOOST_REQUIRE(in.empty());
+    BOOST_REQUIRE(deserialized == values);
+}
+
+BOOST_AUTO_TEST_CASE(test_empty_prefix) {
+    check_roundtrip({});
+    BOOST_REQUIRE_EQUAL(mc::clustering_blocks_serialized_size({}), 0);
+    BOOST_REQUIRE(serialize({}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_single_values) {
+    check_roundtrip({bytes("foo")});
+    check_roundtrip({bytes()});
+    check_roundtrip({bytes_opt()});
+}
+
+BOOST_AUTO_TEST_CASE(test_mixed_values) {
+    check_roundtrip({bytes("key"), bytes_opt(), bytes(), bytes("value"), bytes_opt()});
+}
+
+BOOST_AUTO_TEST_CASE(test_long_values) {
+    check_roundtrip({bytes(1, 'x'), bytes(127, 'y'), bytes(128, 'z'), bytes(70000, 'w')});
+}
+
+BOOST_AUTO_TEST_CASE(test_multiple_blocks) {
+    // Prefixes longer than one block get one header per group of
+    // clustering_block_size values; exercise the boundaries.
+    for (auto n : { mc::clustering_block_size - 1, mc::clustering_block_size,
+                    mc::clustering_block_size + 1, 3 * mc::clustering_block_size }) {
+        std::vector<bytes_opt> values;
+        for (unsigned i = 0; i < n; ++i) {
+            switch (i % 3) {
+            case 0: values.emplace_back(bytes(1 + i % 7, 'a' + i % 26)); break;
+            case 1: values.emplace_back(bytes_opt()); break;
+            case 2: values.emplace_back(bytes()); break;
+            }
+        }
+        check_roundtrip(values);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_flag_bits_confined_to_block) {
+    // A null right after a block boundary must set the first flag bits of
+    // the second header, not bits past position 32 of the first.
+    std::vector<bytes_opt> values(mc::clustering_block_size, bytes_opt(bytes("v")));
+    values.emplace_back(bytes_opt());
+    auto serialized = serialize(values);
+    auto in = bytes_view(serialized);
+    // All values in the first block are present, so its header is a
+    // single zero vint byte.
+    BOOST_REQUIRE_EQUAL(serialized[0], 0);
+    auto deserialized = mc::read_clustering_blocks(in, values.size());
+    BOOST_REQUIRE(deserialized == values);
+    BOOST_REQUIRE(!deserialized[mc::clustering_block_size]);
+}
+
+BOOST_AUTO_TEST_CASE(test_reader_leaves_trailing_bytes) {
+    std::vector<bytes_opt> values = {bytes("a"), bytes("bc")};
+    auto serialized = serialize(values) + bytes("tail");
+    auto in = bytes_view(serialized);
+    auto deserialized = mc::read_clustering_blocks(in, values.size());
+    BOOST_REQUIRE(deserialized == values);
+    BOOST_REQUIRE(bytes(in.begin(), in.end()) == bytes("tail"));
+}
+
+BOOST_AUTO_TEST_CASE(test_truncated_input_throws) {
+    std::vector<bytes_opt> values = {bytes("some"), bytes("values"), bytes_opt(), bytes("here")};
+    auto serialized = serialize(values);
+    for (size_t len = 0; len < serialized.size(); ++len) {
+        auto in = bytes_view(serialized.data(), len);
+        BOOST_REQUIRE_THROW(mc::read_clustering_blocks(in, values.size()), malformed_sstable_exception);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_random_roundtrip) {
+    std::default_random_engine gen(1);
+    std::uniform_int_distribution<unsigned> n_dist(0, 100);
+    std::uniform_int_distribution<unsigned> kind_dist(0, 9);
+    std::uniform_int_distribution<unsigned> len_dist(1, 300);
+    for (int i = 0; i < 100; ++i) {
+        std::vector<bytes_opt> values;
+        auto n = n_dist(gen);
+        for (unsigned j = 0; j < n; ++j) {
+            auto kind = kind_dist(gen);
+            if (kind == 0) {
+                values.emplace_back(bytes_opt());
+            } else if (kind == 1) {
+                values.emplace_back(bytes());
+            } else {
+                values.emplace_back(bytes(len_dist(gen), bytes::value_type(j)));
+            }
+        }
+        check_roundtrip(values);
+    }
+}
@@ -122,3 +122,23 @@ BOOST_AUTO_TEST_CASE(test_hash_output) {
         }
     }
 }
+
+// The two-lane version must produce the same results as the single-lane
+// one for each input, for all combinations of lane lengths (equal, first
+// longer, second longer, with and without tails).
+BOOST_AUTO_TEST_CASE(test_two_lane_hash_output) {
+    for (size_t i = 0; i < full_sequence.size(); ++i) {
+        for (size_t j : {size_t(0), i / 2, i, full_sequence.size() - i}) {
+            auto first = bytes_view(full_sequence.begin(), i);
+            auto second = bytes_view(full_sequence.begin(), j);
+
+            std::array<uint64_t,2> dst1;
+            std::array<uint64_t,2> dst2;
+            utils::murmur_hash::hash3_x64_128_x2(first.begin(), first.size(), second.begin(), second.size(), seed, dst1, dst2);
+
+            if (dst1 != prefix_hashes[i] || dst2 != prefix_hashes[j]) {
+                BOOST_FAIL(sprint("Two-lane hashes differ for lengths %d and %d", i, j));
+            }
+        }
+    }
+}
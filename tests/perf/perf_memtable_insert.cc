@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/tests/perf/perf_tests.hh>
+
+#include "tests/simple_schema.hh"
+
+#include "memtable.hh"
+
+namespace tests {
+
+class memtable_inserts {
+    static constexpr size_t partition_count = 1024;
+    static constexpr size_t row_count = 8;
+    static constexpr size_t reset_interval = 4096;
+    simple_schema _schema;
+    std::vector<mutation> _one_row;
+    std::vector<mutation> _many_rows;
+    lw_shared_ptr<::memtable> _mt;
+    size_t _i = 0;
+public:
+    memtable_inserts()
+        : _mt(make_lw_shared<::memtable>(_schema.schema()))
+    {
+        auto dkeys = _schema.make_pkeys(partition_count);
+        _one_row.reserve(partition_count);
+        _many_rows.reserve(partition_count);
+        for (auto& dkey : dkeys) {
+            auto m = mutation(_schema.schema(), dkey);
+            m.apply(_schema.make_row(_schema.make_ckey(0), "value"));
+            _one_row.push_back(m);
+            for (size_t i = 1; i < row_count; i++) {
+                m.apply(_schema.make_row(_schema.make_ckey(i), "value"));
+            }
+            _many_rows.push_back(std::move(m));
+        }
+    }
+protected:
+    void apply_next(const std::vector<mutation>& pool) {
+        // Recreate the memtable periodically so that it does not grow
+        // without bound across iterations; amortized over the interval the
+        // construction cost is noise.
+        if (_i % reset_interval == 0) {
+            _mt = make_lw_shared<::memtable>(_schema.schema());
+        }
+        _mt->apply(pool[_i++ % pool.size()]);
+    }
+
+    const std::vector<mutation>& one_row_pool() const { return _one_row; }
+    const std::vector<mutation>& many_rows_pool() const { return _many_rows; }
+};
+
+PERF_TEST_F(memtable_inserts, one_row)
+{
+    apply_next(one_row_pool());
+}
+
+PERF_TEST_F(memtable_inserts, many_rows)
+{
+    apply_next(many_rows_pool());
+}
+
+}
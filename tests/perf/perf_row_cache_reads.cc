@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/tests/perf/perf_tests.hh>
+
+#include "tests/simple_schema.hh"
+
+#include "row_cache.hh"
+#include "mutation_reader.hh"
+#include "flat_mutation_reader.hh"
+
+namespace tests {
+
+class cache_reads {
+    static constexpr size_t partition_count = 1024;
+    static constexpr size_t row_count = 8;
+    simple_schema _schema;
+    cache_tracker _tracker;
+    row_cache _cache;
+    // First half of the keys is populated into the cache, second half stays
+    // cold.
+    std::vector<dht::decorated_key> _keys;
+    size_t _i = 0;
+    std::optional<dht::partition_range> _pr;
+public:
+    cache_reads()
+        : _cache(_schema.schema(), make_empty_snapshot_source(), _tracker)
+        , _keys(_schema.make_pkeys(partition_count))
+    {
+        for (size_t i = 0; i < partition_count / 2; i++) {
+            auto m = mutation(_schema.schema(), _keys[i]);
+            for (size_t j = 0; j < row_count; j++) {
+                m.apply(_schema.make_row(_schema.make_ckey(j), "value"));
+            }
+            _cache.populate(m);
+        }
+    }
+protected:
+    schema_ptr schema() const { return _schema.schema(); }
+
+    const dht::decorated_key& next_hot_key() {
+        return _keys[_i++ % (partition_count / 2)];
+    }
+
+    const dht::decorated_key& next_cold_key() {
+        return _keys[partition_count / 2 + _i++ % (partition_count / 2)];
+    }
+
+    const dht::partition_range& make_singular_range(const dht::decorated_key& dk) {
+        _pr.emplace(dht::partition_range::make_singular(dk));
+        return *_pr;
+    }
+
+    row_cache& cache() { return _cache; }
+
+    future<> consume_all(flat_mutation_reader mr) const {
+        return do_with(std::move(mr), [] (auto& mr) {
+            return mr.consume_pausable([] (mutation_fragment mf) {
+                perf_tests::do_not_optimize(mf);
+                return stop_iteration::no;
+            });
+        });
+    }
+};
+
+PERF_TEST_F(cache_reads, hit)
+{
+    return consume_all(cache().make_reader(schema(), make_singular_range(next_hot_key())));
+}
+
+PERF_TEST_F(cache_reads, miss)
+{
+    auto& dk = next_cold_key();
+    return consume_all(cache().make_reader(schema(), make_singular_range(dk))).then([this, &dk] {
+        // Drop the entry the miss just populated so the key stays cold.
+        // Removing one empty entry is cheap next to the miss path being
+        // measured.
+        return cache().invalidate([] {}, dk);
+    });
+}
+
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/tests/perf/perf_tests.hh>
+
+#include "tests/simple_schema.hh"
+
+#include "vint-serialization.hh"
+#include "frozen_mutation.hh"
+#include "mutation.hh"
+
+namespace tests {
+
+class vint {
+protected:
+    static constexpr size_t value_count = 1024;
+private:
+    std::vector<uint64_t> _values;
+    bytes _buffer;
+    bytes _encoded;
+    std::vector<uint64_t> _decoded;
+private:
+    static std::vector<uint64_t> make_values() {
+        std::vector<uint64_t> values;
+        values.reserve(value_count);
+        // Cycle through all encoded lengths so the benchmark is not
+        // dominated by a single branch pattern.
+        for (size_t i = 0; i < value_count; i++) {
+            auto bits = (i % 9) * 7;
+            values.push_back((uint64_t(1) << bits) + i % 127);
+        }
+        return values;
+    }
+public:
+    vint()
+        : _values(make_values())
+        , _buffer(bytes::initialized_later(), value_count * 9)
+        , _decoded(value_count)
+    {
+        size_t size = 0;
+        for (auto v : _values) {
+            size += unsigned_vint::serialized_size(v);
+        }
+        _encoded = bytes(bytes::initialized_later(), size);
+        auto out = _encoded.begin();
+        for (auto v : _values) {
+            out += unsigned_vint::serialize(v, out);
+        }
+    }
+protected:
+    const std::vector<uint64_t>& values() const { return _values; }
+    bytes::iterator buffer() { return _buffer.begin(); }
+    bytes_view encoded() const { return _encoded; }
+    uint64_t* decoded() { return _decoded.data(); }
+};
+
+PERF_TEST_F(vint, encode)
+{
+    auto out = buffer();
+    for (auto v : values()) {
+        out += unsigned_vint::serialize(v, out);
+    }
+    perf_tests::do_not_optimize(out);
+    return value_count;
+}
+
+PERF_TEST_F(vint, decode)
+{
+    auto in = encoded();
+    uint64_t sum = 0;
+    while (!in.empty()) {
+        auto d = unsigned_vint::deserialize(in);
+        sum += d.value;
+        in.remove_prefix(d.size);
+    }
+    perf_tests::do_not_optimize(sum);
+    return value_count;
+}
+
+PERF_TEST_F(vint, decode_batch)
+{
+    auto d = unsigned_vint::deserialize_batch(encoded(), decoded(), value_count);
+    perf_tests::do_not_optimize(d);
+    return value_count;
+}
+
+class compound_key {
+protected:
+    static constexpr size_t key_count = 1024;
+private:
+    simple_schema _schema;
+    std::vector<bytes> _keys;
+public:
+    compound_key() {
+        _keys.reserve(key_count);
+        for (size_t i = 0; i < key_count; i++) {
+            _keys.push_back(to_bytes(_schema.make_ckey(i).representation()));
+        }
+    }
+protected:
+    schema_ptr schema() const { return _schema.schema(); }
+    const std::vector<bytes>& keys() const { return _keys; }
+};
+
+PERF_TEST_F(compound_key, compare_adjacent)
+{
+    auto& type = *schema()->clustering_key_type();
+    int sum = 0;
+    for (size_t i = 0; i + 1 < key_count; i++) {
+        sum += type.compare(keys()[i], keys()[i + 1]);
+    }
+    perf_tests::do_not_optimize(sum);
+    return key_count - 1;
+}
+
+PERF_TEST_F(compound_key, compare_equal)
+{
+    auto& type = *schema()->clustering_key_type();
+    int sum = 0;
+    for (auto& k : keys()) {
+        sum += type.compare(k, k);
+    }
+    perf_tests::do_not_optimize(sum);
+    return key_count;
+}
+
+class freezing {
+    simple_schema _schema;
+    mutation _one_row;
+    mutation _many_rows;
+    frozen_mutation _one_row_frozen;
+    frozen_mutation _many_rows_frozen;
+private:
+    static mutation make_mutation(simple_schema& s, size_t rows) {
+        auto m = mutation(s.schema(), s.make_pkeys(1)[0]);
+        for (size_t i = 0; i < rows; i++) {
+            m.apply(s.make_row(s.make_ckey(i), "value"));
+        }
+        return m;
+    }
+public:
+    freezing()
+        : _one_row(make_mutation(_schema, 1))
+        , _many_rows(make_mutation(_schema, 100))
+        , _one_row_frozen(freeze(_one_row))
+        , _many_rows_frozen(freeze(_many_rows))
+    { }
+protected:
+    schema_ptr schema() const { return _schema.schema(); }
+    const mutation& one_row() const { return _one_row; }
+    const mutation& many_rows() const { return _many_rows; }
+    const frozen_mutation& one_row_frozen() const { return _one_row_frozen; }
+    const frozen_mutation& many_rows_frozen() const { return _many_rows_frozen; }
+};
+
+PERF_TEST_F(freezing, freeze_one_row)
+{
+    perf_tests::do_not_optimize(freeze(one_row()));
+}
+
+PERF_TEST_F(freezing, freeze_many_rows)
+{
+    perf_tests::do_not_optimize(freeze(many_rows()));
+}
+
+PERF_TEST_F(freezing, unfreeze_one_row)
+{
+    perf_tests::do_not_optimize(one_row_frozen().unfreeze(schema()));
+}
+
+PERF_TEST_F(freezing, unfreeze_many_rows)
+{
+    perf_tests::do_not_optimize(many_rows_frozen().unfreeze(schema()));
+}
+
+}
@@ -1508,6 +1508,45 @@ SEASTAR_TEST_CASE(test_slicing_mutation_reader) {
     });
 }
 
+SEASTAR_TEST_CASE(test_rows_per_partition_caching_option_caps_population) {
+    return seastar::async([] {
+        auto s = schema_builder("ks", "cf")
+            .with_column("pk", int32_type, column_kind::partition_key)
+            .with_column("ck", int32_type, column_kind::clustering_key)
+            .with_column("v", int32_type)
+            .set_caching_options(caching_options::from_map(std::map<sstring, sstring>{{"rows_per_partition", "3"}}))
+            .build();
+
+        auto pk = partition_key::from_exploded(*s, { int32_type->decompose(0) });
+        mutation m(s, pk);
+        constexpr auto row_count = 8;
+        for (auto i = 0; i < row_count; i++) {
+            m.set_clustered_cell(clustering_key_prefix::from_single_value(*s, int32_type->decompose(i)),
+                                 to_bytes("v"), data_value(i), api::new_timestamp());
+        }
+
+        auto mt = make_lw_shared<memtable>(s);
+        mt->apply(m);
+
+        cache_tracker tracker;
+        row_cache cache(s, snapshot_source_from_snapshot(mt->as_data_source()), tracker);
+
+        // Reads are unaffected by the cap...
+        assert_that(cache.make_reader(s, query::full_partition_range))
+            .produces(m)
+            .produces_end_of_stream();
+
+        // ...but only the head of the partition was populated.
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().row_insertions, 3);
+
+        // Repeated reads don't populate beyond the cap either.
+        assert_that(cache.make_reader(s, query::full_partition_range))
+            .produces(m)
+            .produces_end_of_stream();
+        BOOST_REQUIRE_EQUAL(tracker.get_stats().row_insertions, 3);
+    });
+}
+
 SEASTAR_TEST_CASE(test_lru) {
     return seastar::async([] {
         auto s = make_schema();
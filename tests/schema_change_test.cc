@@ -416,3 +416,23 @@ SEASTAR_TEST_CASE(test_prepared_statement_is_invalidated_by_schema_change) {
         });
     });
 }
+
+SEASTAR_TEST_CASE(test_prepared_statement_can_be_reprepared_after_schema_change) {
+    return do_with_cql_env([](cql_test_env& e) {
+        return seastar::async([&] {
+            e.execute_cql("create keyspace tests with replication = { 'class' : 'SimpleStrategy', 'replication_factor' : 1 };").get();
+            e.execute_cql("create table tests.table1 (pk int primary key, c1 int, c2 int);").get();
+            auto id = e.prepare("select * from tests.table1;").get0();
+
+            e.execute_cql("alter table tests.table1 add s1 int;").get();
+
+            // Re-preparation reuses the retained parse tree and must produce
+            // a statement reflecting the new schema.
+            auto new_id = e.prepare("select * from tests.table1;").get0();
+            BOOST_REQUIRE(new_id.key() == id.key());
+            e.execute_cql("insert into tests.table1 (pk, c1, c2, s1) values (1, 2, 3, 4);").get();
+            auto msg = e.execute_prepared(new_id, {}).get0();
+            assert_that(msg).is_rows().with_size(1);
+        });
+    });
+}
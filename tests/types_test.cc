@@ -525,7 +525,16 @@ BOOST_AUTO_TEST_CASE(test_utf8_type_validation) {
     utf8_type->validate(bytes());
     utf8_type->validate(bytes("foo"));
     utf8_type->validate(bytes("fóo"));
+    utf8_type->validate(bytes("foo, bar, baz and a longer ascii run €𐍈"));
     test_validation_fails(utf8_type, bytes("test") + from_hex("fe"));
+    // Truncated sequence, overlong encoding, surrogate, above U+10FFFF and a
+    // stray continuation byte, each after an ASCII run longer than the
+    // validator's eight-byte fast path.
+    test_validation_fails(utf8_type, bytes("0123456789") + from_hex("e282"));
+    test_validation_fails(utf8_type, bytes("0123456789") + from_hex("c080"));
+    test_validation_fails(utf8_type, bytes("0123456789") + from_hex("eda080"));
+    test_validation_fails(utf8_type, bytes("0123456789") + from_hex("f4908080"));
+    test_validation_fails(utf8_type, bytes("0123456789") + from_hex("80"));
 }
 
 BOOST_AUTO_TEST_CASE(test_int32_type_validation) {
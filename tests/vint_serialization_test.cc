@@ -141,3 +141,49 @@ BOOST_AUTO_TEST_CASE(sanity_signed_examples) {
 BOOST_AUTO_TEST_CASE(sanity_signed_sweep) {
     check_roundtrip_sweep<signed_vint>(100'000, random_engine());
 }
+
+// Check that batch decoding of a contiguous sequence of vints agrees with
+// decoding them one at a time, including when the buffer ends mid-vint.
+template <class Vint>
+static void check_batch_roundtrip(const std::vector<typename Vint::value_type>& values) {
+    bytes buffer(bytes::initialized_later(), values.size() * 9);
+    vint_size_type encoded_size = 0;
+    for (auto v : values) {
+        encoded_size += Vint::serialize(v, buffer.begin() + encoded_size);
+    }
+
+    std::vector<typename Vint::value_type> decoded(values.size());
+    const auto full = Vint::deserialize_batch(bytes_view(buffer.data(), encoded_size),
+            decoded.data(), decoded.size());
+    BOOST_REQUIRE_EQUAL(full.count, values.size());
+    BOOST_REQUIRE_EQUAL(full.size, encoded_size);
+    BOOST_REQUIRE(decoded == values);
+
+    // A truncated buffer must decode a prefix and report the bytes it consumed.
+    if (encoded_size > 1) {
+        const auto partial = Vint::deserialize_batch(bytes_view(buffer.data(), encoded_size - 1),
+                decoded.data(), decoded.size());
+        BOOST_REQUIRE(partial.count < values.size());
+        BOOST_REQUIRE(partial.size < encoded_size);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_unsigned_sweep) {
+    std::vector<uint64_t> values;
+    with_random_samples<uint64_t>(random_engine(), 10'000, [&values](uint64_t v) {
+        values.push_back(v);
+        // Mix in short encodings so batches exercise all vint sizes.
+        values.push_back(v & 0x7f);
+        values.push_back(v & 0xffff);
+    });
+    check_batch_roundtrip<unsigned_vint>(values);
+}
+
+BOOST_AUTO_TEST_CASE(batch_signed_sweep) {
+    std::vector<int64_t> values;
+    with_random_samples<int64_t>(random_engine(), 10'000, [&values](int64_t v) {
+        values.push_back(v);
+        values.push_back(v % 100);
+    });
+    check_batch_roundtrip<signed_vint>(values);
+}
@@ -184,7 +184,7 @@ private:
      *
      * @return a vector with the mutation data
      */
-    std::vector<cql3::raw_value> make_event_mutation_data(one_session_records& session_records, const event_record& record);
+    std::vector<cql3::raw_value> make_event_mutation_data(one_session_records& session_records, event_record& record);
 
     /**
      * Converts a @param elapsed to an int32_t value of microseconds.
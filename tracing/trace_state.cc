@@ -132,6 +132,27 @@ void trace_state::stop_foreground_and_write() noexcept {
                     _records->drop_records();
                 }
             }
+
+            if (_records->do_log_slow_query) {
+                // Also push a flattened summary into the per-shard ring, so
+                // that the latest offenders can be read back without going
+                // through the system_traces tables. Parameters may be empty
+                // here if build_parameters_map() above failed or records were
+                // over budget; the summary is still worth keeping.
+                try {
+                    slow_query_record rec;
+                    auto& s = _records->session_rec;
+                    rec.started_at = s.started_at;
+                    rec.duration = std::chrono::duration_cast<std::chrono::microseconds>(e);
+                    rec.client = s.client;
+                    rec.username = s.username;
+                    rec.request = s.request;
+                    rec.parameters = s.parameters;
+                    _local_tracing_ptr->record_slow_query(std::move(rec));
+                } catch (...) {
+                    ++_local_tracing_ptr->stats.trace_errors;
+                }
+            }
         }
 
         set_state(state::background);
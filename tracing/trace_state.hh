@@ -43,6 +43,7 @@
 #include <deque>
 #include <unordered_set>
 #include <seastar/util/lazy.hh>
+#include <seastar/core/apply.hh>
 #include "mutation.hh"
 #include "utils/UUID_gen.hh"
 #include "tracing/tracing.hh"
@@ -398,6 +399,29 @@ private:
      */
     void trace_internal(sstring msg);
 
+    /**
+     * Same as above for a message with deferred formatting: the builder is
+     * only invoked if and when the record is flushed to the backend.
+     *
+     * @note This method is allowed to throw.
+     * @param msg_builder builds the trace message
+     */
+    void trace_internal(noncopyable_function<sstring()> msg_builder);
+
+    /**
+     * Check the records budget before storing a new trace message.
+     *
+     * @return true if there is budget for one more record
+     */
+    bool take_record_budget();
+
+    /**
+     * Schedule the aggregated records for write if there are enough of them.
+     *
+     * @param e the elapsed time of the event that has just been recorded
+     */
+    void maybe_schedule_for_write(elapsed_clock::duration e);
+
     /**
      * Add a single trace entry - a special case for a simple string.
      *
@@ -454,11 +478,7 @@ private:
     friend void add_table_name(const trace_state_ptr& p, const sstring& ks_name, const sstring& cf_name);
 };
 
-inline void trace_state::trace_internal(sstring message) {
-    if (is_in_state(state::inactive)) {
-        throw std::logic_error("trying to use a trace() before begin() for \"" + message + "\" tracepoint");
-    }
-
+inline bool trace_state::take_record_budget() {
     // We don't want the total amount of pending, active and flushing records to
     // bypass two times the maximum number of pending records.
     //
@@ -472,6 +492,34 @@ inline void trace_state::trace_internal(sstring message) {
             tracing_logger.warn("Maximum records limit is hit {} times", _local_tracing_ptr->stats.dropped_records);
         }
 
+        return false;
+    }
+
+    return true;
+}
+
+inline void trace_state::maybe_schedule_for_write(elapsed_clock::duration e) {
+    // If we have aggregated enough records - schedule them for write already.
+    //
+    // We prefer the traces to be written after the session is over. However
+    // if there is a session that creates a lot of traces - we want to write
+    // them before we start to drop new records.
+    //
+    // We don't want to write records of a tracing session if we trace only
+    // slow queries and the elapsed time is still below the slow query
+    // logging threshold.
+    if (_records->events_recs.size() >= tracing::exp_trace_events_per_session && (full_tracing() || should_log_slow_query(e))) {
+        _local_tracing_ptr->schedule_for_write(_records);
+        _local_tracing_ptr->write_maybe();
+    }
+}
+
+inline void trace_state::trace_internal(sstring message) {
+    if (is_in_state(state::inactive)) {
+        throw std::logic_error("trying to use a trace() before begin() for \"" + message + "\" tracepoint");
+    }
+
+    if (!take_record_budget()) {
         return;
     }
 
@@ -479,20 +527,27 @@ inline void trace_state::trace_internal(sstring message) {
         auto e = elapsed();
         _records->events_recs.emplace_back(std::move(message), e, i_tracing_backend_helper::wall_clock::now());
         _records->consume_from_budget();
+        maybe_schedule_for_write(e);
+    } catch (...) {
+        // Bump up an error counter and ignore
+        ++_local_tracing_ptr->stats.trace_errors;
+    }
+}
 
-        // If we have aggregated enough records - schedule them for write already.
-        //
-        // We prefer the traces to be written after the session is over. However
-        // if there is a session that creates a lot of traces - we want to write
-        // them before we start to drop new records.
-        //
-        // We don't want to write records of a tracing session if we trace only
-        // slow queries and the elapsed time is still below the slow query
-        // logging threshold.
-        if (_records->events_recs.size() >= tracing::exp_trace_events_per_session && (full_tracing() || should_log_slow_query(e))) {
-            _local_tracing_ptr->schedule_for_write(_records);
-            _local_tracing_ptr->write_maybe();
-        }
+inline void trace_state::trace_internal(noncopyable_function<sstring()> msg_builder) {
+    if (is_in_state(state::inactive)) {
+        throw std::logic_error("trying to use a trace() before begin() for \"" + msg_builder() + "\" tracepoint");
+    }
+
+    if (!take_record_budget()) {
+        return;
+    }
+
+    try {
+        auto e = elapsed();
+        _records->events_recs.emplace_back(std::move(msg_builder), e, i_tracing_backend_helper::wall_clock::now());
+        _records->consume_from_budget();
+        maybe_schedule_for_write(e);
     } catch (...) {
         // Bump up an error counter and ignore
         ++_local_tracing_ptr->stats.trace_errors;
@@ -502,7 +557,14 @@ inline void trace_state::trace_internal(sstring message) {
 template <typename... A>
 void trace_state::trace(const char* fmt, A&&... a) noexcept {
     try {
-        trace_internal(seastar::format(fmt, std::forward<A>(a)...));
+        // Formatting is deferred until the record is flushed to the backend.
+        // The format string is required to be a literal; the positional
+        // parameters are copied, as documented above.
+        trace_internal(noncopyable_function<sstring()>([fmt, args = std::make_tuple(std::forward<A>(a)...)] {
+            return seastar::apply([fmt] (const auto&... a) {
+                return seastar::format(fmt, a...);
+            }, args);
+        }));
     } catch (...) {
         // Bump up an error counter and ignore
         ++_local_tracing_ptr->stats.trace_errors;
@@ -43,9 +43,11 @@
 #include <vector>
 #include <atomic>
 #include <random>
+#include <boost/circular_buffer.hpp>
 #include <seastar/core/sharded.hh>
 #include <seastar/core/sstring.hh>
 #include <seastar/core/metrics_registration.hh>
+#include <seastar/util/noncopyable_function.hh>
 #include "gc_clock.hh"
 #include "utils/UUID.hh"
 #include "gms/inet_address.hh"
@@ -195,7 +197,13 @@ private:
 };
 
 struct event_record {
+    // Formatting a message is deferred until the record is flushed to the
+    // backend: until then only the format string pointer (a literal) and the
+    // captured arguments are kept. Sessions that are dropped without being
+    // written - e.g. slow-query-only sessions that end under the threshold -
+    // never pay for formatting at all.
     sstring message;
+    noncopyable_function<sstring()> message_builder;
     elapsed_clock::duration elapsed;
     i_tracing_backend_helper::wall_clock::time_point event_time_point;
 
@@ -203,6 +211,19 @@ struct event_record {
         : message(std::move(message_))
         , elapsed(elapsed_)
         , event_time_point(event_time_point_) {}
+
+    event_record(noncopyable_function<sstring()> message_builder_, elapsed_clock::duration elapsed_, i_tracing_backend_helper::wall_clock::time_point event_time_point_)
+        : message_builder(std::move(message_builder_))
+        , elapsed(elapsed_)
+        , event_time_point(event_time_point_) {}
+
+    const sstring& get_message() {
+        if (message_builder) {
+            message = message_builder();
+            message_builder = {};
+        }
+        return message;
+    }
 };
 
 struct session_record {
@@ -236,6 +257,21 @@ public:
     }
 };
 
+/**
+ * A flattened summary of a single completed slow query. Recent records are
+ * kept in a small per-shard ring (see tracing::recent_slow_queries()) so
+ * that the latest tail-latency offenders can be inspected immediately and
+ * without querying the system_traces tables.
+ */
+struct slow_query_record {
+    std::chrono::system_clock::time_point started_at;
+    std::chrono::microseconds duration;
+    gms::inet_address client;
+    sstring username;
+    sstring request;
+    std::map<sstring, sstring> parameters;
+};
+
 class one_session_records {
 public:
     utils::UUID session_id;
@@ -319,6 +355,8 @@ public:
     static constexpr int write_event_records_threshold = write_event_sessions_threshold * exp_trace_events_per_session;
     // Number of events when an info message is printed
     static constexpr int log_warning_period = 10000;
+    // Number of slow query summaries retained in the per-shard ring
+    static constexpr int max_slow_query_ring_entries = 256;
 
     static const std::chrono::microseconds default_slow_query_duraion_threshold;
     static const std::chrono::seconds default_slow_query_record_ttl;
@@ -397,6 +435,7 @@ private:
     std::ranlux48_base _gen;
     std::chrono::microseconds _slow_query_duration_threshold;
     std::chrono::seconds _slow_query_record_ttl;
+    boost::circular_buffer<slow_query_record> _slow_query_ring{max_slow_query_ring_entries};
 
 public:
     uint64_t get_next_rand_uint64() {
@@ -632,6 +671,14 @@ public:
         return _slow_query_record_ttl;
     }
 
+    void record_slow_query(slow_query_record record) {
+        _slow_query_ring.push_back(std::move(record));
+    }
+
+    const boost::circular_buffer<slow_query_record>& recent_slow_queries() const {
+        return _slow_query_ring;
+    }
+
 private:
     void write_timer_callback();
 
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "cql3/result_set.hh"
+#include "cql3/result_generator.hh"
 #include "cql3/statements/prepared_statement.hh"
 
 #include "transport/messages/result_message_base.hh"
@@ -173,11 +174,31 @@ public:
 
 class result_message::rows : public result_message {
 private:
-    std::unique_ptr<cql3::result_set> _rs;
+    // Lazily materialized from _generator when only the latter is set.
+    mutable std::unique_ptr<cql3::result_set> _rs;
+    std::experimental::optional<cql3::result_generator> _generator;
+    ::shared_ptr<const cql3::metadata> _metadata;
 public:
-    rows(std::unique_ptr<cql3::result_set> rs) : _rs(std::move(rs)) {}
+    rows(std::unique_ptr<cql3::result_set> rs) : _rs(std::move(rs)), _metadata(_rs->_metadata) {}
+    rows(cql3::result_generator generator, ::shared_ptr<const cql3::metadata> m)
+        : _generator(std::move(generator)), _metadata(std::move(m)) {}
+
+    // Engaged when the page can be serialized to the wire straight from the
+    // underlying query::result, bypassing rs().
+    const std::experimental::optional<cql3::result_generator>& generator() const {
+        return _generator;
+    }
+
+    const cql3::metadata& get_metadata() const {
+        return *_metadata;
+    }
 
     const cql3::result_set& rs() const {
+        if (!_rs) {
+            _rs = _generator->materialize();
+            // Preserve the paging state the statement attached to this page.
+            _rs->_metadata = ::make_shared<cql3::metadata>(*_metadata);
+        }
         return *_rs;
     }
 
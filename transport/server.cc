@@ -36,6 +36,7 @@
 #include "core/future-util.hh"
 #include "core/reactor.hh"
 #include "utils/UUID.hh"
+#include "utils/cpu_profiler.hh"
 #include "database.hh"
 #include "net/byteorder.hh"
 #include <seastar/core/metrics.hh>
@@ -46,10 +47,12 @@
 #include "enum_set.hh"
 #include "service/query_state.hh"
 #include "service/client_state.hh"
+#include "service/workload_group.hh"
 #include "exceptions/exceptions.hh"
 
 #include "auth/authenticator.hh"
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 
@@ -222,6 +225,8 @@ public:
     void write_string_map(std::map<sstring, sstring> string_map);
     void write_string_multimap(std::multimap<sstring, sstring> string_map);
     void write_value(bytes_opt value);
+    void write_value(std::experimental::optional<bytes_view> value);
+    void add_custom_payload(const std::map<sstring, sstring>& payload);
     void write(const cql3::metadata& m, bool skip = false);
     void write(const cql3::prepared_metadata& m, uint8_t version);
     future<> output(output_stream<char>& out, uint8_t version, cql_compression compression);
@@ -268,6 +273,7 @@ cql_server::cql_server(distributed<service::storage_proxy>& proxy, distributed<c
     , _notifier(std::make_unique<event_notifier>())
     , _lb(lb)
     , _auth_service(auth_service)
+    , _max_estimated_delay_ms(_proxy.local().get_db().local().get_config().read_request_timeout_in_ms())
 {
     namespace sm = seastar::metrics;
 
@@ -291,6 +297,11 @@ cql_server::cql_server(distributed<service::storage_proxy>& proxy, distributed<c
                         sm::description(
                             seastar::format("Holds the number of requests that are currently blocked due to reaching the memory quota limit ({}B). "
                                             "Non-zero value indicates that our bottleneck is memory and more specifically - the memory quota allocated for the \"CQL transport\" component.", _max_request_size))),
+        sm::make_derive("requests_shed", _requests_shed,
+                        sm::description("Counts requests shed by admission control because the estimated queueing "
+                                        "delay on this shard already exceeded the request timeout. Clients get an "
+                                        "Overloaded error instead of queueing up to a certain timeout.")),
+
         sm::make_derive("requests_blocked_memory", _requests_blocked_memory,
                         sm::description(
                             seastar::format("Holds an incrementing counter with the requests that ever blocked due to reaching the memory quota limit ({}B). "
@@ -453,9 +464,13 @@ cql_server::connection::read_frame() {
 }
 
 future<cql_server::connection::processing_result>
-    cql_server::connection::process_request_one(bytes_view buf, uint8_t op, uint16_t stream, service::client_state client_state, tracing_request_type tracing_request) {
+    cql_server::connection::process_request_one(bytes_view buf, uint8_t op, uint16_t stream, service::client_state client_state, tracing_request_type tracing_request, std::chrono::steady_clock::time_point arrival) {
     using auth_state = service::client_state::auth_state;
 
+    utils::cpu_profiler::scope profiler_scope(utils::cpu_profiler::component::cql_transport);
+
+    auto start = std::chrono::steady_clock::now();
+
     auto cqlop = static_cast<cql_binary_opcode>(op);
     tracing::trace_state_props_set trace_props;
 
@@ -505,14 +520,41 @@ future<cql_server::connection::processing_result>
 
         tracing::set_username(client_state.get_trace_state(), user);
 
+        if (user && user->name) {
+            if (auto wg = service::find_workload_group(*user->name)) {
+                client_state.set_workload_group(*wg);
+            }
+        }
+
+        // Statements run inside the scheduling group of the role's workload
+        // group, if one is configured, so that a tenant's heavy statements
+        // compete for reactor time at the configured share instead of
+        // starving other workloads.
+        auto wg = client_state.get_workload_group();
+        auto run = [wg] (auto process) -> future<response_type> {
+            if (wg) {
+                return with_scheduling_group(*wg, std::move(process));
+            }
+            return process();
+        };
+
         switch (cqlop) {
         case cql_binary_opcode::STARTUP:       return process_startup(stream, std::move(buf), std::move(client_state));
         case cql_binary_opcode::AUTH_RESPONSE: return process_auth_response(stream, std::move(buf), std::move(client_state));
         case cql_binary_opcode::OPTIONS:       return process_options(stream, std::move(buf), std::move(client_state));
-        case cql_binary_opcode::QUERY:         return process_query(stream, std::move(buf), std::move(client_state));
+        case cql_binary_opcode::QUERY:
+            return run([this, stream, buf = std::move(buf), client_state = std::move(client_state)] () mutable {
+                return process_query(stream, std::move(buf), std::move(client_state));
+            });
         case cql_binary_opcode::PREPARE:       return process_prepare(stream, std::move(buf), std::move(client_state));
-        case cql_binary_opcode::EXECUTE:       return process_execute(stream, std::move(buf), std::move(client_state));
-        case cql_binary_opcode::BATCH:         return process_batch(stream, std::move(buf), std::move(client_state));
+        case cql_binary_opcode::EXECUTE:
+            return run([this, stream, buf = std::move(buf), client_state = std::move(client_state)] () mutable {
+                return process_execute(stream, std::move(buf), std::move(client_state));
+            });
+        case cql_binary_opcode::BATCH:
+            return run([this, stream, buf = std::move(buf), client_state = std::move(client_state)] () mutable {
+                return process_batch(stream, std::move(buf), std::move(client_state));
+            });
         case cql_binary_opcode::REGISTER:      return process_register(stream, std::move(buf), std::move(client_state));
         default:                               throw exceptions::protocol_exception(sprint("Unknown opcode %d", int(cqlop)));
         }
@@ -567,6 +609,26 @@ future<cql_server::connection::processing_result>
         } catch (...) {
             return make_ready_future<processing_result>(std::make_pair(make_error(stream, exceptions::exception_code::SERVER_ERROR, "unknown error", client_state.get_trace_state()), client_state));
         }
+    }).then([this, cqlop, arrival, start] (processing_result r) {
+        if (_exec_info_requested && (cqlop == cql_binary_opcode::QUERY
+                || cqlop == cql_binary_opcode::EXECUTE
+                || cqlop == cql_binary_opcode::BATCH)) {
+            // The breakdown is attached here, on the shard which executed the
+            // request and allocated the response, before the response crosses
+            // back to the connection's shard. Values are decimal strings:
+            // friendlier to tracing pipelines than a private binary format,
+            // and the cost only matters to connections which asked for it.
+            auto us = [] (std::chrono::steady_clock::duration d) {
+                return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+            };
+            auto now = std::chrono::steady_clock::now();
+            std::map<sstring, sstring> payload;
+            payload.emplace("scylla_queued_us", sprint("%d", us(start - arrival)));
+            payload.emplace("scylla_exec_us", sprint("%d", us(now - start)));
+            payload.emplace("scylla_shard", sprint("%d", engine().cpu_id()));
+            r.cql_response->add_custom_payload(payload);
+        }
+        return make_ready_future<processing_result>(std::move(r));
     }).finally([tracing_state = client_state.get_trace_state()] {
         tracing::stop_foreground(tracing_state);
     });
@@ -630,6 +692,21 @@ future<> cql_server::connection::shutdown()
     return make_ready_future<>();
 }
 
+void cql_server::admission_controller::register_completion() {
+    ++_completed;
+    auto now = lowres_clock::now();
+    if (now - _tick < tick_period()) {
+        return;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _tick).count();
+    auto rate = double(_completed - _completed_at_tick) / elapsed;
+    // Exponential smoothing so a short burst or dip does not swing the
+    // admission decision back and forth.
+    _rate = _rate ? _rate * 0.8 + rate * 0.2 : rate;
+    _completed_at_tick = _completed;
+    _tick = now;
+}
+
 struct process_request_executor {
     static auto get() { return &cql_server::connection::process_request_one; }
 };
@@ -661,6 +738,15 @@ void cql_server::connection::update_client_state(processing_result& response) {
     }
 }
 
+// Reads one frame and dispatches it. Note that the returned future resolves
+// once the frame body has been consumed from the socket, not when the request
+// completes: execution is started under _pending_requests_gate and left to
+// run, so the process() loop is already reading and parsing frame N+1 while
+// request N executes. Responses are written as their requests finish, which
+// may be out of arrival order; that is fine, since the protocol only ties a
+// response to its request through the stream id, and a client may not reuse
+// a stream id while its request is in flight. Backpressure comes from the
+// memory semaphore awaited below, not from request completion.
 future<> cql_server::connection::process_request() {
     return read_frame().then_wrapped([this] (future<std::experimental::optional<cql_binary_frame_v3>>&& v) {
         auto maybe_frame = std::get<0>(v.get());
@@ -670,6 +756,10 @@ future<> cql_server::connection::process_request() {
         }
 
         auto& f = *maybe_frame;
+        // Timestamp for the queue-delay part of the per-request execution
+        // info: everything between here and the start of processing (memory
+        // semaphore, gate, a possible cross-shard hop) counts as queueing.
+        auto arrival = std::chrono::steady_clock::now();
         tracing_request_type tracing_requested = tracing_request_type::not_requested;
         if (f.flags & cql_frame_flags::tracing) {
             // If tracing is requested for a specific CQL command - flush
@@ -694,24 +784,53 @@ future<> cql_server::connection::process_request() {
             ++_server._requests_blocked_memory;
         }
 
-        return fut.then([this, length = f.length, flags = f.flags, op, stream, tracing_requested] (semaphore_units<> mem_permit) {
-          return this->read_and_decompress_frame(length, flags).then([this, flags, op, stream, tracing_requested, mem_permit = std::move(mem_permit)] (temporary_buffer<char> buf) mutable {
+        // Admission control: when the backlog on this shard is deep enough
+        // that a newly admitted data request would wait longer than its
+        // timeout, it is bound to fail anyway, so fail it upfront with an
+        // Overloaded error instead of letting the queue (and every queued
+        // request's latency) keep growing. Batches, which are always writes,
+        // and small requests get twice the headroom, so overload sheds the
+        // expensive reads first. Control messages (startup, auth, prepare,
+        // register) are never shed.
+        auto cqlop = cql_binary_opcode(op);
+        if (cqlop == cql_binary_opcode::QUERY || cqlop == cql_binary_opcode::EXECUTE || cqlop == cql_binary_opcode::BATCH) {
+            static constexpr uint32_t small_request_length = 4096;
+            auto limit = _server._max_estimated_delay_ms;
+            if (cqlop == cql_binary_opcode::BATCH || f.length <= small_request_length) {
+                limit *= 2;
+            }
+            if (_server._admission.estimated_delay_ms(_server._requests_serving) > limit) {
+                ++_server._requests_shed;
+                // The frame body still has to be consumed to keep the
+                // connection usable for the requests behind it.
+                return fut.then([this, length = f.length, stream] (semaphore_units<> mem_permit) {
+                    return _read_buf.read_exactly(length).then([this, stream, mem_permit = std::move(mem_permit)] (temporary_buffer<char>) {
+                        return write_response(make_error(stream, exceptions::exception_code::OVERLOADED,
+                                "shard backlog exceeds request timeout", tracing::trace_state_ptr()), _compression);
+                    });
+                });
+            }
+        }
+
+        return fut.then([this, length = f.length, flags = f.flags, op, stream, tracing_requested, arrival] (semaphore_units<> mem_permit) {
+          return this->read_and_decompress_frame(length, flags).then([this, flags, op, stream, tracing_requested, arrival, mem_permit = std::move(mem_permit)] (temporary_buffer<char> buf) mutable {
 
             ++_server._requests_served;
             ++_server._requests_serving;
 
-            with_gate(_pending_requests_gate, [this, flags, op, stream, buf = std::move(buf), tracing_requested, mem_permit = std::move(mem_permit)] () mutable {
+            with_gate(_pending_requests_gate, [this, flags, op, stream, buf = std::move(buf), tracing_requested, arrival, mem_permit = std::move(mem_permit)] () mutable {
                 auto bv = bytes_view{reinterpret_cast<const int8_t*>(buf.begin()), buf.size()};
                 auto cpu = pick_request_cpu();
                 return [&] {
                     if (cpu == engine().cpu_id()) {
-                        return process_request_stage(this, bv, op, stream, service::client_state(service::client_state::request_copy_tag{}, _client_state, _client_state.get_timestamp()), tracing_requested);
+                        return process_request_stage(this, bv, op, stream, service::client_state(service::client_state::request_copy_tag{}, _client_state, _client_state.get_timestamp()), tracing_requested, arrival);
                     } else {
-                        return smp::submit_to(cpu, [this, bv = std::move(bv), op, stream, client_state = _client_state, tracing_requested, ts = _client_state.get_timestamp()] () mutable {
-                            return process_request_stage(this, bv, op, stream, service::client_state(service::client_state::request_copy_tag{}, client_state, ts), tracing_requested);
+                        return smp::submit_to(cpu, [this, bv = std::move(bv), op, stream, client_state = _client_state, tracing_requested, arrival, ts = _client_state.get_timestamp()] () mutable {
+                            return process_request_stage(this, bv, op, stream, service::client_state(service::client_state::request_copy_tag{}, client_state, ts), tracing_requested, arrival);
                         });
                     }
                 }().then([this, flags] (auto&& response) {
+                    _server._admission.register_completion();
                     update_client_state(response);
                     return this->write_response(std::move(response.cql_response), _compression);
                 }).then([buf = std::move(buf), mem_permit = std::move(mem_permit)] {
@@ -733,6 +852,42 @@ static inline bytes_view to_bytes_view(temporary_buffer<char>& b)
     return bytes_view(reinterpret_cast<const byte*>(b.get()), b.size());
 }
 
+void cql_server::connection::frame_buffer_pool::put(buffer b) {
+    if (_free.size() < max_buffers) {
+        _free.emplace_back(std::move(b));
+    }
+}
+
+temporary_buffer<char> cql_server::connection::frame_buffer_pool::get(lw_shared_ptr<frame_buffer_pool> pool, size_t size) {
+    auto& p = *pool;
+    p._recent_max_size = std::max(p._recent_max_size, size);
+    if (++p._frames >= shrink_interval) {
+        // Drop buffers no recent frame was large enough to need, so a burst
+        // of large frames does not pin their capacity forever.
+        auto max = p._recent_max_size;
+        p._free.erase(std::remove_if(p._free.begin(), p._free.end(), [max] (const buffer& b) {
+            return b.capacity > max;
+        }), p._free.end());
+        p._frames = 0;
+        p._recent_max_size = size;
+    }
+    buffer b;
+    auto i = std::find_if(p._free.begin(), p._free.end(), [size] (const buffer& b) {
+        return b.capacity >= size;
+    });
+    if (i != p._free.end()) {
+        b = std::move(*i);
+        p._free.erase(i);
+    } else {
+        b.data = std::unique_ptr<char[]>(new char[size]);
+        b.capacity = size;
+    }
+    auto ptr = b.data.get();
+    return temporary_buffer<char>(ptr, size, make_deleter([pool = std::move(pool), b = std::move(b)] () mutable {
+        pool->put(std::move(b));
+    }));
+}
+
 future<temporary_buffer<char>> cql_server::connection::read_and_decompress_frame(size_t length, uint8_t flags)
 {
     if (flags & cql_frame_flags::compression) {
@@ -746,8 +901,11 @@ future<temporary_buffer<char>> cql_server::connection::read_and_decompress_frame
                 if (uncomp_len < 0) {
                     throw std::runtime_error("CQL frame uncompressed length is negative: " + std::to_string(uncomp_len));
                 }
+                if (size_t(uncomp_len) > _server._max_request_size) {
+                    throw exceptions::protocol_exception(sprint("CQL frame uncompressed length %d exceeds allowed maximum %d", uncomp_len, _server._max_request_size));
+                }
                 buf.trim_front(4);
-                temporary_buffer<char> uncomp{size_t(uncomp_len)};
+                auto uncomp = frame_buffer_pool::get(_frame_buffer_pool, size_t(uncomp_len));
                 const char* input = buf.get();
                 size_t input_len = buf.size();
                 char *output = uncomp.get_write();
@@ -756,6 +914,7 @@ future<temporary_buffer<char>> cql_server::connection::read_and_decompress_frame
                 if (ret < 0) {
                     throw std::runtime_error("CQL frame LZ4 uncompression failure");
                 }
+                uncomp.trim(ret);
                 return make_ready_future<temporary_buffer<char>>(std::move(uncomp));
             });
         } else if (_compression == cql_compression::snappy) {
@@ -766,12 +925,16 @@ future<temporary_buffer<char>> cql_server::connection::read_and_decompress_frame
                 if (snappy_uncompressed_length(input, input_len, &uncomp_len) != SNAPPY_OK) {
                     throw std::runtime_error("CQL frame Snappy uncompressed size is unknown");
                 }
-                temporary_buffer<char> uncomp{uncomp_len};
+                if (uncomp_len > _server._max_request_size) {
+                    throw exceptions::protocol_exception(sprint("CQL frame uncompressed length %d exceeds allowed maximum %d", uncomp_len, _server._max_request_size));
+                }
+                auto uncomp = frame_buffer_pool::get(_frame_buffer_pool, uncomp_len);
                 char *output = uncomp.get_write();
                 size_t output_len = uncomp_len;
                 if (snappy_uncompress(input, input_len, output, &output_len) != SNAPPY_OK) {
                     throw std::runtime_error("CQL frame Snappy uncompression failure");
                 }
+                uncomp.trim(output_len);
                 return make_ready_future<temporary_buffer<char>>(std::move(uncomp));
             });
         } else {
@@ -804,6 +967,13 @@ future<response_type> cql_server::connection::process_startup(uint16_t stream, b
              throw exceptions::protocol_exception(sprint("Unknown compression algorithm: %s", compression));
          }
     }
+    auto exec_info_opt = options.find("SCYLLA_REQUEST_EXECUTION_INFO");
+    if (exec_info_opt != options.end() && exec_info_opt->second == "true") {
+        if (_version < 4) {
+            throw exceptions::protocol_exception("SCYLLA_REQUEST_EXECUTION_INFO requires protocol version 4 (custom payloads)");
+        }
+        _exec_info_requested = true;
+    }
     auto& a = client_state.get_auth_service()->underlying_authenticator();
     if (a.require_authentication()) {
         return make_ready_future<response_type>(std::make_pair(make_autheticate(stream, a.qualified_java_name(), client_state.get_trace_state()), client_state));
@@ -846,6 +1016,7 @@ future<response_type> cql_server::connection::process_query(uint16_t stream, byt
     auto& query_state = q_state->query_state;
     q_state->options = read_options(buf);
     auto& options = *q_state->options;
+    options.set_scratch_arena(query_state.arena());
     auto skip_metadata = options.skip_metadata();
 
     // Count the number of unpaged queries
@@ -924,6 +1095,7 @@ future<response_type> cql_server::connection::process_execute(uint16_t stream, b
         q_state->options = read_options(buf);
     }
     auto& options = *q_state->options;
+    options.set_scratch_arena(query_state.arena());
     auto skip_metadata = options.skip_metadata();
     options.prepare(prepared->bound_names);
 
@@ -1022,6 +1194,7 @@ cql_server::connection::process_batch(uint16_t stream, bytes_view buf, service::
     // #563. CQL v2 encodes query_options in v1 format for batch requests.
     q_state->options = std::make_unique<cql3::query_options>(cql3::query_options::make_batch_options(std::move(*read_options(buf, _version < 3 ? 1 : _version)), std::move(values)));
     auto& options = *q_state->options;
+    options.set_scratch_arena(query_state.arena());
 
     tracing::set_consistency_level(client_state.get_trace_state(), options.get_consistency());
     tracing::set_optional_serial_consistency_level(client_state.get_trace_state(), options.get_serial_consistency());
@@ -1172,6 +1345,21 @@ shared_ptr<cql_server::response> cql_server::connection::make_supported(int16_t
     opts.insert({"CQL_VERSION", cql3::query_processor::CQL_VERSION});
     opts.insert({"COMPRESSION", "lz4"});
     opts.insert({"COMPRESSION", "snappy"});
+    // Scylla-specific extensions consumed by shard-aware drivers. Together
+    // they describe the static partition-to-shard mapping; a driver keeps
+    // opening connections until it holds one per shard (SCYLLA_SHARD tells
+    // it which shard each connection landed on) and then routes every
+    // statement to the shard owning its partition, avoiding the cross-shard
+    // hop in storage_proxy for single-partition requests.
+    auto& partitioner = dht::global_partitioner();
+    opts.insert({"SCYLLA_SHARD", sprint("%d", engine().cpu_id())});
+    opts.insert({"SCYLLA_NR_SHARDS", sprint("%d", partitioner.shard_count())});
+    opts.insert({"SCYLLA_PARTITIONER", partitioner.name()});
+    opts.insert({"SCYLLA_SHARDING_ALGORITHM", "biased-token-round-robin"});
+    opts.insert({"SCYLLA_SHARDING_IGNORE_MSB", sprint("%d", partitioner.sharding_ignore_msb())});
+    // Per-request execution breakdown in response custom payloads; see
+    // process_startup().
+    opts.insert({"SCYLLA_REQUEST_EXECUTION_INFO", "true"});
     auto response = make_shared<cql_server::response>(stream, cql_binary_opcode::SUPPORTED, tr_state);
     response->write_string_multimap(opts);
     return response;
@@ -1223,6 +1411,14 @@ public:
 
     virtual void visit(const messages::result_message::rows& m) override {
         _response->write_int(0x0002);
+        if (auto&& generator = m.generator()) {
+            // Fused path: serialize straight from query::result, without
+            // materializing the page as a cql3::result_set first.
+            _response->write(m.get_metadata(), _skip_metadata);
+            _response->write_int(generator->row_count());
+            generator->visit(*_response);
+            return;
+        }
         auto& rs = m.rs();
         _response->write(rs.get_metadata(), _skip_metadata);
         _response->write_int(rs.size());
@@ -1274,10 +1470,18 @@ cql_server::connection::make_schema_change_event(const event::schema_change& eve
 
 future<> cql_server::connection::write_response(foreign_ptr<shared_ptr<cql_server::response>>&& response, cql_compression compression)
 {
+    ++_pending_response_writes;
     _ready_to_respond = _ready_to_respond.then([this, compression, response = std::move(response)] () mutable {
         return do_with(std::move(response), [this, compression] (auto& response) {
-            return response->output(_write_buf, _version, compression).then([this] {
-                return _write_buf.flush();
+            return response->output(_write_buf, _version, compression).finally([this] {
+                --_pending_response_writes;
+            }).then([this] {
+                // Flush only if no further responses are queued behind this
+                // one; they will reuse the buffered bytes and flush for us.
+                if (_pending_response_writes == 0) {
+                    return _write_buf.flush();
+                }
+                return make_ready_future<>();
             });
         });
     });
@@ -1775,6 +1979,35 @@ void cql_server::response::write_string_map(std::map<sstring, sstring> string_ma
     }
 }
 
+// Prepends a v4 custom payload ([bytes map]) to an already built response.
+// The payload sits between the tracing id (if any) and the message body, so
+// it has to be spliced in rather than appended; the copy this costs is only
+// paid by connections which opted into it.
+void cql_server::response::add_custom_payload(const std::map<sstring, sstring>& payload)
+{
+    std::vector<char> map_body;
+    auto write_be16 = [&map_body] (uint16_t n) {
+        uint16_t u = htons(n);
+        auto* s = reinterpret_cast<const char*>(&u);
+        map_body.insert(map_body.end(), s, s + sizeof(u));
+    };
+    auto write_be32 = [&map_body] (int32_t n) {
+        int32_t u = htonl(n);
+        auto* s = reinterpret_cast<const char*>(&u);
+        map_body.insert(map_body.end(), s, s + sizeof(u));
+    };
+    write_be16(cast_if_fits<uint16_t>(payload.size()));
+    for (auto&& kv : payload) {
+        write_be16(cast_if_fits<uint16_t>(kv.first.size()));
+        map_body.insert(map_body.end(), kv.first.begin(), kv.first.end());
+        write_be32(cast_if_fits<int32_t>(kv.second.size()));
+        map_body.insert(map_body.end(), kv.second.begin(), kv.second.end());
+    }
+    auto offset = (_flags & cql_frame_flags::tracing) ? utils::UUID::serialized_size() : 0;
+    _body.insert(_body.begin() + offset, map_body.begin(), map_body.end());
+    set_frame_flag(cql_frame_flags::custom_payload);
+}
+
 void cql_server::response::write_string_multimap(std::multimap<sstring, sstring> string_map)
 {
     std::vector<sstring> keys;
@@ -1804,6 +2037,17 @@ void cql_server::response::write_value(bytes_opt value)
     _body.insert(_body.end(), value->begin(), value->end());
 }
 
+void cql_server::response::write_value(std::experimental::optional<bytes_view> value)
+{
+    if (!value) {
+        write_int(-1);
+        return;
+    }
+
+    write_int(value->size());
+    _body.insert(_body.end(), value->begin(), value->end());
+}
+
 class type_codec {
 private:
     enum class type_id : int16_t {
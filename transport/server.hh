@@ -53,8 +53,9 @@ enum class cql_compression {
 };
 
 enum cql_frame_flags {
-    compression = 0x01,
-    tracing     = 0x02,
+    compression    = 0x01,
+    tracing        = 0x02,
+    custom_payload = 0x04, // protocol v4 and later only
 };
 
 struct [[gnu::packed]] cql_binary_frame_v1 {
@@ -119,8 +120,33 @@ private:
     uint64_t _unpaged_queries = 0;
     uint64_t _requests_serving = 0;
     uint64_t _requests_blocked_memory = 0;
+    uint64_t _requests_shed = 0;
     cql_load_balance _lb;
     auth::service& _auth_service;
+
+    // Tracks this shard's recent request service rate so that admission
+    // control can estimate, via Little's law, how long a newly arrived
+    // request would wait behind the requests already in flight (see
+    // connection::process_request()).
+    class admission_controller {
+        uint64_t _completed = 0;
+        uint64_t _completed_at_tick = 0;
+        lowres_clock::time_point _tick = lowres_clock::now();
+        double _rate = 0; // completions per millisecond, smoothed
+        static lowres_clock::duration tick_period() { return std::chrono::milliseconds(100); }
+    public:
+        void register_completion();
+        // Estimated time, in milliseconds, a new request would spend queued
+        // behind in_flight requests. Zero until a service rate is known.
+        double estimated_delay_ms(uint64_t in_flight) const {
+            return _rate ? in_flight / _rate : 0;
+        }
+    };
+    admission_controller _admission;
+    // Estimated queueing delay beyond which data requests are shed; writes
+    // and small requests get twice this. Initialized from the read request
+    // timeout: anything queued longer than that fails anyway.
+    uint32_t _max_estimated_delay_ms;
 public:
     cql_server(distributed<service::storage_proxy>& proxy, distributed<cql3::query_processor>& qp, cql_load_balance lb, auth::service&);
     future<> listen(ipv4_addr addr, std::shared_ptr<seastar::tls::credentials_builder> = {}, bool keepalive = false);
@@ -155,9 +181,20 @@ private:
         output_stream<char> _write_buf;
         seastar::gate _pending_requests_gate;
         future<> _ready_to_respond = make_ready_future<>();
+        // Number of responses queued on _ready_to_respond but not yet
+        // written out. Used to coalesce flushes: only the last queued
+        // response flushes the socket, so responses completing in the same
+        // reactor poll share one syscall and one TCP segment where possible.
+        size_t _pending_response_writes = 0;
         cql_protocol_version_type _version = 0;
         cql_compression _compression = cql_compression::none;
         cql_serialization_format _cql_serialization_format = cql_serialization_format::latest();
+        // Set from the SCYLLA_REQUEST_EXECUTION_INFO STARTUP option (v4 and
+        // later). When on, every QUERY/EXECUTE/BATCH response carries a
+        // custom payload with the coordinator-side breakdown of where the
+        // request spent its time, so client-side tracing can attribute
+        // latency without enabling server tracing.
+        bool _exec_info_requested = false;
         service::client_state _client_state;
         std::unordered_map<uint16_t, cql_query_state> _query_states;
         unsigned _request_cpu = 0;
@@ -167,6 +204,30 @@ private:
             no_write_on_close,
             write_on_close
         };
+
+        // Pool of decompression output buffers, reused across the frames in
+        // flight on this connection so compressed frames do not pay an
+        // allocation each (see read_and_decompress_frame()). Buffers grow on
+        // demand and ones no recent frame was large enough to need are
+        // dropped again. The pool is shared with the buffers handed out, so
+        // it may safely outlive the connection.
+        class frame_buffer_pool {
+            struct buffer {
+                std::unique_ptr<char[]> data;
+                size_t capacity = 0;
+            };
+            static constexpr unsigned max_buffers = 8;
+            static constexpr unsigned shrink_interval = 1024;
+            std::vector<buffer> _free;
+            size_t _recent_max_size = 0;
+            unsigned _frames = 0;
+            void put(buffer b);
+        public:
+            // Returns a buffer of exactly `size` usable bytes which gives
+            // its storage back to the pool on destruction.
+            static temporary_buffer<char> get(lw_shared_ptr<frame_buffer_pool> pool, size_t size);
+        };
+        lw_shared_ptr<frame_buffer_pool> _frame_buffer_pool = make_lw_shared<frame_buffer_pool>();
     public:
         connection(cql_server& server, ipv4_addr server_addr, connected_socket&& fd, socket_address addr);
         ~connection();
@@ -175,7 +236,7 @@ private:
         future<> shutdown();
     private:
         friend class process_request_executor;
-        future<processing_result> process_request_one(bytes_view buf, uint8_t op, uint16_t stream, service::client_state client_state, tracing_request_type tracing_request);
+        future<processing_result> process_request_one(bytes_view buf, uint8_t op, uint16_t stream, service::client_state client_state, tracing_request_type tracing_request, std::chrono::steady_clock::time_point arrival);
         unsigned frame_size() const;
         unsigned pick_request_cpu();
         void update_client_state(processing_result& r);
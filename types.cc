@@ -43,10 +43,10 @@
 #include <boost/range/numeric.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/date_time/c_local_time_adjustor.hpp>
-#include <boost/locale/encoding_utf.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/algorithm/cxx11/any_of.hpp>
 #include "utils/big_decimal.hh"
+#include "utils/utf8.hh"
 #include "utils/date.h"
 #include "mutation_partition.hh"
 
@@ -321,10 +321,8 @@ struct string_type_impl : public concrete_type<sstring> {
                 throw marshal_exception("Validation failed - non-ASCII character in an ASCII string");
             }
         } else {
-            try {
-                boost::locale::conv::utf_to_utf<char>(v.begin(), v.end(), boost::locale::conv::stop);
-            } catch (const boost::locale::conv::conversion_error& ex) {
-                throw marshal_exception(ex.what());
+            if (!utils::utf8::validate(reinterpret_cast<const uint8_t*>(v.data()), v.size())) {
+                throw marshal_exception("Validation failed - non-UTF8 string");
             }
         }
     }
@@ -2367,8 +2365,59 @@ collection_type_impl::serialize_mutation_form_only_live(mutation_view mut, gc_cl
     }));
 }
 
+// Fast path for the common case of element-wise updates landing at the end of
+// an existing collection (list appends, map/set inserts with monotonically
+// growing keys): when neither side carries a collection tombstone and all of
+// b's cells sort strictly after a's last cell, the merged serialized form is
+// simply a's cells followed by b's, so the two buffers can be spliced with
+// bulk copies instead of deserializing and reserializing every cell of the
+// large side.
+static stdx::optional<collection_mutation>
+try_splice_append(const data_type& key_type, collection_mutation_view a, collection_mutation_view b) {
+    auto av = a.data;
+    auto bv = b.data;
+    if (read_simple<bool>(av) || read_simple<bool>(bv)) {
+        return stdx::nullopt;
+    }
+    auto na = read_simple<uint32_t>(av);
+    auto nb = read_simple<uint32_t>(bv);
+    if (!na || !nb) {
+        return stdx::nullopt;
+    }
+    // Hop over a's length-prefixed cells to find its last key. Unlike
+    // deserialize_mutation_form() this materializes no cell views and
+    // allocates nothing.
+    bytes_view last_key;
+    auto in = av;
+    for (uint32_t i = 0; i != na; ++i) {
+        auto ksize = read_simple<uint32_t>(in);
+        last_key = read_simple_bytes(in, ksize);
+        auto vsize = read_simple<uint32_t>(in);
+        in.remove_prefix(vsize);
+    }
+    auto bin = bv;
+    auto ksize = read_simple<uint32_t>(bin);
+    auto first_key = read_simple_bytes(bin, ksize);
+    // Strictly less: an equal key needs a proper cell merge.
+    if (!key_type->less(last_key, first_key)) {
+        return stdx::nullopt;
+    }
+    // Both sides are serialized in key order, so the result is too.
+    bytes ret(bytes::initialized_later(), 1 + 4 + av.size() + bv.size());
+    bytes::iterator out = ret.begin();
+    *out++ = false;
+    // FIXME: overflow?
+    serialize_int32(out, na + nb);
+    out = std::copy_n(av.begin(), av.size(), out);
+    std::copy_n(bv.begin(), bv.size(), out);
+    return collection_mutation{std::move(ret)};
+}
+
 collection_mutation
 collection_type_impl::merge(collection_mutation_view a, collection_mutation_view b) const {
+    if (auto spliced = try_splice_append(name_comparator(), a, b)) {
+        return std::move(*spliced);
+    }
     auto aa = deserialize_mutation_form(a);
     auto bb = deserialize_mutation_form(b);
     mutation_view merged;
@@ -74,12 +74,26 @@ public:
     // This matches Java's UUID.toString() actual implementation. Note that
     // that method's documentation suggest something completely different!
     sstring to_sstring() const {
-        return sprint("%08x-%04x-%04x-%04x-%012x",
-                ((uint64_t)most_sig_bits >> 32),
-                ((uint64_t)most_sig_bits >> 16 & 0xffff),
-                ((uint64_t)most_sig_bits & 0xffff),
-                ((uint64_t)least_sig_bits >> 48 & 0xffff),
-                ((uint64_t)least_sig_bits & 0xffffffffffffLL));
+        // Common enough on the CQL text paths to warrant formatting by hand
+        // instead of going through sprint().
+        const char* digits = "0123456789abcdef";
+        sstring ret(sstring::initialized_later(), 36);
+        auto out = ret.begin();
+        auto put = [&out, digits] (uint64_t v, unsigned nibbles) {
+            while (nibbles--) {
+                *out++ = digits[(v >> (nibbles * 4)) & 0xf];
+            }
+        };
+        put((uint64_t)most_sig_bits >> 32, 8);
+        *out++ = '-';
+        put((uint64_t)most_sig_bits >> 16, 4);
+        *out++ = '-';
+        put((uint64_t)most_sig_bits, 4);
+        *out++ = '-';
+        put((uint64_t)least_sig_bits >> 48, 4);
+        *out++ = '-';
+        put((uint64_t)least_sig_bits, 12);
+        return ret;
     }
 
     friend std::ostream& operator<<(std::ostream& out, const UUID& uuid);
@@ -88,6 +88,53 @@ bool bloom_filter::is_present(const bytes_view& key) {
     return is_present(make_hashed_key(key));
 }
 
+blocked_bloom_filter::blocked_bloom_filter(int hashes, bitmap&& bs)
+        : _bitset(std::move(bs))
+        , _hash_count(hashes)
+        , _num_blocks(_bitset.size() / block_bits) {
+}
+
+// All probes for a key live in the block picked by h[0]; within the block
+// the probe offsets are derived the same double-hashing way as in
+// for_each_index(), but modulo the block size, so they stay in one cache
+// line.
+template<typename Func>
+static void for_each_block_index(hashed_key hk, int count, int64_t num_blocks, Func&& func) {
+    auto h = hk.hash();
+    const int64_t block = std::abs(int64_t(h[0]) % num_blocks) * blocked_bloom_filter::block_bits;
+    uint64_t base = h[0];
+    const uint64_t inc = h[1];
+    for (int i = 0; i < count; i++) {
+        base += inc;
+        if (func(block + int64_t(base % blocked_bloom_filter::block_bits)) == stop_iteration::yes) {
+            break;
+        }
+    }
+}
+
+bool blocked_bloom_filter::is_present(hashed_key key) {
+    bool result = true;
+    for_each_block_index(key, _hash_count, _num_blocks, [this, &result] (auto i) {
+        if (!_bitset.test(i)) {
+            result = false;
+            return stop_iteration::yes;
+        }
+        return stop_iteration::no;
+    });
+    return result;
+}
+
+void blocked_bloom_filter::add(const bytes_view& key) {
+    for_each_block_index(make_hashed_key(key), _hash_count, _num_blocks, [this] (auto i) {
+        _bitset.set(i);
+        return stop_iteration::no;
+    });
+}
+
+bool blocked_bloom_filter::is_present(const bytes_view& key) {
+    return is_present(make_hashed_key(key));
+}
+
 filter_ptr create_filter(int hash, large_bitset&& bitset) {
     return std::make_unique<murmur3_bloom_filter>(hash, std::move(bitset));
 }
@@ -98,5 +145,16 @@ filter_ptr create_filter(int hash, int64_t num_elements, int buckets_per) {
     large_bitset bitset(num_bits);
     return std::make_unique<murmur3_bloom_filter>(hash, std::move(bitset));
 }
+
+filter_ptr create_blocked_filter(int hash, large_bitset&& bitset) {
+    return std::make_unique<blocked_bloom_filter>(hash, std::move(bitset));
+}
+
+filter_ptr create_blocked_filter(int hash, int64_t num_elements, int buckets_per) {
+    int64_t num_bits = (num_elements * buckets_per) + bloom_calculations::EXCESS;
+    num_bits = align_up<int64_t>(num_bits, blocked_bloom_filter::block_bits);
+    large_bitset bitset(num_bits);
+    return std::make_unique<blocked_bloom_filter>(hash, std::move(bitset));
+}
 }
 }
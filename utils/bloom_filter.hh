@@ -88,6 +88,42 @@ struct murmur3_bloom_filter: public bloom_filter {
 
 };
 
+// Register-blocked variant: the first hash selects a 512-bit block (one
+// cache line of the bitmap), and all k probes address bits within it. A
+// negative lookup therefore touches a single cache line instead of up to
+// k of them. See i_filter.hh's filter_format for the trade-off.
+class blocked_bloom_filter: public i_filter {
+public:
+    using bitmap = large_bitset;
+    static constexpr int64_t block_bits = 512;
+
+private:
+    bitmap _bitset;
+    int _hash_count;
+    int64_t _num_blocks;
+public:
+    int num_hashes() { return _hash_count; }
+    bitmap& bits() { return _bitset; }
+
+    blocked_bloom_filter(int hashes, bitmap&& bs);
+
+    virtual void add(const bytes_view& key) override;
+
+    virtual bool is_present(const bytes_view& key) override;
+
+    virtual bool is_present(hashed_key key) override;
+
+    virtual void clear() override {
+        _bitset.clear();
+    }
+
+    virtual void close() override { }
+
+    virtual size_t memory_size() override {
+        return sizeof(_hash_count) + sizeof(_num_blocks) + _bitset.memory_size();
+    }
+};
+
 struct always_present_filter: public i_filter {
 
     virtual bool is_present(const bytes_view& key) override {
@@ -111,5 +147,7 @@ struct always_present_filter: public i_filter {
 
 filter_ptr create_filter(int hash, large_bitset&& bitset);
 filter_ptr create_filter(int hash, int64_t num_elements, int buckets_per);
+filter_ptr create_blocked_filter(int hash, large_bitset&& bitset);
+filter_ptr create_blocked_filter(int hash, int64_t num_elements, int buckets_per);
 }
 }
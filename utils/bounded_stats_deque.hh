@@ -49,6 +49,7 @@ class bounded_stats_deque {
 private:
     std::deque<long> _deque;
     long _sum = 0;
+    long _sum_of_squares = 0;
     int _max_size;
 public:
     bounded_stats_deque(int size)
@@ -64,9 +65,11 @@ public:
             auto removed = _deque.front();
             _deque.pop_front();
             _sum -= removed;
+            _sum_of_squares -= removed * removed;
         }
         _deque.push_back(i);
         _sum += i;
+        _sum_of_squares += i * i;
     }
 
     long sum() {
@@ -77,6 +80,14 @@ public:
         return size() > 0 ? ((double) sum()) / size() : 0;
     }
 
+    double variance() {
+        if (size() == 0) {
+            return 0;
+        }
+        auto m = mean();
+        return ((double) _sum_of_squares) / size() - m * m;
+    }
+
     const std::deque<long>& deque() const {
         return _deque;
     }
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace utils {
+
+// A simple bump allocator for short-lived scratch memory which all shares
+// one lifetime, e.g. the temporaries created while executing a single
+// request. Allocation is a pointer bump within the current chunk; there is
+// no per-object deallocation, everything is released at once when the arena
+// is destroyed. This removes matched malloc()/free() pairs from hot paths
+// and keeps related temporaries adjacent in memory.
+//
+// Objects placed in the arena must not require their destructor to run.
+class bump_arena {
+    static constexpr size_t chunk_size = 8 * 1024;
+private:
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    char* _pos = nullptr;
+    char* _end = nullptr;
+private:
+    void* alloc_slow(size_t size, size_t align) {
+        if (size + align > chunk_size) {
+            // Oversized allocations get a chunk of their own, leaving the
+            // current chunk to keep serving small ones.
+            _chunks.emplace_back(std::make_unique<char[]>(size + align));
+            auto p = reinterpret_cast<uintptr_t>(_chunks.back().get());
+            return reinterpret_cast<void*>((p + align - 1) & ~uintptr_t(align - 1));
+        }
+        _chunks.emplace_back(std::make_unique<char[]>(chunk_size));
+        _pos = _chunks.back().get();
+        _end = _pos + chunk_size;
+        return alloc(size, align);
+    }
+public:
+    bump_arena() = default;
+    bump_arena(bump_arena&&) = default;
+    bump_arena& operator=(bump_arena&&) = default;
+    bump_arena(const bump_arena&) = delete;
+    bump_arena& operator=(const bump_arena&) = delete;
+
+    // align must be a power of two.
+    void* alloc(size_t size, size_t align = alignof(std::max_align_t)) {
+        auto pad = (align - reinterpret_cast<uintptr_t>(_pos) % align) % align;
+        if (static_cast<size_t>(_end - _pos) < pad + size) {
+            return alloc_slow(size, align);
+        }
+        auto p = _pos + pad;
+        _pos = p + size;
+        return p;
+    }
+};
+
+}
@@ -165,6 +165,19 @@ public:
             make_room(n);
         }
     }
+    // Prepares for an eventual size of n elements without committing all
+    // of their storage up front. The chunk pointer vector is sized for the
+    // final chunk count and the first chunk is allocated at full size, so
+    // subsequent growth never migrates existing elements; the remaining
+    // chunks are still allocated one at a time as elements are appended.
+    // Useful when n is a hint or an upper bound that may not be reached.
+    void reserve_partial(size_t n) {
+        auto eager = std::min(n, max_chunk_capacity());
+        if (eager > _capacity) {
+            make_room(eager);
+        }
+        _chunks.reserve((n + max_chunk_capacity() - 1) / max_chunk_capacity());
+    }
 public:
     template <class ValueType>
     class iterator_type {
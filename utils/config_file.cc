@@ -329,10 +329,38 @@ future<> utils::config_file::read_from_file(file f, error_handler h) {
 }
 
 future<> utils::config_file::read_from_file(const sstring& filename, error_handler h) {
+    _read_from = filename;
     return open_file_dma(filename, open_flags::ro).then([this, h](file f) {
        return read_from_file(std::move(f), h);
     });
 }
 
+std::vector<sstring> utils::config_file::apply_live_values(const config_file& other,
+        std::function<bool(const config_src&)> filter) {
+    std::unordered_map<stdx::string_view, const config_src*> theirs;
+    for (const config_src& c : other._cfgs) {
+        theirs.emplace(c.name(), &c);
+    }
+    // An option absent from the new file keeps its current value; we do not
+    // revert removed options to their defaults.
+    std::vector<sstring> applied;
+    for (config_src& c : _cfgs) {
+        auto i = theirs.find(c.name());
+        if (i == theirs.end()) {
+            continue;
+        }
+        auto& o = *i->second;
+        if (o.source() == config_source::None || !c.live_updatable() || c.same_value(o)) {
+            continue;
+        }
+        if (filter && !filter(c)) {
+            continue;
+        }
+        c.copy_value_from(o);
+        applied.emplace_back(sstring(c.name().begin(), c.name().end()));
+    }
+    return applied;
+}
+
 
 
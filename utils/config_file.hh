@@ -24,6 +24,7 @@
 
 #include <unordered_map>
 #include <iosfwd>
+#include <type_traits>
 #include <experimental/string_view>
 
 #include <boost/program_options.hpp>
@@ -81,6 +82,15 @@ public:
         virtual void set_value(const YAML::Node&) = 0;
         virtual value_status status() const = 0;
         virtual config_source source() const = 0;
+
+        // Whether the value may be replaced at runtime through
+        // apply_live_values(). Only trivially copyable values qualify:
+        // those can be rewritten in place without a reader ever observing
+        // a torn or dangling value, provided the write happens on the
+        // shard owning this config instance.
+        virtual bool live_updatable() const = 0;
+        virtual bool same_value(const config_src&) const = 0;
+        virtual void copy_value_from(const config_src&) = 0;
     };
 
     template<typename T, value_status S = value_status::Used>
@@ -90,6 +100,15 @@ public:
         stdx::string_view _name, _desc;
         T _value = T();
         config_source _source = config_source::None;
+
+        template<typename U = T>
+        std::enable_if_t<std::is_trivially_copyable<U>::value, bool> compare_value(const T& other) const {
+            return _value == other;
+        }
+        template<typename U = T>
+        std::enable_if_t<!std::is_trivially_copyable<U>::value, bool> compare_value(const T&) const {
+            return false;
+        }
     public:
         typedef T type;
         typedef named_value<T, S> MyType;
@@ -125,6 +144,20 @@ public:
             return _value;
         }
 
+        bool live_updatable() const override {
+            return S == value_status::Used && std::is_trivially_copyable<T>::value;
+        }
+        bool same_value(const config_src& other) const override {
+            return compare_value(static_cast<const MyType&>(other)._value);
+        }
+        void copy_value_from(const config_src& other) override {
+            auto& typed = static_cast<const MyType&>(other);
+            _value = typed._value;
+            if (typed._source > _source) {
+                _source = typed._source;
+            }
+        }
+
         void add_command_line_option(bpo::options_description_easy_init&,
                         const stdx::string_view&, const stdx::string_view&) override;
         void set_value(const YAML::Node&) override;
@@ -163,13 +196,36 @@ public:
     future<> read_from_file(const sstring&, error_handler = {});
     future<> read_from_file(file, error_handler = {});
 
+    /**
+     * Applies the values of `other` which are set there, differ from ours,
+     * are live_updatable() and pass `filter` (everything, if unset).
+     * Must run on the shard owning this instance, so the in-place writes
+     * cannot race with readers. Returns the names of the applied options.
+     */
+    std::vector<sstring> apply_live_values(const config_file& other,
+            std::function<bool(const config_src&)> filter = {});
+
+    /** The file values were last read from with read_from_file(), if any. */
+    const stdx::optional<sstring>& read_from() const {
+        return _read_from;
+    }
+
     using configs = std::vector<cfg_ref>;
 
     configs set_values() const;
     configs unset_values() const;
+
+    configs& values() {
+        return _cfgs;
+    }
+    const configs& values() const {
+        return _cfgs;
+    }
 private:
     configs
         _cfgs;
+protected:
+    stdx::optional<sstring> _read_from;
 };
 
 }
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/cpu_profiler.hh"
+#include "log.hh"
+
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <system_error>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace utils {
+
+static logging::logger proflog("cpu_profiler");
+
+// All state is per-thread, so no synchronization with other shards is
+// needed. The signal handler only touches _current and _samples; the
+// counters are lock-free atomics, which keeps the handler
+// async-signal-safe.
+static thread_local cpu_profiler::component _current = cpu_profiler::component::other;
+static thread_local std::array<std::atomic<uint64_t>, cpu_profiler::num_components> _samples = {};
+static thread_local timer_t _sample_timer;
+static thread_local bool _running = false;
+
+static void sample_handler(int, siginfo_t*, void*) {
+    _samples[unsigned(_current)].fetch_add(1, std::memory_order_relaxed);
+}
+
+static int profiler_signal() {
+    return SIGRTMIN + 4;
+}
+
+cpu_profiler::scope::scope(component c) noexcept
+        : _prev(_current) {
+    _current = c;
+}
+
+cpu_profiler::scope::~scope() {
+    _current = _prev;
+}
+
+void cpu_profiler::start(std::chrono::microseconds period) {
+    if (_running) {
+        return;
+    }
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = sample_handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(profiler_signal(), &sa, nullptr) < 0) {
+        throw std::system_error(errno, std::system_category(), "cpu_profiler: sigaction");
+    }
+    // A timer on the thread's CPU-time clock, delivering the signal to this
+    // thread only, so samples land on the reactor they describe.
+    struct sigevent sev;
+    std::memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = profiler_signal();
+    sev.sigev_notify_thread_id = syscall(SYS_gettid);
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &_sample_timer) < 0) {
+        throw std::system_error(errno, std::system_category(), "cpu_profiler: timer_create");
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(period).count();
+    struct itimerspec its;
+    std::memset(&its, 0, sizeof(its));
+    its.it_interval.tv_sec = ns / 1000000000;
+    its.it_interval.tv_nsec = ns % 1000000000;
+    its.it_value = its.it_interval;
+    if (timer_settime(_sample_timer, 0, &its, nullptr) < 0) {
+        auto err = errno;
+        timer_delete(_sample_timer);
+        throw std::system_error(err, std::system_category(), "cpu_profiler: timer_settime");
+    }
+    _running = true;
+    proflog.info("sampling every {}us of consumed CPU time", period.count());
+}
+
+void cpu_profiler::stop() {
+    if (!_running) {
+        return;
+    }
+    timer_delete(_sample_timer);
+    _running = false;
+    proflog.info("stopped");
+}
+
+bool cpu_profiler::is_running() {
+    return _running;
+}
+
+std::array<uint64_t, cpu_profiler::num_components> cpu_profiler::shard_samples() {
+    std::array<uint64_t, num_components> counts;
+    for (unsigned i = 0; i < num_components; i++) {
+        counts[i] = _samples[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+const char* cpu_profiler::component_name(component c) {
+    switch (c) {
+    case component::other: return "other";
+    case component::cql_transport: return "cql_transport";
+    case component::coordinator_read: return "coordinator_read";
+    case component::coordinator_write: return "coordinator_write";
+    default: return "unknown";
+    }
+}
+
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace utils {
+
+// A lightweight sampling CPU profiler.
+//
+// When started, the calling thread arms a POSIX timer on its own CPU-time
+// clock which delivers a signal for every period of CPU time the thread
+// consumes. The signal handler attributes the sample to whatever component
+// the thread has declared itself to be working on (see cpu_profiler::scope),
+// so the per-component sample counts approximate how the shard's CPU time
+// is split between subsystems. An idle thread consumes no CPU time and
+// takes no signals, so the cost is proportional to the actual load and is
+// negligible at the default period, allowing the profiler to stay enabled
+// in production.
+//
+// Scopes only cover the synchronous sections they are placed around;
+// continuations scheduled from within a scope run as "other". This is good
+// enough to attribute the request parsing and coordination paths, which is
+// what the scopes currently mark.
+class cpu_profiler {
+public:
+    enum class component : unsigned {
+        other = 0,          // anything not covered by a scope
+        cql_transport,      // CQL frame parsing and request dispatch
+        coordinator_read,   // storage_proxy read coordination
+        coordinator_write,  // storage_proxy write coordination
+        NUM_COMPONENTS
+    };
+    static constexpr unsigned num_components = unsigned(component::NUM_COMPONENTS);
+
+    // Attributes the current synchronous execution section to a component.
+    // Scopes nest; the enclosing component is restored on destruction.
+    class scope {
+        component _prev;
+    public:
+        explicit scope(component c) noexcept;
+        ~scope();
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+    };
+
+    // Starts sampling on the calling shard. A no-op if already running.
+    static void start(std::chrono::microseconds period);
+    // Stops sampling on the calling shard. Collected counts are retained.
+    static void stop();
+    static bool is_running();
+    // Samples collected on the calling shard since start, per component.
+    static std::array<uint64_t, num_components> shard_samples();
+    static const char* component_name(component c);
+};
+
+}
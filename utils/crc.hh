@@ -36,6 +36,14 @@
 
 namespace utils {
 
+#if defined(__x86_64__) || defined(__i386__)
+namespace internal {
+// Bulk CRC-32C of a buffer, running the crc32 instruction on three
+// independent streams to hide its latency. Defined in crc.cc.
+uint32_t crc32c_process(uint32_t crc, const uint8_t* in, size_t size);
+}
+#endif
+
 class crc32 {
     uint32_t _r = 0;
 public:
@@ -76,40 +84,7 @@ public:
     }
 
     void process(const uint8_t* in, size_t size) {
-        if ((reinterpret_cast<uintptr_t>(in) & 1) && size >= 1) {
-            process_le(*in);
-            ++in;
-            --size;
-        }
-        if ((reinterpret_cast<uintptr_t>(in) & 3) && size >= 2) {
-            process_le(*reinterpret_cast<const uint16_t*>(in));
-            in += 2;
-            size -= 2;
-        }
-        if ((reinterpret_cast<uintptr_t>(in) & 7) && size >= 4) {
-            process_le(*reinterpret_cast<const uint32_t*>(in));
-            in += 4;
-            size -= 4;
-        }
-        // FIXME: do in three parallel loops
-        while (size >= 8) {
-            process_le(*reinterpret_cast<const uint64_t*>(in));
-            in += 8;
-            size -= 8;
-        }
-        if (size >= 4) {
-            process_le(*reinterpret_cast<const uint32_t*>(in));
-            in += 4;
-            size -= 4;
-        }
-        if (size >= 2) {
-            process_le(*reinterpret_cast<const uint16_t*>(in));
-            in += 2;
-            size -= 2;
-        }
-        if (size >= 1) {
-            process_le(*in);
-        }
+        _r = internal::crc32c_process(_r, in, size);
     }
 #elif defined(__PPC64__)
     uint32_t crc32_vpmsum(uint32_t crc, const uint8_t* p, size_t len);
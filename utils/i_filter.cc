@@ -27,7 +27,13 @@
 namespace utils {
 static logging::logger filterlog("bloom_filter");
 
-filter_ptr i_filter::get_filter(int64_t num_elements, double max_false_pos_probability) {
+static filter_ptr make_filter(int hash, int64_t num_elements, int buckets_per, filter_format format) {
+    return format == filter_format::blocked
+            ? filter::create_blocked_filter(hash, num_elements, buckets_per)
+            : filter::create_filter(hash, num_elements, buckets_per);
+}
+
+filter_ptr i_filter::get_filter(int64_t num_elements, double max_false_pos_probability, filter_format format) {
     if (max_false_pos_probability > 1.0) {
         throw std::invalid_argument(sprint("Invalid probability %f: must be lower than 1.0", max_false_pos_probability));
     }
@@ -38,10 +44,10 @@ filter_ptr i_filter::get_filter(int64_t num_elements, double max_false_pos_proba
 
     int buckets_per_element = bloom_calculations::max_buckets_per_element(num_elements);
     auto spec = bloom_calculations::compute_bloom_spec(buckets_per_element, max_false_pos_probability);
-    return filter::create_filter(spec.K, num_elements, spec.buckets_per_element);
+    return make_filter(spec.K, num_elements, spec.buckets_per_element, format);
 }
 
-filter_ptr i_filter::get_filter(int64_t num_elements, int target_buckets_per_elem) {
+filter_ptr i_filter::get_filter(int64_t num_elements, int target_buckets_per_elem, filter_format format) {
     int max_buckets_per_element = std::max(1, bloom_calculations::max_buckets_per_element(num_elements));
     int buckets_per_element = std::min(target_buckets_per_elem, max_buckets_per_element);
 
@@ -49,7 +55,7 @@ filter_ptr i_filter::get_filter(int64_t num_elements, int target_buckets_per_ele
         filterlog.warn("Cannot provide an optimal bloom_filter for {} elements ({}/{} buckets per element).", num_elements, buckets_per_element, target_buckets_per_elem);
     }
     auto spec = bloom_calculations::compute_bloom_spec(buckets_per_element);
-    return filter::create_filter(spec.K, num_elements, spec.buckets_per_element);
+    return make_filter(spec.K, num_elements, spec.buckets_per_element, format);
 }
 
 hashed_key make_hashed_key(bytes_view b) {
@@ -48,6 +48,18 @@ namespace utils {
 struct i_filter;
 using filter_ptr = std::unique_ptr<i_filter>;
 
+// Layout of the filter's bit set:
+//  - partitioned: the classic filter; each of the k probes can touch a
+//    different cache line.
+//  - blocked: all k probes fall into a single 512-bit (cache line) block
+//    selected by the first hash, so a negative lookup costs one miss
+//    instead of up to k, at the price of a slightly higher false positive
+//    rate for the same size.
+enum class filter_format {
+    partitioned,
+    blocked,
+};
+
 class hashed_key {
 private:
     std::array<uint64_t, 2> _hash;
@@ -78,11 +90,13 @@ struct i_filter {
      *         Asserts that the given probability can be satisfied using this
      *         filter.
      */
-    static filter_ptr get_filter(int64_t num_elements, double max_false_pos_prob);
+    static filter_ptr get_filter(int64_t num_elements, double max_false_pos_prob,
+            filter_format format = filter_format::partitioned);
     /**
      * @return A bloom_filter with the lowest practical false positive
      *         probability for the given number of elements.
      */
-    static filter_ptr get_filter(int64_t num_elements, int target_buckets_per_elem);
+    static filter_ptr get_filter(int64_t num_elements, int target_buckets_per_elem,
+            filter_format format = filter_format::partitioned);
 };
 }
@@ -55,6 +55,7 @@ private:
     loading_cache_clock_type::time_point _last_read;
     lru_entry* _lru_entry_ptr = nullptr; /// MRU item is at the front, LRU - at the back
     size_t _size = 0;
+    bool _reload_in_progress = false;
 
 public:
     timestamped_val(value_type val)
@@ -95,10 +96,27 @@ public:
         return _lru_entry_ptr;
     }
 
+    bool reload_in_progress() const noexcept {
+        return _reload_in_progress;
+    }
+
+    void set_reload_in_progress(bool b) noexcept {
+        _reload_in_progress = b;
+    }
+
 private:
     void touch() noexcept {
         assert(_lru_entry_ptr);
-        _last_read = loading_cache_clock_type::now();
+        auto now = loading_cache_clock_type::now();
+        if (now == _last_read) {
+            // A hot entry (e.g. a prepared statement replayed by every
+            // request of a connection) is hit many times within a single
+            // clock tick. Eviction granularity is the clock tick anyway,
+            // so re-splicing the LRU list on every one of those hits only
+            // turns the lookup path into a cache-line write. Skip it.
+            return;
+        }
+        _last_read = now;
         _lru_entry_ptr->touch();
     }
 
@@ -217,6 +235,13 @@ enum class loading_cache_reload_enabled { no, yes };
 /// it's going to be "loaded" in the context of get_XXX(key). As long as the value is cached get_XXX(key) is going to return the
 /// cached value immediately and reload it in the background every "refresh" time period as described above.
 ///
+/// On top of the periodic timer, a get_XXX(key) that hits a value older than the "refresh" period kicks off the reload
+/// immediately in the background ("refresh-ahead") while the caller is served the current value, so crossing the
+/// "refresh" boundary never blocks a request on the loader.
+///
+/// When reloading is enabled, a failed load is also remembered ("negative caching"): for the following "refresh" period
+/// the same exception is returned to all callers asking for that key without invoking the loader again.
+///
 /// \tparam Key type of the cache key
 /// \tparam Tp type of the cached value
 /// \tparam ReloadEnabled if loading_cache_reload_enabled::yes allow reloading the values otherwise don't reload
@@ -312,9 +337,29 @@ public:
         // We shouldn't be here if caching is disabled
         assert(caching_enabled());
 
+        if (ReloadEnabled == loading_cache_reload_enabled::yes) {
+            auto nit = _negative_entries.find(k);
+            if (nit != _negative_entries.end()) {
+                if (loading_cache_clock_type::now() < nit->second.cached + _refresh) {
+                    // A recently failed load (e.g. a nonexistant role) is
+                    // replayed from memory instead of re-querying the loader
+                    // on every request.
+                    return make_exception_future<value_ptr>(nit->second.ex);
+                }
+                _negative_entries.erase(nit);
+            }
+        }
+
         return _loading_values.get_or_load(k, [this, load = std::forward<LoadFunc>(load)] (const Key& k) mutable {
-            return load(k).then([this] (value_type val) {
-                return ts_value_type(std::move(val));
+            return futurize_apply(load, k).then_wrapped([this, k] (future<value_type> f) {
+                if (f.failed()) {
+                    auto ex = f.get_exception();
+                    if (ReloadEnabled == loading_cache_reload_enabled::yes) {
+                        this->cache_negative_entry(k, ex);
+                    }
+                    return make_exception_future<ts_value_type>(std::move(ex));
+                }
+                return make_ready_future<ts_value_type>(ts_value_type(f.get0()));
             });
         }).then([this, k] (timestamped_val_ptr ts_val_ptr) {
             // check again since it could have already been inserted and initialized
@@ -337,6 +382,9 @@ public:
                 return make_ready_future<value_ptr>(std::move(vp));
             }
 
+            if (ReloadEnabled == loading_cache_reload_enabled::yes) {
+                maybe_refresh_ahead(*ts_val_ptr, k);
+            }
             return make_ready_future<value_ptr>(std::move(ts_val_ptr));
         });
     }
@@ -425,14 +473,19 @@ private:
         Alloc().deallocate(val, 1);
     }
 
-    future<> reload(ts_value_lru_entry& lru_entry) {
-        return _load(lru_entry.key()).then_wrapped([this, key = lru_entry.key()] (auto&& f) mutable {
+    future<> reload(ts_value_type& ts_val, const Key& key) {
+        if (ts_val.reload_in_progress()) {
+            return now();
+        }
+        ts_val.set_reload_in_progress(true);
+        return futurize_apply(_load, key).then_wrapped([this, key] (auto&& f) mutable {
             // if the entry has been evicted by now - simply end here
             set_iterator it = this->set_find(key);
             if (it == this->set_end()) {
                 _logger.trace("{}: entry was dropped during the reload", key);
                 return make_ready_future<>();
             }
+            it->set_reload_in_progress(false);
 
             // The exceptions are related to the load operation itself.
             // We should ignore them for the background reads - if
@@ -452,6 +505,42 @@ private:
         });
     }
 
+    // Refresh-ahead: a value past its soft TTL (the "refresh" period) is
+    // served stale to the caller while a reload runs in the background, so
+    // crossing a TTL boundary never injects the load latency into a request.
+    void maybe_refresh_ahead(ts_value_type& ts_val, const Key& k) {
+        if (loading_cache_clock_type::now() < ts_val.loaded() + _refresh || ts_val.reload_in_progress()) {
+            return;
+        }
+        try {
+            with_gate(_timer_reads_gate, [this, &ts_val, k] {
+                return reload(ts_val, k);
+            });
+        } catch (seastar::gate_closed_exception&) {
+            // Shutting down - the stale value is still good enough.
+        }
+    }
+
+    void cache_negative_entry(const Key& k, std::exception_ptr ex) {
+        if (_negative_entries.size() >= max_negative_entries) {
+            // Growth here can be driven by lookups of ever-new missing keys;
+            // wholesale clearing is cheap and rare.
+            _negative_entries.clear();
+        }
+        _negative_entries[k] = negative_entry{std::move(ex), loading_cache_clock_type::now()};
+    }
+
+    void drop_stale_negative_entries() {
+        auto now = loading_cache_clock_type::now();
+        for (auto it = _negative_entries.begin(); it != _negative_entries.end();) {
+            if (_refresh < now - it->second.cached) {
+                it = _negative_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
     void drop_expired() {
         auto now = loading_cache_clock_type::now();
         _lru_list.remove_and_dispose_if([now, this] (const ts_value_lru_entry& lru_entry) {
@@ -494,6 +583,7 @@ private:
 
         // Clean up items that were not touched for the whole _expiry period.
         drop_expired();
+        drop_stale_negative_entries();
 
         // check if rehashing is needed and do it if it is.
         periodic_rehash();
@@ -510,7 +600,7 @@ private:
                 _logger.trace("on_timer(): {}: checking the value age", lru_entry.key());
                 if (lru_entry.timestamped_value().loaded() + _refresh < loading_cache_clock_type::now()) {
                     _logger.trace("on_timer(): {}: reloading the value", lru_entry.key());
-                    return this->reload(lru_entry);
+                    return this->reload(lru_entry.timestamped_value(), lru_entry.key());
                 }
                 return now();
             }).finally([this] {
@@ -520,7 +610,14 @@ private:
         });
     }
 
+    struct negative_entry {
+        std::exception_ptr ex;
+        loading_cache_clock_type::time_point cached;
+    };
+    static constexpr size_t max_negative_entries = 1024;
+
     loading_values_type _loading_values;
+    std::unordered_map<Key, negative_entry, Hash, EqualPred> _negative_entries;
     lru_list_type _lru_list;
     size_t _current_size = 0;
     size_t _max_size = 0;
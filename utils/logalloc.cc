@@ -203,6 +203,75 @@ struct region_sanitizer {
 
 #endif
 
+static thread_local bool allocation_profiling_on = false;
+
+// Sampled allocation site profile of one region, collected only while
+// tracker::set_allocation_profiling(true) is in effect. When profiling is
+// off the allocation path only tests allocation_profiling_on.
+class allocation_profile {
+    struct site {
+        uint64_t samples = 0;
+        uint64_t bytes = 0;
+    };
+    static constexpr uint64_t sampling_interval = 128;
+
+    std::unordered_map<saved_backtrace, site> _sites;
+    uint64_t _countdown = sampling_interval;
+public:
+    void on_allocation(size_t size) noexcept {
+        if (--_countdown) {
+            return;
+        }
+        _countdown = sampling_interval;
+        try {
+            auto& s = _sites[current_backtrace()];
+            ++s.samples;
+            // Scale the sample back up to estimate the site's total volume.
+            s.bytes += size * sampling_interval;
+        } catch (...) {
+            // Dropping a sample beats failing the allocation we're observing.
+        }
+    }
+
+    void clear() {
+        _sites.clear();
+        _countdown = sampling_interval;
+    }
+
+    void merge(allocation_profile& other) noexcept {
+        for (auto&& s : other._sites) {
+            try {
+                auto& dst = _sites[s.first];
+                dst.samples += s.second.samples;
+                dst.bytes += s.second.bytes;
+            } catch (...) {
+                break;
+            }
+        }
+        other._sites.clear();
+    }
+
+    // Formats the top sites by estimated volume, largest first.
+    sstring format(unsigned top) const {
+        auto sites = boost::copy_range<std::vector<const std::pair<const saved_backtrace, site>*>>(
+                _sites | boost::adaptors::transformed([] (auto& s) { return &s; }));
+        boost::sort(sites, [] (auto a, auto b) { return a->second.bytes > b->second.bytes; });
+        sstring out;
+        for (auto&& s : sites) {
+            if (!top--) {
+                break;
+            }
+            out += sprint("  ~%d bytes in %d sampled allocations from:\n%s\n",
+                          s->second.bytes, s->second.samples, s->first);
+        }
+        return out;
+    }
+
+    bool empty() const {
+        return _sites.empty();
+    }
+};
+
 struct segment;
 
 static logging::logger llogger("lsa");
@@ -253,6 +322,9 @@ public:
     size_t reclamation_step() const { return _reclamation_step; }
     void enable_abort_on_bad_alloc() { _abort_on_bad_alloc = true; }
     bool should_abort_on_bad_alloc() const { return _abort_on_bad_alloc; }
+    void set_allocation_profiling(bool enabled);
+    bool allocation_profiling_enabled() const;
+    sstring dump_allocation_profile();
 };
 
 class tracker_reclaimer_lock {
@@ -519,6 +591,8 @@ std::unique_ptr<segment_zone> segment_zone::try_creating_zone()
         }
         memory::disable_abort_on_alloc_failure_temporarily no_abort_guard;
         seastar::memory::scoped_large_allocation_warning_disable slawd;
+        // Allocated from this shard's own memory pool, and thus from the
+        // shard's NUMA node; see the comment at shard_segment_pool.
         auto ptr = aligned_alloc(segment::size, size << segment::size_shift);
         if (!ptr) {
             continue;
@@ -1028,6 +1102,11 @@ size_t segment_pool::segments_in_use() const {
     return _segments_in_use;
 }
 
+// Each shard has its own segment pool and never touches another shard's
+// segments. Zones are carved out of the shard-local seastar allocator, whose
+// memory seastar binds to the NUMA node the shard's cpu belongs to (given
+// hwloc support), so LSA-managed memory - memtables, cache - is NUMA-local
+// by construction and needs no node-aware placement or migration here.
 static thread_local segment_pool shard_segment_pool;
 
 void segment::record_alloc(segment::size_type size) {
@@ -1060,6 +1139,16 @@ segment::occupancy() const {
 // sparser and are eventually released. Objects which are too large are
 // allocated using standard allocator.
 //
+// Freed space is never reused in place (except for rewinding the bump
+// pointer when the freed object happens to be the last allocation of the
+// active segment): a dead marker is written over the object and the space is
+// reclaimed only when compaction migrates the remaining live objects out of
+// the segment. Keeping size-class free lists inside segments would defeat
+// this scheme - compaction walks a segment as a sequential stream of object
+// descriptors, and occupancy accounting assumes segments only grow at the
+// bump pointer - and would buy little, since a bump allocation is already
+// just a pointer increment plus a one/two byte descriptor.
+//
 // Segment layout.
 //
 // Objects in a segment are laid out sequentially. Each object is preceded by
@@ -1212,6 +1301,7 @@ private:
     size_t _evictable_space = 0;
     bool _evictable = false;
     region_sanitizer _sanitizer;
+    allocation_profile _profile;
     uint64_t _id;
     eviction_fn _eviction_fn;
 
@@ -1421,6 +1511,10 @@ public:
     occupancy_stats evictable_occupancy() const {
         return occupancy_stats(_evictable_space, _evictable_space);
     }
+
+    allocation_profile& profile() {
+        return _profile;
+    }
     //
     // Returns true if this region can be compacted and compact() will make forward progress,
     // so that this will eventually stop:
@@ -1440,6 +1534,9 @@ public:
     virtual void* alloc(allocation_strategy::migrate_fn migrator, size_t size, size_t alignment) override {
         compaction_lock _(*this);
         memory::on_alloc_point();
+        if (allocation_profiling_on) {
+            _profile.on_allocation(size);
+        }
         if (size > max_managed_object_size) {
             auto ptr = standard_allocator().alloc(migrator, size, alignment);
             // This isn't very acurrate, the correct free_space value would be
@@ -1484,6 +1581,18 @@ public:
         auto old_pos = pos;
         auto desc = object_descriptor::decode_backwards(pos);
         auto dead_size = size + (old_pos - pos);
+
+        // If this was the most recent allocation from the active segment, we
+        // can just rewind the bump pointer instead of leaving a dead object
+        // behind. Alloc/free pairs of short-lived objects (e.g. row entries
+        // discarded right after a merge on the write path) then cost nothing
+        // and leave no garbage for compaction to skip over.
+        if (seg == _active && old_pos + size == _active->at<const char>(_active_offset)) {
+            _active_offset -= dead_size;
+            seg_desc.record_free(dead_size);
+            return;
+        }
+
         desc = object_descriptor::make_dead(dead_size);
         auto npos = const_cast<char*>(pos);
         desc.encode(npos);
@@ -1561,6 +1670,7 @@ public:
         _invalidate_counter = std::max(_invalidate_counter, other._invalidate_counter);
 
         _sanitizer.merge(other._sanitizer);
+        _profile.merge(other._profile);
         other._sanitizer = { };
     }
 
@@ -1718,6 +1828,18 @@ bool tracker::should_abort_on_bad_alloc() {
     return _impl->should_abort_on_bad_alloc();
 }
 
+void tracker::set_allocation_profiling(bool enabled) {
+    _impl->set_allocation_profiling(enabled);
+}
+
+bool tracker::allocation_profiling_enabled() const {
+    return _impl->allocation_profiling_enabled();
+}
+
+sstring tracker::dump_allocation_profile() {
+    return _impl->dump_allocation_profile();
+}
+
 memory::reclaiming_result tracker::reclaim() {
     return reclaim(_impl->reclamation_step() * segment::size)
            ? memory::reclaiming_result::reclaimed_something
@@ -1806,6 +1928,31 @@ occupancy_stats tracker::impl::region_occupancy() {
     return total;
 }
 
+void tracker::impl::set_allocation_profiling(bool enabled) {
+    if (enabled && !allocation_profiling_on) {
+        for (auto&& r : _regions) {
+            r->profile().clear();
+        }
+    }
+    allocation_profiling_on = enabled;
+}
+
+bool tracker::impl::allocation_profiling_enabled() const {
+    return allocation_profiling_on;
+}
+
+sstring tracker::impl::dump_allocation_profile() {
+    sstring out;
+    for (auto&& r : _regions) {
+        if (r->profile().empty()) {
+            continue;
+        }
+        auto name = r->name().empty() ? sprint("%p", r) : r->name();
+        out += sprint("region %s (occupancy %s):\n%s", name, r->occupancy(), r->profile().format(10));
+    }
+    return out;
+}
+
 occupancy_stats tracker::impl::occupancy() {
     reclaiming_lock _(*this);
     auto occ = region_occupancy();
@@ -2195,6 +2342,15 @@ region* region_group::get_largest_region() {
     return _maximal_rg->_regions.top()->_region;
 }
 
+void region_group::for_each_region(const std::function<void(region*)>& func) {
+    for (auto* ri : _regions) {
+        func(ri->_region);
+    }
+    for (auto* child : _subgroups) {
+        child->for_each_region(func);
+    }
+}
+
 void
 region_group::add(region_group* child) {
     child->_subgroup_heap_handle = _subgroups.push(child);
@@ -2230,32 +2386,36 @@ region_group::execution_permitted() noexcept {
 
 future<>
 region_group::start_releaser() {
-    return later().then([this] {
-        return repeat([this] () noexcept {
-            if (_shutdown_requested) {
-                return make_ready_future<stop_iteration>(stop_iteration::yes);
-            }
+    return with_scheduling_group(_deferred_work_sg, [this] {
+        return later().then([this] {
+            return repeat([this] () noexcept {
+                if (_shutdown_requested) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
 
-            if (!_blocked_requests.empty() && execution_permitted()) {
-                auto req = std::move(_blocked_requests.front());
-                _blocked_requests.pop_front();
-                req->allocate();
-                return make_ready_future<stop_iteration>(stop_iteration::no);
-            } else {
-                // Block reclaiming to prevent signal() from being called by reclaimer inside wait()
-                // FIXME: handle allocation failures (not very likely) like allocating_section does
-                tracker_reclaimer_lock rl;
-                return _relief.wait().then([] {
-                    return stop_iteration::no;
-                });
-            }
+                if (!_blocked_requests.empty() && execution_permitted()) {
+                    auto req = std::move(_blocked_requests.front());
+                    _blocked_requests.pop_front();
+                    req->allocate();
+                    return make_ready_future<stop_iteration>(stop_iteration::no);
+                } else {
+                    // Block reclaiming to prevent signal() from being called by reclaimer inside wait()
+                    // FIXME: handle allocation failures (not very likely) like allocating_section does
+                    tracker_reclaimer_lock rl;
+                    return _relief.wait().then([] {
+                        return stop_iteration::no;
+                    });
+                }
+            });
         });
     });
 }
 
-region_group::region_group(region_group *parent, region_group_reclaimer& reclaimer)
+region_group::region_group(region_group *parent, region_group_reclaimer& reclaimer,
+        seastar::scheduling_group deferred_work_sg)
     : _parent(parent)
     , _reclaimer(reclaimer)
+    , _deferred_work_sg(deferred_work_sg)
     , _releaser(reclaimer_can_block() ? start_releaser() : make_ready_future<>())
 {
     if (_parent) {
@@ -175,6 +175,11 @@ class region_group {
     region_group* _parent = nullptr;
     size_t _total_memory = 0;
     region_group_reclaimer& _reclaimer;
+    // Deferred allocating functions, queued when this group was over its
+    // throttle threshold, are executed under this scheduling group, so the
+    // work is charged to the owner of the group (e.g. streaming) instead of
+    // whatever task happens to relieve the pressure.
+    seastar::scheduling_group _deferred_work_sg;
 
     subgroup_heap _subgroups;
     subgroup_heap::handle_type _subgroup_heap_handle;
@@ -252,8 +257,14 @@ public:
     // method run_when_memory_available(), to make sure that a given function is only executed when
     // the total memory for the region group (and all of its parents) is lower or equal to the
     // region_group's throttle_treshold (and respectively for its parents).
-    region_group(region_group_reclaimer& reclaimer = no_reclaimer) : region_group(nullptr, reclaimer) {}
-    region_group(region_group* parent, region_group_reclaimer& reclaimer = no_reclaimer);
+    //
+    // The deferred_work_sg parameter names the scheduling group under which
+    // requests deferred by run_when_memory_available() are later executed.
+    region_group(region_group_reclaimer& reclaimer = no_reclaimer,
+            seastar::scheduling_group deferred_work_sg = seastar::default_scheduling_group())
+        : region_group(nullptr, reclaimer, deferred_work_sg) {}
+    region_group(region_group* parent, region_group_reclaimer& reclaimer = no_reclaimer,
+            seastar::scheduling_group deferred_work_sg = seastar::default_scheduling_group());
     region_group(region_group&& o) = delete;
     region_group(const region_group&) = delete;
     ~region_group() {
@@ -337,6 +348,10 @@ public:
     // children.
     region* get_largest_region();
 
+    // Calls func once for each region that sits below this region group,
+    // including the regions owned by all of its children.
+    void for_each_region(const std::function<void(region*)>& func);
+
     // Shutdown is mandatory for every user who has set a threshold
     // Can be called at most once.
     future<> shutdown() {
@@ -470,6 +485,19 @@ public:
     void enable_abort_on_bad_alloc();
 
     bool should_abort_on_bad_alloc();
+
+    // Toggles sampled allocation site profiling for all regions on this
+    // shard. While enabled, every Nth allocation in a region records a
+    // backtrace; when disabled (the default) the allocation path only
+    // tests a flag. Enabling discards previously collected samples.
+    void set_allocation_profiling(bool enabled);
+
+    bool allocation_profiling_enabled() const;
+
+    // Returns a human-readable report of the top sampled allocation sites
+    // of each region which collected any, with the region names set via
+    // region::set_name().
+    sstring dump_allocation_profile();
 };
 
 tracker& shard_tracker();
@@ -536,6 +564,7 @@ public:
 class basic_region_impl : public allocation_strategy {
 protected:
     bool _reclaiming_enabled = true;
+    sstring _name;
 public:
     void set_reclaiming_enabled(bool enabled) {
         _reclaiming_enabled = enabled;
@@ -544,6 +573,14 @@ public:
     bool reclaiming_enabled() const {
         return _reclaiming_enabled;
     }
+
+    void set_name(sstring name) {
+        _name = std::move(name);
+    }
+
+    const sstring& name() const {
+        return _name;
+    }
 };
 
 //
@@ -607,6 +644,11 @@ public:
     // Returns the reclaimability state of this region.
     bool reclaiming_enabled() const { return _impl->reclaiming_enabled(); }
 
+    // Names this region in diagnostics, e.g. the allocation profile dump.
+    void set_name(sstring name) { _impl->set_name(std::move(name)); }
+
+    const sstring& name() const { return _impl->name(); }
+
     // Returns a value which is increased when this region is either compacted or
     // evicted from, which invalidates references into the region.
     // When the value returned by this method doesn't change, references remain valid.
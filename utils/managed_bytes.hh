@@ -107,7 +107,13 @@ public:
         }
     };
 private:
-    static constexpr size_t max_inline_size = 15;
+    // Values up to this size are stored in-place, with no blob_storage
+    // allocation and no pointer chase on read. Atomic cells prepend flags
+    // and timestamps (and possibly expiry) to the value, so this covers
+    // live cell values of up to 35 bytes (27 with a ttl) - the common case
+    // for numeric and uuid-sized columns - at the cost of growing every
+    // managed_bytes instance, which cells dominate by count.
+    static constexpr size_t max_inline_size = 44;
     struct small_blob {
         bytes_view::value_type data[max_inline_size];
         int8_t size; // -1 -> use blob_storage
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+namespace utils {
+
+// A sequence lock protecting a small trivially-copyable value with a single
+// writer (the owning shard) and any number of readers on other shards.
+// Writes are wait-free; a reader retries if it raced with a write. This
+// allows values which are only ever polled - statistics counters, mostly -
+// to be read across shards without messaging.
+//
+// Note that, strictly speaking, the concurrent access to _value is a data
+// race; like every seqlock, we rely on the fences and the sequence check to
+// discard any torn copy before it is looked at.
+template<typename T>
+class seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock requires a trivially copyable type");
+    std::atomic<uint64_t> _seq{0};
+    T _value{};
+public:
+    // May only be called by the owning shard.
+    void write(const T& v) {
+        auto seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _value = v;
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // May be called by any shard.
+    T read() const {
+        for (;;) {
+            auto before = _seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue; // write in progress
+            }
+            T v = _value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto after = _seq.load(std::memory_order_relaxed);
+            if (before == after) {
+                return v;
+            }
+        }
+    }
+};
+
+}
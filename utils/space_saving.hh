@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace utils {
+
+// Space-Saving frequency estimator (Metwally et al., "Efficient
+// computation of frequent and top-k elements in data streams"): tracks
+// an approximate top-k of a stream using k counters. When an element
+// outside the tracked set arrives and all counters are taken, the
+// minimum counter is reassigned to it and its old count becomes the new
+// entry's estimation error. Any element whose true frequency exceeds
+// total/k is guaranteed to be tracked; count - error is a lower bound
+// on an entry's true frequency.
+//
+// Lookup is a linear scan, so this is only suitable for small k.
+template<typename Key>
+class space_saving {
+public:
+    struct entry {
+        Key key;
+        uint64_t count = 0;
+        uint64_t error = 0;
+    };
+private:
+    std::vector<entry> _entries;
+    size_t _capacity;
+    uint64_t _total = 0;
+public:
+    explicit space_saving(size_t capacity) : _capacity(capacity) {
+        _entries.reserve(capacity);
+    }
+
+    void add(const Key& k) {
+        ++_total;
+        auto it = std::find_if(_entries.begin(), _entries.end(), [&] (const entry& e) {
+            return e.key == k;
+        });
+        if (it != _entries.end()) {
+            ++it->count;
+            return;
+        }
+        if (_entries.size() < _capacity) {
+            _entries.push_back(entry{k, 1, 0});
+            return;
+        }
+        auto min = std::min_element(_entries.begin(), _entries.end(), [] (const entry& a, const entry& b) {
+            return a.count < b.count;
+        });
+        min->error = min->count;
+        min->key = k;
+        ++min->count;
+    }
+
+    // Number of elements fed to add() since construction, clear() or
+    // halved by age().
+    uint64_t total() const {
+        return _total;
+    }
+
+    // Entry with the highest estimated frequency, or nullptr when no
+    // element was added yet.
+    const entry* top() const {
+        if (_entries.empty()) {
+            return nullptr;
+        }
+        return &*std::max_element(_entries.begin(), _entries.end(), [] (const entry& a, const entry& b) {
+            return a.count < b.count;
+        });
+    }
+
+    const std::vector<entry>& entries() const {
+        return _entries;
+    }
+
+    // Halve all counts so that past heavy hitters fade out and the
+    // estimator keeps reflecting the recent stream.
+    void age() {
+        _total /= 2;
+        for (auto& e : _entries) {
+            e.count /= 2;
+            e.error /= 2;
+        }
+    }
+
+    void clear() {
+        _entries.clear();
+        _total = 0;
+    }
+};
+
+}
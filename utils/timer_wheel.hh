@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <seastar/core/timer.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <boost/intrusive/list.hpp>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace utils {
+
+// A hashed timer wheel: expiry tracking for workloads which arm and cancel
+// very large numbers of mostly short-lived timeouts, where a timer<> per
+// entry becomes measurable just from maintaining seastar's timer set.
+//
+// Entries hash into coarse fixed-width buckets by expiry time, and a single
+// timer<> per wheel sweeps one bucket per tick. Arming and cancelling an
+// entry are O(1) list link operations and expiry is amortized O(1). The
+// price is resolution: a callback can fire up to one bucket width late.
+// Timeouts further out than one wheel revolution simply stay linked and are
+// caught the next time their bucket comes around.
+template <typename Clock = seastar::lowres_clock>
+class timer_wheel {
+    using bi_hook = boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::auto_unlink>>;
+public:
+    using clock = Clock;
+    using time_point = typename Clock::time_point;
+    using duration = typename Clock::duration;
+
+    class entry : public bi_hook {
+        std::function<void()> _callback;
+        time_point _expires;
+        friend class timer_wheel;
+    public:
+        entry() = default;
+        explicit entry(std::function<void()> callback) : _callback(std::move(callback)) {}
+        entry(entry&& o) noexcept : _callback(std::move(o._callback)), _expires(o._expires) {
+            if (o.is_linked()) {
+                this->swap_nodes(o);
+            }
+        }
+        entry& operator=(entry&&) = delete;
+        // The auto-unlink hook takes care of unlinking on destruction.
+        ~entry() = default;
+
+        void set_callback(std::function<void()> callback) {
+            _callback = std::move(callback);
+        }
+        bool armed() const {
+            return this->is_linked();
+        }
+        void cancel() {
+            this->unlink();
+        }
+    };
+
+private:
+    using bucket = boost::intrusive::list<entry, boost::intrusive::constant_time_size<false>>;
+    std::vector<bucket> _buckets;
+    duration _resolution;
+    // Start of the next bucket to be swept.
+    time_point _last_sweep;
+    timer<Clock> _timer;
+    bool _in_sweep = false;
+
+    size_t bucket_index(time_point tp) const {
+        return (tp.time_since_epoch() / _resolution) % _buckets.size();
+    }
+    time_point truncate(time_point tp) const {
+        return time_point(tp.time_since_epoch() / _resolution * _resolution);
+    }
+    bool empty() const {
+        for (auto& b : _buckets) {
+            if (!b.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    void sweep() {
+        _in_sweep = true;
+        auto now = Clock::now();
+        // Sweep a bucket only once its whole width has passed, so that all
+        // its non-wrapped entries are due by then.
+        while (_last_sweep + _resolution <= now) {
+            auto& b = _buckets[bucket_index(_last_sweep)];
+            // Move due entries aside first: callbacks may arm or cancel
+            // arbitrary entries, including others in this very bucket.
+            // Entries whose deadline lies a whole revolution (or more) ahead
+            // stay linked for a later pass.
+            bucket due;
+            for (auto it = b.begin(); it != b.end();) {
+                auto& e = *it;
+                ++it;
+                if (e._expires <= now) {
+                    e.unlink();
+                    due.push_back(e);
+                }
+            }
+            while (!due.empty()) {
+                auto& e = due.front();
+                e.unlink();
+                e._callback();
+            }
+            _last_sweep += _resolution;
+        }
+        _in_sweep = false;
+        if (!empty()) {
+            _timer.arm(_last_sweep + _resolution);
+        }
+    }
+
+public:
+    explicit timer_wheel(duration resolution, size_t buckets = 256)
+        : _buckets(buckets)
+        , _resolution(resolution)
+        , _last_sweep(truncate(Clock::now()))
+        , _timer([this] { sweep(); }) {
+    }
+    timer_wheel(timer_wheel&&) = delete;
+
+    // Links e into the wheel so that its callback runs within one bucket
+    // width after timeout. Re-arming an armed entry just relinks it.
+    void arm(entry& e, time_point timeout) {
+        e.cancel();
+        e._expires = timeout;
+        // An already overdue timeout would hash into a bucket that will not
+        // be swept again for a whole revolution; file it under the next
+        // sweep instead.
+        _buckets[bucket_index(std::max(timeout, _last_sweep))].push_back(e);
+        if (!_timer.armed() && !_in_sweep) {
+            // The wheel was idle, so _last_sweep may be far in the past;
+            // it can only be stale if nothing is linked, which an unarmed
+            // timer guarantees for everything but the entry just added.
+            _last_sweep = std::max(_last_sweep, truncate(Clock::now()));
+            _timer.arm(_last_sweep + _resolution);
+        }
+    }
+};
+
+}
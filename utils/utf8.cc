@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "utils/utf8.hh"
+
+namespace utils {
+
+namespace utf8 {
+
+static inline bool is_continuation(uint8_t b) {
+    return (b & 0xc0) == 0x80;
+}
+
+bool validate(const uint8_t* data, size_t size) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    while (p < end) {
+        // Skip over runs of ASCII eight bytes at a time. The unaligned
+        // 64-bit load compiles to a single instruction on the platforms we
+        // care about, and the whole loop to a load, a test and a branch per
+        // eight input bytes.
+        while (end - p >= 8) {
+            uint64_t block;
+            std::memcpy(&block, p, 8);
+            if (block & 0x8080808080808080ull) {
+                break;
+            }
+            p += 8;
+        }
+        if (p == end) {
+            return true;
+        }
+        auto b = *p;
+        if (b < 0x80) {
+            ++p;
+        } else if ((b & 0xe0) == 0xc0) {
+            if (end - p < 2 || b < 0xc2 /* overlong */ || !is_continuation(p[1])) {
+                return false;
+            }
+            p += 2;
+        } else if ((b & 0xf0) == 0xe0) {
+            if (end - p < 3 || !is_continuation(p[1]) || !is_continuation(p[2])) {
+                return false;
+            }
+            if ((b == 0xe0 && p[1] < 0xa0) // overlong
+                    || (b == 0xed && p[1] >= 0xa0)) { // surrogate
+                return false;
+            }
+            p += 3;
+        } else if ((b & 0xf8) == 0xf0) {
+            if (end - p < 4 || b > 0xf4 /* above U+10FFFF */
+                    || !is_continuation(p[1]) || !is_continuation(p[2]) || !is_continuation(p[3])) {
+                return false;
+            }
+            if ((b == 0xf0 && p[1] < 0x90) // overlong
+                    || (b == 0xf4 && p[1] >= 0x90)) { // above U+10FFFF
+                return false;
+            }
+            p += 4;
+        } else {
+            // Stray continuation byte, or the never-valid 0xf8-0xff.
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2018 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace utils {
+
+namespace utf8 {
+
+// Returns true iff the given byte sequence is valid UTF-8: well-formed
+// sequences only, rejecting overlong encodings, surrogate code points and
+// code points above U+10FFFF. Runs of ASCII, the common case for our
+// workloads, are processed eight bytes at a time.
+bool validate(const uint8_t* data, size_t size);
+
+}
+
+}
@@ -45,6 +45,8 @@
 
 #include <seastar/core/bitops.hh>
 
+#include "net/byteorder.hh"
+
 #include <algorithm>
 #include <array>
 #include <limits>
@@ -133,6 +135,26 @@ vint_size_type unsigned_vint::serialized_size(uint64_t value) noexcept {
     return vint_size_type(9) - vint_size_type((magnitude - 1) / 7);
 }
 
+// Decodes a vint whose encoding spans at most 8 bytes, all of which are
+// readable at v.data(). The leading-ones length prefix lets us do this with
+// a single unaligned big-endian load, a count-leading-zeros and a
+// shift-and-mask -- no per-byte loop and no data-dependent branches beyond
+// the one-byte fast path.
+static unsigned_vint::deserialized_type deserialize_word(bytes_view v, int8_t first_byte,
+        vint_size_type extra_bytes_size) {
+    const auto total_size = extra_bytes_size + 1;
+
+    uint64_t raw;
+    std::copy_n(v.data(), 8, reinterpret_cast<int8_t*>(&raw));
+    raw = net::ntoh(raw);
+
+    const auto result = (raw >> ((8 - total_size) * 8))
+            & ((first_byte_value_mask(extra_bytes_size) << (extra_bytes_size * 8))
+               | ((uint64_t(1) << (extra_bytes_size * 8)) - 1));
+
+    return unsigned_vint::deserialized_type{result, total_size};
+}
+
 unsigned_vint::deserialized_type unsigned_vint::deserialize(bytes_view v) {
     const int8_t first_byte = v[0];
 
@@ -144,6 +166,10 @@ unsigned_vint::deserialized_type unsigned_vint::deserialize(bytes_view v) {
     const auto extra_bytes_size = count_extra_bytes(first_byte);
     const auto total_size = extra_bytes_size + 1;
 
+    if (extra_bytes_size < 8 && v.size() >= 8) {
+        return deserialize_word(v, first_byte, extra_bytes_size);
+    }
+
     // Extract the bits not used for counting bytes.
     auto result = uint64_t(first_byte) & first_byte_value_mask(extra_bytes_size);
 
@@ -154,3 +180,47 @@ unsigned_vint::deserialized_type unsigned_vint::deserialize(bytes_view v) {
 
     return deserialized_type{result, total_size};
 }
+
+unsigned_vint::batch_deserialized_type unsigned_vint::deserialize_batch(bytes_view v, uint64_t* out,
+        vint_size_type max_count) {
+    vint_size_type count = 0;
+    vint_size_type consumed = 0;
+
+    while (count < max_count && consumed < v.size()) {
+        const auto remaining = bytes_view(v.data() + consumed, v.size() - consumed);
+        const int8_t first_byte = remaining[0];
+
+        if (first_byte >= 0) {
+            out[count++] = uint64_t(first_byte);
+            consumed += 1;
+            continue;
+        }
+
+        const auto extra_bytes_size = count_extra_bytes(first_byte);
+
+        if (extra_bytes_size + 1u > remaining.size()) {
+            // The buffer ends in the middle of this vint.
+            break;
+        }
+
+        const auto d = (extra_bytes_size < 8 && remaining.size() >= 8)
+                ? deserialize_word(remaining, first_byte, extra_bytes_size)
+                : deserialize(remaining);
+
+        out[count++] = d.value;
+        consumed += d.size;
+    }
+
+    return batch_deserialized_type{count, consumed};
+}
+
+signed_vint::batch_deserialized_type signed_vint::deserialize_batch(bytes_view v, int64_t* out,
+        vint_size_type max_count) {
+    const auto r = unsigned_vint::deserialize_batch(v, reinterpret_cast<uint64_t*>(out), max_count);
+
+    for (vint_size_type i = 0; i < r.count; ++i) {
+        out[i] = decode_zigzag(static_cast<uint64_t>(out[i]));
+    }
+
+    return batch_deserialized_type{r.count, r.size};
+}
@@ -42,6 +42,16 @@ struct unsigned_vint final {
     static vint_size_type serialize(value_type, bytes::iterator out);
 
     static deserialized_type deserialize(bytes_view v);
+
+    struct batch_deserialized_type final {
+        vint_size_type count;
+        vint_size_type size;
+    };
+
+    // Decodes up to max_count consecutive vints from v, storing the values at
+    // out. Stops early if the buffer is exhausted or ends in the middle of a
+    // vint. Returns the number of values decoded and the bytes consumed.
+    static batch_deserialized_type deserialize_batch(bytes_view v, value_type* out, vint_size_type max_count);
 };
 
 struct signed_vint final {
@@ -57,4 +67,12 @@ struct signed_vint final {
     static vint_size_type serialize(value_type, bytes::iterator out);
 
     static deserialized_type deserialize(bytes_view v);
+
+    struct batch_deserialized_type final {
+        vint_size_type count;
+        vint_size_type size;
+    };
+
+    // Like unsigned_vint::deserialize_batch(), for zigzag-encoded values.
+    static batch_deserialized_type deserialize_batch(bytes_view v, value_type* out, vint_size_type max_count);
 };